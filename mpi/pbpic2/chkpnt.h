@@ -0,0 +1,21 @@
+/* header file for chkpnt.c */
+
+int cchkwait();
+
+int cchkopen(char *fname, int idproc, int nvp, int ntime, int ndec,
+             int idec[]);
+
+int cchkaddi(int f[], int nf);
+
+int cchkaddf(float f[], int nf);
+
+int cchkwrite();
+
+int cchkread(char *fname, int idproc, int nvp, int *ntime, int ndec,
+             int idec[]);
+
+int cchkgeti(int f[], int nmax, int *nf);
+
+int cchkgetf(float f[], int nmax, int *nf);
+
+void cchkclose();
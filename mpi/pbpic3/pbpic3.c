@@ -7,6 +7,7 @@
 #include <sys/time.h>
 #include "pbpush3.h"
 #include "pplib3.h"
+#include "chkpnt.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -34,6 +35,10 @@ int main(int argc, char *argv[]) {
 /* sortime = number of time steps between standard electron sorting */
 /* relativity = (no,yes) = (0,1) = relativity is used */
    int idimp = 6, ipbc = 1, sortime = 20, relativity = 1;
+/* nchk = number of time steps between checkpoints, 0 = never */
+/* krst = (0,1) = (start new run, restart from checkpoint files) */
+   int nchk = 0, krst = 0;
+   char *chkfile = "pbpic3_chk";
 /* idps = number of partition boundaries = 4 */
 /* idds = dimensionality of domain decomposition = 2 */
    int idps = 4, idds =    2;
@@ -80,6 +85,9 @@ int main(int argc, char *argv[]) {
    int *npic = NULL;
    double wtot[7], work[7];
    int info[7];
+/* idec = decomposition recorded in checkpoint files */
+/* ichk = npp saved in checkpoint files */
+   int idec[6], ichk[1], iwork[1], ihmax[1], irc;
 
 /* declare arrays for MPI code: */
 /* bs/br = complex send/receive buffers for data transpose */
@@ -226,11 +234,16 @@ int main(int argc, char *argv[]) {
    isign = 0;
    cppois332(qt,fxyzt,isign,ffc,ax,ay,az,affp,&we,nx,ny,nz,kstrt,nvpy,
              nvpz,nze,kxyp,kyzp,nzh);
+/* decomposition recorded in checkpoint files */
+   idec[0] = nx; idec[1] = ny; idec[2] = nz; idec[3] = idimp;
+   idec[4] = nvpy; idec[5] = nvpz;
 /* initialize electrons */
    nps = 1;
    npp = 0;
-   cpdistr32(part,edges,&npp,nps,vtx,vty,vtz,vx0,vy0,vz0,npx,npy,npz,nx,
-             ny,nz,idimp,npmax,idps,ipbc,&ierr);
+   ierr = 0;
+   if (krst==0)
+      cpdistr32(part,edges,&npp,nps,vtx,vty,vtz,vx0,vy0,vz0,npx,npy,npz,
+                nx,ny,nz,idimp,npmax,idps,ipbc,&ierr);
 /* check for particle initialization error */
    if (ierr != 0) {
       if (kstrt==1) {
@@ -245,6 +258,39 @@ int main(int argc, char *argv[]) {
       bxyz[j] = 0.0 + 0.0*_Complex_I;
    }
 
+/* restart from checkpoint files: updates ntime, part, npp, exyz, */
+/* bxyz */
+   if (krst==1) {
+      ierr = cchkread(chkfile,idproc,nvp,&ntime,6,idec);
+      if (ierr==0)
+         ierr = cchkgeti(ichk,1,&j);
+      if (ierr==0) {
+         npp = ichk[0];
+         ierr = cchkgetf(part,idimp*npmax,&j);
+         if ((ierr==0) && (j != idimp*npp))
+            ierr = 1;
+      }
+      if (ierr==0)
+         ierr = cchkgetf((float *)exyz,2*ndim*nze*kxyp*kyzp,&j);
+      if (ierr==0)
+         ierr = cchkgetf((float *)bxyz,2*ndim*nze*kxyp*kyzp,&j);
+      cchkclose();
+      iwork[0] = ierr;
+      cppimax(iwork,ihmax,1);
+      if (iwork[0] != 0) {
+         if (kstrt==1) {
+            printf("restart error: chkfile=%s\n",chkfile);
+         }
+         goto L3000;
+      }
+/* time centering of current deposit is set at ntime = 0 */
+      if (ntime > 0)
+         dth = 0.5*dt;
+      if (kstrt==1) {
+         printf("restart from %s at ntime=%d\n",chkfile,ntime);
+      }
+   }
+
    if (dt > 0.37*ci) {
       printf("Warning: Courant condition may be exceeded!\n");
    }
@@ -503,6 +549,25 @@ Field Energies:\n");
          printf("%e %e %e\n",we,wf,wm);
       }
       ntime += 1;
+/* write checkpoint files in the background: copies part, exyz, bxyz */
+      if ((nchk > 0) && (ntime%nchk==0)) {
+         if (cchkwait() != 0)
+            printf("%d,checkpoint write error\n",kstrt);
+         ichk[0] = npp;
+         irc = cchkopen(chkfile,idproc,nvp,ntime,6,idec);
+         if (irc==0)
+            irc = cchkaddi(ichk,1);
+         if (irc==0)
+            irc = cchkaddf(part,idimp*npp);
+         if (irc==0)
+            irc = cchkaddf((float *)exyz,2*ndim*nze*kxyp*kyzp);
+         if (irc==0)
+            irc = cchkaddf((float *)bxyz,2*ndim*nze*kxyp*kyzp);
+         if (irc==0)
+            irc = cchkwrite();
+         if (irc != 0)
+            printf("%d,checkpoint error: ntime=%d\n",kstrt,ntime);
+      }
       goto L500;
 L2000:
 
@@ -546,6 +611,8 @@ Field Energies:\n");
    }
 
 L3000:
+   if (cchkwait() != 0)
+      printf("%d,checkpoint write error\n",kstrt);
    cppexit();
    return 0;
 }
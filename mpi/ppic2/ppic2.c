@@ -7,6 +7,8 @@
 #include <sys/time.h>
 #include "ppush2.h"
 #include "pplib2.h"
+#include "perflog.h"
+#include "chkpnt.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -33,6 +35,24 @@ int main(int argc, char *argv[]) {
    int idimp = 4, ipbc = 1, sortime = 50;
 /* idps = number of partition boundaries */
    int idps = 2;
+/* idds = dimensionality of domain decomposition = (1,2) = */
+/* (partitions in y, partitions in x and y)                */
+   int idds = 1;
+/* kperf = (0,1,2) = write timings for each time step to perffile as */
+/* (none, CSV, JSON lines), on node 0 only                           */
+/* nperf = print summary of timings every nperf time steps, 0 = never */
+   int kperf = 0, nperf = 0;
+   char *perffile = "ppic2_perf";
+/* nbal = number of time steps between load balancing, 0 = never */
+/* kbal = (1,2) = balance (number of particles, push time) per node */
+/* tbal = repartition only if maximum/mean load is larger than tbal */
+/* ybal = maximum partition size, in units of uniform partition size */
+   int nbal = 0, kbal = 1;
+   float tbal = 1.1, ybal = 4.0;
+/* nchk = number of time steps between checkpoints, 0 = never */
+/* krst = (0,1) = (start new run, restart from checkpoint files) */
+   int nchk = 0, krst = 0;
+   char *chkfile = "ppic2_chk";
 /* wke/we/wt = particle kinetic/electric field/total energy */
    float wke = 0.0, we = 0.0, wt = 0.0;
 /* declare scalars for standard code */
@@ -44,8 +64,31 @@ int main(int argc, char *argv[]) {
 
 /* declare scalars for MPI code */
    int ntpose = 1;
+/* ktpose = (0,1,2) = fft transpose sends (one message at a time, */
+/* all data with one collective, nch chunks overlapped with fft)  */
+/* nch = number of chunks for ktpose = 2, nch <= 16               */
+   int ktpose = 0, nch = 4;
+   int nbt, nct;
    int nvp, idproc, kstrt, npmax, kxp, kyp, nypmx, nypmn;
    int nyp, noff, npp, nps, nbmax, ntmax;
+/* nhole = number of particles leaving this node in current step */
+   int nhole;
+/* noffu/nypu/nypmu = noff/nyp/nypmx for uniform partition used by fft */
+   int noffu, nypu, nypmu;
+   int irc, ltime, nbals = 0;
+/* nplim = maximum number of electrons in partition after balancing */
+/* noffo = lowermost global gridpoint in partition before balancing */
+   int nplim, noffo;
+/* nvpx/nvpy = number of processors in x/y for 2D decomposition */
+/* nxpmx = maximum size of particle partition in x, including guard */
+/* cells, nxpmn = minimum number of gridpoints in x in partition    */
+/* nxv = first dimension of fields in particle partition            */
+   int nvpx = 1, nvpy = 1, nxpmx, nxpmn, nxv, nfb;
+/* noffxy/nxyp = lowermost global gridpoint/number of primary */
+/* gridpoints in x/y in particle partition, for 2D decomposition */
+/* noffuxy/nxypu = the same for the uniform partition used by fft */
+   int noffxy[2], nxyp[2], noffuxy[2], nxypu[2];
+   float abal, wtp, tbpush = 0.0;
 
 /* declare arrays for standard code: */
 /* part, part2 = particle arrays */
@@ -74,6 +117,8 @@ int main(int argc, char *argv[]) {
 /* declare arrays for MPI code: */
 /* bs/br = complex send/receive buffers for data transpose */
    float complex *bs = NULL, *br = NULL;
+/* mtcnt = scratch array for counts of data transposed */
+   int *mtcnt = NULL;
 /* sbufl/sbufr = particle buffers sent to nearby processors */
 /* rbufl/rbufr = particle buffers received from nearby processors */
    float *sbufl = NULL, *sbufr = NULL, *rbufl = NULL, *rbufr = NULL;
@@ -81,6 +126,19 @@ int main(int argc, char *argv[]) {
    float *edges = NULL;
 /* scr = guard cell buffer received from nearby processors */
    float *scr = NULL;
+/* scs = guard cell buffer for columns, for 2D decomposition */
+   float *scs = NULL;
+/* fbufs/fbufr = buffers for moving fields between partitions */
+   float *fbufs = NULL, *fbufr = NULL;
+/* qu/fxyu = charge density/force in uniform partition used by fft */
+   float *qu = NULL, *fxyu = NULL;
+/* dpro = load and number of particles in each grid row */
+/* dscr = scratch array                                  */
+   float *dpro = NULL, *dscr = NULL;
+/* mcnt = scratch array for moving fields between partitions */
+   int *mcnt = NULL;
+/* dlb/dmx = sum/maximum of load and number of particles */
+   double dlb[2], dmx[2], dwk[2];
 
 /* declare and initialize timing data */
    float time;
@@ -89,6 +147,17 @@ int main(int argc, char *argv[]) {
    float tpush = 0.0, tsort = 0.0, tmov = 0.0;
    float tfft[2] = {0.0,0.0};
    double dtime;
+/* timed phases and counters written by cperfstep */
+   char *phnames[7] = {"deposit","guard","fft","transpose","field",
+                       "push","move"};
+   char *cnames[3] = {"moved","maxholes","imbalance"};
+   double tperf[7];
+   float cperf[3];
+   double dmove[1], dwork[1];
+   int ihmax[1], iwork[1];
+/* idec = decomposition recorded in checkpoint files */
+/* ichk = npp, noff, nyp, nbals saved in checkpoint files */
+   int idec[6], ichk[4];
 
 /* initialize scalars for standard code */
 /* np = total number of particles in simulation */
@@ -110,13 +179,21 @@ int main(int argc, char *argv[]) {
    cppinit2(&idproc,&nvp,argc,argv);
    kstrt = idproc + 1;
 /* check if too many processors */
-   if (nvp > ny) {
+   if ((idds==1) && (nvp > ny)) {
       if (kstrt==1) {
          printf("Too many processors requested: ny, nvp=%d,%d\n",ny,nvp);
       }
       goto L3000;
    }
+/* load balancing is only supported with partitions in y */
+   if ((idds==2) && (nbal > 0)) {
+      if (kstrt==1) {
+         printf("load balancing not supported with idds = %d\n",idds);
+      }
+      goto L3000;
+   }
 /* initialize data for MPI code */
+   idps = 2*idds;
    edges = (float *) malloc(idps*sizeof(float));
 /* calculate partition variables: edges, nyp, noff, nypmx              */
 /* edges[0:1] = lower:upper boundary of particle partition             */
@@ -124,13 +201,36 @@ int main(int argc, char *argv[]) {
 /* noff = lowermost global gridpoint in particle partition             */
 /* nypmx = maximum size of particle partition, including guard cells   */
 /* nypmn = minimum value of nyp                                        */
-   cpdicomp2l(edges,&nyp,&noff,&nypmx,&nypmn,ny,kstrt,nvp,idps);
+   if (idds==1) {
+      cpdicomp2l(edges,&nyp,&noff,&nypmx,&nypmn,ny,kstrt,nvp,idps);
+      nxv = nxe;
+   }
+/* for 2D decomposition, edges[0:3] = left:right:lower:upper boundary */
+/* of particle partition, nyp and noff refer to y                     */
+   else {
+      cfcomp2xy(nvp,nx,ny,&nvpx,&nvpy,&ierr);
+      if (ierr != 0)
+         goto L3000;
+      cpdicomp2xyl(edges,nxyp,noffxy,&nxpmx,&nypmx,&nxpmn,&nypmn,nx,ny,
+                   kstrt,nvpx,nvpy,idps,idds);
+      nypmn = nxpmn < nypmn ? nxpmn : nypmn;
+      noff = noffxy[1];
+      nyp = nxyp[1];
+      nxv = nxpmx;
+   }
    if (nypmn < 1) {
       if (kstrt==1) {
          printf("combination not supported nvp, ny = %d,%d\n",nvp,ny);
       }
       goto L3000;
    }
+/* check number of transpose chunks */
+   if ((ktpose==2) && ((nch < 1) || (nch > 16))) {
+      if (kstrt==1) {
+         printf("number of chunks not supported nch = %d\n",nch);
+      }
+      goto L3000;
+   }
 
 /* initialize additional scalars for MPI code */
 /* kxp = number of complex grids in each field partition in x direction */
@@ -143,12 +243,36 @@ int main(int argc, char *argv[]) {
    nbmax = 0.1*npmax;
 /* ntmax = size of ihole buffer for particles leaving processor */
    ntmax = 2*nbmax;
+/* leave room for particles arriving during migration and later steps */
+   nplim = npmax - nbmax;
+/* save uniform partition, used by the fft */
+   noffu = noff;
+   nypu = nyp;
+   nypmu = nypmx;
+/* with 2D decomposition, some processors may have no rows in the fft */
+   if (idds==2) {
+      noffu = kyp*(kstrt - 1);
+      noffu = noffu < ny ? noffu : ny;
+      nypu = ny - noffu;
+      nypu = kyp < nypu ? kyp : nypu;
+      nypmu = kyp + 1;
+      noffuxy[0] = 0;
+      noffuxy[1] = noffu;
+      nxypu[0] = nx;
+      nxypu[1] = nypu;
+   }
+/* enlarge maximum partition size for load balancing */
+   if (nbal > 0) {
+      nypmx = ybal*(float) kyp;
+      nypmx = (nypmx < ny ? nypmx : ny) + 1;
+      nypmx = nypmx > nypmu ? nypmx : nypmu;
+   }
 
 /* allocate data for standard code */
    part = (float *) malloc(idimp*npmax*sizeof(float));
    part2 = (float *) malloc(idimp*npmax*sizeof(float));
-   qe = (float *) malloc(nxe*nypmx*sizeof(float));
-   fxye = (float *) malloc(ndim*nxe*nypmx*sizeof(float));
+   qe = (float *) malloc(nxv*nypmx*sizeof(float));
+   fxye = (float *) malloc(ndim*nxv*nypmx*sizeof(float));
    qt = (float complex *) malloc(nye*kxp*sizeof(float complex));
    fxyt = (float complex *) malloc(ndim*nye*kxp*sizeof(float complex));
    ffc = (float complex *) malloc(nyh*kxp*sizeof(float complex));
@@ -158,24 +282,88 @@ int main(int argc, char *argv[]) {
    npic = (int *) malloc(nypmx*sizeof(int));
 
 /* allocate data for MPI code */
-   bs = (float complex *) malloc(ndim*kxp*kyp*sizeof(float complex));
-   br = (float complex *) malloc(ndim*kxp*kyp*sizeof(float complex));
+/* transpose buffers hold all the chunks in flight if ktpose > 0 */
+   nbt = kxp*kyp;
+   nct = 1;
+   if (ktpose > 0) {
+      nct = ktpose==2 ? nch : 1;
+      nbt = kxp*((kyp - 1)/nct + 1);
+      j = kyp*((kxp - 1)/nct + 1);
+      nbt = nvp*nct*(nbt > j ? nbt : j);
+   }
+   bs = (float complex *) malloc(ndim*nbt*sizeof(float complex));
+   br = (float complex *) malloc(ndim*nbt*sizeof(float complex));
+   mtcnt = (int *) malloc(4*nvp*nct*sizeof(int));
    sbufl = (float *) malloc(idimp*nbmax*sizeof(float));
    sbufr = (float *) malloc(idimp*nbmax*sizeof(float));
    rbufl = (float *) malloc(idimp*nbmax*sizeof(float));
    rbufr = (float *) malloc(idimp*nbmax*sizeof(float));
    scr = (float *) malloc(nxe*2*sizeof(float));
+/* fields in uniform partition are separate only if load balancing */
+/* or with 2D decomposition */
+   if ((nbal > 0) || (idds==2)) {
+      qu = (float *) malloc(nxe*nypmu*sizeof(float));
+      fxyu = (float *) malloc(ndim*nxe*nypmu*sizeof(float));
+      dpro = (float *) malloc(2*ny*sizeof(float));
+      dscr = (float *) malloc(2*ny*sizeof(float));
+      mcnt = (int *) malloc(12*nvp*sizeof(int));
+   }
+   else {
+      qu = qe;
+      fxyu = fxye;
+   }
+
+   if (idds==2) {
+      scs = (float *) malloc(2*ndim*nypmx*sizeof(float));
+      nfb = nxe*nypmu > nxv*nypmx ? nxe*nypmu : nxv*nypmx;
+      fbufs = (float *) malloc(ndim*nfb*sizeof(float));
+      fbufr = (float *) malloc(ndim*nfb*sizeof(float));
+   }
 
 /* prepare fft tables */
    cwpfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
 /* calculate form factors */
    isign = 0;
    cppois22(qt,fxyt,isign,ffc,ax,ay,affp,&we,nx,ny,kstrt,nye,kxp,nyh);
+/* decomposition recorded in checkpoint files */
+   idec[0] = nx; idec[1] = ny; idec[2] = idimp; idec[3] = idds;
+   idec[4] = nvpx; idec[5] = nvpy;
 /* initialize electrons */
    nps = 1;
    npp = 0;
-   cpdistr2(part,edges,&npp,nps,vtx,vty,vx0,vy0,npx,npy,nx,ny,idimp,
-            npmax,idps,ipbc,&ierr);
+   if (krst==0) {
+      if (idds==1)
+         cpdistr2(part,edges,&npp,nps,vtx,vty,vx0,vy0,npx,npy,nx,ny,
+                  idimp,npmax,idps,ipbc,&ierr);
+      else
+         cpdistr2xy(part,edges,&npp,nps,vtx,vty,vx0,vy0,npx,npy,nx,ny,
+                    idimp,npmax,idps,ipbc,&ierr);
+   }
+/* restart from checkpoint files: updates ntime, part, npp, edges, */
+/* noff, nyp, nbals */
+   else {
+      ierr = cchkread(chkfile,idproc,nvp,&ntime,6,idec);
+      if (ierr==0)
+         ierr = cchkgeti(ichk,4,&j);
+      if (ierr==0)
+         ierr = cchkgetf(edges,idps,&j);
+      if (ierr==0) {
+         npp = ichk[0]; noff = ichk[1]; nyp = ichk[2]; nbals = ichk[3];
+         ierr = cchkgetf(part,idimp*npmax,&j);
+         if ((ierr==0) && (j != idimp*npp))
+            ierr = 1;
+      }
+      cchkclose();
+      iwork[0] = ierr;
+      cppimax(iwork,ihmax,1);
+      ierr = iwork[0];
+      if (kstrt==1) {
+         if (ierr==0)
+            printf("restart from %s at ntime=%d\n",chkfile,ntime);
+         else
+            printf("restart error: chkfile=%s\n",chkfile);
+      }
+   }
 /* check for particle initialization error */
    if (ierr != 0) {
       if (kstrt==1) {
@@ -184,40 +372,150 @@ int main(int argc, char *argv[]) {
       goto L3000;
    }
 
+/* open file for timings on node 0 */
+   if ((kstrt==1) && ((kperf > 0) || (nperf > 0))) {
+      if (cperfopen(perffile,kperf,nperf,7,phnames,3,cnames) != 0) {
+         printf("cperfopen error: kperf, perffile=%d,%s\n",kperf,
+                perffile);
+         kperf = 0;
+         nperf = 0;
+      }
+   }
+
 /* * * * start main iteration loop * * * */
 
 L500: if (nloop <= ntime)
          goto L2000;
+/* phase times for this time step, written by cperfstep */
+      for (j = 0; j < 7; j++) {
+         tperf[j] = 0.0;
+      }
 /*    if (kstrt==1) printf("ntime = %i\n",ntime); */
 
+/* repartition to balance load: updates part, npp, edges, nyp, noff */
+      if (nbal > 0) {
+         if (ntime%nbal==0) {
+            dtimer(&dtime,&itime,-1);
+/* find load: number of particles, or push time since last check */
+            ltime = (kbal==2) && (ntime > 0);
+            dlb[0] = ltime ? (double) tbpush : (double) npp;
+            dlb[1] = (double) npp;
+            dmx[0] = dlb[0];
+            dmx[1] = dlb[1];
+            cppdsum(dlb,dwk,2);
+            cppdmax(dmx,dwk,2);
+            abal = dlb[0] > 0.0 ? dmx[0]*(double) nvp/dlb[0] : 1.0;
+            if (abal > tbal) {
+               if (kstrt==1) {
+                  printf("repartition at ntime=%d, load imbalance=%f\n",
+                         ntime,abal);
+                  printf("particle imbalance before=%f",
+                         dmx[1]*(double) nvp/dlb[1]);
+               }
+/* find new partition, each particle weighted by its push time */
+/* each new partition has at most nplim particles                */
+               wtp = 1.0;
+               if (ltime)
+                  wtp = npp > 0 ? tbpush/(float) npp : 0.0;
+               noffo = noff;
+               cpdbcomp2l(part,edges,&nyp,&noff,dpro,dscr,wtp,npp,ny,
+                          kstrt,nvp,idimp,npmax,idps,nypmx,nplim,&irc);
+/* skip migration if no partition has changed */
+               iwork[0] = noff != noffo;
+               cppimax(iwork,ihmax,1);
+               if (iwork[0]==0) {
+                  if (kstrt==1) {
+                     if (irc > 0)
+                        printf(", unchanged: %d particles > nplim\n",
+                               irc);
+                     else
+                        printf(", partition unchanged\n");
+                  }
+               }
+               else {
+/* move particles into new partitions, at most nbmax particles */
+/* are sent to each neighbor in each pass                      */
+                  do {
+                     cppholes2(part,edges,npp,ihole,idimp,npmax,idps,
+                               nbmax,ntmax,&irc);
+                     cppmove2(part,edges,&npp,sbufr,sbufl,rbufr,rbufl,
+                              ihole,ny,kstrt,nvp,idimp,npmax,idps,nbmax,
+                              ntmax,info);
+                     if (info[0] != 0)
+                        break;
+                     iwork[0] = irc;
+                     cppimax(iwork,ihmax,1);
+                  } while (iwork[0] > 0);
+                  if (info[0] != 0) {
+                     ierr = info[0];
+                     if (kstrt==1) {
+                        printf("\nparticle manager error: ierr=%d\n",
+                               ierr);
+                     }
+                     goto L3000;
+                  }
+                  dmx[1] = (double) npp;
+                  cppdmax(&dmx[1],dwk,1);
+                  if (kstrt==1) {
+                     printf(", after=%f\n",dmx[1]*(double) nvp/np);
+                  }
+                  nbals += 1;
+               }
+            }
+            tbpush = 0.0;
+            dtimer(&dtime,&itime,1);
+            time = (float) dtime;
+            tmov += time;
+            tperf[6] += dtime;
+         }
+      }
+
 /* deposit charge with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
-      for (j = 0; j < nxe*nypmx; j++) {
+      for (j = 0; j < nxv*nypmx; j++) {
          qe[j] = 0.0;
       }
-      cppgpost2l(part,qe,npp,noff,qme,idimp,npmax,nxe,nypmx);
+      if (idds==1)
+         cppgpost2l(part,qe,npp,noff,qme,idimp,npmax,nxe,nypmx);
+      else
+         cppgpost2xyl(part,qe,npp,noffxy,qme,idimp,npmax,nxv,nypmx);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdpost += time;
+      tperf[0] += dtime;
 
 /* add guard cells with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
-      cppaguard2xl(qe,nyp,nx,nxe,nypmx);
-      cppnaguard2l(qe,scr,nyp,nx,kstrt,nvp,nxe,nypmx);
+      if (idds==1) {
+         cppaguard2xl(qe,nyp,nx,nxe,nypmx);
+         cppnaguard2l(qe,scr,nyp,nx,kstrt,nvp,nxe,nypmx);
+      }
+      else
+         cppnaguard2xyl(qe,scs,scr,nxyp,kstrt,nvpx,nvpy,nxv,nypmx);
+/* move charge to uniform partition for fft */
+      if (nbal > 0)
+         cppfmove2(qe,qu,noff,nyp,noffu,nypu,kstrt,nvp,nxe,mcnt);
+      else if (idds==2)
+         cppfmove2xy(qe,qu,fbufs,fbufr,noffxy,nxyp,noffuxy,nxypu,kstrt,
+                     nvp,1,nxv,nxe,mcnt);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* transform charge to fourier space with standard procedure: updates qt */
 /* modifies qe */
       dtimer(&dtime,&itime,-1);
       isign = -1;
-      cwppfft2r((float complex *)qe,qt,bs,br,isign,ntpose,mixup,sct,&ttp,
-                indx,indy,kstrt,nvp,nxeh,nye,kxp,kyp,nypmx,nxhy,nxyh);
+      cwppfft2ra((float complex *)qu,qt,bs,br,isign,ntpose,ktpose,nch,
+                 mixup,sct,&ttp,indx,indy,kstrt,nvp,nxeh,nye,kxp,kyp,
+                 nypmu,nxhy,nxyh,mtcnt);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft[0] += time;
+      tperf[2] += dtime;
       tfft[1] += ttp;
+      tperf[3] += ttp;
 
 /* calculate force/charge in fourier space with standard procedure: */
 /* updates fxyt, we */
@@ -227,35 +525,55 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
+      tperf[4] += dtime;
 
 /* transform force to real space with standard procedure: updates fxye */
 /* modifies fxyt */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      cwppfft2r2((float complex *)fxye,fxyt,bs,br,isign,ntpose,mixup,sct,
-                 &ttp,indx,indy,kstrt,nvp,nxeh,nye,kxp,kyp,nypmx,nxhy,
-                 nxyh);
+      cwppfft2r2a((float complex *)fxyu,fxyt,bs,br,isign,ntpose,ktpose,
+                  nch,mixup,sct,&ttp,indx,indy,kstrt,nvp,nxeh,nye,kxp,
+                  kyp,nypmu,nxhy,nxyh,mtcnt);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft[0] += time;
+      tperf[2] += dtime;
       tfft[1] += ttp;
+      tperf[3] += ttp;
 
 /* copy guard cells with standard procedure: updates fxye */
       dtimer(&dtime,&itime,-1);
-      cppncguard2l(fxye,nyp,kstrt,nvp,nnxe,nypmx);
-      cppcguard2xl(fxye,nyp,nx,ndim,nxe,nypmx);
+/* move force from uniform partition used by fft */
+      if (nbal > 0)
+         cppfmove2(fxyu,fxye,noffu,nypu,noff,nyp,kstrt,nvp,nnxe,mcnt);
+      if (idds==1) {
+         cppncguard2l(fxye,nyp,kstrt,nvp,nnxe,nypmx);
+         cppcguard2xl(fxye,nyp,nx,ndim,nxe,nypmx);
+      }
+      else {
+         cppfmove2xy(fxyu,fxye,fbufs,fbufr,noffuxy,nxypu,noffxy,nxyp,
+                     kstrt,nvp,ndim,nxe,nxv,mcnt);
+         cppncguard2xyl(fxye,scs,nxyp,kstrt,nvpx,nvpy,ndim,nxv,nypmx);
+      }
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* push particles: updates part, wke, and ihole */
       dtimer(&dtime,&itime,-1);
       wke = 0.0;
-      cppgpush2l(part,fxye,edges,npp,noff,ihole,qbme,dt,&wke,nx,ny,idimp,
-                 npmax,nxe,nypmx,idps,ntmax,ipbc);
+      if (idds==1)
+         cppgpush2l(part,fxye,edges,npp,noff,ihole,qbme,dt,&wke,nx,ny,
+                    idimp,npmax,nxe,nypmx,idps,ntmax,ipbc);
+      else
+         cppgpush2xyl(part,fxye,edges,npp,noffxy,ihole,qbme,dt,&wke,nx,
+                      ny,idimp,npmax,nxv,nypmx,idps,ntmax,ipbc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
+      tperf[5] += dtime;
+      tbpush += time;
 /* check for ihole overflow error */
       if (ihole[0] < 0) {
          ierr = -ihole[0];
@@ -264,12 +582,18 @@ L500: if (nloop <= ntime)
          goto L3000;
       }
 /* move electrons into appropriate spatial regions: updates part, npp */
+      nhole = ihole[0];
       dtimer(&dtime,&itime,-1);
-      cppmove2(part,edges,&npp,sbufr,sbufl,rbufr,rbufl,ihole,ny,kstrt,nvp,
-               idimp,npmax,idps,nbmax,ntmax,info);
+      if (idds==1)
+         cppmove2(part,edges,&npp,sbufr,sbufl,rbufr,rbufl,ihole,ny,kstrt,
+                  nvp,idimp,npmax,idps,nbmax,ntmax,info);
+      else
+         cppmove2xy(part,edges,&npp,sbufr,sbufl,rbufr,rbufl,ihole,nx,ny,
+                    kstrt,nvpx,nvpy,idimp,npmax,idps,nbmax,ntmax,info);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tmov += time;
+      tperf[6] += dtime;
 /* check for particle manager error */
       if (info[0] != 0) {
          ierr = info[0];
@@ -291,6 +615,7 @@ L500: if (nloop <= ntime)
             dtimer(&dtime,&itime,1);
             time = (float) dtime;
             tsort += time;
+            tperf[6] += dtime;
          }
       }
 
@@ -302,6 +627,21 @@ L500: if (nloop <= ntime)
       cppdsum(wtot,work,4);
       we = wtot[0];
       wke = wtot[1];
+
+/* record timings and counters for this time step: total particles */
+/* leaving nodes, maximum leaving one node, and max/mean particles */
+      if ((kperf > 0) || (nperf > 0)) {
+         dmove[0] = (double) nhole;
+         cppdsum(dmove,dwork,1);
+         ihmax[0] = nhole;
+         cppimax(ihmax,iwork,1);
+         if (kstrt==1) {
+            cperf[0] = (float) dmove[0];
+            cperf[1] = (float) ihmax[0];
+            cperf[2] = (float) (((double) info[1])*((double) nvp)/np);
+            cperfstep(ntime,tperf,cperf);
+         }
+      }
       if (ntime==0) {
          if (kstrt==1) {
             printf("Initial Field, Kinetic and Total Energies:\n");
@@ -309,14 +649,35 @@ L500: if (nloop <= ntime)
          }
       }
       ntime += 1;
+/* write checkpoint files in the background: copies part */
+      if ((nchk > 0) && (ntime%nchk==0)) {
+         if (cchkwait() != 0)
+            printf("%d,checkpoint write error\n",kstrt);
+         ichk[0] = npp; ichk[1] = noff; ichk[2] = nyp; ichk[3] = nbals;
+         irc = cchkopen(chkfile,idproc,nvp,ntime,6,idec);
+         if (irc==0)
+            irc = cchkaddi(ichk,4);
+         if (irc==0)
+            irc = cchkaddf(edges,idps);
+         if (irc==0)
+            irc = cchkaddf(part,idimp*npp);
+         if (irc==0)
+            irc = cchkwrite();
+         if (irc != 0)
+            printf("%d,checkpoint error: ntime=%d\n",kstrt,ntime);
+      }
       goto L500;
 L2000:
 
 /* * * * end main iteration loop * * * */
  
+   if ((kstrt==1) && ((kperf > 0) || (nperf > 0)))
+      cperfclose();
    if (kstrt==1) {
       printf("ntime = %i\n",ntime);
       printf("MPI nodes nvp = %i\n",nvp);
+      if (idds==2)
+         printf("MPI nodes in x, y: nvpx, nvpy = %i,%i\n",nvpx,nvpy);
       printf("Final Field, Kinetic and Total Energies:\n");
       printf("%e %e %e\n",we,wke,wke+we);
 
@@ -327,6 +688,8 @@ L2000:
       printf("fft and transpose time = %f,%f\n",tfft[0],tfft[1]);
       printf("push time = %f\n",tpush);
       printf("particle move time = %f\n",tmov);
+      if (nbal > 0)
+         printf("number of repartitions = %d\n",nbals);
       printf("sort time = %f\n",tsort);
       tfield += tguard + tfft[0];
       printf("total solver time = %f\n",tfield);
@@ -345,6 +708,8 @@ L2000:
    }
 
 L3000:
+   if (cchkwait() != 0)
+      printf("%d,checkpoint write error\n",kstrt);
    cppexit();
    return 0;
 }
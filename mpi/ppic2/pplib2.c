@@ -19,13 +19,35 @@
    cppnacguard2lL adds guard cells in y for vector array, linear
                   interpolation, and distributed data with non-uniform
                   partition.
+   cppncguard2xyl copies data to guard cells in x and y for vector
+                  data, linear interpolation, and distributed data with
+                  2D spatial decomposition.
+   cppnaguard2xyl adds guard cells in x and y for scalar array, linear
+                  interpolation, and distributed data with 2D spatial
+                  decomposition.
    cpptpose performs a transpose of a complex scalar array, distributed
             in y, to a complex scalar array, distributed in x.
    cppntpose performs a transpose of an n component complex vector array,
             distributed in y, to an n component complex vector array,
             distributed in x.
+   cppatpose performs a transpose of an n component complex vector array,
+             distributed in y, to an n component complex vector array,
+             distributed in x, with a collective all-to-all operation.
+   cppatposes starts a non-blocking transpose of a chunk of rows of an
+              n component complex vector array, distributed in y.
+   cppatposew waits for the chunks started by cppatposes and inserts
+              them into an n component complex vector array,
+              distributed in x.
    cppmove2 moves particles into appropriate spatial regions with periodic
             boundary conditions.  Assumes ihole list has been found.
+   cppmove2xy moves particles into appropriate spatial regions with
+              periodic boundary conditions and 2D spatial decomposition.
+              Assumes ihole list has been found.
+   cppfmove2 moves field data between two partitions, for example from a
+             non-uniform partition to a uniform one.
+   cppfmove2xy moves field data between two partitions in x and y, for
+               example from a 2D spatial decomposition to the uniform
+               partition in y used by the fft.
    written by viktor k. decyk, ucla
    copyright 1995, regents of the university of california
    update: april 21, 2013                                         */
@@ -54,6 +76,9 @@ static MPI_Op msum, mmax;
 
 static FILE *unit2 = NULL;
 
+/* mtreq = requests for chunks being transposed by cppatposes */
+static MPI_Request mtreq[16];
+
 float vresult(float prec) {
    float vresult;
    vresult = prec;
@@ -413,6 +438,183 @@ local data */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppncguard2xyl(float f[], float scs[], int nxyp[], int kstrt,
+                    int nvpx, int nvpy, int ndim, int nxv, int nypmx) {
+/* this subroutine copies data to guard cells in non-uniform partitions
+   f[k][j][0:ndim-1] = real data for grid j,k in particle partition.
+   the grid is non-uniform and includes one extra guard cell in x and y.
+   guard cells in x are copied first, so that the corner guard cell is
+   copied with the guard cells in y.
+   output: f, scs
+   scs = scratch array for particle partition, of size 2*ndim*nypmx
+   nxyp[0:1] = number of primary gridpoints in x/y in particle partition
+   it is assumed the nxyp > 0.
+   kstrt = starting data block number
+   nvpx/nvpy = number of real or virtual processors in x/y
+   ndim = leading dimension of array f
+   nxv = second dimension of f, must be >= nxyp[0]+1
+   nypmx = maximum size of particle partition in y, including guard cells
+   linear interpolation, for distributed data,
+   with 2D spatial decomposition
+local data */
+   int i, k, js, ks, nxp, nyp, nnxv, moff, kl, kr, ierr;
+   MPI_Request msid;
+   MPI_Status istatus;
+   nxp = nxyp[0];
+   nyp = nxyp[1];
+   nnxv = ndim*nxv;
+/* js/ks = processor co-ordinates in x/y => idproc = js + nvpx*ks */
+   ks = (kstrt - 1)/nvpx;
+   js = kstrt - nvpx*ks - 1;
+   moff = nypmx*nvpx*nvpy + 2;
+/* copy guard cells in x */
+/* special case for one processor in x */
+   if (nvpx==1) {
+      for (k = 0; k < nyp; k++) {
+         for (i = 0; i < ndim; i++) {
+            f[i+ndim*nxp+nnxv*k] = f[i+nnxv*k];
+         }
+      }
+   }
+/* this segment is used for mpi computers */
+   else {
+      kr = js + 1;
+      if (kr >= nvpx)
+         kr = kr - nvpx;
+      kr += nvpx*ks;
+      kl = js - 1;
+      if (kl < 0)
+         kl = kl + nvpx;
+      kl += nvpx*ks;
+      for (k = 0; k < nyp; k++) {
+         for (i = 0; i < ndim; i++) {
+            scs[i+ndim*k] = f[i+nnxv*k];
+         }
+      }
+      ierr = MPI_Irecv(&scs[ndim*nypmx],ndim*nyp,mreal,kr,moff,lgrp,
+                       &msid);
+      ierr = MPI_Send(scs,ndim*nyp,mreal,kl,moff,lgrp);
+      ierr = MPI_Wait(&msid,&istatus);
+      for (k = 0; k < nyp; k++) {
+         for (i = 0; i < ndim; i++) {
+            f[i+ndim*nxp+nnxv*k] = scs[i+ndim*(k+nypmx)];
+         }
+      }
+   }
+/* copy guard cells in y, including corner */
+/* special case for one processor in y */
+   if (nvpy==1) {
+      for (i = 0; i < ndim*(nxp+1); i++) {
+         f[i+nnxv*nyp] = f[i];
+      }
+   }
+/* this segment is used for mpi computers */
+   else {
+      kr = ks + 1;
+      if (kr >= nvpy)
+         kr = kr - nvpy;
+      kr = js + nvpx*kr;
+      kl = ks - 1;
+      if (kl < 0)
+         kl = kl + nvpy;
+      kl = js + nvpx*kl;
+      ierr = MPI_Irecv(&f[nnxv*nyp],ndim*(nxp+1),mreal,kr,moff+1,lgrp,
+                       &msid);
+      ierr = MPI_Send(f,ndim*(nxp+1),mreal,kl,moff+1,lgrp);
+      ierr = MPI_Wait(&msid,&istatus);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppnaguard2xyl(float f[], float scs[], float scr[], int nxyp[],
+                    int kstrt, int nvpx, int nvpy, int nxv, int nypmx) {
+/* this subroutine adds data from guard cells in non-uniform partitions
+   f[k][j] = real data for grid j,k in particle partition.
+   the grid is non-uniform and includes one extra guard cell in x and y.
+   guard cells in x are added first, so that the corner guard cell is
+   added with the guard cells in y.
+   output: f, scs, scr
+   scs = scratch array for particle partition, of size 2*nypmx
+   scr = scratch array for particle partition, of size nxv
+   nxyp[0:1] = number of primary gridpoints in x/y in particle partition
+   it is assumed the nxyp > 0.
+   kstrt = starting data block number
+   nvpx/nvpy = number of real or virtual processors in x/y
+   nxv = first dimension of f, must be >= nxyp[0]+1
+   nypmx = maximum size of particle partition in y, including guard cells
+   linear interpolation, for distributed data,
+   with 2D spatial decomposition
+local data */
+   int j, k, js, ks, nxp, nyp, nyp1, moff, kl, kr, ierr;
+   MPI_Request msid;
+   MPI_Status istatus;
+   nxp = nxyp[0];
+   nyp = nxyp[1];
+   nyp1 = nyp + 1;
+/* js/ks = processor co-ordinates in x/y => idproc = js + nvpx*ks */
+   ks = (kstrt - 1)/nvpx;
+   js = kstrt - nvpx*ks - 1;
+   moff = nypmx*nvpx*nvpy + 1;
+/* add guard cells in x, including corner */
+/* special case for one processor in x */
+   if (nvpx==1) {
+      for (k = 0; k < nyp1; k++) {
+         f[nxv*k] += f[nxp+nxv*k];
+         f[nxp+nxv*k] = 0.0;
+      }
+   }
+/* this segment is used for mpi computers */
+   else {
+      kr = js + 1;
+      if (kr >= nvpx)
+         kr = kr - nvpx;
+      kr += nvpx*ks;
+      kl = js - 1;
+      if (kl < 0)
+         kl = kl + nvpx;
+      kl += nvpx*ks;
+      for (k = 0; k < nyp1; k++) {
+         scs[k] = f[nxp+nxv*k];
+         f[nxp+nxv*k] = 0.0;
+      }
+      ierr = MPI_Irecv(&scs[nypmx],nyp1,mreal,kl,moff,lgrp,&msid);
+      ierr = MPI_Send(scs,nyp1,mreal,kr,moff,lgrp);
+      ierr = MPI_Wait(&msid,&istatus);
+      for (k = 0; k < nyp1; k++) {
+         f[nxv*k] += scs[k+nypmx];
+      }
+   }
+/* add guard cells in y */
+/* special case for one processor in y */
+   if (nvpy==1) {
+      for (j = 0; j < nxp; j++) {
+         f[j] += f[j+nxv*nyp];
+         f[j+nxv*nyp] = 0.0;
+      }
+   }
+/* this segment is used for mpi computers */
+   else {
+      kr = ks + 1;
+      if (kr >= nvpy)
+         kr = kr - nvpy;
+      kr = js + nvpx*kr;
+      kl = ks - 1;
+      if (kl < 0)
+         kl = kl + nvpy;
+      kl = js + nvpx*kl;
+      ierr = MPI_Irecv(scr,nxp,mreal,kl,moff+1,lgrp,&msid);
+      ierr = MPI_Send(&f[nxv*nyp],nxp,mreal,kr,moff+1,lgrp);
+      ierr = MPI_Wait(&msid,&istatus);
+      for (j = 0; j < nxp; j++) {
+         f[j] += scr[j];
+         f[j+nxv*nyp] = 0.0;
+      }
+   }
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpptpose(float complex f[], float complex g[], float complex s[],
               float complex t[], int nx, int ny, int kxp, int kyp,
@@ -606,49 +808,191 @@ local data */
 }
 
 /*--------------------------------------------------------------------*/
-void cppmove2(float part[], float edges[], int *npp, float sbufr[],
-              float sbufl[], float rbufr[], float rbufl[], int ihole[],
-              int ny, int kstrt, int nvp, int idimp, int npmax, int idps,
-              int nbmax, int ntmax, int info[]) {
-/* this subroutine moves particles into appropriate spatial regions
-   periodic boundary conditions
-   output: part, npp, sbufr, sbufl, rbufr, rbufl, info
-   part[n][0] = position x of particle n in partition
-   part[n][1] = position y of particle n in partition
-   part[n][2] = velocity vx of particle n in partition
-   part[n][3] = velocity vy of particle n in partition
-   edges[0:1] = lower:lower boundary of particle partition
-   npp = number of particles in partition
-   sbufl = buffer for particles being sent to lower processor
-   sbufr = buffer for particles being sent to upper processor
-   rbufl = buffer for particles being received from lower processor
-   rbufr = buffer for particles being received from upper processor
-   ihole = location of holes left in particle arrays
-   ny = system length in y direction
+void cppatpose(float complex f[], float complex g[], float complex s[],
+               float complex t[], int nx, int ny, int kxp, int kyp,
+               int kstrt, int nvp, int ndim, int nxv, int nyv, int kxpd,
+               int kypd, int mcnt[]) {
+/* this subroutine performs a transpose of a matrix f, distributed in y,
+   to a matrix g, distributed in x, that is,
+   g[l][j][k+kyp*m][1:ndim] = f[m][k][j+kxp*l][1:ndim], where
+   0 <= j < kxp, 0 <= k < kyp, 0 <= l < nx/kxp, 0 <= m < ny/kyp
+   and where indices l and m can be distributed across processors.
+   this subroutine exchanges all the blocks at once with a single
+   collective all-to-all operation, instead of one message at a time
+   as in cppntpose.  it uses more system resources
+   f = complex input array
+   g = complex output array
+   s, t = complex scratch arrays, of size ndim*kxp*kyp*nvp
+   nx/ny = number of points in x/y
+   kxp/kyp = number of data values per block in x/y
    kstrt = starting data block number
    nvp = number of real or virtual processors
-   idimp = size of phase space = 4
-   npmax = maximum number of particles in each partition.
-   idps = number of partition boundaries
-   nbmax =  size of buffers for passing particles between processors
-   ntmax =  size of hole array for particles leaving processors
-   info = status information
-   info[0] = ierr = (0,N) = (no,yes) error condition exists
-   info[1] = maximum number of particles per processor
-   info[2] = minimum number of particles per processor
-   info[3] = maximum number of buffer overflows
-   info[4] = maximum number of particle passes required
+   ndim = leading dimension of arrays f and g
+   nxv/nyv = first dimension of f/g
+   kypd/kxpd = second dimension of f/g
+   mcnt = scratch array, of size 4*nvp
 local data */
-/* iy = partitioned co-ordinate */
-   int iy = 1;
-   int ierr, ks, ih, iter, nps, itg, kl, kr, j, j1, j2, i;
+   cppatposes(f,s,t,nx,ny,kxp,kyp,kstrt,nvp,ndim,nxv,kyp,0,mcnt);
+   cppatposew(g,t,nx,ny,kxp,kyp,kstrt,nvp,ndim,nyv,kyp,1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppatposes(float complex f[], float complex s[], float complex t[],
+                int nx, int ny, int kxp, int kyp, int kstrt, int nvp,
+                int ndim, int nxv, int kch, int ic, int mcnt[]) {
+/* this subroutine starts the transpose of chunk ic of a matrix f,
+   distributed in y, to a matrix g, distributed in x, as in cppatpose.
+   chunk ic consists of local rows kch*ic <= k < kch*(ic+1) of f, so that
+   the transpose of one chunk can proceed while the next one is being
+   computed.  data is sent and received with a non-blocking all-to-all
+   operation which is completed by cppatposew.  f and s must not be
+   modified and t must not be used until then
+   f = complex input array
+   s, t = complex scratch arrays, of size ndim*kxp*kch*nvp*(ic+1)
+   nx/ny = number of points in x/y
+   kxp/kyp = number of data values per block in x/y
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   ndim = leading dimension of array f
+   nxv = first dimension of f
+   kch = number of rows of f per chunk, the same on all processors
+   ic = chunk number, 0 <= ic < 16
+   mcnt = scratch array, of size 4*nvp*(ic+1)
+local data */
+   int i, j, k, l, m, ks, kyps, k0, k1, joff, ld, kd, nnxv, nblk, ierr;
+   int soff;
+   int *scnt, *sdsp, *rcnt, *rdsp;
+   ks = kstrt - 1;
+   kyps = ny - kyp*ks;
+   kyps = 0 > kyps ? 0 : kyps;
+   kyps = kyp < kyps ? kyp : kyps;
+   nnxv = ndim*nxv;
+   nblk = ndim*kxp*kch;
+   soff = nblk*nvp*ic;
+   scnt = &mcnt[4*nvp*ic];
+   sdsp = &mcnt[4*nvp*ic+nvp];
+   rcnt = &mcnt[4*nvp*ic+2*nvp];
+   rdsp = &mcnt[4*nvp*ic+3*nvp];
+/* rows of f in this chunk */
+   k0 = kch*ic;
+   k1 = k0 + kch;
+   k1 = kyps < k1 ? kyps : k1;
+   kd = k1 - k0;
+   kd = 0 > kd ? 0 : kd;
+/* extract data to send to each processor */
+   for (l = 0; l < nvp; l++) {
+      joff = kxp*l;
+      ld = nx - joff;
+      ld = 0 > ld ? 0 : ld;
+      ld = kxp < ld ? kxp : ld;
+      for (k = 0; k < kd; k++) {
+         for (j = 0; j < ld; j++) {
+            for (i = 0; i < ndim; i++) {
+               s[i+ndim*(j+ld*k)+nblk*l+soff]
+               = f[i+ndim*(j+joff)+nnxv*(k+k0)];
+            }
+         }
+      }
+      scnt[l] = ndim*ld*kd;
+      sdsp[l] = nblk*l;
+   }
+/* size of data received from each processor */
+   ld = nx - kxp*ks;
+   ld = 0 > ld ? 0 : ld;
+   ld = kxp < ld ? kxp : ld;
+   for (m = 0; m < nvp; m++) {
+      kd = ny - kyp*m;
+      kd = 0 > kd ? 0 : kd;
+      kd = kyp < kd ? kyp : kd;
+      kd = (kd < (k0 + kch) ? kd : (k0 + kch)) - k0;
+      kd = 0 > kd ? 0 : kd;
+      rcnt[m] = ndim*ld*kd;
+      rdsp[m] = nblk*m;
+   }
+/* this segment is used for mpi computers */
+   ierr = MPI_Ialltoallv(&s[soff],scnt,sdsp,mcplx,&t[soff],rcnt,rdsp,
+                         mcplx,lgrp,&mtreq[ic]);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppatposew(float complex g[], float complex t[], int nx, int ny,
+                int kxp, int kyp, int kstrt, int nvp, int ndim, int nyv,
+                int kch, int nch) {
+/* this subroutine waits for the transposes of chunks 0 <= ic < nch
+   started by cppatposes to complete, and inserts the data received into
+   the matrix g, distributed in x, that is,
+   g[l][j][k+kyp*m][1:ndim] = f[m][k][j+kxp*l][1:ndim]
+   g = complex output array
+   t = complex scratch array, of size ndim*kxp*kch*nvp*nch
+   nx/ny = number of points in x/y
+   kxp/kyp = number of data values per block in x/y
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   ndim = leading dimension of array g
+   nyv = first dimension of g
+   kch = number of rows of f per chunk, as in cppatposes
+   nch = number of chunks started
+local data */
+   int i, j, k, m, ic, ks, kxps, k0, kd, koff, nnyv, nblk, toff, ierr;
+   ks = kstrt - 1;
+   kxps = nx - kxp*ks;
+   kxps = 0 > kxps ? 0 : kxps;
+   kxps = kxp < kxps ? kxp : kxps;
+   nnyv = ndim*nyv;
+   nblk = ndim*kxp*kch;
+/* wait for all chunks to arrive */
+   ierr = MPI_Waitall(nch,mtreq,MPI_STATUSES_IGNORE);
+/* insert data received */
+   for (ic = 0; ic < nch; ic++) {
+      k0 = kch*ic;
+      toff = nblk*nvp*ic;
+      for (m = 0; m < nvp; m++) {
+         koff = kyp*m;
+         kd = ny - koff;
+         kd = 0 > kd ? 0 : kd;
+         kd = kyp < kd ? kyp : kd;
+         kd = (kd < (k0 + kch) ? kd : (k0 + kch)) - k0;
+         for (k = 0; k < kd; k++) {
+            for (j = 0; j < kxps; j++) {
+               for (i = 0; i < ndim; i++) {
+                  g[i+ndim*(k+k0+koff)+nnyv*j]
+                  = t[i+ndim*(j+kxps*k)+nblk*m+toff];
+               }
+            }
+         }
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+static void cppmovec2(float part[], float edges[], int *npp,
+                      float sbufr[], float sbufl[], float rbufr[],
+                      float rbufl[], int ihole[], float an, int ic,
+                      int kc, int nvpd, int kl, int kr, int idimp,
+                      int npmax, int nbmax, int info[]) {
+/* this subroutine moves particles into appropriate spatial regions in
+   one partitioned co-ordinate, between a ring of nvpd processors,
+   with periodic boundary conditions.  used by cppmove2 and cppmove2xy
+   ihole = location of holes left in particle arrays by particles
+   leaving in this co-ordinate
+   edges[0:1] = lower:upper boundary of particle partition in this
+   co-ordinate
+   an = system length in this co-ordinate
+   ic = partitioned co-ordinate, 0 for x, 1 for y
+   kc = processor co-ordinate in the ring
+   nvpd = number of processors in the ring
+   kl/kr = processor ids of the lower/upper neighbors in the ring
+   other arguments and info are as in cppmove2
+local data */
+   int ierr, ih, iter, nps, itg, j, j1, j2, i;
    int joff, jin, nbsize, nter, mter, itermax, mpp;
-   float any, yt;
+   float yt;
    MPI_Request msid[4];
    MPI_Status istatus;
    int jsl[2], jsr[2], jss[2], ibflg[4], iwork[4];
-   any = (float) ny;
-   ks = kstrt - 1;
    nbsize = idimp*nbmax;
    iter = 2;
    nter = 0;
@@ -672,16 +1016,16 @@ L10: mter = 0;
 /* load particle buffers */
    for (j = 0; j < ih; j++) {
       j1 = ihole[j+joff] - 1;
-      yt = part[iy+idimp*j1];
+      yt = part[ic+idimp*j1];
 /* particles going down */
       if (yt < edges[0]) {
-         if (ks==0)
-            yt += any;
+         if (kc==0)
+            yt += an;
          if (jsl[0] < nbmax) {
             for (i = 0; i < idimp; i++) {
                sbufl[i+idimp*jsl[0]] = part[i+idimp*j1];
             }
-            sbufl[iy+idimp*jsl[0]] = yt;
+            sbufl[ic+idimp*jsl[0]] = yt;
             jsl[0] += 1;
          }
          else {
@@ -691,13 +1035,13 @@ L10: mter = 0;
       }
 /* particles going up */
       else {
-         if (ks==(nvp-1))
-            yt -= any;
+         if (kc==(nvpd-1))
+            yt -= an;
          if (jsr[0] < nbmax) {
             for (i = 0; i < idimp; i++) {
                sbufr[i+idimp*jsr[0]] = part[i+idimp*j1];
             }
-            sbufr[iy+idimp*jsr[0]] = yt;
+            sbufr[ic+idimp*jsr[0]] = yt;
             jsr[0] += 1;
          }
          else {
@@ -715,7 +1059,7 @@ L50: jss[0] = jsl[0] + jsr[0];
 L60: iter += 2;
    mter += 1;
 /* special case for one processor */
-   if (nvp==1) {
+   if (nvpd==1) {
       jsl[1] = jsr[0];
       for (j = 0; j < jsl[1]; j++) {
          for (i = 0; i < idimp; i++) {
@@ -732,12 +1076,6 @@ L60: iter += 2;
 /* this segment is used for mpi computers */
    else {
 /* get particles from below and above */
-      kr = ks + 1;
-      if (kr >= nvp)
-         kr -= nvp;
-      kl = ks - 1;
-      if (kl < 0)
-         kl += nvp;
 /* post receive */
       itg = iter - 1;
       ierr = MPI_Irecv(rbufl,nbsize,mreal,kl,itg,lgrp,&msid[0]);
@@ -756,31 +1094,31 @@ L60: iter += 2;
       jsr[1] = nps/idimp;
    }
 /* check if particles must be passed further */
-/* check if any particles coming from above belong here */
+/* check if an particles coming from above belong here */
    jsl[0] = 0;
    jsr[0] = 0;
    jss[1] = 0;
    for (j = 0; j < jsr[1]; j++) {
-      if (rbufr[iy+idimp*j] < edges[0])
+      if (rbufr[ic+idimp*j] < edges[0])
          jsl[0] += 1;
-      if (rbufr[iy+idimp*j] >= edges[1])
+      if (rbufr[ic+idimp*j] >= edges[1])
          jsr[0] += 1;
    }
    if (jsr[0] != 0)
-      fprintf(unit2,"%d,Info: particles returning up\n",ks+1);
-/* check if any particles coming from below belong here */
+      fprintf(unit2,"%d,Info: particles returning up\n",kc+1);
+/* check if an particles coming from below belong here */
    for (j = 0; j < jsl[1]; j++) {
-      if (rbufl[iy+idimp*j] >= edges[1])
+      if (rbufl[ic+idimp*j] >= edges[1])
          jsr[0] += 1;
-      if (rbufl[iy+idimp*j] < edges[0])
+      if (rbufl[ic+idimp*j] < edges[0])
          jss[1] += 1;
    }
    if (jss[1] != 0)
-      fprintf(unit2,"%d,Info: particles returning down\n",ks+1);
+      fprintf(unit2,"%d,Info: particles returning down\n",kc+1);
    nps = jsl[0] + jsr[0] + jss[1];
    ibflg[1] = nps;
 /* make sure sbufr and sbufl have been sent */
-   if (nvp != 1) {
+   if (nvpd != 1) {
       ierr = MPI_Wait(&msid[2],&istatus);
       ierr = MPI_Wait(&msid[3],&istatus);
    }
@@ -792,12 +1130,12 @@ L60: iter += 2;
    jsr[0] = 0;
    jss[1] = 0;
    for (j = 0; j < jsr[1]; j++) {
-      yt = rbufr[iy+idimp*j];
+      yt = rbufr[ic+idimp*j];
 /* particles going down */
       if (yt < edges[0]) {
-         if (ks==0)
-            yt += any;
-         rbufr[iy+idimp*j] = yt;
+         if (kc==0)
+            yt += an;
+         rbufr[ic+idimp*j] = yt;
          for (i = 0; i < idimp; i++) {
             sbufl[i+idimp*jsl[0]] = rbufr[i+idimp*j];
          }
@@ -805,9 +1143,9 @@ L60: iter += 2;
       }
 /* particles going up, should not happen */
       else if (yt >= edges[1]) {
-         if (ks==(nvp-1))
-            yt -= any;
-         rbufr[iy+idimp*j] = yt;
+         if (kc==(nvpd-1))
+            yt -= an;
+         rbufr[ic+idimp*j] = yt;
          for (i = 0; i < idimp; i++) {
             sbufr[i+idimp*jsr[0]] = rbufr[i+idimp*j];
          }
@@ -825,13 +1163,13 @@ L60: iter += 2;
 /* next check particles coming from below */
    jss[1] = 0;
    for (j = 0; j < jsl[1]; j++) {
-      yt = rbufl[iy+idimp*j];
+      yt = rbufl[ic+idimp*j];
 /* particles going up */
       if (yt >= edges[1]) {
          if (jsr[0] < nbmax) {
-            if (ks==(nvp-1))
-               yt -= any;
-            rbufl[iy+idimp*j] = yt;
+            if (kc==(nvpd-1))
+               yt -= an;
+            rbufl[ic+idimp*j] = yt;
             for (i = 0; i < idimp; i++) {
                sbufr[i+idimp*jsr[0]] = rbufl[i+idimp*j];
             }
@@ -845,9 +1183,9 @@ L60: iter += 2;
 /* particles going down, should not happen */
       else if (yt < edges[0]) {
          if (jsl[0] < nbmax) {
-            if (ks==0)
-               yt += any;
-            rbufl[iy+idimp*j] = yt;
+            if (kc==0)
+               yt += an;
+            rbufl[ic+idimp*j] = yt;
             for (i = 0; i < idimp; i++) {
                sbufl[i+idimp*jsl[0]] = rbufl[i+idimp*j];
             }
@@ -952,7 +1290,7 @@ L180: nps = mpp + jsl[1] + jsr[1] - jss[0];
       mpp -= jsr[1];
    }
    jss[0] = 0;
-/* check if any particles have to be passed further */
+/* check if an particles have to be passed further */
    if (ibflg[2] > 0)
       ibflg[2] = 1;
    info[4] = info[4] > mter ? info[4] : mter;
@@ -980,6 +1318,351 @@ L180: nps = mpp + jsl[1] + jsr[1] - jss[0];
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppmove2(float part[], float edges[], int *npp, float sbufr[],
+              float sbufl[], float rbufr[], float rbufl[], int ihole[],
+              int ny, int kstrt, int nvp, int idimp, int npmax, int idps,
+              int nbmax, int ntmax, int info[]) {
+/* this subroutine moves particles into appropriate spatial regions
+   periodic boundary conditions
+   output: part, npp, sbufr, sbufl, rbufr, rbufl, info
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   part[n][2] = velocity vx of particle n in partition
+   part[n][3] = velocity vy of particle n in partition
+   edges[0:1] = lower:lower boundary of particle partition
+   npp = number of particles in partition
+   sbufl = buffer for particles being sent to lower processor
+   sbufr = buffer for particles being sent to upper processor
+   rbufl = buffer for particles being received from lower processor
+   rbufr = buffer for particles being received from upper processor
+   ihole = location of holes left in particle arrays
+   ny = system length in y direction
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition.
+   idps = number of partition boundaries
+   nbmax =  size of buffers for passing particles between processors
+   ntmax =  size of hole array for particles leaving processors
+   info = status information
+   info[0] = ierr = (0,N) = (no,yes) error condition exists
+   info[1] = maximum number of particles per processor
+   info[2] = minimum number of particles per processor
+   info[3] = maximum number of buffer overflows
+   info[4] = maximum number of particle passes required
+local data */
+   int ks, kl, kr;
+   ks = kstrt - 1;
+/* get particles from below and above */
+   kr = ks + 1;
+   if (kr >= nvp)
+      kr -= nvp;
+   kl = ks - 1;
+   if (kl < 0)
+      kl += nvp;
+   cppmovec2(part,edges,npp,sbufr,sbufl,rbufr,rbufl,ihole,(float) ny,1,
+             ks,nvp,kl,kr,idimp,npmax,nbmax,info);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppmove2xy(float part[], float edges[], int *npp, float sbufr[],
+                float sbufl[], float rbufr[], float rbufl[],
+                int ihole[], int nx, int ny, int kstrt, int nvpx,
+                int nvpy, int idimp, int npmax, int idps, int nbmax,
+                int ntmax, int info[]) {
+/* this subroutine moves particles into appropriate spatial regions
+   periodic boundary conditions, with 2D spatial decomposition.
+   particles are first moved in x, between processors with the same
+   partition in y, then in y, between processors with the same
+   partition in x.  the holes left by particles leaving in y are found
+   again after the move in x, since that move reorders the particles.
+   output: part, npp, ihole, sbufr, sbufl, rbufr, rbufl, info
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   part[n][2] = velocity vx of particle n in partition
+   part[n][3] = velocity vy of particle n in partition
+   edges[0:1] = left:right boundary in x of particle partition
+   edges[2:3] = lower:upper boundary in y of particle partition
+   npp = number of particles in partition
+   sbufl = buffer for particles being sent to left/lower processor
+   sbufr = buffer for particles being sent to right/upper processor
+   rbufl = buffer for particles being received from left/lower processor
+   rbufr = buffer for particles being received from right/upper processor
+   ihole = location of holes left in particle arrays, for particles
+   leaving in x or y, as found by cppgpush2xyl
+   nx/ny = system length in x/y direction
+   kstrt = starting data block number
+   nvpx/nvpy = number of real or virtual processors in x/y
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition.
+   idps = number of partition boundaries = 4
+   nbmax =  size of buffers for passing particles between processors
+   ntmax =  size of hole array for particles leaving processors
+   info = status information
+   info[0] = ierr = (0,N) = (no,yes) error condition exists
+   info[1] = maximum number of particles per processor
+   info[2] = minimum number of particles per processor
+   info[3] = maximum number of buffer overflows, in x or y
+   info[4] = maximum number of particle passes required, in x or y
+local data */
+   int j, j1, ih, nh, js, ks, kl, kr, mbuf, mter;
+   float xt, yt;
+   int ibflg[1], iwork[1];
+/* js/ks = processor co-ordinates in x/y => idproc = js + nvpx*ks */
+   ks = (kstrt - 1)/nvpx;
+   js = kstrt - nvpx*ks - 1;
+   mbuf = 0;
+   mter = 0;
+/* move particles in x, if partitioned in x */
+   if (nvpx > 1) {
+/* keep only holes of particles leaving in x */
+      ih = 0;
+      for (j = 0; j < ihole[0]; j++) {
+         j1 = ihole[j+1] - 1;
+         xt = part[idimp*j1];
+         if ((xt < edges[0]) || (xt >= edges[1])) {
+            ihole[ih+1] = j1 + 1;
+            ih += 1;
+         }
+      }
+      ihole[0] = ih;
+      kr = js + 1;
+      if (kr >= nvpx)
+         kr -= nvpx;
+      kr += nvpx*ks;
+      kl = js - 1;
+      if (kl < 0)
+         kl += nvpx;
+      kl += nvpx*ks;
+      cppmovec2(part,edges,npp,sbufr,sbufl,rbufr,rbufl,ihole,(float) nx,
+                0,js,nvpx,kl,kr,idimp,npmax,nbmax,info);
+      if (info[0] != 0)
+         return;
+      mbuf = info[3];
+      mter = info[4];
+/* find holes of particles leaving in y */
+      ih = 0;
+      nh = 0;
+      for (j = 0; j < *npp; j++) {
+         yt = part[1+idimp*j];
+         if ((yt < edges[2]) || (yt >= edges[3])) {
+            if (ih < ntmax)
+               ihole[ih+1] = j + 1;
+            else
+               nh = 1;
+            ih += 1;
+         }
+      }
+      ihole[0] = ih;
+/* check for ihole overflow condition on any processor */
+      ibflg[0] = nh > 0 ? ih - ntmax : 0;
+      cppimax(ibflg,iwork,1);
+      if (ibflg[0] > 0) {
+         fprintf(unit2,"ihole overflow error, ierr = %d\n",ibflg[0]);
+         info[0] = -ibflg[0];
+         return;
+      }
+   }
+/* move particles in y */
+   kr = ks + 1;
+   if (kr >= nvpy)
+      kr -= nvpy;
+   kr = js + nvpx*kr;
+   kl = ks - 1;
+   if (kl < 0)
+      kl += nvpy;
+   kl = js + nvpx*kl;
+   cppmovec2(part,&edges[2],npp,sbufr,sbufl,rbufr,rbufl,ihole,(float) ny,
+             1,ks,nvpy,kl,kr,idimp,npmax,nbmax,info);
+   info[3] = mbuf > info[3] ? mbuf : info[3];
+   info[4] = mter > info[4] ? mter : info[4];
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppfmove2(float f[], float g[], int noff, int nyp, int noffg,
+               int nypg, int kstrt, int nvp, int nxv, int mcnt[]) {
+/* this subroutine moves field data from one partition to another, for
+   example, between a non-uniform particle partition and the uniform
+   partition used by the fft.  each grid row which overlaps the new
+   partition is sent to the processor which owns it.
+   f[k][j] = real data for grid j,k in old partition, input
+   g[k][j] = real data for grid j,k in new partition, output
+   only the primary gridpoints are moved, guard cells are not set.
+   noff/nyp = lowermost global gridpoint/number of primary gridpoints
+   in old partition
+   noffg/nypg = lowermost global gridpoint/number of primary gridpoints
+   in new partition
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   nxv = number of data values in each grid row of f and g
+   mcnt = scratch array, of size 8*nvp
+local data */
+   int j, k0, k1, nvp4, ierr;
+   int *scnt, *sdsp, *rcnt, *rdsp;
+   int ibfl[4];
+/* special case for one processor */
+   if (nvp==1) {
+      for (j = 0; j < nxv*nyp; j++) {
+         g[j] = f[j];
+      }
+      return;
+   }
+   nvp4 = 4*nvp;
+   scnt = &mcnt[nvp4];
+   sdsp = &mcnt[nvp4+nvp];
+   rcnt = &mcnt[nvp4+2*nvp];
+   rdsp = &mcnt[nvp4+3*nvp];
+/* collect both partitions from all processors */
+   ibfl[0] = noff;
+   ibfl[1] = nyp;
+   ibfl[2] = noffg;
+   ibfl[3] = nypg;
+   ierr = MPI_Allgather(ibfl,4,mint,mcnt,4,mint,lgrp);
+   for (j = 0; j < nvp; j++) {
+/* rows of old partition sent to new partition of processor j */
+      k0 = mcnt[2+4*j];
+      k1 = k0 + mcnt[3+4*j];
+      k0 = noff > k0 ? noff : k0;
+      k1 = (noff + nyp) < k1 ? (noff + nyp) : k1;
+      if (k1 > k0) {
+         scnt[j] = nxv*(k1 - k0);
+         sdsp[j] = nxv*(k0 - noff);
+      }
+      else {
+         scnt[j] = 0;
+         sdsp[j] = 0;
+      }
+/* rows of new partition received from old partition of processor j */
+      k0 = mcnt[4*j];
+      k1 = k0 + mcnt[1+4*j];
+      k0 = noffg > k0 ? noffg : k0;
+      k1 = (noffg + nypg) < k1 ? (noffg + nypg) : k1;
+      if (k1 > k0) {
+         rcnt[j] = nxv*(k1 - k0);
+         rdsp[j] = nxv*(k0 - noffg);
+      }
+      else {
+         rcnt[j] = 0;
+         rdsp[j] = 0;
+      }
+   }
+/* this segment is used for mpi computers */
+   ierr = MPI_Alltoallv(f,scnt,sdsp,mreal,g,rcnt,rdsp,mreal,lgrp);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppfmove2xy(float f[], float g[], float s[], float t[], int noff[],
+                 int nxyp[], int noffg[], int nxypg[], int kstrt,
+                 int nvp, int ndim, int nxv, int nxvg, int mcnt[]) {
+/* this subroutine moves field data from one partition in x and y to
+   another, for example, between the partition in x and y used by the
+   particles and the uniform partition in y used by the fft.  each
+   rectangle of gridpoints which overlaps the new partition is packed
+   and sent to the processor which owns it.
+   f[k][j][0:ndim-1] = real data for grid j,k in old partition, input
+   g[k][j][0:ndim-1] = real data for grid j,k in new partition, output
+   only the primary gridpoints are moved, guard cells are not set.
+   s, t = scratch arrays, of size ndim*nxyp[0]*nxyp[1] and
+   ndim*nxypg[0]*nxypg[1]
+   noff[0:1] = leftmost/lowermost global gridpoint in old partition
+   nxyp[0:1] = number of primary gridpoints in x/y in old partition
+   noffg[0:1] = leftmost/lowermost global gridpoint in new partition
+   nxypg[0:1] = number of primary gridpoints in x/y in new partition
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   ndim = leading dimension of arrays f and g
+   nxv/nxvg = second dimension of f/g
+   mcnt = scratch array, of size 12*nvp
+local data */
+   int i, j, k, n, j0, j1, k0, k1, nvp8, ioff, ierr;
+   int *scnt, *sdsp, *rcnt, *rdsp;
+   int ibfl[8];
+   nvp8 = 8*nvp;
+   scnt = &mcnt[nvp8];
+   sdsp = &mcnt[nvp8+nvp];
+   rcnt = &mcnt[nvp8+2*nvp];
+   rdsp = &mcnt[nvp8+3*nvp];
+/* collect both partitions from all processors */
+   ibfl[0] = noff[0];
+   ibfl[1] = nxyp[0];
+   ibfl[2] = noff[1];
+   ibfl[3] = nxyp[1];
+   ibfl[4] = noffg[0];
+   ibfl[5] = nxypg[0];
+   ibfl[6] = noffg[1];
+   ibfl[7] = nxypg[1];
+   ierr = MPI_Allgather(ibfl,8,mint,mcnt,8,mint,lgrp);
+/* extract data to send to new partition of each processor */
+   ioff = 0;
+   for (n = 0; n < nvp; n++) {
+      j0 = mcnt[4+8*n];
+      j1 = j0 + mcnt[5+8*n];
+      k0 = mcnt[6+8*n];
+      k1 = k0 + mcnt[7+8*n];
+      j0 = noff[0] > j0 ? noff[0] : j0;
+      j1 = (noff[0] + nxyp[0]) < j1 ? (noff[0] + nxyp[0]) : j1;
+      k0 = noff[1] > k0 ? noff[1] : k0;
+      k1 = (noff[1] + nxyp[1]) < k1 ? (noff[1] + nxyp[1]) : k1;
+      sdsp[n] = ioff;
+      if ((j1 > j0) && (k1 > k0)) {
+         for (k = k0; k < k1; k++) {
+            for (j = j0; j < j1; j++) {
+               for (i = 0; i < ndim; i++) {
+                  s[ioff+i] = f[i+ndim*(j-noff[0]+nxv*(k-noff[1]))];
+               }
+               ioff += ndim;
+            }
+         }
+      }
+      scnt[n] = ioff - sdsp[n];
+   }
+/* size of data received from old partition of each processor */
+   ioff = 0;
+   for (n = 0; n < nvp; n++) {
+      j0 = mcnt[8*n];
+      j1 = j0 + mcnt[1+8*n];
+      k0 = mcnt[2+8*n];
+      k1 = k0 + mcnt[3+8*n];
+      j0 = noffg[0] > j0 ? noffg[0] : j0;
+      j1 = (noffg[0] + nxypg[0]) < j1 ? (noffg[0] + nxypg[0]) : j1;
+      k0 = noffg[1] > k0 ? noffg[1] : k0;
+      k1 = (noffg[1] + nxypg[1]) < k1 ? (noffg[1] + nxypg[1]) : k1;
+      rdsp[n] = ioff;
+      if ((j1 > j0) && (k1 > k0))
+         ioff += ndim*(j1 - j0)*(k1 - k0);
+      rcnt[n] = ioff - rdsp[n];
+   }
+/* this segment is used for mpi computers */
+   ierr = MPI_Alltoallv(s,scnt,sdsp,mreal,t,rcnt,rdsp,mreal,lgrp);
+/* insert data received */
+   ioff = 0;
+   for (n = 0; n < nvp; n++) {
+      j0 = mcnt[8*n];
+      j1 = j0 + mcnt[1+8*n];
+      k0 = mcnt[2+8*n];
+      k1 = k0 + mcnt[3+8*n];
+      j0 = noffg[0] > j0 ? noffg[0] : j0;
+      j1 = (noffg[0] + nxypg[0]) < j1 ? (noffg[0] + nxypg[0]) : j1;
+      k0 = noffg[1] > k0 ? noffg[1] : k0;
+      k1 = (noffg[1] + nxypg[1]) < k1 ? (noffg[1] + nxypg[1]) : k1;
+      if ((j1 > j0) && (k1 > k0)) {
+         for (k = k0; k < k1; k++) {
+            for (j = j0; j < j1; j++) {
+               for (i = 0; i < ndim; i++) {
+                  g[i+ndim*(j-noffg[0]+nxvg*(k-noffg[1]))] = t[ioff+i];
+               }
+               ioff += ndim;
+            }
+         }
+      }
+   }
+   return;
+}
+
 /* Interfaces to Fortran */
 
 /*--------------------------------------------------------------------*/
@@ -1049,6 +1732,22 @@ void cppnacguard2l_(float *f, float *scr, int *nyp, int *nx, int *ndim,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppncguard2xyl_(float *f, float *scs, int *nxyp, int *kstrt,
+                     int *nvpx, int *nvpy, int *ndim, int *nxv,
+                     int *nypmx) {
+   cppncguard2xyl(f,scs,nxyp,*kstrt,*nvpx,*nvpy,*ndim,*nxv,*nypmx);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppnaguard2xyl_(float *f, float *scs, float *scr, int *nxyp,
+                     int *kstrt, int *nvpx, int *nvpy, int *nxv,
+                     int *nypmx) {
+   cppnaguard2xyl(f,scs,scr,nxyp,*kstrt,*nvpx,*nvpy,*nxv,*nypmx);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpptpose_(float complex *f, float complex *g, float complex *s,
                float complex *t, int *nx, int *ny, int *kxp, int *kyp,
@@ -1068,6 +1767,34 @@ void cppntpose_(float complex *f, float complex *g, float complex *s,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppatpose_(float complex *f, float complex *g, float complex *s,
+                float complex *t, int *nx, int *ny, int *kxp, int *kyp,
+                int *kstrt, int *nvp, int *ndim, int *nxv, int *nyv,
+                int *kxpd, int *kypd, int *mcnt) {
+   cppatpose(f,g,s,t,*nx,*ny,*kxp,*kyp,*kstrt,*nvp,*ndim,*nxv,*nyv,*kxpd,
+             *kypd,mcnt);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppatposes_(float complex *f, float complex *s, float complex *t,
+                 int *nx, int *ny, int *kxp, int *kyp, int *kstrt,
+                 int *nvp, int *ndim, int *nxv, int *kch, int *ic,
+                 int *mcnt) {
+   cppatposes(f,s,t,*nx,*ny,*kxp,*kyp,*kstrt,*nvp,*ndim,*nxv,*kch,*ic,
+              mcnt);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppatposew_(float complex *g, float complex *t, int *nx, int *ny,
+                 int *kxp, int *kyp, int *kstrt, int *nvp, int *ndim,
+                 int *nyv, int *kch, int *nch) {
+   cppatposew(g,t,*nx,*ny,*kxp,*kyp,*kstrt,*nvp,*ndim,*nyv,*kch,*nch);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppmove2_(float *part, float *edges, int *npp, float *sbufr,
                float *sbufl, float *rbufr, float *rbufl, int *ihole,
@@ -1077,3 +1804,30 @@ void cppmove2_(float *part, float *edges, int *npp, float *sbufr,
             *idimp,*npmax,*idps,*nbmax,*ntmax,info);
    return;
 }
+
+/*--------------------------------------------------------------------*/
+void cppmove2xy_(float *part, float *edges, int *npp, float *sbufr,
+                 float *sbufl, float *rbufr, float *rbufl, int *ihole,
+                 int *nx, int *ny, int *kstrt, int *nvpx, int *nvpy,
+                 int *idimp, int *npmax, int *idps, int *nbmax,
+                 int *ntmax, int *info) {
+   cppmove2xy(part,edges,npp,sbufr,sbufl,rbufr,rbufl,ihole,*nx,*ny,
+              *kstrt,*nvpx,*nvpy,*idimp,*npmax,*idps,*nbmax,*ntmax,info);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppfmove2_(float *f, float *g, int *noff, int *nyp, int *noffg,
+                int *nypg, int *kstrt, int *nvp, int *nxv, int *mcnt) {
+   cppfmove2(f,g,*noff,*nyp,*noffg,*nypg,*kstrt,*nvp,*nxv,mcnt);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppfmove2xy_(float *f, float *g, float *s, float *t, int *noff,
+                  int *nxyp, int *noffg, int *nxypg, int *kstrt,
+                  int *nvp, int *ndim, int *nxv, int *nxvg, int *mcnt) {
+   cppfmove2xy(f,g,s,t,noff,nxyp,noffg,nxypg,*kstrt,*nvp,*ndim,*nxv,
+               *nxvg,mcnt);
+   return;
+}
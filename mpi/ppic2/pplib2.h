@@ -25,6 +25,12 @@ void cppnaguard2l(float f[], float scr[], int nyp, int nx, int kstrt,
 void cppnacguard2l(float f[], float scr[], int nyp, int nx, int ndim,
                    int kstrt, int nvp, int nxv, int nypmx);
 
+void cppncguard2xyl(float f[], float scs[], int nxyp[], int kstrt,
+                    int nvpx, int nvpy, int ndim, int nxv, int nypmx);
+
+void cppnaguard2xyl(float f[], float scs[], float scr[], int nxyp[],
+                    int kstrt, int nvpx, int nvpy, int nxv, int nypmx);
+
 void cpptpose(float complex f[], float complex g[], float complex s[],
               float complex t[], int nx, int ny, int kxp, int kyp,
               int kstrt, int nvp, int nxv, int nyv, int kxpd, int kypd);
@@ -34,7 +40,33 @@ void cppntpose(float complex f[], float complex g[], float complex s[],
                int kstrt, int nvp, int ndim, int nxv, int nyv, int kxpd,
                int kypd);
 
+void cppatpose(float complex f[], float complex g[], float complex s[],
+               float complex t[], int nx, int ny, int kxp, int kyp,
+               int kstrt, int nvp, int ndim, int nxv, int nyv, int kxpd,
+               int kypd, int mcnt[]);
+
+void cppatposes(float complex f[], float complex s[], float complex t[],
+                int nx, int ny, int kxp, int kyp, int kstrt, int nvp,
+                int ndim, int nxv, int kch, int ic, int mcnt[]);
+
+void cppatposew(float complex g[], float complex t[], int nx, int ny,
+                int kxp, int kyp, int kstrt, int nvp, int ndim, int nyv,
+                int kch, int nch);
+
 void cppmove2(float part[], float edges[], int *npp, float sbufr[],
               float sbufl[], float rbufr[], float rbufl[], int ihole[],
               int ny, int kstrt, int nvp, int idimp, int npmax, int idps,
               int nbmax, int ntmax, int info[]);
+
+void cppmove2xy(float part[], float edges[], int *npp, float sbufr[],
+                float sbufl[], float rbufr[], float rbufl[],
+                int ihole[], int nx, int ny, int kstrt, int nvpx,
+                int nvpy, int idimp, int npmax, int idps, int nbmax,
+                int ntmax, int info[]);
+
+void cppfmove2(float f[], float g[], int noff, int nyp, int noffg,
+               int nypg, int kstrt, int nvp, int nxv, int mcnt[]);
+
+void cppfmove2xy(float f[], float g[], float s[], float t[], int noff[],
+                 int nxyp[], int noffg[], int nxypg[], int kstrt,
+                 int nvp, int ndim, int nxv, int nxvg, int mcnt[]);
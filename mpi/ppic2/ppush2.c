@@ -120,6 +120,310 @@ local data                                                            */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cpdicomp2xyl(float edges[], int nxyp[], int noff[], int *nxpmx,
+                  int *nypmx, int *nxpmn, int *nypmn, int nx, int ny,
+                  int kstrt, int nvpx, int nvpy, int idps, int idds) {
+/* this subroutine determines spatial boundaries for uniform particle
+   decomposition in x and y, calculates number of grid points in each
+   spatial region, and the offset of these grid points from the global
+   address.  nvpx must be < nx and nvpy must be < ny.
+   some combinations of nx and nvpx and ny and nvpy result in a zero
+   value of nxyp.  this is not supported.
+   integer boundaries are set.
+   input: nx, ny, kstrt, nvpx, nvpy, idps, idds
+   output: edges, nxyp, noff, nxpmx, nypmx, nxpmn, nypmn
+   for 2D spatial decomposition
+   edges[0:1] = left:right boundary in x of particle partition
+   edges[2:3] = lower:upper boundary in y of particle partition
+   nxyp[0:1] = number of primary (complete) gridpoints in x/y
+   noff[0] = leftmost global gridpoint in x in particle partition
+   noff[1] = lowermost global gridpoint in y in particle partition
+   nxpmx = maximum size of particle partition in x, including guard cells
+   nypmx = maximum size of particle partition in y, including guard cells
+   nxpmn = minimum value of nxyp[0]
+   nypmn = minimum value of nxyp[1]
+   nx/ny = system length in x/y direction
+   kstrt = starting data block number (processor id + 1)
+   nvpx/nvpy = number of real or virtual processors in x/y
+   idps = number of particle partition boundaries = 4
+   idds = dimensionality of domain decomposition = 2
+local data                                                            */
+   int jb, kb, kxp, kyp;
+   float at1, at2, anx, any;
+   int mxypm[4], iwork4[4];
+   anx = (float) nx;
+   any = (float) ny;
+/* determine decomposition */
+/* find processor id in x/y */
+   kb = (kstrt - 1)/nvpx;
+   jb = kstrt - nvpx*kb - 1;
+/* boundaries in x */
+   kxp = (nx - 1)/nvpx + 1;
+   at1 = (float) kxp;
+   edges[0] = at1*(float) jb;
+   if (edges[0] > anx)
+      edges[0] = anx;
+   noff[0] = edges[0];
+   edges[1] = at1*(float) (jb + 1);
+   if (edges[1] > anx)
+      edges[1] = anx;
+   jb = edges[1];
+   nxyp[0] = jb - noff[0];
+/* boundaries in y */
+   kyp = (ny - 1)/nvpy + 1;
+   at2 = (float) kyp;
+   edges[2] = at2*(float) kb;
+   if (edges[2] > any)
+      edges[2] = any;
+   noff[1] = edges[2];
+   edges[3] = at2*(float) (kb + 1);
+   if (edges[3] > any)
+      edges[3] = any;
+   kb = edges[3];
+   nxyp[1] = kb - noff[1];
+/* find maximum/minimum partition size in x and y */
+   mxypm[0] = nxyp[0];
+   mxypm[1] = -nxyp[0];
+   mxypm[2] = nxyp[1];
+   mxypm[3] = -nxyp[1];
+   cppimax(mxypm,iwork4,4);
+   *nxpmx = mxypm[0] + 1;
+   *nxpmn = -mxypm[1];
+   *nypmx = mxypm[2] + 1;
+   *nypmn = -mxypm[3];
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfcomp2xy(int nvp, int nx, int ny, int *nvpx, int *nvpy,
+               int *ierr) {
+/* determines optimal partition for nvp processors
+   input: nvp, number of processors, nx, ny = number of grids
+   output: nvpx, nvpy, processors in x, y direction, ierr = error code
+   nvp = number of real or virtual processors obtained
+   nx/ny = system length in x/y direction
+   nvpx/nvpy = number of real or virtual processors in x/y
+   ierr = (0,1) = (no,yes) error condition exists
+local data                                                            */
+   int j, lvp;
+   double dt1;
+   *ierr = 0;
+/* prefer equal number of grids in x and y partitions */
+   dt1 = sqrt((double) nvp*(double) nx/(double) ny);
+/* use the divisor of nvp closest to the optimum, so no processor */
+/* is left idle                                                   */
+   lvp = 1;
+   for (j = 1; j <= nvp; j++) {
+      if ((nvp%j)==0) {
+         if (fabs((double) j - dt1) < fabs((double) lvp - dt1))
+            lvp = j;
+      }
+   }
+/* return total number of processors in x and y */
+   *nvpx = lvp;
+   *nvpy = nvp/lvp;
+   if ((*nvpx > nx) || (*nvpy > ny)) {
+      printf("invalid partition:nvpx,nvpy,nvp=%d,%d,%d\n",*nvpx,*nvpy,
+             nvp);
+      *ierr = 1;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpdbcomp2l(float part[], float edges[], int *nyp, int *noff,
+                float dpro[], float dwork[], float wt, int npp, int ny,
+                int kstrt, int nvp, int idimp, int npmax, int idps,
+                int nypmx, int nplim, int *irc) {
+/* this subroutine determines spatial boundaries for a load balanced
+   particle decomposition, calculates number of grid points in each
+   spatial region, and the offset of these grid points from the global
+   address.  the load of each grid row is found from the particles in
+   all partitions, each particle contributing the weight wt of the
+   partition it is in, and the boundaries are placed so that each
+   partition has approximately the same load.
+   integer boundaries are set.  each partition has at least one and at
+   most nypmx-1 grid points, nvp*(nypmx-1) must be >= ny.  boundaries
+   are also limited so that each partition has at most nplim particles.
+   if this is not possible, the partition is not changed.
+   input: part, wt, npp, ny, kstrt, nvp, idimp, npmax, idps, nypmx,
+   nplim
+   output: edges, nyp, noff, dpro, irc
+   part[n][1] = position y of particle n in partition
+   edges[0] = lower boundary of particle partition
+   edges[1] = upper boundary of particle partition
+   nyp = number of primary (complete) gridpoints in particle partition
+   noff = lowermost global gridpoint in particle partition
+   dpro[k] = load in grid row k, summed over partitions
+   dpro[ny+k] = number of particles in grid row k
+   dwork = scratch array, of size 2*ny
+   wt = load of each particle in this partition, for example, 1.0 to
+   balance the number of particles, or the time to push one particle
+   npp = number of particles in partition
+   ny = system length in y direction
+   kstrt = starting data block number (processor id + 1)
+   nvp = number of real or virtual processors
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition
+   idps = number of partition boundaries
+   nypmx = maximum size of particle partition, including guard cells
+   nplim = maximum number of particles in new partition, <= npmax
+   irc = maximum number of particles in new partitions, if larger than
+   nplim, otherwise irc = 0
+local data                                                            */
+   int j, k, kb, kc, kl, kr, kt, kmin, kmax, nypm, kbl, kbr;
+   double sum1, at1, at2, at3, at4, anp;
+   nypm = nypmx - 1;
+/* find load and number of particles in each grid row */
+   for (k = 0; k < 2*ny; k++) {
+      dpro[k] = 0.0;
+   }
+   for (j = 0; j < npp; j++) {
+      k = part[1+idimp*j];
+      if (k >= ny)
+         k = ny - 1;
+      dpro[k] += wt;
+      dpro[ny+k] += 1.0;
+   }
+   cppsum(dpro,dwork,2*ny);
+   sum1 = 0.0;
+   at3 = 0.0;
+   for (k = 0; k < ny; k++) {
+      sum1 += dpro[k];
+      at3 += dpro[ny+k];
+   }
+/* find boundaries, in order, for all partitions */
+/* at1 = load in grid rows below k */
+/* at3 = number of particles in grid rows at or above kc */
+   kb = kstrt - 1;
+   k = 0;
+   kc = 0;
+   at1 = 0.0;
+   anp = 0.0;
+   kl = 0;
+   kr = 0;
+   kbl = 0;
+   kbr = ny;
+   for (j = 1; j <= nvp; j++) {
+      kl = kr;
+      if (j==nvp) {
+         kr = ny;
+      }
+      else {
+/* place boundary at grid nearest to the target load */
+         at2 = sum1*((double) j/(double) nvp);
+         while ((k < ny) && ((at1 + dpro[k]) <= at2)) {
+            at1 += dpro[k];
+            k += 1;
+         }
+         kr = k;
+         if ((k < ny) && ((at2 - at1) > (at1 + dpro[k] - at2)))
+            kr = k + 1;
+/* leave room for remaining partitions */
+         kmin = kl + 1;
+         kmax = ny - nypm*(nvp - j);
+         kmin = kmin > kmax ? kmin : kmax;
+         kmax = kl + nypm;
+         kt = ny - (nvp - j);
+         kmax = kmax < kt ? kmax : kt;
+/* leave room for particles in remaining partitions */
+         while ((kc < kmax) && (at3 > (double) nplim*(nvp - j))) {
+            at3 -= dpro[ny+kc];
+            kc += 1;
+         }
+         kmin = kmin > kc ? kmin : kc;
+/* limit number of particles in this partition */
+         at4 = 0.0;
+         for (kt = kl; kt < kmax; kt++) {
+            at4 += dpro[ny+kt];
+            if (at4 > (double) nplim) {
+               kmax = kt > kmin ? kt : kmin;
+               break;
+            }
+         }
+         kr = kr > kmin ? kr : kmin;
+         kr = kr < kmax ? kr : kmax;
+      }
+/* find largest number of particles in new partitions */
+      at4 = 0.0;
+      for (kt = kl; kt < kr; kt++) {
+         at4 += dpro[ny+kt];
+      }
+      anp = anp > at4 ? anp : at4;
+      if (j==(kb+1)) {
+         kbl = kl;
+         kbr = kr;
+      }
+   }
+/* new partitions would not fit, keep old partition */
+   if (anp > (double) nplim) {
+      *irc = (int) anp;
+      return;
+   }
+   *irc = 0;
+   edges[0] = (float) kbl;
+   edges[1] = (float) kbr;
+   *noff = kbl;
+   *nyp = kbr - kbl;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2(float part[], float edges[], int npp, int ihole[],
+               int idimp, int npmax, int idps, int nbmax, int ntmax,
+               int *irc) {
+/* this subroutine finds the particles which are outside of the
+   partition, for example after the partition boundaries have changed.
+   at most nbmax particles going down and nbmax going up are stored,
+   so that each pass of the particle manager sends at most nbmax
+   particles to each neighbor.
+   input: all except ihole, irc, output: ihole, irc
+   part[n][1] = position y of particle n in partition
+   edges[0:1] = lower:upper boundary of particle partition
+   npp = number of particles in partition
+   ihole = location of holes left in particle arrays
+   ihole[0] = number of holes stored, at most ntmax
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition
+   idps = number of partition boundaries
+   nbmax = size of buffers for passing particles between processors
+   ntmax = size of hole array for particles leaving processors
+   irc = number of particles outside the partition which were not
+   stored in ihole, these are found again after the others have been
+   moved
+local data                                                            */
+   int j, ih, nh, nl, nr;
+   float dy;
+   ih = 0;
+   nh = 0;
+   nl = 0;
+   nr = 0;
+   for (j = 0; j < npp; j++) {
+      dy = part[1+idimp*j];
+      if ((dy < edges[0]) || (dy >= edges[1])) {
+         if (dy < edges[0])
+            nl += 1;
+         else
+            nr += 1;
+         if ((ih < ntmax) && (nl <= nbmax) && (nr <= nbmax)) {
+            ihole[ih+1] = j + 1;
+            ih += 1;
+         }
+         else {
+            if (dy < edges[0])
+               nl -= 1;
+            else
+               nr -= 1;
+            nh += 1;
+         }
+      }
+   }
+   ihole[0] = ih;
+   *irc = nh;
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpdistr2(float part[], float edges[], int *npp, int nps, float vtx,
               float vty, float vdx, float vdy, int npx, int npy, int nx,
@@ -225,6 +529,112 @@ local data                                                            */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cpdistr2xy(float part[], float edges[], int *npp, int nps,
+                float vtx, float vty, float vdx, float vdy, int npx,
+                int npy, int nx, int ny, int idimp, int npmax, int idps,
+                int ipbc, int *ierr) {
+/* for 2d code, this subroutine calculates initial particle co-ordinates
+   and velocities with uniform density and maxwellian velocity with drift
+   for distributed data with 2D spatial decomposition
+   input: all except part, npp, ierr, output: part, npp, ierr
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   part[n][2] = velocity vx of particle n in partition
+   part[n][3] = velocity vy of particle n in partition
+   edges[0:1] = left:right boundary in x of particle partition
+   edges[2:3] = lower:upper boundary in y of particle partition
+   npp = number of particles in partition
+   nps = starting address of particles in partition
+   vtx/vty = thermal velocity of electrons in x/y direction
+   vdx/vdy = drift velocity of beam electrons in x/y direction
+   npx/npy = initial number of particles distributed in x/y direction
+   nx/ny = system length in x/y direction
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition
+   idps = number of partition boundaries = 4
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+   ierr = (0,1) = (no,yes) error condition exists
+   ranorm = gaussian random number with zero mean and unit variance
+local data                                                            */
+   int j, k, npt, k1, npxyp;
+   float edgelx, edgely, at1, at2, xt, yt, vxt, vyt;
+   double dnpx, dnpxy, dt1;
+   int ierr1[1], iwork1[1];
+   double sum3[3], work3[3];
+   *ierr = 0;
+/* particle distribution constant */
+   dnpx = (double) npx;
+/* set boundary values */
+   edgelx = 0.0;
+   edgely = 0.0;
+   at1 = (float) nx/(float) npx;
+   at2 = (float) ny/(float) npy;
+   if (ipbc==2) {
+      edgelx = 1.0;
+      edgely = 1.0;
+      at1 = (float) (nx-2)/(float) npx;
+      at2 = (float) (ny-2)/(float) npy;
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0;
+      at1 = (float) (nx-2)/(float) npx;
+   }
+   npt = *npp;
+/* uniform density profile */
+   for (k = 0; k < npy; k++) {
+      yt = edgely + at2*(((float) k) + 0.5);
+      for (j = 0; j < npx; j++) {
+         xt = edgelx + at1*(((float) j) + 0.5);
+/* maxwellian velocity distribution */
+         vxt = vtx*ranorm();
+         vyt = vty*ranorm();
+         if ((xt >= edges[0]) && (xt < edges[1]) && (yt >= edges[2])
+            && (yt < edges[3])) {
+            if (npt < npmax) {
+               k1 = idimp*npt;
+               part[k1] = xt;
+               part[1+k1] = yt;
+               part[2+k1] = vxt;
+               part[3+k1] = vyt;
+               npt += 1;
+            }
+            else
+               *ierr += 1;
+         }
+      }
+   }
+   npxyp = 0;
+/* add correct drift */
+   sum3[0] = 0.0;
+   sum3[1] = 0.0;
+   for (j = nps-1; j < npt; j++) {
+      npxyp += 1;
+      sum3[0] += part[2+idimp*j];
+      sum3[1] += part[3+idimp*j];
+   }
+   sum3[2] = npxyp;
+   cppdsum(sum3,work3,3);
+   dnpxy = sum3[2];
+   ierr1[0] = *ierr;
+   cppimax(ierr1,iwork1,1);
+   *ierr = ierr1[0];
+   dt1 = 1.0/dnpxy;
+   sum3[0] = dt1*sum3[0] - vdx;
+   sum3[1] = dt1*sum3[1] - vdy;
+   for (j = nps-1; j < npt; j++) {
+      part[2+idimp*j] -= sum3[0];
+      part[3+idimp*j] -= sum3[1];
+   }
+/* process errors */
+   dnpxy -= dnpx*(double) npy;
+   if (dnpxy != 0.0)
+      *ierr = dnpxy;
+   *npp = npt;
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppgpush2l(float part[], float fxy[], float edges[], int npp,
                 int noff, int ihole[], float qbm, float dt, float *ek,
@@ -370,6 +780,145 @@ local data                                                            */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppgpush2xyl(float part[], float fxy[], float edges[], int npp,
+                  int noff[], int ihole[], float qbm, float dt,
+                  float *ek, int nx, int ny, int idimp, int npmax,
+                  int nxv, int nypmx, int idps, int ntmax, int ipbc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with various boundary conditions
+   also determines list of particles which are leaving this processor
+   scalar version using guard cells, for distributed data
+   with 2D spatial decomposition
+   42 flops/particle, 12 loads, 4 stores
+   input: all except ihole, output: part, ihole, ek
+   equations used are the same as in cppgpush2l
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   part[n][2] = velocity vx of particle n in partition
+   part[n][3] = velocity vy of particle n in partition
+   fxy[k][j][0] = x component of force/charge at grid (jj,kk)
+   fxy[k][j][1] = y component of force/charge at grid (jj,kk)
+   in other words, fxy are the convolutions of the electric field
+   over the particle shape, where jj = j + noff[0], kk = k + noff[1]
+   edges[0:1] = left:right boundary in x of particle partition
+   edges[2:3] = lower:upper boundary in y of particle partition
+   npp = number of particles in partition
+   noff[0:1] = leftmost/lowermost global gridpoint in particle partition
+   ihole = location of hole left in particle arrays, for particles
+   leaving in x or y
+   ihole[0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   nx/ny = system length in x/y direction
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition
+   nxv = first dimension of field array, must be >= nxpmx
+   nypmx = maximum size of particle partition in y, including guard cells
+   idps = number of partition boundaries = 4
+   ntmax = size of hole array for particles leaving processors
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+local data                                                            */
+   int mnoff, lnoff, j, nn, mm, np, mp, ih, nh, nxv2;
+   float qtm, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
+   float dx, dy, vx, vy;
+   double sum1;
+   nxv2 = 2*nxv;
+   qtm = qbm*dt;
+   sum1 = 0.0;
+/* set boundary values */
+   edgelx = 0.0;
+   edgely = 1.0;
+   edgerx = (float) nx;
+   edgery = (float) (ny-1);
+   if ((ipbc==2) || (ipbc==3)) {
+      edgelx = 1.0;
+      edgerx = (float) (nx-1);
+   }
+   lnoff = noff[0];
+   mnoff = noff[1];
+   ih = 0;
+   nh = 0;
+   for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+      nn = part[idimp*j];
+      mm = part[1+idimp*j];
+      dxp = part[idimp*j] - (float) nn;
+      dyp = part[1+idimp*j] - (float) mm;
+      nn = 2*(nn - lnoff);
+      mm = nxv2*(mm - mnoff);
+      amx = 1.0 - dxp;
+      mp = mm + nxv2;
+      amy = 1.0 - dyp;
+      np = nn + 2;
+/* find acceleration */
+      dx = dyp*(dxp*fxy[np+mp] + amx*fxy[nn+mp])
+         + amy*(dxp*fxy[np+mm] + amx*fxy[nn+mm]);
+      dy = dyp*(dxp*fxy[1+np+mp] + amx*fxy[1+nn+mp])
+         + amy*(dxp*fxy[1+np+mm] + amx*fxy[1+nn+mm]);
+/* new velocity */
+      vx = part[2+idimp*j];
+      vy = part[3+idimp*j];
+      dx = vx + qtm*dx;
+      dy = vy + qtm*dy;
+/* average kinetic energy */
+      vx += dx;
+      vy += dy;
+      sum1 += vx*vx + vy*vy;
+      part[2+idimp*j] = dx;
+      part[3+idimp*j] = dy;
+/* new position */
+      dx = part[idimp*j] + dx*dt;
+      dy = part[1+idimp*j] + dy*dt;
+/* periodic boundary conditions in x */
+      if (ipbc==1) {
+         if (dx < edgelx) dx += edgerx;
+         if (dx >= edgerx) dx -= edgerx;
+      }
+/* reflecting boundary conditions */
+      else if (ipbc==2) {
+         if ((dx < edgelx) || (dx >= edgerx)) {
+            dx = part[idimp*j];
+            part[2+idimp*j] = -part[2+idimp*j];
+         }
+         if ((dy < edgely) || (dy >= edgery)) {
+            dy = part[1+idimp*j];
+            part[3+idimp*j] = -part[3+idimp*j];
+         }
+      }
+/* mixed reflecting/periodic boundary conditions */
+      else if (ipbc==3) {
+         if ((dx < edgelx) || (dx >= edgerx)) {
+            dx = part[idimp*j];
+            part[2+idimp*j] = -part[2+idimp*j];
+         }
+      }
+/* find particles out of bounds */
+      if ((dx < edges[0]) || (dx >= edges[1]) || (dy < edges[2])
+         || (dy >= edges[3])) {
+         if (ih < ntmax)
+            ihole[ih+1] = j + 1;
+         else
+            nh = 1;
+         ih += 1;
+      }
+/* set new position */
+      part[idimp*j] = dx;
+      part[1+idimp*j] = dy;
+   }
+/* set end of file flag */
+   if (nh > 0)
+      ih = -ih;
+   ihole[0] = ih;
+/* normalize kinetic energy */
+   *ek += 0.125*sum1;
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppgpost2l(float part[], float q[], int npp, int noff, float qm,
                 int idimp, int npmax, int nxv, int nypmx) {
@@ -419,6 +968,54 @@ local data                                                            */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppgpost2xyl(float part[], float q[], int npp, int noff[],
+                  float qm, int idimp, int npmax, int nxv, int nypmx) {
+/* for 2d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   scalar version using guard cells, for distributed data
+   with 2D spatial decomposition
+   17 flops/particle, 6 loads, 4 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   as in cppgpost2l
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   q[k][j] = charge density at grid point (jj,kk),
+   where jj = j + noff[0], kk = k + noff[1]
+   npp = number of particles in partition
+   noff[0:1] = leftmost/lowermost global gridpoint in particle partition
+   qm = charge on particle, in units of e
+   idimp = size of phase space = 4
+   npmax = maximum number of particles in each partition
+   nxv = first dimension of charge array, must be >= nxpmx
+   nypmx = maximum size of particle partition in y, including guard cells
+local data                                                            */
+   int  lnoff, mnoff, j, nn, np, mm, mp;
+   float dxp, dyp, amx, amy;
+   lnoff = noff[0];
+   mnoff = noff[1];
+   for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+      nn = part[idimp*j];
+      mm = part[1+idimp*j];
+      dxp = qm*(part[idimp*j] - (float) nn);
+      dyp = part[1+idimp*j] - (float) mm;
+      nn -= lnoff;
+      mm = nxv*(mm - mnoff);
+      amx = qm - dxp;
+      mp = mm + nxv;
+      amy = 1.0 - dyp;
+      np = nn + 1;
+/* deposit charge */
+      q[np+mp] += dxp*dyp;
+      q[nn+mp] += amx*dyp;
+      q[np+mm] += dxp*amy;
+      q[nn+mm] += amx*amy;
+   }
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppdsortp2yl(float parta[], float partb[], int npic[], int npp,
                   int noff, int nyp, int idimp, int npmax, int nypm1) {
@@ -1559,6 +2156,224 @@ void cwppfft2r2(float complex f[], float complex g[], float complex bs[],
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cwppfft2ra(float complex f[], float complex g[], float complex bs[],
+                float complex br[], int isign, int ntpose, int ktpose,
+                int nch, int mixup[], float complex sct[], float *ttp,
+                int indx, int indy, int kstrt, int nvp, int nxvh, int nyv,
+                int kxp, int kyp, int kypd, int nxhyd, int nxyhd,
+                int mcnt[]) {
+/* wrapper function for 2d real to complex fft, with packed data */
+/* parallelized with MPI, with a choice of transpose: */
+/* ktpose = (0,1,2) = transpose one message at a time, with one */
+/* collective all-to-all, or in nch chunks with non-blocking */
+/* all-to-alls, each overlapped with the fft of the next chunk */
+/* bs/br must be of size nvp*max(kxp*kych,kyp*kxch)*nc, */
+/* where nc = (1,nch) for ktpose = (1,2), kych = (kyp - 1)/nc + 1, */
+/* kxch = (kxp - 1)/nc + 1, and mcnt must be of size 4*nvp*nc */
+/* local data */
+   int nxh, ny, ks, kxpp, kypp, nc, kxch, kych, ic, kn;
+   static int kxpi = 1, kypi = 1;
+   float tf;
+   double dtime;
+   if (ktpose==0) {
+      cwppfft2r(f,g,bs,br,isign,ntpose,mixup,sct,ttp,indx,indy,kstrt,
+                nvp,nxvh,nyv,kxp,kyp,kypd,nxhyd,nxyhd);
+      return;
+   }
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+   ks = kstrt - 1;
+   kxpp = nxh - kxp*ks;
+   kxpp = 0 > kxpp ? 0 : kxpp;
+   kxpp = kxp < kxpp ? kxp : kxpp;
+   kypp = ny - kyp*ks;
+   kypp = 0 > kypp ? 0 : kypp;
+   kypp = kyp < kypp ? kyp : kypp;
+/* number of chunks and size of each chunk in y/x */
+   nc = ktpose==2 ? nch : 1;
+   kych = (kyp - 1)/nc + 1;
+   kxch = (kxp - 1)/nc + 1;
+   *ttp = 0.0;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft and start transpose of f array to g, for each chunk */
+      for (ic = 0; ic < nc; ic++) {
+         kn = kypp - kych*ic;
+         kn = 0 > kn ? 0 : kn;
+         kn = kych < kn ? kych : kn;
+         if (kn > 0)
+            cppfft2rxx(f,isign,mixup,sct,indx,indy,kstrt,kych*ic+1,kn,
+                       nxvh,kypd,nxhyd,nxyhd);
+         cpwtimera(-1,&tf,&dtime);
+         cppatposes(f,bs,br,nxh,ny,kxp,kyp,kstrt,nvp,1,nxvh,kych,ic,
+                    mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* finish transpose of f array to g */
+      cpwtimera(-1,&tf,&dtime);
+      cppatposew(g,br,nxh,ny,kxp,kyp,kstrt,nvp,1,nyv,kych,nc);
+      cpwtimera(1,&tf,&dtime);
+      *ttp += tf;
+/* perform y fft */
+      cppfft2rxy(g,isign,mixup,sct,indx,indy,kstrt,kxpi,kxpp,nyv,kxp,
+                 nxhyd,nxyhd);
+/* transpose g array to f */
+      if (ntpose==0) {
+         cpwtimera(-1,&tf,&dtime);
+         cppatpose(g,f,br,bs,ny,nxh,kyp,kxp,kstrt,nvp,1,nyv,nxvh,kypd,
+                   kxp,mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* transpose f array to g */
+      if (ntpose==0) {
+         cpwtimera(-1,&tf,&dtime);
+         cppatpose(f,g,bs,br,nxh,ny,kxp,kyp,kstrt,nvp,1,nxvh,nyv,kxp,
+                   kypd,mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* perform y fft and start transpose of g array to f, for each chunk */
+      for (ic = 0; ic < nc; ic++) {
+         kn = kxpp - kxch*ic;
+         kn = 0 > kn ? 0 : kn;
+         kn = kxch < kn ? kxch : kn;
+         if (kn > 0)
+            cppfft2rxy(g,isign,mixup,sct,indx,indy,kstrt,kxch*ic+1,kn,
+                       nyv,kxp,nxhyd,nxyhd);
+         cpwtimera(-1,&tf,&dtime);
+         cppatposes(g,br,bs,ny,nxh,kyp,kxp,kstrt,nvp,1,nyv,kxch,ic,
+                    mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* finish transpose of g array to f */
+      cpwtimera(-1,&tf,&dtime);
+      cppatposew(f,bs,ny,nxh,kyp,kxp,kstrt,nvp,1,nxvh,kxch,nc);
+      cpwtimera(1,&tf,&dtime);
+      *ttp += tf;
+/* perform x fft */
+      cppfft2rxx(f,isign,mixup,sct,indx,indy,kstrt,kypi,kypp,nxvh,kypd,
+                 nxhyd,nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwppfft2r2a(float complex f[], float complex g[], float complex bs[],
+                 float complex br[], int isign, int ntpose, int ktpose,
+                 int nch, int mixup[], float complex sct[], float *ttp,
+                 int indx, int indy, int kstrt, int nvp, int nxvh, int nyv,
+                 int kxp, int kyp, int kypd, int nxhyd, int nxyhd,
+                 int mcnt[]) {
+/* wrapper function for 2 2d real to complex ffts, with packed data */
+/* parallelized with MPI, with a choice of transpose: */
+/* ktpose = (0,1,2) = transpose one message at a time, with one */
+/* collective all-to-all, or in nch chunks with non-blocking */
+/* all-to-alls, each overlapped with the fft of the next chunk */
+/* bs/br must be of size 2*nvp*max(kxp*kych,kyp*kxch)*nc, */
+/* where nc = (1,nch) for ktpose = (1,2), kych = (kyp - 1)/nc + 1, */
+/* kxch = (kxp - 1)/nc + 1, and mcnt must be of size 4*nvp*nc */
+/* local data */
+   int nxh, ny, ks, kxpp, kypp, nc, kxch, kych, ic, kn;
+   static int kxpi = 1, kypi = 1;
+   float tf;
+   double dtime;
+   if (ktpose==0) {
+      cwppfft2r2(f,g,bs,br,isign,ntpose,mixup,sct,ttp,indx,indy,kstrt,
+                 nvp,nxvh,nyv,kxp,kyp,kypd,nxhyd,nxyhd);
+      return;
+   }
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+   ks = kstrt - 1;
+   kxpp = nxh - kxp*ks;
+   kxpp = 0 > kxpp ? 0 : kxpp;
+   kxpp = kxp < kxpp ? kxp : kxpp;
+   kypp = ny - kyp*ks;
+   kypp = 0 > kypp ? 0 : kypp;
+   kypp = kyp < kypp ? kyp : kypp;
+/* number of chunks and size of each chunk in y/x */
+   nc = ktpose==2 ? nch : 1;
+   kych = (kyp - 1)/nc + 1;
+   kxch = (kxp - 1)/nc + 1;
+   *ttp = 0.0;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft and start transpose of f array to g, for each chunk */
+      for (ic = 0; ic < nc; ic++) {
+         kn = kypp - kych*ic;
+         kn = 0 > kn ? 0 : kn;
+         kn = kych < kn ? kych : kn;
+         if (kn > 0)
+            cppfft2r2xx(f,isign,mixup,sct,indx,indy,kstrt,kych*ic+1,kn,
+                        nxvh,kypd,nxhyd,nxyhd);
+         cpwtimera(-1,&tf,&dtime);
+         cppatposes(f,bs,br,nxh,ny,kxp,kyp,kstrt,nvp,2,nxvh,kych,ic,
+                    mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* finish transpose of f array to g */
+      cpwtimera(-1,&tf,&dtime);
+      cppatposew(g,br,nxh,ny,kxp,kyp,kstrt,nvp,2,nyv,kych,nc);
+      cpwtimera(1,&tf,&dtime);
+      *ttp += tf;
+/* perform y fft */
+      cppfft2r2xy(g,isign,mixup,sct,indx,indy,kstrt,kxpi,kxpp,nyv,kxp,
+                  nxhyd,nxyhd);
+/* transpose g array to f */
+      if (ntpose==0) {
+         cpwtimera(-1,&tf,&dtime);
+         cppatpose(g,f,br,bs,ny,nxh,kyp,kxp,kstrt,nvp,2,nyv,nxvh,kypd,
+                   kxp,mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* transpose f array to g */
+      if (ntpose==0) {
+         cpwtimera(-1,&tf,&dtime);
+         cppatpose(f,g,bs,br,nxh,ny,kxp,kyp,kstrt,nvp,2,nxvh,nyv,kxp,
+                   kypd,mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* perform y fft and start transpose of g array to f, for each chunk */
+      for (ic = 0; ic < nc; ic++) {
+         kn = kxpp - kxch*ic;
+         kn = 0 > kn ? 0 : kn;
+         kn = kxch < kn ? kxch : kn;
+         if (kn > 0)
+            cppfft2r2xy(g,isign,mixup,sct,indx,indy,kstrt,kxch*ic+1,kn,
+                        nyv,kxp,nxhyd,nxyhd);
+         cpwtimera(-1,&tf,&dtime);
+         cppatposes(g,br,bs,ny,nxh,kyp,kxp,kstrt,nvp,2,nyv,kxch,ic,
+                    mcnt);
+         cpwtimera(1,&tf,&dtime);
+         *ttp += tf;
+      }
+/* finish transpose of g array to f */
+      cpwtimera(-1,&tf,&dtime);
+      cppatposew(f,bs,ny,nxh,kyp,kxp,kstrt,nvp,2,nxvh,kxch,nc);
+      cpwtimera(1,&tf,&dtime);
+      *ttp += tf;
+/* perform x fft */
+      cppfft2r2xx(f,isign,mixup,sct,indx,indy,kstrt,kypi,kypp,nxvh,kypd,
+                  nxhyd,nxyhd);
+   }
+   return;
+}
+
 /* Interfaces to Fortran */
 
 /*--------------------------------------------------------------------*/
@@ -1568,6 +2383,42 @@ void cpdicomp2l_(float *edges, int *nyp, int *noff, int *nypmx,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cpdicomp2xyl_(float *edges, int *nxyp, int *noff, int *nxpmx,
+                   int *nypmx, int *nxpmn, int *nypmn, int *nx, int *ny,
+                   int *kstrt, int *nvpx, int *nvpy, int *idps,
+                   int *idds) {
+   cpdicomp2xyl(edges,nxyp,noff,nxpmx,nypmx,nxpmn,nypmn,*nx,*ny,*kstrt,
+                *nvpx,*nvpy,*idps,*idds);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfcomp2xy_(int *nvp, int *nx, int *ny, int *nvpx, int *nvpy,
+                int *ierr) {
+   cfcomp2xy(*nvp,*nx,*ny,nvpx,nvpy,ierr);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpdbcomp2l_(float *part, float *edges, int *nyp, int *noff,
+                 float *dpro, float *dwork, float *wt, int *npp, int *ny,
+                 int *kstrt, int *nvp, int *idimp, int *npmax, int *idps,
+                 int *nypmx, int *nplim, int *irc) {
+   cpdbcomp2l(part,edges,nyp,noff,dpro,dwork,*wt,*npp,*ny,*kstrt,*nvp,
+              *idimp,*npmax,*idps,*nypmx,*nplim,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2_(float *part, float *edges, int *npp, int *ihole,
+                int *idimp, int *npmax, int *idps, int *nbmax,
+                int *ntmax, int *irc) {
+   cppholes2(part,edges,*npp,ihole,*idimp,*npmax,*idps,*nbmax,*ntmax,
+             irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpdistr2_(float *part, float *edges, int *npp, int *nps, float *vtx,
                float *vty, float *vdx, float *vdy, int *npx, int *npy,
@@ -1578,6 +2429,16 @@ void cpdistr2_(float *part, float *edges, int *npp, int *nps, float *vtx,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cpdistr2xy_(float *part, float *edges, int *npp, int *nps,
+                 float *vtx, float *vty, float *vdx, float *vdy,
+                 int *npx, int *npy, int *nx, int *ny, int *idimp,
+                 int *npmax, int *idps, int *ipbc, int *ierr) {
+   cpdistr2xy(part,edges,npp,*nps,*vtx,*vty,*vdx,*vdy,*npx,*npy,*nx,*ny,
+              *idimp,*npmax,*idps,*ipbc,ierr);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppgpush2l_(float *part, float *fxy, float *edges, int *npp,
                  int *noff, int *ihole, float *qbm, float *dt, float *ek,
@@ -1588,6 +2449,17 @@ void cppgpush2l_(float *part, float *fxy, float *edges, int *npp,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppgpush2xyl_(float *part, float *fxy, float *edges, int *npp,
+                   int *noff, int *ihole, float *qbm, float *dt,
+                   float *ek, int *nx, int *ny, int *idimp, int *npmax,
+                   int *nxv, int *nypmx, int *idps, int *ntmax,
+                   int *ipbc) {
+   cppgpush2xyl(part,fxy,edges,*npp,noff,ihole,*qbm,*dt,ek,*nx,*ny,
+                *idimp,*npmax,*nxv,*nypmx,*idps,*ntmax,*ipbc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppgpost2l_(float *part, float *q, int *npp, int *noff, float *qm,
                  int *idimp, int *npmax, int *nxv, int *nypmx) {
@@ -1595,6 +2467,14 @@ void cppgpost2l_(float *part, float *q, int *npp, int *noff, float *qm,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppgpost2xyl_(float *part, float *q, int *npp, int *noff,
+                   float *qm, int *idimp, int *npmax, int *nxv,
+                   int *nypmx) {
+   cppgpost2xyl(part,q,*npp,noff,*qm,*idimp,*npmax,*nxv,*nypmx);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppdsortp2yl_(float *parta, float *partb, int *npic, int *npp,
                    int *noff, int *nyp, int *idimp, int *npmax,
@@ -1694,3 +2574,29 @@ void cwppfft2r2_(float complex *f, float complex *g, float complex *bs,
               *nvp,*nxvh,*nyv,*kxp,*kyp,*kypd,*nxhyd,*nxyhd);
    return;
 }
+
+/*--------------------------------------------------------------------*/
+void cwppfft2ra_(float complex *f, float complex *g, float complex *bs,
+                 float complex *br, int *isign, int *ntpose, int *ktpose,
+                 int *nch, int *mixup, float complex *sct, float *ttp,
+                 int *indx, int *indy, int *kstrt, int *nvp, int *nxvh,
+                 int *nyv, int *kxp, int *kyp, int *kypd, int *nxhyd,
+                 int *nxyhd, int *mcnt) {
+   cwppfft2ra(f,g,bs,br,*isign,*ntpose,*ktpose,*nch,mixup,sct,ttp,*indx,
+              *indy,*kstrt,*nvp,*nxvh,*nyv,*kxp,*kyp,*kypd,*nxhyd,
+              *nxyhd,mcnt);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwppfft2r2a_(float complex *f, float complex *g, float complex *bs,
+                  float complex *br, int *isign, int *ntpose,
+                  int *ktpose, int *nch, int *mixup, float complex *sct,
+                  float *ttp, int *indx, int *indy, int *kstrt, int *nvp,
+                  int *nxvh, int *nyv, int *kxp, int *kyp, int *kypd,
+                  int *nxhyd, int *nxyhd, int *mcnt) {
+   cwppfft2r2a(f,g,bs,br,*isign,*ntpose,*ktpose,*nch,mixup,sct,ttp,
+               *indx,*indy,*kstrt,*nvp,*nxvh,*nyv,*kxp,*kyp,*kypd,*nxhyd,
+               *nxyhd,mcnt);
+   return;
+}
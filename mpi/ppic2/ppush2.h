@@ -5,18 +5,47 @@ double ranorm();
 void cpdicomp2l(float edges[], int *nyp, int *noff, int *nypmx,
                 int *nypmn, int ny, int kstrt, int nvp, int idps);
 
+void cpdicomp2xyl(float edges[], int nxyp[], int noff[], int *nxpmx,
+                  int *nypmx, int *nxpmn, int *nypmn, int nx, int ny,
+                  int kstrt, int nvpx, int nvpy, int idps, int idds);
+
+void cfcomp2xy(int nvp, int nx, int ny, int *nvpx, int *nvpy,
+               int *ierr);
+
+void cpdbcomp2l(float part[], float edges[], int *nyp, int *noff,
+                float dpro[], float dwork[], float wt, int npp, int ny,
+                int kstrt, int nvp, int idimp, int npmax, int idps,
+                int nypmx, int nplim, int *irc);
+
+void cppholes2(float part[], float edges[], int npp, int ihole[],
+               int idimp, int npmax, int idps, int nbmax, int ntmax,
+               int *irc);
+
 void cpdistr2(float part[], float edges[], int *npp, int nps, float vtx,
               float vty, float vdx, float vdy, int npx, int npy, int nx,
               int ny, int idimp, int npmax, int idps, int ipbc, int *ierr);
 
+void cpdistr2xy(float part[], float edges[], int *npp, int nps,
+                float vtx, float vty, float vdx, float vdy, int npx,
+                int npy, int nx, int ny, int idimp, int npmax, int idps,
+                int ipbc, int *ierr);
+
 void cppgpush2l(float part[], float fxy[], float edges[], int npp,
                 int noff, int ihole[], float qbm, float dt, float *ek,
                 int nx, int ny, int idimp, int npmax, int nxv,
                 int nypmx, int idps, int ntmax, int ipbc);
 
+void cppgpush2xyl(float part[], float fxy[], float edges[], int npp,
+                  int noff[], int ihole[], float qbm, float dt,
+                  float *ek, int nx, int ny, int idimp, int npmax,
+                  int nxv, int nypmx, int idps, int ntmax, int ipbc);
+
 void cppgpost2l(float part[], float q[], int npp, int noff, float qm,
                 int idimp, int npmax, int nxv, int nypmx);
 
+void cppgpost2xyl(float part[], float q[], int npp, int noff[],
+                  float qm, int idimp, int npmax, int nxv, int nypmx);
+
 void cppdsortp2yl(float parta[], float partb[], int npic[], int npp,
                   int noff, int nyp, int idimp, int npmax, int nypm1);
 
@@ -64,3 +93,17 @@ void cwppfft2r2(float complex f[], float complex g[], float complex bs[],
                 float complex sct[], float *ttp, int indx, int indy,
                 int kstrt, int nvp, int nxvh, int nyv, int kxp, int kyp,
                 int kypd, int nxhyd, int nxyhd);
+
+void cwppfft2ra(float complex f[], float complex g[], float complex bs[],
+                float complex br[], int isign, int ntpose, int ktpose,
+                int nch, int mixup[], float complex sct[], float *ttp,
+                int indx, int indy, int kstrt, int nvp, int nxvh, int nyv,
+                int kxp, int kyp, int kypd, int nxhyd, int nxyhd,
+                int mcnt[]);
+
+void cwppfft2r2a(float complex f[], float complex g[], float complex bs[],
+                 float complex br[], int isign, int ntpose, int ktpose,
+                 int nch, int mixup[], float complex sct[], float *ttp,
+                 int indx, int indy, int kstrt, int nvp, int nxvh, int nyv,
+                 int kxp, int kyp, int kypd, int nxhyd, int nxyhd,
+                 int mcnt[]);
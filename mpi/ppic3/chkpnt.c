@@ -0,0 +1,265 @@
+/* C Library for checkpoint and restart of Skeleton PIC codes */
+/* each MPI node writes its own binary file, fname.idproc, with a */
+/* header which records the decomposition, followed by records of */
+/* integer and real arrays.  the data is copied to a buffer, and  */
+/* the file is written by a helper thread, so that the main loop  */
+/* is not stalled.  the file is written under a temporary name    */
+/* and renamed when complete, so a previous checkpoint survives a */
+/* failure during the write.                                      */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "chkpnt.h"
+
+#define MAXDEC          16
+#define CHKVERSION      1
+
+/* identifies checkpoint files */
+static char magic[8] = "PICCHK1";
+
+/* buffer with checkpoint data being written, and its size in bytes */
+static char *cbuf = NULL;
+static size_t nbuf = 0, mbuf = 0;
+/* file names for checkpoint being written */
+static char path[256], tpath[260];
+/* helper thread, kthr = 1 if running, kerr = 1 if last write failed */
+static pthread_t thread;
+static int kthr = 0, kerr = 0;
+/* file for checkpoint being read */
+static FILE *frst = NULL;
+
+/*--------------------------------------------------------------------*/
+static int cchkbuf(void *f, size_t nbytes) {
+/* appends nbytes from f to the checkpoint buffer, enlarging it
+   as needed.  returns 0 if successful, otherwise 1
+local data                                                            */
+   size_t nn;
+   char *tbuf;
+   if (nbuf+nbytes > mbuf) {
+      nn = 2*mbuf > nbuf+nbytes ? 2*mbuf : nbuf+nbytes;
+      tbuf = (char *) realloc(cbuf,nn);
+      if (tbuf==NULL)
+         return 1;
+      cbuf = tbuf;
+      mbuf = nn;
+   }
+   memcpy(&cbuf[nbuf],f,nbytes);
+   nbuf += nbytes;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+static void *cchkthread(void *arg) {
+/* helper thread: writes the checkpoint buffer to a temporary file and
+   renames it to the checkpoint file
+local data                                                            */
+   FILE *fchk;
+   int ierr = 1;
+   fchk = fopen(tpath,"wb");
+   if (fchk != NULL) {
+      if (fwrite(cbuf,1,nbuf,fchk)==nbuf)
+         ierr = 0;
+      if (fclose(fchk) != 0)
+         ierr = 1;
+      if (ierr==0) {
+         if (rename(tpath,path) != 0)
+            ierr = 1;
+      }
+   }
+   kerr = ierr;
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkwait() {
+/* this subroutine waits until the previous checkpoint, if any, has
+   been written.
+   returns 0 if successful, otherwise 1.
+local data                                                            */
+   if (kthr==1) {
+      pthread_join(thread,NULL);
+      kthr = 0;
+   }
+   return kerr;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkopen(char *fname, int idproc, int nvp, int ntime, int ndec,
+             int idec[]) {
+/* this subroutine starts a new checkpoint, after waiting for the
+   previous one, and copies the header to the checkpoint buffer.
+   returns 0 if successful, otherwise 1.
+   fname = name of file, without processor id
+   idproc = processor id
+   nvp = number of MPI nodes
+   ntime = time step at which the run will continue
+   ndec = number of integers which describe the decomposition,
+   ndec <= 16
+   idec = integers which describe the decomposition, such as the grid
+   and partition sizes
+local data                                                            */
+   int ihead[5];
+   cchkwait();
+   if ((ndec < 0) || (ndec > MAXDEC))
+      return 1;
+   snprintf(path,sizeof(path),"%s.%d",fname,idproc);
+   snprintf(tpath,sizeof(tpath),"%s.tmp",path);
+   nbuf = 0;
+   ihead[0] = CHKVERSION;
+   ihead[1] = idproc;
+   ihead[2] = nvp;
+   ihead[3] = ntime;
+   ihead[4] = ndec;
+   if (cchkbuf(magic,sizeof(magic)) || cchkbuf(ihead,sizeof(ihead))
+      || cchkbuf(idec,ndec*sizeof(int)))
+      return 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkaddi(int f[], int nf) {
+/* this subroutine copies an integer array to the checkpoint buffer.
+   returns 0 if successful, otherwise 1.
+   f = integer array
+   nf = number of elements in f
+local data                                                            */
+   int irec[2];
+   irec[0] = 0;
+   irec[1] = nf;
+   if (cchkbuf(irec,sizeof(irec)) || cchkbuf(f,nf*sizeof(int)))
+      return 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkaddf(float f[], int nf) {
+/* this subroutine copies a real array to the checkpoint buffer.
+   complex arrays are added as real arrays of twice the length.
+   returns 0 if successful, otherwise 1.
+   f = real array
+   nf = number of elements in f
+local data                                                            */
+   int irec[2];
+   irec[0] = 1;
+   irec[1] = nf;
+   if (cchkbuf(irec,sizeof(irec)) || cchkbuf(f,nf*sizeof(float)))
+      return 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkwrite() {
+/* this subroutine starts the helper thread which writes the checkpoint
+   buffer to the file.  the arrays added to the buffer may be modified
+   as soon as this returns.
+   returns 0 if successful, otherwise 1.
+local data                                                            */
+   kerr = 0;
+   if (pthread_create(&thread,NULL,cchkthread,NULL) != 0) {
+/* write without helper thread */
+      cchkthread(NULL);
+      return kerr;
+   }
+   kthr = 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkread(char *fname, int idproc, int nvp, int *ntime, int ndec,
+             int idec[]) {
+/* this subroutine opens a checkpoint file and checks that its header
+   agrees with the current decomposition.
+   returns 0 if successful, otherwise 1.
+   input: all except ntime
+   output: ntime
+   fname = name of file, without processor id
+   idproc = processor id
+   nvp = number of MPI nodes
+   ntime = time step at which the run will continue
+   ndec = number of integers which describe the decomposition
+   idec = integers which describe the decomposition
+local data                                                            */
+   int j;
+   int ihead[5], jdec[MAXDEC];
+   char cmag[8];
+   char rpath[256];
+   if ((ndec < 0) || (ndec > MAXDEC))
+      return 1;
+   snprintf(rpath,sizeof(rpath),"%s.%d",fname,idproc);
+   frst = fopen(rpath,"rb");
+   if (frst==NULL)
+      return 1;
+   if ((fread(cmag,1,sizeof(cmag),frst) != sizeof(cmag))
+      || (memcmp(cmag,magic,sizeof(magic)) != 0))
+      goto L10;
+   if (fread(ihead,sizeof(int),5,frst) != 5)
+      goto L10;
+   if ((ihead[0] != CHKVERSION) || (ihead[1] != idproc)
+      || (ihead[2] != nvp) || (ihead[4] != ndec))
+      goto L10;
+   if (fread(jdec,sizeof(int),ndec,frst) != ndec)
+      goto L10;
+   for (j = 0; j < ndec; j++) {
+      if (jdec[j] != idec[j])
+         goto L10;
+   }
+   *ntime = ihead[3];
+   return 0;
+L10: cchkclose();
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+static int cchkget(void *f, int itype, size_t nsize, int nmax,
+                   int *nf) {
+/* reads the next record from the checkpoint file, which must have
+   type itype and at most nmax elements of nsize bytes
+local data                                                            */
+   int irec[2];
+   if (frst==NULL)
+      return 1;
+   if (fread(irec,sizeof(int),2,frst) != 2)
+      return 1;
+   if ((irec[0] != itype) || (irec[1] < 0) || (irec[1] > nmax))
+      return 1;
+   if (fread(f,nsize,irec[1],frst) != irec[1])
+      return 1;
+   *nf = irec[1];
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+int cchkgeti(int f[], int nmax, int *nf) {
+/* this subroutine reads the next record, which must be an integer
+   array, from the checkpoint file.
+   returns 0 if successful, otherwise 1.
+   f = integer array
+   nmax = maximum number of elements in f
+   nf = number of elements read
+local data                                                            */
+   return cchkget(f,0,sizeof(int),nmax,nf);
+}
+
+/*--------------------------------------------------------------------*/
+int cchkgetf(float f[], int nmax, int *nf) {
+/* this subroutine reads the next record, which must be a real array,
+   from the checkpoint file.
+   returns 0 if successful, otherwise 1.
+   f = real array
+   nmax = maximum number of elements in f
+   nf = number of elements read
+local data                                                            */
+   return cchkget(f,1,sizeof(float),nmax,nf);
+}
+
+/*--------------------------------------------------------------------*/
+void cchkclose() {
+/* this subroutine closes the checkpoint file being read
+local data                                                            */
+   if (frst != NULL)
+      fclose(frst);
+   frst = NULL;
+   return;
+}
@@ -7,6 +7,7 @@
 #include <sys/time.h>
 #include "ppush3.h"
 #include "pplib3.h"
+#include "chkpnt.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -32,6 +33,10 @@ int main(int argc, char *argv[]) {
 /* ipbc = particle boundary condition: 1 = periodic */
 /* sortime = number of time steps between standard electron sorting */
    int idimp = 6, ipbc = 1, sortime = 20;
+/* nchk = number of time steps between checkpoints, 0 = never */
+/* krst = (0,1) = (start new run, restart from checkpoint files) */
+   int nchk = 0, krst = 0;
+   char *chkfile = "ppic3_chk";
 /* idps = number of partition boundaries = 4 */
 /* idds = dimensionality of domain decomposition = 2 */
    int idps = 4, idds =    2;
@@ -73,6 +78,9 @@ int main(int argc, char *argv[]) {
    int *npic = NULL;
    double wtot[4], work[4];
    int info[7];
+/* idec = decomposition recorded in checkpoint files */
+/* ichk = npp saved in checkpoint files */
+   int idec[6], ichk[1], iwork[1], ihmax[1], irc;
 
 /* declare arrays for MPI code: */
 /* bs/br = complex send/receive buffers for data transpose */
@@ -208,11 +216,16 @@ int main(int argc, char *argv[]) {
    isign = 0;
    cppois332(qt,fxyzt,isign,ffc,ax,ay,az,affp,&we,nx,ny,nz,kstrt,nvpy,
              nvpz,nze,kxyp,kyzp,nzh);
+/* decomposition recorded in checkpoint files */
+   idec[0] = nx; idec[1] = ny; idec[2] = nz; idec[3] = idimp;
+   idec[4] = nvpy; idec[5] = nvpz;
 /* initialize electrons */
    nps = 1;
    npp = 0;
-   cpdistr32(part,edges,&npp,nps,vtx,vty,vtz,vx0,vy0,vz0,npx,npy,npz,nx,
-             ny,nz,idimp,npmax,idps,ipbc,&ierr);
+   ierr = 0;
+   if (krst==0)
+      cpdistr32(part,edges,&npp,nps,vtx,vty,vtz,vx0,vy0,vz0,npx,npy,npz,
+                nx,ny,nz,idimp,npmax,idps,ipbc,&ierr);
 /* check for particle initialization error */
    if (ierr != 0) {
       if (kstrt==1) {
@@ -221,6 +234,31 @@ int main(int argc, char *argv[]) {
       goto L3000;
    }
 
+/* restart from checkpoint files: updates ntime, part, npp */
+   if (krst==1) {
+      ierr = cchkread(chkfile,idproc,nvp,&ntime,6,idec);
+      if (ierr==0)
+         ierr = cchkgeti(ichk,1,&j);
+      if (ierr==0) {
+         npp = ichk[0];
+         ierr = cchkgetf(part,idimp*npmax,&j);
+         if ((ierr==0) && (j != idimp*npp))
+            ierr = 1;
+      }
+      cchkclose();
+      iwork[0] = ierr;
+      cppimax(iwork,ihmax,1);
+      if (iwork[0] != 0) {
+         if (kstrt==1) {
+            printf("restart error: chkfile=%s\n",chkfile);
+         }
+         goto L3000;
+      }
+      if (kstrt==1) {
+         printf("restart from %s at ntime=%d\n",chkfile,ntime);
+      }
+   }
+
 /* * * * start main iteration loop * * * */
  
 L500: if (nloop <= ntime)
@@ -353,6 +391,21 @@ L500: if (nloop <= ntime)
          }
       }
       ntime += 1;
+/* write checkpoint files in the background: copies part */
+      if ((nchk > 0) && (ntime%nchk==0)) {
+         if (cchkwait() != 0)
+            printf("%d,checkpoint write error\n",kstrt);
+         ichk[0] = npp;
+         irc = cchkopen(chkfile,idproc,nvp,ntime,6,idec);
+         if (irc==0)
+            irc = cchkaddi(ichk,1);
+         if (irc==0)
+            irc = cchkaddf(part,idimp*npp);
+         if (irc==0)
+            irc = cchkwrite();
+         if (irc != 0)
+            printf("%d,checkpoint error: ntime=%d\n",kstrt,ntime);
+      }
       goto L500;
 L2000:
 
@@ -389,6 +442,8 @@ L2000:
    }
 
 L3000:
+   if (cchkwait() != 0)
+      printf("%d,checkpoint write error\n",kstrt);
    cppexit();
    return 0;
 }
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <complex.h>
+#include <math.h>
 #include <sys/time.h>
 #include "mbpush2.h"
 #include "omplib.h"
@@ -34,9 +35,23 @@ int main(int argc, char *argv[]) {
 /* ipbc = particle boundary condition: 1 = periodic */
 /* relativity = (no,yes) = (0,1) = relativity is used */
    int idimp = 5, ipbc = 1, relativity = 1;
+/* nsub = number of maxwell solver subcycles per particle time step */
+/* if nsub > 1, particles are pushed with time averaged fields      */
+   int nsub = 1;
+/* kvpush = (0,1) = (scalar,vectorizable) relativistic push */
+   int kvpush = 1;
+/* kfqj = (0,1) = deposit current and charge in (separate,one) pass */
+   int kfqj = 1;
+/* kqe = (0,1) = charge (not yet,already) deposited in this time step */
+/* nqjs = number of time steps in which kfqj = 1 fell back to a       */
+/* separate charge deposit                                            */
+   int kqe = 0, nqjs = 0;
 /* wke/we = particle kinetic/electrostatic field energy */
 /* wf/wm/wt = magnetic field/transverse electric field/total energy */
    float wke = 0.0, we = 0.0, wf = 0.0, wm = 0.0, wt = 0.0;
+/* etot0 = initial total energy */
+/* edrift = maximum relative change in total energy */
+   float etot0 = 0.0, edrift = 0.0;
 /* mx/my = number of grids in x/y in sorting tiles */
    int mx = 16, my = 16;
 /* xtras = fraction of extra particles needed for particle management */
@@ -60,6 +75,12 @@ int main(int argc, char *argv[]) {
    float *qe = NULL, *cue = NULL, *fxyze = NULL, *bxyze = NULL;
 /* exyz/bxyz = transverse electric/magnetic field in fourier space */
    float complex *exyz = NULL, *bxyz = NULL;
+/* exyza/bxyza = transverse fields averaged over subcycles */
+/* exyzs/bxyzs = transverse fields used to push particles  */
+/* exyzt/bxyzt = scratch transverse fields for subcycling  */
+   float complex *exyza = NULL, *bxyza = NULL;
+   float complex *exyzt = NULL, *bxyzt = NULL;
+   float complex *exyzs = NULL, *bxyzs = NULL;
 /* ffc = form factor array for poisson solver */
 /* sct = sine/cosine table for FFT */
    float complex *ffc = NULL, *sct = NULL;
@@ -114,6 +135,16 @@ int main(int argc, char *argv[]) {
    bxyze = (float *) malloc(ndim*nxe*nye*sizeof(float));
    exyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
    bxyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
+   if (nsub > 1) {
+      exyza = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      bxyza = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      exyzt = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      bxyzt = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+   }
    ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
    mixup = (int *) malloc(nxhy*sizeof(int));
    sct = (float complex *) malloc(nxyh*sizeof(float complex));
@@ -161,7 +192,7 @@ int main(int argc, char *argv[]) {
       exit(1);
    }
 
-   if (dt > 0.45*ci) {
+   if (dt/(float) nsub > 0.45*ci) {
       printf("Warning: Courant condition may be exceeded!\n");
    }
 
@@ -176,31 +207,59 @@ L500: if (nloop <= ntime)
       for (j = 0; j < ndim*nxe*nye; j++) {
          cue[j] = 0.0;
       }
+      if (kfqj==1) {
+         for (j = 0; j < nxe*nye; j++) {
+            qe[j] = 0.0;
+         }
+      }
       if (relativity==1) {
 /* updates ppart, cue */
 /*       cgrjppost2l(ppart,cue,kpic,qme,dth,ci,nppmx0,idimp,nx,ny,mx, */
 /*                   my,nxe,nye,mx1,mxy1,ipbc);                       */
 /* updates ppart, cue, ncl, ihole, irc */
-         cgrjppostf2l(ppart,cue,kpic,ncl,ihole,qme,dth,ci,nppmx0,
-                      idimp,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+         if (kfqj==0) {
+            cgrjppostf2l(ppart,cue,kpic,ncl,ihole,qme,dth,ci,nppmx0,
+                         idimp,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+         }
+/* updates ppart, cue, qe, ncl, ihole, irc */
+         else {
+            cgrjqppostf2l(ppart,cue,qe,kpic,ncl,ihole,qme,dth,ci,
+                          nppmx0,idimp,nx,ny,mx,my,nxe,nye,mx1,mxy1,
+                          ntmax,&irc);
+         }
       }
       else {
 /* updates ppart, cue */
 /*       cgjppost2l(ppart,cue,kpic,qme,dth,nppmx0,idimp,nx,ny,mx,my,  */
 /*                  nxe,nye,mx1,mxy1,ipbc);                           */
 /* updates ppart, cue, ncl, ihole, irc */
-         cgjppostf2l(ppart,cue,kpic,ncl,ihole,qme,dth,nppmx0,idimp,
-                     nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+         if (kfqj==0) {
+            cgjppostf2l(ppart,cue,kpic,ncl,ihole,qme,dth,nppmx0,idimp,
+                        nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+         }
+/* updates ppart, cue, qe, ncl, ihole, irc */
+         else {
+            cgjqppostf2l(ppart,cue,qe,kpic,ncl,ihole,qme,dth,nppmx0,
+                         idimp,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+         }
       }
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdjpost += time;
+/* particles which moved a grid point or more were not deposited in */
+/* qe by the combined deposit: deposit the charge separately below  */
+      kqe = kfqj;
+      if (irc==(-1)) {
+         kqe = 0;
+         nqjs += 1;
+         irc = 0;
+      }
       if (irc != 0) {
          if (relativity==1) {
-            printf("cgrjppostf2l error: irc=%d\n",irc);
+            printf("cgrjppostf2l/cgrjqppostf2l error: irc=%d\n",irc);
          }
          else {
-            printf("cgjppostf2l error: irc=%d\n",irc);
+            printf("cgjppostf2l/cgjqppostf2l error: irc=%d\n",irc);
          }
          exit(1);
       }
@@ -223,14 +282,17 @@ L500: if (nloop <= ntime)
       }
 
 /* deposit charge with OpenMP: updates qe */
-      dtimer(&dtime,&itime,-1);
-      for (j = 0; j < nxe*nye; j++) {
-         qe[j] = 0.0;
+      if (kqe==0) {
+         dtimer(&dtime,&itime,-1);
+         for (j = 0; j < nxe*nye; j++) {
+            qe[j] = 0.0;
+         }
+         cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                   mxy1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tdpost += time;
       }
-      cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,mxy1);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tdpost += time;
 
 /* add guard cells with OpenMP: updates cue, qe */
       dtimer(&dtime,&itime,-1);
@@ -268,12 +330,22 @@ L500: if (nloop <= ntime)
 /* calculate electromagnetic fields in fourier space with OpenMP: */
 /* updates exyz, bxyz, wf, wm */
       dtimer(&dtime,&itime,-1);
+      exyzs = exyz;
+      bxyzs = bxyz;
       if (ntime==0) {
          cmibpois23((float complex *)cue,bxyz,ffc,ci,&wm,nx,ny,nxeh,nye,
                    nxh,nyh);
          wf = 0.0;
          dth = 0.5*dt;
       }
+/* subcycle maxwell solver: also updates exyza, bxyza */
+      else if (nsub > 1) {
+         cmsubmaxwel2(exyz,bxyz,exyza,bxyza,exyzt,bxyzt,
+                      (float complex *)cue,ffc,ci,dt,&wf,&wm,nx,ny,nxeh,
+                      nye,nxh,nyh,nsub);
+         exyzs = exyza;
+         bxyzs = bxyza;
+      }
       else {
          cmmaxwel2(exyz,bxyz,(float complex *)cue,ffc,ci,dt,&wf,&wm,nx,
                    ny,nxeh,nye,nxh,nyh);
@@ -295,11 +367,11 @@ L500: if (nloop <= ntime)
 /* updates fxyze */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      cmemfield2((float complex *)fxyze,exyz,ffc,isign,nx,ny,nxeh,nye,
+      cmemfield2((float complex *)fxyze,exyzs,ffc,isign,nx,ny,nxeh,nye,
                  nxh,nyh);
 /* copy magnetic field with OpenMP: updates bxyze */
       isign = -1;
-      cmemfield2((float complex *)bxyze,bxyz,ffc,isign,nx,ny,nxeh,nye,
+      cmemfield2((float complex *)bxyze,bxyzs,ffc,isign,nx,ny,nxeh,nye,
                  nxh,nyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
@@ -339,9 +411,16 @@ L500: if (nloop <= ntime)
 /*       cgrbppush23l(ppart,fxyze,bxyze,kpic,qbme,dt,dth,ci,&wke,idimp, */
 /*                    nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ipbc);        */
 /* updates ppart, ncl, ihole, wke, irc */
-         cgrbppushf23l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth,ci,
-                       &wke,idimp,nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,
-                       ntmax,&irc);
+         if (kvpush==1) {
+            cvgrbppushf23l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,
+                           dth,ci,&wke,idimp,nppmx0,nx,ny,mx,my,nxe,
+                           nye,mx1,mxy1,ntmax,&irc);
+         }
+         else {
+            cgrbppushf23l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth,
+                          ci,&wke,idimp,nppmx0,nx,ny,mx,my,nxe,nye,mx1,
+                          mxy1,ntmax,&irc);
+         }
       }
       else {
 /* updates ppart, wke */
@@ -356,7 +435,10 @@ L500: if (nloop <= ntime)
       time = (float) dtime;
       tpush += time;
       if (irc != 0) {
-         if (relativity==1) {
+         if ((relativity==1) && (kvpush==1)) {
+            printf("cvgrbppushf23l error: irc=%d\n",irc);
+         }
+         else if (relativity==1) {
             printf("cgrbppushf23l error: irc=%d\n",irc);
          }
          else {
@@ -381,6 +463,16 @@ L500: if (nloop <= ntime)
          exit(1);
       }
 
+/* energy diagnostic: updates etot0, edrift */
+      wt = we + wf + wm;
+      if (ntime==0) {
+         etot0 = wt + wke;
+      }
+      else if (etot0 != 0.0) {
+         wt = fabsf((wt + wke)/etot0 - 1.0);
+         edrift = wt > edrift ? wt : edrift;
+      }
+
       if (ntime==0) {
          wt = we + wf + wm;
          printf("Initial Total Field, Kinetic and Total Energies:\n");
@@ -395,15 +487,20 @@ L2000:
 
 /* * * * end main iteration loop * * * */
 
-   printf("ntime, relativity = %i,%i\n",ntime,relativity);
+   printf("ntime, relativity, nsub = %i,%i,%i\n",ntime,relativity,
+          nsub);
    wt = we + wf + wm;
    printf("Final Total Field, Kinetic and Total Energies:\n");
    printf("%e %e %e\n",wt,wke,wke+wt);
    printf("Final Electrostatic, Transverse Electric and Magnetic Field \
 Energies:\n");
    printf("%e %e %e\n",we,wf,wm);
+   printf("Maximum Relative Change in Total Energy = %e\n",edrift);
 
    printf("\n");
+   if (nqjs > 0) {
+      printf("time steps with separate charge deposit = %d\n",nqjs);
+   }
    printf("deposit time = %f\n",tdpost);
    printf("current deposit time = %f\n",tdjpost);
    tdpost += tdjpost;
@@ -426,6 +523,8 @@ Energies:\n");
    printf("Deposit Time (nsec) = %f\n",tdpost*wt);
    printf("Sort Time (nsec) = %f\n",tsort*wt);
    printf("Total Particle Time (nsec) = %f\n",time*wt);
+   wt = time + tfield;
+   printf("Simulated Time per Second = %f\n",(float) nloop*dt/wt);
 
    return 0;
 }
@@ -1501,6 +1501,390 @@ reduction(+:sum2)
 #undef MYV
 }
 
+/*--------------------------------------------------------------------*/
+void cvgrbppushf23l(float ppart[], float fxy[], float bxy[], int kpic[],
+                    int ncl[], int ihole[], float qbm, float dt,
+                    float dtc, float ci, float *ek, int idimp,
+                    int nppmx, int nx, int ny, int mx, int my, int nxv,
+                    int nyv, int mx1, int mxy1, int ntmax, int *irc) {
+/* for 2-1/2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, for relativistic particles with magnetic field
+   with periodic boundary conditions.
+   Using the Boris Mover.
+   also determines list of particles which are leaving this tile
+   vectorizable version of cgrbppushf23l: particles are processed in
+   blocks of NPBLK, with separate loops for the interpolation weights,
+   the field gathers, the momentum update and the boundary check.
+   local fields are padded to N words per grid point so that the
+   gathers from the four nearest grid points are contiguous.
+   the inverse gammas are found from a reciprocal square root estimate
+   refined by three newton iterations, avoiding the divide and sqrtf
+   library call, so that the momentum loop has no branches or calls.
+   results agree with cgrbppushf23l to within single precision roundoff
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   158 flops/particle, 2 divides, 25 loads, 5 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, irc, ek
+   momentum equations used are:
+   px(t+dt/2) = rot(1)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t))*dt) +
+      rot(2)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t))*dt) +
+      rot(3)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t))*dt) +
+      .5*(q/m)*fx(x(t),y(t))*dt)
+   py(t+dt/2) = rot(4)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t))*dt) +
+      rot(5)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t))*dt) +
+      rot(6)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t))*dt) +
+      .5*(q/m)*fy(x(t),y(t))*dt)
+   pz(t+dt/2) = rot(7)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t))*dt) +
+      rot(8)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t))*dt) +
+      rot(9)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t))*dt) +
+      .5*(q/m)*fz(x(t),y(t))*dt)
+   where q/m is charge/mass, and the rotation matrix is given by:
+      rot[0] = (1 - (om*dt/2)**2 + 2*(omx*dt/2)**2)/(1 + (om*dt/2)**2)
+      rot[1] = 2*(omz*dt/2 + (omx*dt/2)*(omy*dt/2))/(1 + (om*dt/2)**2)
+      rot[2] = 2*(-omy*dt/2 + (omx*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot[3] = 2*(-omz*dt/2 + (omx*dt/2)*(omy*dt/2))/(1 + (om*dt/2)**2)
+      rot[4] = (1 - (om*dt/2)**2 + 2*(omy*dt/2)**2)/(1 + (om*dt/2)**2)
+      rot[5] = 2*(omx*dt/2 + (omy*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot[6] = 2*(omy*dt/2 + (omx*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot[7] = 2*(-omx*dt/2 + (omy*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot[8] = (1 - (om*dt/2)**2 + 2*(omz*dt/2)**2)/(1 + (om*dt/2)**2)
+   and om**2 = omx**2 + omy**2 + omz**2
+   the rotation matrix is determined by:
+   omx = (q/m)*bx(x(t),y(t))*gami, omy = (q/m)*by(x(t),y(t))*gami, and
+   omz = (q/m)*bz(x(t),y(t))*gami,
+   where gami = 1./sqrt(1.+(px(t)*px(t)+py(t)*py(t)+pz(t)*pz(t))*ci*ci)
+   position equations used are:
+   x(t+dt) = x(t) + px(t+dt/2)*dtg
+   y(t+dt) = y(t) + py(t+dt/2)*dtg
+   where dtg = dtc/sqrt(1.+(px(t+dt/2)*px(t+dt/2)+py(t+dt/2)*py(t+dt/2)+
+   pz(t+dt/2)*pz(t+dt/2))*ci*ci)
+   fx(x(t),y(t)), fy(x(t),y(t)), and fz(x(t),y(t))
+   bx(x(t),y(t)), by(x(t),y(t)), and bz(x(t),y(t))
+   are approximated by interpolation from the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   similarly for fy(x,y), fz(x,y), bx(x,y), by(x,y), bz(x,y)
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = x momentum of particle n in tile m
+   ppart[m][n][3] = y momentum of particle n in tile m
+   ppart[m][n][4] = z momentum of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   fxy[k][j][2] = z component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   bxy[k][j][0] = x component of magnetic field at grid (j,k)
+   bxy[k][j][1] = y component of magnetic field at grid (j,k)
+   bxy[k][j][2] = z component of magnetic field at grid (j,k)
+   that is, the convolution of magnetic field over particle shape
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass ratio
+   dt = time interval between successive calculations
+   dtc = time interval between successive co-ordinate calculations
+   ci = reciprocal of velocity of light
+   kinetic energy/mass at time t is also calculated, using
+   ek = gami*sum((px(t-dt/2) + .5*(q/m)*fx(x(t),y(t))*dt)**2 +
+        (py(t-dt/2) + .5*(q/m)*fy(x(t),y(t))*dt)**2 +
+        (pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t))*dt)**2)/(1. + gami)
+   idimp = size of phase space = 5
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   optimized version
+local data                                                            */
+#define MXV             33
+#define MYV             33
+#define NPBLK             32
+#define LVECT             4
+#define N 4
+   int noff, moff, npoff, npp, ipp, joff, nps, lxv;
+   int i, j, k, m, ih, nh, nn, mm;
+   float qtmh, ci2, dxp, dyp, amx, amy, dx, dy, dz, ox, oy, oz;
+   float acx, acy, acz, p2, gami, qtmg, dtg, omxt, omyt, omzt, omt;
+   float anorm, rot1, rot2, rot3, rot4, rot5, rot6, rot7, rot8, rot9;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+   float x, y, vx, vy, vz;
+   float sfxy[N*MXV*MYV], sbxy[N*MXV*MYV];
+/* float sfxy[N*(mx+1)*(my+1)], sbxy[N*(mx+1)*(my+1)]; */
+/* scratch arrays */
+   int n[NPBLK];
+   float s1[NPBLK*LVECT], s2[NPBLK*LVECT], t[NPBLK*3];
+   double sum1, sum2;
+/* union used to form initial estimate of reciprocal square root */
+   union {float f; int i;} rs;
+   lxv = mx + 1;
+   qtmh = 0.5f*qbm*dt;
+   ci2 = ci*ci;
+   anx = (float) nx;
+   any = (float) ny;
+   sum2 = 0.0;
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV)) */
+/*    return;                      */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,m,noff,moff,npp,npoff,ipp,joff,nps,nn,mm,ih,nh,x,y,vx, \
+vy,vz,dxp,dyp,amx,amy,dx,dy,dz,ox,oy,oz,acx,acy,acz,omxt,omyt,omzt,omt, \
+anorm,rot1,rot2,rot3,rot4,rot5,rot6,rot7,rot8,rot9,edgelx,edgely, \
+edgerx,edgery,p2,gami,qtmg,dtg,sum1,sfxy,sbxy,n,s1,s2,t,rs) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+/* load local fields from global array */
+      for (j = 0; j < mm; j++) {
+         for (i = 0; i < nn; i++) {
+            sfxy[N*(i+lxv*j)] = fxy[3*(i+noff+nxv*(j+moff))];
+            sfxy[1+N*(i+lxv*j)] = fxy[1+3*(i+noff+nxv*(j+moff))];
+            sfxy[2+N*(i+lxv*j)] = fxy[2+3*(i+noff+nxv*(j+moff))];
+            sfxy[3+N*(i+lxv*j)] = 0.0f;
+         }
+      }
+      for (j = 0; j < mm; j++) {
+         for (i = 0; i < nn; i++) {
+            sbxy[N*(i+lxv*j)] = bxy[3*(i+noff+nxv*(j+moff))];
+            sbxy[1+N*(i+lxv*j)] = bxy[1+3*(i+noff+nxv*(j+moff))];
+            sbxy[2+N*(i+lxv*j)] = bxy[2+3*(i+noff+nxv*(j+moff))];
+            sbxy[3+N*(i+lxv*j)] = 0.0f;
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+      sum1 = 0.0;
+      ipp = (npp + NPBLK - 1)/NPBLK;
+/* outer loop over blocks, the last one possibly partial */
+      for (m = 0; m < ipp; m++) {
+         joff = NPBLK*m;
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* inner loop over particles in block */
+         for (j = 0; j < nps; j++) {
+/* find interpolation weights */
+            x = ppart[idimp*(j+joff+npoff)];
+            y = ppart[1+idimp*(j+joff+npoff)];
+            nn = x;
+            mm = y;
+            dxp = x - (float) nn;
+            dyp = y - (float) mm;
+            n[j] = N*(nn - noff + lxv*(mm - moff));
+            amx = 1.0f - dxp;
+            amy = 1.0f - dyp;
+            s1[j] = amx*amy;
+            s1[j+NPBLK] = dxp*amy;
+            s1[j+2*NPBLK] = amx*dyp;
+            s1[j+3*NPBLK] = dxp*dyp;
+            t[j] = x;
+            t[j+NPBLK] = y;
+         }
+/* find acceleration */
+         for (j = 0; j < nps; j++) {
+            nn = n[j];
+            mm = nn + N*(lxv - 2);
+            dx = 0.0f;
+            dy = 0.0f;
+            dz = 0.0f;
+            ox = 0.0f;
+            oy = 0.0f;
+            oz = 0.0f;
+            for (i = 0; i < LVECT; i++) {
+               if (i > 1)
+                  nn = mm;
+               dx += sfxy[N*i+nn]*s1[j+NPBLK*i];
+               dy += sfxy[1+N*i+nn]*s1[j+NPBLK*i];
+               dz += sfxy[2+N*i+nn]*s1[j+NPBLK*i];
+               ox += sbxy[N*i+nn]*s1[j+NPBLK*i];
+               oy += sbxy[1+N*i+nn]*s1[j+NPBLK*i];
+               oz += sbxy[2+N*i+nn]*s1[j+NPBLK*i];
+            }
+            s1[j] = dx;
+            s1[j+NPBLK] = dy;
+            s1[j+2*NPBLK] = dz;
+            s2[j] = ox;
+            s2[j+NPBLK] = oy;
+            s2[j+2*NPBLK] = oz;
+         }
+/* new momentum */
+         for (j = 0; j < nps; j++) {
+            x = t[j];
+            y = t[j+NPBLK];
+/* calculate half impulse */
+            dx = qtmh*s1[j];
+            dy = qtmh*s1[j+NPBLK];
+            dz = qtmh*s1[j+2*NPBLK];
+/* half acceleration */
+            acx = ppart[2+idimp*(j+joff+npoff)] + dx;
+            acy = ppart[3+idimp*(j+joff+npoff)] + dy;
+            acz = ppart[4+idimp*(j+joff+npoff)] + dz;
+/* find inverse gamma */
+            p2 = acx*acx + acy*acy + acz*acz;
+            omt = 1.0f + p2*ci2;
+            rs.f = omt;
+            rs.i = 0x5f3759df - (rs.i >> 1);
+            gami = rs.f;
+            omt *= 0.5f;
+            gami = gami*(1.5f - omt*gami*gami);
+            gami = gami*(1.5f - omt*gami*gami);
+            gami = gami*(1.5f - omt*gami*gami);
+/* renormalize magnetic field */
+            qtmg = qtmh*gami;
+/* time-centered kinetic energy */
+            t[j+2*NPBLK] = gami*p2/(1.0f + gami);
+/* calculate cyclotron frequency */
+            omxt = qtmg*s2[j];
+            omyt = qtmg*s2[j+NPBLK];
+            omzt = qtmg*s2[j+2*NPBLK];
+/* calculate rotation matrix */
+            omt = omxt*omxt + omyt*omyt + omzt*omzt;
+            anorm = 2.0f/(1.0f + omt);
+            omt = 0.5f*(1.0f - omt);
+            rot4 = omxt*omyt;
+            rot7 = omxt*omzt;
+            rot8 = omyt*omzt;
+            rot1 = omt + omxt*omxt;
+            rot5 = omt + omyt*omyt;
+            rot9 = omt + omzt*omzt;
+            rot2 = omzt + rot4;
+            rot4 -= omzt;
+            rot3 = -omyt + rot7;
+            rot7 += omyt;
+            rot6 = omxt + rot8;
+            rot8 -= omxt;
+/* new momentum */
+            vx = (rot1*acx + rot2*acy + rot3*acz)*anorm + dx;
+            vy = (rot4*acx + rot5*acy + rot6*acz)*anorm + dy;
+            vz = (rot7*acx + rot8*acy + rot9*acz)*anorm + dz;
+/* update inverse gamma */
+            p2 = vx*vx + vy*vy + vz*vz;
+            omt = 1.0f + p2*ci2;
+            rs.f = omt;
+            rs.i = 0x5f3759df - (rs.i >> 1);
+            dtg = rs.f;
+            omt *= 0.5f;
+            dtg = dtg*(1.5f - omt*dtg*dtg);
+            dtg = dtg*(1.5f - omt*dtg*dtg);
+            dtg = dtc*dtg*(1.5f - omt*dtg*dtg);
+/* new position */
+            s1[j] = x + vx*dtg;
+            s1[j+NPBLK] = y + vy*dtg;
+            s2[j] = vx;
+            s2[j+NPBLK] = vy;
+            s2[j+2*NPBLK] = vz;
+         }
+/* check boundary conditions */
+         for (j = 0; j < nps; j++) {
+            dx = s1[j];
+            dy = s1[j+NPBLK];
+            sum1 += t[j+2*NPBLK];
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx -= anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy -= any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+/* set new position */
+            ppart[idimp*(j+joff+npoff)] = dx;
+            ppart[1+idimp*(j+joff+npoff)] = dy;
+/* set new momentum */
+            ppart[2+idimp*(j+joff+npoff)] = s2[j];
+            ppart[3+idimp*(j+joff+npoff)] = s2[j+NPBLK];
+            ppart[4+idimp*(j+joff+npoff)] = s2[j+2*NPBLK];
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+8*k-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*k)] = j + joff + 1;
+                  ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += sum2;
+   return;
+#undef N
+#undef LVECT
+#undef NPBLK
+#undef MXV
+#undef MYV
+}
+
 /*--------------------------------------------------------------------*/
 void cgppost2l(float ppart[], float q[], int kpic[], float qm,
                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
@@ -2058,91 +2442,593 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,scu)
 #undef MXV
 #undef MYV
 }
-
+
+/*--------------------------------------------------------------------*/
+void cgrjppost2l(float ppart[], float cu[], int kpic[], float qm,
+                 float dt, float ci, int nppmx, int idimp, int nx,
+                 int ny, int mx, int my, int nxv, int nyv, int mx1,
+                 int mxy1, int ipbc) {
+/* for 2-1/2d code, this subroutine calculates particle current density
+   using first-order linear interpolation
+   in addition, particle positions are advanced a half time-step
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   47 flops/particle, 1 divide, 1 sqrt, 17 loads, 14 stores
+   input: all, output: ppart, cu
+   current density is approximated by values at the nearest grid points
+   cu(i,n,m)=qci*(1.-dx)*(1.-dy)
+   cu(i,n+1,m)=qci*dx*(1.-dy)
+   cu(i,n,m+1)=qci*(1.-dx)*dy
+   cu(i,n+1,m+1)=qci*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   and qci = qm*pi*gami, where i = x,y,z
+   where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = x momentum of particle n in tile m
+   ppart[m][n][3] = y momentum of particle n in tile m
+   ppart[m][n][4] = z momentum of particle n in tile m
+   cu[k][j][i] = ith component of current density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   dt = time interval between successive calculations
+   ci = reciprocal of velocity of light
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 5
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   nxv = first dimension of current array, must be >= nx+1
+   nyv = second dimension of current array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+local data                                                            */
+#define MXV             33
+#define MYV             33
+   int noff, moff, npoff, npp, mxv3;
+   int i, j, k, nn, mm;
+   float ci2, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy, vz, p2, gami;
+   float scu[3*MXV*MYV];
+/* float scu[3*(mx+1)*(my+1)]; */
+   mxv3 = 3*(mx + 1);
+   ci2 = ci*ci;
+/* set boundary values */
+   edgelx = 0.0;
+   edgely = 0.0;
+   edgerx = (float) nx;
+   edgery = (float) ny;
+   if (ipbc==2) {
+      edgelx = 1.0;
+      edgely = 1.0;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0;
+      edgerx = (float) (nx-1);
+   }
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV))   */
+/*    return;                        */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy,dx,dy,vx, \
+vy,vz,p2,gami,scu)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+/* zero out local accumulator */
+      for (j = 0; j < mxv3*(my+1); j++) {
+         scu[j] = 0.0f;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+/* find inverse gamma */
+         vx = ppart[2+idimp*(j+npoff)];
+         vy = ppart[3+idimp*(j+npoff)];
+         vz = ppart[4+idimp*(j+npoff)];
+         p2 = vx*vx + vy*vy + vz*vz;
+         gami = 1.0/sqrtf(1.0 + p2*ci2);
+/* calculate weights */
+         nn = 3*(nn - noff) + mxv3*(mm - moff);
+         amx = qm - dxp;
+         amy = 1.0 - dyp;
+/* deposit current */
+         dx = amx*amy;
+         dy = dxp*amy;
+         vx *= gami;
+         vy *= gami;
+         vz *= gami;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = amx*dyp;
+         mm = nn + 3;
+         scu[mm] += vx*dy;
+         scu[mm+1] += vy*dy;
+         scu[mm+2] += vz*dy;
+         dy = dxp*dyp;
+         nn += mxv3;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         mm = nn + 3;
+         scu[mm] += vx*dy;
+         scu[mm+1] += vy*dy;
+         scu[mm+2] += vz*dy;
+/* advance position half a time-step */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* reflecting boundary conditions */
+         if (ipbc==2) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = ppart[idimp*(j+npoff)];
+               ppart[2+idimp*(j+npoff)] = -ppart[2+idimp*(j+npoff)];
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = ppart[1+idimp*(j+npoff)];
+               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+            }
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = ppart[idimp*(j+npoff)];
+               ppart[2+idimp*(j+npoff)] = -ppart[2+idimp*(j+npoff)];
+            }
+         }
+/* set new position */
+         ppart[idimp*(j+npoff)] = dx;
+         ppart[1+idimp*(j+npoff)] = dy;
+      }
+/* deposit current to interior points in global array */
+      nn = nxv - noff;
+      mm = nyv - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+            cu[3*(i+noff+nxv*(j+moff))] += scu[3*i+mxv3*j];
+            cu[1+3*(i+noff+nxv*(j+moff))] += scu[1+3*i+mxv3*j];
+            cu[2+3*(i+noff+nxv*(j+moff))] += scu[2+3*i+mxv3*j];
+         }
+      }
+/* deposit current to edge points in global array */
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (i = 1; i < nn; i++) {
+#pragma omp atomic
+         cu[3*(i+noff+nxv*moff)] += scu[3*i];
+#pragma omp atomic
+         cu[1+3*(i+noff+nxv*moff)] += scu[1+3*i];
+#pragma omp atomic
+         cu[2+3*(i+noff+nxv*moff)] += scu[2+3*i];
+         if (mm > my) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*(mm+moff-1))] += scu[3*i+mxv3*(mm-1)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*(mm+moff-1))] += scu[1+3*i+mxv3*(mm-1)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*(mm+moff-1))] += scu[2+3*i+mxv3*(mm-1)];
+         }
+      }
+      nn = nxv - noff;
+      nn = mx+1 < nn ? mx+1 : nn;
+      for (j = 0; j < mm; j++) {
+#pragma omp atomic
+         cu[3*(noff+nxv*(j+moff))] += scu[mxv3*j];
+#pragma omp atomic
+         cu[1+3*(noff+nxv*(j+moff))] += scu[1+mxv3*j];
+#pragma omp atomic
+         cu[2+3*(noff+nxv*(j+moff))] += scu[2+mxv3*j];
+         if (nn > mx) {
+#pragma omp atomic
+            cu[3*(nn+noff-1+nxv*(j+moff))] += scu[3*(nn-1)+mxv3*j];
+#pragma omp atomic
+            cu[1+3*(nn+noff-1+nxv*(j+moff))] += scu[1+3*(nn-1)+mxv3*j];
+#pragma omp atomic
+            cu[2+3*(nn+noff-1+nxv*(j+moff))] += scu[2+3*(nn-1)+mxv3*j];
+         }
+      }
+   }
+   return;
+#undef MXV
+#undef MYV
+}
+
+/*--------------------------------------------------------------------*/
+void cgrjppostf2l(float ppart[], float cu[], int kpic[], int ncl[],
+                  int ihole[], float qm, float dt, float ci, int nppmx,
+                  int idimp, int nx, int ny, int mx, int my, int nxv,
+                  int nyv, int mx1, int mxy1, int ntmax, int *irc) {
+/* for 2-1/2d code, this subroutine calculates particle current density
+   using first-order linear interpolation for relativistic particles
+   in addition, particle positions are advanced a half time-step
+   with periodic boundary conditions.
+   also determines list of particles which are leaving this tile
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   47 flops/particle, 1 divide, 1 sqrt, 17 loads, 14 stores
+   input: all except ncl, ihole, irc,
+   output: ppart, cu, ncl, ihole, irc
+   current density is approximated by values at the nearest grid points
+   cu(i,n,m)=qci*(1.-dx)*(1.-dy)
+   cu(i,n+1,m)=qci*dx*(1.-dy)
+   cu(i,n,m+1)=qci*(1.-dx)*dy
+   cu(i,n+1,m+1)=qci*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   and qci = qm*pi*gami, where i = x,y,z
+   where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = x momentum of particle n in tile m
+   ppart[m][n][3] = y momentum of particle n in tile m
+   ppart[m][n][4] = z momentum of particle n in tile m
+   cu[k][j][i] = ith component of current density at grid point j,k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qm = charge on particle, in units of e
+   dt = time interval between successive calculations
+   ci = reciprocal of velocity of light
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 5
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   nxv = first dimension of current array, must be >= nx+1
+   nyv = second dimension of current array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   optimized version
+local data                                                            */
+#define MXV             33
+#define MYV             33
+   int noff, moff, npoff, npp;
+   int i, j, k, ih, nh, nn, mm, mxv3;
+   float ci2, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy, vz, p2, gami;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+   float scu[3*MXV*MYV];
+/* float scu[3*(mx+1)*(my+1)]; */
+   mxv3 = 3*(mx + 1);
+   ci2 = ci*ci;
+   anx = (float) nx;
+   any = (float) ny;
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV))   */
+/*    return;                        */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy,dx, \
+dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+/* zero out local accumulator */
+      for (j = 0; j < mxv3*(my+1); j++) {
+         scu[j] = 0.0f;
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+/* find inverse gamma */
+         vx = ppart[2+idimp*(j+npoff)];
+         vy = ppart[3+idimp*(j+npoff)];
+         vz = ppart[4+idimp*(j+npoff)];
+         p2 = vx*vx + vy*vy + vz*vz;
+         gami = 1.0/sqrtf(1.0 + p2*ci2);
+/* calculate weights */
+         nn = 3*(nn - noff) + mxv3*(mm - moff);
+         amx = qm - dxp;
+         amy = 1.0 - dyp;
+/* deposit current */
+         dx = amx*amy;
+         dy = dxp*amy;
+         vx *= gami;
+         vy *= gami;
+         vz *= gami;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = amx*dyp;
+         mm = nn + 3;
+         scu[mm] += vx*dy;
+         scu[mm+1] += vy*dy;
+         scu[mm+2] += vz*dy;
+         dy = dxp*dyp;
+         nn += mxv3;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         mm = nn + 3;
+         scu[mm] += vx*dy;
+         scu[mm+1] += vy*dy;
+         scu[mm+2] += vz*dy;
+/* advance position half a time-step */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx -= anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0;
+            }
+            else {
+               mm = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy -= any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0;
+            }
+            else {
+               mm += 3;
+            }
+         }
+/* set new position */
+         ppart[idimp*(j+npoff)] = dx;
+         ppart[1+idimp*(j+npoff)] = dy;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* deposit current to interior points in global array */
+      nn = nxv - noff;
+      mm = nyv - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+            cu[3*(i+noff+nxv*(j+moff))] += scu[3*i+mxv3*j];
+            cu[1+3*(i+noff+nxv*(j+moff))] += scu[1+3*i+mxv3*j];
+            cu[2+3*(i+noff+nxv*(j+moff))] += scu[2+3*i+mxv3*j];
+         }
+      }
+/* deposit current to edge points in global array */
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (i = 1; i < nn; i++) {
+#pragma omp atomic
+         cu[3*(i+noff+nxv*moff)] += scu[3*i];
+#pragma omp atomic
+         cu[1+3*(i+noff+nxv*moff)] += scu[1+3*i];
+#pragma omp atomic
+         cu[2+3*(i+noff+nxv*moff)] += scu[2+3*i];
+         if (mm > my) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*(mm+moff-1))] += scu[3*i+mxv3*(mm-1)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*(mm+moff-1))] += scu[1+3*i+mxv3*(mm-1)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*(mm+moff-1))] += scu[2+3*i+mxv3*(mm-1)];
+         }
+      }
+      nn = nxv - noff;
+      nn = mx+1 < nn ? mx+1 : nn;
+      for (j = 0; j < mm; j++) {
+#pragma omp atomic
+         cu[3*(noff+nxv*(j+moff))] += scu[mxv3*j];
+#pragma omp atomic
+         cu[1+3*(noff+nxv*(j+moff))] += scu[1+mxv3*j];
+#pragma omp atomic
+         cu[2+3*(noff+nxv*(j+moff))] += scu[2+mxv3*j];
+         if (nn > mx) {
+#pragma omp atomic
+            cu[3*(nn+noff-1+nxv*(j+moff))] += scu[3*(nn-1)+mxv3*j];
+#pragma omp atomic
+            cu[1+3*(nn+noff-1+nxv*(j+moff))] += scu[1+3*(nn-1)+mxv3*j];
+#pragma omp atomic
+            cu[2+3*(nn+noff-1+nxv*(j+moff))] += scu[2+3*(nn-1)+mxv3*j];
+         }
+      }
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+   return;
+#undef MXV
+#undef MYV
+}
 /*--------------------------------------------------------------------*/
-void cgrjppost2l(float ppart[], float cu[], int kpic[], float qm,
-                 float dt, float ci, int nppmx, int idimp, int nx,
-                 int ny, int mx, int my, int nxv, int nyv, int mx1,
-                 int mxy1, int ipbc) {
-/* for 2-1/2d code, this subroutine calculates particle current density
+void cgjqppostf2l(float ppart[], float cu[], float q[], int kpic[],
+                  int ncl[], int ihole[], float qm, float dt,
+                  int nppmx, int idimp, int nx, int ny, int mx, int my,
+                  int nxv, int nyv, int mx1, int mxy1, int ntmax,
+                  int *irc) {
+/* for 2-1/2d code, this subroutine calculates particle current and
+   charge density in one pass over the particles,
    using first-order linear interpolation
    in addition, particle positions are advanced a half time-step
+   with periodic boundary conditions.
+   the charge density is deposited at the advanced positions, so the
+   result is the same as calling cgppost2l after the particles have
+   been reordered.  the charge accumulator of each tile is extended
+   by one grid point on each side, to hold the charge of particles
+   leaving the tile, and is added to the global array with periodic
+   wrap around.  particles must move less than one grid point per
+   half time-step, otherwise their charge is not deposited and irc is
+   set to -1, so that the charge can be deposited separately after the
+   particles have been reordered.
+   also determines list of particles which are leaving this tile
    OpenMP version using guard cells
    data deposited in tiles
    particles stored segmented array
-   47 flops/particle, 1 divide, 1 sqrt, 17 loads, 14 stores
-   input: all, output: ppart, cu
+   58 flops/particle, 21 loads, 18 stores
+   input: all except ncl, ihole, irc,
+   output: ppart, cu, q, ncl, ihole, irc
    current density is approximated by values at the nearest grid points
    cu(i,n,m)=qci*(1.-dx)*(1.-dy)
    cu(i,n+1,m)=qci*dx*(1.-dy)
    cu(i,n,m+1)=qci*(1.-dx)*dy
    cu(i,n+1,m+1)=qci*dx*dy
    where n,m = leftmost grid points and dx = x-n, dy = y-m
-   and qci = qm*pi*gami, where i = x,y,z
-   where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   and qci = qm*vi, where i = x,y,z
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m,
+   at the advanced positions
    ppart[m][n][0] = position x of particle n in tile m
    ppart[m][n][1] = position y of particle n in tile m
-   ppart[m][n][2] = x momentum of particle n in tile m
-   ppart[m][n][3] = y momentum of particle n in tile m
-   ppart[m][n][4] = z momentum of particle n in tile m
+   ppart[m][n][2] = x velocity of particle n in tile m
+   ppart[m][n][3] = y velocity of particle n in tile m
+   ppart[m][n][4] = z velocity of particle n in tile m
    cu[k][j][i] = ith component of current density at grid point j,k
-   kpic = number of particles per tile
+   q[k][j] = charge density at grid point j,k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
    qm = charge on particle, in units of e
    dt = time interval between successive calculations
-   ci = reciprocal of velocity of light
    nppmx = maximum number of particles in tile
    idimp = size of phase space = 5
    nx/ny = system length in x/y direction
    mx/my = number of grids in sorting cell in x/y
-   nxv = first dimension of current array, must be >= nx+1
-   nyv = second dimension of current array, must be >= ny+1
+   nxv = first dimension of current, charge arrays, must be >= nx+1
+   nyv = second dimension of current, charge arrays, must be >= ny+1
    mx1 = (system length in x direction - 1)/mx + 1
    mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
-   ipbc = particle boundary condition = (0,1,2,3) =
-   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -1 if a particle moved a grid point or more, and no overflow
+   occurred
+   optimized version
 local data                                                            */
 #define MXV             33
 #define MYV             33
-   int noff, moff, npoff, npp, mxv3;
-   int i, j, k, nn, mm;
-   float ci2, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
-   float x, y, dx, dy, vx, vy, vz, p2, gami;
-   float scu[3*MXV*MYV];
-/* float scu[3*(mx+1)*(my+1)]; */
+   int noff, moff, npoff, npp;
+   int i, j, k, ih, nh, nq, nn, mm, ii, jj, mxv3, mxv2;
+   float dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy, vz;
+   float anx, any, edgelx, edgely, edgerx, edgery, edgeqx, edgeqy;
+   float scu[3*MXV*MYV], sq[(MXV+2)*(MYV+2)];
+/* float scu[3*(mx+1)*(my+1)], sq[(mx+3)*(my+3)]; */
    mxv3 = 3*(mx + 1);
-   ci2 = ci*ci;
-/* set boundary values */
-   edgelx = 0.0;
-   edgely = 0.0;
-   edgerx = (float) nx;
-   edgery = (float) ny;
-   if (ipbc==2) {
-      edgelx = 1.0;
-      edgely = 1.0;
-      edgerx = (float) (nx-1);
-      edgery = (float) (ny-1);
-   }
-   else if (ipbc==3) {
-      edgelx = 1.0;
-      edgerx = (float) (nx-1);
-   }
+   mxv2 = mx + 3;
+   anx = (float) nx;
+   any = (float) ny;
 /* error if local array is too small */
 /* if ((mx >= MXV) || (my >= MYV))   */
 /*    return;                        */
+   nq = 0;
 /* loop over tiles */
 #pragma omp parallel for \
-private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy,dx,dy,vx, \
-vy,vz,p2,gami,scu)
+private(i,j,k,noff,moff,npp,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy,dx, \
+dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,edgeqx,edgeqy,ii,jj,scu,sq) \
+reduction(+:nq)
    for (k = 0; k < mxy1; k++) {
       noff = k/mx1;
       moff = my*noff;
       noff = mx*(k - mx1*noff);
       npp = kpic[k];
       npoff = nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      edgeqx = edgerx - edgelx + 2.0f;
+      edgeqy = edgery - edgely + 2.0f;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
 /* zero out local accumulator */
       for (j = 0; j < mxv3*(my+1); j++) {
          scu[j] = 0.0f;
       }
+      for (j = 0; j < mxv2*(my+3); j++) {
+         sq[j] = 0.0f;
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
 /* loop over particles in tile */
       for (j = 0; j < npp; j++) {
 /* find interpolation weights */
@@ -2152,22 +3038,15 @@ vy,vz,p2,gami,scu)
          mm = y;
          dxp = qm*(x - (float) nn);
          dyp = y - (float) mm;
-/* find inverse gamma */
-         vx = ppart[2+idimp*(j+npoff)];
-         vy = ppart[3+idimp*(j+npoff)];
-         vz = ppart[4+idimp*(j+npoff)];
-         p2 = vx*vx + vy*vy + vz*vz;
-         gami = 1.0/sqrtf(1.0 + p2*ci2);
-/* calculate weights */
          nn = 3*(nn - noff) + mxv3*(mm - moff);
          amx = qm - dxp;
          amy = 1.0 - dyp;
 /* deposit current */
          dx = amx*amy;
          dy = dxp*amy;
-         vx *= gami;
-         vy *= gami;
-         vz *= gami;
+         vx = ppart[2+idimp*(j+npoff)];
+         vy = ppart[3+idimp*(j+npoff)];
+         vz = ppart[4+idimp*(j+npoff)];
          scu[nn] += vx*dx;
          scu[nn+1] += vy*dx;
          scu[nn+2] += vz*dx;
@@ -2188,27 +3067,83 @@ vy,vz,p2,gami,scu)
 /* advance position half a time-step */
          dx = x + vx*dt;
          dy = y + vy*dt;
-/* reflecting boundary conditions */
-         if (ipbc==2) {
-            if ((dx < edgelx) || (dx >= edgerx)) {
-               dx = ppart[idimp*(j+npoff)];
-               ppart[2+idimp*(j+npoff)] = -ppart[2+idimp*(j+npoff)];
+/* deposit charge at new position to extended local accumulator */
+         x = dx - edgelx + 1.0f;
+         y = dy - edgely + 1.0f;
+/* particle moved a grid point or more */
+         if ((x < 0.0f) || (x >= edgeqx) || (y < 0.0f)
+            || (y >= edgeqy)) {
+            nq += 1;
+         }
+         else {
+            nn = x;
+            mm = y;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            nn += mxv2*mm;
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+            sq[nn] += amx*amy;
+            sq[nn+1] += dxp*amy;
+            nn += mxv2;
+            sq[nn] += amx*dyp;
+            sq[nn+1] += dxp*dyp;
+         }
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx -= anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0;
             }
-            if ((dy < edgely) || (dy >= edgery)) {
-               dy = ppart[1+idimp*(j+npoff)];
-               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+            else {
+               mm = 1;
             }
          }
-/* mixed reflecting/periodic boundary conditions */
-         else if (ipbc==3) {
-            if ((dx < edgelx) || (dx >= edgerx)) {
-               dx = ppart[idimp*(j+npoff)];
-               ppart[2+idimp*(j+npoff)] = -ppart[2+idimp*(j+npoff)];
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy -= any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0;
+            }
+            else {
+               mm += 3;
             }
          }
 /* set new position */
          ppart[idimp*(j+npoff)] = dx;
          ppart[1+idimp*(j+npoff)] = dy;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
       }
 /* deposit current to interior points in global array */
       nn = nxv - noff;
@@ -2259,28 +3194,76 @@ vy,vz,p2,gami,scu)
             cu[2+3*(nn+noff-1+nxv*(j+moff))] += scu[2+3*(nn-1)+mxv3*j];
          }
       }
+/* deposit charge to global array with periodic wrap around,      */
+/* points which other tiles may also update are added atomically, */
+/* skipping zeros in the part of the halo no particle reached     */
+      nn = nx - noff;
+      mm = ny - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 0; j < mm+3; j++) {
+         jj = j + moff - 1;
+         if (jj < 0)
+            jj += ny;
+         else if (jj > ny)
+            jj -= ny;
+         for (i = 0; i < nn+3; i++) {
+            ii = i + noff - 1;
+            if (ii < 0)
+               ii += nx;
+            else if (ii > nx)
+               ii -= nx;
+            if ((i > 2) && (i < nn) && (j > 2) && (j < mm)) {
+               q[ii+nxv*jj] += sq[i+mxv2*j];
+            }
+            else if (sq[i+mxv2*j] != 0.0f) {
+#pragma omp atomic
+               q[ii+nxv*jj] += sq[i+mxv2*j];
+            }
+         }
+      }
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
    }
+/* particles moved a grid point or more, if no ihole overflow */
+   if ((nq > 0) && (*irc==0))
+      *irc = -1;
    return;
 #undef MXV
 #undef MYV
 }
-
 /*--------------------------------------------------------------------*/
-void cgrjppostf2l(float ppart[], float cu[], int kpic[], int ncl[],
-                  int ihole[], float qm, float dt, float ci, int nppmx,
-                  int idimp, int nx, int ny, int mx, int my, int nxv,
-                  int nyv, int mx1, int mxy1, int ntmax, int *irc) {
-/* for 2-1/2d code, this subroutine calculates particle current density
+void cgrjqppostf2l(float ppart[], float cu[], float q[], int kpic[],
+                   int ncl[], int ihole[], float qm, float dt,
+                   float ci, int nppmx, int idimp, int nx, int ny,
+                   int mx, int my, int nxv, int nyv, int mx1, int mxy1,
+                   int ntmax, int *irc) {
+/* for 2-1/2d code, this subroutine calculates particle current and
+   charge density in one pass over the particles,
    using first-order linear interpolation for relativistic particles
    in addition, particle positions are advanced a half time-step
    with periodic boundary conditions.
+   the charge density is deposited at the advanced positions, so the
+   result is the same as calling cgppost2l after the particles have
+   been reordered.  the charge accumulator of each tile is extended
+   by one grid point on each side, to hold the charge of particles
+   leaving the tile, and is added to the global array with periodic
+   wrap around.  particles must move less than one grid point per
+   half time-step, otherwise their charge is not deposited and irc is
+   set to -1, so that the charge can be deposited separately after the
+   particles have been reordered.
    also determines list of particles which are leaving this tile
    OpenMP version using guard cells
    data deposited in tiles
    particles stored segmented array
-   47 flops/particle, 1 divide, 1 sqrt, 17 loads, 14 stores
+   64 flops/particle, 1 divide, 1 sqrt, 21 loads, 18 stores
    input: all except ncl, ihole, irc,
-   output: ppart, cu, ncl, ihole, irc
+   output: ppart, cu, q, ncl, ihole, irc
    current density is approximated by values at the nearest grid points
    cu(i,n,m)=qci*(1.-dx)*(1.-dy)
    cu(i,n+1,m)=qci*dx*(1.-dy)
@@ -2289,12 +3272,20 @@ void cgrjppostf2l(float ppart[], float cu[], int kpic[], int ncl[],
    where n,m = leftmost grid points and dx = x-n, dy = y-m
    and qci = qm*pi*gami, where i = x,y,z
    where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m,
+   at the advanced positions
    ppart[m][n][0] = position x of particle n in tile m
    ppart[m][n][1] = position y of particle n in tile m
    ppart[m][n][2] = x momentum of particle n in tile m
    ppart[m][n][3] = y momentum of particle n in tile m
    ppart[m][n][4] = z momentum of particle n in tile m
    cu[k][j][i] = ith component of current density at grid point j,k
+   q[k][j] = charge density at grid point j,k
    kpic[k] = number of particles in tile k
    ncl[k][i] = number of particles going to destination i, tile k
    ihole[k][:][0] = location of hole in array left by departing particle
@@ -2307,34 +3298,40 @@ void cgrjppostf2l(float ppart[], float cu[], int kpic[], int ncl[],
    idimp = size of phase space = 5
    nx/ny = system length in x/y direction
    mx/my = number of grids in sorting cell in x/y
-   nxv = first dimension of current array, must be >= nx+1
-   nyv = second dimension of current array, must be >= ny+1
+   nxv = first dimension of current, charge arrays, must be >= nx+1
+   nyv = second dimension of current, charge arrays, must be >= ny+1
    mx1 = (system length in x direction - 1)/mx + 1
    mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
    ntmax = size of hole array for particles leaving tiles
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -1 if a particle moved a grid point or more, and no overflow
+   occurred
    optimized version
 local data                                                            */
 #define MXV             33
 #define MYV             33
    int noff, moff, npoff, npp;
-   int i, j, k, ih, nh, nn, mm, mxv3;
+   int i, j, k, ih, nh, nq, nn, mm, ii, jj, mxv3, mxv2;
    float ci2, dxp, dyp, amx, amy;
    float x, y, dx, dy, vx, vy, vz, p2, gami;
-   float anx, any, edgelx, edgely, edgerx, edgery;
-   float scu[3*MXV*MYV];
-/* float scu[3*(mx+1)*(my+1)]; */
+   float anx, any, edgelx, edgely, edgerx, edgery, edgeqx, edgeqy;
+   float scu[3*MXV*MYV], sq[(MXV+2)*(MYV+2)];
+/* float scu[3*(mx+1)*(my+1)], sq[(mx+3)*(my+3)]; */
    mxv3 = 3*(mx + 1);
+   mxv2 = mx + 3;
    ci2 = ci*ci;
    anx = (float) nx;
    any = (float) ny;
 /* error if local array is too small */
 /* if ((mx >= MXV) || (my >= MYV))   */
 /*    return;                        */
+   nq = 0;
 /* loop over tiles */
 #pragma omp parallel for \
 private(i,j,k,noff,moff,npp,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy,dx, \
-dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
+dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,edgeqx,edgeqy,ii,jj,p2, \
+gami,scu,sq) \
+reduction(+:nq)
    for (k = 0; k < mxy1; k++) {
       noff = k/mx1;
       moff = my*noff;
@@ -2349,6 +3346,8 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
       edgerx = noff + nn;
       edgely = moff;
       edgery = moff + mm;
+      edgeqx = edgerx - edgelx + 2.0f;
+      edgeqy = edgery - edgely + 2.0f;
       ih = 0;
       nh = 0;
       nn += 1;
@@ -2357,6 +3356,9 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
       for (j = 0; j < mxv3*(my+1); j++) {
          scu[j] = 0.0f;
       }
+      for (j = 0; j < mxv2*(my+3); j++) {
+         sq[j] = 0.0f;
+      }
 /* clear counters */
       for (j = 0; j < 8; j++) {
          ncl[j+8*k] = 0;
@@ -2406,6 +3408,28 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
 /* advance position half a time-step */
          dx = x + vx*dt;
          dy = y + vy*dt;
+/* deposit charge at new position to extended local accumulator */
+         x = dx - edgelx + 1.0f;
+         y = dy - edgely + 1.0f;
+/* particle moved a grid point or more */
+         if ((x < 0.0f) || (x >= edgeqx) || (y < 0.0f)
+            || (y >= edgeqy)) {
+            nq += 1;
+         }
+         else {
+            nn = x;
+            mm = y;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            nn += mxv2*mm;
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+            sq[nn] += amx*amy;
+            sq[nn+1] += dxp*amy;
+            nn += mxv2;
+            sq[nn] += amx*dyp;
+            sq[nn+1] += dxp*dyp;
+         }
 /* find particles going out of bounds */
          mm = 0;
 /* count how many particles are going in each direction in ncl   */
@@ -2511,6 +3535,34 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
             cu[2+3*(nn+noff-1+nxv*(j+moff))] += scu[2+3*(nn-1)+mxv3*j];
          }
       }
+/* deposit charge to global array with periodic wrap around,      */
+/* points which other tiles may also update are added atomically, */
+/* skipping zeros in the part of the halo no particle reached     */
+      nn = nx - noff;
+      mm = ny - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 0; j < mm+3; j++) {
+         jj = j + moff - 1;
+         if (jj < 0)
+            jj += ny;
+         else if (jj > ny)
+            jj -= ny;
+         for (i = 0; i < nn+3; i++) {
+            ii = i + noff - 1;
+            if (ii < 0)
+               ii += nx;
+            else if (ii > nx)
+               ii -= nx;
+            if ((i > 2) && (i < nn) && (j > 2) && (j < mm)) {
+               q[ii+nxv*jj] += sq[i+mxv2*j];
+            }
+            else if (sq[i+mxv2*j] != 0.0f) {
+#pragma omp atomic
+               q[ii+nxv*jj] += sq[i+mxv2*j];
+            }
+         }
+      }
 /* set error and end of file flag */
 /* ihole overflow */
       if (nh > 0) {
@@ -2519,6 +3571,9 @@ dy,vx,vy,vz,edgelx,edgely,edgerx,edgery,p2,gami,scu)
       }
       ihole[2*(ntmax+1)*k] = ih;
    }
+/* particles moved a grid point or more, if no ihole overflow */
+   if ((nq > 0) && (*irc==0))
+      *irc = -1;
    return;
 #undef MXV
 #undef MYV
@@ -3622,6 +4677,95 @@ reduction(+:sum1,sum2)
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cmsubmaxwel2(float complex exy[], float complex bxy[],
+                  float complex exya[], float complex bxya[],
+                  float complex exyt[], float complex bxyt[],
+                  float complex cu[], float complex ffc[], float ci,
+                  float dt, float *wf, float *wm, int nx, int ny,
+                  int nxvh, int nyv, int nxhd, int nyhd, int nsub) {
+/* this subroutine subcycles 2-1/2d maxwell's equation in fourier space,
+   advancing the transverse electric and magnetic fields nsub times with
+   time step dts = dt/nsub, using cmmaxwel2, with the current held
+   fixed.  the fields are averaged over a window of length dt centered
+   on the end of the step, so that the particles can be pushed with a
+   time step dt which does not resolve light waves, with OpenMP
+   the window uses the fields at the last nh = nsub/2 subcycles of the
+   step, at the end of the step, and at nh further subcycles advanced
+   in a copy exyt/bxyt.  if nsub is even, the first and last of these
+   fields have half weight.
+   input: all, output: wf, wm, exy, bxy, exya, bxya, exyt, bxyt
+   exy/bxy = complex transverse electric/magnetic field at end of step
+   exya/bxya = complex transverse electric/magnetic field averaged over
+   the nsub subcycles centered on the end of step
+   exyt/bxyt = scratch complex transverse electric/magnetic field
+   cu = complex current density, ffc = form factor array
+   ci = reciprocal of velocity of light
+   dt = time interval between successive particle pushes
+   wf/wm = transverse electric/magnetic field energy at end of step
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+   nsub = number of field subcycles per particle time step, nsub >= 1
+local data                                                 */
+   int j, n, nh, nxyv;
+   float dts, anorm, wh, at1, wft, wmt;
+   nxyv = 3*nxvh*nyv;
+   nh = nsub/2;
+   dts = dt/(float) nsub;
+   anorm = 1.0/(float) nsub;
+/* weight of first and last fields in window */
+   wh = nsub==2*nh ? 0.5 : 1.0;
+#pragma omp parallel for
+   for (j = 0; j < nxyv; j++) {
+      exya[j] = 0.0;
+      bxya[j] = 0.0;
+   }
+/* advance fields to end of step, summing from half a step before end */
+   for (n = 0; n < nsub; n++) {
+      cmmaxwel2(exy,bxy,cu,ffc,ci,dts,wf,wm,nx,ny,nxvh,nyv,nxhd,nyhd);
+      if ((n+nh) >= (nsub-1)) {
+         at1 = (n+nh)==(nsub-1) ? wh : 1.0;
+#pragma omp parallel for
+         for (j = 0; j < nxyv; j++) {
+            exya[j] += at1*exy[j];
+            bxya[j] += at1*bxy[j];
+         }
+      }
+   }
+/* advance copy of fields nh subcycles past end of step */
+   if (nh > 0) {
+      wft = *wf;
+      wmt = *wm;
+#pragma omp parallel for
+      for (j = 0; j < nxyv; j++) {
+         exyt[j] = exy[j];
+         bxyt[j] = bxy[j];
+      }
+      for (n = 0; n < nh; n++) {
+         cmmaxwel2(exyt,bxyt,cu,ffc,ci,dts,wf,wm,nx,ny,nxvh,nyv,nxhd,
+                   nyhd);
+         at1 = n==(nh-1) ? wh : 1.0;
+#pragma omp parallel for
+         for (j = 0; j < nxyv; j++) {
+            exya[j] += at1*exyt[j];
+            bxya[j] += at1*bxyt[j];
+         }
+      }
+/* energies at end of step */
+      *wf = wft;
+      *wm = wmt;
+   }
+#pragma omp parallel for
+   for (j = 0; j < nxyv; j++) {
+      exya[j] *= anorm;
+      bxya[j] *= anorm;
+   }
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cmemfield2(float complex fxy[], float complex exy[],
                 float complex ffc[], int isign, int nx, int ny,
@@ -4580,6 +5724,19 @@ void cgrbppushf23l_(float *ppart, float *fxy, float *bxy, int *kpic,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cvgrbppushf23l_(float *ppart, float *fxy, float *bxy, int *kpic,
+                     int *ncl, int *ihole, float *qbm, float *dt,
+                     float *dtc, float *ci, float *ek, int *idimp,
+                     int *nppmx, int *nx, int *ny, int *mx, int *my,
+                     int *nxv, int *nyv, int *mx1, int *mxy1,
+                     int *ntmax, int *irc) {
+   cvgrbppushf23l(ppart,fxy,bxy,kpic,ncl,ihole,*qbm,*dt,*dtc,*ci,ek,
+                  *idimp,*nppmx,*nx,*ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,
+                  *ntmax,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cgppost2l_(float *ppart, float *q, int *kpic, float *qm,
                 int *nppmx, int *idimp, int *mx, int *my, int *nxv,
@@ -4631,6 +5788,28 @@ void cgrjppostf2l_(float *ppart, float *cu, int *kpic, int *ncl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgjqppostf2l_(float *ppart, float *cu, float *q, int *kpic,
+                   int *ncl, int *ihole, float *qm, float *dt,
+                   int *nppmx, int *idimp, int *nx, int *ny, int *mx,
+                   int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                   int *ntmax, int *irc) {
+   cgjqppostf2l(ppart,cu,q,kpic,ncl,ihole,*qm,*dt,*nppmx,*idimp,*nx,
+                *ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgrjqppostf2l_(float *ppart, float *cu, float *q, int *kpic,
+                    int *ncl, int *ihole, float *qm, float *dt,
+                    float *ci, int *nppmx, int *idimp, int *nx, int *ny,
+                    int *mx, int *my, int *nxv, int *nyv, int *mx1,
+                    int *mxy1, int *ntmax, int *irc) {
+   cgrjqppostf2l(ppart,cu,q,kpic,ncl,ihole,*qm,*dt,*ci,*nppmx,*idimp,
+                 *nx,*ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpporder2l_(float *ppart, float *ppbuff, int *kpic, int *ncl,
                  int *ihole, int *idimp, int *nppmx, int *nx, int *ny,
@@ -4703,6 +5882,19 @@ void cmmaxwel2_(float complex *exy, float complex *bxy,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cmsubmaxwel2_(float complex *exy, float complex *bxy,
+                   float complex *exya, float complex *bxya,
+                   float complex *exyt, float complex *bxyt,
+                   float complex *cu, float complex *ffc, float *ci,
+                   float *dt, float *wf, float *wm, int *nx, int *ny,
+                   int *nxvh, int *nyv, int *nxhd, int *nyhd,
+                   int *nsub) {
+   cmsubmaxwel2(exy,bxy,exya,bxya,exyt,bxyt,cu,ffc,*ci,*dt,wf,wm,*nx,
+                *ny,*nxvh,*nyv,*nxhd,*nyhd,*nsub);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cmemfield2_(float complex *fxy, float complex *exy,
                  float complex *ffc, int *isign, int *nx, int *ny,
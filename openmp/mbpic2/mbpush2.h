@@ -39,6 +39,12 @@ void cgrbppushf23l(float ppart[], float fxy[], float bxy[], int kpic[],
                    int nx, int ny, int mx, int my, int nxv, int nyv,
                    int mx1, int mxy1, int ntmax, int *irc);
 
+void cvgrbppushf23l(float ppart[], float fxy[], float bxy[], int kpic[],
+                    int ncl[], int ihole[], float qbm, float dt,
+                    float dtc, float ci, float *ek, int idimp,
+                    int nppmx, int nx, int ny, int mx, int my, int nxv,
+                    int nyv, int mx1, int mxy1, int ntmax, int *irc);
+
 void cgppost2l(float ppart[], float q[], int kpic[], float qm,
                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
                int mx1, int mxy1);
@@ -62,6 +68,18 @@ void cgrjppostf2l(float ppart[], float cu[], int kpic[], int ncl[],
                   int idimp, int nx, int ny, int mx, int my, int nxv,
                   int nyv, int mx1, int mxy1, int ntmax, int *irc);
 
+void cgjqppostf2l(float ppart[], float cu[], float q[], int kpic[],
+                  int ncl[], int ihole[], float qm, float dt,
+                  int nppmx, int idimp, int nx, int ny, int mx, int my,
+                  int nxv, int nyv, int mx1, int mxy1, int ntmax,
+                  int *irc);
+
+void cgrjqppostf2l(float ppart[], float cu[], float q[], int kpic[],
+                   int ncl[], int ihole[], float qm, float dt,
+                   float ci, int nppmx, int idimp, int nx, int ny,
+                   int mx, int my, int nxv, int nyv, int mx1, int mxy1,
+                   int ntmax, int *irc);
+
 void cpporder2l(float ppart[], float ppbuff[], int kpic[], int ncl[],
                 int ihole[], int idimp, int nppmx, int nx, int ny,
                 int mx, int my, int mx1, int my1, int npbmx, int ntmax,
@@ -93,6 +111,13 @@ void cmmaxwel2(float complex exy[], float complex bxy[],
                float dt, float *wf, float *wm, int nx, int ny, int nxvh,
                int nyv, int nxhd, int nyhd);
 
+void cmsubmaxwel2(float complex exy[], float complex bxy[],
+                  float complex exya[], float complex bxya[],
+                  float complex exyt[], float complex bxyt[],
+                  float complex cu[], float complex ffc[], float ci,
+                  float dt, float *wf, float *wm, int nx, int ny,
+                  int nxvh, int nyv, int nxhd, int nyhd, int nsub);
+
 void cmemfield2(float complex fxy[], float complex exy[],
                 float complex ffc[], int isign, int nx, int ny,
                 int nxvh, int nyv, int nxhd, int nyhd);
@@ -0,0 +1,260 @@
+/*---------------------------------------------------------------------*/
+/* Benchmark for subcycled maxwell solver in 2-1/2D OpenMP PIC code    */
+/* compares particles and fields advanced with the same time step,     */
+/* limited by the Courant condition (cmmaxwel2), with particles pushed */
+/* with a larger time step while the fields are subcycled nsub times   */
+/* and time averaged (cmsubmaxwel2), for the same simulated time       */
+/* written for the Skeleton 2-1/2D Electromagnetic OpenMP PIC code     */
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+#include <sys/time.h>
+#include "mbpush2.h"
+#include "omplib.h"
+
+void dtimer(double *time, struct timeval *itime, int icntrl);
+
+static int crun(int nsub, float dt, float tend, int indx, int indy,
+                int npc, float tpart[], float *edrift, float *wtf);
+
+int main(int argc, char *argv[]) {
+/* indx/indy = exponent which determines grid points in x/y direction */
+   int indx = 7, indy = 7;
+/* npc = number of electrons per grid cell in each direction */
+   int npc = 4;
+/* tend = time at end of simulation, in units of plasma frequency */
+   float tend = 8.0;
+/* nsubs = list of subcycles, particle time step is nsub*dtf */
+/* dtf = field time step, must satisfy Courant condition */
+   int nsubs[5] = {1,2,3,4,5};
+   float dtf = 0.04;
+/* nvp = number of shared memory nodes (0=default) */
+   int nvp = 0;
+   int n, irc;
+   float tpart[3], edrift, wtf, sps;
+
+   irc = 0;
+   if (argc > 1)
+      nvp = atoi(argv[1]);
+/* initialize for shared memory parallel processing */
+   cinit_omp(nvp);
+   printf("nsub  dt      particle (sec) field (sec) total (sec) ");
+   printf("speedup  energy drift  field energy\n");
+   sps = 0.0;
+   for (n = 0; n < 5; n++) {
+      if (crun(nsubs[n],dtf*(float) nsubs[n],tend,indx,indy,npc,tpart,
+               &edrift,&wtf) != 0) {
+         printf("subbench2: run failed for nsub = %d\n",nsubs[n]);
+         irc = 1;
+         continue;
+      }
+      if (n==0)
+         sps = tpart[2];
+      printf("%4d  %5.3f %14.4f %11.4f %11.4f",nsubs[n],
+             dtf*(float) nsubs[n],tpart[0],tpart[1],tpart[2]);
+      printf(" %8.3f %13.4e %13.4e\n",sps/tpart[2],edrift,wtf);
+   }
+   printf("speedup = total time for nsub = 1 / total time\n");
+   printf("energy drift = largest relative change in total energy\n");
+   printf("field energy = final electrostatic and transverse field ");
+   printf("energy\n");
+
+   return irc;
+}
+
+/*--------------------------------------------------------------------*/
+static int crun(int nsub, float dt, float tend, int indx, int indy,
+                int npc, float tpart[], float *edrift, float *wtf) {
+/* runs the relativistic electromagnetic PIC code until time tend, with
+   particle time step dt and nsub maxwell solver subcycles per step
+   returns 0 if successful, otherwise 1.
+   tpart = particle, field and total time, in seconds
+   edrift = largest relative change in total energy
+   wtf = final total field energy
+local data                                                            */
+   int ndim = 3, idimp = 5, ipbc = 1, mx = 16, my = 16;
+   float qme = -1.0, vtx = 1.0, vty = 1.0, vtz = 1.0;
+   float ax = .912871, ay = .912871, ci = 0.1, xtras = 0.2;
+   int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
+   int mx1, my1, mxy1, nppmx, nppmx0, ntmax, npbmx;
+   int j, ntime, nloop, isign, irc;
+   float qbme, affp, dth, we, wf, wm, wke, wt, etot0;
+   float *part = NULL, *qe = NULL, *cue = NULL, *fxyze = NULL;
+   float *bxyze = NULL;
+   float complex *exyz = NULL, *bxyz = NULL, *exyza = NULL;
+   float complex *bxyza = NULL, *exyzs = NULL, *bxyzs = NULL;
+   float complex *exyzt = NULL, *bxyzt = NULL;
+   float complex *ffc = NULL, *sct = NULL;
+   int *mixup = NULL;
+   float *ppart = NULL, *ppbuff = NULL;
+   int *kpic = NULL, *ncl = NULL, *ihole = NULL;
+   struct timeval itime;
+   double dtime;
+
+   irc = 0;
+   nx = 1L<<indx; ny = 1L<<indy;
+   np = (npc*nx)*(npc*ny);
+   nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
+   nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
+   nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+   mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
+   nloop = tend/dt + .0001;
+   qbme = qme;
+   affp = (float) (nx*ny)/(float ) np;
+   dth = 0.0;
+   we = 0.0; wf = 0.0; wm = 0.0;
+   for (j = 0; j < 3; j++) {
+      tpart[j] = 0.0;
+   }
+   *edrift = 0.0;
+   *wtf = 0.0;
+   etot0 = 0.0;
+
+/* allocate data for standard code */
+   part = (float *) malloc(idimp*np*sizeof(float));
+   qe = (float *) malloc(nxe*nye*sizeof(float));
+   fxyze = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   cue = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   bxyze = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   exyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
+   bxyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
+   exyza = (float complex *) malloc(ndim*nxeh*nye
+                                    *sizeof(float complex));
+   bxyza = (float complex *) malloc(ndim*nxeh*nye
+                                    *sizeof(float complex));
+   exyzt = (float complex *) malloc(ndim*nxeh*nye
+                                    *sizeof(float complex));
+   bxyzt = (float complex *) malloc(ndim*nxeh*nye
+                                    *sizeof(float complex));
+   ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
+   mixup = (int *) malloc(nxhy*sizeof(int));
+   sct = (float complex *) malloc(nxyh*sizeof(float complex));
+   kpic = (int *) malloc(mxy1*sizeof(int));
+
+/* prepare fft tables and form factors */
+   cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+   isign = 0;
+   cmpois23((float complex *)qe,(float complex *)fxyze,isign,ffc,ax,ay,
+             affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+/* initialize electrons */
+   cdistr2h(part,vtx,vty,vtz,0.0,0.0,0.0,npc*nx,npc*ny,idimp,np,nx,ny,
+            ipbc);
+   for (j = 0; j < ndim*nxeh*nye; j++) {
+      exyz[j] = 0.0 + 0.0*_Complex_I;
+      bxyz[j] = 0.0 + 0.0*_Complex_I;
+   }
+   cdblkp2l(part,kpic,&nppmx,idimp,np,mx,my,mx1,mxy1,&irc);
+   if (irc != 0)
+      goto L10;
+   nppmx0 = (1.0 + xtras)*nppmx;
+   ntmax = xtras*nppmx;
+   npbmx = xtras*nppmx;
+   ppart = (float *) malloc(idimp*nppmx0*mxy1*sizeof(float));
+   ppbuff = (float *) malloc(idimp*npbmx*mxy1*sizeof(float));
+   ncl = (int *) malloc(8*mxy1*sizeof(int));
+   ihole = (int *) malloc(2*(ntmax+1)*mxy1*sizeof(int));
+   cppmovin2l(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   if (irc != 0)
+      goto L10;
+
+   for (ntime = 0; ntime < nloop; ntime++) {
+/* deposit current and charge, updates ppart, cue, qe */
+      dtimer(&dtime,&itime,-1);
+      for (j = 0; j < ndim*nxe*nye; j++) {
+         cue[j] = 0.0;
+      }
+      cgrjppostf2l(ppart,cue,kpic,ncl,ihole,qme,dth,ci,nppmx0,idimp,nx,
+                   ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+      if (irc != 0)
+         goto L10;
+      cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,my1,
+                  npbmx,ntmax,&irc);
+      if (irc != 0)
+         goto L10;
+      for (j = 0; j < nxe*nye; j++) {
+         qe[j] = 0.0;
+      }
+      cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,mxy1);
+      dtimer(&dtime,&itime,1);
+      tpart[0] += (float) dtime;
+/* solve for fields, updates exyz, bxyz, fxyze, bxyze, we, wf, wm */
+      dtimer(&dtime,&itime,-1);
+      cacguard2l(cue,nx,ny,nxe,nye);
+      caguard2l(qe,nx,ny,nxe,nye);
+      isign = -1;
+      cwfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cwfft2rm3((float complex *)cue,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cmcuperp2((float complex *)cue,nx,ny,nxeh,nye);
+      exyzs = exyz;
+      bxyzs = bxyz;
+      if (ntime==0) {
+         cmibpois23((float complex *)cue,bxyz,ffc,ci,&wm,nx,ny,nxeh,nye,
+                   nxh,nyh);
+         wf = 0.0;
+         dth = 0.5*dt;
+      }
+      else if (nsub > 1) {
+         cmsubmaxwel2(exyz,bxyz,exyza,bxyza,exyzt,bxyzt,
+                      (float complex *)cue,ffc,ci,dt,&wf,&wm,nx,ny,nxeh,
+                      nye,nxh,nyh,nsub);
+         exyzs = exyza;
+         bxyzs = bxyza;
+      }
+      else {
+         cmmaxwel2(exyz,bxyz,(float complex *)cue,ffc,ci,dt,&wf,&wm,nx,
+                   ny,nxeh,nye,nxh,nyh);
+      }
+      cmpois23((float complex *)qe,(float complex *)fxyze,isign,ffc,ax,
+               ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+      isign = 1;
+      cmemfield2((float complex *)fxyze,exyzs,ffc,isign,nx,ny,nxeh,nye,
+                 nxh,nyh);
+      isign = -1;
+      cmemfield2((float complex *)bxyze,bxyzs,ffc,isign,nx,ny,nxeh,nye,
+                 nxh,nyh);
+      isign = 1;
+      cwfft2rm3((float complex *)fxyze,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      cwfft2rm3((float complex *)bxyze,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      cbguard2l(fxyze,nx,ny,nxe,nye);
+      cbguard2l(bxyze,nx,ny,nxe,nye);
+      dtimer(&dtime,&itime,1);
+      tpart[1] += (float) dtime;
+/* push particles, updates ppart, wke */
+      wke = 0.0;
+      dtimer(&dtime,&itime,-1);
+      cgrbppushf23l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth,ci,
+                    &wke,idimp,nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,
+                    ntmax,&irc);
+      if (irc != 0)
+         goto L10;
+      cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,my1,
+                  npbmx,ntmax,&irc);
+      if (irc != 0)
+         goto L10;
+      dtimer(&dtime,&itime,1);
+      tpart[0] += (float) dtime;
+/* energy diagnostic */
+      wt = we + wf + wm;
+      if (ntime==0) {
+         etot0 = wt + wke;
+      }
+      else if (etot0 != 0.0) {
+         wt = fabsf((wt + wke)/etot0 - 1.0);
+         *edrift = wt > *edrift ? wt : *edrift;
+      }
+   }
+   *wtf = we + wf + wm;
+   tpart[2] = tpart[0] + tpart[1];
+
+L10: free(ihole); free(ncl); free(ppbuff); free(ppart);
+   free(kpic); free(sct); free(mixup); free(ffc);
+   free(bxyzt); free(exyzt); free(bxyza); free(exyza);
+   free(bxyz); free(exyz);
+   free(bxyze); free(cue); free(fxyze); free(qe); free(part);
+   return irc != 0;
+}
@@ -33,6 +33,14 @@ int main(int argc, char *argv[]) {
 /* ipbc = particle boundary condition: 1 = periodic */
 /* relativity = (no,yes) = (0,1) = relativity is used */
    int idimp = 6, ipbc = 1, relativity = 1;
+/* kvpush = (0,1) = (scalar,vectorizable) relativistic push */
+   int kvpush = 1;
+/* kfqj = (0,1) = deposit current and charge in (separate,one) pass */
+   int kfqj = 1;
+/* kqe = (0,1) = charge (not yet,already) deposited in this time step */
+/* nqjs = number of time steps in which kfqj = 1 fell back to a       */
+/* separate charge deposit                                            */
+   int kqe = 0, nqjs = 0;
 /* wke/we = particle kinetic/electrostatic field energy             */
 /* wf/wm/wt = magnetic field/transverse electric field/total energy */
    float wke = 0.0, we = 0.0, wf = 0.0, wm = 0.0, wt = 0.0;
@@ -182,31 +190,58 @@ L500: if (nloop <= ntime)
       for (j = 0; j < ndim*nxe*nye*nze; j++) {
          cue[j] = 0.0;
       }
-      if (relativity==1)
+      if (kfqj==1) {
+         for (j = 0; j < nxe*nye*nze; j++) {
+            qe[j] = 0.0;
+         }
+      }
+      if (relativity==1) {
 /* updates ppart, cue */
 /*       cgrjppost3l(ppart,cue,kpic,qme,dth,ci,nppmx0,idimp,nx,ny,nz, */
 /*                   mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,ipbc);        */
 /* updates ppart, cue, ncl, ihole, irc */
-         cgrjppostf3l(ppart,cue,kpic,ncl,ihole,qme,dth,ci,nppmx0,
-                      idimp,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,
-                      mxyz1,ntmax,&irc);
-      else
+         if (kfqj==0)
+            cgrjppostf3l(ppart,cue,kpic,ncl,ihole,qme,dth,ci,nppmx0,
+                         idimp,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,
+                         mxyz1,ntmax,&irc);
+/* updates ppart, cue, qe, ncl, ihole, irc */
+         else
+            cgrjqppostf3l(ppart,cue,qe,kpic,ncl,ihole,qme,dth,ci,
+                          nppmx0,idimp,nx,ny,nz,mx,my,mz,nxe,nye,nze,
+                          mx1,my1,mxyz1,ntmax,&irc);
+      }
+      else {
 /* updates ppart, cue */
 /*       cgjppost3l(ppart,cue,kpic,qme,dth,nppmx0,idimp,nx,ny,nz,mx, */
 /*                  my,mz,nxe,nye,nze,mx1,my1,mxyz1,ipbc);           */
 /* updates ppart, cue, ncl, ihole, irc */
-         cgjppostf3l(ppart,cue,kpic,ncl,ihole,qme,dth,nppmx0,idimp,
-                     nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,
-                     ntmax,&irc);
+         if (kfqj==0)
+            cgjppostf3l(ppart,cue,kpic,ncl,ihole,qme,dth,nppmx0,idimp,
+                        nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,
+                        ntmax,&irc);
+/* updates ppart, cue, qe, ncl, ihole, irc */
+         else
+            cgjqppostf3l(ppart,cue,qe,kpic,ncl,ihole,qme,dth,nppmx0,
+                         idimp,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,
+                         mxyz1,ntmax,&irc);
+      }
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdjpost += time;
+/* particles which moved a grid point or more were not deposited in */
+/* qe by the combined deposit: deposit the charge separately below  */
+      kqe = kfqj;
+      if (irc==(-1)) {
+         kqe = 0;
+         nqjs += 1;
+         irc = 0;
+      }
       if (irc != 0) {
          if (relativity==1) {
-            printf("cgrjppostf3l error: irc=%d\n",irc);
+            printf("cgrjppostf3l/cgrjqppostf3l error: irc=%d\n",irc);
          }
          else {
-            printf("cgjppostf3l error: irc=%d\n",irc);
+            printf("cgjppostf3l/cgjqppostf3l error: irc=%d\n",irc);
          }
          exit(1);
       }
@@ -228,15 +263,17 @@ L500: if (nloop <= ntime)
       }
 
 /* deposit charge with OpenMP: updates qe */
-      dtimer(&dtime,&itime,-1);
-      for (j = 0; j < nxe*nye*nze; j++) {
-         qe[j] = 0.0;
+      if (kqe==0) {
+         dtimer(&dtime,&itime,-1);
+         for (j = 0; j < nxe*nye*nze; j++) {
+            qe[j] = 0.0;
+         }
+         cgppost3l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,mz,nxe,nye,nze,
+                   mx1,my1,mxyz1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tdpost += time;
       }
-      cgppost3l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,mz,nxe,nye,nze,mx1,
-                my1,mxyz1);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tdpost += time;
 
 /* add guard cells with OpenMP: updates cue, qe */
       dtimer(&dtime,&itime,-1);
@@ -347,9 +384,14 @@ L500: if (nloop <= ntime)
 /*                   nppmx0,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,     */
 /*                   mxyz1,ipbc);                                      */
 /* updates ppart, ncl, ihole, wke, irc */
-         cgrbppushf3l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth, 
-                      ci,&wke,idimp,nppmx0,nx,ny,nz,mx,my,mz,nxe,nye,
-                      nze,mx1,my1,mxyz1,ntmax,&irc);
+         if (kvpush==1)
+            cvgrbppushf3l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth,
+                          ci,&wke,idimp,nppmx0,nx,ny,nz,mx,my,mz,nxe,
+                          nye,nze,mx1,my1,mxyz1,ntmax,&irc);
+         else
+            cgrbppushf3l(ppart,fxyze,bxyze,kpic,ncl,ihole,qbme,dt,dth, 
+                         ci,&wke,idimp,nppmx0,nx,ny,nz,mx,my,mz,nxe,nye,
+                         nze,mx1,my1,mxyz1,ntmax,&irc);
       else
 /* updates ppart, wke */
 /*       cgbppush3l(ppart,fxyze,bxyze,kpic,qbme,dt,dth,&wke,idimp, */
@@ -363,7 +405,10 @@ L500: if (nloop <= ntime)
       time = (float) dtime;
       tpush += time;
       if (irc != 0) {
-         if (relativity==1) {
+         if ((relativity==1) && (kvpush==1)) {
+            printf("cvgrbppushf3l error: irc=%d\n",irc);
+         }
+         else if (relativity==1) {
             printf("cgrbppushf3l error: irc=%d\n",irc);
          }
          else {
@@ -411,6 +456,9 @@ Energies:\n");
    printf("%e %e %e\n",we,wf,wm);
 
    printf("\n");
+   if (nqjs > 0) {
+      printf("time steps with separate charge deposit = %d\n",nqjs);
+   }
    printf("deposit time = %f\n",tdpost);
    printf("current deposit time = %f\n",tdjpost);
    tdpost += tdjpost;
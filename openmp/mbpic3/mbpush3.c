@@ -1783,6 +1783,465 @@ reduction(+:sum2)
 #undef MZV
 }
 
+/*--------------------------------------------------------------------*/
+void cvgrbppushf3l(float ppart[], float fxyz[], float bxyz[],
+                   int kpic[], int ncl[], int ihole[], float qbm,
+                   float dt, float dtc, float ci, float *ek, int idimp,
+                   int nppmx, int nx, int ny, int nz, int mx, int my,
+                   int mz, int nxv, int nyv, int nzv, int mx1, int my1,
+                   int mxyz1, int ntmax, int *irc) {
+/* for 3d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, for relativistic particles with magnetic field
+   Using the Boris Mover.
+   also determines list of particles which are leaving this tile
+   vectorizable version of cgrbppushf3l: particles are processed in
+   blocks of NPBLK, with separate loops for the interpolation weights,
+   the field gathers, the momentum update and the boundary check.
+   local fields are padded to N words per grid point and the gathers
+   from the eight nearest grid points use a table of tile offsets.
+   the inverse gammas are found from a reciprocal square root estimate
+   refined by three newton iterations, avoiding the divide and sqrtf
+   library call, so that the momentum loop has no branches or calls.
+   results agree with cgrbppushf3l to within single precision roundoff
+   OpenMP version using guard cells
+   data read in tiles
+   particles stored segmented array
+   229 flops/particle, 2 divides, 54 loads, 6 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   momentum equations used are:
+   px(t+dt/2) = rot(1)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t),z(t))*dt) +
+      rot(2)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t),z(t))*dt) +
+      rot(3)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t),z(t))*dt) +
+      .5*(q/m)*fx(x(t),y(t),z(t))*dt)
+   py(t+dt/2) = rot(4)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t),z(t))*dt) +
+      rot(5)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t),z(t))*dt) +
+      rot(6)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t),z(t))*dt) +
+      .5*(q/m)*fy(x(t),y(t),z(t))*dt)
+   pz(t+dt/2) = rot(7)*(px(t-dt/2) + .5*(q/m)*fx(x(t),y(t),z(t))*dt) +
+      rot(8)*(py(t-dt/2) + .5*(q/m)*fy(x(t),y(t),z(t))*dt) +
+      rot(9)*(pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t),z(t))*dt) +
+      .5*(q/m)*fz(x(t),y(t),z(t))*dt)
+   where q/m is charge/mass, and the rotation matrix is given by:
+      rot(1) = (1 - (om*dt/2)**2 + 2*(omx*dt/2)**2)/(1 + (om*dt/2)**2)
+      rot(2) = 2*(omz*dt/2 + (omx*dt/2)*(omy*dt/2))/(1 + (om*dt/2)**2)
+      rot(3) = 2*(-omy*dt/2 + (omx*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot(4) = 2*(-omz*dt/2 + (omx*dt/2)*(omy*dt/2))/(1 + (om*dt/2)**2)
+      rot(5) = (1 - (om*dt/2)**2 + 2*(omy*dt/2)**2)/(1 + (om*dt/2)**2)
+      rot(6) = 2*(omx*dt/2 + (omy*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot(7) = 2*(omy*dt/2 + (omx*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot(8) = 2*(-omx*dt/2 + (omy*dt/2)*(omz*dt/2))/(1 + (om*dt/2)**2)
+      rot(9) = (1 - (om*dt/2)**2 + 2*(omz*dt/2)**2)/(1 + (om*dt/2)**2)
+   and om**2 = omx**2 + omy**2 + omz**2
+   the rotation matrix is determined by:
+   omx = (q/m)*bx(x(t),y(t),z(t))*gami, 
+   omy = (q/m)*by(x(t),y(t),z(t))*gami,
+   omz = (q/m)*bz(x(t),y(t),z(t))*gami,
+   where gami = 1./sqrt(1.+(px(t)*px(t)+py(t)*py(t)+pz(t)*pz(t))*ci*ci)
+   position equations used are:
+   x(t+dt) = x(t) + px(t+dt/2)*dtg
+   y(t+dt) = y(t) + py(t+dt/2)*dtg
+   z(t+dt) = z(t) + pz(t+dt/2)*dtg
+   where dtg = dtc/sqrt(1.+(px(t+dt/2)*px(t+dt/2)+py(t+dt/2)*py(t+dt/2)+
+   pz(t+dt/2)*pz(t+dt/2))*ci*ci)
+   fx(x(t),y(t),z(t)), fy(x(t),y(t),z(t)), and fz(x(t),y(t),z(t)),
+   bx(x(t),y(t),z(t)), by(x(t),y(t),z(t)), and bz(x(t),y(t),z(t))
+   are approximated by interpolation from the nearest grid points:
+   fx(x,y,z) = (1-dz)*((1-dy)*((1-dx)*fx(n,m,l)+dx*fx(n+1,m,l))
+                  + dy*((1-dx)*fx(n,m+1,l) + dx*fx(n+1,m+1,l)))
+             + dz*((1-dy)*((1-dx)*fx(n,m,l+1)+dx*fx(n+1,m,l+1))
+                  + dy*((1-dx)*fx(n,m+1,l+1) + dx*fx(n+1,m+1,l+1)))
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
+   similarly for fy(x,y,z), fz(x,y,z), bx(x,y,z), by(x,y,z), bz(x,y,z)
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = position z of particle n in tile m
+   ppart[m][n][3] = momentum px of particle n in tile m
+   ppart[m][n][4] = momentum py of particle n in tile m
+   ppart[m][n][5] = momentum pz of particle n in tile m
+   fxyz[l][k][j][0] = x component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][1] = y component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][2] = z component of force/charge at grid (j,k,l)
+   that is, convolution of electric field over particle shape
+   bxyz[l][k][j][0] = x component of magnetic field at grid (j,k,l)
+   bxyz[l][k][j][1] = y component of magnetic field at grid (j,k,l)
+   bxyz[l][k][j][2] = z component of magnetic field at grid (j,k,l)
+   that is, the convolution of magnetic field over particle shape
+   kpic[l] = number of particles in tile l
+   ncl[l][i] = number of particles going to destination i, tile l
+   ihole[l][:][0] = location of hole in array left by departing particle
+   ihole[l][:][1] = direction destination of particle leaving hole
+   all for tile l
+   ihole[l][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass ratio
+   dt = time interval between successive force calculations
+   dtc = time interval between successive co-ordinate calculations
+   ci = reciprocal of velocity of light
+   kinetic energy/mass at time t is also calculated, using
+   ek = gami*sum((px(t-dt/2) + .5*(q/m)*fx(x(t),y(t))*dt)**2 +
+        (py(t-dt/2) + .5*(q/m)*fy(x(t),y(t))*dt)**2 +
+        (pz(t-dt/2) + .5*(q/m)*fz(x(t),y(t))*dt)**2)/(1. + gami)
+   idimp = size of phase space = 6
+   nppmx = maximum number of particles in tile
+   nx/ny/nz = system length in x/y/z direction
+   mx/my/mz = number of grids in sorting cell in x/y/z
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   nzv = fourth dimension of field array, must be >= nz+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   mxyz1 = mx1*my1*mz1,
+   where mz1 = (system length in z direction - 1)/mz + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   optimized version
+local data                                                            */
+#define MXV             17
+#define MYV             17
+#define MZV             17
+#define NPBLK             32
+#define LVECT             8
+#define N 4
+   int mxy1, noff, moff, loff, npoff, npp, ipp, joff, nps;
+   int i, j, k, l, ih, nh, nn, mm, ll, mxv, myv, mxyv, nxyv;
+   float anx, any, anz, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float dxp, dyp, dzp, amx, amy, amz, dx, dy, dz, ox, oy, oz, dx1;
+   float acx, acy, acz, p2, gami, qtmg, omxt, omyt, omzt, omt, anorm;
+   float rot1, rot2, rot3, rot4, rot5, rot6, rot7, rot8, rot9, dtg;
+   float qtmh, ci2, x, y, z, vx, vy, vz;
+   float sfxyz[N*MXV*MYV*MZV], sbxyz[N*MXV*MYV*MZV];
+/* float sfxyz[N*(mx+1)*(my+1)*(mz+1)]; */
+/* float sbxyz[N*(mx+1)*(my+1)*(mz+1)]; */
+/* scratch arrays */
+   int n[NPBLK], m[LVECT];
+   float s1[NPBLK*LVECT], s2[NPBLK*3], t[NPBLK*4];
+   double sum1, sum2;
+/* union used to form initial estimate of reciprocal square root */
+   union {float f; int i;} rs;
+/* mxv = MXV; */
+/* myv = MYV; */
+   mxv = mx+1;
+   myv = my+1;
+   mxyv = mxv*myv;
+   nxyv = nxv*nyv;
+   mxy1 = mx1*my1;
+   m[0] = 0;
+   m[1] = N;
+   m[2] = N*mxv;
+   m[3] = N*(mxv + 1);
+   m[4] = N*mxyv;
+   m[5] = N*(mxyv + 1);
+   m[6] = N*(mxyv + mxv);
+   m[7] = N*(mxyv + mxv + 1);
+   qtmh = 0.5f*qbm*dt;
+   ci2 = ci*ci;
+   anx = (float) nx;
+   any = (float) ny;
+   anz = (float) nz;
+   sum2 = 0.0;
+/* error if local array is too small                */
+/* if ((mx >= MXV) || (my >= MYV) || (mz >= MZV))   */
+/*    return;                                       */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,l,noff,moff,loff,npp,npoff,ipp,joff,nps,nn,mm,ll,ih,nh, \
+x,y,z,vx,vy,vz,dxp,dyp,dzp,amx,amy,amz,dx1,dx,dy,dz,ox,oy,oz,acx,acy, \
+acz,omxt,omyt,omzt,omt,anorm,rot1,rot2,rot3,rot4,rot5,rot6,rot7,rot8, \
+rot9,p2,gami,qtmg,dtg,edgelx,edgely,edgelz,edgerx,edgery,edgerz,sum1, \
+sfxyz,sbxyz,n,s1,s2,t,rs) \
+reduction(+:sum2)
+   for (l = 0; l < mxyz1; l++) {
+      loff = l/mxy1;
+      k = l - mxy1*loff;
+      loff = mz*loff;
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[l];
+      npoff = nppmx*l;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ll = nz - loff;
+      ll = mz < ll ? mz : ll;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      edgelz = loff;
+      edgerz = loff + ll;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+      ll += 1;
+/* load local fields from global array */
+      for (k = 0; k < ll; k++) {
+         for (j = 0; j < mm; j++) {
+            for (i = 0; i < nn; i++) {
+               sfxyz[N*(i+mxv*j+mxyv*k)]
+               = fxyz[3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sfxyz[1+N*(i+mxv*j+mxyv*k)]
+               = fxyz[1+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sfxyz[2+N*(i+mxv*j+mxyv*k)]
+               = fxyz[2+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sfxyz[3+N*(i+mxv*j+mxyv*k)] = 0.0f;
+            }
+         }
+      }
+      for (k = 0; k < ll; k++) {
+         for (j = 0; j < mm; j++) {
+            for (i = 0; i < nn; i++) {
+               sbxyz[N*(i+mxv*j+mxyv*k)]
+               = bxyz[3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sbxyz[1+N*(i+mxv*j+mxyv*k)]
+               = bxyz[1+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sbxyz[2+N*(i+mxv*j+mxyv*k)]
+               = bxyz[2+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))];
+               sbxyz[3+N*(i+mxv*j+mxyv*k)] = 0.0f;
+            }
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 26; j++) {
+         ncl[j+26*l] = 0;
+      }
+      sum1 = 0.0;
+      ipp = (npp + NPBLK - 1)/NPBLK;
+/* outer loop over blocks, the last one possibly partial */
+      for (k = 0; k < ipp; k++) {
+         joff = NPBLK*k;
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* inner loop over particles in block */
+         for (j = 0; j < nps; j++) {
+/* find interpolation weights */
+            x = ppart[idimp*(j+joff+npoff)];
+            y = ppart[1+idimp*(j+joff+npoff)];
+            z = ppart[2+idimp*(j+joff+npoff)];
+            nn = x;
+            mm = y;
+            ll = z;
+            dxp = x - (float) nn;
+            dyp = y - (float) mm;
+            dzp = z - (float) ll;
+            n[j] = N*(nn - noff + mxv*(mm - moff) + mxyv*(ll - loff));
+            amx = 1.0f - dxp;
+            amy = 1.0f - dyp;
+            dx1 = dxp*dyp;
+            dyp = amx*dyp;
+            amx = amx*amy;
+            amz = 1.0f - dzp;
+            amy = dxp*amy;
+            s1[j] = amx*amz;
+            s1[j+NPBLK] = amy*amz;
+            s1[j+2*NPBLK] = dyp*amz;
+            s1[j+3*NPBLK] = dx1*amz;
+            s1[j+4*NPBLK] = amx*dzp;
+            s1[j+5*NPBLK] = amy*dzp;
+            s1[j+6*NPBLK] = dyp*dzp;
+            s1[j+7*NPBLK] = dx1*dzp;
+            t[j] = x;
+            t[j+NPBLK] = y;
+            t[j+2*NPBLK] = z;
+         }
+/* find acceleration */
+         for (j = 0; j < nps; j++) {
+            dx = 0.0f;
+            dy = 0.0f;
+            dz = 0.0f;
+            ox = 0.0f;
+            oy = 0.0f;
+            oz = 0.0f;
+            for (i = 0; i < LVECT; i++) {
+               dx += sfxyz[n[j]+m[i]]*s1[j+NPBLK*i];
+               dy += sfxyz[1+n[j]+m[i]]*s1[j+NPBLK*i];
+               dz += sfxyz[2+n[j]+m[i]]*s1[j+NPBLK*i];
+               ox += sbxyz[n[j]+m[i]]*s1[j+NPBLK*i];
+               oy += sbxyz[1+n[j]+m[i]]*s1[j+NPBLK*i];
+               oz += sbxyz[2+n[j]+m[i]]*s1[j+NPBLK*i];
+            }
+            s1[j] = dx;
+            s1[j+NPBLK] = dy;
+            s1[j+2*NPBLK] = dz;
+            s2[j] = ox;
+            s2[j+NPBLK] = oy;
+            s2[j+2*NPBLK] = oz;
+         }
+/* new momentum */
+         for (j = 0; j < nps; j++) {
+            x = t[j];
+            y = t[j+NPBLK];
+            z = t[j+2*NPBLK];
+/* calculate half impulse */
+            dx = qtmh*s1[j];
+            dy = qtmh*s1[j+NPBLK];
+            dz = qtmh*s1[j+2*NPBLK];
+/* half acceleration */
+            acx = ppart[3+idimp*(j+joff+npoff)] + dx;
+            acy = ppart[4+idimp*(j+joff+npoff)] + dy;
+            acz = ppart[5+idimp*(j+joff+npoff)] + dz;
+/* find inverse gamma */
+            p2 = acx*acx + acy*acy + acz*acz;
+            omt = 1.0f + p2*ci2;
+            rs.f = omt;
+            rs.i = 0x5f3759df - (rs.i >> 1);
+            gami = rs.f;
+            omt *= 0.5f;
+            gami = gami*(1.5f - omt*gami*gami);
+            gami = gami*(1.5f - omt*gami*gami);
+            gami = gami*(1.5f - omt*gami*gami);
+/* renormalize magnetic field */
+            qtmg = qtmh*gami;
+/* time-centered kinetic energy */
+            t[j+3*NPBLK] = gami*p2/(1.0f + gami);
+/* calculate cyclotron frequency */
+            omxt = qtmg*s2[j];
+            omyt = qtmg*s2[j+NPBLK];
+            omzt = qtmg*s2[j+2*NPBLK];
+/* calculate rotation matrix */
+            omt = omxt*omxt + omyt*omyt + omzt*omzt;
+            anorm = 2.0f/(1.0f + omt);
+            omt = 0.5f*(1.0f - omt);
+            rot4 = omxt*omyt;
+            rot7 = omxt*omzt;
+            rot8 = omyt*omzt;
+            rot1 = omt + omxt*omxt;
+            rot5 = omt + omyt*omyt;
+            rot9 = omt + omzt*omzt;
+            rot2 = omzt + rot4;
+            rot4 -= omzt;
+            rot3 = -omyt + rot7;
+            rot7 += omyt;
+            rot6 = omxt + rot8;
+            rot8 -= omxt;
+/* new velocity */
+            vx = (rot1*acx + rot2*acy + rot3*acz)*anorm + dx;
+            vy = (rot4*acx + rot5*acy + rot6*acz)*anorm + dy;
+            vz = (rot7*acx + rot8*acy + rot9*acz)*anorm + dz;
+/* update inverse gamma */
+            p2 = vx*vx + vy*vy + vz*vz;
+            omt = 1.0f + p2*ci2;
+            rs.f = omt;
+            rs.i = 0x5f3759df - (rs.i >> 1);
+            dtg = rs.f;
+            omt *= 0.5f;
+            dtg = dtg*(1.5f - omt*dtg*dtg);
+            dtg = dtg*(1.5f - omt*dtg*dtg);
+            dtg = dtc*dtg*(1.5f - omt*dtg*dtg);
+/* new position */
+            s1[j] = x + vx*dtg;
+            s1[j+NPBLK] = y + vy*dtg;
+            s1[j+2*NPBLK] = z + vz*dtg;
+            s2[j] = vx;
+            s2[j+NPBLK] = vy;
+            s2[j+2*NPBLK] = vz;
+         }
+/* check boundary conditions */
+         for (j = 0; j < nps; j++) {
+            dx = s1[j];
+            dy = s1[j+NPBLK];
+            dz = s1[j+2*NPBLK];
+            sum1 += t[j+3*NPBLK];
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                             */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx = dx - anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0f;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy = dy - any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0f) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0f;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+            if (dz >= edgerz) {
+               if (dz >= anz)
+                  dz = dz - anz;
+               mm += 18;
+            }
+            else if (dz < edgelz) {
+               if (dz < 0.0f) {
+                  dz += anz;
+                  if (dz < anz)
+                     mm += 9;
+                  else
+                     dz = 0.0f;
+               }
+               else {
+                  mm += 9;
+               }
+            }
+/* set new position */
+            ppart[idimp*(j+joff+npoff)] = dx;
+            ppart[1+idimp*(j+joff+npoff)] = dy;
+            ppart[2+idimp*(j+joff+npoff)] = dz;
+/* set new velocity */
+            ppart[3+idimp*(j+joff+npoff)] = s2[j];
+            ppart[4+idimp*(j+joff+npoff)] = s2[j+NPBLK];
+            ppart[5+idimp*(j+joff+npoff)] = s2[j+2*NPBLK];
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+26*l-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*l)] = j + joff + 1;
+                  ihole[1+2*(ih+(ntmax+1)*l)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*l] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += sum2;
+   return;
+#undef N
+#undef LVECT
+#undef NPBLK
+#undef MXV
+#undef MYV
+#undef MZV
+}
+
 /*--------------------------------------------------------------------*/
 void cgppost3l(float ppart[], float q[], int kpic[], float qm,
                int nppmx, int idimp, int mx, int my, int mz, int nxv,
@@ -2762,14 +3221,818 @@ void cgrjppost3l(float ppart[], float cu[], int kpic[], float qm,
    ppart[m][n][0] = position x of particle n in tile m
    ppart[m][n][1] = position y of particle n in tile m
    ppart[m][n][2] = position z of particle n in tile m
-   ppart[m][n][3] = x momentum of particle n in tile m
-   ppart[m][n][4] = y momentum of particle n in tile m
-   ppart[m][n][5] = z momentum of particle n in tile m
+   ppart[m][n][3] = x momentum of particle n in tile m
+   ppart[m][n][4] = y momentum of particle n in tile m
+   ppart[m][n][5] = z momentum of particle n in tile m
+   cu[l][k][j][i] = ith component of current density at grid point j,k,l
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   dt = time interval between successive calculations
+   ci = reciprocal of velocity of light
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 6
+   nx/ny/nz = system length in x/y/z direction
+   mx/my/mz = number of grids in sorting cell in x/y/z
+   nxv = second dimension of current array, must be >= nx+1
+   nyv = third dimension of current array, must be >= ny+1
+   nzv = fourth dimension of current array, must be >= nz+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   mxyz1 = mx1*my1*mz1,
+   where mz1 = (system length in z direction - 1)/mz + 1
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,3d periodic,3d reflecting,mixed 2d reflecting/1d periodic)
+local data                                                            */
+#define MXV             17
+#define MYV             17
+#define MZV             17
+   int mxy1, noff, moff, loff, npoff, npp;
+   int i, j, k, l, nn, mm, ll, nm, lm, mxv, myv, mxyv, nxyv;
+   float ci2, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float dxp, dyp, dzp, amx, amy, amz, dx1, dx, dy, dz, vx, vy, vz;
+   float x, y, z, p2, gami;
+   float scu[3*MXV*MYV*MZV];
+/* float scu[3*(mx+1)*(my+1)*(mz+1)]; */
+/* mxv = MXV; */
+/* myv = MYV; */
+   mxv = mx+1;
+   myv = my+1;
+   mxyv = mxv*myv;
+   nxyv = nxv*nyv;
+   mxy1 = mx1*my1;
+   ci2 = ci*ci;
+/* set boundary values */
+   edgelx = 0.0f;
+   edgely = 0.0f;
+   edgelz = 0.0f;
+   edgerx = (float) nx;
+   edgery = (float) ny;
+   edgerz = (float) nz;
+   if (ipbc==2) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgelz = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+      edgerz = (float) (nz-1);
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+   }
+/* error if local array is too small                */
+/* if ((mx >= MXV) || (my >= MYV) || (mz >= MZV))   */
+/*    return;                                       */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,l,noff,moff,loff,npp,npoff,nn,mm,ll,nm,lm,x,y,z,dxp,dyp, \
+dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
+   for (l = 0; l < mxyz1; l++) {
+      loff = l/mxy1;
+      k = l - mxy1*loff;
+      loff = mz*loff;
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[l];
+      npoff = nppmx*l;
+/* zero out local accumulator */
+      for (j = 0; j < 3*mxyv*(mz+1); j++) {
+         scu[j] = 0.0f;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         z = ppart[2+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         ll = z;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+         dzp = z - (float) ll;
+/* find inverse gamma */
+         vx = ppart[3+idimp*(j+npoff)];
+         vy = ppart[4+idimp*(j+npoff)];
+         vz = ppart[5+idimp*(j+npoff)];
+         p2 = vx*vx + vy*vy + vz*vz;
+         gami = 1.0f/sqrtf(1.0f + p2*ci2);
+/* calculate weights */
+         nn = 3*(nn - noff + mxv*(mm - moff) + mxyv*(ll - loff));
+         amx = qm - dxp;
+         amy = 1.0f - dyp;
+         dx1 = dxp*dyp;
+         dyp = amx*dyp;
+         amx = amx*amy;
+         amz = 1.0f - dzp;
+         amy = dxp*amy;
+/* deposit current within tile to local accumulator */
+         dx = amx*amz;
+         dy = amy*amz;
+         vx *= gami;
+         vy *= gami;
+         vz *= gami;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = dyp*amz;
+         scu[nn+3] += vx*dy;
+         scu[nn+1+3] += vy*dy;
+         scu[nn+2+3] += vz*dy;
+         dy = dx1*amz;
+         mm = nn + 3*mxv;
+         scu[mm] += vx*dx;
+         scu[mm+1] += vy*dx;
+         scu[mm+2] += vz*dx;
+         dx = amx*dzp;
+         scu[mm+3] += vx*dy;
+         scu[mm+1+3] += vy*dy;
+         scu[mm+2+3] += vz*dy;
+         dy = amy*dzp;
+         nn += 3*mxyv;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = dyp*dzp;
+         scu[nn+3] += vx*dy;
+         scu[nn+1+3] += vy*dy;
+         scu[nn+2+3] += vz*dy;
+         dy = dx1*dzp;
+         mm = nn + 3*mxv;
+         scu[mm] += vx*dx;
+         scu[mm+1] += vy*dx;
+         scu[mm+2] += vz*dx;
+         scu[mm+3] += vx*dy;
+         scu[mm+1+3] += vy*dy;
+         scu[mm+2+3] += vz*dy;
+/* advance position half a time-step */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+         dz = z + vz*dt;
+/* reflecting boundary conditions */
+         if (ipbc==2) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = y;
+               ppart[4+idimp*(j+npoff)] = -ppart[4+idimp*(j+npoff)];
+            }
+            if ((dz < edgelz) || (dz >= edgerz)) {
+               dz = z;
+               ppart[5+idimp*(j+npoff)] = -ppart[5+idimp*(j+npoff)];
+            }
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = y;
+               ppart[4+idimp*(j+npoff)] = -ppart[4+idimp*(j+npoff)];
+            }
+         }
+/* set new position */
+         ppart[idimp*(j+npoff)] = dx;
+         ppart[1+idimp*(j+npoff)] = dy;
+         ppart[2+idimp*(j+npoff)] = dz;
+      }
+/* deposit current to interior points in global array */
+      nn = nxv - noff;
+      nn = mx < nn ? mx : nn;
+      mm = nyv - moff;
+      mm = my < mm ? my : mm;
+      ll = nzv - loff;
+      ll = mz < ll ? mz : ll;
+      for (k = 1; k < ll; k++) {
+         for (j = 1; j < mm; j++) {
+            for (i = 1; i < nn; i++) {
+               cu[3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[3*(i+mxv*j+mxyv*k)];
+               cu[1+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[1+3*(i+mxv*j+mxyv*k)];
+               cu[2+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[2+3*(i+mxv*j+mxyv*k)];
+            }
+         }
+      }
+/* deposit current to edge points in global array */
+      lm = nzv - loff;
+      lm = mz+1 < lm ? mz+1 : lm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*(j+moff)+nxyv*loff)] += scu[3*(i+mxv*j)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*(j+moff)+nxyv*loff)]
+            += scu[1+3*(i+mxv*j)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*(j+moff)+nxyv*loff)]
+            += scu[2+3*(i+mxv*j)];
+            if (lm > mz) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[3*(i+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[1+3*(i+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[2+3*(i+mxv*j+mxyv*(lm-1))];
+            }
+         }
+      }
+      nm = nxv - noff;
+      nm = mx+1 < nm ? mx+1 : nm;
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (k = 0; k < ll; k++) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*moff+nxyv*(k+loff))] += scu[3*(i+mxyv*k)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*moff+nxyv*(k+loff))]
+            += scu[1+3*(i+mxyv*k)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*moff+nxyv*(k+loff))]
+            += scu[2+3*(i+mxyv*k)];
+            if (mm > my) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[3*(i+mxv*(mm-1)+mxyv*k)];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[1+3*(i+mxv*(mm-1)+mxyv*k)];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[2+3*(i+mxv*(mm-1)+mxyv*k)];
+            }
+         }
+         for (j = 0; j < mm; j++) {
+#pragma omp atomic
+            cu[3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[3*(mxv*j+mxyv*k)];
+#pragma omp atomic
+            cu[1+3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[1+3*(mxv*j+mxyv*k)];
+#pragma omp atomic
+            cu[2+3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[2+3*(mxv*j+mxyv*k)];
+            if (nm > mx) {
+#pragma omp atomic
+               cu[3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[3*(nm-1+mxv*j+mxyv*k)];
+#pragma omp atomic
+               cu[1+3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[1+3*(nm-1+mxv*j+mxyv*k)];
+#pragma omp atomic
+               cu[2+3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[2+3*(nm-1+mxv*j+mxyv*k)];
+            }
+         }
+      }
+      if (lm > mz) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[3*(i+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[1+3*(i+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[2+3*(i+mxyv*(lm-1))];
+            if (mm > my) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[1+3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[2+3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+            }
+         }
+         for (j = 0; j < mm; j++) {
+#pragma omp atomic
+            cu[3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[3*(mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[1+3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[1+3*(mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[2+3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[2+3*(mxv*j+mxyv*(lm-1))];
+            if (nm > mx) {
+#pragma omp atomic
+               cu[3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[3*(nm-1+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[1+3*(nm-1+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[2+3*(nm-1+mxv*j+mxyv*(lm-1))];
+            }
+         }
+      }
+   }
+   return;
+#undef MXV
+#undef MYV
+#undef MZV
+}
+
+/*--------------------------------------------------------------------*/
+void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
+                  int ihole[], float qm, float dt, float ci, int nppmx,
+                  int idimp, int nx, int ny, int nz, int mx, int my,
+                  int mz, int nxv, int nyv, int nzv, int mx1, int my1,
+                  int mxyz1, int ntmax, int *irc) {
+/* for 3d code, this subroutine calculates particle current density
+   using first-order linear interpolation for relativistic particles
+   in addition, particle positions are advanced a half time-step
+   with periodic boundary conditions.
+   also determines list of particles which are leaving this tile
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   79 flops/particle, 1 divide, 1 sqrt, 30 loads, 27 stores
+   input: all except ncl, ihole, irc,
+   output: ppart, cu, ncl, ihole, irc
+   current density is approximated by values at the nearest grid points
+  cu(i,n,m,l)=qci*(1.-dx)*(1.-dy)*(1.-dz)
+   cu(i,n+1,m,l)=qci*dx*(1.-dy)*(1.-dz)
+   cu(i,n,m+1,l)=qci*(1.-dx)*dy*(1.-dz)
+   cu(i,n+1,m+1,l)=qci*dx*dy*(1.-dz)
+   cu(i,n,m,l+1)=qci*(1.-dx)*(1.-dy)*dz
+   cu(i,n+1,m,l+1)=qci*dx*(1.-dy)*dz
+   cu(i,n,m+1,l+1)=qci*(1.-dx)*dy*dz
+   cu(i,n+1,m+1,l+1)=qci*dx*dy*dz
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
+   and qci = qm*pi*gami, where i = x,y,z
+   where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = position z of particle n in tile m
+   ppart[m][n][3] = x momentum of particle n in tile m
+   ppart[m][n][4] = y momentum of particle n in tile m
+   ppart[m][n][5] = z momentum of particle n in tile m
+   cu[l][k][j][i] = ith component of current density at grid point j,k,l
+   kpic[l] = number of particles in tile l
+   ncl[l][i] = number of particles going to destination i, tile l
+   ihole[l][:][0] = location of hole in array left by departing particle
+   ihole[l][:][1] = direction destination of particle leaving hole
+   all for tile l
+   ihole[l][0][0] = ih, number of holes left (error, if negative)
+   qm = charge on particle, in units of e
+   dt = time interval between successive calculations
+   ci = reciprocal of velocity of light
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 6
+   nx/ny/nz = system length in x/y/z direction
+   mx/my/mz = number of grids in sorting cell in x/y/z
+   nxv = second dimension of current array, must be >= nx+1
+   nyv = third dimension of current array, must be >= ny+1
+   nzv = fourth dimension of current array, must be >= nz+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   mxyz1 = mx1*my1*mz1,
+   where mz1 = (system length in z direction - 1)/mz + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   optimized version
+local data                                                            */
+#define MXV             17
+#define MYV             17
+#define MZV             17
+   int mxy1, noff, moff, loff, npoff, npp;
+   int i, j, k, l, ih, nh, nn, mm, ll, nm, lm, mxv, myv, mxyv, nxyv;
+   float anx, any, anz, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float dxp, dyp, dzp, amx, amy, amz, dx1, dx, dy, dz, vx, vy, vz;
+   float ci2, x, y, z, p2, gami;
+   float scu[3*MXV*MYV*MZV];
+/* float scu[3*(mx+1)*(my+1)*(mz+1)]; */
+/* mxv = MXV; */
+/* myv = MYV; */
+   mxv = mx+1;
+   myv = my+1;
+   mxyv = mxv*myv;
+   nxyv = nxv*nyv;
+   mxy1 = mx1*my1;
+   ci2 = ci*ci;
+   anx = (float) nx;
+   any = (float) ny;
+   anz = (float) nz;
+/* error if local array is too small                */
+/* if ((mx >= MXV) || (my >= MYV) || (mz >= MZV))   */
+/*    return;                                       */
+#pragma omp parallel for \
+private(i,j,k,l,noff,moff,loff,npp,npoff,nn,mm,ll,ih,nh,nm,lm,x,y,z, \
+dxp,dyp,dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,edgelx,edgely, \
+edgelz,edgerx,edgery,edgerz,scu)
+   for (l = 0; l < mxyz1; l++) {
+      loff = l/mxy1;
+      k = l - mxy1*loff;
+      loff = mz*loff;
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[l];
+      npoff = nppmx*l;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ll = nz - loff;
+      ll = mz < ll ? mz : ll;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      edgelz = loff;
+      edgerz = loff + ll;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+      ll += 1;
+/* zero out local accumulator */
+      for (j = 0; j < 3*mxyv*(mz+1); j++) {
+         scu[j] = 0.0f;
+      }
+/* clear counters */
+      for (j = 0; j < 26; j++) {
+         ncl[j+26*l] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         z = ppart[2+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         ll = z;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+         dzp = z - (float) ll;
+/* find inverse gamma */
+         vx = ppart[3+idimp*(j+npoff)];
+         vy = ppart[4+idimp*(j+npoff)];
+         vz = ppart[5+idimp*(j+npoff)];
+         p2 = vx*vx + vy*vy + vz*vz;
+         gami = 1.0f/sqrtf(1.0f + p2*ci2);
+/* calculate weights */
+         nn = 3*(nn - noff + mxv*(mm - moff) + mxyv*(ll - loff));
+         amx = qm - dxp;
+         amy = 1.0f - dyp;
+         dx1 = dxp*dyp;
+         dyp = amx*dyp;
+         amx = amx*amy;
+         amz = 1.0f - dzp;
+         amy = dxp*amy;
+/* deposit current within tile to local accumulator */
+         dx = amx*amz;
+         dy = amy*amz;
+         vx *= gami;
+         vy *= gami;
+         vz *= gami;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = dyp*amz;
+         scu[nn+3] += vx*dy;
+         scu[nn+1+3] += vy*dy;
+         scu[nn+2+3] += vz*dy;
+         dy = dx1*amz;
+         mm = nn + 3*mxv;
+         scu[mm] += vx*dx;
+         scu[mm+1] += vy*dx;
+         scu[mm+2] += vz*dx;
+         dx = amx*dzp;
+         scu[mm+3] += vx*dy;
+         scu[mm+1+3] += vy*dy;
+         scu[mm+2+3] += vz*dy;
+         dy = amy*dzp;
+         nn += 3*mxyv;
+         scu[nn] += vx*dx;
+         scu[nn+1] += vy*dx;
+         scu[nn+2] += vz*dx;
+         dx = dyp*dzp;
+         scu[nn+3] += vx*dy;
+         scu[nn+1+3] += vy*dy;
+         scu[nn+2+3] += vz*dy;
+         dy = dx1*dzp;
+         mm = nn + 3*mxv;
+         scu[mm] += vx*dx;
+         scu[mm+1] += vy*dx;
+         scu[mm+2] += vz*dx;
+         scu[mm+3] += vx*dy;
+         scu[mm+1+3] += vy*dy;
+         scu[mm+2+3] += vz*dy;
+/* advance position half a time-step */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+         dz = z + vz*dt;
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                             */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx = dx - anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0f;
+            }
+            else {
+               mm = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy = dy - any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0f) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0f;
+            }
+            else {
+               mm += 3;
+            }
+         }
+         if (dz >= edgerz) {
+            if (dz >= anz)
+               dz = dz - anz;
+            mm += 18;
+         }
+         else if (dz < edgelz) {
+            if (dz < 0.0f) {
+               dz += anz;
+               if (dz < anz)
+                  mm += 9;
+               else
+                  dz = 0.0f;
+            }
+            else {
+               mm += 9;
+            }
+         }
+/* set new position */
+         ppart[idimp*(j+npoff)] = dx;
+         ppart[1+idimp*(j+npoff)] = dy;
+         ppart[2+idimp*(j+npoff)] = dz;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+26*l-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*l)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*l)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* deposit current to interior points in global array */
+      nn = nxv - noff;
+      nn = mx < nn ? mx : nn;
+      mm = nyv - moff;
+      mm = my < mm ? my : mm;
+      ll = nzv - loff;
+      ll = mz < ll ? mz : ll;
+      for (k = 1; k < ll; k++) {
+         for (j = 1; j < mm; j++) {
+            for (i = 1; i < nn; i++) {
+               cu[3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[3*(i+mxv*j+mxyv*k)];
+               cu[1+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[1+3*(i+mxv*j+mxyv*k)];
+               cu[2+3*(i+noff+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[2+3*(i+mxv*j+mxyv*k)];
+            }
+         }
+      }
+/* deposit current to edge points in global array */
+      lm = nzv - loff;
+      lm = mz+1 < lm ? mz+1 : lm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*(j+moff)+nxyv*loff)] += scu[3*(i+mxv*j)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*(j+moff)+nxyv*loff)]
+            += scu[1+3*(i+mxv*j)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*(j+moff)+nxyv*loff)]
+            += scu[2+3*(i+mxv*j)];
+            if (lm > mz) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[3*(i+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[1+3*(i+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[2+3*(i+mxv*j+mxyv*(lm-1))];
+            }
+         }
+      }
+      nm = nxv - noff;
+      nm = mx+1 < nm ? mx+1 : nm;
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (k = 0; k < ll; k++) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*moff+nxyv*(k+loff))] += scu[3*(i+mxyv*k)];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*moff+nxyv*(k+loff))]
+            += scu[1+3*(i+mxyv*k)];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*moff+nxyv*(k+loff))]
+            += scu[2+3*(i+mxyv*k)];
+            if (mm > my) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[3*(i+mxv*(mm-1)+mxyv*k)];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[1+3*(i+mxv*(mm-1)+mxyv*k)];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(mm+moff-1)+nxyv*(k+loff))]
+               += scu[2+3*(i+mxv*(mm-1)+mxyv*k)];
+            }
+         }
+         for (j = 0; j < mm; j++) {
+#pragma omp atomic
+            cu[3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[3*(mxv*j+mxyv*k)];
+#pragma omp atomic
+            cu[1+3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[1+3*(mxv*j+mxyv*k)];
+#pragma omp atomic
+            cu[2+3*(noff+nxv*(j+moff)+nxyv*(k+loff))]
+            += scu[2+3*(mxv*j+mxyv*k)];
+            if (nm > mx) {
+#pragma omp atomic
+               cu[3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[3*(nm-1+mxv*j+mxyv*k)];
+#pragma omp atomic
+               cu[1+3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[1+3*(nm-1+mxv*j+mxyv*k)];
+#pragma omp atomic
+               cu[2+3*(nm+noff-1+nxv*(j+moff)+nxyv*(k+loff))]
+               += scu[2+3*(nm-1+mxv*j+mxyv*k)];
+            }
+         }
+      }
+      if (lm > mz) {
+         for (i = 1; i < nn; i++) {
+#pragma omp atomic
+            cu[3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[3*(i+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[1+3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[1+3*(i+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[2+3*(i+noff+nxv*moff+nxyv*(lm+loff-1))]
+            += scu[2+3*(i+mxyv*(lm-1))];
+            if (mm > my) {
+#pragma omp atomic
+               cu[3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[1+3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(i+noff+nxv*(mm+moff-1)+nxyv*(lm+loff-1))]
+               += scu[2+3*(i+mxv*(mm-1)+mxyv*(lm-1))];
+            }
+         }
+         for (j = 0; j < mm; j++) {
+#pragma omp atomic
+            cu[3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[3*(mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[1+3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[1+3*(mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+            cu[2+3*(noff+nxv*(j+moff)+nxyv*(lm+loff-1))]
+            += scu[2+3*(mxv*j+mxyv*(lm-1))];
+            if (nm > mx) {
+#pragma omp atomic
+               cu[3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[3*(nm-1+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[1+3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[1+3*(nm-1+mxv*j+mxyv*(lm-1))];
+#pragma omp atomic
+               cu[2+3*(nm+noff-1+nxv*(j+moff)+nxyv*(lm+loff-1))]
+               += scu[2+3*(nm-1+mxv*j+mxyv*(lm-1))];
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*l] = ih;
+   }
+   return;
+#undef MXV
+#undef MYV
+#undef MZV
+}
+/*--------------------------------------------------------------------*/
+void cgjqppostf3l(float ppart[], float cu[], float q[], int kpic[],
+                  int ncl[], int ihole[], float qm, float dt,
+                  int nppmx, int idimp, int nx, int ny, int nz, int mx,
+                  int my, int mz, int nxv, int nyv, int nzv, int mx1,
+                  int my1, int mxyz1, int ntmax, int *irc) {
+/* for 3d code, this subroutine calculates particle current and charge
+   density in one pass over the particles,
+   using first-order linear interpolation
+   in addition, particle positions are advanced a half time-step
+   with periodic boundary conditions.
+   the charge density is deposited at the advanced positions, so the
+   result is the same as calling cgppost3l after the particles have
+   been reordered.  the charge accumulator of each tile is extended
+   by one grid point on each side, to hold the charge of particles
+   leaving the tile, and is added to the global array with periodic
+   wrap around.  particles must move less than one grid point per
+   half time-step, otherwise their charge is not deposited and irc is
+   set to -1, so that the charge can be deposited separately after the
+   particles have been reordered.
+   also determines list of particles which are leaving this tile
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   94 flops/particle, 38 loads, 35 stores
+   input: all except ncl, ihole, irc,
+   output: ppart, cu, q, ncl, ihole, irc
+   current density is approximated by values at the nearest grid points
+   cu(i,n,m,l)=qci*(1.-dx)*(1.-dy)*(1.-dz)
+   cu(i,n+1,m,l)=qci*dx*(1.-dy)*(1.-dz)
+   cu(i,n,m+1,l)=qci*(1.-dx)*dy*(1.-dz)
+   cu(i,n+1,m+1,l)=qci*dx*dy*(1.-dz)
+   cu(i,n,m,l+1)=qci*(1.-dx)*(1.-dy)*dz
+   cu(i,n+1,m,l+1)=qci*dx*(1.-dy)*dz
+   cu(i,n,m+1,l+1)=qci*(1.-dx)*dy*dz
+   cu(i,n+1,m+1,l+1)=qci*dx*dy*dz
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
+   and qci = qm*vi, where i = x,y,z
+   charge density is approximated by values at the nearest grid points
+   q(n,m,l)=qm*(1.-dx)*(1.-dy)*(1.-dz)
+   q(n+1,m,l)=qm*dx*(1.-dy)*(1.-dz)
+   q(n,m+1,l)=qm*(1.-dx)*dy*(1.-dz)
+   q(n+1,m+1,l)=qm*dx*dy*(1.-dz)
+   q(n,m,l+1)=qm*(1.-dx)*(1.-dy)*dz
+   q(n+1,m,l+1)=qm*dx*(1.-dy)*dz
+   q(n,m+1,l+1)=qm*(1.-dx)*dy*dz
+   q(n+1,m+1,l+1)=qm*dx*dy*dz
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l,
+   at the advanced positions
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = position z of particle n in tile m
+   ppart[m][n][3] = velocity vx of particle n in tile m
+   ppart[m][n][4] = velocity vy of particle n in tile m
+   ppart[m][n][5] = velocity vz of particle n in tile m
    cu[l][k][j][i] = ith component of current density at grid point j,k,l
-   kpic = number of particles per tile
+   q[l][k][j] = charge density at grid point j,k,l
+   kpic[l] = number of particles in tile l
+   ncl[l][i] = number of particles going to destination i, tile l
+   ihole[l][:][0] = location of hole in array left by departing particle
+   ihole[l][:][1] = direction destination of particle leaving hole
+   all for tile l
+   ihole[l][0][0] = ih, number of holes left (error, if negative)
    qm = charge on particle, in units of e
    dt = time interval between successive calculations
-   ci = reciprocal of velocity of light
    nppmx = maximum number of particles in tile
    idimp = size of phase space = 6
    nx/ny/nz = system length in x/y/z direction
@@ -2777,23 +4040,30 @@ void cgrjppost3l(float ppart[], float cu[], int kpic[], float qm,
    nxv = second dimension of current array, must be >= nx+1
    nyv = third dimension of current array, must be >= ny+1
    nzv = fourth dimension of current array, must be >= nz+1
+   nxv/nyv/nzv are also the dimensions of the charge array
    mx1 = (system length in x direction - 1)/mx + 1
    my1 = (system length in y direction - 1)/my + 1
    mxyz1 = mx1*my1*mz1,
    where mz1 = (system length in z direction - 1)/mz + 1
-   ipbc = particle boundary condition = (0,1,2,3) =
-   (none,3d periodic,3d reflecting,mixed 2d reflecting/1d periodic)
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -1 if a particle moved a grid point or more, and no overflow
+   occurred
+   optimized version
 local data                                                            */
 #define MXV             17
 #define MYV             17
 #define MZV             17
    int mxy1, noff, moff, loff, npoff, npp;
-   int i, j, k, l, nn, mm, ll, nm, lm, mxv, myv, mxyv, nxyv;
-   float ci2, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   int i, j, k, l, ih, nh, nn, mm, ll, nm, lm, mxv, myv, mxyv, nxyv;
+   int nq, ii, jj, kk, mxv2, mxyv2;
+   float anx, any, anz, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float edgeqx, edgeqy, edgeqz;
    float dxp, dyp, dzp, amx, amy, amz, dx1, dx, dy, dz, vx, vy, vz;
-   float x, y, z, p2, gami;
-   float scu[3*MXV*MYV*MZV];
+   float x, y, z;
+   float scu[3*MXV*MYV*MZV], sq[(MXV+2)*(MYV+2)*(MZV+2)];
 /* float scu[3*(mx+1)*(my+1)*(mz+1)]; */
+/* float sq[(mx+3)*(my+3)*(mz+3)];    */
 /* mxv = MXV; */
 /* myv = MYV; */
    mxv = mx+1;
@@ -2801,35 +4071,20 @@ local data                                                            */
    mxyv = mxv*myv;
    nxyv = nxv*nyv;
    mxy1 = mx1*my1;
-   ci2 = ci*ci;
-/* set boundary values */
-   edgelx = 0.0f;
-   edgely = 0.0f;
-   edgelz = 0.0f;
-   edgerx = (float) nx;
-   edgery = (float) ny;
-   edgerz = (float) nz;
-   if (ipbc==2) {
-      edgelx = 1.0f;
-      edgely = 1.0f;
-      edgelz = 1.0f;
-      edgerx = (float) (nx-1);
-      edgery = (float) (ny-1);
-      edgerz = (float) (nz-1);
-   }
-   else if (ipbc==3) {
-      edgelx = 1.0f;
-      edgely = 1.0f;
-      edgerx = (float) (nx-1);
-      edgery = (float) (ny-1);
-   }
+   mxv2 = mx + 3;
+   mxyv2 = mxv2*(my + 3);
+   anx = (float) nx;
+   any = (float) ny;
+   anz = (float) nz;
 /* error if local array is too small                */
 /* if ((mx >= MXV) || (my >= MYV) || (mz >= MZV))   */
 /*    return;                                       */
-/* loop over tiles */
+   nq = 0;
 #pragma omp parallel for \
-private(i,j,k,l,noff,moff,loff,npp,npoff,nn,mm,ll,nm,lm,x,y,z,dxp,dyp, \
-dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
+private(i,j,k,l,noff,moff,loff,npp,npoff,nn,mm,ll,nm,lm,ih,nh,x,y,z, \
+dxp,dyp,dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,edgelx,edgely,edgelz, \
+edgerx,edgery,edgerz,edgeqx,edgeqy,edgeqz,ii,jj,kk,scu,sq) \
+reduction(+:nq)
    for (l = 0; l < mxyz1; l++) {
       loff = l/mxy1;
       k = l - mxy1*loff;
@@ -2839,10 +4094,37 @@ dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
       noff = mx*(k - mx1*noff);
       npp = kpic[l];
       npoff = nppmx*l;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ll = nz - loff;
+      ll = mz < ll ? mz : ll;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      edgelz = loff;
+      edgerz = loff + ll;
+      edgeqx = edgerx - edgelx + 2.0f;
+      edgeqy = edgery - edgely + 2.0f;
+      edgeqz = edgerz - edgelz + 2.0f;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+      ll += 1;
 /* zero out local accumulator */
       for (j = 0; j < 3*mxyv*(mz+1); j++) {
          scu[j] = 0.0f;
       }
+      for (j = 0; j < mxyv2*(mz+3); j++) {
+         sq[j] = 0.0f;
+      }
+/* clear counters */
+      for (j = 0; j < 26; j++) {
+         ncl[j+26*l] = 0;
+      }
 /* loop over particles in tile */
       for (j = 0; j < npp; j++) {
 /* find interpolation weights */
@@ -2855,13 +4137,6 @@ dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
          dxp = qm*(x - (float) nn);
          dyp = y - (float) mm;
          dzp = z - (float) ll;
-/* find inverse gamma */
-         vx = ppart[3+idimp*(j+npoff)];
-         vy = ppart[4+idimp*(j+npoff)];
-         vz = ppart[5+idimp*(j+npoff)];
-         p2 = vx*vx + vy*vy + vz*vz;
-         gami = 1.0f/sqrtf(1.0f + p2*ci2);
-/* calculate weights */
          nn = 3*(nn - noff + mxv*(mm - moff) + mxyv*(ll - loff));
          amx = qm - dxp;
          amy = 1.0f - dyp;
@@ -2873,9 +4148,9 @@ dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
 /* deposit current within tile to local accumulator */
          dx = amx*amz;
          dy = amy*amz;
-         vx *= gami;
-         vy *= gami;
-         vz *= gami;
+         vx = ppart[3+idimp*(j+npoff)];
+         vy = ppart[4+idimp*(j+npoff)];
+         vz = ppart[5+idimp*(j+npoff)];
          scu[nn] += vx*dx;
          scu[nn+1] += vy*dx;
          scu[nn+2] += vz*dx;
@@ -2913,36 +4188,115 @@ dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
          dx = x + vx*dt;
          dy = y + vy*dt;
          dz = z + vz*dt;
-/* reflecting boundary conditions */
-         if (ipbc==2) {
-            if ((dx < edgelx) || (dx >= edgerx)) {
-               dx = x;
-               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+/* deposit charge at new position to extended local accumulator */
+         x = dx - edgelx + 1.0f;
+         y = dy - edgely + 1.0f;
+         z = dz - edgelz + 1.0f;
+/* particle moved a grid point or more */
+         if ((x < 0.0f) || (x >= edgeqx) || (y < 0.0f)
+            || (y >= edgeqy) || (z < 0.0f) || (z >= edgeqz)) {
+            nq += 1;
+         }
+         else {
+            nn = x;
+            mm = y;
+            ll = z;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            dzp = z - (float) ll;
+            nn += mxv2*mm + mxyv2*ll;
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+            dx1 = dxp*dyp;
+            dyp = amx*dyp;
+            amx = amx*amy;
+            amz = 1.0f - dzp;
+            amy = dxp*amy;
+            sq[nn] += amx*amz;
+            sq[nn+1] += amy*amz;
+            mm = nn + mxv2;
+            sq[mm] += dyp*amz;
+            sq[mm+1] += dx1*amz;
+            nn += mxyv2;
+            sq[nn] += amx*dzp;
+            sq[nn+1] += amy*dzp;
+            mm = nn + mxv2;
+            sq[mm] += dyp*dzp;
+            sq[mm+1] += dx1*dzp;
+         }
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                             */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx = dx - anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0f;
             }
-            if ((dy < edgely) || (dy >= edgery)) {
-               dy = y;
-               ppart[4+idimp*(j+npoff)] = -ppart[4+idimp*(j+npoff)];
+            else {
+               mm = 1;
             }
-            if ((dz < edgelz) || (dz >= edgerz)) {
-               dz = z;
-               ppart[5+idimp*(j+npoff)] = -ppart[5+idimp*(j+npoff)];
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy = dy - any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0f) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0f;
+            }
+            else {
+               mm += 3;
             }
          }
-/* mixed reflecting/periodic boundary conditions */
-         else if (ipbc==3) {
-            if ((dx < edgelx) || (dx >= edgerx)) {
-               dx = x;
-               ppart[3+idimp*(j+npoff)] = -ppart[3+idimp*(j+npoff)];
+         if (dz >= edgerz) {
+            if (dz >= anz)
+               dz = dz - anz;
+            mm += 18;
+         }
+         else if (dz < edgelz) {
+            if (dz < 0.0f) {
+               dz += anz;
+               if (dz < anz)
+                  mm += 9;
+               else
+                  dz = 0.0f;
             }
-            if ((dy < edgely) || (dy >= edgery)) {
-               dy = y;
-               ppart[4+idimp*(j+npoff)] = -ppart[4+idimp*(j+npoff)];
+            else {
+               mm += 9;
             }
          }
 /* set new position */
          ppart[idimp*(j+npoff)] = dx;
          ppart[1+idimp*(j+npoff)] = dy;
          ppart[2+idimp*(j+npoff)] = dz;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+26*l-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*l)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*l)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
       }
 /* deposit current to interior points in global array */
       nn = nxv - noff;
@@ -3084,30 +4438,89 @@ dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,scu)
             }
          }
       }
+/* deposit charge to global array with periodic wrap around,      */
+/* points which other tiles may also update are added atomically, */
+/* skipping zeros in the part of the halo no particle reached     */
+      nn = nx - noff;
+      mm = ny - moff;
+      ll = nz - loff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      ll = mz < ll ? mz : ll;
+      for (k = 0; k < ll+3; k++) {
+         kk = k + loff - 1;
+         if (kk < 0)
+            kk += nz;
+         else if (kk > nz)
+            kk -= nz;
+         for (j = 0; j < mm+3; j++) {
+            jj = j + moff - 1;
+            if (jj < 0)
+               jj += ny;
+            else if (jj > ny)
+               jj -= ny;
+            for (i = 0; i < nn+3; i++) {
+               ii = i + noff - 1;
+               if (ii < 0)
+                  ii += nx;
+               else if (ii > nx)
+                  ii -= nx;
+               nm = ii + nxv*jj + nxyv*kk;
+               lm = i + mxv2*j + mxyv2*k;
+               if ((i > 2) && (i < nn) && (j > 2) && (j < mm)
+                  && (k > 2) && (k < ll)) {
+                  q[nm] += sq[lm];
+               }
+               else if (sq[lm] != 0.0f) {
+#pragma omp atomic
+                  q[nm] += sq[lm];
+               }
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*l] = ih;
    }
+/* particles moved a grid point or more, if no ihole overflow */
+   if ((nq > 0) && (*irc==0))
+      *irc = -1;
    return;
 #undef MXV
 #undef MYV
 #undef MZV
 }
-
 /*--------------------------------------------------------------------*/
-void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
-                  int ihole[], float qm, float dt, float ci, int nppmx,
-                  int idimp, int nx, int ny, int nz, int mx, int my,
-                  int mz, int nxv, int nyv, int nzv, int mx1, int my1,
-                  int mxyz1, int ntmax, int *irc) {
-/* for 3d code, this subroutine calculates particle current density
+void cgrjqppostf3l(float ppart[], float cu[], float q[], int kpic[],
+                   int ncl[], int ihole[], float qm, float dt,
+                   float ci, int nppmx, int idimp, int nx, int ny,
+                   int nz, int mx, int my, int mz, int nxv, int nyv,
+                   int nzv, int mx1, int my1, int mxyz1, int ntmax,
+                   int *irc) {
+/* for 3d code, this subroutine calculates particle current and charge
+   density in one pass over the particles,
    using first-order linear interpolation for relativistic particles
    in addition, particle positions are advanced a half time-step
    with periodic boundary conditions.
+   the charge density is deposited at the advanced positions, so the
+   result is the same as calling cgppost3l after the particles have
+   been reordered.  the charge accumulator of each tile is extended
+   by one grid point on each side, to hold the charge of particles
+   leaving the tile, and is added to the global array with periodic
+   wrap around.  particles must move less than one grid point per
+   half time-step, otherwise their charge is not deposited and irc is
+   set to -1, so that the charge can be deposited separately after the
+   particles have been reordered.
    also determines list of particles which are leaving this tile
    OpenMP version using guard cells
    data deposited in tiles
    particles stored segmented array
-   79 flops/particle, 1 divide, 1 sqrt, 30 loads, 27 stores
+   104 flops/particle, 1 divide, 1 sqrt, 38 loads, 35 stores
    input: all except ncl, ihole, irc,
-   output: ppart, cu, ncl, ihole, irc
+   output: ppart, cu, q, ncl, ihole, irc
    current density is approximated by values at the nearest grid points
   cu(i,n,m,l)=qci*(1.-dx)*(1.-dy)*(1.-dz)
    cu(i,n+1,m,l)=qci*dx*(1.-dy)*(1.-dz)
@@ -3120,6 +4533,17 @@ void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
    where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
    and qci = qm*pi*gami, where i = x,y,z
    where gami = 1./sqrt(1.+sum(pi**2)*ci*ci)
+   charge density is approximated by values at the nearest grid points
+   q(n,m,l)=qm*(1.-dx)*(1.-dy)*(1.-dz)
+   q(n+1,m,l)=qm*dx*(1.-dy)*(1.-dz)
+   q(n,m+1,l)=qm*(1.-dx)*dy*(1.-dz)
+   q(n+1,m+1,l)=qm*dx*dy*(1.-dz)
+   q(n,m,l+1)=qm*(1.-dx)*(1.-dy)*dz
+   q(n+1,m,l+1)=qm*dx*(1.-dy)*dz
+   q(n,m+1,l+1)=qm*(1.-dx)*dy*dz
+   q(n+1,m+1,l+1)=qm*dx*dy*dz
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l,
+   at the advanced positions
    ppart[m][n][0] = position x of particle n in tile m
    ppart[m][n][1] = position y of particle n in tile m
    ppart[m][n][2] = position z of particle n in tile m
@@ -3127,6 +4551,7 @@ void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
    ppart[m][n][4] = y momentum of particle n in tile m
    ppart[m][n][5] = z momentum of particle n in tile m
    cu[l][k][j][i] = ith component of current density at grid point j,k,l
+   q[l][k][j] = charge density at grid point j,k,l
    kpic[l] = number of particles in tile l
    ncl[l][i] = number of particles going to destination i, tile l
    ihole[l][:][0] = location of hole in array left by departing particle
@@ -3143,12 +4568,15 @@ void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
    nxv = second dimension of current array, must be >= nx+1
    nyv = third dimension of current array, must be >= ny+1
    nzv = fourth dimension of current array, must be >= nz+1
+   nxv/nyv/nzv are also the dimensions of the charge array
    mx1 = (system length in x direction - 1)/mx + 1
    my1 = (system length in y direction - 1)/my + 1
    mxyz1 = mx1*my1*mz1,
    where mz1 = (system length in z direction - 1)/mz + 1
    ntmax = size of hole array for particles leaving tiles
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -1 if a particle moved a grid point or more, and no overflow
+   occurred
    optimized version
 local data                                                            */
 #define MXV             17
@@ -3156,11 +4584,14 @@ local data                                                            */
 #define MZV             17
    int mxy1, noff, moff, loff, npoff, npp;
    int i, j, k, l, ih, nh, nn, mm, ll, nm, lm, mxv, myv, mxyv, nxyv;
+   int nq, ii, jj, kk, mxv2, mxyv2;
    float anx, any, anz, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float edgeqx, edgeqy, edgeqz;
    float dxp, dyp, dzp, amx, amy, amz, dx1, dx, dy, dz, vx, vy, vz;
    float ci2, x, y, z, p2, gami;
-   float scu[3*MXV*MYV*MZV];
+   float scu[3*MXV*MYV*MZV], sq[(MXV+2)*(MYV+2)*(MZV+2)];
 /* float scu[3*(mx+1)*(my+1)*(mz+1)]; */
+/* float sq[(mx+3)*(my+3)*(mz+3)];    */
 /* mxv = MXV; */
 /* myv = MYV; */
    mxv = mx+1;
@@ -3168,6 +4599,8 @@ local data                                                            */
    mxyv = mxv*myv;
    nxyv = nxv*nyv;
    mxy1 = mx1*my1;
+   mxv2 = mx + 3;
+   mxyv2 = mxv2*(my + 3);
    ci2 = ci*ci;
    anx = (float) nx;
    any = (float) ny;
@@ -3175,10 +4608,13 @@ local data                                                            */
 /* error if local array is too small                */
 /* if ((mx >= MXV) || (my >= MYV) || (mz >= MZV))   */
 /*    return;                                       */
+   nq = 0;
 #pragma omp parallel for \
 private(i,j,k,l,noff,moff,loff,npp,npoff,nn,mm,ll,ih,nh,nm,lm,x,y,z, \
 dxp,dyp,dzp,amx,amy,amz,dx1,dx,dy,dz,vx,vy,vz,p2,gami,edgelx,edgely, \
-edgelz,edgerx,edgery,edgerz,scu)
+edgelz,edgerx,edgery,edgerz,edgeqx,edgeqy,edgeqz,ii,jj,kk,scu, \
+sq) \
+reduction(+:nq)
    for (l = 0; l < mxyz1; l++) {
       loff = l/mxy1;
       k = l - mxy1*loff;
@@ -3200,6 +4636,9 @@ edgelz,edgerx,edgery,edgerz,scu)
       edgery = moff + mm;
       edgelz = loff;
       edgerz = loff + ll;
+      edgeqx = edgerx - edgelx + 2.0f;
+      edgeqy = edgery - edgely + 2.0f;
+      edgeqz = edgerz - edgelz + 2.0f;
       ih = 0;
       nh = 0;
       nn += 1;
@@ -3209,6 +4648,9 @@ edgelz,edgerx,edgery,edgerz,scu)
       for (j = 0; j < 3*mxyv*(mz+1); j++) {
          scu[j] = 0.0f;
       }
+      for (j = 0; j < mxyv2*(mz+3); j++) {
+         sq[j] = 0.0f;
+      }
 /* clear counters */
       for (j = 0; j < 26; j++) {
          ncl[j+26*l] = 0;
@@ -3283,6 +4725,42 @@ edgelz,edgerx,edgery,edgerz,scu)
          dx = x + vx*dt;
          dy = y + vy*dt;
          dz = z + vz*dt;
+/* deposit charge at new position to extended local accumulator */
+         x = dx - edgelx + 1.0f;
+         y = dy - edgely + 1.0f;
+         z = dz - edgelz + 1.0f;
+/* particle moved a grid point or more */
+         if ((x < 0.0f) || (x >= edgeqx) || (y < 0.0f)
+            || (y >= edgeqy) || (z < 0.0f) || (z >= edgeqz)) {
+            nq += 1;
+         }
+         else {
+            nn = x;
+            mm = y;
+            ll = z;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            dzp = z - (float) ll;
+            nn += mxv2*mm + mxyv2*ll;
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+            dx1 = dxp*dyp;
+            dyp = amx*dyp;
+            amx = amx*amy;
+            amz = 1.0f - dzp;
+            amy = dxp*amy;
+            sq[nn] += amx*amz;
+            sq[nn+1] += amy*amz;
+            mm = nn + mxv2;
+            sq[mm] += dyp*amz;
+            sq[mm+1] += dx1*amz;
+            nn += mxyv2;
+            sq[nn] += amx*dzp;
+            sq[nn+1] += amy*dzp;
+            mm = nn + mxv2;
+            sq[mm] += dyp*dzp;
+            sq[mm+1] += dx1*dzp;
+         }
 /* find particles going out of bounds */
          mm = 0;
 /* count how many particles are going in each direction in ncl   */
@@ -3497,6 +4975,46 @@ edgelz,edgerx,edgery,edgerz,scu)
             }
          }
       }
+/* deposit charge to global array with periodic wrap around,      */
+/* points which other tiles may also update are added atomically, */
+/* skipping zeros in the part of the halo no particle reached     */
+      nn = nx - noff;
+      mm = ny - moff;
+      ll = nz - loff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      ll = mz < ll ? mz : ll;
+      for (k = 0; k < ll+3; k++) {
+         kk = k + loff - 1;
+         if (kk < 0)
+            kk += nz;
+         else if (kk > nz)
+            kk -= nz;
+         for (j = 0; j < mm+3; j++) {
+            jj = j + moff - 1;
+            if (jj < 0)
+               jj += ny;
+            else if (jj > ny)
+               jj -= ny;
+            for (i = 0; i < nn+3; i++) {
+               ii = i + noff - 1;
+               if (ii < 0)
+                  ii += nx;
+               else if (ii > nx)
+                  ii -= nx;
+               nm = ii + nxv*jj + nxyv*kk;
+               lm = i + mxv2*j + mxyv2*k;
+               if ((i > 2) && (i < nn) && (j > 2) && (j < mm)
+                  && (k > 2) && (k < ll)) {
+                  q[nm] += sq[lm];
+               }
+               else if (sq[lm] != 0.0f) {
+#pragma omp atomic
+                  q[nm] += sq[lm];
+               }
+            }
+         }
+      }
 /* set error and end of file flag */
       if (nh > 0) {
          *irc = ih;
@@ -3504,6 +5022,9 @@ edgelz,edgerx,edgery,edgerz,scu)
       }
       ihole[2*(ntmax+1)*l] = ih;
    }
+/* particles moved a grid point or more, if no ihole overflow */
+   if ((nq > 0) && (*irc==0))
+      *irc = -1;
    return;
 #undef MXV
 #undef MYV
@@ -7267,6 +8788,20 @@ void cgrbppushf3l_(float *ppart, float *fxyz, float *bxyz, int *kpic,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cvgrbppushf3l_(float *ppart, float *fxyz, float *bxyz, int *kpic,
+                    int *ncl, int *ihole, float *qbm, float *dt,
+                    float *dtc, float *ci, float *ek, int *idimp,
+                    int *nppmx, int *nx, int *ny, int *nz, int *mx,
+                    int *my, int *mz, int *nxv, int *nyv, int *nzv,
+                    int *mx1, int *my1, int *mxyz1, int* ntmax,
+                    int *irc) {
+   cvgrbppushf3l(ppart,fxyz,bxyz,kpic,ncl,ihole,*qbm,*dt,*dtc,*ci,ek,
+                 *idimp,*nppmx,*nx,*ny,*nz,*mx,*my,*mz,*nxv,*nyv,*nzv,
+                 *mx1,*my1,*mxyz1,*ntmax,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cgppost3l_(float *ppart, float *q, int *kpic, float *qm,
                 int *nppmx, int *idimp, int *mx, int *my, int *mz,
@@ -7324,6 +8859,32 @@ void cgrjppostf3l_(float *ppart, float *cu, int *kpic, int *ncl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgjqppostf3l_(float *ppart, float *cu, float *q, int *kpic,
+                   int *ncl, int *ihole, float *qm, float *dt,
+                   int *nppmx, int *idimp, int *nx, int *ny, int *nz,
+                   int *mx, int *my, int *mz, int *nxv, int *nyv,
+                   int *nzv, int *mx1, int *my1, int *mxyz1, int *ntmax,
+                   int *irc) {
+   cgjqppostf3l(ppart,cu,q,kpic,ncl,ihole,*qm,*dt,*nppmx,*idimp,*nx,
+                *ny,*nz,*mx,*my,*mz,*nxv,*nyv,*nzv,*mx1,*my1,*mxyz1,
+                *ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgrjqppostf3l_(float *ppart, float *cu, float *q, int *kpic,
+                    int *ncl, int *ihole, float *qm, float *dt,
+                    float *ci, int *nppmx, int *idimp, int *nx, int *ny,
+                    int *nz, int *mx, int *my, int *mz, int *nxv,
+                    int *nyv, int *nzv, int *mx1, int *my1, int *mxyz1,
+                    int *ntmax, int *irc) {
+   cgrjqppostf3l(ppart,cu,q,kpic,ncl,ihole,*qm,*dt,*ci,*nppmx,*idimp,
+                 *nx,*ny,*nz,*mx,*my,*mz,*nxv,*nyv,*nzv,*mx1,*my1,
+                 *mxyz1,*ntmax,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpporder3l_(float *ppart, float *ppbuff, int *kpic, int *ncl,
                  int *ihole, int *idimp, int *nppmx, int *nx, int *ny,
@@ -44,6 +44,13 @@ void cgrbppushf3l(float ppart[], float fxyz[], float bxyz[], int kpic[],
                   int nxv, int nyv, int nzv, int mx1, int my1,
                   int mxyz1, int ntmax, int *irc);
 
+void cvgrbppushf3l(float ppart[], float fxyz[], float bxyz[],
+                   int kpic[], int ncl[], int ihole[], float qbm,
+                   float dt, float dtc, float ci, float *ek, int idimp,
+                   int nppmx, int nx, int ny, int nz, int mx, int my,
+                   int mz, int nxv, int nyv, int nzv, int mx1, int my1,
+                   int mxyz1, int ntmax, int *irc);
+
 void cgppost3l(float ppart[], float q[], int kpic[], float qm,
                int nppmx, int idimp, int mx, int my, int mz, int nxv,
                int nyv, int nzv, int mx1, int my1, int mxyz1);
@@ -71,6 +78,19 @@ void cgrjppostf3l(float ppart[], float cu[], int kpic[], int ncl[],
                   int mz, int nxv, int nyv, int nzv, int mx1, int my1,
                   int mxyz1, int ntmax, int *irc);
 
+void cgjqppostf3l(float ppart[], float cu[], float q[], int kpic[],
+                  int ncl[], int ihole[], float qm, float dt,
+                  int nppmx, int idimp, int nx, int ny, int nz, int mx,
+                  int my, int mz, int nxv, int nyv, int nzv, int mx1,
+                  int my1, int mxyz1, int ntmax, int *irc);
+
+void cgrjqppostf3l(float ppart[], float cu[], float q[], int kpic[],
+                   int ncl[], int ihole[], float qm, float dt,
+                   float ci, int nppmx, int idimp, int nx, int ny,
+                   int nz, int mx, int my, int mz, int nxv, int nyv,
+                   int nzv, int mx1, int my1, int mxyz1, int ntmax,
+                   int *irc);
+
 void cpporder3l(float ppart[], float ppbuff[], int kpic[], int ncl[],
                 int ihole[], int idimp, int nppmx, int nx, int ny,
                 int nz, int mx, int my, int mz, int mx1, int my1,
@@ -3602,6 +3602,44 @@ local data                                                 */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cvrdiff2(float a[], float b[], float *err, int ndim, int nx,
+              int ny, int nxe, int nye) {
+/* this subroutine calculates the relative change between two real
+   vector fields, err = sqrt(sum((a-b)**2)/sum(a**2)), and then copies
+   a to b, so that b holds the previous iterate on the next call
+   with OpenMP
+   a = new field, b = previous field on input, new field on output
+   err = relative change, 0 if a is zero
+   ndim = first dimension of field arrays
+   nx/ny = system length in x/y direction
+   nxe = second dimension of field arrays, must be >= nx
+   nye = third dimension of field arrays, must be >= ny
+local data                                                 */
+   int i, j, k, nnxe;
+   float at1;
+   double sum1, sum2;
+   nnxe = ndim*nxe;
+   sum1 = 0.0;
+   sum2 = 0.0;
+#pragma omp parallel for private(i,j,k,at1) reduction(+:sum1,sum2)
+   for (k = 0; k < ny; k++) {
+      for (j = 0; j < nx; j++) {
+         for (i = 0; i < ndim; i++) {
+            at1 = a[i+ndim*j+nnxe*k];
+            sum1 += (at1 - b[i+ndim*j+nnxe*k])
+                   *(at1 - b[i+ndim*j+nnxe*k]);
+            sum2 += at1*at1;
+            b[i+ndim*j+nnxe*k] = at1;
+         }
+      }
+   }
+   *err = 0.0;
+   if (sum2 > 0.0)
+      *err = sqrt(sum1/sum2);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cwfft2rinit(int mixup[], float complex sct[], int indx, int indy, 
                  int nxhyd, int nxyhd) {
@@ -5135,6 +5173,13 @@ void caddvrfield2_(float *a, float *b, float *c, int *ndim, int *nxe,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cvrdiff2_(float *a, float *b, float *err, int *ndim, int *nx,
+               int *ny, int *nxe, int *nye) {
+   cvrdiff2(a,b,err,*ndim,*nx,*ny,*nxe,*nye);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cwfft2rinit_(int *mixup, float complex *sct, int *indx, int *indy,
                   int *nxhyd, int *nxyhd) {
@@ -103,6 +103,9 @@ void cmepois23(float complex dcu[], float complex exy[], int isign,
 void caddvrfield2(float a[], float b[], float c[], int ndim, int nxe,
                   int nye);
 
+void cvrdiff2(float a[], float b[], float *err, int ndim, int nx,
+              int ny, int nxe, int nye);
+
 void cwfft2rinit(int mixup[], float complex sct[], int indx, int indy, 
                  int nxhyd, int nxyhd);
 
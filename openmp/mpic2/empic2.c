@@ -0,0 +1,391 @@
+/*---------------------------------------------------------------------*/
+/* Ensemble driver for Skeleton 2D Electrostatic OpenMP PIC code */
+/* advances many independent simulations with the same grid in one */
+/* process.  the fft tables and form factors are calculated once */
+/* and shared, read-only, by all members of the ensemble.  members */
+/* are scheduled dynamically on the OpenMP threads, and each member */
+/* runs its OpenMP procedures within a single thread */
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include <sys/time.h>
+#include <omp.h>
+#include "mpush2.h"
+#include "omplib.h"
+
+void dtimer(double *time, struct timeval *itime, int icntrl);
+
+static int cadvance(float **ppart, float **ppbuff, float **ppbuff2,
+                    int **ihole, float qe[], float fxye[],
+                    float complex ffc[], int mixup[],
+                    float complex sct[], int kpic[], int ncl[],
+                    float qme, float dt, float ax, float ay, float affp,
+                    int indx, int indy, int nloop, int idimp,
+                    int *nppmx0, int *ntmax, int *npbmx, int mx, int my,
+                    float wt[], int *nrecov);
+
+int main(int argc, char *argv[]) {
+/* indx/indy = exponent which determines grid points in x/y direction: */
+/* nx = 2**indx, ny = 2**indy */
+   int indx =   6, indy =   6;
+/* npx/npy = number of electrons distributed in x/y direction */
+   int npx =  256, npy =   256;
+/* ndim = number of velocity coordinates = 2 */
+   int ndim = 2;
+/* tend = time at end of simulation, in units of plasma frequency */
+   float tend = 10.0;
+/* vtxs = thermal velocities vtx = vty, qmes = charges on electron, */
+/* in units of e, dts = time intervals between successive           */
+/* calculations.  every combination is one member of the ensemble  */
+   float vtxs[4] = {0.5,1.0,1.5,2.0};
+   float qmes[2] = {-1.0,-0.5};
+   float dts[2] = {0.1,0.05};
+   int nvtx = 4, nqme = 2, ndt = 2;
+/* vx0/vy0 = drift velocity of electrons in x/y direction */
+   float vx0 = 0.0, vy0 = 0.0;
+/* ax/ay = smoothed particle size in x/y direction */
+   float ax = .912871, ay = .912871;
+/* idimp = number of particle coordinates = 4 */
+/* ipbc = particle boundary condition: 1 = periodic */
+   int idimp = 4, ipbc = 1;
+/* mx/my = number of grids in x/y in sorting tiles */
+   int mx = 16, my = 16;
+/* xtras = fraction of extra particles needed for particle management */
+   float xtras = 0.2;
+/* declare scalars for standard code */
+   int j, k, nens, isign, irc;
+   int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
+   int mx1, my1, mxy1, nppmx;
+   float affp, we;
+
+/* declare scalars for OpenMP code */
+   int nvp;
+
+/* declare shared, read-only arrays: */
+/* ffc = form factor array for poisson solver */
+   float complex *ffc = NULL;
+/* mixup = bit reverse table for FFT */
+   int *mixup = NULL;
+/* sct = sine/cosine table for FFT */
+   float complex *sct = NULL;
+/* part = original particle array, reused by each member */
+   float *part = NULL;
+
+/* declare arrays for each member k of the ensemble: */
+/* qe[k] = electron charge density with guard cells */
+/* fxye[k] = smoothed electric field with guard cells */
+   float **qe = NULL, **fxye = NULL;
+/* ppart[k] = tiled particle array */
+/* ppbuff[k] = buffer array for reordering tiled particle array */
+/* ppbuff2[k] = temporary array used to enlarge ppart[k] */
+   float **ppart = NULL, **ppbuff = NULL, **ppbuff2 = NULL;
+/* kpic[k] = number of particles in each tile */
+/* ncl[k] = number of particles departing tile in each direction */
+/* ihole[k] = location/destination of each particle departing tile */
+   int **kpic = NULL, **ncl = NULL, **ihole = NULL;
+/* nppmx0/ntmax/npbmx = sizes of particle arrays for each member */
+   int *nppmx0 = NULL, *ntmax = NULL, *npbmx = NULL;
+/* nloop = number of time steps for each member */
+/* nrecov = number of times particle arrays were enlarged on overflow */
+/* ierr = error code for each member, 0 if successful */
+   int *nloop = NULL, *nrecov = NULL, *ierr = NULL;
+/* vtx/qme/dt = parameters for each member */
+   float *vtx = NULL, *qme = NULL, *dt = NULL;
+/* wt[k] = initial and final field, kinetic and total energies */
+/* tmem[k] = time used by member k in main loop */
+   float *wt = NULL, *tmem = NULL;
+
+/* declare and initialize timing data */
+   struct timeval itime, jtime;
+   float tinit = 0.0, tshare = 0.0, tloop = 0.0, tsum = 0.0;
+   double dtime, etime;
+
+   irc = 0;
+/* nvp = number of shared memory nodes  (0=default) */
+   nvp = 0;
+   if (argc > 1)
+      nvp = atoi(argv[1]);
+/* initialize for shared memory parallel processing */
+   cinit_omp(nvp);
+/* procedures called within a member run in a single thread */
+   omp_set_max_active_levels(1);
+
+/* initialize scalars for standard code */
+/* np = total number of particles in each simulation */
+/* nx/ny = number of grid points in x/y direction */
+   nens = nvtx*nqme*ndt;
+   np = npx*npy; nx = 1L<<indx; ny = 1L<<indy;
+   nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
+   nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
+   nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+/* mx1/my1 = number of tiles in x/y direction */
+   mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
+   affp = (float) (nx*ny)/(float ) np;
+
+/* allocate shared data */
+   ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
+   mixup = (int *) malloc(nxhy*sizeof(int));
+   sct = (float complex *) malloc(nxyh*sizeof(float complex));
+   part = (float *) malloc(idimp*np*sizeof(float));
+/* allocate tables for members */
+   qe = (float **) calloc(nens,sizeof(float *));
+   fxye = (float **) calloc(nens,sizeof(float *));
+   ppart = (float **) calloc(nens,sizeof(float *));
+   ppbuff = (float **) calloc(nens,sizeof(float *));
+   ppbuff2 = (float **) calloc(nens,sizeof(float *));
+   kpic = (int **) calloc(nens,sizeof(int *));
+   ncl = (int **) calloc(nens,sizeof(int *));
+   ihole = (int **) calloc(nens,sizeof(int *));
+   nppmx0 = (int *) malloc(nens*sizeof(int));
+   ntmax = (int *) malloc(nens*sizeof(int));
+   npbmx = (int *) malloc(nens*sizeof(int));
+   nloop = (int *) malloc(nens*sizeof(int));
+   nrecov = (int *) malloc(nens*sizeof(int));
+   ierr = (int *) malloc(nens*sizeof(int));
+   vtx = (float *) malloc(nens*sizeof(float));
+   qme = (float *) malloc(nens*sizeof(float));
+   dt = (float *) malloc(nens*sizeof(float));
+   wt = (float *) malloc(6*nens*sizeof(float));
+   tmem = (float *) malloc(nens*sizeof(float));
+
+/* prepare fft tables and form factors once, shared by all members */
+   dtimer(&dtime,&itime,-1);
+   qe[0] = (float *) malloc(nxe*nye*sizeof(float));
+   fxye[0] = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+   isign = 0;
+   cmpois22((float complex *)qe[0],(float complex *)fxye[0],isign,ffc,
+            ax,ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+   dtimer(&dtime,&itime,1);
+   tshare = (float) dtime;
+
+/* initialize each member in turn, since the random number */
+/* generator in cdistr2 is not thread safe.  each member gets */
+/* different particles */
+   dtimer(&dtime,&itime,-1);
+   for (k = 0; k < nens; k++) {
+      vtx[k] = vtxs[k%nvtx];
+      qme[k] = qmes[(k/nvtx)%nqme];
+      dt[k] = dts[k/(nvtx*nqme)];
+      nloop[k] = tend/dt[k] + .0001;
+      nrecov[k] = 0;
+      ierr[k] = 0;
+      tmem[k] = 0.0;
+      for (j = 0; j < 6; j++) {
+         wt[j+6*k] = 0.0;
+      }
+      if (k > 0) {
+         qe[k] = (float *) malloc(nxe*nye*sizeof(float));
+         fxye[k] = (float *) malloc(ndim*nxe*nye*sizeof(float));
+      }
+      kpic[k] = (int *) malloc(mxy1*sizeof(int));
+/* initialize electrons */
+      cdistr2(part,vtx[k],vtx[k],vx0,vy0,npx,npy,idimp,np,nx,ny,ipbc);
+/* find number of particles in each of mx, my tiles: */
+/* updates kpic, nppmx */
+      cdblkp2l(part,kpic[k],&nppmx,idimp,np,mx,my,mx1,mxy1,&irc);
+      if (irc != 0) {
+         printf("member %d: cdblkp2l error, irc=%d\n",k,irc);
+         exit(1);
+      }
+/* allocate vector particle data */
+      nppmx0[k] = (1.0 + xtras)*nppmx;
+      ntmax[k] = xtras*nppmx;
+      npbmx[k] = xtras*nppmx;
+      ppart[k] = (float *) malloc(idimp*nppmx0[k]*mxy1*sizeof(float));
+      ppbuff[k] = (float *) malloc(idimp*npbmx[k]*mxy1*sizeof(float));
+      ncl[k] = (int *) malloc(8*mxy1*sizeof(int));
+      ihole[k] = (int *) malloc(2*(ntmax[k]+1)*mxy1*sizeof(int));
+/* copy ordered particle data for OpenMP: updates ppart and kpic */
+      cppmovin2l(part,ppart[k],kpic[k],nppmx0[k],idimp,np,mx,my,mx1,
+                 mxy1,&irc);
+      if (irc != 0) {
+         printf("member %d: cppmovin2l overflow error, irc=%d\n",k,irc);
+         exit(1);
+      }
+/* sanity check */
+      cppcheck2l(ppart[k],kpic[k],idimp,nppmx0[k],nx,ny,mx,my,mx1,my1,
+                 &irc);
+      if (irc != 0) {
+         printf("member %d: cppcheck2l error, irc=%d\n",k,irc);
+         exit(1);
+      }
+   }
+   dtimer(&dtime,&itime,1);
+   tinit = (float) dtime;
+
+/* * * * advance all members, each within a single thread * * * */
+   dtimer(&dtime,&itime,-1);
+#pragma omp parallel for schedule(dynamic,1) private(k,jtime,etime)
+   for (k = 0; k < nens; k++) {
+      dtimer(&etime,&jtime,-1);
+      ierr[k] = cadvance(&ppart[k],&ppbuff[k],&ppbuff2[k],&ihole[k],
+                         qe[k],fxye[k],ffc,mixup,sct,kpic[k],ncl[k],
+                         qme[k],dt[k],ax,ay,affp,indx,indy,nloop[k],
+                         idimp,&nppmx0[k],&ntmax[k],&npbmx[k],mx,my,
+                         &wt[6*k],&nrecov[k]);
+      dtimer(&etime,&jtime,1);
+      tmem[k] = (float) etime;
+   }
+   dtimer(&dtime,&itime,1);
+   tloop = (float) dtime;
+
+   printf("ensemble of %d members, nx, ny, np = %d,%d,%d\n",nens,nx,
+          ny,np);
+   printf("  k   vtx    qme    dt   nloop  initial total  ");
+   printf("final field    final kinetic  final total    time (sec)\n");
+   for (k = 0; k < nens; k++) {
+      printf("%3d %5.2f %6.2f %6.3f %5d  %e  ",k,vtx[k],qme[k],dt[k],
+             nloop[k],wt[2+6*k]);
+      if (ierr[k] != 0) {
+         printf("failed, irc=%d\n",ierr[k]);
+         irc = 1;
+         continue;
+      }
+      printf("%e   %e   %e   %.4f\n",wt[3+6*k],wt[4+6*k],wt[5+6*k],
+             tmem[k]);
+      if (nrecov[k] > 0)
+         printf("    member %d: particle arrays enlarged %d times\n",k,
+                nrecov[k]);
+   }
+   printf("\n");
+   printf("shared table time = %f\n",tshare);
+   printf("table time saved by sharing = %f\n",tshare*(nens - 1));
+   printf("member initialization time = %f\n",tinit);
+   printf("main loop time = %f\n",tloop);
+   tsum = 0.0;
+   for (k = 0; k < nens; k++) {
+      tsum += tmem[k];
+   }
+   printf("sum of member times = %f\n",tsum);
+   printf("\n");
+
+   for (k = 0; k < nens; k++) {
+      free(ppbuff2[k]); free(ihole[k]); free(ncl[k]); free(ppbuff[k]);
+      free(ppart[k]); free(kpic[k]); free(fxye[k]); free(qe[k]);
+   }
+   free(tmem); free(wt); free(dt); free(qme); free(vtx);
+   free(ierr); free(nrecov); free(nloop); free(npbmx); free(ntmax);
+   free(nppmx0); free(ihole); free(ncl); free(kpic); free(ppbuff2);
+   free(ppbuff); free(ppart); free(fxye); free(qe);
+   free(part); free(sct); free(mixup); free(ffc);
+
+   return irc;
+}
+
+/*--------------------------------------------------------------------*/
+static int cadvance(float **ppart, float **ppbuff, float **ppbuff2,
+                    int **ihole, float qe[], float fxye[],
+                    float complex ffc[], int mixup[],
+                    float complex sct[], int kpic[], int ncl[],
+                    float qme, float dt, float ax, float ay, float affp,
+                    int indx, int indy, int nloop, int idimp,
+                    int *nppmx0, int *ntmax, int *npbmx, int mx, int my,
+                    float wt[], int *nrecov) {
+/* advances one member of the ensemble for nloop time steps.  this is
+   the main loop of mpic2.c, with particle arrays enlarged on overflow.
+   ffc, mixup and sct are shared by all members and are not modified.
+   when called from within a parallel region, the OpenMP procedures in
+   mpush2.c run in the calling thread.
+   returns 0 if successful, otherwise the error code irc.
+   ppart/ppbuff/ihole = particle, buffer and hole arrays, which may be
+   reallocated with larger sizes nppmx0, npbmx and ntmax
+   ppbuff2 = temporary particle array used to enlarge ppart
+   wt[0:2] = initial field, kinetic and total energies
+   wt[3:5] = final field, kinetic and total energies
+   nrecov = number of times particle arrays were enlarged
+local data                                                            */
+   int j, ntime, isign, irc, nppmx1;
+   int nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy, mx1, my1, mxy1;
+   float qbme, we, wke;
+   float *pptemp = NULL;
+   nx = 1L<<indx; ny = 1L<<indy;
+   nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
+   nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
+   nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+   mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
+   qbme = qme;
+   irc = 0;
+   we = 0.0;
+   wke = 0.0;
+
+   for (ntime = 0; ntime < nloop; ntime++) {
+/* deposit charge: updates qe */
+      for (j = 0; j < nxe*nye; j++) {
+         qe[j] = 0.0;
+      }
+      cgppost2l(*ppart,qe,kpic,qme,*nppmx0,idimp,mx,my,nxe,nye,mx1,
+                mxy1);
+/* add guard cells: updates qe */
+      caguard2l(qe,nx,ny,nxe,nye);
+/* transform charge to fourier space: updates qe */
+      isign = -1;
+      cwfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+/* calculate force/charge in fourier space: updates fxye, we */
+      cmpois22((float complex *)qe,(float complex *)fxye,isign,ffc,ax,
+               ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+/* transform force to real space: updates fxye */
+      isign = 1;
+      cwfft2rm2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+/* copy guard cells: updates fxye */
+      ccguard2l(fxye,nx,ny,nxe,nye);
+/* push particles: updates ppart, ncl, ihole, wke, irc */
+      wke = 0.0;
+      cgppushf2l(*ppart,fxye,kpic,ncl,*ihole,qbme,dt,&wke,idimp,*nppmx0,
+                 nx,ny,mx,my,nxe,nye,mx1,mxy1,*ntmax,&irc);
+/* reorder particles by tile: updates ppart, ppbuff, kpic, ncl, irc */
+      if (irc==0)
+         cpporderf2l(*ppart,*ppbuff,kpic,ncl,*ihole,idimp,*nppmx0,mx1,
+                     my1,*npbmx,*ntmax,&irc);
+/* recover from overflow: enlarge arrays and repeat reordering */
+      while (irc != 0) {
+         *nrecov += 1;
+/* ppart overflow: increase nppmx0 by half */
+         if (irc > *nppmx0) {
+            nppmx1 = *nppmx0 + *nppmx0/2;
+            nppmx1 = irc > nppmx1 ? irc : nppmx1;
+            free(*ppbuff2);
+            *ppbuff2 = (float *) malloc(idimp*nppmx1*mxy1
+                                        *sizeof(float));
+            if (*ppbuff2==NULL)
+               return irc;
+            cppcopy2l(*ppart,*ppbuff2,kpic,idimp,*nppmx0,nppmx1,mxy1);
+            pptemp = *ppart;
+            *ppart = *ppbuff2;
+            *ppbuff2 = pptemp;
+            *nppmx0 = nppmx1;
+         }
+/* ihole or ppbuff overflow: double ntmax and npbmx */
+         else {
+            *ntmax = irc > 2*(*ntmax) ? irc : 2*(*ntmax);
+            *npbmx = *ntmax;
+            free(*ihole);
+            free(*ppbuff);
+            *ppbuff = (float *) malloc(idimp*(*npbmx)*mxy1
+                                       *sizeof(float));
+            *ihole = (int *) malloc(2*(*ntmax+1)*mxy1*sizeof(int));
+            if ((*ppbuff==NULL) || (*ihole==NULL))
+               return irc;
+         }
+/* find particles leaving tiles again and repeat reordering */
+         irc = 0;
+         cppholes2l(*ppart,kpic,ncl,*ihole,idimp,*nppmx0,mx,my,mx1,my1,
+                    *ntmax,&irc);
+         if (irc != 0)
+            continue;
+         cpporderf2l(*ppart,*ppbuff,kpic,ncl,*ihole,idimp,*nppmx0,mx1,
+                     my1,*npbmx,*ntmax,&irc);
+      }
+      if (ntime==0) {
+         wt[0] = we;
+         wt[1] = wke;
+         wt[2] = we + wke;
+      }
+   }
+   wt[3] = we;
+   wt[4] = wke;
+   wt[5] = we + wke;
+   return 0;
+}
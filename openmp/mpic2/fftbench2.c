@@ -0,0 +1,168 @@
+/*---------------------------------------------------------------------*/
+/* Benchmark for 2D real to complex OpenMP FFTs                        */
+/* compares cache-blocked radix-4 ffts cwfft2r4x/cwfft2r42 with        */
+/* radix-2 ffts cwfft2rmx/cwfft2rm2, for a range of grid sizes         */
+/* written for the Skeleton 2D Electrostatic OpenMP PIC code           */
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+#include <sys/time.h>
+#include "mpush2.h"
+#include "omplib.h"
+
+void dtimer(double *time, struct timeval *itime, int icntrl);
+
+int main(int argc, char *argv[]) {
+/* indmin/indmax = range of exponents, nx = ny = 2**ind */
+   int indmin = 7, indmax = 11;
+/* nloop = number of forward/inverse transform pairs timed */
+   int nloop = 20;
+/* nvp = number of shared memory nodes (0=default) */
+   int nvp = 0;
+   int ind, indx, indy, nx, ny, nxh, nxe, nye, nxeh, nxyh, nxhy;
+   int i, j, n, isign, irc;
+   float ea, eb, d, tr2[2], tr4[2];
+   float *q = NULL, *qa = NULL, *qb = NULL;
+   float *fxy = NULL, *fxya = NULL, *fxyb = NULL;
+   int *mixup = NULL;
+   float complex *sct = NULL;
+/* declare and initialize timing data */
+   struct timeval itime;
+   double dtime;
+
+   irc = 0;
+/* nvp = number of shared memory nodes (0=default) */
+   if (argc > 1)
+      nvp = atoi(argv[1]);
+/* initialize for shared memory parallel processing */
+   cinit_omp(nvp);
+   printf("ind   scalar fft (radix-2, radix-4)   vector fft (radix-2, ");
+   printf("radix-4)   max error (scalar, vector)\n");
+
+   for (ind = indmin; ind <= indmax; ind++) {
+      indx = ind; indy = ind;
+      nx = 1L<<indx; ny = 1L<<indy; nxh = nx/2;
+      nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
+      nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+/* allocate data */
+      q = (float *) malloc(nxe*nye*sizeof(float));
+      qa = (float *) malloc(nxe*nye*sizeof(float));
+      qb = (float *) malloc(nxe*nye*sizeof(float));
+      fxy = (float *) malloc(2*nxe*nye*sizeof(float));
+      fxya = (float *) malloc(2*nxe*nye*sizeof(float));
+      fxyb = (float *) malloc(2*nxe*nye*sizeof(float));
+      mixup = (int *) malloc(nxhy*sizeof(int));
+      sct = (float complex *) malloc(nxyh*sizeof(float complex));
+      if ((q==NULL) || (qa==NULL) || (qb==NULL) || (fxy==NULL)
+         || (fxya==NULL) || (fxyb==NULL) || (mixup==NULL)
+         || (sct==NULL)) {
+         printf("fftbench2: allocation failed for ind=%d\n",ind);
+         exit(1);
+      }
+/* prepare fft tables */
+      cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+/* initialize real space data */
+      srand(ind);
+      for (j = 0; j < nxe*nye; j++) {
+         q[j] = (float) rand()/(float) RAND_MAX - 0.5;
+         fxy[2*j] = (float) rand()/(float) RAND_MAX - 0.5;
+         fxy[2*j+1] = (float) rand()/(float) RAND_MAX - 0.5;
+      }
+/* compare single inverse transforms */
+      for (j = 0; j < nxe*nye; j++) {
+         qa[j] = q[j]; qb[j] = q[j];
+         fxya[2*j] = fxy[2*j]; fxyb[2*j] = fxy[2*j];
+         fxya[2*j+1] = fxy[2*j+1]; fxyb[2*j+1] = fxy[2*j+1];
+      }
+      isign = -1;
+      cwfft2rmx((float complex *)qa,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cwfft2r4x((float complex *)qb,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cwfft2rm2((float complex *)fxya,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      cwfft2r42((float complex *)fxyb,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      ea = 0.0; eb = 0.0;
+      for (i = 0; i < ny; i++) {
+         for (j = 0; j < nx; j++) {
+            d = fabsf(qa[j+nxe*i] - qb[j+nxe*i]);
+            ea = d > ea ? d : ea;
+            d = fabsf(fxya[2*(j+nxe*i)] - fxyb[2*(j+nxe*i)]);
+            eb = d > eb ? d : eb;
+            d = fabsf(fxya[1+2*(j+nxe*i)] - fxyb[1+2*(j+nxe*i)]);
+            eb = d > eb ? d : eb;
+         }
+      }
+/* transform back to real space */
+      isign = 1;
+      cwfft2rmx((float complex *)qa,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cwfft2r4x((float complex *)qb,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cwfft2rm2((float complex *)fxya,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      cwfft2r42((float complex *)fxyb,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+/* time forward and inverse transform pairs */
+      for (n = 0; n < 2; n++) {
+         tr2[n] = 0.0; tr4[n] = 0.0;
+      }
+      for (n = 0; n < nloop; n++) {
+         dtimer(&dtime,&itime,-1);
+         for (isign = -1; isign <= 1; isign += 2) {
+            cwfft2rmx((float complex *)qa,isign,mixup,sct,indx,indy,
+                      nxeh,nye,nxhy,nxyh);
+         }
+         dtimer(&dtime,&itime,1);
+         tr2[0] += (float) dtime;
+         dtimer(&dtime,&itime,-1);
+         for (isign = -1; isign <= 1; isign += 2) {
+            cwfft2r4x((float complex *)qb,isign,mixup,sct,indx,indy,
+                      nxeh,nye,nxhy,nxyh);
+         }
+         dtimer(&dtime,&itime,1);
+         tr4[0] += (float) dtime;
+         dtimer(&dtime,&itime,-1);
+         for (isign = -1; isign <= 1; isign += 2) {
+            cwfft2rm2((float complex *)fxya,isign,mixup,sct,indx,indy,
+                      nxeh,nye,nxhy,nxyh);
+         }
+         dtimer(&dtime,&itime,1);
+         tr2[1] += (float) dtime;
+         dtimer(&dtime,&itime,-1);
+         for (isign = -1; isign <= 1; isign += 2) {
+            cwfft2r42((float complex *)fxyb,isign,mixup,sct,indx,indy,
+                      nxeh,nye,nxhy,nxyh);
+         }
+         dtimer(&dtime,&itime,1);
+         tr4[1] += (float) dtime;
+      }
+/* check that round trip recovers the original data */
+      for (i = 0; i < ny; i++) {
+         for (j = 0; j < nx; j++) {
+            d = fabsf(qb[j+nxe*i] - q[j+nxe*i]);
+            if (d > 1.0e-4)
+               irc = 1;
+            d = fabsf(fxyb[2*(j+nxe*i)] - fxy[2*(j+nxe*i)]);
+            if (d > 1.0e-4)
+               irc = 1;
+            d = fabsf(fxyb[1+2*(j+nxe*i)] - fxy[1+2*(j+nxe*i)]);
+            if (d > 1.0e-4)
+               irc = 1;
+         }
+      }
+      printf("%3d   %12.4e %12.4e      %12.4e %12.4e     %10.3e %10.3e\n",
+             ind,tr2[0]/(float) nloop,tr4[0]/(float) nloop,
+             tr2[1]/(float) nloop,tr4[1]/(float) nloop,ea,eb);
+      free(q); free(qa); free(qb);
+      free(fxy); free(fxya); free(fxyb);
+      free(mixup); free(sct);
+   }
+   printf("times are in seconds per forward/inverse transform pair\n");
+   if (irc != 0)
+      printf("fftbench2: round trip error exceeds tolerance\n");
+
+   return irc;
+}
@@ -7,6 +7,7 @@
 #include <sys/time.h>
 #include "mpush2.h"
 #include "omplib.h"
+#include "perflog.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -14,6 +15,11 @@ int main(int argc, char *argv[]) {
 /* indx/indy = exponent which determines grid points in x/y direction: */
 /* nx = 2**indx, ny = 2**indy */
    int indx =   9, indy =   9;
+/* nxn/nyn = number of grid points in x/y direction, if nonzero, used */
+/* instead of 2**indx/2**indy, with a mixed radix fft.  nxn must be a */
+/* multiple of 4 and nyn a multiple of 2, with no prime factors other */
+/* than 2, 3 and 5, e.g., nxn = 384 */
+   int nxn = 0, nyn = 0;
 /* npx/npy = number of electrons distributed in x/y direction */
    int npx =  3072, npy =   3072;
 /* ndim = number of velocity coordinates = 2 */
@@ -36,15 +42,52 @@ int main(int argc, char *argv[]) {
    int mx = 16, my = 16;
 /* xtras = fraction of extra particles needed for particle management */
    float xtras = 0.2;
+/* ksoa = (0,1) = store particles in each tile as */
+/* (array of structures, structure of arrays)     */
+   int ksoa = 0;
+/* kdep = (0,1) = deposit charge with (local tile accumulators, */
+/* tiles processed directly in 4 colors), used if ksoa = 0      */
+   int kdep = 0;
+/* kfuse = (0,1) = push, reorder and deposit in (separate, one) OpenMP */
+/* parallel region, used if ksoa = 0                                   */
+   int kfuse = 0;
+/* kprec = (0,1) = store particle positions in tiles as (absolute,  */
+/* relative to tile) and accumulate charge in tiles in (float,      */
+/* double), used if ksoa = 0                                        */
+   int kprec = 0;
+/* nord = (1,2,3) = particle shape is (linear, quadratic spline, cubic */
+/* spline), used if ksoa = 0 and kprec = 0                             */
+   int nord = 1;
+/* kfft = (0,1,2) = fft with (radix-2, cache-blocked radix-4, mixed */
+/* radix) butterflies, kfft = 2 is used if nxn or nyn is nonzero      */
+   int kfft = 0;
+/* ktune = (0,1,2) = (use mx/my and xtras above, find fastest mx/my and */
+/* xtras and save them in tunefile, reuse mx/my and xtras from tunefile) */
+/* ntune = number of time steps timed for each tile size when tuning */
+   int ktune = 0, ntune = 3;
+   char *tunefile = "mpic2.tune";
+/* kperf = (0,1,2) = write timings and counters for each time step to */
+/* perffile as (none, CSV, JSON lines)                                */
+/* nperf = print summary of timings and counters every nperf time     */
+/* steps, 0 = never                                                   */
+   int kperf = 0, nperf = 0;
+   char *perffile = "mpic2_perf";
 /* declare scalars for standard code */
    int j;
    int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
    int mx1, my1, mxy1, ntime, nloop, isign;
+   int nfac[32];
    float qbme, affp;
 
 /* declare scalars for OpenMP code */
    int nppmx, nppmx0, ntmax, npbmx, irc;
    int nvp;
+/* nrecov = number of times particle arrays were enlarged on overflow */
+   int nrecov = 0, nppmx1, kovf;
+/* nmove = number of particles which changed tiles */
+/* nhmax = maximum number of particles leaving a tile */
+   int nmove, nhmax;
+   FILE *ftune;
 
 /* declare arrays for standard code: */
 /* part = original particle array */
@@ -64,6 +107,8 @@ int main(int argc, char *argv[]) {
 /* ppart = tiled particle array */
 /* ppbuff = buffer array for reordering tiled particle array */
    float *ppart = NULL, *ppbuff = NULL;
+/* pptemp = temporary particle array used to enlarge ppart */
+   float *pptemp = NULL;
 /* kpic = number of particles in each tile */
    int *kpic = NULL;
 /* ncl = number of particles departing tile in each direction */
@@ -77,6 +122,11 @@ int main(int argc, char *argv[]) {
    float tdpost = 0.0, tguard = 0.0, tfft = 0.0, tfield = 0.0;
    float tpush = 0.0, tsort = 0.0;
    double dtime;
+/* timed phases and counters written by cperfstep */
+   char *phnames[6] = {"deposit","guard","fft","field","push","reorder"};
+   char *cnames[3] = {"moved","maxholes","imbalance"};
+   double tperf[6];
+   float cperf[3];
 
    irc = 0;
 /* nvp = number of shared memory nodes  (0=default) */
@@ -85,14 +135,35 @@ int main(int argc, char *argv[]) {
 /* scanf("%i",&nvp);                   */
 /* initialize for shared memory parallel processing */
    cinit_omp(nvp);
+   if (ksoa != 0) {
+      kfuse = 0;
+      kprec = 0;
+   }
+   if ((kprec != 0) || (nord < 2) || (nord > 3))
+      nord = 1;
+   if ((kprec != 0) || (nord > 1))
+      kfuse = 0;
 
 /* initialize scalars for standard code */
 /* np = total number of particles in simulation */
 /* nx/ny = number of grid points in x/y direction */
    np = npx*npy; nx = 1L<<indx; ny = 1L<<indy;
+   if (nxn > 0) nx = nxn;
+   if (nyn > 0) ny = nyn;
    nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
    nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
    nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+   if ((nxn > 0) || (nyn > 0))
+      kfft = 2;
+   if (kfft==2) {
+      if (((nx%4) != 0) || ((ny%2) != 0) || (cfft1nfac(nxh,nfac)==0)
+         || (cfft1nfac(ny,nfac)==0)) {
+         printf("nx=%d, ny=%d not supported by mixed radix fft\n",nx,ny);
+         exit(1);
+      }
+/* mixed radix fft tables have separate x and y parts */
+      nxyh = nxh + ny/2; nxhy = nxh + ny;
+   }
 /* mx1/my1 = number of tiles in x/y direction */
    mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
 /* nloop = number of time steps in simulation */
@@ -108,10 +179,12 @@ int main(int argc, char *argv[]) {
    ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
    mixup = (int *) malloc(nxhy*sizeof(int));
    sct = (float complex *) malloc(nxyh*sizeof(float complex));
-   kpic = (int *) malloc(mxy1*sizeof(int));
 
 /* prepare fft tables */
-   cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+   if (kfft==2)
+      cwfft2rninit(mixup,sct,nx,ny,nxhy,nxyh);
+   else
+      cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
 /* calculate form factors */
    isign = 0;
    cmpois22((float complex *)qe,(float complex *)fxye,isign,ffc,ax,ay,
@@ -119,6 +192,48 @@ int main(int argc, char *argv[]) {
 /* initialize electrons */
    cdistr2(part,vtx,vty,vx0,vy0,npx,npy,idimp,np,nx,ny,ipbc);
 
+/* reuse tile size from previous run: updates mx, my, xtras */
+   if (ktune==2) {
+      ftune = fopen(tunefile,"r");
+      if (ftune==NULL) {
+         ktune = 1;
+      }
+      else {
+         if (fscanf(ftune,"%d %d %f",&mx,&my,&xtras) != 3) {
+            printf("error reading tile size from %s\n",tunefile);
+            exit(1);
+         }
+         fclose(ftune);
+      }
+   }
+/* find fastest tile size: updates mx, my, xtras */
+   if (ktune==1) {
+      for (j = 0; j < ndim*nxe*nye; j++) {
+         fxye[j] = 0.0;
+      }
+      cpptune2l(part,fxye,qbme,dt,qme,&xtras,idimp,np,nx,ny,nxe,nye,
+                ntune,&mx,&my,&irc);
+      if (irc != 0) {
+         printf("cpptune2l error, irc=%d\n",irc);
+         exit(1);
+      }
+      ftune = fopen(tunefile,"w");
+      if (ftune != NULL) {
+         fprintf(ftune,"%d %d %f\n",mx,my,xtras);
+         fclose(ftune);
+      }
+   }
+   if (ktune > 0) {
+      printf("tile size mx, my, xtras = %d,%d,%f\n",mx,my,xtras);
+      mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
+   }
+/* tile fields and charge are kept on the thread stacks */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("tile size mx=%d, my=%d larger than MXM=%d\n",mx,my,MXM);
+      exit(1);
+   }
+   kpic = (int *) malloc(mxy1*sizeof(int));
+
 /* find number of particles in each of mx, my tiles: updates kpic, nppmx */
    cdblkp2l(part,kpic,&nppmx,idimp,np,mx,my,mx1,mxy1,&irc);
    if (irc != 0) { 
@@ -134,33 +249,74 @@ int main(int argc, char *argv[]) {
    ncl = (int *) malloc(8*mxy1*sizeof(int));
    ihole = (int *) malloc(2*(ntmax+1)*mxy1*sizeof(int));
 /* copy ordered particle data for OpenMP: updates ppart and kpic */
-   cppmovin2l(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   if (kprec==1)
+      cppmovin2lr(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   else if (ksoa==0)
+      cppmovin2l(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   else
+      cppmovin2lt(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
    if (irc != 0) { 
       printf("cppmovin2l overflow error, irc=%d\n",irc);
       exit(1);
    }
 /* sanity check */
-   cppcheck2l(ppart,kpic,idimp,nppmx0,nx,ny,mx,my,mx1,my1,&irc);
+   if (kprec==1)
+      cppcheck2lr(ppart,kpic,idimp,nppmx0,nx,ny,mx,my,mx1,my1,&irc);
+   else if (ksoa==0)
+      cppcheck2l(ppart,kpic,idimp,nppmx0,nx,ny,mx,my,mx1,my1,&irc);
+   else
+      cppcheck2lt(ppart,kpic,idimp,nppmx0,nx,ny,mx,my,mx1,my1,&irc);
    if (irc != 0) {
       printf("%d,cppcheck2l error: irc=%d\n",ntime,irc);
       exit(1);
    }
 
+/* open file for timings and counters */
+   if ((kperf > 0) || (nperf > 0)) {
+      if (cperfopen(perffile,kperf,nperf,6,phnames,3,cnames) != 0) {
+         printf("cperfopen error: kperf, perffile=%d,%s\n",kperf,
+                perffile);
+         exit(1);
+      }
+   }
+
 /* * * * start main iteration loop * * * */
 
 L500: if (nloop <= ntime)
          goto L2000;
+/* phase times for this time step, written by cperfstep */
+      for (j = 0; j < 6; j++) {
+         tperf[j] = 0.0;
+      }
 /*    printf("ntime = %i\n",ntime); */
 
 /* deposit charge with OpenMP: updates qe */
-      dtimer(&dtime,&itime,-1);
-      for (j = 0; j < nxe*nye; j++) {
-         qe[j] = 0.0;
+/* with fused step, charge was deposited during previous time step */
+      if ((kfuse==0) || (ntime==0)) {
+         dtimer(&dtime,&itime,-1);
+         for (j = 0; j < nxe*nye; j++) {
+            qe[j] = 0.0;
+         }
+         if (kprec==1)
+            cgppost2lr(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                       mxy1);
+         else if (nord > 1)
+            cgppost2s(ppart,qe,kpic,qme,nppmx0,idimp,nx,ny,mx,my,nxe,
+                      nye,mx1,mxy1,nord);
+         else if ((ksoa==0) && (kdep==0))
+            cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                      mxy1);
+         else if (ksoa==0)
+            cgppost2lc(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                       mxy1);
+         else
+            cvgppost2lt(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                        mxy1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tdpost += time;
+         tperf[0] += dtime;
       }
-      cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,mxy1);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tdpost += time;
 
 /* add guard cells with OpenMP: updates qe */
       dtimer(&dtime,&itime,-1);
@@ -168,15 +324,24 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* transform charge to fourier space with OpenMP: updates qe */
       dtimer(&dtime,&itime,-1);
       isign = -1;
-      cwfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,
-                nye,nxhy,nxyh);
+      if (kfft==2)
+         cwfft2rmnx((float complex *)qe,isign,mixup,sct,nx,ny,nxeh,nye,
+                    nxhy,nxyh);
+      else if (kfft==1)
+         cwfft2r4x((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,
+                   nye,nxhy,nxyh);
+      else
+         cwfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,
+                   nye,nxhy,nxyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
+      tperf[2] += dtime;
 
 /* calculate force/charge in fourier space with OpenMP: updates fxye, we */
       dtimer(&dtime,&itime,-1);
@@ -186,16 +351,25 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
+      tperf[3] += dtime;
 
 /* transform force to real space with OpenMP: updates fxye */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      cwfft2rm2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,
-                nye,nxhy,nxyh);
+      if (kfft==2)
+         cwfft2rmn2((float complex *)fxye,isign,mixup,sct,nx,ny,nxeh,
+                    nye,nxhy,nxyh);
+      else if (kfft==1)
+         cwfft2r42((float complex *)fxye,isign,mixup,sct,indx,indy,
+                   nxeh,nye,nxhy,nxyh);
+      else
+         cwfft2rm2((float complex *)fxye,isign,mixup,sct,indx,indy,
+                   nxeh,nye,nxhy,nxyh);
 
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
+      tperf[2] += dtime;
 
 /* copy guard cells with OpenMP: updates fxye */
       dtimer(&dtime,&itime,-1);
@@ -203,6 +377,7 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* push particles with OpenMP: */
       wke = 0.0;
@@ -211,15 +386,27 @@ L500: if (nloop <= ntime)
 /*    cgppush2l(ppart,fxye,kpic,qbme,dt,&wke,idimp,nppmx0,nx,ny,mx,my, */
 /*              nxe,nye,mx1,mxy1,ipbc);                                */
 /* updates ppart, ncl, ihole, wke, irc */
-      cgppushf2l(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,nppmx0,
-                 nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+/* fused step also updates ppbuff, kpic and qe for next time step */
+      if (kfuse==1)
+         cgppushfpost2l(ppart,fxye,ppbuff,qe,kpic,ncl,ihole,qbme,dt,qme,
+                        &wke,idimp,nppmx0,nx,ny,mx,my,nxe,nye,mx1,my1,
+                        npbmx,ntmax,&irc);
+      else if (kprec==1)
+         cgppushf2lr(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                     nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+      else if (nord > 1)
+         cgppushf2s(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,nppmx0,
+                    nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,nord,&irc);
+      else if (ksoa==0)
+         cgppushf2l(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,nppmx0,
+                    nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+      else
+         cvgppushf2lt(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                      nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
-      if (irc != 0) {
-         printf("cgppushf2l error: irc=%d\n",irc);
-         exit(1);
-      }
+      tperf[4] += dtime;
 
 /* reorder particles by tile with OpenMP: */
       dtimer(&dtime,&itime,-1);
@@ -227,14 +414,92 @@ L500: if (nloop <= ntime)
 /*    cpporder2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx,ny,mx,my, */
 /*               mx1,my1,npbmx,ntmax,&irc);                            */
 /* updates ppart, ppbuff, kpic, ncl, and irc */
-      cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,my1,
-                  npbmx,ntmax,&irc);
+      kovf = irc;
+      if ((irc==0) && (kfuse==0)) {
+         if (kprec==1)
+            cpporderf2lr(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx,ny,
+                         mx,my,mx1,my1,npbmx,ntmax,&irc);
+         else if (ksoa==0)
+            cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,
+                        my1,npbmx,ntmax,&irc);
+         else
+            cpporderf2lt(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,
+                         my1,npbmx,ntmax,&irc);
+      }
+/* recover from overflow: enlarge arrays and repeat reordering */
+      while (irc != 0) {
+         nrecov += 1;
+/* ppart overflow: increase nppmx0 by half */
+         if (irc > nppmx0) {
+            nppmx1 = nppmx0 + nppmx0/2;
+            nppmx1 = irc > nppmx1 ? irc : nppmx1;
+            pptemp = (float *) malloc(idimp*nppmx1*mxy1*sizeof(float));
+            if (ksoa==0)
+               cppcopy2l(ppart,pptemp,kpic,idimp,nppmx0,nppmx1,mxy1);
+            else
+               cppcopy2lt(ppart,pptemp,kpic,idimp,nppmx0,nppmx1,mxy1);
+            free(ppart);
+            ppart = pptemp;
+            nppmx0 = nppmx1;
+         }
+/* ihole or ppbuff overflow: double ntmax and npbmx */
+         else {
+            ntmax = irc > 2*ntmax ? irc : 2*ntmax;
+            npbmx = ntmax;
+            free(ihole);
+            free(ppbuff);
+            ppbuff = (float *) malloc(idimp*npbmx*mxy1*sizeof(float));
+            ihole = (int *) malloc(2*(ntmax+1)*mxy1*sizeof(int));
+         }
+         printf("%d,overflow, irc=%d: nppmx0, ntmax, npbmx = %d,%d,%d\n",
+                ntime,irc,nppmx0,ntmax,npbmx);
+/* find particles leaving tiles again and repeat reordering */
+         irc = 0;
+         if (kprec==1)
+            cppholes2lr(ppart,kpic,ncl,ihole,idimp,nppmx0,nx,ny,mx,my,
+                        mx1,my1,ntmax,&irc);
+         else if (ksoa==0)
+            cppholes2l(ppart,kpic,ncl,ihole,idimp,nppmx0,mx,my,mx1,my1,
+                       ntmax,&irc);
+         else
+            cppholes2lt(ppart,kpic,ncl,ihole,idimp,nppmx0,mx,my,mx1,my1,
+                        ntmax,&irc);
+         if (irc != 0)
+            continue;
+         if (kprec==1)
+            cpporderf2lr(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx,ny,
+                         mx,my,mx1,my1,npbmx,ntmax,&irc);
+         else if (ksoa==0)
+            cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,
+                        my1,npbmx,ntmax,&irc);
+         else
+            cpporderf2lt(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,
+                         my1,npbmx,ntmax,&irc);
+      }
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tsort += time;
-      if (irc != 0) {
-         printf("cpporderf2l error: ntmax, irc=%d,%d\n",ntmax,irc);
-         exit(1);
+      tperf[5] += dtime;
+/* fused step stopped by overflow before depositing charge */
+      if ((kfuse==1) && (kovf != 0)) {
+         dtimer(&dtime,&itime,-1);
+         for (j = 0; j < nxe*nye; j++) {
+            qe[j] = 0.0;
+         }
+         cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                   mxy1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tdpost += time;
+         tperf[0] += dtime;
+      }
+
+/* record timings and counters for this time step */
+      if ((kperf > 0) || (nperf > 0)) {
+         cppstat2l(kpic,ihole,ntmax,mxy1,&nmove,&nhmax,&cperf[2]);
+         cperf[0] = (float) nmove;
+         cperf[1] = (float) nhmax;
+         cperfstep(ntime,tperf,cperf);
       }
 
       if (ntime==0) {
@@ -247,9 +512,14 @@ L2000:
 
 /* * * * end main iteration loop * * * */
 
+   if ((kperf > 0) || (nperf > 0))
+      cperfclose();
    printf("ntime = %i\n",ntime);
    printf("Final Field, Kinetic and Total Energies:\n");
    printf("%e %e %e\n",we,wke,wke+we);
+   if (nrecov > 0) {
+      printf("particle arrays enlarged %d times on overflow\n",nrecov);
+   }
 
    printf("\n");
    printf("deposit time = %f\n",tdpost);
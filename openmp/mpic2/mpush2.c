@@ -5,8 +5,11 @@
 #include <stdio.h>
 #include <complex.h>
 #include <math.h>
+#include <sys/time.h>
 #include "mpush2.h"
 
+void dtimer(double *time, struct timeval *itime, int icntrl);
+
 /*--------------------------------------------------------------------*/
 double ranorm() {
 /* this program calculates a random number y from a gaussian distribution
@@ -161,9 +164,16 @@ void cdblkp2l(float part[], int kpic[], int *nppmx, int idimp, int nop,
    mx1 = (system length in x direction - 1)/mx + 1
    mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM = 128, the largest tile the
+   push and deposit procedures accept
 local data                                                            */
    int j, k, n, m, isum, ist, npx, ierr;
    ierr = 0;
+/* error if tile is too large for local arrays in push and deposit */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
+   }
 /* clear counter array */
    for (k = 0; k < mxy1; k++) {
       kpic[k] = 0;
@@ -355,6 +365,7 @@ void cgppush2l(float ppart[], float fxy[], int kpic[], float qbm,
    nppmx = maximum number of particles in tile
    nx/ny = system length in x/y direction
    mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
    nxv = second dimension of field arrays, must be >= nx+1
    nyv = third dimension of field arrays, must be >= ny+1
    mx1 = (system length in x direction - 1)/mx + 1
@@ -362,16 +373,11 @@ void cgppush2l(float ppart[], float fxy[], int kpic[], float qbm,
    ipbc = particle boundary condition = (0,1,2,3) =
    (none,2d periodic,2d reflecting,mixed reflecting/periodic)
 local data                                                            */
-#define MXV             33
-#define MYV             33
    int noff, moff, npoff, npp;
    int i, j, k, nn, mm, mxv;
    float qtm, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
    float x, y, dx, dy, vx, vy;
-   float sfxy[2*MXV*MYV];
-/* float sfxy[2*(mx+1)*(my+1)]; */
    double sum1, sum2;
-/* mxv = MXV; */
    mxv = mx+1;
    qtm = qbm*dt;
    sum2 = 0.0;
@@ -390,15 +396,18 @@ local data                                                            */
       edgelx = 1.0f;
       edgerx = (float) (nx-1);
    }
-/* error if local array is too small */
-/* if ((mx >= MXV) || (my >= MYV))   */
-/*    return;                        */
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cgppush2l error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
 /* loop over tiles */
 #pragma omp parallel for \
 private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy,dx,dy, \
-vx,vy,sum1,sfxy) \
+vx,vy,sum1) \
 reduction(+:sum2)
    for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+1)*(my+1)];
       noff = k/mx1;
       moff = my*noff;
       noff = mx*(k - mx1*noff);
@@ -477,8 +486,6 @@ reduction(+:sum2)
 /* normalize kinetic energy */
    *ek += 0.125f*sum2;
    return;
-#undef MXV
-#undef MYV
 }
 
 /*--------------------------------------------------------------------*/
@@ -527,38 +534,39 @@ void cgppushf2l(float ppart[], float fxy[], int kpic[], int ncl[],
    nppmx = maximum number of particles in tile
    nx/ny = system length in x/y direction
    mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
    nxv = second dimension of field arrays, must be >= nx+1
    nyv = third dimension of field arrays, must be >= ny+1
    mx1 = (system length in x direction - 1)/mx + 1
    mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
    ntmax = size of hole array for particles leaving tiles
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM
    optimized version
 local data                                                            */
-#define MXV             33
-#define MYV             33
    int noff, moff, npoff, npp;
    int i, j, k, ih, nh, nn, mm, mxv;
    float qtm, dxp, dyp, amx, amy;
    float x, y, dx, dy, vx, vy;
    float anx, any, edgelx, edgely, edgerx, edgery;
-   float sfxy[2*MXV*MYV];
-/* float sfxy[2*(mx+1)*(my+1)]; */
    double sum1, sum2;
    mxv = mx + 1;
    qtm = qbm*dt;
    anx = (float) nx;
    any = (float) ny;
    sum2 = 0.0;
-/* error if local array is too small */
-/* if ((mx >= MXV) || (my >= MYV))   */
-/*    return;                        */
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
+   }
 /* loop over tiles */
 #pragma omp parallel for \
 private(i,j,k,noff,moff,npp,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy, \
-dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1,sfxy) \
+dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1) \
 reduction(+:sum2)
    for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+1)*(my+1)];
       noff = k/mx1;
       moff = my*noff;
       noff = mx*(k - mx1*noff);
@@ -692,8 +700,6 @@ reduction(+:sum2)
 /* normalize kinetic energy */
    *ek += 0.125f*sum2;
    return;
-#undef MXV
-#undef MYV
 }
 
 /*--------------------------------------------------------------------*/
@@ -721,26 +727,26 @@ void cgppost2l(float ppart[], float q[], int kpic[], float qm,
    nppmx = maximum number of particles in tile
    idimp = size of phase space = 4
    mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
    nxv = first dimension of charge array, must be >= nx+1
    nyv = second dimension of charge array, must be >= ny+1
    mx1 = (system length in x direction - 1)/mx + 1
    mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
 local data                                                            */
-#define MXV             33
-#define MYV             33
    int noff, moff, npoff, npp, mxv;
    int i, j, k, nn, mm;
    float x, y, dxp, dyp, amx, amy;
-   float sq[MXV*MYV];
-/* float sq[(mx+1)*(my+1)]; */
    mxv = mx + 1;
-/* error if local array is too small */
-/* if ((mx >= MXV) || (my >= MYV))   */
-/*    return;                        */
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cgppost2l error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
 /* loop over tiles */
 #pragma omp parallel for \
-private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy,sq)
+private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy)
    for (k = 0; k < mxy1; k++) {
+      float sq[(mx+1)*(my+1)];
       noff = k/mx1;
       moff = my*noff;
       noff = mx*(k - mx1*noff);
@@ -806,8 +812,88 @@ private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy,sq)
       }
    }
    return;
-#undef MXV
-#undef MYV
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost2lc(float ppart[], float q[], int kpic[], float qm,
+                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                int mx1, int mxy1) {
+/* for 2d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   OpenMP version using guard cells
+   data deposited directly to global array, tiles processed in 4 colors
+   particles stored segmented array
+   17 flops/particle, 6 loads, 4 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   tiles are colored by the parity of their x and y tile index, and
+   all the tiles of one color are processed in parallel before the
+   next color is started.  tiles of the same color are never adjacent,
+   so no local accumulator or atomic update is needed, and there is no
+   limit on the tile size
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   q[k][j] = charge density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   mx/my = number of grids in sorting cell in x/y
+   nxv = first dimension of charge array, must be >= nx+1
+   nyv = second dimension of charge array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+local data                                                            */
+   int npoff, npp, my1;
+   int j, k, l, kk, lx, ly, nlx, nly, nn, mm;
+   float x, y, dxp, dyp, amx, amy;
+   my1 = mxy1/mx1;
+/* loop over colors */
+   for (l = 0; l < 4; l++) {
+      ly = l/2;
+      lx = l - 2*ly;
+/* number of tiles of this color in x and y */
+      nlx = (mx1 - lx + 1)/2;
+      nly = (my1 - ly + 1)/2;
+/* loop over tiles of this color */
+#pragma omp parallel for \
+private(j,k,kk,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy)
+      for (kk = 0; kk < nlx*nly; kk++) {
+         mm = kk/nlx;
+         k = lx + 2*(kk - nlx*mm) + mx1*(ly + 2*mm);
+         npp = kpic[k];
+         npoff = nppmx*k;
+/* loop over particles in tile */
+         for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+            x = ppart[idimp*(j+npoff)];
+            y = ppart[1+idimp*(j+npoff)];
+            nn = x;
+            mm = y;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            nn = nn + nxv*mm;
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+/* deposit charge directly to global array */
+            x = q[nn] + amx*amy;
+            y = q[nn+1] + dxp*amy;
+            q[nn] = x;
+            q[nn+1] = y;
+            nn += nxv;
+            x = q[nn] + amx*dyp;
+            y = q[nn+1] + dxp*dyp;
+            q[nn] = x;
+            q[nn+1] = y;
+         }
+      }
+   }
+   return;
 }
 
 /*--------------------------------------------------------------------*/
@@ -843,6 +929,8 @@ void cpporder2l(float ppart[], float ppbuff[], int kpic[], int ncl[],
    npbmx = size of buffer array ppbuff
    ntmax = size of hole array for particles leaving tiles
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   particles are not moved between tiles if an error occurs, so that
+   the reordering can be repeated with larger arrays
 local data                                                            */
    int mxy1, noff, moff, npp, ncoff;
    int i, j, k, ii, kx, ky, ih, nh, ist, nn, mm, isum;
@@ -985,6 +1073,57 @@ private(i,j,k,isum,ist,nh,ip,j1,ii)
    if (*irc > 0)
       return;
 
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp parallel for \
+private(k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ncoff,ks)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+      npp = kpic[k] - ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+         npp += ncl[ii+8*ks[ii]] - ncoff;
+      }
+/* set error */
+      if (npp > nppmx)
+         *irc = npp;
+   }
+/* ppart overflow */
+   if (*irc > 0)
+      return;
+
 /* copy incoming particles from buffer into ppart: update ppart, kpic */
 /* loop over tiles */
 #pragma omp parallel for \
@@ -1109,6 +1248,8 @@ void cpporderf2l(float ppart[], float ppbuff[], int kpic[], int ncl[],
    npbmx = size of buffer array ppbuff
    ntmax = size of hole array for particles leaving tiles
    irc = maximum overflow, returned only if error occurs, when irc > 0
+   particles are not moved between tiles if an error occurs, so that
+   the reordering can be repeated with larger arrays
 local data                                                            */
    int mxy1, npp, ncoff;
    int i, j, k, ii, kx, ky, ih, nh, ist, isum;
@@ -1154,6 +1295,57 @@ private(i,j,k,isum,ist,nh,ip,j1,ii)
    if (*irc > 0)
       return;
 
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp parallel for \
+private(k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ncoff,ks)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+      npp = kpic[k] - ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+         npp += ncl[ii+8*ks[ii]] - ncoff;
+      }
+/* set error */
+      if (npp > nppmx)
+         *irc = npp;
+   }
+/* ppart overflow */
+   if (*irc > 0)
+      return;
+
 /* copy incoming particles from buffer into ppart: update ppart, kpic */
 /* loop over tiles */
 #pragma omp parallel for \
@@ -1248,590 +1440,5555 @@ private(i,j,k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ih,nh,ncoff,ist,j1,j2,ip,ks)
 }
 
 /*--------------------------------------------------------------------*/
-void ccguard2l(float fxy[], int nx, int ny, int nxe, int nye) {
-/* replicate extended periodic vector field fxy
-   linear interpolation
-   nx/ny = system length in x/y direction
-   nxe = first dimension of field arrays, must be >= nx+1
-   nxe = second dimension of field arrays, must be >= ny+1
-local data                                                 */
-   int j, k;
-/* copy edges of extended field */
-   for (k = 0; k < ny; k++) {
-      fxy[2*nx+2*nxe*k] = fxy[2*nxe*k];
-      fxy[1+2*nx+2*nxe*k] = fxy[1+2*nxe*k];
-   }
-   for (j = 0; j < nx; j++) {
-      fxy[2*j+2*nxe*ny] = fxy[2*j];
-      fxy[1+2*j+2*nxe*ny] = fxy[1+2*j];
-   }
-   fxy[2*nx+2*nxe*ny] = fxy[0];
-   fxy[1+2*nx+2*nxe*ny] = fxy[1];
-   return;
-}
-
-/*--------------------------------------------------------------------*/
-void caguard2l(float q[], int nx, int ny, int nxe, int nye) {
-/* accumulate extended periodic scalar field q
-   linear interpolation
+void cgppushfpost2l(float ppart[], float fxy[], float ppbuff[],
+                    float q[], int kpic[], int ncl[], int ihole[],
+                    float qbm, float dt, float qm, float *ek, int idimp,
+                    int nppmx, int nx, int ny, int mx, int my, int nxv,
+                    int nyv, int mx1, int my1, int npbmx, int ntmax,
+                    int *irc) {
+/* for 2d code, this subroutine performs the particle part of a time
+   step in a single OpenMP parallel region: it updates particle
+   co-ordinates and velocities, reorders particles by tile, and
+   calculates the charge density for the next time step, using
+   first-order linear interpolation in space, with periodic boundary
+   conditions.  it is equivalent to calling cgppushf2l, cpporderf2l,
+   then clearing q and calling cgppost2l.
+   there are 3 phases, separated by the barriers required by the data
+   dependencies.  first, for each tile, particles are pushed, particles
+   leaving the tile are found, and these are copied to ppbuff while the
+   tile is still in cache.  second, the new number of particles in each
+   tile is checked.  finally, for each tile, incoming particles are
+   copied from the buffers of the neighboring tiles, and charge is
+   deposited from the tile.
+   if an overflow occurs, the charge is not deposited and irc is
+   returned as for cgppushf2l and cpporderf2l, so that the caller can
+   enlarge arrays, complete the reordering with cppholes2l and
+   cpporderf2l, and deposit the charge with cgppost2l.
+   input: all except ppbuff, q, ncl, ihole, ek, irc
+   output: ppart, ppbuff, q, kpic, ncl, ihole, ek, irc
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = velocity vx of particle n in tile m
+   ppart[m][n][3] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   ppbuff[k][n][i] = i co-ordinate of particle n in tile k
+   q[k][j] = charge density at grid point j,k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   qm = charge on particle, in units of e
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
    nx/ny = system length in x/y direction
-   nxe = first dimension of field arrays, must be >= nx+1
-   nxe = second dimension of field arrays, must be >= ny+1
-local data                                                 */
-   int j, k;
-/* accumulate edges of extended field */
-   for (k = 0; k < ny; k++) {
-      q[nxe*k] += q[nx+nxe*k];
-      q[nx+nxe*k] = 0.0;
-   }
-   for (j = 0; j < nx; j++) {
-      q[j] += q[j+nxe*ny];
-      q[j+nxe*ny] = 0.0;
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = first dimension of field arrays, must be >= nx+1
+   nyv = second dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM
+local data                                                            */
+   int mxy1, noff, moff, npoff, npp, ncoff;
+   int i, j, k, ii, ih, nh, nn, mm, mxv, ist, isum;
+   int ip, j1, j2, kx, ky, kxl, kxr, kk, kl, kr;
+   int ierr;
+   int ks[8];
+   float qtm, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+   double sum1, sum2;
+   mxy1 = mx1*my1;
+   mxv = mx + 1;
+   qtm = qbm*dt;
+   anx = (float) nx;
+   any = (float) ny;
+   sum2 = 0.0;
+   ierr = 0;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
    }
-   q[0] += q[nx+nxe*ny];
-   q[nx+nxe*ny] = 0.0;
-   return;
-}
-
-/*--------------------------------------------------------------------*/
-void cmpois22(float complex q[], float complex fxy[], int isign,
-              float complex ffc[], float ax, float ay, float affp,
-              float *we, int nx, int ny, int nxvh, int nyv, int nxhd,
-              int nyhd) {
-/* this subroutine solves 2d poisson's equation in fourier space for
-   force/charge (or convolution of electric field over particle shape)
-   with periodic boundary conditions.
-   for isign = 0, input: isign,ax,ay,affp,nx,ny,nxvh,nyhd, output: ffc
-   for isign /= 0, input: q,ffc,isign,nx,ny,nxvh,nyhd, output: fxy,we
-   approximate flop count is: 26*nxc*nyc + 12*(nxc + nyc)
-   where nxc = nx/2 - 1, nyc = ny/2 - 1
-   equation used is:
-   fx[ky][kx] = -sqrt(-1)*kx*g[ky][kx]*s[ky][kx]*q[ky][kx],
-   fy[ky][kx] = -sqrt(-1)*ky*g[ky][kx]*s[ky][kx]*q[ky][kx],
-   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
-   g[ky][kx] = (affp/(kx**2+ky**2))*s(kx,ky),
-   s[ky][kx] = exp(-((kx*ax)**2+(ky*ay)**2)/2), except for
-   fx(kx=pi) = fy(kx=pi) = fx(ky=pi) = fy(ky=pi) = 0, and
-   fx(kx=0,ky=0) = fy(kx=0,ky=0) = 0.
-   q[k][j] = complex charge density for fourier mode (j,k)
-   fxy[k][j][0] = x component of complex force/charge,
-   fxy[k][j][1] = y component of complex force/charge,
-   all for fourier mode (j,k)
-   if isign = 0, form factor array is prepared
-   if isign is not equal to 0, force/charge is calculated
-   cimag(ffc[k][j]) = finite-size particle shape factor s
-   for fourier mode (j,k)
-   creal(ffc[k][j]) = potential green's function g
-   for fourier mode (j,k)
-   ax/ay = half-width of particle in x/y direction
-   affp = normalization constant = nx*ny/np, where np=number of particles
-   electric field energy is also calculated, using
-   we = nx*ny*sum((affp/(kx**2+ky**2))*|q[ky][kx]*s[ky][kx]|**2)
-   nx/ny = system length in x/y direction
-   nxvh = first dimension of field arrays, must be >= nxh
-   nyv = second dimension of field arrays, must be >= ny
-   nxhd = first dimension of form factor array, must be >= nxh
-   nyhd = second dimension of form factor array, must be >= nyh
-local data                                                 */
-   int nxh, nyh, j, k, k1, kk, kj;
+#pragma omp parallel \
+private(i,j,k,ii,noff,moff,npp,npoff,ncoff,nn,mm,ih,nh,ist,isum,ip,j1, \
+j2,kx,ky,kxl,kxr,kk,kl,kr,ks,x,y,dxp,dyp,amx,amy,dx,dy,vx,vy,edgelx, \
+edgely,edgerx,edgery,sum1)
+   {
+/* clear charge density for next time step */
+#pragma omp for nowait
+      for (j = 0; j < nxv*nyv; j++) {
+         q[j] = 0.0f;
+      }
+/* push particles and buffer particles leaving tile */
+/* loop over tiles */
+#pragma omp for reduction(+:sum2)
+      for (k = 0; k < mxy1; k++) {
+         float sfxy[2*(mx+1)*(my+1)];
+         noff = k/mx1;
+         moff = my*noff;
+         noff = mx*(k - mx1*noff);
+         npp = kpic[k];
+         npoff = nppmx*k;
+         nn = nx - noff;
+         nn = mx < nn ? mx : nn;
+         mm = ny - moff;
+         mm = my < mm ? my : mm;
+         edgelx = noff;
+         edgerx = noff + nn;
+         edgely = moff;
+         edgery = moff + mm;
+         ih = 0;
+         nh = 0;
+         nn += 1;
+         mm += 1;
+/* load local fields from global array */
+         for (j = 0; j < mm; j++) {
+            for (i = 0; i < nn; i++) {
+               sfxy[2*(i+mxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];
+               sfxy[1+2*(i+mxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))];
+            }
+         }
+/* clear counters */
+         for (j = 0; j < 8; j++) {
+            ncl[j+8*k] = 0;
+         }
+         sum1 = 0.0;
+/* loop over particles in tile */
+         for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+            x = ppart[idimp*(j+npoff)];
+            y = ppart[1+idimp*(j+npoff)];
+            nn = x;
+            mm = y;
+            dxp = x - (float) nn;
+            dyp = y - (float) mm;
+            nn = 2*(nn - noff) + 2*mxv*(mm - moff);
+            amx = 1.0f - dxp;
+            amy = 1.0f - dyp;
+/* find acceleration */
+            dx = amx*sfxy[nn];
+            dy = amx*sfxy[nn+1];
+            dx = amy*(dxp*sfxy[nn+2] + dx);
+            dy = amy*(dxp*sfxy[nn+3] + dy);
+            nn += 2*mxv;
+            vx = amx*sfxy[nn];
+            vy = amx*sfxy[nn+1];
+            dx += dyp*(dxp*sfxy[nn+2] + vx);
+            dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+            vx = ppart[2+idimp*(j+npoff)];
+            vy = ppart[3+idimp*(j+npoff)];
+            dx = vx + qtm*dx;
+            dy = vy + qtm*dy;
+/* average kinetic energy */
+            vx += dx;
+            vy += dy;
+            sum1 += (vx*vx + vy*vy);
+            ppart[2+idimp*(j+npoff)] = dx;
+            ppart[3+idimp*(j+npoff)] = dy;
+/* new position */
+            dx = x + dx*dt;
+            dy = y + dy*dt;
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx -= anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy -= any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+/* set new position */
+            ppart[idimp*(j+npoff)] = dx;
+            ppart[1+idimp*(j+npoff)] = dy;
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+8*k-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+                  ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+         sum2 += sum1;
+/* set error and end of file flag */
+/* ihole overflow */
+         if (nh > 0) {
+            *irc = ih;
+            ih = -ih;
+         }
+         ihole[2*(ntmax+1)*k] = ih;
+/* find address offset for ordered ppbuff array */
+         isum = 0;
+         for (j = 0; j < 8; j++) {
+            ist = ncl[j+8*k];
+            ncl[j+8*k] = isum;
+            isum += ist;
+         }
+         ip = 0;
+/* loop over particles leaving tile */
+         for (j = 0; j < ih; j++) {
+/* buffer particles that are leaving tile, in direction order */
+            j1 = ihole[2*(j+1+(ntmax+1)*k)] - 1;
+            ist = ihole[1+2*(j+1+(ntmax+1)*k)];
+            ii = ncl[ist+8*k-1];
+            if (ii < npbmx) {
+               for (i = 0; i < idimp; i++) {
+                  ppbuff[i+idimp*(ii+npbmx*k)]
+                  = ppart[i+idimp*(j1+npoff)];
+               }
+            }
+            else {
+               ip = 1;
+            }
+            ncl[ist+8*k-1] = ii + 1;
+         }
+/* set error */
+/* ppbuff overflow */
+         if (ip > 0)
+            *irc = ncl[7+8*k];
+      }
+/* ihole or ppbuff overflow: all threads leave after the barrier */
+      if (*irc==0) {
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp for
+         for (k = 0; k < mxy1; k++) {
+            ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+            kk = ky*mx1;
+/* find tile above */
+            kl = ky - 1;
+            if (kl < 0)
+               kl += my1;
+            kl = kl*mx1;
+/* find tile below */
+            kr = ky + 1;
+            if (kr >= my1)
+                kr -= my1;
+            kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+            kx = k - ky*mx1;
+            kxl = kx - 1;
+            if (kxl < 0)
+               kxl += mx1;
+            kxr = kx + 1;
+            if (kxr >= mx1)
+               kxr -= mx1;
+/* find tile number for different directions */
+            ks[0] = kxr + kk;
+            ks[1] = kxl + kk;
+            ks[2] = kx + kr;
+            ks[3] = kxr + kr;
+            ks[4] = kxl + kr;
+            ks[5] = kx + kl;
+            ks[6] = kxr + kl;
+            ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+            npp = kpic[k] - ihole[2*(ntmax+1)*k];
+            ncoff = 0;
+            for (ii = 0; ii < 8; ii++) {
+               if (ii > 0)
+                  ncoff = ncl[ii-1+8*ks[ii]];
+               npp += ncl[ii+8*ks[ii]] - ncoff;
+            }
+/* set error */
+            if (npp > nppmx)
+               ierr = npp;
+         }
+/* ppart overflow: all threads leave after the barrier */
+         if (ierr==0) {
+/* copy incoming particles and deposit charge for next time step */
+/* loop over tiles */
+#pragma omp for
+            for (k = 0; k < mxy1; k++) {
+               float sq[(mx+1)*(my+1)];
+               npp = kpic[k];
+               npoff = nppmx*k;
+               ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+               kk = ky*mx1;
+/* find tile above */
+               kl = ky - 1;
+               if (kl < 0)
+                  kl += my1;
+               kl = kl*mx1;
+/* find tile below */
+               kr = ky + 1;
+               if (kr >= my1)
+                   kr -= my1;
+               kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+               kx = k - ky*mx1;
+               kxl = kx - 1;
+               if (kxl < 0)
+                  kxl += mx1;
+               kxr = kx + 1;
+               if (kxr >= mx1)
+                  kxr -= mx1;
+/* find tile number for different directions */
+               ks[0] = kxr + kk;
+               ks[1] = kxl + kk;
+               ks[2] = kx + kr;
+               ks[3] = kxr + kr;
+               ks[4] = kxl + kr;
+               ks[5] = kx + kl;
+               ks[6] = kxr + kl;
+               ks[7] = kxl + kl;
+/* loop over directions */
+               nh = ihole[2*(ntmax+1)*k];
+               ncoff = 0;
+               ih = 0;
+               j1 = 0;
+               for (ii = 0; ii < 8; ii++) {
+                  if (ii > 0)
+                     ncoff = ncl[ii-1+8*ks[ii]];
+/* ip = number of particles coming from direction ii */
+                  ip = ncl[ii+8*ks[ii]] - ncoff;
+                  for (j = 0; j < ip; j++) {
+                     ih += 1;
+/* insert incoming particles into holes */
+                     if (ih <= nh) {
+                        j1 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+                     }
+/* place overflow at end of array */
+                     else {
+                        j1 = npp;
+                        npp += 1;
+                     }
+                     for (i = 0; i < idimp; i++) {
+                        ppart[i+idimp*(j1+npoff)]
+                        = ppbuff[i+idimp*(j+ncoff+npbmx*ks[ii])];
+                     }
+                  }
+               }
+/* fill up remaining holes in particle array with particles from bottom */
+               if (ih < nh) {
+                  ip = nh - ih;
+                  for (j = 0; j < ip; j++) {
+                     j1 = npp - j - 1;
+                     j2 = ihole[2*(nh-j+(ntmax+1)*k)] - 1;
+                     if (j1 > j2) {
+/* move particle only if it is below current hole */
+                        for (i = 0; i < idimp; i++) {
+                           ppart[i+idimp*(j2+npoff)]
+                           = ppart[i+idimp*(j1+npoff)];
+                        }
+                     }
+                  }
+                  npp -= ip;
+               }
+               kpic[k] = npp;
+               noff = k/mx1;
+               moff = my*noff;
+               noff = mx*(k - mx1*noff);
+/* zero out local accumulator */
+               for (j = 0; j < mxv*(my+1); j++) {
+                  sq[j] = 0.0f;
+               }
+/* loop over particles in tile */
+               for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+                  x = ppart[idimp*(j+npoff)];
+                  y = ppart[1+idimp*(j+npoff)];
+                  nn = x;
+                  mm = y;
+                  dxp = qm*(x - (float) nn);
+                  dyp = y - (float) mm;
+                  nn = nn - noff + mxv*(mm - moff);
+                  amx = qm - dxp;
+                  amy = 1.0f - dyp;
+/* deposit charge within tile to local accumulator */
+                  x = sq[nn] + amx*amy;
+                  y = sq[nn+1] + dxp*amy;
+                  sq[nn] = x;
+                  sq[nn+1] = y;
+                  nn += mxv;
+                  x = sq[nn] + amx*dyp;
+                  y = sq[nn+1] + dxp*dyp;
+                  sq[nn] = x;
+                  sq[nn+1] = y;
+               }
+/* deposit charge to interior points in global array */
+               nn = nxv - noff;
+               mm = nyv - moff;
+               nn = mx < nn ? mx : nn;
+               mm = my < mm ? my : mm;
+               for (j = 1; j < mm; j++) {
+                  for (i = 1; i < nn; i++) {
+                     q[i+noff+nxv*(j+moff)] += sq[i+mxv*j];
+                  }
+               }
+/* deposit charge to edge points in global array */
+               mm = nyv - moff;
+               mm = my+1 < mm ? my+1 : mm;
+               for (i = 1; i < nn; i++) {
+#pragma omp atomic
+                  q[i+noff+nxv*moff] += sq[i];
+                  if (mm > my) {
+#pragma omp atomic
+                     q[i+noff+nxv*(mm+moff-1)] += sq[i+mxv*(mm-1)];
+                  }
+               }
+               nn = nxv - noff;
+               nn = mx+1 < nn ? mx+1 : nn;
+               for (j = 0; j < mm; j++) {
+#pragma omp atomic
+                  q[noff+nxv*(j+moff)] += sq[mxv*j];
+                  if (nn > mx) {
+#pragma omp atomic
+                     q[nn+noff-1+nxv*(j+moff)] += sq[nn-1+mxv*j];
+                  }
+               }
+            }
+         }
+      }
+   }
+   if (ierr > 0)
+      *irc = ierr;
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppmovin2lt(float part[], float ppart[], int kpic[], int nppmx,
+                 int idimp, int nop, int mx, int my, int mx1, int mxy1,
+                 int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   and copies to segmented array ppart
+   linear interpolation
+   input: all except ppart, kpic, output: ppart, kpic
+   part/ppart = input/output particle arrays
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k
+   kpic = output number of particles per tile
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   nop = number of particles
+   mx/my = number of grids in sorting cell in x and y
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int i, j, k, n, m, ip, ierr;
+   ierr = 0;
+/* clear counter array */
+   for (k = 0; k < mxy1; k++) {
+      kpic[k] = 0;
+   }
+/* find addresses of particles at each tile and reorder particles */
+   for (j = 0; j < nop; j++) {
+      n = part[idimp*j];
+      m = part[1+idimp*j];
+      n = n/mx;
+      m = m/my;
+      m = n + mx1*m;
+      ip = kpic[m];
+      if (ip < nppmx) {
+         for (i = 0; i < idimp; i++) {
+            ppart[ip+nppmx*(i+idimp*m)] = part[i+idimp*j];
+         }
+      }
+      else {
+         ierr = ierr > ip-nppmx+1 ? ierr : ip-nppmx+1;
+      }
+      kpic[m] = ip + 1;
+   }
+   if (ierr > 0)
+      *irc = ierr;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcheck2lt(float ppart[], int kpic[], int idimp, int nppmx, int nx,
+                 int ny, int mx, int my, int mx1, int my1, 
+                 int *irc) {
+/* this subroutine performs a sanity check to make sure particles sorted
+   by x,y grid in tiles of mx, my, are all within bounds.
+   tiles are assumed to be arranged in 2D linear memory, and transposed
+   input: all except irc
+   output: irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k
+   kpic[k] = number of reordered output particles in tile k
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   irc = particle error, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxy1, noff, moff, npp, j, k, ist, nn, mm;
+   float edgelx, edgely, edgerx, edgery, dx, dy;
+   mxy1 = mx1*my1;
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,noff,moff,npp,nn,mm,ist,edgelx,edgely,edgerx,edgery,dx,dy)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+         dx = ppart[j+nppmx*(idimp*k)];
+         dy = ppart[j+nppmx*(1+idimp*k)];
+/* find particles going out of bounds */
+         ist = 0;
+         if (dx < edgelx)
+            ist = 1;
+         if (dx >= edgerx)
+            ist = 2;
+         if (dy < edgely)
+            ist += 3;
+         if (dy >= edgery)
+            ist += 6;
+         if (ist > 0)
+            *irc = k + 1;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppush2lt(float ppart[], float fxy[], int kpic[], float qbm,
+                 float dt, float *ek, int idimp, int nppmx, int nx,
+                 int ny, int mx, int my, int nxv, int nyv, int mx1,
+                 int mxy1, int ipbc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with various boundary conditions.
+   vectorizable/OpenMP version using guard cells
+   data read in tiles
+   particles stored segmented array
+   44 flops/particle, 12 loads, 4 stores
+   input: all, output: ppart, ek
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   fy(x,y) = (1-dy)*((1-dx)*fy(n,m)+dx*fy(n+1,m)) + dy*((1-dx)*fy(n,m+1)
+      + dx*fy(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   ppart[m][2][n] = velocity vx of particle n in tile m
+   ppart[m][3][n] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic = number of particles per tile
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+local data                                                            */
+#define NPBLK             32
+#define LVECT             4
+   int noff, moff, npoff, npp, ipp, joff, nps;
+   int i, j, k, m, nn, mm, lxv;
+   float qtm, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+/* scratch arrays */
+   int n[NPBLK];
+   float s[NPBLK*LVECT], t[NPBLK*2];
+   double sum1, sum2;
+   lxv = mx + 1;
+   qtm = qbm*dt;
+   sum2 = 0.0;
+/* set boundary values */
+   edgelx = 0.0f;
+   edgely = 0.0f;
+   edgerx = (float) nx;
+   edgery = (float) ny;
+   if (ipbc==2) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0f;
+      edgerx = (float) (nx-1);
+   }
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cvgppush2lt error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,m,noff,moff,npp,npoff,ipp,joff,nps,nn,mm,x,y,dxp,dyp, \
+amx,amy,dx,dy,vx,vy,sum1,n,s,t) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+1)*(my+1)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+/* load local fields from global array */
+      nn = (mx < nx-noff ? mx : nx-noff) + 1;
+      mm = (my < ny-moff ? my : ny-moff) + 1;
+      for (j = 0; j < mm; j++) {
+         for (i = 0; i < nn; i++) {
+            sfxy[2*(i+lxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];
+            sfxy[1+2*(i+lxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))];
+         }
+      }
+      sum1 = 0.0;
+/* loop over particles in tile */
+      ipp = npp/NPBLK;
+/* outer loop over number of full blocks */
+      for (m = 0; m < ipp; m++) {
+         joff = NPBLK*m;
+/* inner loop over particles in block */
+         for (j = 0; j < NPBLK; j++) {
+/* find interpolation weights */
+            x = ppart[j+joff+npoff];
+            y = ppart[j+joff+nppmx+npoff];
+            nn = x;
+            mm = y;
+            dxp = x - (float) nn;
+            dyp = y - (float) mm;
+            n[j] = nn - noff + lxv*(mm - moff);
+            amx = 1.0f - dxp;
+            amy = 1.0f - dyp;
+            s[j] = amx*amy;
+            s[j+NPBLK] = dxp*amy;
+            s[j+2*NPBLK] = amx*dyp;
+            s[j+3*NPBLK] = dxp*dyp;
+            t[j] = x;
+            t[j+NPBLK] = y;
+         }
+/* find acceleration */
+         for (j = 0; j < NPBLK; j++) {
+            nn = n[j];
+            mm = nn + lxv - 2;
+            dx = 0.0f;
+            dy = 0.0f;
+            for (i = 0; i < LVECT; i++) {
+               if (i > 1)
+                  nn = mm;
+               dx += sfxy[2*(i+nn)]*s[j+NPBLK*i];
+               dy += sfxy[1+2*(i+nn)]*s[j+NPBLK*i];
+            }
+            s[j] = dx;
+            s[j+NPBLK] = dy;
+         }
+/* new velocity */
+         for (j = 0; j < NPBLK; j++) {
+            x = t[j];
+            y = t[j+NPBLK];
+            dxp = ppart[j+joff+2*nppmx+npoff];
+            dyp = ppart[j+joff+3*nppmx+npoff];
+            vx = dxp + qtm*s[j];
+            vy = dyp + qtm*s[j+NPBLK];
+/* average kinetic energy */
+            dxp += vx;
+            dyp += vy;
+            sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+            s[j] = x + vx*dt;
+            s[j+NPBLK] = y + vy*dt;
+            s[j+2*NPBLK] = vx;
+            s[j+3*NPBLK] = vy;
+         }
+/* check boundary conditions */
+         for (j = 0; j < NPBLK; j++) {
+            dx = s[j];
+            dy = s[j+NPBLK];
+            vx = s[j+2*NPBLK];
+            vy = s[j+3*NPBLK];
+/* reflecting boundary conditions */
+            if (ipbc==2) {
+               if ((dx < edgelx) || (dx >= edgerx)) {
+                  dx = t[j];
+                  vx = -vx;
+               }
+               if ((dy < edgely) || (dy >= edgery)) {
+                  dy = t[j+NPBLK];
+                  vy = -vy;
+               }
+            }
+/* mixed reflecting/periodic boundary conditions */
+            else if (ipbc==3) {
+               if ((dx < edgelx) || (dx >= edgerx)) {
+                  dx = t[j];
+                  vx = -vx;
+               }
+            }
+/* set new position */
+            ppart[j+joff+npoff] = dx;
+            ppart[j+joff+nppmx+npoff] = dy;
+/* set new velocity */
+            ppart[j+joff+2*nppmx+npoff] = vx;
+            ppart[j+joff+3*nppmx+npoff] = vy;
+         }
+      }
+      nps = NPBLK*ipp;
+/* loop over remaining particles */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         nn = 2*(nn - noff + lxv*(mm - moff));
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+/* find acceleration */
+         dx = amx*sfxy[nn];
+         dy = amx*sfxy[nn+1];
+         dx = amy*(dxp*sfxy[nn+2] + dx);
+         dy = amy*(dxp*sfxy[nn+3] + dy);
+         nn += 2*lxv;
+         vx = amx*sfxy[nn];
+         vy = amx*sfxy[nn+1];
+         dx += dyp*(dxp*sfxy[nn+2] + vx);
+         dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+         dxp = ppart[j+2*nppmx+npoff];
+         dyp = ppart[j+3*nppmx+npoff];
+         vx = dxp + qtm*dx;
+         vy = dyp + qtm*dy;
+/* average kinetic energy */
+         dxp += vx;
+         dyp += vy;
+         sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* reflecting boundary conditions */
+         if (ipbc==2) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               vx = -vx;
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = y;
+               vy = -vy;
+            }
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               vx = -vx;
+            }
+         }
+/* set new position */
+         ppart[j+npoff] = dx;
+         ppart[j+nppmx+npoff] = dy;
+/* set new velocity */
+         ppart[j+2*nppmx+npoff] = vx;
+         ppart[j+3*nppmx+npoff] = vy;
+      }
+      sum2 += sum1;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef LVECT
+#undef NPBLK
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppushf2lt(float ppart[], float fxy[], int kpic[], int ncl[],
+                  int ihole[], float qbm, float dt, float *ek,
+                  int idimp, int nppmx, int nx, int ny, int mx, int my,
+                  int nxv, int nyv, int mx1, int mxy1, int ntmax,
+                  int *irc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with periodic boundary conditions.
+   also determines list of particles which are leaving this tile
+   vectorizable/OpenMP version using guard cells
+   data read in tiles
+   particles stored segmented array
+   44 flops/particle, 12 loads, 4 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   fy(x,y) = (1-dy)*((1-dx)*fy(n,m)+dx*fy(n+1,m)) + dy*((1-dx)*fy(n,m+1)
+      + dx*fy(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   ppart[m][2][n] = velocity vx of particle n in tile m
+   ppart[m][3][n] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM
+   optimized version
+local data                                                            */
+#define NPBLK             32
+#define LVECT             4
+   int noff, moff, npoff, npp, ipp, joff, nps;
+   int i, j, k, m, ih, nh, nn, mm, lxv;
+   float qtm, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+/* scratch arrays */
+   int n[NPBLK];
+   float s[NPBLK*LVECT], t[NPBLK*2];
+   double sum1, sum2;
+   lxv = mx + 1;
+   qtm = qbm*dt;
+   anx = (float) nx;
+   any = (float) ny;
+   sum2 = 0.0;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,m,noff,moff,npp,npoff,ipp,joff,nps,nn,mm,ih,nh,x,y,dxp, \
+dyp,amx,amy,dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1,n,s,t) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+1)*(my+1)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+/* load local fields from global array */
+      for (j = 0; j < mm; j++) {
+         for (i = 0; i < nn; i++) {
+            sfxy[2*(i+lxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];
+            sfxy[1+2*(i+lxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))];
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+      sum1 = 0.0;
+/* loop over particles in tile */
+      ipp = npp/NPBLK;
+/* outer loop over number of full blocks */
+      for (m = 0; m < ipp; m++) {
+         joff = NPBLK*m;
+/* inner loop over particles in block */
+         for (j = 0; j < NPBLK; j++) {
+/* find interpolation weights */
+            x = ppart[j+joff+npoff];
+            y = ppart[j+joff+nppmx+npoff];
+            nn = x;
+            mm = y;
+            dxp = x - (float) nn;
+            dyp = y - (float) mm;
+            n[j] = nn - noff + lxv*(mm - moff);
+            amx = 1.0f - dxp;
+            amy = 1.0f - dyp;
+            s[j] = amx*amy;
+            s[j+NPBLK] = dxp*amy;
+            s[j+2*NPBLK] = amx*dyp;
+            s[j+3*NPBLK] = dxp*dyp;
+            t[j] = x;
+            t[j+NPBLK] = y;
+         }
+/* find acceleration */
+         for (j = 0; j < NPBLK; j++) {
+            nn = n[j];
+            mm = nn + lxv - 2;
+            dx = 0.0f;
+            dy = 0.0f;
+            for (i = 0; i < LVECT; i++) {
+               if (i > 1)
+                  nn = mm;
+               dx += sfxy[2*(i+nn)]*s[j+NPBLK*i];
+               dy += sfxy[1+2*(i+nn)]*s[j+NPBLK*i];
+            }
+            s[j] = dx;
+            s[j+NPBLK] = dy;
+         }
+/* new velocity */
+         for (j = 0; j < NPBLK; j++) {
+            x = t[j];
+            y = t[j+NPBLK];
+            dxp = ppart[j+joff+2*nppmx+npoff];
+            dyp = ppart[j+joff+3*nppmx+npoff];
+            vx = dxp + qtm*s[j];
+            vy = dyp + qtm*s[j+NPBLK];
+/* average kinetic energy */
+            dxp += vx;
+            dyp += vy;
+            sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+            s[j] = x + vx*dt;
+            s[j+NPBLK] = y + vy*dt;
+            s[j+2*NPBLK] = vx;
+            s[j+3*NPBLK] = vy;
+         }
+/* check boundary conditions */
+         for (j = 0; j < NPBLK; j++) {
+            dx = s[j];
+            dy = s[j+NPBLK];
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx -= anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy -= any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+/* set new position */
+            ppart[j+joff+npoff] = dx;
+            ppart[j+joff+nppmx+npoff] = dy;
+/* set new velocity */
+            ppart[j+joff+2*nppmx+npoff] = s[j+2*NPBLK];
+            ppart[j+joff+3*nppmx+npoff] = s[j+3*NPBLK];
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+8*k-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*k)] = j + joff + 1;
+                  ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+      }
+      nps = NPBLK*ipp;
+/* loop over remaining particles */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         nn = 2*(nn - noff + lxv*(mm - moff));
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+/* find acceleration */
+         dx = amx*sfxy[nn];
+         dy = amx*sfxy[nn+1];
+         dx = amy*(dxp*sfxy[nn+2] + dx);
+         dy = amy*(dxp*sfxy[nn+3] + dy);
+         nn += 2*lxv;
+         vx = amx*sfxy[nn];
+         vy = amx*sfxy[nn+1];
+         dx += dyp*(dxp*sfxy[nn+2] + vx);
+         dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+         dxp = ppart[j+2*nppmx+npoff];
+         dyp = ppart[j+3*nppmx+npoff];
+         vx = dxp + qtm*dx;
+         vy = dyp + qtm*dy;
+/* average kinetic energy */
+         dxp += vx;
+         dyp += vy;
+         sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx -= anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0;
+            }
+            else {
+               mm = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy -= any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0;
+            }
+            else {
+               mm += 3;
+            }
+         }
+/* set new position */
+         ppart[j+npoff] = dx;
+         ppart[j+nppmx+npoff] = dy;
+/* set new velocity */
+         ppart[j+2*nppmx+npoff] = vx;
+         ppart[j+3*nppmx+npoff] = vy;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef LVECT
+#undef NPBLK
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppost2lt(float ppart[], float q[], int kpic[], float qm,
+                 int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                 int mx1, int mxy1) {
+/* for 2d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   vectorizable/OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   17 flops/particle, 6 loads, 4 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   q[k][j] = charge density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = first dimension of charge array, must be >= nx+1
+   nyv = second dimension of charge array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+local data                                                            */
+#define NPBLK             32
+#define LVECT             4
+   int noff, moff, npoff, npp, ipp, joff, nps;
+   int i, j, k, m, nn, mm, lxv;
+   float x, y, dxp, dyp, amx, amy;
+/* scratch arrays */
+   int n[NPBLK];
+   float s[NPBLK*LVECT];
+   lxv = mx + 1;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cvgppost2lt error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,m,noff,moff,npp,npoff,ipp,joff,nps,nn,mm,x,y,dxp,dyp, \
+amx,amy,n,s)
+   for (k = 0; k < mxy1; k++) {
+      float sq[(mx+1)*(my+1)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+/* zero out local accumulator */
+      for (j = 0; j < lxv*(my+1); j++) {
+         sq[j] = 0.0f;
+      }
+/* loop over particles in tile */
+      ipp = npp/NPBLK;
+/* outer loop over number of full blocks */
+      for (m = 0; m < ipp; m++) {
+         joff = NPBLK*m;
+/* inner loop over particles in block */
+         for (j = 0; j < NPBLK; j++) {
+/* find interpolation weights */
+            x = ppart[j+joff+npoff];
+            y = ppart[j+joff+nppmx+npoff];
+            nn = x;
+            mm = y;
+            dxp = qm*(x - (float) nn);
+            dyp = y - (float) mm;
+            n[j] = nn - noff + lxv*(mm - moff);
+            amx = qm - dxp;
+            amy = 1.0f - dyp;
+            s[j] = amx*amy;
+            s[j+NPBLK] = dxp*amy;
+            s[j+2*NPBLK] = amx*dyp;
+            s[j+3*NPBLK] = dxp*dyp;
+        }
+/* deposit charge within tile to local accumulator */
+         for (j = 0; j < NPBLK; j++) {
+            nn = n[j];
+            mm = nn + lxv - 2;
+            for (i = 0; i < LVECT; i++) {
+               if (i > 1)
+                  nn = mm;
+               sq[i+nn] += s[j+NPBLK*i];
+            }
+         }
+      }
+      nps = NPBLK*ipp;
+/* loop over remaining particles */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+         nn = nn - noff + lxv*(mm - moff);
+         amx = qm - dxp;
+         amy = 1.0f - dyp;
+/* deposit charge within tile to local accumulator */
+         x = sq[nn] + amx*amy;
+         y = sq[nn+1] + dxp*amy;
+         sq[nn] = x;
+         sq[nn+1] = y;
+         nn += lxv;
+         x = sq[nn] + amx*dyp;
+         y = sq[nn+1] + dxp*dyp;
+         sq[nn] = x;
+         sq[nn+1] = y;
+      }
+/* deposit charge to interior points in global array */
+      nn = nxv - noff;
+      mm = nyv - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+            q[i+noff+nxv*(j+moff)] += sq[i+lxv*j];
+         }
+      }
+/* deposit charge to edge points in global array */
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (i = 1; i < nn; i++) {
+#pragma omp atomic
+         q[i+noff+nxv*moff] += sq[i];
+         if (mm > my) {
+#pragma omp atomic
+            q[i+noff+nxv*(mm+moff-1)] += sq[i+lxv*(mm-1)];
+         }
+      }
+      nn = nxv - noff;
+      nn = mx+1 < nn ? mx+1 : nn;
+      for (j = 0; j < mm; j++) {
+#pragma omp atomic
+         q[noff+nxv*(j+moff)] += sq[lxv*j];
+         if (nn > mx) {
+#pragma omp atomic
+            q[nn+noff-1+nxv*(j+moff)] += sq[nn-1+lxv*j];
+         }
+      }
+   }
+   return;
+#undef LVECT
+#undef NPBLK
+}
+
+/*--------------------------------------------------------------------*/
+void cpporder2lt(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                 int ihole[], int idimp, int nppmx, int nx, int ny,
+                 int mx, int my, int mx1, int my1, int npbmx, int ntmax,
+                 int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   linear interpolation, with periodic boundary conditions
+   tiles are assumed to be arranged in 2D linear memory
+   algorithm has 3 steps.  first, one finds particles leaving tile and
+   stores their number in each directon, location, and destination in ncl
+   and ihole.  second, a prefix scan of ncl is performed and departing
+   particles are buffered in ppbuff in direction order.  finally, we copy
+   the incoming particles from other tiles into ppart.
+   input: all except ppbuff, ncl, ihole, irc
+   output: ppart, ppbuff, kpic, ncl, ihole, irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k 
+   ppbuff[k][i][n] = i co-ordinate of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   particles are not moved between tiles if an error occurs, so that
+   the reordering can be repeated with larger arrays
+local data                                                            */
+   int mxy1, noff, moff, npoff, npp, nboff, ncoff;
+   int i, j, k, ii, kx, ky, ih, nh, ist, nn, mm, isum;
+   int ip, j1, j2, kxl, kxr, kk, kl, kr;
+   float anx, any, edgelx, edgely, edgerx, edgery, dx, dy;
+   int ks[8];
+   mxy1 = mx1*my1;
+   anx = (float) nx;
+   any = (float) ny;
+/* find and count particles leaving tiles and determine destination */
+/* update ppart, ihole, ncl */
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,noff,moff,npp,npoff,nn,mm,ih,nh,ist,dx,dy,edgelx,edgely, \
+edgerx,edgery)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ih = 0;
+      nh = 0;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+         dx = ppart[j+npoff];
+         dy = ppart[j+nppmx+npoff];
+/* find particles going out of bounds */
+         ist = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* ist = direction particle is going                             */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               ppart[j+npoff] = dx - anx;
+            ist = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0) {
+               dx += anx;
+               if (dx < anx)
+                  ist = 1;
+               else
+                  dx = 0.0;
+               ppart[j+npoff] = dx;
+            }
+            else {
+               ist = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               ppart[j+nppmx+npoff] = dy - any;
+            ist += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  ist += 3;
+               else
+                  dy = 0.0;
+               ppart[j+nppmx+npoff] = dy;
+            }
+            else {
+               ist += 3;
+            }
+         }
+         if (ist > 0) {
+            ncl[ist+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = ist;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* ihole overflow */
+   if (*irc > 0)
+      return;
+
+/* buffer particles that are leaving tile: update ppbuff, ncl */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,npoff,nboff,isum,ist,nh,ip,j1,ii)
+   for (k = 0; k < mxy1; k++) {
+      npoff = idimp*nppmx*k;
+      nboff = idimp*npbmx*k;
+/* find address offset for ordered ppbuff array */
+      isum = 0;
+      for (j = 0; j < 8; j++) {
+         ist = ncl[j+8*k];
+         ncl[j+8*k] = isum;
+         isum += ist;
+      }
+      nh = ihole[2*(ntmax+1)*k];
+      ip = 0;
+/* loop over particles leaving tile */
+      for (j = 0; j < nh; j++) {
+/* buffer particles that are leaving tile, in direction order */
+         j1 = ihole[2*(j+1+(ntmax+1)*k)] - 1;
+         ist = ihole[1+2*(j+1+(ntmax+1)*k)];
+         ii = ncl[ist+8*k-1];
+         if (ii < npbmx) {
+            for (i = 0; i < idimp; i++) {
+               ppbuff[ii+npbmx*i+nboff]
+               = ppart[j1+nppmx*i+npoff];
+            }
+         }
+         else {
+            ip = 1;
+         }
+         ncl[ist+8*k-1] = ii + 1;
+      }
+/* set error */
+      if (ip > 0)
+         *irc = ncl[7+8*k];
+   }
+/* ppbuff overflow */
+   if (*irc > 0)
+      return;
+
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp parallel for \
+private(k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ncoff,ks)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+      npp = kpic[k] - ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+         npp += ncl[ii+8*ks[ii]] - ncoff;
+      }
+/* set error */
+      if (npp > nppmx)
+         *irc = npp;
+   }
+/* ppart overflow */
+   if (*irc > 0)
+      return;
+
+/* copy incoming particles from buffer into ppart: update ppart, kpic */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,ii,kk,npp,npoff,nboff,kx,ky,kl,kr,kxl,kxr,ih,nh,nn, \
+ncoff,ist,j1,j2,ip,ks)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* loop over directions */
+      nh = ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      ih = 0;
+      ist = 0;
+      j1 = 0;
+      for (ii = 0; ii < 8; ii++) {
+         nboff = idimp*npbmx*ks[ii];
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+/* ip = number of particles coming from direction ii */
+         ip = ncl[ii+8*ks[ii]] - ncoff;
+         for (j = 0; j < ip; j++) {
+            ih += 1;
+/* insert incoming particles into holes */
+            if (ih <= nh) {
+               j1 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+/* place overflow at end of array */
+            else {
+               j1 = npp;
+               npp += 1;
+            }
+            if (j1 < nppmx) {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j1+nppmx*i+npoff]
+                  = ppbuff[j+ncoff+npbmx*i+nboff];
+                }
+            }
+            else {
+               ist = 1;
+            }
+         }
+      }
+/* set error */
+      if (ist > 0)
+         *irc = j1+1;
+/* fill up remaining holes in particle array with particles from bottom */
+/* holes with locations great than npp-ip do not need to be filled      */
+      if (ih < nh) {
+         ip = nh - ih;
+         ii = nh;
+         nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+         ih += 1;
+         j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+/* move particles from end into remaining holes */
+/* holes are processed in increasing order      */
+         for (j = 0; j < ip; j++) {
+            j1 = npp - j - 1;
+            if (j1==nn) {
+               ii -= 1;
+               nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+            }
+            else {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j2+nppmx*i+npoff]
+                  = ppart[j1+nppmx*i+npoff];
+               }
+               ih += 1;
+               j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+         }
+         npp -= ip;
+      }
+      kpic[k] = npp;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpporderf2lt(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                  int ihole[], int idimp, int nppmx, int mx1, int my1,
+                  int npbmx, int ntmax, int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   linear interpolation, with periodic boundary conditions
+   tiles are assumed to be arranged in 2D linear memory
+   the algorithm has 2 steps.  first, a prefix scan of ncl is performed
+   and departing particles are buffered in ppbuff in direction order.
+   then we copy the incoming particles from other tiles into ppart.
+   it assumes that the number, location, and destination of particles 
+   leaving a tile have been previously stored in ncl and ihole by the
+   cgppushf2lt procedure.
+   input: all except ppbuff, irc
+   output: ppart, ppbuff, kpic, ncl, irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k 
+   ppbuff[k][i][n] = i co-ordinate of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   particles are not moved between tiles if an error occurs, so that
+   the reordering can be repeated with larger arrays
+local data                                                            */
+   int mxy1, npoff, npp, nboff, ncoff;
+   int i, j, k, ii, kx, ky, ih, nh, ist, nn, isum;
+   int ip, j1, j2, kxl, kxr, kk, kl, kr;
+   int ks[8];
+   mxy1 = mx1*my1;
+/* buffer particles that are leaving tile: update ppbuff, ncl */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,npoff,nboff,isum,ist,nh,ip,j1,ii)
+   for (k = 0; k < mxy1; k++) {
+      npoff = idimp*nppmx*k;
+      nboff = idimp*npbmx*k;
+/* find address offset for ordered ppbuff array */
+      isum = 0;
+      for (j = 0; j < 8; j++) {
+         ist = ncl[j+8*k];
+         ncl[j+8*k] = isum;
+         isum += ist;
+      }
+      nh = ihole[2*(ntmax+1)*k];
+      ip = 0;
+/* loop over particles leaving tile */
+      for (j = 0; j < nh; j++) {
+/* buffer particles that are leaving tile, in direction order */
+         j1 = ihole[2*(j+1+(ntmax+1)*k)] - 1;
+         ist = ihole[1+2*(j+1+(ntmax+1)*k)];
+         ii = ncl[ist+8*k-1];
+         if (ii < npbmx) {
+            for (i = 0; i < idimp; i++) {
+               ppbuff[ii+npbmx*i+nboff]
+               = ppart[j1+nppmx*i+npoff];
+            }
+         }
+         else {
+            ip = 1;
+         }
+         ncl[ist+8*k-1] = ii + 1;
+      }
+/* set error */
+      if (ip > 0)
+         *irc = ncl[7+8*k];
+   }
+/* ppbuff overflow */
+   if (*irc > 0)
+      return;
+
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp parallel for \
+private(k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ncoff,ks)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+      npp = kpic[k] - ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+         npp += ncl[ii+8*ks[ii]] - ncoff;
+      }
+/* set error */
+      if (npp > nppmx)
+         *irc = npp;
+   }
+/* ppart overflow */
+   if (*irc > 0)
+      return;
+
+/* copy incoming particles from buffer into ppart: update ppart, kpic */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,ii,kk,npp,npoff,nboff,kx,ky,kl,kr,kxl,kxr,ih,nh,nn, \
+ncoff,ist,j1,j2,ip,ks)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* loop over directions */
+      nh = ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      ih = 0;
+      ist = 0;
+      j1 = 0;
+      for (ii = 0; ii < 8; ii++) {
+         nboff = idimp*npbmx*ks[ii];
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+/* ip = number of particles coming from direction ii */
+         ip = ncl[ii+8*ks[ii]] - ncoff;
+         for (j = 0; j < ip; j++) {
+            ih += 1;
+/* insert incoming particles into holes */
+            if (ih <= nh) {
+               j1 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+/* place overflow at end of array */
+            else {
+               j1 = npp;
+               npp += 1;
+            }
+            if (j1 < nppmx) {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j1+nppmx*i+npoff]
+                  = ppbuff[j+ncoff+npbmx*i+nboff];
+                }
+            }
+            else {
+               ist = 1;
+            }
+         }
+      }
+/* set error */
+      if (ist > 0)
+         *irc = j1+1;
+/* fill up remaining holes in particle array with particles from bottom */
+/* holes with locations great than npp-ip do not need to be filled      */
+      if (ih < nh) {
+         ip = nh - ih;
+         ii = nh;
+         nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+         ih += 1;
+         j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+/* move particles from end into remaining holes */
+/* holes are processed in increasing order      */
+         for (j = 0; j < ip; j++) {
+            j1 = npp - j - 1;
+            if (j1==nn) {
+               ii -= 1;
+               nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+            }
+            else {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j2+nppmx*i+npoff]
+                  = ppart[j1+nppmx*i+npoff];
+               }
+               ih += 1;
+               j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+         }
+         npp -= ip;
+      }
+      kpic[k] = npp;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2l(float ppart[], int kpic[], int ncl[], int ihole[],
+                int idimp, int nppmx, int mx, int my, int mx1, int my1,
+                int ntmax, int *irc) {
+/* this subroutine finds particles leaving tiles, and stores their
+   number in each direction, location, and destination in ncl and
+   ihole, for particles whose co-ordinates have already been updated
+   with periodic boundary conditions, as in cgppushf2l.  used to
+   recreate the list for cpporderf2l after ihole, ppbuff or ppart
+   arrays have been enlarged following an overflow
+   input: all except ncl, ihole, irc, output: ncl, ihole, irc
+   ppart[k][n][0] = position x of particle n in tile k
+   ppart[k][n][1] = position y of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxy1, npp, npoff;
+   int j, k, kx, ky, kxr, kyr, nn, mm, ih, nh, ist;
+   mxy1 = mx1*my1;
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,kx,ky,kxr,kyr,npp,npoff,nn,mm,ih,nh,ist)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+      kx = k - mx1*ky;
+/* find neighboring tiles, assume periodic boundary conditions */
+      kxr = kx < mx1 - 1 ? kx + 1 : 0;
+      kyr = ky < my1 - 1 ? ky + 1 : 0;
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ih = 0;
+      nh = 0;
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find tile particle is now in */
+         nn = ppart[idimp*j+npoff];
+         mm = ppart[1+idimp*j+npoff];
+         nn = nn/mx;
+         mm = mm/my;
+/* ist = direction particle is going */
+         ist = 0;
+         if (nn != kx) {
+            if (nn==kxr)
+               ist = 2;
+            else
+               ist = 1;
+         }
+         if (mm != ky) {
+            if (mm==kyr)
+               ist += 6;
+            else
+               ist += 3;
+         }
+         if (ist > 0) {
+            ncl[ist+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = ist;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2lt(float ppart[], int kpic[], int ncl[], int ihole[],
+                 int idimp, int nppmx, int mx, int my, int mx1, int my1,
+                 int ntmax, int *irc) {
+/* this subroutine finds particles leaving tiles, and stores their
+   number in each direction, location, and destination in ncl and
+   ihole, for particles whose co-ordinates have already been updated
+   with periodic boundary conditions, as in cvgppushf2lt.  used to
+   recreate the list for cpporderf2lt after ihole, ppbuff or ppart
+   arrays have been enlarged following an overflow
+   input: all except ncl, ihole, irc, output: ncl, ihole, irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxy1, npp, npoff;
+   int j, k, kx, ky, kxr, kyr, nn, mm, ih, nh, ist;
+   mxy1 = mx1*my1;
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,kx,ky,kxr,kyr,npp,npoff,nn,mm,ih,nh,ist)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+      kx = k - mx1*ky;
+/* find neighboring tiles, assume periodic boundary conditions */
+      kxr = kx < mx1 - 1 ? kx + 1 : 0;
+      kyr = ky < my1 - 1 ? ky + 1 : 0;
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ih = 0;
+      nh = 0;
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find tile particle is now in */
+         nn = ppart[j+npoff];
+         mm = ppart[j+nppmx+npoff];
+         nn = nn/mx;
+         mm = mm/my;
+/* ist = direction particle is going */
+         ist = 0;
+         if (nn != kx) {
+            if (nn==kxr)
+               ist = 2;
+            else
+               ist = 1;
+         }
+         if (mm != ky) {
+            if (mm==kyr)
+               ist += 6;
+            else
+               ist += 3;
+         }
+         if (ist > 0) {
+            ncl[ist+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = ist;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcopy2l(float ppart[], float ppart1[], int kpic[], int idimp,
+               int nppmx, int nppmx1, int mxy1) {
+/* this subroutine copies segmented particle array ppart to ppart1,
+   which may have a different maximum number of particles in tile,
+   used to resize the particle array
+   input: all except ppart1, output: ppart1
+   ppart[k][n][i] = i co-ordinate of particle n in tile k
+   ppart1[k][n][i] = i co-ordinate of particle n in tile k
+   kpic = number of particles per tile
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile in ppart
+   nppmx1 = maximum number of particles in tile in ppart1,
+   must be >= kpic
+   mxy1 = total number of tiles
+local data                                                            */
+   int i, j, k, npp, npoff, npoff1;
+/* loop over tiles */
+#pragma omp parallel for private(i,j,k,npp,npoff,npoff1)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      npoff1 = idimp*nppmx1*k;
+      for (j = 0; j < npp; j++) {
+         for (i = 0; i < idimp; i++) {
+            ppart1[i+idimp*j+npoff1] = ppart[i+idimp*j+npoff];
+         }
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcopy2lt(float ppart[], float ppart1[], int kpic[], int idimp,
+                int nppmx, int nppmx1, int mxy1) {
+/* this subroutine copies segmented particle array ppart to ppart1,
+   which may have a different maximum number of particles in tile,
+   used to resize the particle array, structure of arrays layout
+   input: all except ppart1, output: ppart1
+   ppart[k][i][n] = i co-ordinate of particle n in tile k
+   ppart1[k][i][n] = i co-ordinate of particle n in tile k
+   kpic = number of particles per tile
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile in ppart
+   nppmx1 = maximum number of particles in tile in ppart1,
+   must be >= kpic
+   mxy1 = total number of tiles
+local data                                                            */
+   int i, j, k, npp, npoff, npoff1;
+/* loop over tiles */
+#pragma omp parallel for private(i,j,k,npp,npoff,npoff1)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      npoff1 = idimp*nppmx1*k;
+      for (i = 0; i < idimp; i++) {
+         for (j = 0; j < npp; j++) {
+            ppart1[j+nppmx1*i+npoff1] = ppart[j+nppmx*i+npoff];
+         }
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppstat2l(int kpic[], int ihole[], int ntmax, int mxy1, int *nmove,
+               int *nhmax, float *imbal) {
+/* this subroutine calculates particle management statistics from the
+   last reordering of the segmented particle array, for diagnostics
+   input: all except nmove, nhmax, imbal, output: nmove, nhmax, imbal
+   kpic = number of particles per tile
+   ihole[k][0][0] = number of particles which left tile k
+   ntmax = size of hole array for particles leaving tiles
+   mxy1 = total number of tiles
+   nmove = total number of particles which changed tiles
+   nhmax = maximum number of particles leaving a tile, must be <= ntmax
+   imbal = load imbalance, maximum/average number of particles per tile
+local data                                                            */
+   int k, ih, npp, nppmx, nmv, nhx;
+   double npt;
+   nmv = 0;
+   nhx = 0;
+   nppmx = 0;
+   npt = 0.0;
+   for (k = 0; k < mxy1; k++) {
+      ih = ihole[2*(ntmax+1)*k];
+      ih = ih > 0 ? ih : -ih;
+      nmv += ih;
+      nhx = ih > nhx ? ih : nhx;
+      npp = kpic[k];
+      nppmx = npp > nppmx ? npp : nppmx;
+      npt += (double) npp;
+   }
+   *nmove = nmv;
+   *nhmax = nhx;
+   *imbal = npt > 0.0 ? (float) (((double) (nppmx*mxy1))/npt) : 0.0;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpptune2l(float part[], float fxy[], float qbm, float dt,
+               float qm, float *xtras, int idimp, int nop, int nx,
+               int ny, int nxv, int nyv, int ntune, int *mx, int *my,
+               int *irc) {
+/* this subroutine finds the tile size mx, my which gives the fastest
+   particle push, reordering and charge deposit.  for each candidate
+   tile size, particles are copied to a trial segmented array and
+   ntune time steps of cgppushf2l, cpporderf2l and cgppost2l are timed.
+   the largest fraction of particles leaving any tile in one time step
+   is also found, and xtras is increased if needed, so that
+   nppmx, ntmax and npbmx can be sized to match the chosen tile
+   linear interpolation
+   input: all except mx, my, irc, output: mx, my, xtras, irc
+   part = input particle array, not modified
+   part[n][0] = position x of particle n
+   part[n][1] = position y of particle n
+   fxy = force/charge at grid points used for trial push
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   qm = charge on particle, in units of e
+   xtras = fraction of extra particles needed for particle management
+   on input, minimum value, on output, value needed for chosen tile
+   idimp = size of phase space = 4
+   nop = number of particles
+   nx/ny = system length in x/y direction
+   nxv = first dimension of field arrays, must be >= nx+1
+   nyv = second dimension of field arrays, must be >= ny+1
+   ntune = number of time steps timed for each tile size
+   mx/my = output number of grids in sorting cell in x and y
+   irc = error, returned only if no tile size could be used
+local data                                                            */
+#define NTILES          7
+   int mxc[NTILES] = {8,16,16,32,32,64,64};
+   int myc[NTILES] = {8,8,16,16,32,32,64};
+   int i, j, k, l, kx, ky, mx1, my1, mxy1, nppmx, nppmx0, ntmax, npbmx;
+   int nh, ierr;
+   float ek, xt, fl, flmax, tbest;
+   float *ppart = NULL, *ppbuff = NULL, *q = NULL;
+   int *kpic = NULL, *ncl = NULL, *ihole = NULL;
+   double ttune, dtime;
+   struct timeval itime;
+   kx = *mx;
+   ky = *my;
+   tbest = -1.0;
+   xt = *xtras;
+   q = (float *) malloc(nxv*nyv*sizeof(float));
+/* loop over candidate tile sizes */
+   for (l = 0; l < NTILES; l++) {
+      if ((mxc[l] > nx) || (myc[l] > ny))
+         continue;
+      mx1 = (nx - 1)/mxc[l] + 1;
+      my1 = (ny - 1)/myc[l] + 1;
+      mxy1 = mx1*my1;
+      ierr = 0;
+      kpic = (int *) malloc(mxy1*sizeof(int));
+      cdblkp2l(part,kpic,&nppmx,idimp,nop,mxc[l],myc[l],mx1,mxy1,&ierr);
+      nppmx0 = (1.0 + *xtras)*nppmx;
+      ntmax = *xtras*nppmx;
+      npbmx = *xtras*nppmx;
+      ppart = (float *) malloc(idimp*nppmx0*mxy1*sizeof(float));
+      ppbuff = (float *) malloc(idimp*npbmx*mxy1*sizeof(float));
+      ncl = (int *) malloc(8*mxy1*sizeof(int));
+      ihole = (int *) malloc(2*(ntmax+1)*mxy1*sizeof(int));
+      if (ierr==0)
+         cppmovin2l(part,ppart,kpic,nppmx0,idimp,nop,mxc[l],myc[l],mx1,
+                    mxy1,&ierr);
+      flmax = 0.0;
+      ttune = 0.0;
+/* time trial steps */
+      for (i = 0; i < ntune; i++) {
+         if (ierr != 0)
+            break;
+         ek = 0.0;
+         dtimer(&dtime,&itime,-1);
+         cgppushf2l(ppart,fxy,kpic,ncl,ihole,qbm,dt,&ek,idimp,nppmx0,
+                    nx,ny,mxc[l],myc[l],nxv,nyv,mx1,mxy1,ntmax,&ierr);
+         dtimer(&dtime,&itime,1);
+         ttune += dtime;
+         if (ierr != 0)
+            break;
+/* find largest fraction of particles leaving a tile */
+         for (k = 0; k < mxy1; k++) {
+            nh = ihole[2*(ntmax+1)*k];
+            fl = (float) nh/(float) nppmx;
+            flmax = fl > flmax ? fl : flmax;
+         }
+         dtimer(&dtime,&itime,-1);
+         cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,my1,
+                     npbmx,ntmax,&ierr);
+         for (j = 0; j < nxv*nyv; j++) {
+            q[j] = 0.0f;
+         }
+         cgppost2l(ppart,q,kpic,qm,nppmx0,idimp,mxc[l],myc[l],nxv,nyv,
+                   mx1,mxy1);
+         dtimer(&dtime,&itime,1);
+         ttune += dtime;
+      }
+      free(ihole);
+      free(ncl);
+      free(ppbuff);
+      free(ppart);
+      free(kpic);
+/* tiles which overflow are not used */
+      if (ierr != 0)
+         continue;
+      if ((tbest < 0.0) || (ttune < tbest)) {
+         tbest = ttune;
+         kx = mxc[l];
+         ky = myc[l];
+/* allow twice the largest fraction seen in trial */
+         xt = 2.0*flmax;
+         xt = xt > *xtras ? xt : *xtras;
+      }
+   }
+   free(q);
+   if (tbest < 0.0) {
+      *irc = 1;
+      return;
+   }
+   *mx = kx;
+   *my = ky;
+   *xtras = xt;
+   return;
+#undef NTILES
+}
+
+/*--------------------------------------------------------------------*/
+void cppmovin2lr(float part[], float ppart[], int kpic[], int nppmx,
+                 int idimp, int nop, int mx, int my, int mx1, int mxy1,
+                 int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   and copies to segmented array ppart, with positions stored relative
+   to the lower left corner of each tile, so that positions far from
+   the origin keep the full precision of a float
+   linear interpolation
+   input: all except ppart, kpic, output: ppart, kpic
+   part/ppart = input/output particle arrays
+   part[n][0] = position x of particle n in partition
+   part[n][1] = position y of particle n in partition
+   ppart[m][n][0] = position x of particle n in tile m, relative to tile
+   ppart[m][n][1] = position y of particle n in tile m, relative to tile
+   ppart[m][n][2] = velocity vx of particle n in tile m
+   ppart[m][n][3] = velocity vy of particle n in tile m
+   kpic = output number of particles per tile
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   nop = number of particles
+   mx/my = number of grids in sorting cell in x and y
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int i, j, k, n, m, ip, ierr;
+   ierr = 0;
+/* clear counter array */
+   for (k = 0; k < mxy1; k++) {
+      kpic[k] = 0;
+   }
+/* find addresses of particles at each tile and reorder particles */
+   for (j = 0; j < nop; j++) {
+      n = part[idimp*j];
+      m = part[1+idimp*j];
+      n = n/mx;
+      m = m/my;
+      k = n + mx1*m;
+      ip = kpic[k];
+      if (ip < nppmx) {
+         ppart[idimp*(ip+nppmx*k)] = part[idimp*j] - (float) (mx*n);
+         ppart[1+idimp*(ip+nppmx*k)] = part[1+idimp*j] - (float) (my*m);
+         for (i = 2; i < idimp; i++) {
+            ppart[i+idimp*(ip+nppmx*k)] = part[i+idimp*j];
+         }
+      }
+      else {
+         ierr = ierr > ip-nppmx+1 ? ierr : ip-nppmx+1;
+      }
+      kpic[k] = ip + 1;
+   }
+   if (ierr > 0)
+      *irc = ierr;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcheck2lr(float ppart[], int kpic[], int idimp, int nppmx,
+                 int nx, int ny, int mx, int my, int mx1, int my1, 
+                 int *irc) {
+/* this subroutine performs a sanity check to make sure particles sorted
+   by x,y grid in tiles of mx, my, with positions relative to the tile,
+   are all within bounds.
+   tiles are assumed to be arranged in 2D linear memory
+   input: all except irc
+   output: irc
+   ppart[k][n][0] = position x of particle n in tile k, relative to tile
+   ppart[k][n][1] = position y of particle n in tile k, relative to tile
+   kpic[k] = number of reordered output particles in tile k
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   irc = particle error, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxy1, noff, moff, npp, j, k, ist, nn, mm;
+   float edgerx, edgery, dx, dy;
+   mxy1 = mx1*my1;
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,noff,moff,npp,nn,mm,ist,edgerx,edgery,dx,dy)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgerx = nn;
+      edgery = mm;
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+         dx = ppart[idimp*(j+nppmx*k)];
+         dy = ppart[1+idimp*(j+nppmx*k)];
+/* find particles going out of bounds */
+         ist = 0;
+         if (dx < 0.0f)
+            ist = 1;
+         if (dx >= edgerx)
+            ist = 2;
+         if (dy < 0.0f)
+            ist += 3;
+         if (dy >= edgery)
+            ist += 6;
+         if (ist > 0)
+            *irc = k + 1;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppushf2lr(float ppart[], float fxy[], int kpic[], int ncl[],
+                 int ihole[], float qbm, float dt, float *ek, int idimp,
+                 int nppmx, int nx, int ny, int mx, int my, int nxv,
+                 int nyv, int mx1, int mxy1, int ntmax, int *irc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with periodic boundary conditions.
+   also determines list of particles which are leaving this tile
+   positions are stored relative to the lower left corner of the tile,
+   and particles leaving the tile keep positions relative to this tile
+   until cpporderf2lr moves them.  kinetic energy is summed in double
+   precision
+   OpenMP version using guard cells
+   data read in tiles
+   particles stored segmented array
+   44 flops/particle, 12 loads, 4 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   fy(x,y) = (1-dy)*((1-dx)*fy(n,m)+dx*fy(n+1,m)) + dy*((1-dx)*fy(n,m+1)
+      + dx*fy(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][n][0] = position x of particle n in tile m, relative to tile
+   ppart[m][n][1] = position y of particle n in tile m, relative to tile
+   ppart[m][n][2] = velocity vx of particle n in tile m
+   ppart[m][n][3] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM
+local data                                                            */
+   int noff, moff, npoff, npp, my1;
+   int i, j, k, ih, nh, nn, mm, mxv;
+   float qtm, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+   float edgelx, edgely, edgerx, edgery;
+   double sum1, sum2;
+   mxv = mx + 1;
+   my1 = mxy1/mx1;
+   qtm = qbm*dt;
+   sum2 = 0.0;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy, \
+dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+1)*(my+1)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+/* edgerx/edgery = size of this tile */
+/* edgelx/edgely = size of tile to the left/below */
+      edgerx = nn;
+      edgery = mm;
+      edgelx = noff > 0 ? mx : nx - mx*(mx1 - 1);
+      edgely = moff > 0 ? my : ny - my*(my1 - 1);
+      ih = 0;
+      nh = 0;
+      nn += 1;
+      mm += 1;
+/* load local fields from global array */
+      for (j = 0; j < mm; j++) {
+         for (i = 0; i < nn; i++) {
+            sfxy[2*(i+mxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];
+            sfxy[1+2*(i+mxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))];
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+      sum1 = 0.0;
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         nn = 2*nn + 2*mxv*mm;
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+/* find acceleration */
+         dx = amx*sfxy[nn];
+         dy = amx*sfxy[nn+1];
+         dx = amy*(dxp*sfxy[nn+2] + dx);
+         dy = amy*(dxp*sfxy[nn+3] + dy);
+         nn += 2*mxv;
+         vx = amx*sfxy[nn];
+         vy = amx*sfxy[nn+1];
+         dx += dyp*(dxp*sfxy[nn+2] + vx);
+         dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+         vx = ppart[2+idimp*(j+npoff)];
+         vy = ppart[3+idimp*(j+npoff)];
+         dx = vx + qtm*dx;
+         dy = vy + qtm*dy;
+/* average kinetic energy */
+         vx += dx;
+         vy += dy;
+         sum1 += (double) vx*vx + (double) vy*vy;
+         ppart[2+idimp*(j+npoff)] = dx;
+         ppart[3+idimp*(j+npoff)] = dy;
+/* new position */
+         dx = x + dx*dt;
+         dy = y + dy*dt;
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* check for roundoff error when particle is moved to tile on    */
+/* the left or below, as the position there would be the edge    */
+/* mm = direction particle is going                              */
+         if (dx >= edgerx) {
+            mm = 2;
+         }
+         else if (dx < 0.0f) {
+            if ((dx + edgelx) < edgelx)
+               mm = 1;
+            else
+               dx = 0.0f;
+         }
+         if (dy >= edgery) {
+            mm += 6;
+         }
+         else if (dy < 0.0f) {
+            if ((dy + edgely) < edgely)
+               mm += 3;
+            else
+               dy = 0.0f;
+         }
+/* set new position */
+         ppart[idimp*(j+npoff)] = dx;
+         ppart[1+idimp*(j+npoff)] = dy;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125*sum2;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost2lr(float ppart[], float q[], int kpic[], float qm,
+                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                int mx1, int mxy1) {
+/* for 2d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   positions are stored relative to the lower left corner of the tile,
+   and charge is accumulated for each tile in double precision before
+   it is added to the global array
+   OpenMP version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   17 flops/particle, 6 loads, 4 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][n][0] = position x of particle n in tile m, relative to tile
+   ppart[m][n][1] = position y of particle n in tile m, relative to tile
+   q[k][j] = charge density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = first dimension of charge array, must be >= nx+1
+   nyv = second dimension of charge array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+local data                                                            */
+   int noff, moff, npoff, npp, mxv;
+   int i, j, k, nn, mm;
+   float x, y;
+   double dxp, dyp, amx, amy;
+   mxv = mx + 1;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cgppost2lr error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,npoff,nn,mm,x,y,dxp,dyp,amx,amy)
+   for (k = 0; k < mxy1; k++) {
+      double sq[(mx+1)*(my+1)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+/* zero out local accumulator */
+      for (j = 0; j < mxv*(my+1); j++) {
+         sq[j] = 0.0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[idimp*(j+npoff)];
+         y = ppart[1+idimp*(j+npoff)];
+         nn = x;
+         mm = y;
+         dxp = qm*(double) (x - (float) nn);
+         dyp = (double) (y - (float) mm);
+         nn = nn + mxv*mm;
+         amx = qm - dxp;
+         amy = 1.0 - dyp;
+/* deposit charge within tile to local accumulator */
+         sq[nn] += amx*amy;
+         sq[nn+1] += dxp*amy;
+         nn += mxv;
+         sq[nn] += amx*dyp;
+         sq[nn+1] += dxp*dyp;
+      }
+/* deposit charge to interior points in global array */
+      nn = nxv - noff;
+      mm = nyv - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 1; j < mm; j++) {
+         for (i = 1; i < nn; i++) {
+            q[i+noff+nxv*(j+moff)] += (float) sq[i+mxv*j];
+         }
+      }
+/* deposit charge to edge points in global array */
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (i = 1; i < nn; i++) {
+#pragma omp atomic
+         q[i+noff+nxv*moff] += (float) sq[i];
+         if (mm > my) {
+#pragma omp atomic
+            q[i+noff+nxv*(mm+moff-1)] += (float) sq[i+mxv*(mm-1)];
+         }
+      }
+      nn = nxv - noff;
+      nn = mx+1 < nn ? mx+1 : nn;
+      for (j = 0; j < mm; j++) {
+#pragma omp atomic
+         q[noff+nxv*(j+moff)] += (float) sq[mxv*j];
+         if (nn > mx) {
+#pragma omp atomic
+            q[nn+noff-1+nxv*(j+moff)] += (float) sq[nn-1+mxv*j];
+         }
+      }
+   }
+   return;
+}
+/*--------------------------------------------------------------------*/
+void cpporderf2lr(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                  int ihole[], int idimp, int nppmx, int nx, int ny,
+                  int mx, int my, int mx1, int my1, int npbmx,
+                  int ntmax, int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   linear interpolation, with periodic boundary conditions
+   positions are stored relative to the lower left corner of the tile,
+   and are shifted to the destination tile when buffered
+   tiles are assumed to be arranged in 2D linear memory
+   the algorithm has 2 steps.  first, a prefix scan of ncl is performed
+   and departing particles are buffered in ppbuff in direction order.
+   then we copy the incoming particles from other tiles into ppart.
+   it assumes that the number, location, and destination of particles 
+   leaving a tile have been previously stored in ncl and ihole by the
+   cgppushf2lr procedure.
+   input: all except ppbuff, irc
+   output: ppart, ppbuff, kpic, ncl, irc
+   ppart[k][n][0] = position x of particle n in tile k, relative to tile
+   ppart[k][n][1] = position y of particle n in tile k, relative to tile
+   ppbuff[k][n][i] = i co-ordinate of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   particles are not moved between tiles if an error occurs, so that
+   the reordering can be repeated with larger arrays
+local data                                                            */
+   int mxy1, npp, ncoff;
+   int i, j, k, ii, kx, ky, ih, nh, ist, isum;
+   int ip, j1, j2, kxl, kxr, kk, kl, kr;
+   int ks[8];
+   float edgelx, edgely, edgerx, edgery;
+   mxy1 = mx1*my1;
+/* buffer particles that are leaving tile: update ppbuff, ncl */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,kx,ky,isum,ist,nh,ip,j1,ii,edgelx,edgely,edgerx,edgery)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+      kx = k - mx1*ky;
+/* edgerx/edgery = size of this tile */
+/* edgelx/edgely = size of tile to the left/below */
+      edgerx = nx - mx*kx;
+      edgerx = mx < edgerx ? mx : edgerx;
+      edgery = ny - my*ky;
+      edgery = my < edgery ? my : edgery;
+      edgelx = kx > 0 ? mx : nx - mx*(mx1 - 1);
+      edgely = ky > 0 ? my : ny - my*(my1 - 1);
+/* find address offset for ordered ppbuff array */
+      isum = 0;
+      for (j = 0; j < 8; j++) {
+         ist = ncl[j+8*k];
+         ncl[j+8*k] = isum;
+         isum += ist;
+      }
+      nh = ihole[2*(ntmax+1)*k];
+      ip = 0;
+/* loop over particles leaving tile */
+      for (j = 0; j < nh; j++) {
+/* buffer particles that are leaving tile, in direction order */
+         j1 = ihole[2*(j+1+(ntmax+1)*k)] - 1;
+         ist = ihole[1+2*(j+1+(ntmax+1)*k)];
+         ii = ncl[ist+8*k-1];
+         if (ii < npbmx) {
+            for (i = 0; i < idimp; i++) {
+               ppbuff[i+idimp*(ii+npbmx*k)]
+               = ppart[i+idimp*(j1+nppmx*k)];
+            }
+/* shift position to destination tile */
+            j1 = ist - 3*(ist/3);
+            if (j1==1)
+               ppbuff[idimp*(ii+npbmx*k)] += edgelx;
+            else if (j1==2)
+               ppbuff[idimp*(ii+npbmx*k)] -= edgerx;
+            j1 = ist/3;
+            if (j1==1)
+               ppbuff[1+idimp*(ii+npbmx*k)] += edgely;
+            else if (j1==2)
+               ppbuff[1+idimp*(ii+npbmx*k)] -= edgery;
+         }
+         else {
+            ip = 1;
+         }
+         ncl[ist+8*k-1] = ii + 1;
+      }
+/* set error */
+      if (ip > 0)
+         *irc = ncl[7+8*k];
+   }
+/* ppbuff overflow */
+   if (*irc > 0)
+      return;
+
+/* check that incoming particles fit in ppart before moving any */
+/* loop over tiles */
+#pragma omp parallel for \
+private(k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ncoff,ks)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* npp = number of particles in tile after reordering */
+      npp = kpic[k] - ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+         npp += ncl[ii+8*ks[ii]] - ncoff;
+      }
+/* set error */
+      if (npp > nppmx)
+         *irc = npp;
+   }
+/* ppart overflow */
+   if (*irc > 0)
+      return;
+
+/* copy incoming particles from buffer into ppart: update ppart, kpic */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,ii,kk,npp,kx,ky,kl,kr,kxl,kxr,ih,nh,ncoff,ist,j1,j2,ip,ks)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* loop over directions */
+      nh = ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      ih = 0;
+      ist = 0;
+      j1 = 0;
+      for (ii = 0; ii < 8; ii++) {
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+/* ip = number of particles coming from direction ii */
+         ip = ncl[ii+8*ks[ii]] - ncoff;
+         for (j = 0; j < ip; j++) {
+            ih += 1;
+/* insert incoming particles into holes */
+            if (ih <= nh) {
+               j1 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+/* place overflow at end of array */
+            else {
+               j1 = npp;
+               npp += 1;
+            }
+            if (j1 < nppmx) {
+               for (i = 0; i < idimp; i++) {
+                  ppart[i+idimp*(j1+nppmx*k)]
+                  = ppbuff[i+idimp*(j+ncoff+npbmx*ks[ii])];
+                }
+            }
+            else {
+               ist = 1;
+            }
+         }
+      }
+/* set error */
+      if (ist > 0)
+         *irc = j1+1;
+/* fill up remaining holes in particle array with particles from bottom */
+      if (ih < nh) {
+         ip = nh - ih;
+         for (j = 0; j < ip; j++) {
+            j1 = npp - j - 1;
+            j2 = ihole[2*(nh-j+(ntmax+1)*k)] - 1;
+            if (j1 > j2) {
+/* move particle only if it is below current hole */
+               for (i = 0; i < idimp; i++) {
+                  ppart[i+idimp*(j2+nppmx*k)]
+                  = ppart[i+idimp*(j1+nppmx*k)];
+               }
+            }
+         }
+         npp -= ip;
+      }
+      kpic[k] = npp;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2lr(float ppart[], int kpic[], int ncl[], int ihole[],
+                 int idimp, int nppmx, int nx, int ny, int mx, int my,
+                 int mx1, int my1, int ntmax, int *irc) {
+/* this subroutine finds particles leaving tiles, and stores their
+   number in each direction, location, and destination in ncl and
+   ihole, for particles whose co-ordinates have already been updated
+   with positions relative to the tile, as in cgppushf2lr.  used to
+   recreate the list for cpporderf2lr after ihole, ppbuff or ppart
+   arrays have been enlarged following an overflow
+   input: all except ncl, ihole, irc, output: ncl, ihole, irc
+   ppart[k][n][0] = position x of particle n in tile k, relative to tile
+   ppart[k][n][1] = position y of particle n in tile k, relative to tile
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxy1, npp, npoff;
+   int j, k, kx, ky, ih, nh, ist;
+   float dx, dy, edgerx, edgery;
+   mxy1 = mx1*my1;
+/* loop over tiles */
+#pragma omp parallel for \
+private(j,k,kx,ky,npp,npoff,ih,nh,ist,dx,dy,edgerx,edgery)
+   for (k = 0; k < mxy1; k++) {
+      ky = k/mx1;
+      kx = k - mx1*ky;
+/* edgerx/edgery = size of this tile */
+      edgerx = nx - mx*kx;
+      edgerx = mx < edgerx ? mx : edgerx;
+      edgery = ny - my*ky;
+      edgery = my < edgery ? my : edgery;
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ih = 0;
+      nh = 0;
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+/* loop over particles in tile */
+      for (j = 0; j < npp; j++) {
+         dx = ppart[idimp*j+npoff];
+         dy = ppart[1+idimp*j+npoff];
+/* ist = direction particle is going */
+         ist = 0;
+         if (dx >= edgerx)
+            ist = 2;
+         else if (dx < 0.0f)
+            ist = 1;
+         if (dy >= edgery)
+            ist += 6;
+         else if (dy < 0.0f)
+            ist += 3;
+         if (ist > 0) {
+            ncl[ist+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = ist;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppushf2s(float ppart[], float fxy[], int kpic[], int ncl[],
+                int ihole[], float qbm, float dt, float *ek, int idimp,
+                int nppmx, int nx, int ny, int mx, int my, int nxv,
+                int nyv, int mx1, int mxy1, int ntmax, int nord,
+                int *irc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and second-order quadratic
+   or third-order cubic spline interpolation in space, with periodic
+   boundary conditions.
+   also determines list of particles which are leaving this tile
+   vectorizable/OpenMP version
+   data read in tiles, with guards of one grid below and two grids
+   above each tile, copied from the periodic interior of fxy
+   particles stored segmented array
+   quadratic: 80 flops/particle, 22 loads, 4 stores
+   cubic: 125 flops/particle, 36 loads, 4 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest nord+1 grid points in each direction:
+   fx(x,y) = sum(sy(m)*sum(sx(n)*fx(n,m))), similarly for fy
+   for nord = 2, n,m = nearest grid points and dx = x-n, dy = y-m
+   sx(n-1) = .5*(.5-dx)**2, sx(n) = .75-dx**2, sx(n+1) = .5*(.5+dx)**2
+   for nord = 3, n,m = leftmost grid points and dx = x-n, dy = y-m
+   sx(n-1) = (1-dx)**3/6, sx(n) = (4-6*dx**2+3*dx**3)/6,
+   sx(n+1) = (1+3*dx+3*dx**2-3*dx**3)/6, sx(n+2) = dx**3/6
+   with similar expressions for sy
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = velocity vx of particle n in tile m
+   ppart[m][n][3] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = second dimension of field arrays, must be >= nx
+   nyv = third dimension of field arrays, must be >= ny
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   nord = order of spline interpolation, 2 = quadratic, 3 = cubic
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   irc = -2 if mx or my is larger than MXM
+local data                                                            */
+#define NPBLK             32
+#define LSTEN             4
+   int noff, moff, npoff, npp, joff, nps;
+   int i, j, k, l, m, ih, nh, nn, mm, ii, ns, lxv;
+   float qtm, dxp, dyp, amx, amy, wx;
+   float x, y, dx, dy, vx, vy;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+   float sixth = 1.0f/6.0f, twoth = 2.0f/3.0f;
+/* scratch arrays */
+   int n[NPBLK];
+   float sx[NPBLK*LSTEN], sy[NPBLK*LSTEN], s[2*NPBLK];
+   double sum1, sum2;
+   ns = nord + 1;
+   lxv = mx + 3;
+   qtm = qbm*dt;
+   anx = (float) nx;
+   any = (float) ny;
+   sum2 = 0.0;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      *irc = -2;
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,l,m,noff,moff,npp,npoff,joff,nps,nn,mm,ii,ih,nh,x,y,dxp, \
+dyp,amx,amy,wx,dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1,n,sx, \
+sy,s) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      float sfxy[2*(mx+3)*(my+3)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      ih = 0;
+      nh = 0;
+      nn += 3;
+      mm += 3;
+/* load local fields from global array, guards wrap periodically */
+      for (j = 0; j < mm; j++) {
+         l = j + moff - 1;
+         l = l < 0 ? l + ny : l;
+         l = l < ny ? l : l - ny;
+         for (i = 0; i < nn; i++) {
+            ii = i + noff - 1;
+            ii = ii < 0 ? ii + nx : ii;
+            ii = ii < nx ? ii : ii - nx;
+            sfxy[2*(i+lxv*j)] = fxy[2*(ii+nxv*l)];
+            sfxy[1+2*(i+lxv*j)] = fxy[1+2*(ii+nxv*l)];
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 8; j++) {
+         ncl[j+8*k] = 0;
+      }
+      sum1 = 0.0;
+/* loop over blocks of particles in tile */
+      for (joff = 0; joff < npp; joff += NPBLK) {
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* find interpolation weights */
+         if (nord==2) {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               nn = x + 0.5f;
+               mm = y + 0.5f;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               n[j] = nn - noff + lxv*(mm - moff);
+               amx = 0.5f - dxp;
+               amy = 0.5f - dyp;
+               dx = 0.5f + dxp;
+               dy = 0.5f + dyp;
+               sx[j] = 0.5f*amx*amx;
+               sx[j+NPBLK] = 0.75f - dxp*dxp;
+               sx[j+2*NPBLK] = 0.5f*dx*dx;
+               sy[j] = 0.5f*amy*amy;
+               sy[j+NPBLK] = 0.75f - dyp*dyp;
+               sy[j+2*NPBLK] = 0.5f*dy*dy;
+            }
+         }
+         else {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               nn = x;
+               mm = y;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               n[j] = nn - noff + lxv*(mm - moff);
+               amx = 1.0f - dxp;
+               amy = 1.0f - dyp;
+               dx = dxp*dxp;
+               dy = dyp*dyp;
+               sx[j] = sixth*amx*amx*amx;
+               sx[j+NPBLK] = twoth - dx*(1.0f - 0.5f*dxp);
+               sx[j+2*NPBLK] = sixth + 0.5f*(dxp + dx - dx*dxp);
+               sx[j+3*NPBLK] = sixth*dx*dxp;
+               sy[j] = sixth*amy*amy*amy;
+               sy[j+NPBLK] = twoth - dy*(1.0f - 0.5f*dyp);
+               sy[j+2*NPBLK] = sixth + 0.5f*(dyp + dy - dy*dyp);
+               sy[j+3*NPBLK] = sixth*dy*dyp;
+            }
+         }
+/* find acceleration */
+         for (j = 0; j < nps; j++) {
+            s[j] = 0.0f;
+            s[j+NPBLK] = 0.0f;
+         }
+         for (m = 0; m < ns; m++) {
+            for (l = 0; l < ns; l++) {
+               ii = 2*(l + lxv*m);
+               for (j = 0; j < nps; j++) {
+                  nn = 2*n[j] + ii;
+                  wx = sx[j+NPBLK*l]*sy[j+NPBLK*m];
+                  s[j] += wx*sfxy[nn];
+                  s[j+NPBLK] += wx*sfxy[nn+1];
+               }
+            }
+         }
+/* new velocity */
+         for (j = 0; j < nps; j++) {
+            x = ppart[idimp*(j+joff+npoff)];
+            y = ppart[1+idimp*(j+joff+npoff)];
+            vx = ppart[2+idimp*(j+joff+npoff)];
+            vy = ppart[3+idimp*(j+joff+npoff)];
+            dx = vx + qtm*s[j];
+            dy = vy + qtm*s[j+NPBLK];
+/* average kinetic energy */
+            vx += dx;
+            vy += dy;
+            sum1 += (vx*vx + vy*vy);
+            ppart[2+idimp*(j+joff+npoff)] = dx;
+            ppart[3+idimp*(j+joff+npoff)] = dy;
+/* new position */
+            dx = x + dx*dt;
+            dy = y + dy*dt;
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx -= anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy -= any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+/* set new position */
+            ppart[idimp*(j+joff+npoff)] = dx;
+            ppart[1+idimp*(j+joff+npoff)] = dy;
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+8*k-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*k)] = j + joff + 1;
+                  ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef LSTEN
+#undef NPBLK
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost2s(float ppart[], float q[], int kpic[], float qm,
+               int nppmx, int idimp, int nx, int ny, int mx, int my,
+               int nxv, int nyv, int mx1, int mxy1, int nord) {
+/* for 2d code, this subroutine calculates particle charge density
+   using second-order quadratic or third-order cubic spline
+   interpolation, periodic boundaries
+   vectorizable/OpenMP version
+   data deposited in tiles, with guards of one grid below and two grids
+   above each tile, which are added to the periodic interior of q
+   particles stored segmented array
+   quadratic: 43 flops/particle, 11 loads, 9 stores
+   cubic: 68 flops/particle, 18 loads, 16 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest nord+1 grid
+   points in each direction:
+   q(n,m) = qm*sx(n)*sy(m), with weights as in cgppushf2s
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   q[k][j] = charge density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx and my must be <= MXM = 128
+   nxv = first dimension of charge array, must be >= nx
+   nyv = second dimension of charge array, must be >= ny
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   nord = order of spline interpolation, 2 = quadratic, 3 = cubic
+   guard cells of q are not used
+local data                                                            */
+#define NPBLK             32
+#define LSTEN             4
+   int noff, moff, npoff, npp, joff, nps;
+   int i, j, k, l, m, nn, mm, ii, ns, lxv;
+   float x, y, dxp, dyp, amx, amy, dx, dy;
+   float sixth = 1.0f/6.0f, twoth = 2.0f/3.0f;
+/* scratch arrays */
+   int n[NPBLK];
+   float sx[NPBLK*LSTEN], sy[NPBLK*LSTEN];
+   ns = nord + 1;
+   lxv = mx + 3;
+/* error if local arrays are too large for the thread stack */
+   if ((mx > MXM) || (my > MXM)) {
+      printf("cgppost2s error: mx,my=%d,%d > MXM=%d\n",mx,my,MXM);
+      return;
+   }
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,l,m,noff,moff,npp,npoff,joff,nps,nn,mm,ii,x,y,dxp,dyp, \
+amx,amy,dx,dy,n,sx,sy)
+   for (k = 0; k < mxy1; k++) {
+      float sq[(mx+3)*(my+3)];
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      npoff = nppmx*k;
+/* zero out local accumulator */
+      for (j = 0; j < lxv*(my+3); j++) {
+         sq[j] = 0.0f;
+      }
+/* loop over blocks of particles in tile */
+      for (joff = 0; joff < npp; joff += NPBLK) {
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* find interpolation weights */
+         if (nord==2) {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               nn = x + 0.5f;
+               mm = y + 0.5f;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               n[j] = nn - noff + lxv*(mm - moff);
+               amx = 0.5f - dxp;
+               amy = 0.5f - dyp;
+               dx = 0.5f + dxp;
+               dy = 0.5f + dyp;
+               sx[j] = 0.5f*qm*amx*amx;
+               sx[j+NPBLK] = qm*(0.75f - dxp*dxp);
+               sx[j+2*NPBLK] = 0.5f*qm*dx*dx;
+               sy[j] = 0.5f*amy*amy;
+               sy[j+NPBLK] = 0.75f - dyp*dyp;
+               sy[j+2*NPBLK] = 0.5f*dy*dy;
+            }
+         }
+         else {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               nn = x;
+               mm = y;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               n[j] = nn - noff + lxv*(mm - moff);
+               amx = 1.0f - dxp;
+               amy = 1.0f - dyp;
+               dx = dxp*dxp;
+               dy = dyp*dyp;
+               sx[j] = sixth*qm*amx*amx*amx;
+               sx[j+NPBLK] = qm*(twoth - dx*(1.0f - 0.5f*dxp));
+               sx[j+2*NPBLK] = qm*(sixth + 0.5f*(dxp + dx - dx*dxp));
+               sx[j+3*NPBLK] = sixth*qm*dx*dxp;
+               sy[j] = sixth*amy*amy*amy;
+               sy[j+NPBLK] = twoth - dy*(1.0f - 0.5f*dyp);
+               sy[j+2*NPBLK] = sixth + 0.5f*(dyp + dy - dy*dyp);
+               sy[j+3*NPBLK] = sixth*dy*dyp;
+            }
+         }
+/* deposit charge within tile to local accumulator */
+         for (j = 0; j < nps; j++) {
+            nn = n[j];
+            for (m = 0; m < ns; m++) {
+               mm = nn + lxv*m;
+               for (l = 0; l < ns; l++) {
+                  sq[l+mm] += sx[j+NPBLK*l]*sy[j+NPBLK*m];
+               }
+            }
+         }
+      }
+/* deposit charge to interior points in global array */
+/* interior points are not touched by any other tile */
+      nn = nx - noff;
+      mm = ny - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      for (j = 3; j < mm; j++) {
+         for (i = 3; i < nn; i++) {
+            q[i+noff-1+nxv*(j+moff-1)] += sq[i+lxv*j];
+         }
+      }
+/* deposit charge to edge and guard points in global array */
+/* guard points wrap periodically */
+      for (j = 0; j < mm+3; j++) {
+         l = j + moff - 1;
+         l = l < 0 ? l + ny : l;
+         l = l < ny ? l : l - ny;
+         for (i = 0; i < nn+3; i++) {
+            if ((i >= 3) && (i < nn) && (j >= 3) && (j < mm))
+               continue;
+            ii = i + noff - 1;
+            ii = ii < 0 ? ii + nx : ii;
+            ii = ii < nx ? ii : ii - nx;
+#pragma omp atomic
+            q[ii+nxv*l] += sq[i+lxv*j];
+         }
+      }
+   }
+   return;
+#undef LSTEN
+#undef NPBLK
+}
+
+/*--------------------------------------------------------------------*/
+void ccguard2l(float fxy[], int nx, int ny, int nxe, int nye) {
+/* replicate extended periodic vector field fxy
+   linear interpolation
+   nx/ny = system length in x/y direction
+   nxe = first dimension of field arrays, must be >= nx+1
+   nxe = second dimension of field arrays, must be >= ny+1
+local data                                                 */
+   int j, k;
+/* copy edges of extended field */
+   for (k = 0; k < ny; k++) {
+      fxy[2*nx+2*nxe*k] = fxy[2*nxe*k];
+      fxy[1+2*nx+2*nxe*k] = fxy[1+2*nxe*k];
+   }
+   for (j = 0; j < nx; j++) {
+      fxy[2*j+2*nxe*ny] = fxy[2*j];
+      fxy[1+2*j+2*nxe*ny] = fxy[1+2*j];
+   }
+   fxy[2*nx+2*nxe*ny] = fxy[0];
+   fxy[1+2*nx+2*nxe*ny] = fxy[1];
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void caguard2l(float q[], int nx, int ny, int nxe, int nye) {
+/* accumulate extended periodic scalar field q
+   linear interpolation
+   nx/ny = system length in x/y direction
+   nxe = first dimension of field arrays, must be >= nx+1
+   nxe = second dimension of field arrays, must be >= ny+1
+local data                                                 */
+   int j, k;
+/* accumulate edges of extended field */
+   for (k = 0; k < ny; k++) {
+      q[nxe*k] += q[nx+nxe*k];
+      q[nx+nxe*k] = 0.0;
+   }
+   for (j = 0; j < nx; j++) {
+      q[j] += q[j+nxe*ny];
+      q[j+nxe*ny] = 0.0;
+   }
+   q[0] += q[nx+nxe*ny];
+   q[nx+nxe*ny] = 0.0;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cmpois22(float complex q[], float complex fxy[], int isign,
+              float complex ffc[], float ax, float ay, float affp,
+              float *we, int nx, int ny, int nxvh, int nyv, int nxhd,
+              int nyhd) {
+/* this subroutine solves 2d poisson's equation in fourier space for
+   force/charge (or convolution of electric field over particle shape)
+   with periodic boundary conditions.
+   for isign = 0, input: isign,ax,ay,affp,nx,ny,nxvh,nyhd, output: ffc
+   for isign /= 0, input: q,ffc,isign,nx,ny,nxvh,nyhd, output: fxy,we
+   approximate flop count is: 26*nxc*nyc + 12*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   equation used is:
+   fx[ky][kx] = -sqrt(-1)*kx*g[ky][kx]*s[ky][kx]*q[ky][kx],
+   fy[ky][kx] = -sqrt(-1)*ky*g[ky][kx]*s[ky][kx]*q[ky][kx],
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   g[ky][kx] = (affp/(kx**2+ky**2))*s(kx,ky),
+   s[ky][kx] = exp(-((kx*ax)**2+(ky*ay)**2)/2), except for
+   fx(kx=pi) = fy(kx=pi) = fx(ky=pi) = fy(ky=pi) = 0, and
+   fx(kx=0,ky=0) = fy(kx=0,ky=0) = 0.
+   q[k][j] = complex charge density for fourier mode (j,k)
+   fxy[k][j][0] = x component of complex force/charge,
+   fxy[k][j][1] = y component of complex force/charge,
+   all for fourier mode (j,k)
+   if isign = 0, form factor array is prepared
+   if isign is not equal to 0, force/charge is calculated
+   cimag(ffc[k][j]) = finite-size particle shape factor s
+   for fourier mode (j,k)
+   creal(ffc[k][j]) = potential green's function g
+   for fourier mode (j,k)
+   ax/ay = half-width of particle in x/y direction
+   affp = normalization constant = nx*ny/np, where np=number of particles
+   electric field energy is also calculated, using
+   we = nx*ny*sum((affp/(kx**2+ky**2))*|q[ky][kx]*s[ky][kx]|**2)
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+local data                                                 */
+   int nxh, nyh, j, k, k1, kk, kj;
    float dnx, dny, dkx, dky, at1, at2, at3, at4;
    float complex zero, zt1, zt2;
    double wp, sum1;
    nxh = nx/2;
-   nyh = 1 > ny/2 ? 1 : ny/2;
-   dnx = 6.28318530717959/(float) nx;
-   dny = 6.28318530717959/(float) ny;
-   zero = 0.0 + 0.0*_Complex_I;
-   if (isign != 0)
-      goto L30;
-/* prepare form factor array */
-   for (k = 0; k < nyh; k++) {
-      dky = dny*(float) k;
-      kk = nxhd*k;
-      at1 = dky*dky;
-      at2 = pow((dky*ay),2);
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   dnx = 6.28318530717959/(float) nx;
+   dny = 6.28318530717959/(float) ny;
+   zero = 0.0 + 0.0*_Complex_I;
+   if (isign != 0)
+      goto L30;
+/* prepare form factor array */
+   for (k = 0; k < nyh; k++) {
+      dky = dny*(float) k;
+      kk = nxhd*k;
+      at1 = dky*dky;
+      at2 = pow((dky*ay),2);
+      for (j = 0; j < nxh; j++) {
+         dkx = dnx*(float) j;
+         at3 = dkx*dkx + at1;
+         at4 = exp(-0.5*(pow((dkx*ax),2) + at2));
+         if (at3==0.0) {
+            ffc[j+kk] = affp + 1.0*_Complex_I;
+         }
+         else {
+            ffc[j+kk] = (affp*at4/at3) + at4*_Complex_I;
+         }
+      }
+   }
+   return;
+/* calculate force/charge and sum field energy */
+L30: sum1 = 0.0;
+#pragma omp parallel for \
+private(j,k,k1,kk,kj,dky,at1,at2,at3,zt1,zt2,wp) \
+reduction(+:sum1)
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      k1 = ny - k;
+      dky = dny*(float) k;
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      wp = 0.0;
+      for (j = 1; j < nxh; j++) {
+         at1 = crealf(ffc[j+kk])*cimagf(ffc[j+kk]);
+         at2 = at1*dnx*(float) j;
+         at3 = dky*at1;
+         zt1 = cimagf(q[j+kj]) - crealf(q[j+kj])*_Complex_I;
+         zt2 = cimagf(q[j+k1]) - crealf(q[j+k1])*_Complex_I;
+         fxy[2*j+2*kj] = at2*zt1;
+         fxy[1+2*j+2*kj] = at3*zt1;
+         fxy[2*j+2*k1] = at2*zt2;
+         fxy[1+2*j+2*k1] = -at3*zt2;
+         wp += at1*(q[j+kj]*conjf(q[j+kj]) + q[j+k1]*conjf(q[j+k1]));
+      }
+      at1 = crealf(ffc[kk])*cimagf(ffc[kk]);
+      at3 = at1*dny*(float) k;
+      zt1 = cimagf(q[kj]) - crealf(q[kj])*_Complex_I;
+      fxy[2*kj] = zero;
+      fxy[1+2*kj] = at3*zt1;
+      fxy[2*k1] = zero;
+      fxy[1+2*k1] = zero;
+      wp += at1*(q[kj]*conjf(q[kj]));
+      sum1 += wp;
+   }
+   wp = 0.0;
+/* mode numbers ky = 0, ny/2 */
+   k1 = 2*nxvh*nyh;
+   for (j = 1; j < nxh; j++) {
+      at1 = crealf(ffc[j])*cimagf(ffc[j]);
+      at2 = at1*dnx*(float) j;  
+      zt1 = cimagf(q[j]) - crealf(q[j])*_Complex_I;
+      fxy[2*j] = at2*zt1;
+      fxy[1+2*j] = zero;
+      fxy[2*j+k1] = zero;
+      fxy[1+2*j+k1] = zero;
+      wp += at1*(q[j]*conjf(q[j]));
+   }
+   fxy[0] = zero;
+   fxy[1] = zero;
+   fxy[k1] = zero;
+   fxy[1+k1] = zero;
+   sum1 += wp;
+   *we = sum1*(float) (nx*ny);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rinit(int mixup[], float complex sct[], int indx, int indy, 
+                 int nxhyd, int nxyhd) {
+/* this subroutine calculates tables needed by a two dimensional
+   real to complex fast fourier transform and its inverse.
+   input: indx, indy, nxhyd, nxyhd
+   output: mixup, sct
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = one half of maximum of (nx,ny)
+   written by viktor k. decyk, ucla
+local data                                                            */
+   int indx1, indx1y, nx, ny, nxy, nxhy, nxyh;
+   int j, k, lb, ll, jb, it;
+   float dnxy, arg;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   ny = 1L<<indy;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+/* bit-reverse index table: mixup[j] = 1 + reversed bits of j */
+   for (j = 0; j < nxhy; j++) {
+      lb = j;
+      ll = 0;
+      for (k = 0; k < indx1y; k++) {
+         jb = lb/2;
+         it = lb - 2*jb;
+         lb = jb;
+         ll = 2*ll + it;
+      }
+      mixup[j] = ll + 1;
+   }
+/* sine/cosine table for the angles 2*n*pi/nxy */
+   nxyh = nxy/2;
+   dnxy = 6.28318530717959/(float) nxy;
+   for (j = 0; j < nxyh; j++) {
+      arg = dnxy*(float) j;
+      sct[j] = cosf(arg) - sinf(arg)*_Complex_I;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rmxx(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of a two dimensional real to
+   complex fast fourier transform and its inverse, for a subset of y,
+   using complex arithmetic, with OpenMP
+   for isign = (-1,1), input: all, output: f
+   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
+   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
+   where N = (nx/2)*ny
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, an inverse fourier transform in x is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*exp(-sqrt(-1)*2pi*n*j/nx))
+   if isign = 1, a forward fourier transform in x is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as follows:
+   f[k][j] = real, imaginary part of mode j,k, where
+   0 <= j < nx/2 and 0 <= k < ny, except for
+   f[k][1] = real, imaginary part of mode nx/2,k, where
+   ny/2+1 <= k < ny, and
+   imag(f[0][0]) = real part of mode nx/2,0 and
+   imag(f[0][ny/2]) = real part of mode nx/2,ny/2
+   written by viktor k. decyk, ucla
+local data                                                            */
+   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
+   int nrx, i, j, k, l, j1, j2, k1, k2, ns, ns2, km, kmr, nrxb, joff;
+   float ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   nxh = nx/2;
+   nxhh = nx/4;
+   ny = 1L<<indy;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nyt = nyi + nyp - 1;
+   if (isign > 0)
+      goto L70;
+/* inverse fourier transform */
+   nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,joff,ani,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = nxhd*i;
+/* bit-reverse array elements in x */
+      for (j = 0; j < nxh; j++) {
+         j1 = (mixup[j] - 1)/nrxb;
+         if (j < j1) {
+            t1 = f[j1+joff];
+            f[j1+joff] = f[j+joff];
+            f[j+joff] = t1;
+         }
+      }
+/* then transform in x */
+      ns = 1;
+      for (l = 0; l < indx1; l++) {
+         ns2 = ns + ns;
+         km = nxhh/ns;
+         kmr = km*nrx;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = j + k1;
+               j2 = j + k2;
+               t1 = sct[kmr*j];
+               t2 = t1*f[j2+joff];
+               f[j2+joff] = f[j1+joff] - t2;
+               f[j1+joff] += t2;
+            }
+         }
+         ns = ns2;
+      }
+/* unscramble coefficients and normalize */
+      kmr = nxy/nx;
+      ani = 0.5/(((float) nx)*((float) ny));
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
+         t2 = conjf(f[nxh-j+joff]);
+         t1 = f[j+joff] + t2;
+         t2 = (f[j+joff] - t2)*t3;
+         f[j+joff] = ani*(t1 + t2);
+         f[nxh-j+joff] = ani*conjf(t1 - t2);
+      }
+      ani = 2.0*ani;
+      f[nxhh+joff] = ani*conjf(f[nxhh+joff]);
+      f[joff] = ani*((crealf(f[joff]) + cimagf(f[joff]))
+                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I);
+   }
+   return;
+/* forward fourier transform */
+L70: nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,joff,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = nxhd*i;
+/* scramble coefficients */
+      kmr = nxy/nx;
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
+         t2 = conjf(f[nxh-j+joff]);
+         t1 = f[j+joff] + t2;
+         t2 = (f[j+joff] - t2)*t3;
+         f[j+joff] = t1 + t2;
+         f[nxh-j+joff] = conjf(t1 - t2);
+      }
+      f[nxhh+joff] = 2.0*conjf(f[nxhh+joff]);
+      f[joff] = (crealf(f[joff]) + cimagf(f[joff]))
+                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I;
+/* bit-reverse array elements in x */
+      for (j = 0; j < nxh; j++) {
+         j1 = (mixup[j] - 1)/nrxb;
+         if (j < j1) {
+            t1 = f[j1+joff];
+            f[j1+joff] = f[j+joff];
+            f[j+joff] = t1;
+         }
+      }
+/* then transform in x */
+      ns = 1;
+      for (l = 0; l < indx1; l++) {
+         ns2 = ns + ns;
+         km = nxhh/ns;
+         kmr = km*nrx;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = j + k1;
+               j2 = j + k2;
+               t1 = conjf(sct[kmr*j]);
+               t2 = t1*f[j2+joff];
+               f[j2+joff] = f[j1+joff] - t2;
+               f[j1+joff] += t2;
+            }
+         }
+         ns = ns2;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rmxy(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of a two dimensional real to
+   complex fast fourier transform and its inverse, for a subset of x,
+   using complex arithmetic, with OpenMP
+   for isign = (-1,1), input: all, output: f
+   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
+   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
+   where N = (nx/2)*ny
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, an inverse fourier transform in y is performed
+   f[m][n] = sum(f[k][j]*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform in y is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as follows:
+   f[k][j] = real, imaginary part of mode j,k, where
+   0 <= j < nx/2 and 0 <= k < ny, except for
+   f[k][1] = real, imaginary part of mode nx/2,k, where
+   ny/2+1 <= k < ny, and
+   imag(f[0][0]) = real part of mode nx/2,0 and
+   imag(f[0][ny/2]) = real part of mode nx/2,ny/2
+   written by viktor k. decyk, ucla
+local data                                                            */
+   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
+   int nry, i, j, k, l, j1, j2, k1, k2, ns, ns2, km, kmr, nryb, koff;
+   float complex t1, t2;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   ny = 1L<<indy;
+   nyh = ny/2;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nxt = nxi + nxp - 1;
+   if (isign > 0)
+      goto L70;
+/* inverse fourier transform */
+   nryb = nxhy/ny;
+   nry = nxy/ny;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,koff,t1,t2)
+   for (i = nxi-1; i < nxt; i++) {
+/* bit-reverse array elements in y */
+      for (k = 0; k < ny; k++) {
+         koff = nxhd*k;
+         k1 = (mixup[k] - 1)/nryb;
+         if (k < k1) {
+            k1 = nxhd*k1;
+            t1 = f[i+k1];
+            f[i+k1] = f[i+koff];
+            f[i+koff] = t1;
+         }
+      }
+/* then transform in y */
+      ns = 1;
+      for (l = 0; l < indy; l++) {
+         ns2 = ns + ns;
+         km = nyh/ns;
+         kmr = km*nry;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = nxhd*(j + k1);
+               j2 = nxhd*(j + k2);
+               t1 = sct[kmr*j];
+               t2 = t1*f[i+j2];
+               f[i+j2] = f[i+j1] - t2;
+               f[i+j1] += t2;
+            }
+         }
+         ns = ns2;
+      }
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = nxhd*k;
+         k1 = nxhd*ny - koff;
+         t1 = f[k1];
+         f[k1] = 0.5*(cimagf(f[koff] + t1)
+                  + crealf(f[koff] - t1)*_Complex_I);
+         f[koff] = 0.5*(crealf(f[koff] + t1)
+                    + cimagf(f[koff] - t1)*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+L70: nryb = nxhy/ny;
+   nry = nxy/ny;
+/* scramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = nxhd*k;
+         k1 = nxhd*ny - koff;
+         t1 = cimagf(f[k1]) + crealf(f[k1])*_Complex_I;
+         f[k1] = conjf(f[koff] - t1);
+         f[koff] += t1;
+      }
+   }
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,koff,t1,t2)
+   for (i = nxi-1; i < nxt; i++) {
+/* bit-reverse array elements in y */
+      for (k = 0; k < ny; k++) {
+         koff = nxhd*k;
+         k1 = (mixup[k] - 1)/nryb;
+         if (k < k1) {
+            k1 = nxhd*k1;
+            t1 = f[i+k1];
+            f[i+k1] = f[i+koff];
+            f[i+koff] = t1;
+         }
+      }
+/* then transform in y */
+      ns = 1;
+      for (l = 0; l < indy; l++) {
+         ns2 = ns + ns;
+         km = nyh/ns;
+         kmr = km*nry;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = nxhd*(j + k1);
+               j2 = nxhd*(j + k2);
+               t1 = conjf(sct[kmr*j]);
+               t2 = t1*f[i+j2];
+               f[i+j2] = f[i+j1] - t2;
+               f[i+j1] += t2;
+            }
+         }
+         ns = ns2;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rm2x(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of 2 two dimensional real to
+   complex fast fourier transforms, and their inverses, for a subset of
+   y, using complex arithmetic, with OpenMP
+   for isign = (-1,1), input: all, output: f
+   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
+   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
+   where N = (nx/2)*ny
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, two inverse fourier transforms in x are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*n*j/nx))
+   if isign = 1, two forward fourier transforms in x are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as follows:
+   f[k][j][0:1] = real, imaginary part of mode j,k, where
+   0 <= j < nx/2 and 0 <= k < ny, except for
+   f[k][1][0:1] = real, imaginary part of mode nx/2,k, where
+   ny/2+1 <= k < ny, and
+   imag(f[0][0][0:1]) = real part of mode nx/2,0 and
+   imag(f[0][ny/2][0:1]) = real part of mode nx/2,ny/2
+   written by viktor k. decyk, ucla
+local data                                                            */
+   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
+   int nrx, i, j, k, l, jj, j1, j2, k1, k2, ns, ns2, km, kmr, joff;
+   int nrxb;
+   float at1, ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   nxh = nx/2;
+   nxhh = nx/4;
+   ny = 1L<<indy;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nyt = nyi + nyp - 1;
+   if (isign > 0)
+      goto L100;
+/* inverse fourier transform */
+   nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,ani,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = 2*nxhd*i;
+/* swap complex components */
+      for (j = 0; j < nxh; j++) {
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+       }
+/* bit-reverse array elements in x */
+      for (j = 0; j < nxh; j++) {
+         j1 = (mixup[j] - 1)/nrxb;
+         if (j < j1) {
+            t1 = f[2*j1+joff];
+            t2 = f[1+2*j1+joff];
+            f[2*j1+joff] = f[2*j+joff];
+            f[1+2*j1+joff] = f[1+2*j+joff];
+            f[2*j+joff] = t1;
+            f[1+2*j+joff] = t2;
+         }
+      }
+/* then transform in x */
+      ns = 1;
+      for (l = 0; l < indx1; l++) {
+         ns2 = ns + ns;
+         km = nxhh/ns;
+         kmr = km*nrx;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = j + k1;
+               j2 = j + k2;
+               t1 = sct[kmr*j];
+               t2 = t1*f[2*j2+joff];
+               t3 = t1*f[1+2*j2+joff];
+               f[2*j2+joff] = f[2*j1+joff] - t2;
+               f[1+2*j2+joff] = f[1+2*j1+joff] - t3;
+               f[2*j1+joff] += t2;
+               f[1+2*j1+joff] += t3;
+            }
+         }
+         ns = ns2;
+      }
+/* unscramble coefficients and normalize */
+      kmr = nxy/nx;
+      ani = 0.5/(((float) nx)*((float) ny));
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = ani*(t1 + t2);
+            f[jj+2*(nxh-j)+joff] = ani*conjf(t1 - t2);
+         }
+      }
+      ani = 2.0*ani;
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = ani*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = ani*((crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+L100: nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = 2*nxhd*i;
+/* scramble coefficients */
+      kmr = nxy/nx;
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = t1 + t2;
+            f[jj+2*(nxh-j)+joff] = conjf(t1 - t2);
+         }
+      }
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = 2.0*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = (crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I;
+      }
+/* bit-reverse array elements in x */
+      for (j = 0; j < nxh; j++) {
+         j1 = (mixup[j] - 1)/nrxb;
+         if (j < j1) {
+            t1 = f[2*j1+joff];
+            t2 = f[1+2*j1+joff];
+            f[2*j1+joff] = f[2*j+joff];
+            f[1+2*j1+joff] = f[1+2*j+joff];
+            f[2*j+joff] = t1;
+            f[1+2*j+joff] = t2;
+         }
+      }
+/* then transform in x */
+      ns = 1;
+      for (l = 0; l < indx1; l++) {
+         ns2 = ns + ns;
+         km = nxhh/ns;
+         kmr = km*nrx;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = j + k1;
+               j2 = j + k2;
+               t1 = conjf(sct[kmr*j]);
+               t2 = t1*f[2*j2+joff];
+               t3 = t1*f[1+2*j2+joff];
+               f[2*j2+joff] = f[2*j1+joff] - t2;
+               f[1+2*j2+joff] = f[1+2*j1+joff] - t3;
+               f[2*j1+joff] += t2;
+               f[1+2*j1+joff] +=  t3;
+            }
+         }
+         ns = ns2;
+      }
+/* swap complex components */
+      for (j = 0; j < nxh; j++) {
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rm2y(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of 2 two dimensional real to
+   complex fast fourier transforms, and their inverses, for a subset of
+   x, using complex arithmetic, with OpenMP
+   for isign = (-1,1), input: all, output: f
+   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
+   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
+   where N = (nx/2)*ny
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, two inverse fourier transforms in y are performed
+   f[m][n][0:1] = *sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms in y are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as follows:
+   f[k][j][0:1] = real, imaginary part of mode j,k, where
+   0 <= j < nx/2 and 0 <= k < ny, except for
+   f[k][1][0:1] = real, imaginary part of mode nx/2,k, where
+   ny/2+1 <= k < ny, and
+   imag(f[0][0][0:1]) = real part of mode nx/2,0 and
+   imag(f[0][ny/2][0:1]) = real part of mode nx/2,ny/2
+  written by viktor k. decyk, ucla
+local data                                                            */
+   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
+   int nry, i, j, k, l, jj, j1, j2, k1, k2, ns, ns2, km, kmr, koff;
+   int nryb;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   ny = 1L<<indy;
+   nyh = ny/2;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nxt = nxi + nxp - 1;
+   if (isign > 0)
+      goto L80;
+/* inverse fourier transform */
+   nryb = nxhy/ny;
+   nry = nxy/ny;
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,koff,t1,t2,t3)
+   for (i = nxi-1; i < nxt; i++) {
+/* bit-reverse array elements in y */
+      for (k = 0; k < ny; k++) {
+         koff = 2*nxhd*k;
+         k1 = (mixup[k] - 1)/nryb;
+         if (k < k1) {
+            k1 = 2*nxhd*k1;
+            t1 = f[2*i+k1];
+            t2 = f[1+2*i+k1];
+            f[2*i+k1] = f[2*i+koff];
+            f[1+2*i+k1] = f[1+2*i+koff];
+            f[2*i+koff] = t1;
+            f[1+2*i+koff] = t2;
+         }
+      }
+/* then transform in y */
+      ns = 1;
+      for (l = 0; l < indy; l++) {
+         ns2 = ns + ns;
+         km = nyh/ns;
+         kmr = km*nry;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = 2*nxhd*(j + k1);
+               j2 = 2*nxhd*(j + k2);
+               t1 = sct[kmr*j];
+               t2 = t1*f[2*i+j2];
+               t3 = t1*f[1+2*i+j2];
+               f[2*i+j2] = f[2*i+j1] - t2;
+               f[1+2*i+j2] = f[1+2*i+j1] - t3;
+               f[2*i+j1] += t2;
+               f[1+2*i+j1] += t3;
+            }
+         }
+         ns = ns2;
+      }
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - koff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = f[jj+k1];
+            f[jj+k1] = 0.5*(cimagf(f[jj+koff] + t1)
+                        + crealf(f[jj+koff] - t1)*_Complex_I);
+            f[jj+koff] = 0.5*(crealf(f[jj+koff] + t1)
+                          + cimagf(f[jj+koff] - t1)*_Complex_I);
+         }
+      }
+   }
+   return;
+/* forward fourier transform */
+L80: nryb = nxhy/ny;
+   nry = nxy/ny;
+/* scramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - koff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = cimagf(f[jj+k1]) + crealf(f[jj+k1])*_Complex_I;
+            f[jj+k1] = conjf(f[jj+koff] - t1);
+            f[jj+koff] += t1;
+         }
+      }
+   }
+#pragma omp parallel for \
+private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,koff,t1,t2,t3)
+   for (i = nxi-1; i < nxt; i++) {
+/* bit-reverse array elements in y */
+      for (k = 0; k < ny; k++) {
+         koff = 2*nxhd*k;
+         k1 = (mixup[k] - 1)/nryb;
+         if (k < k1) {
+            k1 = 2*nxhd*k1;
+            t1 = f[2*i+k1];
+            t2 = f[1+2*i+k1];
+            f[2*i+k1] = f[2*i+koff];
+            f[1+2*i+k1] = f[1+2*i+koff];
+            f[2*i+koff] = t1;
+            f[1+2*i+koff] = t2;
+         }
+      }
+/* then transform in y */
+      ns = 1;
+      for (l = 0; l < indy; l++) {
+         ns2 = ns + ns;
+         km = nyh/ns;
+         kmr = km*nry;
+         for (k = 0; k < km; k++) {
+            k1 = ns2*k;
+            k2 = k1 + ns;
+            for (j = 0; j < ns; j++) {
+               j1 = 2*nxhd*(j + k1);
+               j2 = 2*nxhd*(j + k2);
+               t1 = conjf(sct[kmr*j]);
+               t2 = t1*f[2*i+j2];
+               t3 = t1*f[1+2*i+j2];
+               f[2*i+j2] = f[2*i+j1] - t2;
+               f[1+2*i+j2] = f[1+2*i+j1] - t3;
+               f[2*i+j1] += t2;
+               f[1+2*i+j1] += t3;
+            }
+         }
+         ns = ns2;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rmx(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd) {
+/* wrapper function for real to complex fft, with packed data */
+/* parallelized with OpenMP */
+/* local data */
+   int nxh, ny;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2rmxx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform y fft */
+      cfft2rmxy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2rmxy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform x fft */
+      cfft2rmxx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rm2(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd) {
+/* wrapper function for 2 2d real to complex ffts, with packed data */
+/* parallelized with OpenMP */
+/* local data */
+   int nxh, ny;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2rm2x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform y fft */
+      cfft2rm2y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2rm2y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform x fft */
+      cfft2rm2x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft1rm4(float complex f[], int isign, int mixup[],
+              float complex sct[], int indn, int nrb, int nr, int ld,
+              int nb) {
+/* this subroutine performs nb complex fast fourier transforms of
+   length n = 2**indn, using radix-4 butterflies, with a final radix-2
+   stage if indn is odd.  the nb transforms are stored in adjacent
+   locations, so that the innermost loop is over the transforms and
+   can be vectorized.  used by the cache-blocked ffts below.
+   the data are not normalized.
+   for isign = (-1,1), input: all, output: f
+   if isign = -1, f[m*ld+i] = sum(f[k*ld+i]*exp(-sqrt(-1)*2pi*m*k/n))
+   if isign = 1, f[m*ld+i] = sum(f[k*ld+i]*exp(sqrt(-1)*2pi*m*k/n))
+   where 0 <= i < nb
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   indn = exponent which determines length of transform, n=2**indn
+   nrb = ratio of size of mixup table to n
+   nr = ratio of twice the size of sct table to n
+   ld = distance between successive elements of a transform
+   nb = number of transforms
+local data                                                            */
+   int n, nh, ns, ns4, l, k, j, m, i, km, kmr, kmr2, k1, m1;
+   int j0, j1, j2, j3;
+   float wr1, wi1, wr2, wi2, wr3, wi3, sg;
+   float ar, ai, br, bi, cr, ci, dr, di, tr, ti;
+   float complex t1;
+   float *fr;
+   fr = (float *) f;
+   n = 1L<<indn;
+   nh = n/2;
+   sg = isign < 0 ? 1.0f : -1.0f;
+/* bit-reverse array elements */
+   for (m = 0; m < n; m++) {
+      m1 = (mixup[m] - 1)/nrb;
+      if (m < m1) {
+         for (i = 0; i < nb; i++) {
+            t1 = f[i+ld*m1];
+            f[i+ld*m1] = f[i+ld*m];
+            f[i+ld*m] = t1;
+         }
+      }
+   }
+/* radix-4 stages, each equivalent to two radix-2 stages */
+   ns = 1;
+   l = 0;
+   while ((l+1) < indn) {
+      ns4 = 4*ns;
+      km = n/ns4;
+      kmr = (nh/ns)*nr;
+      kmr2 = kmr/2;
+      for (k = 0; k < km; k++) {
+         k1 = ns4*k;
+         for (j = 0; j < ns; j++) {
+            wr1 = crealf(sct[kmr*j]);
+            wi1 = sg*cimagf(sct[kmr*j]);
+            wr2 = crealf(sct[kmr2*j]);
+            wi2 = sg*cimagf(sct[kmr2*j]);
+            wr3 = crealf(sct[kmr2*(j+ns)]);
+            wi3 = sg*cimagf(sct[kmr2*(j+ns)]);
+            j0 = 2*ld*(j + k1);
+            j1 = j0 + 2*ld*ns;
+            j2 = j1 + 2*ld*ns;
+            j3 = j2 + 2*ld*ns;
+            for (i = 0; i < 2*nb; i += 2) {
+/* first radix-2 stage */
+               tr = wr1*fr[i+j1] - wi1*fr[i+1+j1];
+               ti = wr1*fr[i+1+j1] + wi1*fr[i+j1];
+               ar = fr[i+j0] + tr;
+               ai = fr[i+1+j0] + ti;
+               br = fr[i+j0] - tr;
+               bi = fr[i+1+j0] - ti;
+               tr = wr1*fr[i+j3] - wi1*fr[i+1+j3];
+               ti = wr1*fr[i+1+j3] + wi1*fr[i+j3];
+               cr = fr[i+j2] + tr;
+               ci = fr[i+1+j2] + ti;
+               dr = fr[i+j2] - tr;
+               di = fr[i+1+j2] - ti;
+/* second radix-2 stage */
+               tr = wr2*cr - wi2*ci;
+               ti = wr2*ci + wi2*cr;
+               fr[i+j0] = ar + tr;
+               fr[i+1+j0] = ai + ti;
+               fr[i+j2] = ar - tr;
+               fr[i+1+j2] = ai - ti;
+               tr = wr3*dr - wi3*di;
+               ti = wr3*di + wi3*dr;
+               fr[i+j1] = br + tr;
+               fr[i+1+j1] = bi + ti;
+               fr[i+j3] = br - tr;
+               fr[i+1+j3] = bi - ti;
+            }
+         }
+      }
+      ns = ns4;
+      l += 2;
+   }
+/* final radix-2 stage */
+   if (l < indn) {
+      kmr = (nh/ns)*nr;
+      for (j = 0; j < ns; j++) {
+         wr1 = crealf(sct[kmr*j]);
+         wi1 = sg*cimagf(sct[kmr*j]);
+         j0 = 2*ld*j;
+         j1 = j0 + 2*ld*ns;
+         for (i = 0; i < 2*nb; i += 2) {
+            tr = wr1*fr[i+j1] - wi1*fr[i+1+j1];
+            ti = wr1*fr[i+1+j1] + wi1*fr[i+j1];
+            fr[i+j1] = fr[i+j0] - tr;
+            fr[i+1+j1] = fr[i+1+j0] - ti;
+            fr[i+j0] += tr;
+            fr[i+1+j0] += ti;
+         }
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2r4xx(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of a two dimensional real to
+   complex fast fourier transform and its inverse, for a subset of y,
+   using radix-4 butterflies, with OpenMP
+   same as cfft2rmxx, except for the butterflies, see cfft1rm4
+   for isign = (-1,1), input: all, output: f
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, an inverse fourier transform in x is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*exp(-sqrt(-1)*2pi*n*j/nx))
+   if isign = 1, a forward fourier transform in x is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as for cfft2rmxx
+local data                                                            */
+   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
+   int nrx, i, j, kmr, nrxb, joff;
+   float ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   nxh = nx/2;
+   nxhh = nx/4;
+   ny = 1L<<indy;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nyt = nyi + nyp - 1;
+   nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+   if (isign > 0)
+      goto L70;
+/* inverse fourier transform */
+#pragma omp parallel for private(i,j,kmr,joff,ani,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = nxhd*i;
+/* bit-reverse and transform in x */
+      cfft1rm4(&f[joff],isign,mixup,sct,indx1,nrxb,nrx,1,1);
+/* unscramble coefficients and normalize */
+      kmr = nxy/nx;
+      ani = 0.5/(((float) nx)*((float) ny));
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
+         t2 = conjf(f[nxh-j+joff]);
+         t1 = f[j+joff] + t2;
+         t2 = (f[j+joff] - t2)*t3;
+         f[j+joff] = ani*(t1 + t2);
+         f[nxh-j+joff] = ani*conjf(t1 - t2);
+      }
+      ani = 2.0*ani;
+      f[nxhh+joff] = ani*conjf(f[nxhh+joff]);
+      f[joff] = ani*((crealf(f[joff]) + cimagf(f[joff]))
+                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I);
+   }
+   return;
+/* forward fourier transform */
+L70:
+#pragma omp parallel for private(i,j,kmr,joff,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = nxhd*i;
+/* scramble coefficients */
+      kmr = nxy/nx;
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
+         t2 = conjf(f[nxh-j+joff]);
+         t1 = f[j+joff] + t2;
+         t2 = (f[j+joff] - t2)*t3;
+         f[j+joff] = t1 + t2;
+         f[nxh-j+joff] = conjf(t1 - t2);
+      }
+      f[nxhh+joff] = 2.0*conjf(f[nxhh+joff]);
+      f[joff] = (crealf(f[joff]) + cimagf(f[joff]))
+                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I;
+/* bit-reverse and transform in x */
+      cfft1rm4(&f[joff],isign,mixup,sct,indx1,nrxb,nrx,1,1);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2r4xy(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of a two dimensional real to
+   complex fast fourier transform and its inverse, for a subset of x,
+   using radix-4 butterflies, with OpenMP
+   same as cfft2rmxy, except that the y transforms are performed in
+   blocks of NXB adjacent x indices, so that each block of the array
+   stays in cache during the transform, and the innermost loops are over
+   contiguous memory.  see cfft1rm4
+   for isign = (-1,1), input: all, output: f
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, an inverse fourier transform in y is performed
+   f[m][n] = sum(f[k][j]*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform in y is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as for cfft2rmxy
+local data                                                            */
+#define NXB             16
+   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
+   int nry, nryb, i, k, k1, koff, nb, nxb;
+   float complex t1;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   ny = 1L<<indy;
+   nyh = ny/2;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nxt = nxi + nxp - 1;
+   nryb = nxhy/ny;
+   nry = nxy/ny;
+/* number of blocks of x indices */
+   nxb = (nxp - 1)/NXB + 1;
+   if (isign > 0)
+      goto L70;
+/* inverse fourier transform */
+#pragma omp parallel for private(i,nb)
+   for (i = 0; i < nxb; i++) {
+      nb = nxt - (nxi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* bit-reverse and transform in y */
+      cfft1rm4(&f[nxi-1+NXB*i],isign,mixup,sct,indy,nryb,nry,nxhd,nb);
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = nxhd*k;
+         k1 = nxhd*ny - koff;
+         t1 = f[k1];
+         f[k1] = 0.5*(cimagf(f[koff] + t1)
+                  + crealf(f[koff] - t1)*_Complex_I);
+         f[koff] = 0.5*(crealf(f[koff] + t1)
+                    + cimagf(f[koff] - t1)*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+/* scramble modes kx = 0, nx/2 */
+L70: if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = nxhd*k;
+         k1 = nxhd*ny - koff;
+         t1 = cimagf(f[k1]) + crealf(f[k1])*_Complex_I;
+         f[k1] = conjf(f[koff] - t1);
+         f[koff] += t1;
+      }
+   }
+#pragma omp parallel for private(i,nb)
+   for (i = 0; i < nxb; i++) {
+      nb = nxt - (nxi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* bit-reverse and transform in y */
+      cfft1rm4(&f[nxi-1+NXB*i],isign,mixup,sct,indy,nryb,nry,nxhd,nb);
+   }
+   return;
+#undef NXB
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2r42x(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of 2 two dimensional real to
+   complex fast fourier transforms, and their inverses, for a subset of
+   y, using radix-4 butterflies, with OpenMP
+   same as cfft2rm2x, except for the butterflies, see cfft1rm4
+   for isign = (-1,1), input: all, output: f
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*n*j/nx))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as for cfft2rm2x
+local data                                                            */
+   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
+   int nrx, i, j, jj, kmr, nrxb, joff;
+   float at1, ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   nxh = nx/2;
+   nxhh = nx/4;
+   ny = 1L<<indy;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nyt = nyi + nyp - 1;
+   nrxb = nxhy/nxh;
+   nrx = nxy/nxh;
+   if (isign > 0)
+      goto L100;
+/* inverse fourier transform */
+#pragma omp parallel for private(i,j,jj,kmr,joff,at1,ani,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = 2*nxhd*i;
+/* swap complex components */
       for (j = 0; j < nxh; j++) {
-         dkx = dnx*(float) j;
-         at3 = dkx*dkx + at1;
-         at4 = exp(-0.5*(pow((dkx*ax),2) + at2));
-         if (at3==0.0) {
-            ffc[j+kk] = affp + 1.0*_Complex_I;
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+       }
+/* bit-reverse and transform in x */
+      cfft1rm4(&f[joff],isign,mixup,sct,indx1,nrxb,nrx,2,2);
+/* unscramble coefficients and normalize */
+      kmr = nxy/nx;
+      ani = 0.5/(((float) nx)*((float) ny));
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = ani*(t1 + t2);
+            f[jj+2*(nxh-j)+joff] = ani*conjf(t1 - t2);
          }
-         else {
-            ffc[j+kk] = (affp*at4/at3) + at4*_Complex_I;
+      }
+      ani = 2.0*ani;
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = ani*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = ani*((crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+L100:
+#pragma omp parallel for private(i,j,jj,kmr,joff,at1,t1,t2,t3)
+   for (i = nyi-1; i < nyt; i++) {
+      joff = 2*nxhd*i;
+/* scramble coefficients */
+      kmr = nxy/nx;
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = t1 + t2;
+            f[jj+2*(nxh-j)+joff] = conjf(t1 - t2);
+         }
+      }
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = 2.0*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = (crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I;
+      }
+/* bit-reverse and transform in x */
+      cfft1rm4(&f[joff],isign,mixup,sct,indx1,nrxb,nrx,2,2);
+/* swap complex components */
+      for (j = 0; j < nxh; j++) {
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2r42y(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of 2 two dimensional real to
+   complex fast fourier transforms, and their inverses, for a subset of
+   x, using radix-4 butterflies, with OpenMP
+   same as cfft2rm2y, except that the y transforms are performed in
+   blocks of NXB adjacent x indices, as in cfft2r4xy
+   for isign = (-1,1), input: all, output: f
+   indx/indy = exponent which determines length in x/y direction,
+   where nx=2**indx, ny=2**indy
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of bit reversed addresses
+   sct = sine/cosine table
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = maximum of (nx/2,ny)
+   nxyhd = maximum of (nx,ny)/2
+   fourier coefficients are stored as for cfft2rm2y
+local data                                                            */
+#define NXB             16
+   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
+   int nry, nryb, i, k, k1, jj, koff, nb, nxb;
+   float complex t1;
+   if (isign==0)
+      return;
+   indx1 = indx - 1;
+   indx1y = indx1 > indy ? indx1 : indy;
+   nx = 1L<<indx;
+   ny = 1L<<indy;
+   nyh = ny/2;
+   nxy = nx > ny ? nx : ny;
+   nxhy = 1L<<indx1y;
+   nxt = nxi + nxp - 1;
+   nryb = nxhy/ny;
+   nry = nxy/ny;
+/* number of blocks of x indices, both components in each block */
+   nxb = (2*nxp - 1)/NXB + 1;
+   if (isign > 0)
+      goto L80;
+/* inverse fourier transform */
+#pragma omp parallel for private(i,nb)
+   for (i = 0; i < nxb; i++) {
+      nb = 2*nxt - (2*(nxi - 1) + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* bit-reverse and transform in y */
+      cfft1rm4(&f[2*(nxi-1)+NXB*i],isign,mixup,sct,indy,nryb,nry,
+               2*nxhd,nb);
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - koff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = f[jj+k1];
+            f[jj+k1] = 0.5*(cimagf(f[jj+koff] + t1)
+                        + crealf(f[jj+koff] - t1)*_Complex_I);
+            f[jj+koff] = 0.5*(crealf(f[jj+koff] + t1)
+                          + cimagf(f[jj+koff] - t1)*_Complex_I);
+         }
+      }
+   }
+   return;
+/* forward fourier transform */
+/* scramble modes kx = 0, nx/2 */
+L80: if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         koff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - koff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = cimagf(f[jj+k1]) + crealf(f[jj+k1])*_Complex_I;
+            f[jj+k1] = conjf(f[jj+koff] - t1);
+            f[jj+koff] += t1;
          }
       }
    }
-   return;
-/* calculate force/charge and sum field energy */
-L30: sum1 = 0.0;
-#pragma omp parallel for \
-private(j,k,k1,kk,kj,dky,at1,at2,at3,zt1,zt2,wp) \
-reduction(+:sum1)
-/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
-   for (k = 1; k < nyh; k++) {
-      k1 = ny - k;
-      dky = dny*(float) k;
-      kk = nxhd*k;
-      kj = nxvh*k;
-      k1 = nxvh*ny - kj;
-      wp = 0.0;
-      for (j = 1; j < nxh; j++) {
-         at1 = crealf(ffc[j+kk])*cimagf(ffc[j+kk]);
-         at2 = at1*dnx*(float) j;
-         at3 = dky*at1;
-         zt1 = cimagf(q[j+kj]) - crealf(q[j+kj])*_Complex_I;
-         zt2 = cimagf(q[j+k1]) - crealf(q[j+k1])*_Complex_I;
-         fxy[2*j+2*kj] = at2*zt1;
-         fxy[1+2*j+2*kj] = at3*zt1;
-         fxy[2*j+2*k1] = at2*zt2;
-         fxy[1+2*j+2*k1] = -at3*zt2;
-         wp += at1*(q[j+kj]*conjf(q[j+kj]) + q[j+k1]*conjf(q[j+k1]));
+#pragma omp parallel for private(i,nb)
+   for (i = 0; i < nxb; i++) {
+      nb = 2*nxt - (2*(nxi - 1) + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* bit-reverse and transform in y */
+      cfft1rm4(&f[2*(nxi-1)+NXB*i],isign,mixup,sct,indy,nryb,nry,
+               2*nxhd,nb);
+   }
+   return;
+#undef NXB
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2r4x(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd) {
+/* wrapper function for real to complex fft, with packed data */
+/* cache-blocked radix-4 version of cwfft2rmx */
+/* parallelized with OpenMP */
+/* local data */
+   int nxh, ny;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2r4xx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform y fft */
+      cfft2r4xy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2r4xy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform x fft */
+      cfft2r4xx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2r42(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd) {
+/* wrapper function for 2 2d real to complex ffts, with packed data */
+/* cache-blocked radix-4 version of cwfft2rm2 */
+/* parallelized with OpenMP */
+/* local data */
+   int nxh, ny;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = 1L<<(indx - 1);
+   ny = 1L<<indy;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2r42x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform y fft */
+      cfft2r42y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2r42y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
+                nxyhd);
+/* perform x fft */
+      cfft2r42x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
+                nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+int cfft1nfac(int n, int nfac[]) {
+/* this subroutine finds the factors used by the mixed radix ffts, in
+   the order in which the transform stages are performed: factors of 4
+   first, then 2, 3 and 5.  returns the number of factors, or 0 if n
+   has prime factors other than 2, 3 and 5
+   n = length of transform
+   nfac = array of factors, must be dimensioned >= 32
+local data                                                            */
+   int m, nf;
+   if (n < 1)
+      return 0;
+   m = n;
+   nf = 0;
+   while ((m%4)==0) {
+      nfac[nf++] = 4;
+      m = m/4;
+   }
+   if ((m%2)==0) {
+      nfac[nf++] = 2;
+      m = m/2;
+   }
+   while ((m%3)==0) {
+      nfac[nf++] = 3;
+      m = m/3;
+   }
+   while ((m%5)==0) {
+      nfac[nf++] = 5;
+      m = m/5;
+   }
+   if (m != 1)
+      return 0;
+   return nf;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft1rnx(float complex f[], float complex g[], int isign,
+              int mixup[], float complex sct[], int n, int nrs, int ld,
+              int lb, int nb) {
+/* this subroutine performs nb complex fast fourier transforms of
+   length n, where n has no prime factors other than 2, 3 and 5, using
+   a mixed radix (2,3,4,5) decimation in time algorithm.  the data are
+   copied in digit reversed order to the scratch array g, where element
+   m of transform i is stored in g[i+nb*m], so that the innermost loop
+   is over the transforms, transformed, and copied back to f.
+   the data are not normalized.
+   for isign = (-1,1), input: all, output: f
+   if isign = -1, f[m*ld+i*lb] = sum(f[k*ld+i*lb]*exp(-sqrt(-1)*2pi*m*k/n))
+   if isign = 1, f[m*ld+i*lb] = sum(f[k*ld+i*lb]*exp(sqrt(-1)*2pi*m*k/n))
+   where 0 <= i < nb
+   g = scratch array, must be dimensioned >= n*nb
+   mixup = array of digit reversed addresses for n
+   sct = sine/cosine table, sct[j] = exp(-sqrt(-1)*2pi*j/(n*nrs)),
+   for 0 <= j < n*nrs/2
+   nrs = ratio of length of period of sct table to n, n*nrs must be even
+   ld = distance between successive elements of a transform in f
+   lb = distance between successive transforms in f
+   nb = number of transforms
+local data                                                            */
+   int nf, nl, ns, nr, km, kmr, k, j, l, m, i, e, p, k0, nh;
+   int nfac[32];
+   float sg, c1, c2, s1, s2;
+   float wr[4], wi[4];
+   float a0r, a0i, a1r, a1i, a2r, a2i, a3r, a3i, a4r, a4i;
+   float t1r, t1i, t2r, t2i, t3r, t3i, t4r, t4i, tr, ti;
+   float *gr;
+   gr = (float *) g;
+   nf = cfft1nfac(n,nfac);
+   nh = (n*nrs)/2;
+   sg = isign < 0 ? 1.0f : -1.0f;
+/* copy array elements in digit reversed order */
+   for (m = 0; m < n; m++) {
+      j = mixup[m] - 1;
+      for (i = 0; i < nb; i++) {
+         g[i+nb*m] = f[ld*j+lb*i];
+      }
+   }
+/* perform one stage for each factor */
+   ns = 1;
+   for (l = 0; l < nf; l++) {
+      nr = nfac[l];
+      nl = ns*nr;
+      km = n/nl;
+      kmr = km*nrs;
+      for (k = 0; k < km; k++) {
+         k0 = nl*k;
+         for (j = 0; j < ns; j++) {
+/* find twiddle factors exp(-sqrt(-1)*2pi*p*j/nl), 0 < p < nr */
+            for (p = 1; p < nr; p++) {
+               e = kmr*p*j;
+               if (e < nh) {
+                  wr[p-1] = crealf(sct[e]);
+                  wi[p-1] = sg*cimagf(sct[e]);
+               }
+               else {
+                  wr[p-1] = -crealf(sct[e-nh]);
+                  wi[p-1] = -sg*cimagf(sct[e-nh]);
+               }
+            }
+            m = 2*nb*(j + k0);
+            e = 2*nb*ns;
+/* radix 2 butterfly */
+            if (nr==2) {
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  gr[i+m] = a0r + a1r;
+                  gr[i+1+m] = a0i + a1i;
+                  gr[i+m+e] = a0r - a1r;
+                  gr[i+1+m+e] = a0i - a1i;
+               }
+            }
+/* radix 4 butterfly */
+            else if (nr==4) {
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  a3r = wr[2]*gr[i+m+3*e] - wi[2]*gr[i+1+m+3*e];
+                  a3i = wr[2]*gr[i+1+m+3*e] + wi[2]*gr[i+m+3*e];
+                  t1r = a0r + a2r;
+                  t1i = a0i + a2i;
+                  t2r = a0r - a2r;
+                  t2i = a0i - a2i;
+                  t3r = a1r + a3r;
+                  t3i = a1i + a3i;
+                  t4r = sg*(a1r - a3r);
+                  t4i = sg*(a1i - a3i);
+                  gr[i+m] = t1r + t3r;
+                  gr[i+1+m] = t1i + t3i;
+                  gr[i+m+e] = t2r + t4i;
+                  gr[i+1+m+e] = t2i - t4r;
+                  gr[i+m+2*e] = t1r - t3r;
+                  gr[i+1+m+2*e] = t1i - t3i;
+                  gr[i+m+3*e] = t2r - t4i;
+                  gr[i+1+m+3*e] = t2i + t4r;
+               }
+            }
+/* radix 3 butterfly */
+            else if (nr==3) {
+               s1 = sg*0.866025403784439;
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  t1r = a1r + a2r;
+                  t1i = a1i + a2i;
+                  t2r = s1*(a1r - a2r);
+                  t2i = s1*(a1i - a2i);
+                  tr = a0r - 0.5f*t1r;
+                  ti = a0i - 0.5f*t1i;
+                  gr[i+m] = a0r + t1r;
+                  gr[i+1+m] = a0i + t1i;
+                  gr[i+m+e] = tr + t2i;
+                  gr[i+1+m+e] = ti - t2r;
+                  gr[i+m+2*e] = tr - t2i;
+                  gr[i+1+m+2*e] = ti + t2r;
+               }
+            }
+/* radix 5 butterfly */
+            else {
+               c1 = 0.309016994374947;
+               c2 = -0.809016994374947;
+               s1 = sg*0.951056516295154;
+               s2 = sg*0.587785252292473;
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  a3r = wr[2]*gr[i+m+3*e] - wi[2]*gr[i+1+m+3*e];
+                  a3i = wr[2]*gr[i+1+m+3*e] + wi[2]*gr[i+m+3*e];
+                  a4r = wr[3]*gr[i+m+4*e] - wi[3]*gr[i+1+m+4*e];
+                  a4i = wr[3]*gr[i+1+m+4*e] + wi[3]*gr[i+m+4*e];
+                  t1r = a1r + a4r;
+                  t1i = a1i + a4i;
+                  t2r = a2r + a3r;
+                  t2i = a2i + a3i;
+                  t3r = a1r - a4r;
+                  t3i = a1i - a4i;
+                  t4r = a2r - a3r;
+                  t4i = a2i - a3i;
+                  gr[i+m] = a0r + t1r + t2r;
+                  gr[i+1+m] = a0i + t1i + t2i;
+                  tr = a0r + c1*t1r + c2*t2r;
+                  ti = a0i + c1*t1i + c2*t2i;
+                  a1r = s1*t3r + s2*t4r;
+                  a1i = s1*t3i + s2*t4i;
+                  gr[i+m+e] = tr + a1i;
+                  gr[i+1+m+e] = ti - a1r;
+                  gr[i+m+4*e] = tr - a1i;
+                  gr[i+1+m+4*e] = ti + a1r;
+                  tr = a0r + c2*t1r + c1*t2r;
+                  ti = a0i + c2*t1i + c1*t2i;
+                  a1r = s2*t3r - s1*t4r;
+                  a1i = s2*t3i - s1*t4i;
+                  gr[i+m+2*e] = tr + a1i;
+                  gr[i+1+m+2*e] = ti - a1r;
+                  gr[i+m+3*e] = tr - a1i;
+                  gr[i+1+m+3*e] = ti + a1r;
+               }
+            }
+         }
       }
-      at1 = crealf(ffc[kk])*cimagf(ffc[kk]);
-      at3 = at1*dny*(float) k;
-      zt1 = cimagf(q[kj]) - crealf(q[kj])*_Complex_I;
-      fxy[2*kj] = zero;
-      fxy[1+2*kj] = at3*zt1;
-      fxy[2*k1] = zero;
-      fxy[1+2*k1] = zero;
-      wp += at1*(q[kj]*conjf(q[kj]));
-      sum1 += wp;
+      ns = nl;
    }
-   wp = 0.0;
-/* mode numbers ky = 0, ny/2 */
-   k1 = 2*nxvh*nyh;
-   for (j = 1; j < nxh; j++) {
-      at1 = crealf(ffc[j])*cimagf(ffc[j]);
-      at2 = at1*dnx*(float) j;  
-      zt1 = cimagf(q[j]) - crealf(q[j])*_Complex_I;
-      fxy[2*j] = at2*zt1;
-      fxy[1+2*j] = zero;
-      fxy[2*j+k1] = zero;
-      fxy[1+2*j+k1] = zero;
-      wp += at1*(q[j]*conjf(q[j]));
+/* copy array elements back */
+   for (m = 0; m < n; m++) {
+      for (i = 0; i < nb; i++) {
+         f[ld*m+lb*i] = g[i+nb*m];
+      }
    }
-   fxy[0] = zero;
-   fxy[1] = zero;
-   fxy[k1] = zero;
-   fxy[1+k1] = zero;
-   sum1 += wp;
-   *we = sum1*(float) (nx*ny);
    return;
 }
 
 /*--------------------------------------------------------------------*/
-void cwfft2rinit(int mixup[], float complex sct[], int indx, int indy, 
-                 int nxhyd, int nxyhd) {
+void cwfft2rninit(int mixup[], float complex sct[], int nx, int ny,
+                  int nxhyd, int nxyhd) {
 /* this subroutine calculates tables needed by a two dimensional
-   real to complex fast fourier transform and its inverse.
-   input: indx, indy, nxhyd, nxyhd
+   real to complex mixed radix fast fourier transform and its inverse.
+   input: nx, ny, nxhyd, nxyhd
    output: mixup, sct
-   mixup = array of bit reversed addresses
-   sct = sine/cosine table
-   indx/indy = exponent which determines length in x/y direction,
-   where nx=2**indx, ny=2**indy
-   nxhyd = maximum of (nx/2,ny)
-   nxyhd = one half of maximum of (nx,ny)
-   written by viktor k. decyk, ucla
+   mixup = array of digit reversed addresses, for x in mixup[j],
+   0 <= j < nx/2, for y in mixup[nx/2+k], 0 <= k < ny
+   sct = sine/cosine table, for x in sct[j] = exp(-sqrt(-1)*2pi*j/nx),
+   0 <= j < nx/2, for y in sct[nx/2+k] = exp(-sqrt(-1)*2pi*k/ny),
+   0 <= k < ny/2
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5,
+   see cfft1nfac
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
 local data                                                            */
-   int indx1, indx1y, nx, ny, nxy, nxhy, nxyh;
-   int j, k, lb, ll, jb, it;
-   float dnxy, arg;
-   indx1 = indx - 1;
-   indx1y = indx1 > indy ? indx1 : indy;
-   nx = 1L<<indx;
-   ny = 1L<<indy;
-   nxy = nx > ny ? nx : ny;
-   nxhy = 1L<<indx1y;
-/* bit-reverse index table: mixup[j] = 1 + reversed bits of j */
-   for (j = 0; j < nxhy; j++) {
-      lb = j;
-      ll = 0;
-      for (k = 0; k < indx1y; k++) {
-         jb = lb/2;
-         it = lb - 2*jb;
-         lb = jb;
-         ll = 2*ll + it;
+   int nxh, nyh, n, noff, nf, i, j, k, m, lb, ll;
+   int nfac[32];
+   float dnx, arg;
+   nxh = nx/2;
+   nyh = ny/2;
+/* digit reversed index table: mixup[j] = 1 + reversed digits of j */
+   for (i = 0; i < 2; i++) {
+      n = i==0 ? nxh : ny;
+      noff = i==0 ? 0 : nxh;
+      nf = cfft1nfac(n,nfac);
+      for (j = 0; j < n; j++) {
+         lb = j;
+         ll = 0;
+         for (k = 0; k < nf; k++) {
+            m = lb/nfac[k];
+            ll = nfac[k]*ll + (lb - nfac[k]*m);
+            lb = m;
+         }
+         mixup[j+noff] = ll + 1;
       }
-      mixup[j] = ll + 1;
    }
-/* sine/cosine table for the angles 2*n*pi/nxy */
-   nxyh = nxy/2;
-   dnxy = 6.28318530717959/(float) nxy;
-   for (j = 0; j < nxyh; j++) {
-      arg = dnxy*(float) j;
+/* sine/cosine tables for the angles 2*n*pi/nx and 2*n*pi/ny */
+   dnx = 6.28318530717959/(float) nx;
+   for (j = 0; j < nxh; j++) {
+      arg = dnx*(float) j;
       sct[j] = cosf(arg) - sinf(arg)*_Complex_I;
    }
+   dnx = 6.28318530717959/(float) ny;
+   for (k = 0; k < nyh; k++) {
+      arg = dnx*(float) k;
+      sct[k+nxh] = cosf(arg) - sinf(arg)*_Complex_I;
+   }
    return;
 }
 
 /*--------------------------------------------------------------------*/
-void cfft2rmxx(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nyi,
-               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+void cfft2rmnxx(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nyi, int nyp,
+                int nxhd, int nyd, int nxhyd, int nxyhd) {
 /* this subroutine performs the x part of a two dimensional real to
-   complex fast fourier transform and its inverse, for a subset of y,
-   using complex arithmetic, with OpenMP
+   complex mixed radix fast fourier transform and its inverse, for a
+   subset of y, using complex arithmetic, with OpenMP
+   same as cfft2rmxx, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in x are performed in blocks of NXB rows by cfft1rnx
    for isign = (-1,1), input: all, output: f
-   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
-   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
-   where N = (nx/2)*ny
-   indx/indy = exponent which determines length in x/y direction,
-   where nx=2**indx, ny=2**indy
-   if isign = -1, an inverse fourier transform in x is performed
-   f[m][n] = (1/nx*ny)*sum(f[k][j]*exp(-sqrt(-1)*2pi*n*j/nx))
-   if isign = 1, a forward fourier transform in x is performed
-   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx))
-   mixup = array of bit reversed addresses
-   sct = sine/cosine table
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, an inverse fourier transform is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx)*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
    nyi = initial y index used
    nyp = number of y indices used
    nxhd = first dimension of f >= nx/2
    nyd = second dimension of f >= ny
-   nxhyd = maximum of (nx/2,ny)
-   nxyhd = maximum of (nx,ny)/2
-   fourier coefficients are stored as follows:
-   f[k][j] = real, imaginary part of mode j,k, where
-   0 <= j < nx/2 and 0 <= k < ny, except for
-   f[k][1] = real, imaginary part of mode nx/2,k, where
-   ny/2+1 <= k < ny, and
-   imag(f[0][0]) = real part of mode nx/2,0 and
-   imag(f[0][ny/2]) = real part of mode nx/2,ny/2
-   written by viktor k. decyk, ucla
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rmxx
 local data                                                            */
-   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
-   int nrx, i, j, k, l, j1, j2, k1, k2, ns, ns2, km, kmr, nrxb, joff;
+#define NXB             8
+   int nxh, nxhh, nyt, nyb, i, j, k, nb, joff;
    float ani;
    float complex t1, t2, t3;
    if (isign==0)
       return;
-   indx1 = indx - 1;
-   indx1y = indx1 > indy ? indx1 : indy;
-   nx = 1L<<indx;
    nxh = nx/2;
    nxhh = nx/4;
-   ny = 1L<<indy;
-   nxy = nx > ny ? nx : ny;
-   nxhy = 1L<<indx1y;
    nyt = nyi + nyp - 1;
+   nyb = (nyp - 1)/NXB + 1;
    if (isign > 0)
-      goto L70;
+      goto L60;
 /* inverse fourier transform */
-   nrxb = nxhy/nxh;
-   nrx = nxy/nxh;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,joff,ani,t1,t2,t3)
-   for (i = nyi-1; i < nyt; i++) {
-      joff = nxhd*i;
-/* bit-reverse array elements in x */
-      for (j = 0; j < nxh; j++) {
-         j1 = (mixup[j] - 1)/nrxb;
-         if (j < j1) {
-            t1 = f[j1+joff];
-            f[j1+joff] = f[j+joff];
-            f[j+joff] = t1;
-         }
-      }
-/* then transform in x */
-      ns = 1;
-      for (l = 0; l < indx1; l++) {
-         ns2 = ns + ns;
-         km = nxhh/ns;
-         kmr = km*nrx;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = j + k1;
-               j2 = j + k2;
-               t1 = sct[kmr*j];
-               t2 = t1*f[j2+joff];
-               f[j2+joff] = f[j1+joff] - t2;
-               f[j1+joff] += t2;
-            }
-         }
-         ns = ns2;
-      }
+#pragma omp parallel for private(i,j,k,nb,joff,ani,t1,t2,t3)
+   for (i = 0; i < nyb; i++) {
+      float complex g[NXB*nxh];
+      joff = nxhd*(nyi - 1 + NXB*i);
+      nb = nyt - (nyi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,1,nxhd,nb);
 /* unscramble coefficients and normalize */
-      kmr = nxy/nx;
-      ani = 0.5/(((float) nx)*((float) ny));
-      for (j = 1; j < nxhh; j++) {
-         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
-         t2 = conjf(f[nxh-j+joff]);
-         t1 = f[j+joff] + t2;
-         t2 = (f[j+joff] - t2)*t3;
-         f[j+joff] = ani*(t1 + t2);
-         f[nxh-j+joff] = ani*conjf(t1 - t2);
+      ani = 1.0/(float) (2*nx*ny);
+      for (k = 0; k < nb; k++) {
+         for (j = 1; j < nxhh; j++) {
+            t3 = cimagf(sct[j]) - crealf(sct[j])*_Complex_I;
+            t2 = conjf(f[nxh-j+joff]);
+            t1 = f[j+joff] + t2;
+            t2 = (f[j+joff] - t2)*t3;
+            f[j+joff] = ani*(t1 + t2);
+            f[nxh-j+joff] = ani*conjf(t1 - t2);
+         }
+         f[nxhh+joff] = 2.0*ani*conjf(f[nxhh+joff]);
+         f[joff] = 2.0*ani*((crealf(f[joff]) + cimagf(f[joff]))
+                   + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I);
+         joff += nxhd;
       }
-      ani = 2.0*ani;
-      f[nxhh+joff] = ani*conjf(f[nxhh+joff]);
-      f[joff] = ani*((crealf(f[joff]) + cimagf(f[joff]))
-                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I);
    }
    return;
 /* forward fourier transform */
-L70: nrxb = nxhy/nxh;
-   nrx = nxy/nxh;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,joff,t1,t2,t3)
-   for (i = nyi-1; i < nyt; i++) {
-      joff = nxhd*i;
+L60:
+#pragma omp parallel for private(i,j,k,nb,joff,t1,t2,t3)
+   for (i = 0; i < nyb; i++) {
+      float complex g[NXB*nxh];
+      joff = nxhd*(nyi - 1 + NXB*i);
+      nb = nyt - (nyi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
 /* scramble coefficients */
-      kmr = nxy/nx;
-      for (j = 1; j < nxhh; j++) {
-         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
-         t2 = conjf(f[nxh-j+joff]);
-         t1 = f[j+joff] + t2;
-         t2 = (f[j+joff] - t2)*t3;
-         f[j+joff] = t1 + t2;
-         f[nxh-j+joff] = conjf(t1 - t2);
-      }
-      f[nxhh+joff] = 2.0*conjf(f[nxhh+joff]);
-      f[joff] = (crealf(f[joff]) + cimagf(f[joff]))
-                + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I;
-/* bit-reverse array elements in x */
-      for (j = 0; j < nxh; j++) {
-         j1 = (mixup[j] - 1)/nrxb;
-         if (j < j1) {
-            t1 = f[j1+joff];
-            f[j1+joff] = f[j+joff];
-            f[j+joff] = t1;
-         }
-      }
-/* then transform in x */
-      ns = 1;
-      for (l = 0; l < indx1; l++) {
-         ns2 = ns + ns;
-         km = nxhh/ns;
-         kmr = km*nrx;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = j + k1;
-               j2 = j + k2;
-               t1 = conjf(sct[kmr*j]);
-               t2 = t1*f[j2+joff];
-               f[j2+joff] = f[j1+joff] - t2;
-               f[j1+joff] += t2;
-            }
+      for (k = 0; k < nb; k++) {
+         for (j = 1; j < nxhh; j++) {
+            t3 = cimagf(sct[j]) + crealf(sct[j])*_Complex_I;
+            t2 = conjf(f[nxh-j+joff]);
+            t1 = f[j+joff] + t2;
+            t2 = (f[j+joff] - t2)*t3;
+            f[j+joff] = t1 + t2;
+            f[nxh-j+joff] = conjf(t1 - t2);
          }
-         ns = ns2;
+         f[nxhh+joff] = 2.0*conjf(f[nxhh+joff]);
+         f[joff] = (crealf(f[joff]) + cimagf(f[joff]))
+                   + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I;
+         joff += nxhd;
       }
+/* transform in x */
+      joff = nxhd*(nyi - 1 + NXB*i);
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,1,nxhd,nb);
    }
    return;
+#undef NXB
 }
 
 /*--------------------------------------------------------------------*/
-void cfft2rmxy(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nxi,
-               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+void cfft2rmnxy(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxi, int nxp,
+                int nxhd, int nyd, int nxhyd, int nxyhd) {
 /* this subroutine performs the y part of a two dimensional real to
-   complex fast fourier transform and its inverse, for a subset of x,
-   using complex arithmetic, with OpenMP
+   complex mixed radix fast fourier transform and its inverse, for a
+   subset of x, using complex arithmetic, with OpenMP
+   same as cfft2rmxy, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in y are performed in blocks of NXB columns by
+   cfft1rnx
    for isign = (-1,1), input: all, output: f
-   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
-   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
-   where N = (nx/2)*ny
-   indx/indy = exponent which determines length in x/y direction,
-   where nx=2**indx, ny=2**indy
-   if isign = -1, an inverse fourier transform in y is performed
-   f[m][n] = sum(f[k][j]*exp(-sqrt(-1)*2pi*m*k/ny))
-   if isign = 1, a forward fourier transform in y is performed
-   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*m*k/ny))
-   mixup = array of bit reversed addresses
-   sct = sine/cosine table
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, an inverse fourier transform is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx)*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
    nxi = initial x index used
    nxp = number of x indices used
    nxhd = first dimension of f >= nx/2
    nyd = second dimension of f >= ny
-   nxhyd = maximum of (nx/2,ny)
-   nxyhd = maximum of (nx,ny)/2
-   fourier coefficients are stored as follows:
-   f[k][j] = real, imaginary part of mode j,k, where
-   0 <= j < nx/2 and 0 <= k < ny, except for
-   f[k][1] = real, imaginary part of mode nx/2,k, where
-   ny/2+1 <= k < ny, and
-   imag(f[0][0]) = real part of mode nx/2,0 and
-   imag(f[0][ny/2]) = real part of mode nx/2,ny/2
-   written by viktor k. decyk, ucla
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rmxy
 local data                                                            */
-   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
-   int nry, i, j, k, l, j1, j2, k1, k2, ns, ns2, km, kmr, nryb, koff;
-   float complex t1, t2;
+#define NXB             8
+   int nxh, nyh, nxt, nxb, i, k, k1, nb, joff;
+   float complex t1;
    if (isign==0)
       return;
-   indx1 = indx - 1;
-   indx1y = indx1 > indy ? indx1 : indy;
-   nx = 1L<<indx;
-   ny = 1L<<indy;
+   nxh = nx/2;
    nyh = ny/2;
-   nxy = nx > ny ? nx : ny;
-   nxhy = 1L<<indx1y;
    nxt = nxi + nxp - 1;
+   nxb = (nxp - 1)/NXB + 1;
    if (isign > 0)
-      goto L70;
+      goto L50;
 /* inverse fourier transform */
-   nryb = nxhy/ny;
-   nry = nxy/ny;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,koff,t1,t2)
-   for (i = nxi-1; i < nxt; i++) {
-/* bit-reverse array elements in y */
-      for (k = 0; k < ny; k++) {
-         koff = nxhd*k;
-         k1 = (mixup[k] - 1)/nryb;
-         if (k < k1) {
-            k1 = nxhd*k1;
-            t1 = f[i+k1];
-            f[i+k1] = f[i+koff];
-            f[i+koff] = t1;
-         }
-      }
-/* then transform in y */
-      ns = 1;
-      for (l = 0; l < indy; l++) {
-         ns2 = ns + ns;
-         km = nyh/ns;
-         kmr = km*nry;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = nxhd*(j + k1);
-               j2 = nxhd*(j + k2);
-               t1 = sct[kmr*j];
-               t2 = t1*f[i+j2];
-               f[i+j2] = f[i+j1] - t2;
-               f[i+j1] += t2;
-            }
-         }
-         ns = ns2;
-      }
+#pragma omp parallel for private(i,nb,joff)
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = nxi - 1 + NXB*i;
+      nb = nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,nxhd,1,nb);
    }
 /* unscramble modes kx = 0, nx/2 */
    if (nxi==1) {
       for (k = 1; k < nyh; k++) {
-         koff = nxhd*k;
-         k1 = nxhd*ny - koff;
+         joff = nxhd*k;
+         k1 = nxhd*ny - joff;
          t1 = f[k1];
-         f[k1] = 0.5*(cimagf(f[koff] + t1)
-                  + crealf(f[koff] - t1)*_Complex_I);
-         f[koff] = 0.5*(crealf(f[koff] + t1)
-                    + cimagf(f[koff] - t1)*_Complex_I);
+         f[k1] = 0.5*(cimagf(f[joff] + t1)
+                  + crealf(f[joff] - t1)*_Complex_I);
+         f[joff] = 0.5*(crealf(f[joff] + t1)
+                    + cimagf(f[joff] - t1)*_Complex_I);
       }
    }
    return;
 /* forward fourier transform */
-L70: nryb = nxhy/ny;
-   nry = nxy/ny;
 /* scramble modes kx = 0, nx/2 */
-   if (nxi==1) {
+L50: if (nxi==1) {
       for (k = 1; k < nyh; k++) {
-         koff = nxhd*k;
-         k1 = nxhd*ny - koff;
+         joff = nxhd*k;
+         k1 = nxhd*ny - joff;
          t1 = cimagf(f[k1]) + crealf(f[k1])*_Complex_I;
-         f[k1] = conjf(f[koff] - t1);
-         f[koff] += t1;
+         f[k1] = conjf(f[joff] - t1);
+         f[joff] += t1;
       }
    }
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,j1,j2,koff,t1,t2)
-   for (i = nxi-1; i < nxt; i++) {
-/* bit-reverse array elements in y */
-      for (k = 0; k < ny; k++) {
-         koff = nxhd*k;
-         k1 = (mixup[k] - 1)/nryb;
-         if (k < k1) {
-            k1 = nxhd*k1;
-            t1 = f[i+k1];
-            f[i+k1] = f[i+koff];
-            f[i+koff] = t1;
-         }
-      }
-/* then transform in y */
-      ns = 1;
-      for (l = 0; l < indy; l++) {
-         ns2 = ns + ns;
-         km = nyh/ns;
-         kmr = km*nry;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = nxhd*(j + k1);
-               j2 = nxhd*(j + k2);
-               t1 = conjf(sct[kmr*j]);
-               t2 = t1*f[i+j2];
-               f[i+j2] = f[i+j1] - t2;
-               f[i+j1] += t2;
-            }
-         }
-         ns = ns2;
-      }
+#pragma omp parallel for private(i,nb,joff)
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = nxi - 1 + NXB*i;
+      nb = nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,nxhd,1,nb);
    }
    return;
+#undef NXB
 }
 
 /*--------------------------------------------------------------------*/
-void cfft2rm2x(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nyi,
-               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+void cfft2rmn2x(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nyi, int nyp,
+                int nxhd, int nyd, int nxhyd, int nxyhd) {
 /* this subroutine performs the x part of 2 two dimensional real to
-   complex fast fourier transforms, and their inverses, for a subset of
-   y, using complex arithmetic, with OpenMP
+   complex mixed radix fast fourier transforms, and their inverses, for
+   a subset of y, using complex arithmetic, with OpenMP
+   same as cfft2rm2x, except that nx/ny may have prime factors 2, 3 and 5
    for isign = (-1,1), input: all, output: f
-   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
-   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
-   where N = (nx/2)*ny
-   indx/indy = exponent which determines length in x/y direction,
-   where nx=2**indx, ny=2**indy
-   if isign = -1, two inverse fourier transforms in x are performed
-   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*n*j/nx))
-   if isign = 1, two forward fourier transforms in x are performed
-   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx))
-   mixup = array of bit reversed addresses
-   sct = sine/cosine table
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx)*
+         exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
    nyi = initial y index used
    nyp = number of y indices used
    nxhd = second dimension of f >= nx/2
    nyd = third dimension of f >= ny
-   nxhyd = maximum of (nx/2,ny)
-   nxyhd = maximum of (nx,ny)/2
-   fourier coefficients are stored as follows:
-   f[k][j][0:1] = real, imaginary part of mode j,k, where
-   0 <= j < nx/2 and 0 <= k < ny, except for
-   f[k][1][0:1] = real, imaginary part of mode nx/2,k, where
-   ny/2+1 <= k < ny, and
-   imag(f[0][0][0:1]) = real part of mode nx/2,0 and
-   imag(f[0][ny/2][0:1]) = real part of mode nx/2,ny/2
-   written by viktor k. decyk, ucla
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rm2x
 local data                                                            */
-   int indx1, indx1y, nx, nxh, nxhh, ny, nxy, nxhy, nyt;
-   int nrx, i, j, k, l, jj, j1, j2, k1, k2, ns, ns2, km, kmr, joff;
-   int nrxb;
+   int nxh, nxhh, nyt, i, j, jj, joff;
    float at1, ani;
    float complex t1, t2, t3;
    if (isign==0)
       return;
-   indx1 = indx - 1;
-   indx1y = indx1 > indy ? indx1 : indy;
-   nx = 1L<<indx;
    nxh = nx/2;
    nxhh = nx/4;
-   ny = 1L<<indy;
-   nxy = nx > ny ? nx : ny;
-   nxhy = 1L<<indx1y;
    nyt = nyi + nyp - 1;
    if (isign > 0)
-      goto L100;
+      goto L80;
 /* inverse fourier transform */
-   nrxb = nxhy/nxh;
-   nrx = nxy/nxh;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,ani,t1,t2,t3)
+#pragma omp parallel for private(i,j,jj,joff,at1,ani,t1,t2,t3)
    for (i = nyi-1; i < nyt; i++) {
+      float complex g[2*nxh];
       joff = 2*nxhd*i;
 /* swap complex components */
       for (j = 0; j < nxh; j++) {
@@ -1839,47 +6996,13 @@ private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,ani,t1,t2,t3)
          f[2*j+joff] = crealf(f[2*j+joff])
                        + crealf(f[1+2*j+joff])*_Complex_I;
          f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
-       }
-/* bit-reverse array elements in x */
-      for (j = 0; j < nxh; j++) {
-         j1 = (mixup[j] - 1)/nrxb;
-         if (j < j1) {
-            t1 = f[2*j1+joff];
-            t2 = f[1+2*j1+joff];
-            f[2*j1+joff] = f[2*j+joff];
-            f[1+2*j1+joff] = f[1+2*j+joff];
-            f[2*j+joff] = t1;
-            f[1+2*j+joff] = t2;
-         }
-      }
-/* then transform in x */
-      ns = 1;
-      for (l = 0; l < indx1; l++) {
-         ns2 = ns + ns;
-         km = nxhh/ns;
-         kmr = km*nrx;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = j + k1;
-               j2 = j + k2;
-               t1 = sct[kmr*j];
-               t2 = t1*f[2*j2+joff];
-               t3 = t1*f[1+2*j2+joff];
-               f[2*j2+joff] = f[2*j1+joff] - t2;
-               f[1+2*j2+joff] = f[1+2*j1+joff] - t3;
-               f[2*j1+joff] += t2;
-               f[1+2*j1+joff] += t3;
-            }
-         }
-         ns = ns2;
       }
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,2,1,2);
 /* unscramble coefficients and normalize */
-      kmr = nxy/nx;
-      ani = 0.5/(((float) nx)*((float) ny));
+      ani = 1.0/(float) (2*nx*ny);
       for (j = 1; j < nxhh; j++) {
-         t3 = cimagf(sct[kmr*j]) - crealf(sct[kmr*j])*_Complex_I;
+         t3 = cimagf(sct[j]) - crealf(sct[j])*_Complex_I;
          for (jj = 0; jj < 2; jj++) {
             t2 = conjf(f[jj+2*(nxh-j)+joff]);
             t1 = f[jj+2*j+joff] + t2;
@@ -1897,16 +7020,14 @@ private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,ani,t1,t2,t3)
    }
    return;
 /* forward fourier transform */
-L100: nrxb = nxhy/nxh;
-   nrx = nxy/nxh;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,t1,t2,t3)
+L80:
+#pragma omp parallel for private(i,j,jj,joff,at1,t1,t2,t3)
    for (i = nyi-1; i < nyt; i++) {
+      float complex g[2*nxh];
       joff = 2*nxhd*i;
 /* scramble coefficients */
-      kmr = nxy/nx;
       for (j = 1; j < nxhh; j++) {
-         t3 = cimagf(sct[kmr*j]) + crealf(sct[kmr*j])*_Complex_I;
+         t3 = cimagf(sct[j]) + crealf(sct[j])*_Complex_I;
          for (jj = 0; jj < 2; jj++) {
             t2 = conjf(f[jj+2*(nxh-j)+joff]);
             t1 = f[jj+2*j+joff] + t2;
@@ -1920,41 +7041,8 @@ private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,t1,t2,t3)
          f[jj+joff] = (crealf(f[jj+joff]) + cimagf(f[jj+joff]))
                       + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I;
       }
-/* bit-reverse array elements in x */
-      for (j = 0; j < nxh; j++) {
-         j1 = (mixup[j] - 1)/nrxb;
-         if (j < j1) {
-            t1 = f[2*j1+joff];
-            t2 = f[1+2*j1+joff];
-            f[2*j1+joff] = f[2*j+joff];
-            f[1+2*j1+joff] = f[1+2*j+joff];
-            f[2*j+joff] = t1;
-            f[1+2*j+joff] = t2;
-         }
-      }
-/* then transform in x */
-      ns = 1;
-      for (l = 0; l < indx1; l++) {
-         ns2 = ns + ns;
-         km = nxhh/ns;
-         kmr = km*nrx;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = j + k1;
-               j2 = j + k2;
-               t1 = conjf(sct[kmr*j]);
-               t2 = t1*f[2*j2+joff];
-               t3 = t1*f[1+2*j2+joff];
-               f[2*j2+joff] = f[2*j1+joff] - t2;
-               f[1+2*j2+joff] = f[1+2*j1+joff] - t3;
-               f[2*j1+joff] += t2;
-               f[1+2*j1+joff] +=  t3;
-            }
-         }
-         ns = ns2;
-      }
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,2,1,2);
 /* swap complex components */
       for (j = 0; j < nxh; j++) {
          at1 = cimagf(f[2*j+joff]);
@@ -1967,235 +7055,153 @@ private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,joff,at1,t1,t2,t3)
 }
 
 /*--------------------------------------------------------------------*/
-void cfft2rm2y(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nxi,
-               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd) {
+void cfft2rmn2y(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxi, int nxp,
+                int nxhd, int nyd, int nxhyd, int nxyhd) {
 /* this subroutine performs the y part of 2 two dimensional real to
-   complex fast fourier transforms, and their inverses, for a subset of
-   x, using complex arithmetic, with OpenMP
+   complex mixed radix fast fourier transforms, and their inverses, for
+   a subset of x, using complex arithmetic, with OpenMP
+   same as cfft2rm2y, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in y are performed in blocks of NXB columns by
+   cfft1rnx
    for isign = (-1,1), input: all, output: f
-   for isign = -1, approximate flop count: N*(5*log2(N) + 19/2)
-   for isign = 1,  approximate flop count: N*(5*log2(N) + 15/2)
-   where N = (nx/2)*ny
-   indx/indy = exponent which determines length in x/y direction,
-   where nx=2**indx, ny=2**indy
-   if isign = -1, two inverse fourier transforms in y are performed
-   f[m][n][0:1] = *sum(f[k][j][0:1]*exp(-sqrt(-1)*2pi*m*k/ny))
-   if isign = 1, two forward fourier transforms in y are performed
-   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx))
-   mixup = array of bit reversed addresses
-   sct = sine/cosine table
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1] *
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx)*
+         exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
    nxi = initial x index used
    nxp = number of x indices used
    nxhd = second dimension of f >= nx/2
-   nyd = third dimension of f >= ny
-   nxhyd = maximum of (nx/2,ny)
-   nxyhd = maximum of (nx,ny)/2
-   fourier coefficients are stored as follows:
-   f[k][j][0:1] = real, imaginary part of mode j,k, where
-   0 <= j < nx/2 and 0 <= k < ny, except for
-   f[k][1][0:1] = real, imaginary part of mode nx/2,k, where
-   ny/2+1 <= k < ny, and
-   imag(f[0][0][0:1]) = real part of mode nx/2,0 and
-   imag(f[0][ny/2][0:1]) = real part of mode nx/2,ny/2
-  written by viktor k. decyk, ucla
-local data                                                            */
-   int indx1, indx1y, nx, ny, nyh, nxy, nxhy, nxt;
-   int nry, i, j, k, l, jj, j1, j2, k1, k2, ns, ns2, km, kmr, koff;
-   int nryb;
-   float complex t1, t2, t3;
+   nyd = third dimension of f >= ny
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rm2y
+local data                                                            */
+#define NXB             8
+   int nxh, nyh, nxt, nxb, i, k, k1, jj, nb, joff;
+   float complex t1;
    if (isign==0)
       return;
-   indx1 = indx - 1;
-   indx1y = indx1 > indy ? indx1 : indy;
-   nx = 1L<<indx;
-   ny = 1L<<indy;
+   nxh = nx/2;
    nyh = ny/2;
-   nxy = nx > ny ? nx : ny;
-   nxhy = 1L<<indx1y;
    nxt = nxi + nxp - 1;
+/* both components are transformed together, 2*nxp columns */
+   nxb = (2*nxp - 1)/NXB + 1;
    if (isign > 0)
-      goto L80;
+      goto L60;
 /* inverse fourier transform */
-   nryb = nxhy/ny;
-   nry = nxy/ny;
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,koff,t1,t2,t3)
-   for (i = nxi-1; i < nxt; i++) {
-/* bit-reverse array elements in y */
-      for (k = 0; k < ny; k++) {
-         koff = 2*nxhd*k;
-         k1 = (mixup[k] - 1)/nryb;
-         if (k < k1) {
-            k1 = 2*nxhd*k1;
-            t1 = f[2*i+k1];
-            t2 = f[1+2*i+k1];
-            f[2*i+k1] = f[2*i+koff];
-            f[1+2*i+k1] = f[1+2*i+koff];
-            f[2*i+koff] = t1;
-            f[1+2*i+koff] = t2;
-         }
-      }
-/* then transform in y */
-      ns = 1;
-      for (l = 0; l < indy; l++) {
-         ns2 = ns + ns;
-         km = nyh/ns;
-         kmr = km*nry;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = 2*nxhd*(j + k1);
-               j2 = 2*nxhd*(j + k2);
-               t1 = sct[kmr*j];
-               t2 = t1*f[2*i+j2];
-               t3 = t1*f[1+2*i+j2];
-               f[2*i+j2] = f[2*i+j1] - t2;
-               f[1+2*i+j2] = f[1+2*i+j1] - t3;
-               f[2*i+j1] += t2;
-               f[1+2*i+j1] += t3;
-            }
-         }
-         ns = ns2;
-      }
+#pragma omp parallel for private(i,nb,joff)
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = 2*(nxi - 1) + NXB*i;
+      nb = 2*nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,2*nxhd,1,
+               nb);
    }
 /* unscramble modes kx = 0, nx/2 */
    if (nxi==1) {
       for (k = 1; k < nyh; k++) {
-         koff = 2*nxhd*k;
-         k1 = 2*nxhd*ny - koff;
+         joff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - joff;
          for (jj = 0; jj < 2; jj++) {
             t1 = f[jj+k1];
-            f[jj+k1] = 0.5*(cimagf(f[jj+koff] + t1)
-                        + crealf(f[jj+koff] - t1)*_Complex_I);
-            f[jj+koff] = 0.5*(crealf(f[jj+koff] + t1)
-                          + cimagf(f[jj+koff] - t1)*_Complex_I);
+            f[jj+k1] = 0.5*(cimagf(f[jj+joff] + t1)
+                        + crealf(f[jj+joff] - t1)*_Complex_I);
+            f[jj+joff] = 0.5*(crealf(f[jj+joff] + t1)
+                          + cimagf(f[jj+joff] - t1)*_Complex_I);
          }
       }
    }
    return;
 /* forward fourier transform */
-L80: nryb = nxhy/ny;
-   nry = nxy/ny;
 /* scramble modes kx = 0, nx/2 */
-   if (nxi==1) {
+L60: if (nxi==1) {
       for (k = 1; k < nyh; k++) {
-         koff = 2*nxhd*k;
-         k1 = 2*nxhd*ny - koff;
+         joff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - joff;
          for (jj = 0; jj < 2; jj++) {
             t1 = cimagf(f[jj+k1]) + crealf(f[jj+k1])*_Complex_I;
-            f[jj+k1] = conjf(f[jj+koff] - t1);
-            f[jj+koff] += t1;
+            f[jj+k1] = conjf(f[jj+joff] - t1);
+            f[jj+joff] += t1;
          }
       }
    }
-#pragma omp parallel for \
-private(i,j,k,l,ns,ns2,km,kmr,k1,k2,jj,j1,j2,koff,t1,t2,t3)
-   for (i = nxi-1; i < nxt; i++) {
-/* bit-reverse array elements in y */
-      for (k = 0; k < ny; k++) {
-         koff = 2*nxhd*k;
-         k1 = (mixup[k] - 1)/nryb;
-         if (k < k1) {
-            k1 = 2*nxhd*k1;
-            t1 = f[2*i+k1];
-            t2 = f[1+2*i+k1];
-            f[2*i+k1] = f[2*i+koff];
-            f[1+2*i+k1] = f[1+2*i+koff];
-            f[2*i+koff] = t1;
-            f[1+2*i+koff] = t2;
-         }
-      }
-/* then transform in y */
-      ns = 1;
-      for (l = 0; l < indy; l++) {
-         ns2 = ns + ns;
-         km = nyh/ns;
-         kmr = km*nry;
-         for (k = 0; k < km; k++) {
-            k1 = ns2*k;
-            k2 = k1 + ns;
-            for (j = 0; j < ns; j++) {
-               j1 = 2*nxhd*(j + k1);
-               j2 = 2*nxhd*(j + k2);
-               t1 = conjf(sct[kmr*j]);
-               t2 = t1*f[2*i+j2];
-               t3 = t1*f[1+2*i+j2];
-               f[2*i+j2] = f[2*i+j1] - t2;
-               f[1+2*i+j2] = f[1+2*i+j1] - t3;
-               f[2*i+j1] += t2;
-               f[1+2*i+j1] += t3;
-            }
-         }
-         ns = ns2;
-      }
+#pragma omp parallel for private(i,nb,joff)
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = 2*(nxi - 1) + NXB*i;
+      nb = 2*nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,2*nxhd,1,
+               nb);
    }
    return;
+#undef NXB
 }
 
 /*--------------------------------------------------------------------*/
-void cwfft2rmx(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nxhd,
-               int nyd, int nxhyd, int nxyhd) {
-/* wrapper function for real to complex fft, with packed data */
+void cwfft2rmnx(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxhd, int nyd,
+                int nxhyd, int nxyhd) {
+/* wrapper function for real to complex mixed radix fft, with packed */
+/* data, nx/ny may have prime factors 2, 3 and 5 */
 /* parallelized with OpenMP */
 /* local data */
-   int nxh, ny;
+   int nxh;
    static int nxi = 1, nyi = 1;
 /* calculate range of indices */
-   nxh = 1L<<(indx - 1);
-   ny = 1L<<indy;
+   nxh = nx/2;
 /* inverse fourier transform */
    if (isign < 0) {
 /* perform x fft */
-      cfft2rmxx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmnxx(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
 /* perform y fft */
-      cfft2rmxy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmnxy(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
    }
 /* forward fourier transform */
    else if (isign > 0) {
 /* perform y fft */
-      cfft2rmxy(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmnxy(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
 /* perform x fft */
-      cfft2rmxx(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmnxx(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
    }
    return;
 }
 
 /*--------------------------------------------------------------------*/
-void cwfft2rm2(float complex f[], int isign, int mixup[],
-               float complex sct[], int indx, int indy, int nxhd,
-               int nyd, int nxhyd, int nxyhd) {
-/* wrapper function for 2 2d real to complex ffts, with packed data */
+void cwfft2rmn2(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxhd, int nyd,
+                int nxhyd, int nxyhd) {
+/* wrapper function for 2 2d real to complex mixed radix ffts, */
+/* nx/ny may have prime factors 2, 3 and 5 */
 /* parallelized with OpenMP */
 /* local data */
-   int nxh, ny;
+   int nxh;
    static int nxi = 1, nyi = 1;
 /* calculate range of indices */
-   nxh = 1L<<(indx - 1);
-   ny = 1L<<indy;
+   nxh = nx/2;
 /* inverse fourier transform */
    if (isign < 0) {
 /* perform x fft */
-      cfft2rm2x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmn2x(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
 /* perform y fft */
-      cfft2rm2y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmn2y(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
    }
 /* forward fourier transform */
    else if (isign > 0) {
 /* perform y fft */
-      cfft2rm2y(f,isign,mixup,sct,indx,indy,nxi,nxh,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmn2y(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
 /* perform x fft */
-      cfft2rm2x(f,isign,mixup,sct,indx,indy,nyi,ny,nxhd,nyd,nxhyd,
-                nxyhd);
+      cfft2rmn2x(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
    }
    return;
 }
@@ -2264,6 +7270,15 @@ void cgppost2l_(float *ppart, float *q, int *kpic, float *qm,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgppost2lc_(float *ppart, float *q, int *kpic, float *qm,
+                 int *nppmx, int *idimp, int *mx, int *my, int *nxv,
+                 int *nyv, int *mx1, int *mxy1) {
+   cgppost2lc(ppart,q,kpic,*qm,*nppmx,*idimp,*mx,*my,*nxv,*nyv,*mx1,
+              *mxy1);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cpporder2l_(float *ppart, float *ppbuff, int *kpic, int *ncl,
                  int *ihole, int *idimp, int *nppmx, int *nx, int *ny,
@@ -2283,6 +7298,212 @@ void cpporderf2l_(float *ppart, float *ppbuff, int *kpic, int *ncl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgppushfpost2l_(float *ppart, float *fxy, float *ppbuff, float *q,
+                     int *kpic, int *ncl, int *ihole, float *qbm,
+                     float *dt, float *qm, float *ek, int *idimp,
+                     int *nppmx, int *nx, int *ny, int *mx, int *my,
+                     int *nxv, int *nyv, int *mx1, int *my1, int *npbmx,
+                     int *ntmax, int *irc) {
+   cgppushfpost2l(ppart,fxy,ppbuff,q,kpic,ncl,ihole,*qbm,*dt,*qm,ek,
+                  *idimp,*nppmx,*nx,*ny,*mx,*my,*nxv,*nyv,*mx1,*my1,
+                  *npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppmovin2lt_(float *part, float *ppart, int *kpic, int *nppmx,
+                  int *idimp, int *nop, int *mx, int *my, int *mx1,
+                  int *mxy1, int *irc) {
+   cppmovin2lt(part,ppart,kpic,*nppmx,*idimp,*nop,*mx,*my,*mx1,*mxy1,
+               irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcheck2lt_(float *ppart, int *kpic, int *idimp, int *nppmx,
+                  int *nx, int *ny, int *mx, int *my, int *mx1,
+                  int *my1, int *irc) {
+   cppcheck2lt(ppart,kpic,*idimp,*nppmx,*nx,*ny,*mx,*my,*mx1,*my1,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppush2lt_(float *ppart, float *fxy, int *kpic, float *qbm,
+                  float *dt, float *ek, int *idimp, int *nppmx, int *nx,
+                  int *ny, int *mx, int *my, int *nxv, int *nyv,
+                  int *mx1, int *mxy1, int *ipbc) {
+   cvgppush2lt(ppart,fxy,kpic,*qbm,*dt,ek,*idimp,*nppmx,*nx,*ny,*mx,*my,
+               *nxv,*nyv,*mx1,*mxy1,*ipbc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppushf2lt_(float *ppart, float *fxy, int *kpic, int *ncl,
+                   int *ihole, float *qbm, float *dt, float *ek,
+                   int *idimp, int *nppmx, int *nx, int *ny, int *mx,
+                   int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                   int *ntmax, int *irc) {
+   cvgppushf2lt(ppart,fxy,kpic,ncl,ihole,*qbm,*dt,ek,*idimp,*nppmx,*nx,
+                *ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cvgppost2lt_(float *ppart, float *q, int *kpic, float *qm,
+                  int *nppmx, int *idimp, int *mx, int *my, int *nxv,
+                  int *nyv, int *mx1, int *mxy1) {
+   cvgppost2lt(ppart,q,kpic,*qm,*nppmx,*idimp,*mx,*my,*nxv,*nyv,*mx1,
+               *mxy1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpporder2lt_(float *ppart, float *ppbuff, int *kpic, int *ncl,
+                  int *ihole, int *idimp, int *nppmx, int *nx, int *ny,
+                  int *mx, int *my, int *mx1, int *my1, int *npbmx,
+                  int *ntmax, int *irc) {
+   cpporder2lt(ppart,ppbuff,kpic,ncl,ihole,*idimp,*nppmx,*nx,*ny,*mx,
+                *my,*mx1,*my1,*npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpporderf2lt_(float *ppart, float *ppbuff, int *kpic, int *ncl,
+                   int *ihole, int *idimp, int *nppmx, int *mx1,
+                   int *my1, int *npbmx, int *ntmax, int *irc) {
+   cpporderf2lt(ppart,ppbuff,kpic,ncl,ihole,*idimp,*nppmx,*mx1,*my1,
+                 *npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+/*--------------------------------------------------------------------*/
+void cppholes2l_(float *ppart, int *kpic, int *ncl, int *ihole,
+                 int *idimp, int *nppmx, int *mx, int *my, int *mx1,
+                 int *my1, int *ntmax, int *irc) {
+   cppholes2l(ppart,kpic,ncl,ihole,*idimp,*nppmx,*mx,*my,*mx1,*my1,
+              *ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2lt_(float *ppart, int *kpic, int *ncl, int *ihole,
+                  int *idimp, int *nppmx, int *mx, int *my, int *mx1,
+                  int *my1, int *ntmax, int *irc) {
+   cppholes2lt(ppart,kpic,ncl,ihole,*idimp,*nppmx,*mx,*my,*mx1,*my1,
+               *ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcopy2l_(float *ppart, float *ppart1, int *kpic, int *idimp,
+                int *nppmx, int *nppmx1, int *mxy1) {
+   cppcopy2l(ppart,ppart1,kpic,*idimp,*nppmx,*nppmx1,*mxy1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcopy2lt_(float *ppart, float *ppart1, int *kpic, int *idimp,
+                 int *nppmx, int *nppmx1, int *mxy1) {
+   cppcopy2lt(ppart,ppart1,kpic,*idimp,*nppmx,*nppmx1,*mxy1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppstat2l_(int *kpic, int *ihole, int *ntmax, int *mxy1, int *nmove,
+                int *nhmax, float *imbal) {
+   cppstat2l(kpic,ihole,*ntmax,*mxy1,nmove,nhmax,imbal);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpptune2l_(float *part, float *fxy, float *qbm, float *dt,
+                float *qm, float *xtras, int *idimp, int *nop, int *nx,
+                int *ny, int *nxv, int *nyv, int *ntune, int *mx,
+                int *my, int *irc) {
+   cpptune2l(part,fxy,*qbm,*dt,*qm,xtras,*idimp,*nop,*nx,*ny,*nxv,*nyv,
+             *ntune,mx,my,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppmovin2lr_(float *part, float *ppart, int *kpic, int *nppmx,
+                  int *idimp, int *nop, int *mx, int *my, int *mx1,
+                  int *mxy1, int *irc) {
+   cppmovin2lr(part,ppart,kpic,*nppmx,*idimp,*nop,*mx,*my,*mx1,*mxy1,
+               irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppcheck2lr_(float *ppart, int *kpic, int *idimp, int *nppmx,
+                  int *nx, int *ny, int *mx, int *my, int *mx1,
+                  int *my1, int *irc) {
+   cppcheck2lr(ppart,kpic,*idimp,*nppmx,*nx,*ny,*mx,*my,*mx1,*my1,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppushf2lr_(float *ppart, float *fxy, int *kpic, int *ncl,
+                  int *ihole, float *qbm, float *dt, float *ek,
+                  int *idimp, int *nppmx, int *nx, int *ny, int *mx,
+                  int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                  int *ntmax, int *irc) {
+   cgppushf2lr(ppart,fxy,kpic,ncl,ihole,*qbm,*dt,ek,*idimp,*nppmx,*nx,
+               *ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost2lr_(float *ppart, float *q, int *kpic, float *qm,
+                 int *nppmx, int *idimp, int *mx, int *my, int *nxv,
+                 int *nyv, int *mx1, int *mxy1) {
+   cgppost2lr(ppart,q,kpic,*qm,*nppmx,*idimp,*mx,*my,*nxv,*nyv,*mx1,
+              *mxy1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpporderf2lr_(float *ppart, float *ppbuff, int *kpic, int *ncl,
+                   int *ihole, int *idimp, int *nppmx, int *nx, int *ny,
+                   int *mx, int *my, int *mx1, int *my1, int *npbmx,
+                   int *ntmax, int *irc) {
+   cpporderf2lr(ppart,ppbuff,kpic,ncl,ihole,*idimp,*nppmx,*nx,*ny,*mx,
+                *my,*mx1,*my1,*npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppholes2lr_(float *ppart, int *kpic, int *ncl, int *ihole,
+                  int *idimp, int *nppmx, int *nx, int *ny, int *mx,
+                  int *my, int *mx1, int *my1, int *ntmax, int *irc) {
+   cppholes2lr(ppart,kpic,ncl,ihole,*idimp,*nppmx,*nx,*ny,*mx,*my,*mx1,
+               *my1,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppushf2s_(float *ppart, float *fxy, int *kpic, int *ncl,
+                 int *ihole, float *qbm, float *dt, float *ek,
+                 int *idimp, int *nppmx, int *nx, int *ny, int *mx,
+                 int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                 int *ntmax, int *nord, int *irc) {
+   cgppushf2s(ppart,fxy,kpic,ncl,ihole,*qbm,*dt,ek,*idimp,*nppmx,*nx,
+              *ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,*nord,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost2s_(float *ppart, float *q, int *kpic, float *qm,
+                int *nppmx, int *idimp, int *nx, int *ny, int *mx,
+                int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                int *nord) {
+   cgppost2s(ppart,q,kpic,*qm,*nppmx,*idimp,*nx,*ny,*mx,*my,*nxv,*nyv,
+             *mx1,*mxy1,*nord);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void ccguard2l_(float *fxy, int *nx, int *ny, int *nxe, int *nye) {
    ccguard2l(fxy,*nx,*ny,*nxe,*nye);
@@ -2364,3 +7585,41 @@ void cwfft2rm2_(float complex *f, int *isign, int *mixup,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cwfft2r4x_(float complex *f, int *isign, int *mixup,
+                float complex *sct, int *indx, int *indy, int *nxhd,
+                int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2r4x(f,*isign,mixup,sct,*indx,*indy,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2r42_(float complex *f, int *isign, int *mixup,
+                float complex *sct, int *indx, int *indy, int *nxhd,
+                int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2r42(f,*isign,mixup,sct,*indx,*indy,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rninit_(int *mixup, float complex *sct, int *nx, int *ny,
+                   int *nxhyd, int *nxyhd) {
+   cwfft2rninit(mixup,sct,*nx,*ny,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rmnx_(float complex *f, int *isign, int *mixup,
+                 float complex *sct, int *nx, int *ny, int *nxhd,
+                 int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2rmnx(f,*isign,mixup,sct,*nx,*ny,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rmn2_(float complex *f, int *isign, int *mixup,
+                 float complex *sct, int *nx, int *ny, int *nxhd,
+                 int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2rmn2(f,*isign,mixup,sct,*nx,*ny,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
@@ -1,5 +1,10 @@
 /* header file for mpush2.c */
 
+/* MXM = largest tile size mx, my.  the push and deposit procedures */
+/* keep local copies of the tile fields and charge on the stack of  */
+/* each thread, up to 3*(MXM+1)*(MXM+1) floats                      */
+#define MXM             128
+
 double ranorm();
 
 void cdistr2(float part[], float vtx, float vty, float vdx, float vdy,
@@ -31,6 +36,10 @@ void cgppost2l(float ppart[], float q[], int kpic[], float qm,
                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
                int mx1, int mxy1);
 
+void cgppost2lc(float ppart[], float q[], int kpic[], float qm,
+                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                int mx1, int mxy1);
+
 void cpporder2l(float ppart[], float ppbuff[], int kpic[], int ncl[],
                 int ihole[], int idimp, int nppmx, int nx, int ny,
                 int mx, int my, int mx1, int my1, int npbmx, int ntmax,
@@ -40,6 +49,103 @@ void cpporderf2l(float ppart[], float ppbuff[], int kpic[], int ncl[],
                  int ihole[], int idimp, int nppmx, int mx1, int my1,
                  int npbmx, int ntmax, int *irc);
 
+void cgppushfpost2l(float ppart[], float fxy[], float ppbuff[],
+                    float q[], int kpic[], int ncl[], int ihole[],
+                    float qbm, float dt, float qm, float *ek, int idimp,
+                    int nppmx, int nx, int ny, int mx, int my, int nxv,
+                    int nyv, int mx1, int my1, int npbmx, int ntmax,
+                    int *irc);
+
+void cppmovin2lt(float part[], float ppart[], int kpic[], int nppmx,
+                 int idimp, int nop, int mx, int my, int mx1, int mxy1,
+                 int *irc);
+
+void cppcheck2lt(float ppart[], int kpic[], int idimp, int nppmx, int nx,
+                 int ny, int mx, int my, int mx1, int my1, 
+                 int *irc);
+
+void cvgppush2lt(float ppart[], float fxy[], int kpic[], float qbm,
+                 float dt, float *ek, int idimp, int nppmx, int nx,
+                 int ny, int mx, int my, int nxv, int nyv, int mx1,
+                 int mxy1, int ipbc);
+
+void cvgppushf2lt(float ppart[], float fxy[], int kpic[], int ncl[],
+                  int ihole[], float qbm, float dt, float *ek,
+                  int idimp, int nppmx, int nx, int ny, int mx, int my,
+                  int nxv, int nyv, int mx1, int mxy1, int ntmax,
+                  int *irc);
+
+void cvgppost2lt(float ppart[], float q[], int kpic[], float qm,
+                 int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                 int mx1, int mxy1);
+
+void cpporder2lt(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                 int ihole[], int idimp, int nppmx, int nx, int ny,
+                 int mx, int my, int mx1, int my1, int npbmx, int ntmax,
+                 int *irc);
+
+void cpporderf2lt(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                  int ihole[], int idimp, int nppmx, int mx1, int my1,
+                  int npbmx, int ntmax, int *irc);
+
+void cppholes2l(float ppart[], int kpic[], int ncl[], int ihole[],
+                int idimp, int nppmx, int mx, int my, int mx1, int my1,
+                int ntmax, int *irc);
+
+void cppholes2lt(float ppart[], int kpic[], int ncl[], int ihole[],
+                 int idimp, int nppmx, int mx, int my, int mx1, int my1,
+                 int ntmax, int *irc);
+
+void cppcopy2l(float ppart[], float ppart1[], int kpic[], int idimp,
+               int nppmx, int nppmx1, int mxy1);
+
+void cppcopy2lt(float ppart[], float ppart1[], int kpic[], int idimp,
+                int nppmx, int nppmx1, int mxy1);
+
+void cppstat2l(int kpic[], int ihole[], int ntmax, int mxy1, int *nmove,
+               int *nhmax, float *imbal);
+
+void cpptune2l(float part[], float fxy[], float qbm, float dt,
+               float qm, float *xtras, int idimp, int nop, int nx,
+               int ny, int nxv, int nyv, int ntune, int *mx, int *my,
+               int *irc);
+
+void cppmovin2lr(float part[], float ppart[], int kpic[], int nppmx,
+                 int idimp, int nop, int mx, int my, int mx1, int mxy1,
+                 int *irc);
+
+void cppcheck2lr(float ppart[], int kpic[], int idimp, int nppmx,
+                 int nx, int ny, int mx, int my, int mx1, int my1, 
+                 int *irc);
+
+void cgppushf2lr(float ppart[], float fxy[], int kpic[], int ncl[],
+                 int ihole[], float qbm, float dt, float *ek, int idimp,
+                 int nppmx, int nx, int ny, int mx, int my, int nxv,
+                 int nyv, int mx1, int mxy1, int ntmax, int *irc);
+
+void cgppost2lr(float ppart[], float q[], int kpic[], float qm,
+                int nppmx, int idimp, int mx, int my, int nxv, int nyv,
+                int mx1, int mxy1);
+
+void cpporderf2lr(float ppart[], float ppbuff[], int kpic[], int ncl[],
+                  int ihole[], int idimp, int nppmx, int nx, int ny,
+                  int mx, int my, int mx1, int my1, int npbmx,
+                  int ntmax, int *irc);
+
+void cppholes2lr(float ppart[], int kpic[], int ncl[], int ihole[],
+                 int idimp, int nppmx, int nx, int ny, int mx, int my,
+                 int mx1, int my1, int ntmax, int *irc);
+
+void cgppushf2s(float ppart[], float fxy[], int kpic[], int ncl[],
+                int ihole[], float qbm, float dt, float *ek, int idimp,
+                int nppmx, int nx, int ny, int mx, int my, int nxv,
+                int nyv, int mx1, int mxy1, int ntmax, int nord,
+                int *irc);
+
+void cgppost2s(float ppart[], float q[], int kpic[], float qm,
+               int nppmx, int idimp, int nx, int ny, int mx, int my,
+               int nxv, int nyv, int mx1, int mxy1, int nord);
+
 void ccguard2l(float fxy[], int nx, int ny, int nxe, int nye);
 
 void caguard2l(float q[], int nx, int ny, int nxe, int nye);
@@ -75,3 +181,64 @@ void cwfft2rmx(float complex f[], int isign, int mixup[],
 void cwfft2rm2(float complex f[], int isign, int mixup[],
                float complex sct[], int indx, int indy, int nxhd,
                int nyd, int nxhyd, int nxyhd);
+
+void cfft1rm4(float complex f[], int isign, int mixup[],
+              float complex sct[], int indn, int nrb, int nr, int ld,
+              int nb);
+
+void cfft2r4xx(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2r4xy(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2r42x(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nyi,
+               int nyp, int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2r42y(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxi,
+               int nxp, int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cwfft2r4x(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd);
+
+void cwfft2r42(float complex f[], int isign, int mixup[],
+               float complex sct[], int indx, int indy, int nxhd,
+               int nyd, int nxhyd, int nxyhd);
+
+int cfft1nfac(int n, int nfac[]);
+
+void cfft1rnx(float complex f[], float complex g[], int isign,
+              int mixup[], float complex sct[], int n, int nrs, int ld,
+              int lb, int nb);
+
+void cwfft2rninit(int mixup[], float complex sct[], int nx, int ny,
+                  int nxhyd, int nxyhd);
+
+void cfft2rmnxx(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nyi, int nyp,
+                int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2rmnxy(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxi, int nxp,
+                int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2rmn2x(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nyi, int nyp,
+                int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cfft2rmn2y(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxi, int nxp,
+                int nxhd, int nyd, int nxhyd, int nxyhd);
+
+void cwfft2rmnx(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxhd, int nyd,
+                int nxhyd, int nxyhd);
+
+void cwfft2rmn2(float complex f[], int isign, int mixup[],
+                float complex sct[], int nx, int ny, int nxhd, int nyd,
+                int nxhyd, int nxyhd);
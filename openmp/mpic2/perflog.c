@@ -0,0 +1,203 @@
+/* C Library for machine readable timing and counter output */
+/* from Skeleton PIC codes, written on top of dtimer.       */
+/* one record is written for each time step, as CSV or JSON */
+/* lines, and a rolling summary can be printed periodically */
+/* the totals for the run are written to a separate file    */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "perflog.h"
+
+#define MAXPERF         16
+
+/* output file, format and summary interval, kopen = 1 if opened */
+/* sumpath = name of file for totals                             */
+static FILE *fperf = NULL;
+static char sumpath[256];
+static int kopen = 0, kperf = 0, nperf = 0;
+/* names of phases and counters */
+static int nph = 0, ncnt = 0;
+static char *phname[MAXPERF], *cname[MAXPERF];
+/* phase times and counters accumulated over summary interval and run */
+static int nstep = 0, nwin = 0, nfirst = 0;
+static double twin[MAXPERF], ttot[MAXPERF];
+static double cwin[MAXPERF], ctot[MAXPERF];
+static float cwmax[MAXPERF], cmax[MAXPERF];
+
+/*--------------------------------------------------------------------*/
+int cperfopen(char *fname, int kfmt, int nsum, int nphase,
+              char *phnames[], int ncount, char *cnames[]) {
+/* this subroutine opens a file for per time step timing records
+   and counters, and writes the header, if any.
+   returns 0 if successful, otherwise 1.
+   fname = name of file, without extension
+   kfmt = (0,1,2) = write (no file, CSV file fname.csv,
+   JSON lines file fname.json), totals are written by cperfclose to
+   fname_sum.csv or fname_sum.json
+   nsum = print rolling summary every nsum time steps, 0 = never
+   nphase = number of timed phases, nphase <= 16
+   phnames = names of timed phases
+   ncount = number of counters, ncount <= 16
+   cnames = names of counters
+local data                                                            */
+   int j;
+   char path[256];
+   kopen = 0;
+   if ((kfmt < 0) || (kfmt > 2) || (nphase > MAXPERF)
+      || (ncount > MAXPERF))
+      return 1;
+   if (kfmt > 0) {
+      snprintf(path,sizeof(path),"%s.%s",fname,kfmt==1 ? "csv" : "json");
+      fperf = fopen(path,"w");
+      if (fperf==NULL)
+         return 1;
+      snprintf(sumpath,sizeof(sumpath),"%s_sum.%s",fname,
+               kfmt==1 ? "csv" : "json");
+   }
+   kopen = 1;
+   kperf = kfmt;
+   nperf = nsum;
+   nph = nphase;
+   ncnt = ncount;
+   for (j = 0; j < nph; j++) {
+      phname[j] = phnames[j];
+      twin[j] = 0.0;
+      ttot[j] = 0.0;
+   }
+   for (j = 0; j < ncnt; j++) {
+      cname[j] = cnames[j];
+      cwin[j] = 0.0;
+      ctot[j] = 0.0;
+      cwmax[j] = 0.0;
+      cmax[j] = 0.0;
+   }
+   nstep = 0;
+   nwin = 0;
+/* CSV header */
+   if (kperf==1) {
+      fprintf(fperf,"step");
+      for (j = 0; j < nph; j++) {
+         fprintf(fperf,",%s",phname[j]);
+      }
+      for (j = 0; j < ncnt; j++) {
+         fprintf(fperf,",%s",cname[j]);
+      }
+      fprintf(fperf,"\n");
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+void cperfstep(int ntime, double tphase[], float cnt[]) {
+/* this subroutine writes the record for one time step, and prints the
+   rolling summary at the end of each summary interval
+   ntime = current time step
+   tphase = time spent in each phase in this time step, the sum of the
+   dtimer intervals for that phase
+   cnt = value of each counter for this time step
+local data                                                            */
+   int j;
+   double dt;
+   if (kopen==0)
+      return;
+   if (nwin==0)
+      nfirst = ntime;
+/* write record */
+   if (kperf==1)
+      fprintf(fperf,"%d",ntime);
+   else if (kperf==2)
+      fprintf(fperf,"{\"step\":%d",ntime);
+   for (j = 0; j < nph; j++) {
+      dt = tphase[j];
+      twin[j] += dt;
+      ttot[j] += dt;
+      if (kperf==1)
+         fprintf(fperf,",%.6e",dt);
+      else if (kperf==2)
+         fprintf(fperf,",\"%s\":%.6e",phname[j],dt);
+   }
+   for (j = 0; j < ncnt; j++) {
+      cwin[j] += cnt[j];
+      ctot[j] += cnt[j];
+      cwmax[j] = cnt[j] > cwmax[j] ? cnt[j] : cwmax[j];
+      cmax[j] = cnt[j] > cmax[j] ? cnt[j] : cmax[j];
+      if (kperf==1)
+         fprintf(fperf,",%g",cnt[j]);
+      else if (kperf==2)
+         fprintf(fperf,",\"%s\":%g",cname[j],cnt[j]);
+   }
+   if (kperf==1)
+      fprintf(fperf,"\n");
+   else if (kperf==2)
+      fprintf(fperf,"}\n");
+   nstep += 1;
+   nwin += 1;
+/* print rolling summary: mean phase times, mean/max counters */
+   if ((nperf > 0) && (nwin==nperf)) {
+      printf("steps %d-%d:",nfirst,ntime);
+      for (j = 0; j < nph; j++) {
+         printf(" %s=%.3e",phname[j],twin[j]/(double) nwin);
+         twin[j] = 0.0;
+      }
+      for (j = 0; j < ncnt; j++) {
+         printf(" %s=%g/%g",cname[j],cwin[j]/(double) nwin,cwmax[j]);
+         cwin[j] = 0.0;
+         cwmax[j] = 0.0;
+      }
+      printf("\n");
+      nwin = 0;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cperfclose() {
+/* this subroutine closes the file of per time step records, and writes
+   the number of time steps, the total time in each phase, and the mean
+   and maximum of each counter to a separate file, with the same format
+local data                                                            */
+   int j;
+   double an;
+   FILE *fsum;
+   if (kopen==0)
+      return;
+   kopen = 0;
+   if (kperf==0)
+      return;
+   fclose(fperf);
+   fperf = NULL;
+   fsum = fopen(sumpath,"w");
+   if (fsum==NULL)
+      return;
+   an = nstep > 0 ? 1.0/(double) nstep : 0.0;
+   if (kperf==1) {
+      fprintf(fsum,"nsteps");
+      for (j = 0; j < nph; j++) {
+         fprintf(fsum,",%s",phname[j]);
+      }
+      for (j = 0; j < ncnt; j++) {
+         fprintf(fsum,",%s_mean,%s_max",cname[j],cname[j]);
+      }
+      fprintf(fsum,"\n%d",nstep);
+      for (j = 0; j < nph; j++) {
+         fprintf(fsum,",%.6e",ttot[j]);
+      }
+      for (j = 0; j < ncnt; j++) {
+         fprintf(fsum,",%g,%g",ctot[j]*an,cmax[j]);
+      }
+      fprintf(fsum,"\n");
+   }
+   else {
+      fprintf(fsum,"{\"nsteps\":%d",nstep);
+      for (j = 0; j < nph; j++) {
+         fprintf(fsum,",\"%s\":%.6e",phname[j],ttot[j]);
+      }
+      for (j = 0; j < ncnt; j++) {
+         fprintf(fsum,",\"%s_mean\":%g,\"%s_max\":%g",cname[j],
+                 ctot[j]*an,cname[j],cmax[j]);
+      }
+      fprintf(fsum,"}\n");
+   }
+   fclose(fsum);
+   return;
+}
@@ -0,0 +1,8 @@
+/* header file for perflog.c */
+
+int cperfopen(char *fname, int kfmt, int nsum, int nphase,
+              char *phnames[], int ncount, char *cnames[]);
+
+void cperfstep(int ntime, double tphase[], float cnt[]);
+
+void cperfclose();
@@ -0,0 +1,228 @@
+/*---------------------------------------------------------------------*/
+/* Benchmark for mixed precision particles in 2D OpenMP PIC code       */
+/* compares positions stored as absolute floats, with float charge     */
+/* accumulation (cgppushf2l, cpporderf2l, cgppost2l), with positions   */
+/* stored relative to the tile, with double charge accumulation        */
+/* (cgppushf2lr, cpporderf2lr, cgppost2lr), for a range of grid sizes  */
+/* written for the Skeleton 2D Electrostatic OpenMP PIC code           */
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+#include <sys/time.h>
+#include "mpush2.h"
+#include "omplib.h"
+
+void dtimer(double *time, struct timeval *itime, int icntrl);
+
+static int crun(int kprec, int indx, int indy, int npc, int nloop,
+                float tpart[], float *edrift, float *qerr,
+                float *xres);
+
+int main(int argc, char *argv[]) {
+/* indmin/indmax = range of exponents, nx = ny = 2**ind */
+   int indmin = 6, indmax = 9;
+/* npc = number of electrons per grid cell in each direction */
+   int npc = 4;
+/* nloop = number of time steps in each run */
+   int nloop = 100;
+/* nvp = number of shared memory nodes (0=default) */
+   int nvp = 0;
+   int ind, kprec, irc;
+   float tpart[3], edrift, qerr, xres;
+   char *names[2] = {"absolute","relative"};
+
+   irc = 0;
+   if (argc > 1)
+      nvp = atoi(argv[1]);
+/* initialize for shared memory parallel processing */
+   cinit_omp(nvp);
+   printf("ind  positions  push (nsec) reorder (nsec) deposit (nsec) ");
+   printf("energy drift  charge error  position step\n");
+   for (ind = indmin; ind <= indmax; ind++) {
+      for (kprec = 0; kprec < 2; kprec++) {
+         if (crun(kprec,ind,ind,npc,nloop,tpart,&edrift,&qerr,&xres)
+             != 0) {
+            printf("precbench2: run failed for ind, kprec = %d,%d\n",
+                   ind,kprec);
+            irc = 1;
+            continue;
+         }
+         printf("%3d  %-9s %12.4f %14.4f %14.4f",ind,names[kprec],
+                tpart[0],tpart[1],tpart[2]);
+         printf("   %11.4e %13.4e %13.4e\n",edrift,qerr,xres);
+      }
+   }
+   printf("times are per particle per time step\n");
+   printf("energy drift = largest relative change in total energy\n");
+   printf("charge error = largest relative error in total charge\n");
+   printf("position step = float spacing at largest stored position\n");
+
+   return irc;
+}
+
+/*--------------------------------------------------------------------*/
+static int crun(int kprec, int indx, int indy, int npc, int nloop,
+                float tpart[], float *edrift, float *qerr,
+                float *xres) {
+/* runs nloop time steps of the electrostatic PIC code with particle
+   positions (kprec = 0) absolute, or (kprec = 1) relative to the tile
+   returns 0 if successful, otherwise 1.
+   tpart = push, reorder and deposit time per particle per step, nsec
+   edrift = largest relative change in total energy
+   qerr = largest relative error in total deposited charge
+   xres = spacing between floats at the largest stored position
+local data                                                            */
+   int ndim = 2, idimp = 4, ipbc = 1, mx = 16, my = 16;
+   float dt = 0.1, qme = -1.0, vtx = 1.0, vty = 1.0;
+   float ax = .912871, ay = .912871, xtras = 0.2;
+   int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
+   int mx1, my1, mxy1, nppmx, nppmx0, ntmax, npbmx;
+   int i, j, k, ntime, isign, irc;
+   float qbme, affp, we, wke, wt, x;
+   double qsum, etot0;
+   float *part = NULL, *qe = NULL, *fxye = NULL;
+   float complex *ffc = NULL, *sct = NULL;
+   int *mixup = NULL;
+   float *ppart = NULL, *ppbuff = NULL;
+   int *kpic = NULL, *ncl = NULL, *ihole = NULL;
+   struct timeval itime;
+   double dtime;
+
+   irc = 0;
+   nx = 1L<<indx; ny = 1L<<indy;
+   np = (npc*nx)*(npc*ny);
+   nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
+   nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
+   nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+   mx1 = (nx - 1)/mx + 1; my1 = (ny - 1)/my + 1; mxy1 = mx1*my1;
+   qbme = qme;
+   affp = (float) (nx*ny)/(float ) np;
+   for (j = 0; j < 3; j++) {
+      tpart[j] = 0.0;
+   }
+   *edrift = 0.0;
+   *qerr = 0.0;
+   *xres = 0.0;
+   etot0 = 0.0;
+
+/* allocate data for standard code */
+   part = (float *) malloc(idimp*np*sizeof(float));
+   qe = (float *) malloc(nxe*nye*sizeof(float));
+   fxye = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
+   mixup = (int *) malloc(nxhy*sizeof(int));
+   sct = (float complex *) malloc(nxyh*sizeof(float complex));
+   kpic = (int *) malloc(mxy1*sizeof(int));
+
+/* prepare fft tables and form factors */
+   cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+   isign = 0;
+   cmpois22((float complex *)qe,(float complex *)fxye,isign,ffc,ax,ay,
+             affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+/* initialize electrons */
+   cdistr2(part,vtx,vty,0.0,0.0,npc*nx,npc*ny,idimp,np,nx,ny,ipbc);
+   cdblkp2l(part,kpic,&nppmx,idimp,np,mx,my,mx1,mxy1,&irc);
+   if (irc != 0)
+      goto L10;
+   nppmx0 = (1.0 + xtras)*nppmx;
+   ntmax = xtras*nppmx;
+   npbmx = xtras*nppmx;
+   ppart = (float *) malloc(idimp*nppmx0*mxy1*sizeof(float));
+   ppbuff = (float *) malloc(idimp*npbmx*mxy1*sizeof(float));
+   ncl = (int *) malloc(8*mxy1*sizeof(int));
+   ihole = (int *) malloc(2*(ntmax+1)*mxy1*sizeof(int));
+   if (kprec==1)
+      cppmovin2lr(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   else
+      cppmovin2l(part,ppart,kpic,nppmx0,idimp,np,mx,my,mx1,mxy1,&irc);
+   if (irc != 0)
+      goto L10;
+
+   for (ntime = 0; ntime < nloop; ntime++) {
+/* deposit charge: updates qe */
+      for (j = 0; j < nxe*nye; j++) {
+         qe[j] = 0.0;
+      }
+      dtimer(&dtime,&itime,-1);
+      if (kprec==1)
+         cgppost2lr(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                    mxy1);
+      else
+         cgppost2l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,mx1,
+                   mxy1);
+      dtimer(&dtime,&itime,1);
+      tpart[2] += (float) dtime;
+/* check total charge, including guard cells */
+      qsum = 0.0;
+      for (j = 0; j < nxe*nye; j++) {
+         qsum += qe[j];
+      }
+      x = fabs(qsum/((double) qme*(double) np) - 1.0);
+      *qerr = x > *qerr ? x : *qerr;
+/* solve for fields: updates qe, fxye, we */
+      caguard2l(qe,nx,ny,nxe,nye);
+      isign = -1;
+      cwfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,nye,
+                nxhy,nxyh);
+      cmpois22((float complex *)qe,(float complex *)fxye,isign,ffc,ax,
+               ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+      isign = 1;
+      cwfft2rm2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,
+                nye,nxhy,nxyh);
+      ccguard2l(fxye,nx,ny,nxe,nye);
+/* push particles: updates ppart, ncl, ihole, wke */
+      wke = 0.0;
+      dtimer(&dtime,&itime,-1);
+      if (kprec==1)
+         cgppushf2lr(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                     nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+      else
+         cgppushf2l(ppart,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,nppmx0,
+                    nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,&irc);
+      dtimer(&dtime,&itime,1);
+      tpart[0] += (float) dtime;
+      if (irc != 0)
+         goto L10;
+/* reorder particles by tile: updates ppart, ppbuff, kpic, ncl */
+      dtimer(&dtime,&itime,-1);
+      if (kprec==1)
+         cpporderf2lr(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx,ny,mx,
+                      my,mx1,my1,npbmx,ntmax,&irc);
+      else
+         cpporderf2l(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,my1,
+                     npbmx,ntmax,&irc);
+      dtimer(&dtime,&itime,1);
+      tpart[1] += (float) dtime;
+      if (irc != 0)
+         goto L10;
+/* energy at time t is known after the push */
+      if (ntime==0) {
+         etot0 = (double) we + (double) wke;
+      }
+      else {
+         x = fabs(((double) we + (double) wke)/etot0 - 1.0);
+         *edrift = x > *edrift ? x : *edrift;
+      }
+   }
+/* find largest stored position */
+   x = 0.0;
+   for (k = 0; k < mxy1; k++) {
+      for (j = 0; j < kpic[k]; j++) {
+         for (i = 0; i < 2; i++) {
+            wt = fabsf(ppart[i+idimp*(j+nppmx0*k)]);
+            x = wt > x ? wt : x;
+         }
+      }
+   }
+   *xres = nextafterf(x,2.0f*x + 1.0f) - x;
+   wt = 1.0e+09/(((float) nloop)*((float) np));
+   for (j = 0; j < 3; j++) {
+      tpart[j] *= wt;
+   }
+
+L10: free(ihole); free(ncl); free(ppbuff); free(ppart);
+   free(kpic); free(sct); free(mixup); free(ffc);
+   free(fxye); free(qe); free(part);
+   return irc != 0;
+}
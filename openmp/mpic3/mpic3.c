@@ -37,6 +37,9 @@ int main(int argc, char *argv[]) {
    int mx = 8, my = 8, mz = 8;
 /* xtras = fraction of extra particles needed for particle management */
    float xtras = 0.2;
+/* nord = (1,2,3) = particle shape is (linear, quadratic spline, cubic */
+/* spline)                                                             */
+   int nord = 1;
 /* declare scalars for standard code */
    int j;
    int np, nx, ny, nz, nxh, nyh, nzh, nxe, nye, nze, nxeh;
@@ -87,6 +90,8 @@ int main(int argc, char *argv[]) {
 /* scanf("%i",&nvp);                   */
 /* initialize for shared memory parallel processing */
    cinit_omp(nvp);
+   if ((nord < 2) || (nord > 3))
+      nord = 1;
 
 /* initialize scalars for standard code */
 /* np = total number of particles in simulation */
@@ -165,8 +170,12 @@ L500: if (nloop <= ntime)
       for (j = 0; j < nxe*nye*nze; j++) {
          qe[j] = 0.0;
       }
-      cgppost3l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,mz,nxe,nye,nze,mx1,
-                my1,mxyz1);
+      if (nord > 1)
+         cgppost3s(ppart,qe,kpic,qme,nppmx0,idimp,nx,ny,nz,mx,my,mz,nxe,
+                   nye,nze,mx1,my1,mxyz1,nord);
+      else
+         cgppost3l(ppart,qe,kpic,qme,nppmx0,idimp,mx,my,mz,nxe,nye,nze,
+                   mx1,my1,mxyz1);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdpost += time;
@@ -220,9 +229,14 @@ L500: if (nloop <= ntime)
 /*    cgppush3l(ppart,fxyze,kpic,qbme,dt,&wke,idimp,nppmx0,nx,ny,nz, */
 /*              mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,ipbc);            */
 /* updates ppart, ncl, ihole, wke, irc */
-      cgppushf3l(ppart,fxyze,kpic,ncl,ihole,qbme,dt,&wke,idimp,nppmx0,
-                 nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,ntmax,
-                 &irc);
+      if (nord > 1)
+         cgppushf3s(ppart,fxyze,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                    nppmx0,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,
+                    ntmax,nord,&irc);
+      else
+         cgppushf3l(ppart,fxyze,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                    nppmx0,nx,ny,nz,mx,my,mz,nxe,nye,nze,mx1,my1,mxyz1,
+                    ntmax,&irc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
@@ -1630,6 +1630,576 @@ ist,j1,j2,ip,ks)
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgppushf3s(float ppart[], float fxyz[], int kpic[], int ncl[],
+                int ihole[], float qbm, float dt, float *ek, int idimp,
+                int nppmx, int nx, int ny, int nz, int mx, int my,
+                int mz, int nxv, int nyv, int nzv, int mx1, int my1,
+                int mxyz1, int ntmax, int nord, int *irc) {
+/* for 3d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and second-order quadratic
+   or third-order cubic spline interpolation in space, with periodic
+   boundary conditions.
+   also determines list of particles which are leaving this tile
+   vectorizable/OpenMP version
+   data read in tiles, with guards of one grid below and two grids
+   above each tile, copied from the periodic interior of fxyz
+   particles stored segmented array
+   quadratic: 215 flops/particle, 87 loads, 6 stores
+   cubic: 430 flops/particle, 198 loads, 6 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t),z(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t),z(t))*dt,
+   vz(t+dt/2) = vz(t-dt/2) + (q/m)*fz(x(t),y(t),z(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt,
+   z(t+dt) = z(t) + vz(t+dt/2)*dt
+   fx(x(t),y(t),z(t)), fy(x(t),y(t),z(t)), and fz(x(t),y(t),z(t))
+   are approximated by interpolation from the nearest nord+1 grid
+   points in each direction:
+   fx(x,y,z) = sum(sz(l)*sum(sy(m)*sum(sx(n)*fx(n,m,l)))),
+   similarly for fy and fz
+   for nord = 2, n,m,l = nearest grid points and dx = x-n, dy = y-m,
+   dz = z-l
+   sx(n-1) = .5*(.5-dx)**2, sx(n) = .75-dx**2, sx(n+1) = .5*(.5+dx)**2
+   for nord = 3, n,m,l = leftmost grid points and dx = x-n, dy = y-m,
+   dz = z-l
+   sx(n-1) = (1-dx)**3/6, sx(n) = (4-6*dx**2+3*dx**3)/6,
+   sx(n+1) = (1+3*dx+3*dx**2-3*dx**3)/6, sx(n+2) = dx**3/6
+   with similar expressions for sy and sz
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = position z of particle n in tile m
+   ppart[m][n][3] = velocity vx of particle n in tile m
+   ppart[m][n][4] = velocity vy of particle n in tile m
+   ppart[m][n][5] = velocity vz of particle n in tile m
+   fxyz[l][k][j][0] = x component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][1] = y component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][2] = z component of force/charge at grid (j,k,l)
+   that is, convolution of electric field over particle shape
+   kpic[l] = number of particles in tile l
+   ncl[l][i] = number of particles going to destination i, tile l
+   ihole[l][:][0] = location of hole in array left by departing particle
+   ihole[l][:][1] = direction destination of particle leaving hole
+   all for tile l
+   ihole[l][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass ratio
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2+
+   (vz(t+dt/2)+vz(t-dt/2))**2)
+   idimp = size of phase space = 6
+   nppmx = maximum number of particles in tile
+   nx/ny/nz = system length in x/y/z direction
+   mx/my/mz = number of grids in sorting cell in x/y/z
+   nxv = second dimension of field array, must be >= nx
+   nyv = third dimension of field array, must be >= ny
+   nzv = fourth dimension of field array, must be >= nz
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   mxyz1 = mx1*my1*mz1,
+   where mz1 = (system length in z direction - 1)/mz + 1
+   ntmax = size of hole array for particles leaving tiles
+   nord = order of spline interpolation, 2 = quadratic, 3 = cubic
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+#define MXV             19
+#define MYV             19
+#define MZV             19
+#define NPBLK           32
+#define LSTEN           4
+   int mxy1, noff, moff, loff, npoff, npp, joff, nps;
+   int i, j, k, l, m, ih, nh, nn, mm, ll, ii, ns, mxv, myv, mxyv, nxyv;
+   float anx, any, anz, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float qtm, x, y, z, dxp, dyp, dzp, amx, amy, amz, wx;
+   float dx, dy, dz, vx, vy, vz;
+   float sixth = 1.0f/6.0f, twoth = 2.0f/3.0f;
+   float sfxyz[3*MXV*MYV*MZV];
+/* float sfxyz[3*(mx+3)*(my+3)*(mz+3)]; */
+/* scratch arrays */
+   int n[NPBLK];
+   float sx[NPBLK*LSTEN], sy[NPBLK*LSTEN], sz[NPBLK*LSTEN];
+   float s[3*NPBLK];
+   double sum1, sum2;
+   ns = nord + 1;
+   mxv = mx+3;
+   myv = my+3;
+   mxyv = mxv*myv;
+   nxyv = nxv*nyv;
+   mxy1 = mx1*my1;
+   qtm = qbm*dt;
+   anx = (float) nx;
+   any = (float) ny;
+   anz = (float) nz;
+   sum2 = 0.0;
+/* error if local array is too small                      */
+/* if ((mx+3 > MXV) || (my+3 > MYV) || (mz+3 > MZV))      */
+/*    return;                                             */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,l,m,noff,moff,loff,npp,npoff,joff,nps,nn,mm,ll,ii,ih,nh, \
+x,y,z,dxp,dyp,dzp,amx,amy,amz,wx,dx,dy,dz,vx,vy,vz,edgelx,edgely, \
+edgelz,edgerx,edgery,edgerz,sum1,sfxyz,n,sx,sy,sz,s) \
+reduction(+:sum2)
+   for (l = 0; l < mxyz1; l++) {
+      loff = l/mxy1;
+      k = l - mxy1*loff;
+      loff = mz*loff;
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[l];
+      npoff = nppmx*l;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ll = nz - loff;
+      ll = mz < ll ? mz : ll;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      edgelz = loff;
+      edgerz = loff + ll;
+      ih = 0;
+      nh = 0;
+      nn += 3;
+      mm += 3;
+      ll += 3;
+/* load local fields from global array, guards wrap periodically */
+      for (k = 0; k < ll; k++) {
+         m = k + loff - 1;
+         m = m < 0 ? m + nz : m;
+         m = m < nz ? m : m - nz;
+         for (j = 0; j < mm; j++) {
+            ii = j + moff - 1;
+            ii = ii < 0 ? ii + ny : ii;
+            ii = ii < ny ? ii : ii - ny;
+            ii = nxv*ii + nxyv*m;
+            for (i = 0; i < nn; i++) {
+               joff = i + noff - 1;
+               joff = joff < 0 ? joff + nx : joff;
+               joff = joff < nx ? joff : joff - nx;
+               sfxyz[3*(i+mxv*j+mxyv*k)] = fxyz[3*(joff+ii)];
+               sfxyz[1+3*(i+mxv*j+mxyv*k)] = fxyz[1+3*(joff+ii)];
+               sfxyz[2+3*(i+mxv*j+mxyv*k)] = fxyz[2+3*(joff+ii)];
+            }
+         }
+      }
+/* clear counters */
+      for (j = 0; j < 26; j++) {
+         ncl[j+26*l] = 0;
+      }
+      sum1 = 0.0;
+/* loop over blocks of particles in tile */
+      for (joff = 0; joff < npp; joff += NPBLK) {
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* find interpolation weights */
+         if (nord==2) {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               z = ppart[2+idimp*(j+joff+npoff)];
+               nn = x + 0.5f;
+               mm = y + 0.5f;
+               ll = z + 0.5f;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               dzp = z - (float) ll;
+               n[j] = nn - noff + mxv*(mm - moff) + mxyv*(ll - loff);
+               amx = 0.5f - dxp;
+               amy = 0.5f - dyp;
+               amz = 0.5f - dzp;
+               dx = 0.5f + dxp;
+               dy = 0.5f + dyp;
+               dz = 0.5f + dzp;
+               sx[j] = 0.5f*amx*amx;
+               sx[j+NPBLK] = 0.75f - dxp*dxp;
+               sx[j+2*NPBLK] = 0.5f*dx*dx;
+               sy[j] = 0.5f*amy*amy;
+               sy[j+NPBLK] = 0.75f - dyp*dyp;
+               sy[j+2*NPBLK] = 0.5f*dy*dy;
+               sz[j] = 0.5f*amz*amz;
+               sz[j+NPBLK] = 0.75f - dzp*dzp;
+               sz[j+2*NPBLK] = 0.5f*dz*dz;
+            }
+         }
+         else {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               z = ppart[2+idimp*(j+joff+npoff)];
+               nn = x;
+               mm = y;
+               ll = z;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               dzp = z - (float) ll;
+               n[j] = nn - noff + mxv*(mm - moff) + mxyv*(ll - loff);
+               amx = 1.0f - dxp;
+               amy = 1.0f - dyp;
+               amz = 1.0f - dzp;
+               dx = dxp*dxp;
+               dy = dyp*dyp;
+               dz = dzp*dzp;
+               sx[j] = sixth*amx*amx*amx;
+               sx[j+NPBLK] = twoth - dx*(1.0f - 0.5f*dxp);
+               sx[j+2*NPBLK] = sixth + 0.5f*(dxp + dx - dx*dxp);
+               sx[j+3*NPBLK] = sixth*dx*dxp;
+               sy[j] = sixth*amy*amy*amy;
+               sy[j+NPBLK] = twoth - dy*(1.0f - 0.5f*dyp);
+               sy[j+2*NPBLK] = sixth + 0.5f*(dyp + dy - dy*dyp);
+               sy[j+3*NPBLK] = sixth*dy*dyp;
+               sz[j] = sixth*amz*amz*amz;
+               sz[j+NPBLK] = twoth - dz*(1.0f - 0.5f*dzp);
+               sz[j+2*NPBLK] = sixth + 0.5f*(dzp + dz - dz*dzp);
+               sz[j+3*NPBLK] = sixth*dz*dzp;
+            }
+         }
+/* find acceleration */
+         for (j = 0; j < nps; j++) {
+            s[j] = 0.0f;
+            s[j+NPBLK] = 0.0f;
+            s[j+2*NPBLK] = 0.0f;
+         }
+         for (k = 0; k < ns; k++) {
+            for (m = 0; m < ns; m++) {
+               for (i = 0; i < ns; i++) {
+                  ii = 3*(i + mxv*m + mxyv*k);
+                  for (j = 0; j < nps; j++) {
+                     nn = 3*n[j] + ii;
+                     wx = sx[j+NPBLK*i]*sy[j+NPBLK*m]*sz[j+NPBLK*k];
+                     s[j] += wx*sfxyz[nn];
+                     s[j+NPBLK] += wx*sfxyz[nn+1];
+                     s[j+2*NPBLK] += wx*sfxyz[nn+2];
+                  }
+               }
+            }
+         }
+/* new velocity */
+         for (j = 0; j < nps; j++) {
+            x = ppart[idimp*(j+joff+npoff)];
+            y = ppart[1+idimp*(j+joff+npoff)];
+            z = ppart[2+idimp*(j+joff+npoff)];
+            vx = ppart[3+idimp*(j+joff+npoff)];
+            vy = ppart[4+idimp*(j+joff+npoff)];
+            vz = ppart[5+idimp*(j+joff+npoff)];
+            dx = vx + qtm*s[j];
+            dy = vy + qtm*s[j+NPBLK];
+            dz = vz + qtm*s[j+2*NPBLK];
+/* average kinetic energy */
+            vx += dx;
+            vy += dy;
+            vz += dz;
+            sum1 += vx*vx + vy*vy+ vz*vz;
+            ppart[3+idimp*(j+joff+npoff)] = dx;
+            ppart[4+idimp*(j+joff+npoff)] = dy;
+            ppart[5+idimp*(j+joff+npoff)] = dz;
+/* new position */
+            dx = x + dx*dt;
+            dy = y + dy*dt;
+            dz = z + dz*dt;
+/* find particles going out of bounds */
+            mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                             */
+            if (dx >= edgerx) {
+               if (dx >= anx)
+                  dx = dx - anx;
+               mm = 2;
+            }
+            else if (dx < edgelx) {
+               if (dx < 0.0f) {
+                  dx += anx;
+                  if (dx < anx)
+                     mm = 1;
+                  else
+                     dx = 0.0f;
+               }
+               else {
+                  mm = 1;
+               }
+            }
+            if (dy >= edgery) {
+               if (dy >= any)
+                  dy = dy - any;
+               mm += 6;
+            }
+            else if (dy < edgely) {
+               if (dy < 0.0f) {
+                  dy += any;
+                  if (dy < any)
+                     mm += 3;
+                  else
+                     dy = 0.0f;
+               }
+               else {
+                  mm += 3;
+               }
+            }
+            if (dz >= edgerz) {
+               if (dz >= anz)
+                  dz = dz - anz;
+               mm += 18;
+            }
+            else if (dz < edgelz) {
+               if (dz < 0.0f) {
+                  dz += anz;
+                  if (dz < anz)
+                     mm += 9;
+                  else
+                     dz = 0.0f;
+               }
+               else {
+                  mm += 9;
+               }
+            }
+/* set new position */
+            ppart[idimp*(j+joff+npoff)] = dx;
+            ppart[1+idimp*(j+joff+npoff)] = dy;
+            ppart[2+idimp*(j+joff+npoff)] = dz;
+/* increment counters */
+            if (mm > 0) {
+               ncl[mm+26*l-1] += 1;
+               ih += 1;
+               if (ih <= ntmax) {
+                  ihole[2*(ih+(ntmax+1)*l)] = j + joff + 1;
+                  ihole[1+2*(ih+(ntmax+1)*l)] = mm;
+               }
+               else {
+                  nh = 1;
+               }
+            }
+         }
+      }
+      sum2 += sum1;
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*l] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef LSTEN
+#undef NPBLK
+#undef MXV
+#undef MYV
+#undef MZV
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost3s(float ppart[], float q[], int kpic[], float qm,
+               int nppmx, int idimp, int nx, int ny, int nz, int mx,
+               int my, int mz, int nxv, int nyv, int nzv, int mx1,
+               int my1, int mxyz1, int nord) {
+/* for 3d code, this subroutine calculates particle charge density
+   using second-order quadratic or third-order cubic spline
+   interpolation, periodic boundaries
+   vectorizable/OpenMP version
+   data deposited in tiles, with guards of one grid below and two grids
+   above each tile, which are added to the periodic interior of q
+   particles stored segmented array
+   quadratic: 80 flops/particle, 30 loads, 27 stores
+   cubic: 150 flops/particle, 70 loads, 64 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest nord+1 grid
+   points in each direction:
+   q(n,m,l) = qm*sx(n)*sy(m)*sz(l), with weights as in cgppushf3s
+   ppart[m][n][0] = position x of particle n in tile m
+   ppart[m][n][1] = position y of particle n in tile m
+   ppart[m][n][2] = position z of particle n in tile m
+   q[l][k][j] = charge density at grid point j,k,l
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 6
+   nx/ny/nz = system length in x/y/z direction
+   mx/my/mz = number of grids in sorting cell in x/y/z
+   nxv = first dimension of charge array, must be >= nx
+   nyv = second dimension of charge array, must be >= ny
+   nzv = third dimension of charge array, must be >= nz
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   mxyz1 = mx1*my1*mz1,
+   where mz1 = (system length in z direction - 1)/mz + 1
+   nord = order of spline interpolation, 2 = quadratic, 3 = cubic
+   guard cells of q are not used
+local data                                                            */
+#define MXV             19
+#define MYV             19
+#define MZV             19
+#define NPBLK           32
+#define LSTEN           4
+   int mxy1, noff, moff, loff, npoff, npp, joff, nps;
+   int i, j, k, l, m, nn, mm, ll, ii, ns, mxv, myv, mxyv, nxyv;
+   float x, y, z, dxp, dyp, dzp, amx, amy, amz, dx, dy, dz;
+   float sixth = 1.0f/6.0f, twoth = 2.0f/3.0f;
+   float sq[MXV*MYV*MZV];
+/* float sq[(mx+3)*(my+3)*(mz+3)]; */
+/* scratch arrays */
+   int n[NPBLK];
+   float sx[NPBLK*LSTEN], sy[NPBLK*LSTEN], sz[NPBLK*LSTEN];
+   ns = nord + 1;
+   mxv = mx+3;
+   myv = my+3;
+   mxyv = mxv*myv;
+   nxyv = nxv*nyv;
+   mxy1 = mx1*my1;
+/* error if local array is too small                      */
+/* if ((mx+3 > MXV) || (my+3 > MYV) || (mz+3 > MZV))      */
+/*    return;                                             */
+#pragma omp parallel for \
+private(i,j,k,l,m,noff,moff,loff,npp,npoff,joff,nps,nn,mm,ll,ii,x,y,z, \
+dxp,dyp,dzp,amx,amy,amz,dx,dy,dz,sq,n,sx,sy,sz)
+   for (l = 0; l < mxyz1; l++) {
+      loff = l/mxy1;
+      k = l - mxy1*loff;
+      loff = mz*loff;
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[l];
+      npoff = nppmx*l;
+/* zero out local accumulator */
+      for (j = 0; j < mxyv*(mz+3); j++) {
+         sq[j] = 0.0f;
+      }
+/* loop over blocks of particles in tile */
+      for (joff = 0; joff < npp; joff += NPBLK) {
+         nps = npp - joff;
+         nps = NPBLK < nps ? NPBLK : nps;
+/* find interpolation weights */
+         if (nord==2) {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               z = ppart[2+idimp*(j+joff+npoff)];
+               nn = x + 0.5f;
+               mm = y + 0.5f;
+               ll = z + 0.5f;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               dzp = z - (float) ll;
+               n[j] = nn - noff + mxv*(mm - moff) + mxyv*(ll - loff);
+               amx = 0.5f - dxp;
+               amy = 0.5f - dyp;
+               amz = 0.5f - dzp;
+               dx = 0.5f + dxp;
+               dy = 0.5f + dyp;
+               dz = 0.5f + dzp;
+               sx[j] = 0.5f*qm*amx*amx;
+               sx[j+NPBLK] = qm*(0.75f - dxp*dxp);
+               sx[j+2*NPBLK] = 0.5f*qm*dx*dx;
+               sy[j] = 0.5f*amy*amy;
+               sy[j+NPBLK] = 0.75f - dyp*dyp;
+               sy[j+2*NPBLK] = 0.5f*dy*dy;
+               sz[j] = 0.5f*amz*amz;
+               sz[j+NPBLK] = 0.75f - dzp*dzp;
+               sz[j+2*NPBLK] = 0.5f*dz*dz;
+            }
+         }
+         else {
+            for (j = 0; j < nps; j++) {
+               x = ppart[idimp*(j+joff+npoff)];
+               y = ppart[1+idimp*(j+joff+npoff)];
+               z = ppart[2+idimp*(j+joff+npoff)];
+               nn = x;
+               mm = y;
+               ll = z;
+               dxp = x - (float) nn;
+               dyp = y - (float) mm;
+               dzp = z - (float) ll;
+               n[j] = nn - noff + mxv*(mm - moff) + mxyv*(ll - loff);
+               amx = 1.0f - dxp;
+               amy = 1.0f - dyp;
+               amz = 1.0f - dzp;
+               dx = dxp*dxp;
+               dy = dyp*dyp;
+               dz = dzp*dzp;
+               sx[j] = sixth*qm*amx*amx*amx;
+               sx[j+NPBLK] = qm*(twoth - dx*(1.0f - 0.5f*dxp));
+               sx[j+2*NPBLK] = qm*(sixth + 0.5f*(dxp + dx - dx*dxp));
+               sx[j+3*NPBLK] = sixth*qm*dx*dxp;
+               sy[j] = sixth*amy*amy*amy;
+               sy[j+NPBLK] = twoth - dy*(1.0f - 0.5f*dyp);
+               sy[j+2*NPBLK] = sixth + 0.5f*(dyp + dy - dy*dyp);
+               sy[j+3*NPBLK] = sixth*dy*dyp;
+               sz[j] = sixth*amz*amz*amz;
+               sz[j+NPBLK] = twoth - dz*(1.0f - 0.5f*dzp);
+               sz[j+2*NPBLK] = sixth + 0.5f*(dzp + dz - dz*dzp);
+               sz[j+3*NPBLK] = sixth*dz*dzp;
+            }
+         }
+/* deposit charge within tile to local accumulator */
+         for (j = 0; j < nps; j++) {
+            nn = n[j];
+            for (k = 0; k < ns; k++) {
+               for (m = 0; m < ns; m++) {
+                  mm = nn + mxv*m + mxyv*k;
+                  dz = sy[j+NPBLK*m]*sz[j+NPBLK*k];
+                  for (i = 0; i < ns; i++) {
+                     sq[i+mm] += sx[j+NPBLK*i]*dz;
+                  }
+               }
+            }
+         }
+      }
+/* deposit charge to interior points in global array */
+/* interior points are not touched by any other tile */
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ll = nz - loff;
+      ll = mz < ll ? mz : ll;
+      for (k = 3; k < ll; k++) {
+         for (j = 3; j < mm; j++) {
+            for (i = 3; i < nn; i++) {
+               q[i+noff-1+nxv*(j+moff-1)+nxyv*(k+loff-1)]
+               += sq[i+mxv*j+mxyv*k];
+            }
+         }
+      }
+/* deposit charge to edge and guard points in global array */
+/* guard points wrap periodically */
+      for (k = 0; k < ll+3; k++) {
+         m = k + loff - 1;
+         m = m < 0 ? m + nz : m;
+         m = m < nz ? m : m - nz;
+         for (j = 0; j < mm+3; j++) {
+            ii = j + moff - 1;
+            ii = ii < 0 ? ii + ny : ii;
+            ii = ii < ny ? ii : ii - ny;
+            ii = nxv*ii + nxyv*m;
+            for (i = 0; i < nn+3; i++) {
+               if ((i >= 3) && (i < nn) && (j >= 3) && (j < mm)
+                  && (k >= 3) && (k < ll))
+                  continue;
+               joff = i + noff - 1;
+               joff = joff < 0 ? joff + nx : joff;
+               joff = joff < nx ? joff : joff - nx;
+#pragma omp atomic
+               q[joff+ii] += sq[i+mxv*j+mxyv*k];
+            }
+         }
+      }
+   }
+   return;
+#undef LSTEN
+#undef NPBLK
+#undef MXV
+#undef MYV
+#undef MZV
+}
+
 /*--------------------------------------------------------------------*/
 void ccguard3l(float fxyz[], int nx, int ny, int nz, int nxe, int nye,
                int nze) {
@@ -3363,6 +3933,29 @@ void cpporderf3l_(float *ppart, float *ppbuff, int *kpic, int *ncl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cgppushf3s_(float *ppart, float *fxyz, int *kpic, int *ncl,
+                 int *ihole, float *qbm, float *dt, float *ek,
+                 int *idimp, int *nppmx, int *nx, int *ny, int *nz,
+                 int *mx, int *my, int *mz, int *nxv, int *nyv,
+                 int *nzv, int *mx1, int *my1, int *mxyz1, int *ntmax,
+                 int *nord, int *irc) {
+   cgppushf3s(ppart,fxyz,kpic,ncl,ihole,*qbm,*dt,ek,*idimp,*nppmx,*nx,
+              *ny,*nz,*mx,*my,*mz,*nxv,*nyv,*nzv,*mx1,*my1,*mxyz1,
+              *ntmax,*nord,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgppost3s_(float *ppart, float *q, int *kpic, float *qm,
+                int *nppmx, int *idimp, int *nx, int *ny, int *nz,
+                int *mx, int *my, int *mz, int *nxv, int *nyv, int *nzv,
+                int *mx1, int *my1, int *mxyz1, int *nord) {
+   cgppost3s(ppart,q,kpic,*qm,*nppmx,*idimp,*nx,*ny,*nz,*mx,*my,*mz,
+             *nxv,*nyv,*nzv,*mx1,*my1,*mxyz1,*nord);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void ccguard3l_(float *fxyz, int *nx, int *ny, int *nz, int *nxe,
                 int *nye, int *nze) {
@@ -42,6 +42,17 @@ void cpporderf3l(float ppart[], float ppbuff[], int kpic[], int ncl[],
                  int ihole[], int idimp, int nppmx, int mx1, int my1,
                  int mz1, int npbmx, int ntmax, int *irc);
 
+void cgppushf3s(float ppart[], float fxyz[], int kpic[], int ncl[],
+                int ihole[], float qbm, float dt, float *ek, int idimp,
+                int nppmx, int nx, int ny, int nz, int mx, int my,
+                int mz, int nxv, int nyv, int nzv, int mx1, int my1,
+                int mxyz1, int ntmax, int nord, int *irc);
+
+void cgppost3s(float ppart[], float q[], int kpic[], float qm,
+               int nppmx, int idimp, int nx, int ny, int nz, int mx,
+               int my, int mz, int nxv, int nyv, int nzv, int mx1,
+               int my1, int mxyz1, int nord);
+
 void ccguard3l(float fxyz[], int nx, int ny, int nz, int nxe, int nye,
                int nze);
 
@@ -54,6 +54,9 @@ int main(int argc, char *argv[]) {
 
 /* declare scalars for MPI code */
    int ntpose = 1;
+/* kshm = (0,1) = (no,yes) use shared memory window to exchange guard */
+/* cells and particles with neighbors on the same node */
+   int kshm = 0, nshm = 0, nsize;
    int nvp, idproc, kstrt, npmax, kxp, kyp, nypmx, nypmn;
    int nyp, noff, npp, nps, myp1, mxyp1;
 
@@ -250,6 +253,13 @@ int main(int argc, char *argv[]) {
    mcll = (int *) malloc(3*mxyp1*sizeof(int));
    mclr = (int *) malloc(3*mxyp1*sizeof(int));
 
+/* create shared memory window for neighbors on the same node */
+   if (kshm==1) {
+      nsize = 3*mx1 + idimp*nbmaxp;
+      nsize = ndim*nxe > nsize ? ndim*nxe : nsize;
+      cppshminit2(nsize,kstrt,nvp,&nshm);
+   }
+
 /* copy ordered particle data for OpenMP */
    cpppmovin2l(part,ppart,kpic,npp,noff,nppmx0,idimp,npmax,mx,my,mx1,
                   mxyp1,&irc);
@@ -593,6 +603,8 @@ L2000:
    if (kstrt==1) {
       printf("ntime, relativity = %i,%i\n",ntime,relativity);
       printf("MPI nodes nvp = %i\n",nvp);
+      if (nshm > 1)
+         printf("MPI nodes sharing memory window nshm = %i\n",nshm);
       wt = we + wf + wm;
       printf("Final Total Field, Kinetic and Total Energies:\n");
       printf("%e %e %e\n",wt,wke,wke+wt);
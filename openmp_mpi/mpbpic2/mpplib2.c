@@ -26,6 +26,9 @@
             distributed in x.
    cpppmove2 moves particles into appropriate spatial regions for tiled
              distributed data.
+   cppshminit2 creates a shared memory window used by cppncguard2l,
+               cppnaguard2l, cppnacguard2l and cpppmove2 to exchange
+               data with neighbors on the same node.
    written by viktor k. decyk, ucla
    copyright 1995, regents of the university of california
    update: may 10, 2015                                         */
@@ -54,6 +57,20 @@ static MPI_Op msum, mmax;
 
 static FILE *unit2 = NULL;
 
+/* shared memory window for nearest neighbors on the same node
+   lshm = communicator for processors on the same node
+   wshm = shared memory window, with 4 slots on each processor:
+   data sent to left and right processor, for two alternating sets
+   kshm = (0,1) = shared memory window is (not used,used)
+   kpar = set of slots used by next exchange
+   nslot = size of one slot, in words
+   shms = own slots
+   shml/shmr = slots of left/right processor, NULL if on another node */
+static MPI_Comm lshm = MPI_COMM_NULL;
+static MPI_Win wshm = MPI_WIN_NULL;
+static int kshm = 0, kpar = 0, nslot = 0;
+static float *shms = NULL, *shml = NULL, *shmr = NULL;
+
 float vresult(float prec) {
    float vresult;
    vresult = prec;
@@ -141,6 +158,13 @@ local data */
 /* indicate whether MPI_INIT has been called */
    ierror = MPI_Initialized(&flag);
    if (flag) {
+/* free shared memory window */
+      if (kshm==1) {
+         ierror = MPI_Win_unlock_all(wshm);
+         ierror = MPI_Win_free(&wshm);
+         ierror = MPI_Comm_free(&lshm);
+         kshm = 0;
+      }
 /* synchronize processes */
       ierror = MPI_Barrier(lworld);
 /* terminate MPI execution environment */
@@ -265,6 +289,24 @@ local data */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+static float *cppshmslot(float *base, int kd) {
+/* returns address of slot in current set for data sent to
+   left (kd = 0) or right (kd = 1) processor */
+   return &base[nslot*(kd + 2*kpar)];
+}
+
+/*--------------------------------------------------------------------*/
+static void cppshmsync() {
+/* makes data written to own slots visible to other processors on the
+   same node, and waits until all of them have written their slots */
+   int ierr;
+   ierr = MPI_Win_sync(wshm);
+   ierr = MPI_Barrier(lshm);
+   ierr = MPI_Win_sync(wshm);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppncguard2l(float f[], int nyp, int kstrt, int nvp, int nxv,
                   int nypmx) {
@@ -281,7 +323,8 @@ void cppncguard2l(float f[], int nyp, int kstrt, int nvp, int nxv,
    linear interpolation, for distributed data
 local data */
    int j, ks, moff, kl, kr, ierr;
-   MPI_Request msid;
+   float *sl;
+   MPI_Request msid, msid2;
    MPI_Status istatus;
 /* special case for one processor */
    if (nvp==1) {
@@ -299,6 +342,32 @@ local data */
    kl = ks - 1;
    if (kl < 0)
       kl = kl + nvp;
+/* this segment is used for shared memory neighbors */
+   if ((kshm==1) && (nxv <= nslot)) {
+      if (shmr==NULL)
+         ierr = MPI_Irecv(&f[nxv*nyp],nxv,mreal,kr,moff,lgrp,&msid);
+      if (shml==NULL)
+         ierr = MPI_Isend(f,nxv,mreal,kl,moff,lgrp,&msid2);
+      else {
+         sl = cppshmslot(shms,0);
+         for (j = 0; j < nxv; j++) {
+            sl[j] = f[j];
+         }
+      }
+      cppshmsync();
+      if (shmr==NULL)
+         ierr = MPI_Wait(&msid,&istatus);
+      else {
+         sl = cppshmslot(shmr,0);
+         for (j = 0; j < nxv; j++) {
+            f[j+nxv*nyp] = sl[j];
+         }
+      }
+      if (shml==NULL)
+         ierr = MPI_Wait(&msid2,&istatus);
+      kpar = 1 - kpar;
+      return;
+   }
 /* this segment is used for mpi computers */
    ierr = MPI_Irecv(&f[nxv*nyp],nxv,mreal,kr,moff,lgrp,&msid);
    ierr = MPI_Send(f,nxv,mreal,kl,moff,lgrp);
@@ -324,7 +393,8 @@ void cppnaguard2l(float f[], float scr[], int nyp, int nx, int kstrt,
    linear interpolation, for distributed data
 local data */
    int j, nx1, ks, moff, kl, kr, ierr;
-   MPI_Request msid;
+   float *sl;
+   MPI_Request msid, msid2;
    MPI_Status istatus;
    nx1 = nx + 1;
 /* special case for one processor */
@@ -344,6 +414,40 @@ local data */
    kl = ks - 1;
    if (kl < 0)
       kl = kl + nvp;
+/* this segment is used for shared memory neighbors */
+/* guard cells from left processor are added in place */
+   if ((kshm==1) && (nxv <= nslot)) {
+      if (shml==NULL)
+         ierr = MPI_Irecv(scr,nxv,mreal,kl,moff,lgrp,&msid);
+      if (shmr==NULL)
+         ierr = MPI_Isend(&f[nxv*nyp],nxv,mreal,kr,moff,lgrp,&msid2);
+      else {
+         sl = cppshmslot(shms,1);
+         for (j = 0; j < nx1; j++) {
+            sl[j] = f[j+nxv*nyp];
+         }
+      }
+      cppshmsync();
+      if (shml==NULL) {
+         ierr = MPI_Wait(&msid,&istatus);
+         for (j = 0; j < nx1; j++) {
+            f[j] += scr[j];
+         }
+      }
+      else {
+         sl = cppshmslot(shml,1);
+         for (j = 0; j < nx1; j++) {
+            f[j] += sl[j];
+         }
+      }
+      if (shmr==NULL)
+         ierr = MPI_Wait(&msid2,&istatus);
+      for (j = 0; j < nx1; j++) {
+         f[j+nxv*nyp] = 0.0;
+      }
+      kpar = 1 - kpar;
+      return;
+   }
 /* this segment is used for mpi computers */
    ierr = MPI_Irecv(scr,nxv,mreal,kl,moff,lgrp,&msid);
    ierr = MPI_Send(&f[nxv*nyp],nxv,mreal,kr,moff,lgrp);
@@ -376,7 +480,8 @@ void cppnacguard2l(float f[], float scr[], int nyp, int nx, int ndim,
 local data */
    int j, n, nx1, ks, moff, kl, kr, ierr;
    int nnxv;
-   MPI_Request msid;
+   float *sl;
+   MPI_Request msid, msid2;
    MPI_Status istatus;
    nx1 = nx + 1;
 /* special case for one processor */
@@ -399,6 +504,37 @@ local data */
    kl = ks - 1;
    if (kl < 0)
       kl = kl + nvp;
+/* this segment is used for shared memory neighbors */
+/* guard cells from left processor are added in place */
+   if ((kshm==1) && (nnxv <= nslot)) {
+      if (shml==NULL)
+         ierr = MPI_Irecv(scr,nnxv,mreal,kl,moff,lgrp,&msid);
+      if (shmr==NULL)
+         ierr = MPI_Isend(&f[nnxv*nyp],nnxv,mreal,kr,moff,lgrp,&msid2);
+      else {
+         sl = cppshmslot(shms,1);
+         for (j = 0; j < ndim*nx1; j++) {
+            sl[j] = f[j+nnxv*nyp];
+         }
+      }
+      cppshmsync();
+      if (shml==NULL) {
+         ierr = MPI_Wait(&msid,&istatus);
+         sl = scr;
+      }
+      else
+         sl = cppshmslot(shml,1);
+      for (j = 0; j < nx1; j++) {
+         for (n = 0; n < ndim; n++) {
+            f[n+ndim*j] += sl[n+ndim*j];
+            f[n+ndim*(j+nxv*nyp)] = 0.0;
+         }
+      }
+      if (shmr==NULL)
+         ierr = MPI_Wait(&msid2,&istatus);
+      kpar = 1 - kpar;
+      return;
+   }
 /* this segment is used for mpi computers */
    ierr = MPI_Irecv(scr,nnxv,mreal,kl,moff,lgrp,&msid);
    ierr = MPI_Send(&f[nnxv*nyp],nnxv,mreal,kr,moff,lgrp);
@@ -634,9 +770,11 @@ void cpppmove2(float sbufr[], float sbufl[], float rbufr[],
    nbmax =  size of buffers for passing particles between processors
    mx1 = (system length in x direction - 1)/mx + 1
 local data */
-   int ierr, ks, kl, kr, i, j, jsl, jsr;
+   int ierr, ks, kl, kr, i, j, jsl, jsr, nr;
    int nbsize, ncsize;
    int itg[4] = {3,4,5,6};
+   int *ms;
+   float *sl;
    MPI_Request msid[8];
    MPI_Status istatus;
    ks = kstrt - 1;
@@ -666,6 +804,89 @@ local data */
          }
       }
    }
+/* this segment is used for shared memory neighbors */
+/* each slot holds particle number offsets followed by particles */
+   else if ((kshm==1) && (ncsize+nbsize <= nslot)) {
+      kr = ks + 1;
+      if (kr >= nvp)
+         kr -= nvp;
+      kl = ks - 1;
+      if (kl < 0)
+         kl += nvp;
+      nr = 0;
+/* post receives from other nodes */
+      if (shml==NULL) {
+         ierr = MPI_Irecv(mcll,ncsize,mint,kl,itg[0],lgrp,&msid[nr]);
+         ierr = MPI_Irecv(rbufl,nbsize,mreal,kl,itg[2],lgrp,&msid[nr+1]);
+         nr += 2;
+      }
+      if (shmr==NULL) {
+         ierr = MPI_Irecv(mclr,ncsize,mint,kr,itg[1],lgrp,&msid[nr]);
+         ierr = MPI_Irecv(rbufr,nbsize,mreal,kr,itg[3],lgrp,&msid[nr+1]);
+         nr += 2;
+      }
+/* send particles to right processor */
+      jsr = idimp*nclr[3*mx1-1];
+      if (shmr==NULL) {
+         ierr = MPI_Isend(nclr,ncsize,mint,kr,itg[0],lgrp,&msid[nr]);
+         ierr = MPI_Isend(sbufr,jsr,mreal,kr,itg[2],lgrp,&msid[nr+1]);
+         nr += 2;
+      }
+      else {
+         sl = cppshmslot(shms,1);
+         ms = (int *) sl;
+         for (j = 0; j < ncsize; j++) {
+            ms[j] = nclr[j];
+         }
+         for (j = 0; j < jsr; j++) {
+            sl[j+ncsize] = sbufr[j];
+         }
+      }
+/* send particles to left processor */
+      jsl = idimp*ncll[3*mx1-1];
+      if (shml==NULL) {
+         ierr = MPI_Isend(ncll,ncsize,mint,kl,itg[1],lgrp,&msid[nr]);
+         ierr = MPI_Isend(sbufl,jsl,mreal,kl,itg[3],lgrp,&msid[nr+1]);
+         nr += 2;
+      }
+      else {
+         sl = cppshmslot(shms,0);
+         ms = (int *) sl;
+         for (j = 0; j < ncsize; j++) {
+            ms[j] = ncll[j];
+         }
+         for (j = 0; j < jsl; j++) {
+            sl[j+ncsize] = sbufl[j];
+         }
+      }
+      cppshmsync();
+/* copy particles from neighbors on the same node */
+      if (shml != NULL) {
+         sl = cppshmslot(shml,1);
+         ms = (int *) sl;
+         for (j = 0; j < ncsize; j++) {
+            mcll[j] = ms[j];
+         }
+         for (j = 0; j < idimp*mcll[3*mx1-1]; j++) {
+            rbufl[j] = sl[j+ncsize];
+         }
+      }
+      if (shmr != NULL) {
+         sl = cppshmslot(shmr,0);
+         ms = (int *) sl;
+         for (j = 0; j < ncsize; j++) {
+            mclr[j] = ms[j];
+         }
+         for (j = 0; j < idimp*mclr[3*mx1-1]; j++) {
+            rbufr[j] = sl[j+ncsize];
+         }
+      }
+      for (i = 0; i < nr; i++) {
+         ierr = MPI_Wait(&msid[i],&istatus);
+      }
+      kpar = 1 - kpar;
+      return;
+   }
 /* this segment is used for mpi computers */
    else {
 /* get particles from below and above */
@@ -702,6 +923,70 @@ local data */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppshminit2(int nsize, int kstrt, int nvp, int *nshm) {
+/* this subroutine creates a shared memory window with MPI-3 for the
+   processors on the same node.  afterwards, cppncguard2l, cppnaguard2l,
+   cppnacguard2l and cpppmove2 copy data for nearest neighbors on the
+   same node directly to and from the window, and only use messages for
+   neighbors on other nodes.  messages larger than nsize words always
+   use messages.  the window is freed by cppexit.
+   output: nshm
+   nsize = maximum number of words in a message to a neighbor,
+   for cpppmove2, this is 3*mx1 + idimp*nbmax
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   nshm = number of processors on this node, if nshm < 2, the shared
+   memory window is not used
+local data */
+   int ierr, ks, kl, kr, idisp;
+   int kn[2], kns[2];
+   MPI_Aint wsize;
+   MPI_Group gwrld, gshm;
+   *nshm = 0;
+   if ((nvp==1) || (kshm==1))
+      return;
+   ks = kstrt - 1;
+   kr = ks + 1;
+   if (kr >= nvp)
+      kr -= nvp;
+   kl = ks - 1;
+   if (kl < 0)
+      kl += nvp;
+/* find processors on this node */
+   ierr = MPI_Comm_split_type(lgrp,MPI_COMM_TYPE_SHARED,ks,
+                              MPI_INFO_NULL,&lshm);
+   ierr = MPI_Comm_size(lshm,nshm);
+   if (*nshm < 2) {
+      ierr = MPI_Comm_free(&lshm);
+      return;
+   }
+/* find ranks of neighbors on this node, MPI_UNDEFINED if not found */
+   kn[0] = kl;
+   kn[1] = kr;
+   ierr = MPI_Comm_group(lgrp,&gwrld);
+   ierr = MPI_Comm_group(lshm,&gshm);
+   ierr = MPI_Group_translate_ranks(gwrld,2,kn,gshm,kns);
+   ierr = MPI_Group_free(&gwrld);
+   ierr = MPI_Group_free(&gshm);
+/* allocate window, ints and reals are assumed to be the same size */
+   nslot = nsize;
+   wsize = 4*nslot*sizeof(float);
+   ierr = MPI_Win_allocate_shared(wsize,sizeof(float),MPI_INFO_NULL,
+                                  lshm,&shms,&wshm);
+/* find slots of neighbors */
+   shml = NULL;
+   shmr = NULL;
+   if (kns[0] != MPI_UNDEFINED)
+      ierr = MPI_Win_shared_query(wshm,kns[0],&wsize,&idisp,&shml);
+   if (kns[1] != MPI_UNDEFINED)
+      ierr = MPI_Win_shared_query(wshm,kns[1],&wsize,&idisp,&shmr);
+   ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK,wshm);
+   kpar = 0;
+   kshm = 1;
+   return;
+}
+
 /* Interfaces to Fortran */
 
 /*--------------------------------------------------------------------*/
@@ -798,3 +1083,9 @@ void cpppmove2_(float *sbufr, float *sbufl, float *rbufr, float *rbufl,
              *idimp,*nbmax,*mx1);
    return;
 }
+
+/*--------------------------------------------------------------------*/
+void cppshminit2_(int *nsize, int *kstrt, int *nvp, int *nshm) {
+   cppshminit2(*nsize,*kstrt,*nvp,nshm);
+   return;
+}
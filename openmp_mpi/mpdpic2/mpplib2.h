@@ -38,3 +38,5 @@ void cpppmove2(float sbufr[], float sbufl[], float rbufr[],
                float rbufl[], int ncll[], int nclr[], int mcll[],
                int mclr[], int kstrt, int nvp, int idimp, int nbmax,
                int mx1);
+
+void cppshminit2(int nsize, int kstrt, int nvp, int *nshm);
@@ -39,6 +39,9 @@ int main(int argc, char *argv[]) {
    int mx = 16, my = 16;
 /* fraction of extra particles needed for particle management */
    float xtras = 0.2;
+/* kpipe = (0,1) = particles leaving node are sent (after, while) */
+/* interior tiles are pushed                                       */
+   int kpipe = 0;
 /* declare scalars for standard code */
    int j;
    int nx, ny, nxh, nyh, nxe, nye, nxeh, nnxe, nxyh, nxhy;
@@ -309,52 +312,132 @@ L500: if (nloop <= ntime)
       time = (float) dtime;
       tguard += time;
 
+/* push particles and send particles leaving node after all tiles */
+      if (kpipe==0) {
 /* push particles with OpenMP: */
-      dtimer(&dtime,&itime,-1);
-      wke = 0.0;
+         dtimer(&dtime,&itime,-1);
+         wke = 0.0;
 /* updates ppart and wke */
 /*    cppgppush2l(ppart,fxye,kpic,noff,nyp,qbme,dt,&wke,nx,ny,mx,my, */
 /*                idimp,nppmx0,nxe,nypmx,mx1,mxyp1,ipbc);            */
 /* updates ppart, wke, ncl, iholep, irc */
-      cppgppushf2l(ppart,fxye,kpic,ncl,iholep,noff,nyp,qbme,dt,&wke,nx,
-                   ny,mx,my,idimp,nppmx0,nxe,nypmx,mx1,mxyp1,ntmaxp,
-                   &irc);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tpush += time;
-      if (irc != 0) { 
-         printf("%d,cppgppushf2l error: irc=%d\n",kstrt,irc);
-         cppabort();
-         exit(1);
-      }
+         cppgppushf2l(ppart,fxye,kpic,ncl,iholep,noff,nyp,qbme,dt,&wke,
+                      nx,ny,mx,my,idimp,nppmx0,nxe,nypmx,mx1,mxyp1,
+                      ntmaxp,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tpush += time;
+         if (irc != 0) { 
+            printf("%d,cppgppushf2l error: irc=%d\n",kstrt,irc);
+            cppabort();
+            exit(1);
+         }
 
 /* reorder particles by tile with OpenMP */
 /* first part of particle reorder on x and y cell with mx, my tiles: */
-      dtimer(&dtime,&itime,-1);
+         dtimer(&dtime,&itime,-1);
 /* updates ppart, ppbuff, sbufl, sbufr, ncl, iholep, ncll, nclr, irc */
 /*    cppporder2la(ppart,ppbuff,sbufl,sbufr,kpic,ncl,iholep,ncll,nclr, */
 /*                 noff,nyp,idimp,nppmx0,nx,ny,mx,my,mx1,myp1,npbmx,   */
 /*                 ntmaxp,nbmaxp,&irc);                                */
 /* updates: ppart, ppbuff, sbufl, sbufr, ncl, ncll, nclr, irc */
-      cppporderf2la(ppart,ppbuff,sbufl,sbufr,ncl,iholep,ncll,nclr,
-                    idimp,nppmx0,mx1,myp1,npbmx,ntmaxp,nbmaxp,&irc);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tsort += time;
-      if (irc != 0) {
-         printf("%d,cppporderf2la error:ntmaxp,irc=%d,%d\n",kstrt,
-                ntmaxp,irc);
-         cppabort();
-         exit(1);
-      }
+         cppporderf2la(ppart,ppbuff,sbufl,sbufr,ncl,iholep,ncll,nclr,
+                       idimp,nppmx0,mx1,myp1,npbmx,ntmaxp,nbmaxp,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tsort += time;
+         if (irc != 0) {
+            printf("%d,cppporderf2la error:ntmaxp,irc=%d,%d\n",kstrt,
+                   ntmaxp,irc);
+            cppabort();
+            exit(1);
+         }
 /* move particles into appropriate spatial regions: */
 /* updates rbufr, rbufl, mcll, mclr */
-      dtimer(&dtime,&itime,-1);
-      cpppmove2(sbufr,sbufl,rbufr,rbufl,ncll,nclr,mcll,mclr,kstrt,nvp,
-                idimp,nbmaxp,mx1);
-      dtimer(&dtime,&itime,1);
-      time = (float) dtime;
-      tmov += time;
+         dtimer(&dtime,&itime,-1);
+         cpppmove2(sbufr,sbufl,rbufr,rbufl,ncll,nclr,mcll,mclr,kstrt,
+                   nvp,idimp,nbmaxp,mx1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tmov += time;
+      }
+/* push particles and send particles leaving node while interior tiles */
+/* are pushed                                                          */
+      else {
+/* push particles in first and last row of tiles with OpenMP: */
+/* updates ppart, wke, ncl, iholep, irc */
+         dtimer(&dtime,&itime,-1);
+         wke = 0.0;
+         cppgppushf2lr(ppart,fxye,kpic,ncl,iholep,noff,nyp,qbme,dt,&wke,
+                       nx,ny,mx,my,idimp,nppmx0,nxe,nypmx,mx1,mxyp1,
+                       ntmaxp,1,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tpush += time;
+         if (irc != 0) { 
+            printf("%d,cppgppushf2lr error: irc=%d\n",kstrt,irc);
+            cppabort();
+            exit(1);
+         }
+/* buffer particles leaving first and last row of tiles, and leaving */
+/* node: updates ppart, ppbuff, sbufl, sbufr, ncl, ncll, nclr, irc   */
+         dtimer(&dtime,&itime,-1);
+         cppporderf2lr(ppart,ppbuff,ncl,iholep,idimp,nppmx0,mx1,myp1,
+                       npbmx,ntmaxp,1,&irc);
+         if (irc==0)
+            cppporderf2ls(ppbuff,sbufl,sbufr,ncl,ncll,nclr,idimp,mx1,
+                          myp1,npbmx,nbmaxp,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tsort += time;
+         if (irc != 0) {
+            printf("%d,cppporderf2lr error:ntmaxp,irc=%d,%d\n",kstrt,
+                   ntmaxp,irc);
+            cppabort();
+            exit(1);
+         }
+/* start moving particles into appropriate spatial regions: */
+         dtimer(&dtime,&itime,-1);
+         cpppmove2s(sbufr,sbufl,rbufr,rbufl,ncll,nclr,mcll,mclr,kstrt,
+                    nvp,idimp,nbmaxp,mx1);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tmov += time;
+/* push particles in interior tiles with OpenMP: */
+/* updates ppart, wke, ncl, iholep, irc */
+         dtimer(&dtime,&itime,-1);
+         cppgppushf2lr(ppart,fxye,kpic,ncl,iholep,noff,nyp,qbme,dt,&wke,
+                       nx,ny,mx,my,idimp,nppmx0,nxe,nypmx,mx1,mxyp1,
+                       ntmaxp,2,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tpush += time;
+         if (irc != 0) { 
+            printf("%d,cppgppushf2lr error: irc=%d\n",kstrt,irc);
+            cppabort();
+            exit(1);
+         }
+/* buffer particles leaving interior tiles: updates ppbuff, ncl, irc */
+         dtimer(&dtime,&itime,-1);
+         cppporderf2lr(ppart,ppbuff,ncl,iholep,idimp,nppmx0,mx1,myp1,
+                       npbmx,ntmaxp,2,&irc);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tsort += time;
+         if (irc != 0) {
+            printf("%d,cppporderf2lr error:ntmaxp,irc=%d,%d\n",kstrt,
+                   ntmaxp,irc);
+            cppabort();
+            exit(1);
+         }
+/* wait for particles: updates rbufr, rbufl, mcll, mclr */
+         dtimer(&dtime,&itime,-1);
+         cpppmove2w(nvp);
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tmov += time;
+      }
+
 /* second part of particle reorder on x and y cell with mx, my tiles: */
 /* updates ppart, kpic */
       dtimer(&dtime,&itime,-1);
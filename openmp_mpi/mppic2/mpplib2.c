@@ -26,6 +26,8 @@
             distributed in x.
    cpppmove2 moves particles into appropriate spatial regions for tiled
              distributed data.
+   cpppmove2s starts moving particles as in cpppmove2, without waiting.
+   cpppmove2w waits for the particles sent by cpppmove2s.
    written by viktor k. decyk, ucla
    copyright 1995, regents of the university of california
    update: may 10, 2015                                         */
@@ -54,6 +56,9 @@ static MPI_Op msum, mmax;
 
 static FILE *unit2 = NULL;
 
+/* mpreq = requests for particles being moved by cpppmove2s */
+static MPI_Request mpreq[8];
+
 float vresult(float prec) {
    float vresult;
    vresult = prec;
@@ -702,6 +707,80 @@ local data */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cpppmove2s(float sbufr[], float sbufl[], float rbufr[], 
+                float rbufl[], int ncll[], int nclr[], int mcll[],
+                int mclr[], int kstrt, int nvp, int idimp, int nbmax,
+                int mx1) {
+/* this subroutine starts moving particles into appropriate spatial
+   regions, for distributed data, with 1d domain decomposition in y.
+   the messages are posted but not waited for, so that other work can
+   be done while they are in transit.  the output is only valid after
+   cpppmove2w has been called, and the send buffers may not be changed
+   before then.  arguments are the same as for cpppmove2
+   output: rbufr, rbufl, mcll, mclr
+   sbufl = buffer for particles being sent to lower processor
+   sbufr = buffer for particles being sent to upper processor
+   rbufl = buffer for particles being received from lower processor
+   rbufr = buffer for particles being received from upper processor
+   ncll = particle number being sent to lower processor
+   nclr = particle number being sent to upper processor
+   mcll = particle number being received from lower processor
+   mclr = particle number being received from upper processor
+   kstrt = starting data block number
+   nvp = number of real or virtual processors
+   idimp = size of phase space = 4 or 5
+   nbmax =  size of buffers for passing particles between processors
+   mx1 = (system length in x direction - 1)/mx + 1
+local data */
+   int ierr, ks, kl, kr, jsl, jsr;
+   int nbsize, ncsize;
+   int itg[4] = {3,4,5,6};
+/* special case for one processor */
+   if (nvp==1) {
+      cpppmove2(sbufr,sbufl,rbufr,rbufl,ncll,nclr,mcll,mclr,kstrt,nvp,
+                idimp,nbmax,mx1);
+      return;
+   }
+   ks = kstrt - 1;
+   nbsize = idimp*nbmax;
+   ncsize = 3*mx1;
+/* get particles from below and above */
+   kr = ks + 1;
+   if (kr >= nvp)
+      kr -= nvp;
+   kl = ks - 1;
+   if (kl < 0)
+      kl += nvp;
+/* post receives */
+   ierr = MPI_Irecv(mcll,ncsize,mint,kl,itg[0],lgrp,&mpreq[0]);
+   ierr = MPI_Irecv(mclr,ncsize,mint,kr,itg[1],lgrp,&mpreq[1]);
+   ierr = MPI_Irecv(rbufl,nbsize,mreal,kl,itg[2],lgrp,&mpreq[2]);
+   ierr = MPI_Irecv(rbufr,nbsize,mreal,kr,itg[3],lgrp,&mpreq[3]);
+/* send particle number offsets and particles */
+   ierr = MPI_Isend(nclr,ncsize,mint,kr,itg[0],lgrp,&mpreq[4]);
+   ierr = MPI_Isend(ncll,ncsize,mint,kl,itg[1],lgrp,&mpreq[5]);
+   jsr = idimp*nclr[3*mx1-1];
+   ierr = MPI_Isend(sbufr,jsr,mreal,kr,itg[2],lgrp,&mpreq[6]);
+   jsl = idimp*ncll[3*mx1-1];
+   ierr = MPI_Isend(sbufl,jsl,mreal,kl,itg[3],lgrp,&mpreq[7]);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpppmove2w(int nvp) {
+/* this subroutine waits for the particles sent by cpppmove2s to arrive,
+   and for the send buffers to be free.
+   nvp = number of real or virtual processors
+local data */
+   int ierr;
+   MPI_Status istatus[8];
+   if (nvp==1)
+      return;
+   ierr = MPI_Waitall(8,mpreq,istatus);
+   return;
+}
+
 /* Interfaces to Fortran */
 
 /*--------------------------------------------------------------------*/
@@ -798,3 +877,18 @@ void cpppmove2_(float *sbufr, float *sbufl, float *rbufr, float *rbufl,
              *idimp,*nbmax,*mx1);
    return;
 }
+
+/*--------------------------------------------------------------------*/
+void cpppmove2s_(float *sbufr, float *sbufl, float *rbufr, float *rbufl,
+                 int *ncll, int *nclr, int *mcll, int *mclr, int *kstrt,
+                 int *nvp, int *idimp, int *nbmax, int *mx1) {
+   cpppmove2s(sbufr,sbufl,rbufr,rbufl,ncll,nclr,mcll,mclr,*kstrt,*nvp,
+              *idimp,*nbmax,*mx1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cpppmove2w_(int *nvp) {
+   cpppmove2w(*nvp);
+   return;
+}
@@ -38,3 +38,10 @@ void cpppmove2(float sbufr[], float sbufl[], float rbufr[],
                float rbufl[], int ncll[], int nclr[], int mcll[],
                int mclr[], int kstrt, int nvp, int idimp, int nbmax,
                int mx1);
+
+void cpppmove2s(float sbufr[], float sbufl[], float rbufr[], 
+                float rbufl[], int ncll[], int nclr[], int mcll[],
+                int mclr[], int kstrt, int nvp, int idimp, int nbmax,
+                int mx1);
+
+void cpppmove2w(int nvp);
@@ -577,6 +577,26 @@ void cppgppushf2l(float ppart[], float fxy[], int kpic[], int ncl[],
    interpolation in space, with periodic boundary conditions
    also determines list of particles which are leaving this tile
    OpenMP version using guard cells, for distributed data
+   all tiles are pushed, see cppgppushf2lr for details
+local data                                                            */
+   cppgppushf2lr(ppart,fxy,kpic,ncl,ihole,noff,nyp,qbm,dt,ek,nx,ny,mx,
+                 my,idimp,nppmx,nxv,nypmx,mx1,mxyp1,ntmax,0,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppgppushf2lr(float ppart[], float fxy[], int kpic[], int ncl[],
+                   int ihole[], int noff, int nyp, float qbm, float dt,
+                   float *ek, int nx, int ny, int mx, int my, int idimp,
+                   int nppmx, int nxv, int nypmx, int mx1, int mxyp1,
+                   int ntmax, int kt, int *irc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with periodic boundary conditions
+   also determines list of particles which are leaving this tile
+   OpenMP version using guard cells, for distributed data
+   only the tiles selected by kt are pushed, so that particles leaving
+   the node can be sent while the interior tiles are being pushed
    data read in tiles
    particles stored segmented array
    42 flops/particle, 12 loads, 4 stores
@@ -621,13 +641,15 @@ void cppgppushf2l(float ppart[], float fxy[], int kpic[], int ncl[],
    mx1 = (system length in x direction - 1)/mx + 1
    mxyp1 = mx1*myp1, where myp1=(partition length in y direction-1)/my+1
    ntmax = size of hole array for particles leaving tiles
+   kt = (0,1,2) = push (all tiles, tiles in first and last row in y,
+   tiles in the other rows)
    irc = maximum overflow, returned only if error occurs, when irc > 0
    optimized version
 local data                                                            */
 #define MXV             33
 #define MYV             33
-   int noffp, moffp, npoff, nppp;
-   int mnoff, i, j, k, ih, nh, nn, mm, mxv;
+   int noffp, moffp, npoff, nppp, myp1, kf, nf, ks, nt;
+   int mnoff, i, j, k, kk, ih, nh, nn, mm, mxv;
    float qtm, dxp, dyp, amx, amy;
    float x, y, dx, dy, vx, vy;
    float anx, any, edgelx, edgely, edgerx, edgery;
@@ -642,12 +664,32 @@ local data                                                            */
 /* error if local array is too small */
 /* if ((mx >= MXV) || (my >= MYV))   */
 /*    return;                        */
+/* find selected tiles: nt tiles starting at kf, skipping ks tiles */
+/* after the first nf tiles                                        */
+   myp1 = mxyp1/mx1;
+   kf = 0;
+   nt = mxyp1;
+   nf = nt;
+   ks = 0;
+   if (kt==1) {
+      nt = myp1 > 1 ? 2*mx1 : mx1;
+      nf = mx1;
+      ks = mx1*(myp1 - 2);
+   }
+   else if (kt==2) {
+      kf = mx1;
+      nt = myp1 > 2 ? mx1*(myp1 - 2) : 0;
+      nf = nt;
+   }
 /* loop over tiles */
 #pragma omp parallel for \
 private(i,j,k,noffp,moffp,nppp,npoff,nn,mm,ih,nh,mnoff,x,y,dxp,dyp, \
 amx,amy,dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1,sfxy) \
 reduction(+:sum2)
-   for (k = 0; k < mxyp1; k++) {
+   for (kk = 0; kk < nt; kk++) {
+      k = kk + kf;
+      if (kk >= nf)
+         k += ks;
       noffp = k/mx1;
       moffp = my*noffp;
       noffp = mx*(k - mx1*noffp);
@@ -1116,7 +1158,7 @@ L90: if (kk >= mx1)
    kk += kk;
    goto L90;
 L110: kk = mx1*(myp1 - 1);
-#pragma omp parallel for private(i,j,k,ii,nn,mm)
+#pragma omp parallel for private(i,j,k,ii,jj,nn,mm)
    for (k = 0; k < mx1; k++) {
       ii = ncl[4+8*k] - ncl[1+8*k];
       nn = ncll[3*k] - ii;
@@ -1194,14 +1236,75 @@ void cppporderf2la(float ppart[], float ppbuff[], float sbufl[],
    nbmax =  size of buffers for passing particles between processors
    irc = maximum overflow, returned only if error occurs, when irc > 0
 local data                                                            */
-   int mxyp1;
-   int i, j, k, ii, jj, nh, ist, nn, mm, isum, ip, j1, kk;
+/* buffer particles that are leaving tile: update ppbuff, ncl */
+   cppporderf2lr(ppart,ppbuff,ncl,ihole,idimp,nppmx,mx1,myp1,npbmx,ntmax,
+                 0,irc);
+/* ppbuff overflow */
+   if (*irc > 0)
+      return;
+/* buffer particles and their number leaving the node: */
+/* update sbufl, sbufr, ncll, nclr */
+   cppporderf2ls(ppbuff,sbufl,sbufr,ncl,ncll,nclr,idimp,mx1,myp1,npbmx,
+                 nbmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppporderf2lr(float ppart[], float ppbuff[], int ncl[],
+                   int ihole[], int idimp, int nppmx, int mx1, int myp1,
+                   int npbmx, int ntmax, int kt, int *irc) {
+/* this subroutine performs the first step of cppporderf2la for the
+   tiles selected by kt: a prefix scan of ncl is performed and departing
+   particles are buffered in ppbuff in direction order.
+   it assumes that the number, location, and destination of particles 
+   leaving a tile have been previously stored in ncl and ihole by the
+   cppgppushf2lr procedure with the same value of kt.
+   input: all except ppbuff, irc
+   output: ppbuff, ncl, irc
+   ppart[k][n][0] = position x of particle n in tile k
+   ppart[k][n][1] = position y of particle n in tile k 
+   ppbuff[k][n][i] = i co-ordinate of particle n in tile k
+   ncl(i,k) = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   mx1 = (system length in x direction - 1)/mx + 1
+   myp1 = (partition length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   kt = (0,1,2) = buffer (all tiles, tiles in first and last row in y,
+   tiles in the other rows)
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int mxyp1, kf, nf, ks, nt;
+   int i, j, k, kk, ii, nh, ist, isum, ip, j1;
    mxyp1 = mx1*myp1;
+/* find selected tiles */
+   kf = 0;
+   nt = mxyp1;
+   nf = nt;
+   ks = 0;
+   if (kt==1) {
+      nt = myp1 > 1 ? 2*mx1 : mx1;
+      nf = mx1;
+      ks = mx1*(myp1 - 2);
+   }
+   else if (kt==2) {
+      kf = mx1;
+      nt = myp1 > 2 ? mx1*(myp1 - 2) : 0;
+      nf = nt;
+   }
 /* buffer particles that are leaving tile: update ppbuff, ncl */
 /* loop over tiles */
 #pragma omp parallel for \
 private(i,j,k,isum,ist,nh,ip,j1,ii)
-   for (k = 0; k < mxyp1; k++) {
+   for (kk = 0; kk < nt; kk++) {
+      k = kk + kf;
+      if (kk >= nf)
+         k += ks;
 /* find address offset for ordered ppbuff array */
       isum = 0;
       for (j = 0; j < 8; j++) {
@@ -1232,12 +1335,34 @@ private(i,j,k,isum,ist,nh,ip,j1,ii)
       if (ip > 0)
          *irc = ncl[7+8*k];
    }
-/* ppbuff overflow */
-   if (*irc > 0)
-      return;
- 
-/* buffer particles and their number leaving the node: */
-/* update sbufl, sbufr, ncll, nclr */
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppporderf2ls(float ppbuff[], float sbufl[], float sbufr[],
+                   int ncl[], int ncll[], int nclr[], int idimp,
+                   int mx1, int myp1, int npbmx, int nbmax, int *irc) {
+/* this subroutine performs the second step of cppporderf2la: particles
+   leaving the processor are buffered in sbufl and sbufr, and particle
+   number offsets are stored in ncll and nclr.
+   it assumes that the particles leaving the tiles in the first and last
+   row in y have been buffered in ppbuff by cppporderf2lr.
+   input: all except sbufl, sbufr, ncll, nclr, irc
+   output: sbufl, sbufr, ncll, nclr, irc
+   ppbuff[k][n][i] = i co-ordinate of particle n in tile k
+   sbufl = buffer for particles being sent to lower processor
+   sbufr = buffer for particles being sent to upper processor
+   ncl(i,k) = number of particles going to destination i, tile k
+   ncll = number offset being sent to lower processor
+   nclr = number offset being sent to upper processor
+   idimp = size of phase space = 4
+   mx1 = (system length in x direction - 1)/mx + 1
+   myp1 = (partition length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   nbmax =  size of buffers for passing particles between processors
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+local data                                                            */
+   int i, j, k, ii, jj, nn, mm, kk;
    kk = mx1*(myp1 - 1);
 #pragma omp parallel for private(k)
    for (k = 0; k < mx1; k++) {
@@ -1262,7 +1387,7 @@ L90: if (kk >= mx1)
    kk += kk;
    goto L90;
 L110: kk = mx1*(myp1 - 1);
-#pragma omp parallel for private(i,j,k,ii,nn,mm)
+#pragma omp parallel for private(i,j,k,ii,jj,nn,mm)
    for (k = 0; k < mx1; k++) {
       ii = ncl[4+8*k] - ncl[1+8*k];
       nn = ncll[3*k] - ii;
@@ -2635,6 +2760,19 @@ void cppgppushf2l_(float *ppart, float *fxy, int *kpic, int *ncl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppgppushf2lr_(float *ppart, float *fxy, int *kpic, int *ncl,
+                    int *ihole, int *noff, int *nyp, float *qbm,
+                    float *dt, float *ek, int *nx, int *ny, int *mx,
+                    int *my, int *idimp, int *nppmx, int *nxv,
+                    int *nypmx, int *mx1, int *mxyp1, int *ntmax,
+                    int *kt, int *irc) {
+   cppgppushf2lr(ppart,fxy,kpic,ncl,ihole,*noff,*nyp,*qbm,*dt,ek,*nx,
+                 *ny,*mx,*my,*idimp,*nppmx,*nxv,*nypmx,*mx1,*mxyp1,
+                 *ntmax,*kt,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppgppost2l_(float *ppart, float *q, int *kpic, int *noff,
                   float *qm, int *idimp, int *nppmx, int *mx, int *my,
@@ -2668,6 +2806,24 @@ void cppporderf2la_(float *ppart, float *ppbuff, float *sbufl,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void cppporderf2lr_(float *ppart, float *ppbuff, int *ncl, int *ihole,
+                    int *idimp, int *nppmx, int *mx1, int *myp1,
+                    int *npbmx, int *ntmax, int *kt, int *irc) {
+   cppporderf2lr(ppart,ppbuff,ncl,ihole,*idimp,*nppmx,*mx1,*myp1,*npbmx,
+                 *ntmax,*kt,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cppporderf2ls_(float *ppbuff, float *sbufl, float *sbufr, int *ncl,
+                    int *ncll, int *nclr, int *idimp, int *mx1,
+                    int *myp1, int *npbmx, int *nbmax, int *irc) {
+   cppporderf2ls(ppbuff,sbufl,sbufr,ncl,ncll,nclr,*idimp,*mx1,*myp1,
+                 *npbmx,*nbmax,irc);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cppporder2lb_(float *ppart, float *ppbuff, float *rbufl,
                    float *rbufr, int *kpic, int *ncl, int *ihole,
@@ -32,6 +32,12 @@ void cppgppushf2l(float ppart[], float fxy[], int kpic[], int ncl[],
                   int nppmx, int nxv, int nypmx, int mx1, int mxyp1,
                   int ntmax, int *irc);
 
+void cppgppushf2lr(float ppart[], float fxy[], int kpic[], int ncl[],
+                   int ihole[], int noff, int nyp, float qbm, float dt,
+                   float *ek, int nx, int ny, int mx, int my, int idimp,
+                   int nppmx, int nxv, int nypmx, int mx1, int mxyp1,
+                   int ntmax, int kt, int *irc);
+
 void cppgppost2l(float ppart[], float q[], int kpic[], int noff, 
                  float qm, int idimp, int nppmx, int mx, int my,
                  int nxv, int nypmx, int mx1, int mxyp1);
@@ -47,6 +53,14 @@ void cppporderf2la(float ppart[], float ppbuff[], float sbufl[],
                    int nclr[], int idimp, int nppmx, int mx1, int myp1,
                    int npbmx, int ntmax, int nbmax, int *irc);
 
+void cppporderf2lr(float ppart[], float ppbuff[], int ncl[],
+                   int ihole[], int idimp, int nppmx, int mx1, int myp1,
+                   int npbmx, int ntmax, int kt, int *irc);
+
+void cppporderf2ls(float ppbuff[], float sbufl[], float sbufr[],
+                   int ncl[], int ncll[], int nclr[], int idimp,
+                   int mx1, int myp1, int npbmx, int nbmax, int *irc);
+
 void cppporder2lb(float ppart[], float ppbuff[], float rbufl[],
                   float rbufr[], int kpic[], int ncl[], int ihole[],
                   int mcll[], int mclr[], int idimp, int nppmx, int mx1,
@@ -0,0 +1,1918 @@
+/* AVX2 C Library for Skeleton 2D Electrostatic OpenMP/Vector PIC Code */
+/* written by Viktor K. Decyk, UCLA and Ricardo Fonseca, ISCTE */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <math.h>
+#include <immintrin.h>
+#include "avx2mpush2.h"
+
+/* transpose 4x4 blocks of single precision data within each 128 bit */
+/* lane of row0-row3, the 256 bit analog of _MM_TRANSPOSE4_PS        */
+#define MM256_TRANSPOSE4_PS(row0,row1,row2,row3) {                     \
+   __m256 tmp0, tmp1, tmp2, tmp3;                                       \
+   tmp0 = _mm256_unpacklo_ps(row0,row1);                                \
+   tmp2 = _mm256_unpacklo_ps(row2,row3);                                \
+   tmp1 = _mm256_unpackhi_ps(row0,row1);                                \
+   tmp3 = _mm256_unpackhi_ps(row2,row3);                                \
+   row0 = _mm256_shuffle_ps(tmp0,tmp2,68);                              \
+   row1 = _mm256_shuffle_ps(tmp0,tmp2,238);                             \
+   row2 = _mm256_shuffle_ps(tmp1,tmp3,68);                              \
+   row3 = _mm256_shuffle_ps(tmp1,tmp3,238);                             \
+}
+
+/* load 4 consecutive floats at locations s+l[0]...s+l[7] so that    */
+/* a,b,c,d contain the first,second,third,fourth float of the 8 sets */
+#define AVX2_LOAD4X8_PS(s,l,a,b,c,d) {                                 \
+   a = _mm256_insertf128_ps(_mm256_castps128_ps256(                    \
+       _mm_loadu_ps(&s[l[0]])),_mm_loadu_ps(&s[l[4]]),1);               \
+   b = _mm256_insertf128_ps(_mm256_castps128_ps256(                    \
+       _mm_loadu_ps(&s[l[1]])),_mm_loadu_ps(&s[l[5]]),1);               \
+   c = _mm256_insertf128_ps(_mm256_castps128_ps256(                    \
+       _mm_loadu_ps(&s[l[2]])),_mm_loadu_ps(&s[l[6]]),1);               \
+   d = _mm256_insertf128_ps(_mm256_castps128_ps256(                    \
+       _mm_loadu_ps(&s[l[3]])),_mm_loadu_ps(&s[l[7]]),1);               \
+   MM256_TRANSPOSE4_PS(a,b,c,d);                                        \
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2gppush2lt(float ppart[], float fxy[], int kpic[], float qbm,
+                    float dt, float *ek, int idimp, int nppmx, int nx,
+                    int ny, int mx, int my, int nxv, int nyv, int mx1,
+                    int mxy1, int ipbc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with various boundary conditions.
+   OpenMP/vector version using guard cells
+   data read in tiles
+   particles stored segmented array
+   44 flops/particle, 12 loads, 4 stores
+   input: all, output: ppart, ek
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   fy(x,y) = (1-dy)*((1-dx)*fy(n,m)+dx*fy(n+1,m)) + dy*((1-dx)*fy(n,m+1)
+      + dx*fy(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   ppart[m][2][n] = velocity vx of particle n in tile m
+   ppart[m][3][n] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic = number of particles per tile
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,2d periodic,2d reflecting,mixed reflecting/periodic)
+   requires AVX2 and FMA, ppart needs to be 32 byte aligned
+   nppmx needs to be a multiple of 8
+local data                                                            */
+#define MXV             33
+#define MYV             33
+   int noff, moff, npoff, npp, nps;
+   int i, j, k, nn, mm, mxv;
+   float qtm, edgelx, edgely, edgerx, edgery, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+   double sum1, sum2;
+   __m256i v_noff, v_moff, v_mxv;
+   __m256i v_nn, v_mm;
+   __m256 v_qtm, v_dt, v_one;
+   __m256 v_dxp, v_dyp, v_amx, v_amy, v_at;
+   __m256 v_x, v_y, v_dx, v_dy, v_vx, v_vy;
+   __m256 v_edgelx, v_edgely, v_edgerx, v_edgery;
+   __m256 a, b, c, d;
+   __m256d v_sum1, v_d;
+   __attribute__((aligned(32))) int ll[8];
+   __attribute__((aligned(32))) double dd[4];
+   __attribute__((aligned(32))) float sfxy[2*MXV*MYV];
+/* __attribute__((aligned(32))) float sfxy[2*(mx+1)*(my+1)]; */
+   mxv = mx + 1;
+   qtm = qbm*dt;
+   sum2 = 0.0;
+/* set boundary values */
+   edgelx = 0.0f;
+   edgely = 0.0f;
+   edgerx = (float) nx;
+   edgery = (float) ny;
+   if (ipbc==2) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0f;
+      edgerx = (float) (nx-1);
+   }
+   v_mxv = _mm256_set1_epi32(mxv);
+   v_qtm = _mm256_set1_ps(qtm);
+   v_one = _mm256_set1_ps(1.0f);
+   v_dt = _mm256_set1_ps(dt);
+   v_edgelx = _mm256_set1_ps(edgelx);
+   v_edgely = _mm256_set1_ps(edgely);
+   v_edgerx = _mm256_set1_ps(edgerx);
+   v_edgery = _mm256_set1_ps(edgery);
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV))   */
+/*    return;                        */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,nps,npoff,nn,mm,x,y,dxp,dyp,amx,amy,dx,dy, \
+vx,vy,sum1,v_noff,v_moff,v_nn,v_mm,v_x,v_y,v_dxp,v_dyp,v_amx,v_amy, \
+v_dx,v_dy,v_vx,v_vy,v_at,v_d,v_sum1,a,b,c,d,ll,dd,sfxy)  \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      v_noff = _mm256_set1_epi32(noff);
+      v_moff = _mm256_set1_epi32(moff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+/* load local fields from global array */
+      nn = (mx < nx-noff ? mx : nx-noff) + 1;
+      mm = (my < ny-moff ? my : ny-moff) + 1;
+      nps = 8*((2*nn)/8);
+      for (j = 0; j < mm; j++) {
+/* vector loop over elements in blocks of 8 */
+/*       for (i = 0; i < nn; i++) {                               */
+/*          sfxy[2*(i+mxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];     */
+/*          sfxy[1+2*(i+mxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))]; */
+/*       }                                                        */
+         for (i = 0; i < nps; i+=8) {
+            v_at = _mm256_loadu_ps(&fxy[i+2*(noff+nxv*(j+moff))]);
+            _mm256_storeu_ps(&sfxy[i+2*(mxv*j)],v_at);
+         }
+/* loop over remaining elements */
+         for (i = nps; i < 2*nn; i++) {
+            sfxy[i+2*(mxv*j)] = fxy[i+2*(noff+nxv*(j+moff))];
+         }
+      }
+      nps = 8*(npp/8);
+      sum1 = 0.0;
+      v_sum1 = _mm256_set1_pd(0.0);
+/* loop over particles in tile in groups of 8 */
+      for (j = 0; j < nps; j+=8) {
+/* find interpolation weights */
+/*       x = ppart[j+npoff];       */
+/*       y = ppart[j+nppmx+npoff]; */
+         v_x = _mm256_load_ps(&ppart[j+npoff]);
+         v_y = _mm256_load_ps(&ppart[j+nppmx+npoff]);
+/*       nn = x; */
+/*       mm = y; */
+         v_nn = _mm256_cvttps_epi32(v_x);
+         v_mm = _mm256_cvttps_epi32(v_y);
+/*       dxp = x - (float) nn; */
+         v_dxp = _mm256_sub_ps(v_x,_mm256_cvtepi32_ps(v_nn));
+/*       dyp = y - (float) mm; */
+         v_dyp = _mm256_sub_ps(v_y,_mm256_cvtepi32_ps(v_mm));
+/*       nn = 2*(nn - noff + mxv*(mm - moff)); */
+         v_nn = _mm256_sub_epi32(v_nn,v_noff);
+         v_mm = _mm256_mullo_epi32(_mm256_sub_epi32(v_mm,v_moff),v_mxv);
+         v_nn = _mm256_slli_epi32(_mm256_add_epi32(v_nn,v_mm),1);
+/*       amx = 1.0f - dxp; */
+/*       amy = 1.0f - dyp; */
+         v_amx = _mm256_sub_ps(v_one,v_dxp);
+         v_amy = _mm256_sub_ps(v_one,v_dyp);
+/* find acceleration */
+/* load fields, for lower left/right */
+         _mm256_store_si256((__m256i *)ll,v_nn);
+         AVX2_LOAD4X8_PS(sfxy,ll,a,b,c,d);
+/*       dx = amx*sfxy[nn];   */
+/*       dy = amx*sfxy[nn+1]; */
+         v_dx = _mm256_mul_ps(v_amx,a);
+         v_dy = _mm256_mul_ps(v_amx,b);
+/*       dx = amy*(dxp*sfxy[nn+2] + dx); */
+/*       dy = amy*(dxp*sfxy[nn+3] + dy); */
+         v_dx = _mm256_mul_ps(v_amy,_mm256_fmadd_ps(v_dxp,c,v_dx));
+         v_dy = _mm256_mul_ps(v_amy,_mm256_fmadd_ps(v_dxp,d,v_dy));
+/*       nn += 2*mxv; */
+/* load fields, for upper left/right */
+         _mm256_store_si256((__m256i *)ll,
+                 _mm256_add_epi32(v_nn,_mm256_set1_epi32(2*mxv)));
+         AVX2_LOAD4X8_PS(sfxy,ll,a,b,c,d);
+/*       vx = amx*sfxy[nn];   */
+/*       vy = amx*sfxy[nn+1]; */
+         a = _mm256_mul_ps(v_amx,a);
+         b = _mm256_mul_ps(v_amx,b);
+/*       dx += dyp*(dxp*sfxy[nn+2] + vx); */
+/*       dy += dyp*(dxp*sfxy[nn+3] + vy); */
+         v_dx = _mm256_fmadd_ps(v_dyp,_mm256_fmadd_ps(v_dxp,c,a),v_dx);
+         v_dy = _mm256_fmadd_ps(v_dyp,_mm256_fmadd_ps(v_dxp,d,b),v_dy);
+/* new velocity */
+/*       dxp = ppart[j+2*nppmx+npoff]; */
+/*       dyp = ppart[j+3*nppmx+npoff]; */
+         v_dxp = _mm256_load_ps(&ppart[j+2*nppmx+npoff]);
+         v_dyp = _mm256_load_ps(&ppart[j+3*nppmx+npoff]);
+/*       vx = dxp + qtm*dx; */
+/*       vy = dyp + qtm*dy; */
+         v_vx = _mm256_fmadd_ps(v_qtm,v_dx,v_dxp);
+         v_vy = _mm256_fmadd_ps(v_qtm,v_dy,v_dyp);
+/* average kinetic energy */
+/*       dxp += vx; */
+/*       dyp += vy; */
+         v_dxp = _mm256_add_ps(v_dxp,v_vx);
+         v_dyp = _mm256_add_ps(v_dyp,v_vy);
+/*       sum1 += dxp*dxp + dyp*dyp; */
+         v_at = _mm256_fmadd_ps(v_dxp,v_dxp,_mm256_mul_ps(v_dyp,v_dyp));
+/* convert to double precision before accumulating */
+         v_d = _mm256_cvtps_pd(_mm256_castps256_ps128(v_at));
+         v_sum1 = _mm256_add_pd(v_sum1,v_d);
+         v_d = _mm256_cvtps_pd(_mm256_extractf128_ps(v_at,1));
+         v_sum1 = _mm256_add_pd(v_sum1,v_d);
+/* new position */
+/*       dx = x + vx*dt; */
+/*       dy = y + vy*dt; */
+         v_dx = _mm256_fmadd_ps(v_vx,v_dt,v_x);
+         v_dy = _mm256_fmadd_ps(v_vy,v_dt,v_y);
+/* reflecting boundary conditions */
+         if (ipbc==2) {
+/*          if ((dx < edgelx) || (dx >= edgerx)) { */
+/*             dx = x;                             */
+/*             vx = -vx;                           */
+/*          }                                      */
+            v_at = _mm256_cmp_ps(v_dx,v_edgelx,_CMP_LT_OQ);
+            v_at = _mm256_or_ps(v_at,
+                   _mm256_cmp_ps(v_dx,v_edgerx,_CMP_GE_OQ));
+            v_dx = _mm256_blendv_ps(v_dx,v_x,v_at);
+            v_vx = _mm256_blendv_ps(v_vx,
+                   _mm256_sub_ps(_mm256_setzero_ps(),v_vx),v_at);
+/*          if ((dy < edgely) || (dy >= edgery)) { */
+/*             dy = y;                             */
+/*             vy = -vy;                           */
+/*          }                                      */
+            v_at = _mm256_cmp_ps(v_dy,v_edgely,_CMP_LT_OQ);
+            v_at = _mm256_or_ps(v_at,
+                   _mm256_cmp_ps(v_dy,v_edgery,_CMP_GE_OQ));
+            v_dy = _mm256_blendv_ps(v_dy,v_y,v_at);
+            v_vy = _mm256_blendv_ps(v_vy,
+                   _mm256_sub_ps(_mm256_setzero_ps(),v_vy),v_at);
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+/*          if ((dx < edgelx) || (dx >= edgerx)) { */
+/*             dx = x;                             */
+/*             vx = -vx;                           */
+/*          }                                      */
+            v_at = _mm256_cmp_ps(v_dx,v_edgelx,_CMP_LT_OQ);
+            v_at = _mm256_or_ps(v_at,
+                   _mm256_cmp_ps(v_dx,v_edgerx,_CMP_GE_OQ));
+            v_dx = _mm256_blendv_ps(v_dx,v_x,v_at);
+            v_vx = _mm256_blendv_ps(v_vx,
+                   _mm256_sub_ps(_mm256_setzero_ps(),v_vx),v_at);
+         }
+/* set new position */
+/*       ppart[j+npoff] = dx;       */
+/*       ppart[j+nppmx+npoff] = dy; */
+         _mm256_store_ps(&ppart[j+npoff],v_dx);
+         _mm256_store_ps(&ppart[j+nppmx+npoff],v_dy);
+/* set new velocity */
+/*       ppart[j+2*nppmx+npoff] = vx; */
+/*       ppart[j+3*nppmx+npoff] = vy; */
+         _mm256_store_ps(&ppart[j+2*nppmx+npoff],v_vx);
+         _mm256_store_ps(&ppart[j+3*nppmx+npoff],v_vy);
+      }
+/* loop over remaining particles in tile */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         nn = 2*(nn - noff + mxv*(mm - moff));
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+/* find acceleration */
+         dx = amx*sfxy[nn];
+         dy = amx*sfxy[nn+1];
+         dx = amy*(dxp*sfxy[nn+2] + dx);
+         dy = amy*(dxp*sfxy[nn+3] + dy);
+         nn += 2*mxv;
+         vx = amx*sfxy[nn];
+         vy = amx*sfxy[nn+1];
+         dx += dyp*(dxp*sfxy[nn+2] + vx);
+         dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+         dxp = ppart[j+2*nppmx+npoff];
+         dyp = ppart[j+3*nppmx+npoff];
+         vx = dxp + qtm*dx;
+         vy = dyp + qtm*dy;
+/* average kinetic energy */
+         dxp += vx;
+         dyp += vy;
+         sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* reflecting boundary conditions */
+         if (ipbc==2) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               vx = -vx;
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = y;
+               vy = -vy;
+            }
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = x;
+               vx = -vx;
+            }
+         }
+/* set new position */
+         ppart[j+npoff] = dx;
+         ppart[j+nppmx+npoff] = dy;
+/* set new velocity */
+         ppart[j+2*nppmx+npoff] = vx;
+         ppart[j+3*nppmx+npoff] = vy;
+      }
+/*    sum2 += sum1; */
+      _mm256_store_pd(&dd[0],v_sum1);
+      for (j = 1; j < 4; j++) {
+         dd[0] += dd[j];
+      }
+      sum2 += (sum1 + dd[0]);
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef MXV
+#undef MYV
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2gppushf2lt(float ppart[], float fxy[], int kpic[], int ncl[],
+                     int ihole[], float qbm, float dt, float *ek,
+                     int idimp, int nppmx, int nx, int ny, int mx,
+                     int my, int nxv, int nyv, int mx1, int mxy1,
+                     int ntmax, int *irc) {
+/* for 2d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space, with periodic boundary conditions.
+   also determines list of particles which are leaving this tile
+   OpenMP/vector version using guard cells
+   data read in tiles
+   particles stored segmented array
+   44 flops/particle, 12 loads, 4 stores
+   input: all except ncl, ihole, irc, output: ppart, ncl, ihole, ek, irc
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt
+   fx(x(t),y(t)) and fy(x(t),y(t)) are approximated by interpolation from
+   the nearest grid points:
+   fx(x,y) = (1-dy)*((1-dx)*fx(n,m)+dx*fx(n+1,m)) + dy*((1-dx)*fx(n,m+1)
+      + dx*fx(n+1,m+1))
+   fy(x,y) = (1-dy)*((1-dx)*fy(n,m)+dx*fy(n+1,m)) + dy*((1-dx)*fy(n,m+1)
+      + dx*fy(n+1,m+1))
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   ppart[m][2][n] = velocity vx of particle n in tile m
+   ppart[m][3][n] = velocity vy of particle n in tile m
+   fxy[k][j][0] = x component of force/charge at grid (j,k)
+   fxy[k][j][1] = y component of force/charge at grid (j,k)
+   that is, convolution of electric field over particle shape
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = destination of particle leaving hole
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   qbm = particle charge/mass
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   nxv = second dimension of field arrays, must be >= nx+1
+   nyv = third dimension of field arrays, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   requires AVX2 and FMA, ppart needs to be 32 byte aligned
+   nppmx needs to be a multiple of 8
+   optimized version
+local data                                                            */
+#define MXV             33
+#define MYV             33
+   int noff, moff, npoff, npp, nps;
+   int i, j, k, ih, nh, nn, mm, mxv;
+   float qtm, dxp, dyp, amx, amy;
+   float x, y, dx, dy, vx, vy;
+   float anx, any, edgelx, edgely, edgerx, edgery;
+   double sum1, sum2;
+   __m256i v_noff, v_moff, v_mxv;
+   __m256i v_nn, v_mm;
+   __m256 v_qtm, v_dt, v_one;
+   __m256 v_dxp, v_dyp, v_amx, v_amy, v_st, v_at;
+   __m256 v_x, v_y, v_dx, v_dy, v_vx, v_vy;
+   __m256 v_anx, v_any, v_edgelx, v_edgely, v_edgerx, v_edgery;
+   __m256 v_zero, v_two, v_three, v_six;
+   __m256 a, b, c, d;
+   __m256d v_sum1, v_d;
+   __attribute__((aligned(32))) int ll[8];
+   __attribute__((aligned(32))) double dd[4];
+   __attribute__((aligned(32))) float sfxy[2*MXV*MYV];
+/* __attribute__((aligned(32))) float sfxy[2*(mx+1)*(my+1)]; */
+   mxv = mx + 1;
+   qtm = qbm*dt;
+   anx = (float) nx;
+   any = (float) ny;
+   sum2 = 0.0;
+   v_mxv = _mm256_set1_epi32(mxv);
+   v_qtm = _mm256_set1_ps(qtm);
+   v_one = _mm256_set1_ps(1.0f);
+   v_dt = _mm256_set1_ps(dt);
+   v_anx = _mm256_set1_ps(anx);
+   v_any = _mm256_set1_ps(any);
+   v_zero = _mm256_setzero_ps();
+   v_two = _mm256_set1_ps(2.0f);
+   v_three = _mm256_set1_ps(3.0f);
+   v_six = _mm256_set1_ps(6.0f);
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV))   */
+/*    return;                        */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,nps,npoff,nn,mm,ih,nh,x,y,dxp,dyp,amx,amy, \
+dx,dy,vx,vy,edgelx,edgely,edgerx,edgery,sum1,v_noff,v_moff,v_nn,v_mm, \
+v_x,v_y,v_dxp,v_dyp,v_amx,v_amy,v_dx,v_dy,v_vx,v_vy,v_st,v_at, \
+v_edgelx,v_edgely,v_edgerx,v_edgery,v_d,v_sum1,a,b,c,d,ll,dd,sfxy) \
+reduction(+:sum2)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      v_noff = _mm256_set1_epi32(noff);
+      v_moff = _mm256_set1_epi32(moff);
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      v_edgelx = _mm256_set1_ps(edgelx);
+      v_edgely = _mm256_set1_ps(edgely);
+      v_edgerx = _mm256_set1_ps(edgerx);
+      v_edgery = _mm256_set1_ps(edgery);
+      ih = 0;
+      nh = 0;
+/* load local fields from global array */
+      nn += 1;
+      mm += 1;
+      nps = 8*((2*nn)/8);
+      for (j = 0; j < mm; j++) {
+/* vector loop over elements in blocks of 8 */
+/*       for (i = 0; i < nn; i++) {                               */
+/*          sfxy[2*(i+mxv*j)] = fxy[2*(i+noff+nxv*(j+moff))];     */
+/*          sfxy[1+2*(i+mxv*j)] = fxy[1+2*(i+noff+nxv*(j+moff))]; */
+/*       }                                                        */
+         for (i = 0; i < nps; i+=8) {
+            v_at = _mm256_loadu_ps(&fxy[i+2*(noff+nxv*(j+moff))]);
+            _mm256_storeu_ps(&sfxy[i+2*(mxv*j)],v_at);
+         }
+/* loop over remaining elements */
+         for (i = nps; i < 2*nn; i++) {
+            sfxy[i+2*(mxv*j)] = fxy[i+2*(noff+nxv*(j+moff))];
+         }
+      }
+/* clear counters */
+/*    for (j = 0; j < 8; j++) { */
+/*       ncl[j+8*k] = 0;        */
+/*    }                         */
+      memset((void*)&ncl[8*k],0,8*sizeof(int));
+      nps = 8*(npp/8);
+      sum1 = 0.0;
+      v_sum1 = _mm256_set1_pd(0.0);
+/* loop over particles in tile in groups of 8 */
+      for (j = 0; j < nps; j+=8) {
+/* find interpolation weights */
+/*       x = ppart[j+npoff];       */
+/*       y = ppart[j+nppmx+npoff]; */
+         v_x = _mm256_load_ps(&ppart[j+npoff]);
+         v_y = _mm256_load_ps(&ppart[j+nppmx+npoff]);
+/*       nn = x; */
+/*       mm = y; */
+         v_nn = _mm256_cvttps_epi32(v_x);
+         v_mm = _mm256_cvttps_epi32(v_y);
+/*       dxp = x - (float) nn; */
+         v_dxp = _mm256_sub_ps(v_x,_mm256_cvtepi32_ps(v_nn));
+/*       dyp = y - (float) mm; */
+         v_dyp = _mm256_sub_ps(v_y,_mm256_cvtepi32_ps(v_mm));
+/*       nn = 2*(nn - noff + mxv*(mm - moff)); */
+         v_nn = _mm256_sub_epi32(v_nn,v_noff);
+         v_mm = _mm256_mullo_epi32(_mm256_sub_epi32(v_mm,v_moff),v_mxv);
+         v_nn = _mm256_slli_epi32(_mm256_add_epi32(v_nn,v_mm),1);
+/*       amx = 1.0f - dxp; */
+/*       amy = 1.0f - dyp; */
+         v_amx = _mm256_sub_ps(v_one,v_dxp);
+         v_amy = _mm256_sub_ps(v_one,v_dyp);
+/* find acceleration */
+/* load fields, for lower left/right */
+         _mm256_store_si256((__m256i *)ll,v_nn);
+         AVX2_LOAD4X8_PS(sfxy,ll,a,b,c,d);
+/*       dx = amx*sfxy[nn];   */
+/*       dy = amx*sfxy[nn+1]; */
+         v_dx = _mm256_mul_ps(v_amx,a);
+         v_dy = _mm256_mul_ps(v_amx,b);
+/*       dx = amy*(dxp*sfxy[nn+2] + dx); */
+/*       dy = amy*(dxp*sfxy[nn+3] + dy); */
+         v_dx = _mm256_mul_ps(v_amy,_mm256_fmadd_ps(v_dxp,c,v_dx));
+         v_dy = _mm256_mul_ps(v_amy,_mm256_fmadd_ps(v_dxp,d,v_dy));
+/*       nn += 2*mxv; */
+/* load fields, for upper left/right */
+         _mm256_store_si256((__m256i *)ll,
+                 _mm256_add_epi32(v_nn,_mm256_set1_epi32(2*mxv)));
+         AVX2_LOAD4X8_PS(sfxy,ll,a,b,c,d);
+/*       vx = amx*sfxy[nn];   */
+/*       vy = amx*sfxy[nn+1]; */
+         a = _mm256_mul_ps(v_amx,a);
+         b = _mm256_mul_ps(v_amx,b);
+/*       dx += dyp*(dxp*sfxy[nn+2] + vx); */
+/*       dy += dyp*(dxp*sfxy[nn+3] + vy); */
+         v_dx = _mm256_fmadd_ps(v_dyp,_mm256_fmadd_ps(v_dxp,c,a),v_dx);
+         v_dy = _mm256_fmadd_ps(v_dyp,_mm256_fmadd_ps(v_dxp,d,b),v_dy);
+/* new velocity */
+/*       dxp = ppart[j+2*nppmx+npoff]; */
+/*       dyp = ppart[j+3*nppmx+npoff]; */
+         v_dxp = _mm256_load_ps(&ppart[j+2*nppmx+npoff]);
+         v_dyp = _mm256_load_ps(&ppart[j+3*nppmx+npoff]);
+/*       vx = dxp + qtm*dx; */
+/*       vy = dyp + qtm*dy; */
+         v_vx = _mm256_fmadd_ps(v_qtm,v_dx,v_dxp);
+         v_vy = _mm256_fmadd_ps(v_qtm,v_dy,v_dyp);
+/* average kinetic energy */
+/*       dxp += vx; */
+/*       dyp += vy; */
+         v_dxp = _mm256_add_ps(v_dxp,v_vx);
+         v_dyp = _mm256_add_ps(v_dyp,v_vy);
+/*       sum1 += dxp*dxp + dyp*dyp; */
+         v_at = _mm256_fmadd_ps(v_dxp,v_dxp,_mm256_mul_ps(v_dyp,v_dyp));
+/* convert to double precision before accumulating */
+         v_d = _mm256_cvtps_pd(_mm256_castps256_ps128(v_at));
+         v_sum1 = _mm256_add_pd(v_sum1,v_d);
+         v_d = _mm256_cvtps_pd(_mm256_extractf128_ps(v_at,1));
+         v_sum1 = _mm256_add_pd(v_sum1,v_d);
+/* new position */
+/*       dx = x + vx*dt; */
+/*       dy = y + vy*dt; */
+         v_dx = _mm256_fmadd_ps(v_vx,v_dt,v_x);
+         v_dy = _mm256_fmadd_ps(v_vy,v_dt,v_y);
+/* find particles going out of bounds */
+/*       mm = 0; */
+         v_st = v_zero;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+/*       if (dx >= edgerx) { */
+/*          if (dx >= anx)   */
+/*             dx -= anx;    */
+/*          mm = 2;          */
+/*       }                   */
+         v_x = _mm256_cmp_ps(v_dx,v_edgerx,_CMP_GE_OQ);
+         v_y = _mm256_cmp_ps(v_dx,v_edgelx,_CMP_LT_OQ);
+/* execute if either test result is true for any particle */
+         if (_mm256_movemask_ps(_mm256_or_ps(v_x,v_y))) {
+            v_st = _mm256_and_ps(v_two,v_x);
+            v_x = _mm256_and_ps(v_x,
+                  _mm256_cmp_ps(v_dx,v_anx,_CMP_GE_OQ));
+            v_dx = _mm256_sub_ps(v_dx,_mm256_and_ps(v_anx,v_x));
+/*          if (dx < edgelx) {  */
+/*             if (dx < 0.0f) { */
+/*                dx += anx;    */
+/*                if (dx < anx) */
+/*                   mm = 1;    */
+/*                else          */
+/*                   dx = 0.0;  */
+/*             }                */
+/*            else {            */
+/*                mm = 1;       */
+/*            }                 */
+/*          }                   */
+            v_at = _mm256_and_ps(v_one,v_y);
+            v_x = _mm256_and_ps(v_y,
+                  _mm256_cmp_ps(v_dx,v_zero,_CMP_LT_OQ));
+            v_dx = _mm256_add_ps(v_dx,_mm256_and_ps(v_anx,v_x));
+            v_y = _mm256_cmp_ps(v_dx,v_anx,_CMP_LT_OQ);
+            v_dx = _mm256_and_ps(v_dx,v_y);
+            v_st = _mm256_add_ps(v_st,_mm256_and_ps(v_at,v_y));
+         }
+/*       if (dy >= edgery) { */
+/*          if (dy >= any)   */
+/*             dy -= any;    */
+/*          mm += 6;         */
+/*       }                   */
+         v_y = _mm256_cmp_ps(v_dy,v_edgery,_CMP_GE_OQ);
+         v_x = _mm256_cmp_ps(v_dy,v_edgely,_CMP_LT_OQ);
+/* execute if either test result is true for any particle */
+         if (_mm256_movemask_ps(_mm256_or_ps(v_x,v_y))) {
+            v_st = _mm256_add_ps(v_st,_mm256_and_ps(v_six,v_y));
+            v_y = _mm256_and_ps(v_y,
+                  _mm256_cmp_ps(v_dy,v_any,_CMP_GE_OQ));
+            v_dy = _mm256_sub_ps(v_dy,_mm256_and_ps(v_any,v_y));
+/*          if (dy < edgely) {  */
+/*             if (dy < 0.0) {  */
+/*                dy += any;    */
+/*                if (dy < any) */
+/*                   mm += 3;   */
+/*                else          */
+/*                   dy = 0.0;  */
+/*             }                */
+/*             else {           */
+/*                mm += 3;      */
+/*             }                */
+/*          }                   */
+            v_at = _mm256_and_ps(v_three,v_x);
+            v_y = _mm256_and_ps(v_x,
+                  _mm256_cmp_ps(v_dy,v_zero,_CMP_LT_OQ));
+            v_dy = _mm256_add_ps(v_dy,_mm256_and_ps(v_any,v_y));
+            v_x = _mm256_cmp_ps(v_dy,v_any,_CMP_LT_OQ);
+            v_dy = _mm256_and_ps(v_dy,v_x);
+            v_st = _mm256_add_ps(v_st,_mm256_and_ps(v_at,v_x));
+         }
+/* set new position */
+/*       ppart[j+npoff] = dx;       */
+/*       ppart[j+nppmx+npoff] = dy; */
+         _mm256_store_ps(&ppart[j+npoff],v_dx);
+         _mm256_store_ps(&ppart[j+nppmx+npoff],v_dy);
+/* set new velocity */
+/*       ppart[j+2*nppmx+npoff] = vx; */
+/*       ppart[j+3*nppmx+npoff] = vy; */
+         _mm256_store_ps(&ppart[j+2*nppmx+npoff],v_vx);
+         _mm256_store_ps(&ppart[j+3*nppmx+npoff],v_vy);
+/* increment counters, only if some particle is leaving the tile */
+/*       if (mm > 0) {                            */
+/*          ncl[mm+8*k-1] += 1;                   */
+/*          ih += 1;                              */
+/*          if (ih <= ntmax) {                    */
+/*             ihole[2*(ih+(ntmax+1)*k)] = j + 1; */
+/*             ihole[1+2*(ih+(ntmax+1)*k)] = mm;  */
+/*          }                                     */
+/*          else {                                */
+/*             nh = 1;                            */
+/*          }                                     */
+/*       }                                        */
+         if (_mm256_movemask_ps(_mm256_cmp_ps(v_st,v_zero,
+                                              _CMP_NEQ_OQ))) {
+            _mm256_store_si256((__m256i *)ll,_mm256_cvttps_epi32(v_st));
+            for (i = 0; i < 8; i++) {
+               mm = ll[i];
+               if (mm > 0) {
+                  ncl[mm+8*k-1] += 1;
+                  ih += 1;
+                  if (ih <= ntmax) {
+                     ihole[2*(ih+(ntmax+1)*k)] = j + i + 1;
+                     ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+                  }
+                  else {
+                     nh = 1;
+                  }
+               }
+            }
+         }
+      }
+/* loop over remaining particles in tile */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         nn = 2*(nn - noff + mxv*(mm - moff));
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+/* find acceleration */
+         dx = amx*sfxy[nn];
+         dy = amx*sfxy[nn+1];
+         dx = amy*(dxp*sfxy[nn+2] + dx);
+         dy = amy*(dxp*sfxy[nn+3] + dy);
+         nn += 2*mxv;
+         vx = amx*sfxy[nn];
+         vy = amx*sfxy[nn+1];
+         dx += dyp*(dxp*sfxy[nn+2] + vx);
+         dy += dyp*(dxp*sfxy[nn+3] + vy);
+/* new velocity */
+         dxp = ppart[j+2*nppmx+npoff];
+         dyp = ppart[j+3*nppmx+npoff];
+         vx = dxp + qtm*dx;
+         vy = dyp + qtm*dy;
+/* average kinetic energy */
+         dxp += vx;
+         dyp += vy;
+         sum1 += dxp*dxp + dyp*dyp;
+/* new position */
+         dx = x + vx*dt;
+         dy = y + vy*dt;
+/* find particles going out of bounds */
+         mm = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* mm = direction particle is going                              */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               dx -= anx;
+            mm = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0f) {
+               dx += anx;
+               if (dx < anx)
+                  mm = 1;
+               else
+                  dx = 0.0;
+            }
+            else {
+               mm = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               dy -= any;
+            mm += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  mm += 3;
+               else
+                  dy = 0.0;
+            }
+            else {
+               mm += 3;
+            }
+         }
+/* set new position */
+         ppart[j+npoff] = dx;
+         ppart[j+nppmx+npoff] = dy;
+/* set new velocity */
+         ppart[j+2*nppmx+npoff] = vx;
+         ppart[j+3*nppmx+npoff] = vy;
+/* increment counters */
+         if (mm > 0) {
+            ncl[mm+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+(ntmax+1)*k)] = j + 1;
+               ihole[1+2*(ih+(ntmax+1)*k)] = mm;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/*    sum2 += sum1; */
+      _mm256_store_pd(&dd[0],v_sum1);
+      for (j = 1; j < 4; j++) {
+         dd[0] += dd[j];
+      }
+      sum2 += (sum1 + dd[0]);
+/* set error and end of file flag */
+/* ihole overflow */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*(ntmax+1)*k] = ih;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum2;
+   return;
+#undef MXV
+#undef MYV
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2gppost2lt(float ppart[], float q[], int kpic[], float qm,
+                    int nppmx, int idimp, int mx, int my, int nxv,
+                    int nyv, int mx1, int mxy1) {
+/* for 2d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   OpenMP/vector version using guard cells
+   data deposited in tiles
+   particles stored segmented array
+   17 flops/particle, 6 loads, 4 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   q(n,m)=qm*(1.-dx)*(1.-dy)
+   q(n+1,m)=qm*dx*(1.-dy)
+   q(n,m+1)=qm*(1.-dx)*dy
+   q(n+1,m+1)=qm*dx*dy
+   where n,m = leftmost grid points and dx = x-n, dy = y-m
+   ppart[m][0][n] = position x of particle n in tile m
+   ppart[m][1][n] = position y of particle n in tile m
+   q[k][j] = charge density at grid point j,k
+   kpic = number of particles per tile
+   qm = charge on particle, in units of e
+   nppmx = maximum number of particles in tile
+   idimp = size of phase space = 4
+   mx/my = number of grids in sorting cell in x/y
+   nxv = first dimension of charge array, must be >= nx+1
+   nyv = second dimension of charge array, must be >= ny+1
+   mx1 = (system length in x direction - 1)/mx + 1
+   mxy1 = mx1*my1, where my1 = (system length in y direction - 1)/my + 1
+   requires AVX2 and FMA, ppart needs to be 32 byte aligned
+   nppmx needs to be a multiple of 8
+local data                                                            */
+#define MXV             33
+#define MYV             33
+   int noff, moff, npoff, npp, nps, mxv;
+   int i, j, k, nn, mm, it;
+   float x, y, dxp, dyp, amx, amy;
+   __m256i v_noff, v_moff, v_mxv;
+   __m256i v_nn, v_mm;
+   __m256 v_qm, v_one, v_m;
+   __m256 v_x, v_y, v_dxp, v_dyp, v_amx, v_amy;
+   __m256 a, b, c, d;
+   __m128 v_s, v_w;
+   __attribute__((aligned(32))) int ll[8];
+   __attribute__((aligned(32))) float ww[32];
+   __attribute__((aligned(32))) float sq[MXV*MYV];
+/* __attribute__((aligned(32))) float sq[(mx+1)*(my+1)]; */
+   mxv = mx + 1;
+   v_mxv = _mm256_set1_epi32(mxv);
+   v_qm = _mm256_set1_ps(qm);
+   v_one = _mm256_set1_ps(1.0f);
+   v_m = _mm256_castsi256_ps(_mm256_set_epi32(-1,-1,-1,-1,-1,-1,-1,0));
+/* error if local array is too small */
+/* if ((mx >= MXV) || (my >= MYV))   */
+/*    return;                        */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,nps,npoff,nn,mm,it,x,y,dxp,dyp,amx,amy, \
+v_noff,v_moff,v_nn,v_mm,v_x,v_y,v_dxp,v_dyp,v_amx,v_amy,a,b,c,d,v_s, \
+v_w,ll,ww,sq)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      v_noff = _mm256_set1_epi32(noff);
+      v_moff = _mm256_set1_epi32(moff);
+      npp = kpic[k];
+      nps = 8*(npp/8);
+      npoff = idimp*nppmx*k;
+/* zero out local accumulator */
+/*    for (j = 0; j < mxv*(my+1); j++) { */
+/*       sq[j] = 0.0f;                   */
+/*    }                                  */
+      memset((void*)sq,0,mxv*(my+1)*sizeof(float));
+/* loop over particles in tile in groups of 8 */
+      for (j = 0; j < nps; j+=8) {
+/* find interpolation weights */
+/*       x = ppart[j+npoff];       */
+/*       y = ppart[j+nppmx+npoff]; */
+         v_x = _mm256_load_ps(&ppart[j+npoff]);
+         v_y = _mm256_load_ps(&ppart[j+nppmx+npoff]);
+/*       nn = x; */
+/*       mm = y; */
+         v_nn = _mm256_cvttps_epi32(v_x);
+         v_mm = _mm256_cvttps_epi32(v_y);
+/*       dxp = qm*(x - (float) nn); */
+         v_dxp = _mm256_sub_ps(v_x,_mm256_cvtepi32_ps(v_nn));
+         v_dxp = _mm256_mul_ps(v_dxp,v_qm);
+/*       dyp = y - (float) mm; */
+         v_dyp = _mm256_sub_ps(v_y,_mm256_cvtepi32_ps(v_mm));
+/*       nn = nn - noff + mxv*(mm - moff); */
+         v_nn = _mm256_sub_epi32(v_nn,v_noff);
+         v_mm = _mm256_mullo_epi32(_mm256_sub_epi32(v_mm,v_moff),v_mxv);
+         v_nn = _mm256_add_epi32(v_nn,v_mm);
+/*       amx = qm - dxp;   */
+/*       amy = 1.0f - dyp; */
+         v_amx = _mm256_sub_ps(v_qm,v_dxp);
+         v_amy = _mm256_sub_ps(v_one,v_dyp);
+/* calculate weights, for lower left/right, upper left/right */
+         a = _mm256_mul_ps(v_amx,v_amy);
+         b = _mm256_mul_ps(v_dxp,v_amy);
+         c = _mm256_mul_ps(v_amx,v_dyp);
+         d = _mm256_mul_ps(v_dxp,v_dyp);
+         _mm256_store_si256((__m256i *)ll,v_nn);
+/* transpose so a,b,c,d contain the 4 weights for particles 0-3 in */
+/* the lower 128 bit lane and particles 4-7 in the upper lane      */
+         MM256_TRANSPOSE4_PS(a,b,c,d);
+         _mm256_store_ps(&ww[0],a);
+         _mm256_store_ps(&ww[8],b);
+         _mm256_store_ps(&ww[16],c);
+         _mm256_store_ps(&ww[24],d);
+/* deposit charge within tile to local accumulator */
+/*       x = q[nn] + amx*amy;   */
+/*       y = q[nn+1] + dxp*amy; */
+/*       q[nn] = x;             */
+/*       q[nn+1] = y;           */
+/*       nn += nxv;             */
+/*       x = q[nn] + amx*dyp;   */
+/*       y = q[nn+1] + dxp*dyp; */
+/*       q[nn] = x;             */
+/*       q[nn+1] = y;           */
+/* particles must be deposited one at a time to avoid collisions */
+         for (i = 0; i < 8; i++) {
+            mm = ll[i];
+            v_w = _mm_load_ps(&ww[8*(i&3)+4*(i>>2)]);
+            v_s = _mm_loadl_pi(_mm_setzero_ps(),(__m64 *)&sq[mm]);
+            v_s = _mm_loadh_pi(v_s,(__m64 *)&sq[mm+mxv]);
+            v_s = _mm_add_ps(v_s,v_w);
+            _mm_storel_pi((__m64 *)&sq[mm],v_s);
+            _mm_storeh_pi((__m64 *)&sq[mm+mxv],v_s);
+         }
+      }
+/* loop over remaining particles in tile */
+      for (j = nps; j < npp; j++) {
+/* find interpolation weights */
+         x = ppart[j+npoff];
+         y = ppart[j+nppmx+npoff];
+         nn = x;
+         mm = y;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+         nn = nn - noff + mxv*(mm - moff);
+         amx = qm - dxp;
+         amy = 1.0f - dyp;
+/* deposit charge within tile to local accumulator */
+         x = sq[nn] + amx*amy;
+         y = sq[nn+1] + dxp*amy;
+         sq[nn] = x;
+         sq[nn+1] = y;
+         nn += mxv;
+         x = sq[nn] + amx*dyp;
+         y = sq[nn+1] + dxp*dyp;
+         sq[nn] = x;
+         sq[nn+1] = y;
+      }
+/* deposit charge to interior points in global array */
+      nn = nxv - noff;
+      mm = nyv - moff;
+      nn = mx < nn ? mx : nn;
+      mm = my < mm ? my : mm;
+      nps = 8*(nn/8);
+      for (j = 1; j < mm; j++) {
+/* vector loop over elements in blocks of 8 */
+/*       for (i = 1; i < nn; i++) {                */
+/*          q[i+noff+nxv*(j+moff)] += sq[i+mxv*j]; */
+/*       }                                         */
+         for (i = 0; i < nps; i+=8) {
+            v_x = _mm256_loadu_ps(&q[i+noff+nxv*(j+moff)]);
+            v_y = _mm256_loadu_ps(&sq[i+mxv*j]);
+/* zero out first element for i = 0 */
+            if (i==0)
+               v_y = _mm256_and_ps(v_y,v_m);
+            v_x = _mm256_add_ps(v_x,v_y);
+            _mm256_storeu_ps(&q[i+noff+nxv*(j+moff)],v_x);
+         }
+/* loop over remaining elements */
+         it = 1 > nps ? 1 : nps;
+         for (i = it; i < nn; i++) {
+            q[i+noff+nxv*(j+moff)] += sq[i+mxv*j];
+         }
+      }
+/* deposit charge to edge points in global array */
+      mm = nyv - moff;
+      mm = my+1 < mm ? my+1 : mm;
+      for (i = 1; i < nn; i++) {
+#pragma omp atomic
+         q[i+noff+nxv*moff] += sq[i];
+         if (mm > my) {
+#pragma omp atomic
+            q[i+noff+nxv*(mm+moff-1)] += sq[i+mxv*(mm-1)];
+         }
+      }
+      nn = nxv - noff;
+      nn = mx+1 < nn ? mx+1 : nn;
+      for (j = 0; j < mm; j++) {
+#pragma omp atomic
+         q[noff+nxv*(j+moff)] += sq[mxv*j];
+         if (nn > mx) {
+#pragma omp atomic
+            q[nn+noff-1+nxv*(j+moff)] += sq[nn-1+mxv*j];
+         }
+      }
+   }
+   return;
+#undef MXV
+#undef MYV
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2pporder2lt(float ppart[], float ppbuff[], int kpic[],
+                     int ncl[], int ihole[], int idimp, int nppmx,
+                     int nx, int ny, int mx, int my, int mx1, int my1,
+                     int npbmx, int ntmax, int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   linear interpolation, with periodic boundary conditions
+   tiles are assumed to be arranged in 2D linear memory
+   algorithm has 3 steps.  first, one finds particles leaving tile and
+   stores their number in each directon, location, and destination in ncl
+   and ihole.  second, a prefix scan of ncl is performed and departing
+   particles are buffered in ppbuff in direction order.  finally, we copy
+   the incoming particles from other tiles into ppart.
+   the last two steps are performed by cavx2pporderf2lt
+   input: all except ppbuff, ncl, ihole, irc
+   output: ppart, ppbuff, kpic, ncl, ihole, irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k
+   ppbuff[k][i][n] = i co-ordinate of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   nx/ny = system length in x/y direction
+   mx/my = number of grids in sorting cell in x/y
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   requires AVX2, ppart needs to be 32 byte aligned
+   nppmx needs to be a multiple of 8
+local data                                                            */
+   int mxy1, noff, moff, npoff, npp, nps;
+   int i, j, k, ih, nh, ist, nn, mm;
+   float anx, any, edgelx, edgely, edgerx, edgery, dx, dy;
+   __m256 v_dx, v_dy, v_st, v_at, v_x, v_y;
+   __m256 v_anx, v_any, v_edgelx, v_edgely, v_edgerx, v_edgery;
+   __m256 v_zero, v_one, v_two, v_three, v_six;
+   __attribute__((aligned(32))) int ll[8];
+   mxy1 = mx1*my1;
+   anx = (float) nx;
+   any = (float) ny;
+/* find and count particles leaving tiles and determine destination */
+/* update ppart, ihole, ncl */
+   v_anx = _mm256_set1_ps(anx);
+   v_any = _mm256_set1_ps(any);
+   v_zero = _mm256_setzero_ps();
+   v_one = _mm256_set1_ps(1.0f);
+   v_two = _mm256_set1_ps(2.0f);
+   v_three = _mm256_set1_ps(3.0f);
+   v_six = _mm256_set1_ps(6.0f);
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,noff,moff,npp,nps,npoff,nn,mm,ih,nh,ist,dx,dy,edgelx, \
+edgely,edgerx,edgery,v_edgelx,v_edgely,v_edgerx,v_edgery,v_dx,v_dy, \
+v_st,v_at,v_x,v_y,ll)
+   for (k = 0; k < mxy1; k++) {
+      noff = k/mx1;
+      moff = my*noff;
+      noff = mx*(k - mx1*noff);
+      npp = kpic[k];
+      nps = 8*(npp/8);
+      npoff = idimp*nppmx*k;
+      nn = nx - noff;
+      nn = mx < nn ? mx : nn;
+      mm = ny - moff;
+      mm = my < mm ? my : mm;
+      ih = 0;
+      nh = 0;
+      edgelx = noff;
+      edgerx = noff + nn;
+      edgely = moff;
+      edgery = moff + mm;
+      noff = (ntmax+1)*k;
+      v_edgelx = _mm256_set1_ps(edgelx);
+      v_edgely = _mm256_set1_ps(edgely);
+      v_edgerx = _mm256_set1_ps(edgerx);
+      v_edgery = _mm256_set1_ps(edgery);
+/* clear counters */
+/*    for (j = 0; j < 8; j++) { */
+/*       ncl[j+8*k] = 0;        */
+/*    }                         */
+      memset((void*)&ncl[8*k],0,8*sizeof(int));
+/* loop over particles in tile in groups of 8 */
+      for (j = 0; j < nps; j+=8) {
+/*       dx = ppart[j+npoff];       */
+/*       dy = ppart[j+nppmx+npoff]; */
+         v_dx = _mm256_load_ps(&ppart[j+npoff]);
+         v_dy = _mm256_load_ps(&ppart[j+nppmx+npoff]);
+/* find particles going out of bounds */
+/*       ist = 0; */
+         v_st = v_zero;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* ist = direction particle is going                             */
+/*       if (dx >= edgerx) {              */
+/*          if (dx >= anx)                */
+/*             ppart[j+npoff] = dx - anx; */
+/*          ist = 2;                      */
+/*       }                                */
+         v_x = _mm256_cmp_ps(v_dx,v_edgerx,_CMP_GE_OQ);
+         v_y = _mm256_cmp_ps(v_dx,v_edgelx,_CMP_LT_OQ);
+/* execute if either test result is true for any particle */
+         if (_mm256_movemask_ps(_mm256_or_ps(v_x,v_y))) {
+            v_st = _mm256_and_ps(v_two,v_x);
+            v_x = _mm256_and_ps(v_x,
+                  _mm256_cmp_ps(v_dx,v_anx,_CMP_GE_OQ));
+/* write output if test result is true for any particle */
+            if (_mm256_movemask_ps(v_x)) {
+               v_x = _mm256_sub_ps(v_dx,_mm256_and_ps(v_anx,v_x));
+               _mm256_store_ps(&ppart[j+npoff],v_x);
+            }
+/*          if (dx < edgelx) {         */
+/*             if (dx < 0.0) {         */
+/*                dx += anx;           */
+/*                if (dx < anx)        */
+/*                   ist += 1;         */
+/*                else                 */
+/*                   dx = 0.0;         */
+/*                ppart[j+npoff] = dx; */
+/*             }                       */
+/*             else {                  */
+/*                ist += 1;            */
+/*             }                       */
+/*          }                          */
+            v_at = _mm256_and_ps(v_one,v_y);
+            v_x = _mm256_and_ps(v_y,
+                  _mm256_cmp_ps(v_dx,v_zero,_CMP_LT_OQ));
+/* write output if test result is true for any particle */
+            if (_mm256_movemask_ps(v_x)) {
+               v_x = _mm256_add_ps(v_dx,_mm256_and_ps(v_anx,v_x));
+               v_y = _mm256_cmp_ps(v_x,v_anx,_CMP_LT_OQ);
+               v_at = _mm256_and_ps(v_at,v_y);
+               v_x = _mm256_and_ps(v_x,v_y);
+               _mm256_store_ps(&ppart[j+npoff],v_x);
+            }
+            v_st = _mm256_add_ps(v_st,v_at);
+         }
+/*       if (dy >= edgery) {                    */
+/*          if (dy >= any)                      */
+/*             ppart[j+nppmx+npoff] = dy - any; */
+/*          ist += 6;                           */
+/*       }                                      */
+         v_y = _mm256_cmp_ps(v_dy,v_edgery,_CMP_GE_OQ);
+         v_x = _mm256_cmp_ps(v_dy,v_edgely,_CMP_LT_OQ);
+/* execute if either test result is true for any particle */
+         if (_mm256_movemask_ps(_mm256_or_ps(v_x,v_y))) {
+            v_st = _mm256_add_ps(v_st,_mm256_and_ps(v_six,v_y));
+            v_y = _mm256_and_ps(v_y,
+                  _mm256_cmp_ps(v_dy,v_any,_CMP_GE_OQ));
+/* write output if test result is true for any particle */
+            if (_mm256_movemask_ps(v_y)) {
+               v_y = _mm256_sub_ps(v_dy,_mm256_and_ps(v_any,v_y));
+               _mm256_store_ps(&ppart[j+nppmx+npoff],v_y);
+            }
+/*          if (dy < edgely) {               */
+/*             if (dy < 0.0) {               */
+/*                dy += any;                 */
+/*                if (dy < any)              */
+/*                   ist += 3;               */
+/*                else                       */
+/*                   dy = 0.0;               */
+/*                ppart[j+nppmx+npoff] = dy; */
+/*             }                             */
+/*             else {                        */
+/*                ist += 3;                  */
+/*             }                             */
+/*          }                                */
+            v_at = _mm256_and_ps(v_three,v_x);
+            v_y = _mm256_and_ps(v_x,
+                  _mm256_cmp_ps(v_dy,v_zero,_CMP_LT_OQ));
+/* write output if test result is true for any particle */
+            if (_mm256_movemask_ps(v_y)) {
+               v_y = _mm256_add_ps(v_dy,_mm256_and_ps(v_any,v_y));
+               v_x = _mm256_cmp_ps(v_y,v_any,_CMP_LT_OQ);
+               v_at = _mm256_and_ps(v_at,v_x);
+               v_y = _mm256_and_ps(v_y,v_x);
+               _mm256_store_ps(&ppart[j+nppmx+npoff],v_y);
+            }
+            v_st = _mm256_add_ps(v_st,v_at);
+         }
+/* increment counters, only if some particle is leaving the tile */
+/*       if (ist > 0) {                           */
+/*          ncl[ist+8*k-1] += 1;                  */
+/*          ih += 1;                              */
+/*          if (ih <= ntmax) {                    */
+/*             ihole[2*(ih+(ntmax+1)*k)] = j + 1; */
+/*             ihole[1+2*(ih+(ntmax+1)*k)] = ist; */
+/*          }                                     */
+/*          else {                                */
+/*             nh = 1;                            */
+/*          }                                     */
+/*       }                                        */
+         if (_mm256_movemask_ps(_mm256_cmp_ps(v_st,v_zero,
+                                              _CMP_NEQ_OQ))) {
+            _mm256_store_si256((__m256i *)ll,_mm256_cvttps_epi32(v_st));
+            for (i = 0; i < 8; i++) {
+               ist = ll[i];
+               if (ist > 0) {
+                  ncl[ist+8*k-1] += 1;
+                  ih += 1;
+                  if (ih <= ntmax) {
+                     ihole[2*(ih+noff)] = j + i + 1;
+                     ihole[1+2*(ih+noff)] = ist;
+                  }
+                  else {
+                     nh = 1;
+                  }
+               }
+            }
+         }
+      }
+/* loop over remaining particles in tile */
+      for (j = nps; j < npp; j++) {
+         dx = ppart[j+npoff];
+         dy = ppart[j+nppmx+npoff];
+/* find particles going out of bounds */
+         ist = 0;
+/* count how many particles are going in each direction in ncl   */
+/* save their address and destination in ihole                   */
+/* use periodic boundary conditions and check for roundoff error */
+/* ist = direction particle is going                             */
+         if (dx >= edgerx) {
+            if (dx >= anx)
+               ppart[j+npoff] = dx - anx;
+            ist = 2;
+         }
+         else if (dx < edgelx) {
+            if (dx < 0.0) {
+               dx += anx;
+               if (dx < anx)
+                  ist = 1;
+               else
+                  dx = 0.0;
+               ppart[j+npoff] = dx;
+            }
+            else {
+               ist = 1;
+            }
+         }
+         if (dy >= edgery) {
+            if (dy >= any)
+               ppart[j+nppmx+npoff] = dy - any;
+            ist += 6;
+         }
+         else if (dy < edgely) {
+            if (dy < 0.0) {
+               dy += any;
+               if (dy < any)
+                  ist += 3;
+               else
+                  dy = 0.0;
+               ppart[j+nppmx+npoff] = dy;
+            }
+            else {
+               ist += 3;
+            }
+         }
+         if (ist > 0) {
+            ncl[ist+8*k-1] += 1;
+            ih += 1;
+            if (ih <= ntmax) {
+               ihole[2*(ih+noff)] = j + 1;
+               ihole[1+2*(ih+noff)] = ist;
+            }
+            else {
+               nh = 1;
+            }
+         }
+      }
+/* set error and end of file flag */
+      if (nh > 0) {
+         *irc = ih;
+         ih = -ih;
+      }
+      ihole[2*noff] = ih;
+   }
+/* ihole overflow */
+   if (*irc > 0)
+      return;
+
+/* buffer particles that are leaving tile and copy incoming particles */
+/* from buffer into ppart: update ppart, ppbuff, kpic, ncl, irc       */
+   cavx2pporderf2lt(ppart,ppbuff,kpic,ncl,ihole,idimp,nppmx,mx1,my1,
+                    npbmx,ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2pporderf2lt(float ppart[], float ppbuff[], int kpic[],
+                      int ncl[], int ihole[], int idimp, int nppmx,
+                      int mx1, int my1, int npbmx, int ntmax,
+                      int *irc) {
+/* this subroutine sorts particles by x,y grid in tiles of mx, my
+   linear interpolation, with periodic boundary conditions
+   tiles are assumed to be arranged in 2D linear memory
+   the algorithm has 2 steps.  first, a prefix scan of ncl is performed
+   and departing particles are buffered in ppbuff in direction order.
+   then we copy the incoming particles from other tiles into ppart.
+   it assumes that the number, location, and destination of particles
+   leaving a tile have been previously stored in ncl and ihole by the
+   cavx2gppushf2lt procedure.
+   input: all except ppbuff, irc
+   output: ppart, ppbuff, kpic, ncl, irc
+   ppart[k][0][n] = position x of particle n in tile k
+   ppart[k][1][n] = position y of particle n in tile k
+   ppbuff[k][i][n] = i co-ordinate of particle n in tile k
+   kpic[k] = number of particles in tile k
+   ncl[k][i] = number of particles going to destination i, tile k
+   ihole[k][:][0] = location of hole in array left by departing particle
+   ihole[k][:][1] = direction destination of particle leaving hole
+   all for tile k
+   ihole[k][0][0] = ih, number of holes left (error, if negative)
+   idimp = size of phase space = 4
+   nppmx = maximum number of particles in tile
+   mx1 = (system length in x direction - 1)/mx + 1
+   my1 = (system length in y direction - 1)/my + 1
+   npbmx = size of buffer array ppbuff
+   ntmax = size of hole array for particles leaving tiles
+   irc = maximum overflow, returned only if error occurs, when irc > 0
+   requires AVX2
+local data                                                            */
+   int mxy1, npoff, npp, nboff, ncoff;
+   int i, j, k, ii, kx, ky, ih, nh, ist, nn;
+   int ip, j1, j2, kxl, kxr, kk, kl, kr;
+   __m256i v_it, v_is, v_zero, v_p1, v_p2, v_p4;
+   int ks[8];
+   mxy1 = mx1*my1;
+   v_zero = _mm256_setzero_si256();
+/* permutations which shift data up by 1, 2 and 4 elements */
+   v_p1 = _mm256_set_epi32(6,5,4,3,2,1,0,0);
+   v_p2 = _mm256_set_epi32(5,4,3,2,1,0,0,0);
+   v_p4 = _mm256_set_epi32(3,2,1,0,0,0,0,0);
+/* buffer particles that are leaving tile: update ppbuff, ncl */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,npoff,nboff,ist,nh,ip,j1,ii,v_it,v_is)
+   for (k = 0; k < mxy1; k++) {
+      npoff = idimp*nppmx*k;
+      nboff = idimp*npbmx*k;
+/* find address offset for ordered ppbuff array */
+/*    isum = 0;                 */
+/*    for (j = 0; j < 8; j++) { */
+/*       ist = ncl[j+8*k];      */
+/*       ncl[j+8*k] = isum;     */
+/*       isum += ist;           */
+/*    }                         */
+/* perform exclusive prefix scan with 3 shift and add passes */
+      v_it = _mm256_loadu_si256((__m256i *)&ncl[8*k]);
+      v_is = _mm256_permutevar8x32_epi32(v_it,v_p1);
+      v_it = _mm256_add_epi32(v_it,_mm256_blend_epi32(v_is,v_zero,1));
+      v_is = _mm256_permutevar8x32_epi32(v_it,v_p2);
+      v_it = _mm256_add_epi32(v_it,_mm256_blend_epi32(v_is,v_zero,3));
+      v_is = _mm256_permutevar8x32_epi32(v_it,v_p4);
+      v_it = _mm256_add_epi32(v_it,_mm256_blend_epi32(v_is,v_zero,15));
+/* shift inclusive scan by one element to make it exclusive */
+      v_is = _mm256_permutevar8x32_epi32(v_it,v_p1);
+      v_it = _mm256_blend_epi32(v_is,v_zero,1);
+      _mm256_storeu_si256((__m256i *)&ncl[8*k],v_it);
+      nh = ihole[2*(ntmax+1)*k];
+      ip = 0;
+/* loop over particles leaving tile */
+      for (j = 0; j < nh; j++) {
+/* buffer particles that are leaving tile, in direction order */
+         j1 = ihole[2*(j+1+(ntmax+1)*k)] - 1;
+         ist = ihole[1+2*(j+1+(ntmax+1)*k)];
+         ii = ncl[ist+8*k-1];
+         if (ii < npbmx) {
+            for (i = 0; i < idimp; i++) {
+               ppbuff[ii+npbmx*i+nboff]
+               = ppart[j1+nppmx*i+npoff];
+            }
+         }
+         else {
+            ip = 1;
+         }
+         ncl[ist+8*k-1] = ii + 1;
+      }
+/* set error */
+      if (ip > 0)
+         *irc = ncl[7+8*k];
+   }
+/* ppbuff overflow */
+   if (*irc > 0)
+      return;
+
+/* copy incoming particles from buffer into ppart: update ppart, kpic */
+/* loop over tiles */
+#pragma omp parallel for \
+private(i,j,k,ii,kk,npp,npoff,nboff,kx,ky,kl,kr,kxl,kxr,ih,nh,nn, \
+ncoff,ist,j1,j2,ip,ks)
+   for (k = 0; k < mxy1; k++) {
+      npp = kpic[k];
+      npoff = idimp*nppmx*k;
+      ky = k/mx1;
+/* loop over tiles in y, assume periodic boundary conditions */
+      kk = ky*mx1;
+/* find tile above */
+      kl = ky - 1;
+      if (kl < 0)
+         kl += my1;
+      kl = kl*mx1;
+/* find tile below */
+      kr = ky + 1;
+      if (kr >= my1)
+          kr -= my1;
+      kr = kr*mx1;
+/* loop over tiles in x, assume periodic boundary conditions */
+      kx = k - ky*mx1;
+      kxl = kx - 1;
+      if (kxl < 0)
+         kxl += mx1;
+      kxr = kx + 1;
+      if (kxr >= mx1)
+         kxr -= mx1;
+/* find tile number for different directions */
+      ks[0] = kxr + kk;
+      ks[1] = kxl + kk;
+      ks[2] = kx + kr;
+      ks[3] = kxr + kr;
+      ks[4] = kxl + kr;
+      ks[5] = kx + kl;
+      ks[6] = kxr + kl;
+      ks[7] = kxl + kl;
+/* loop over directions */
+      nh = ihole[2*(ntmax+1)*k];
+      ncoff = 0;
+      ih = 0;
+      ist = 0;
+      j1 = 0;
+      for (ii = 0; ii < 8; ii++) {
+         nboff = idimp*npbmx*ks[ii];
+         if (ii > 0)
+            ncoff = ncl[ii-1+8*ks[ii]];
+/* ip = number of particles coming from direction ii */
+         ip = ncl[ii+8*ks[ii]] - ncoff;
+         for (j = 0; j < ip; j++) {
+            ih += 1;
+/* insert incoming particles into holes */
+            if (ih <= nh) {
+               j1 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+/* place overflow at end of array */
+            else {
+               j1 = npp;
+               npp += 1;
+            }
+            if (j1 < nppmx) {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j1+nppmx*i+npoff]
+                  = ppbuff[j+ncoff+npbmx*i+nboff];
+                }
+            }
+            else {
+               ist = 1;
+            }
+         }
+      }
+/* set error */
+      if (ist > 0)
+         *irc = j1+1;
+/* fill up remaining holes in particle array with particles from bottom */
+/* holes with locations great than npp-ip do not need to be filled      */
+      if (ih < nh) {
+         ip = nh - ih;
+         ii = nh;
+         nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+         ih += 1;
+         j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+/* move particles from end into remaining holes */
+/* holes are processed in increasing order      */
+         for (j = 0; j < ip; j++) {
+            j1 = npp - j - 1;
+            if (j1==nn) {
+               ii -= 1;
+               nn = ihole[2*(ii+(ntmax+1)*k)] - 1;
+            }
+            else {
+               for (i = 0; i < idimp; i++) {
+                  ppart[j2+nppmx*i+npoff]
+                  = ppart[j1+nppmx*i+npoff];
+               }
+               ih += 1;
+               j2 = ihole[2*(ih+(ntmax+1)*k)] - 1;
+            }
+         }
+         npp -= ip;
+      }
+      kpic[k] = npp;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2cguard2l(float fxy[], int nx, int ny, int nxe, int nye) {
+/* replicate extended periodic vector field fxy
+   linear interpolation
+   nx/ny = system length in x/y direction
+   nxe = first dimension of field arrays, must be >= nx+1
+   nye = second dimension of field arrays, must be >= ny+1
+   requires AVX2
+local data                                                 */
+   int j, k, nxs;
+   nxs = 4*(nx/4);
+/* copy edges of extended field */
+   for (k = 0; k < ny; k++) {
+      fxy[2*nx+2*nxe*k] = fxy[2*nxe*k];
+      fxy[1+2*nx+2*nxe*k] = fxy[1+2*nxe*k];
+   }
+/* vector loop over elements in blocks of 4 */
+   for (j = 0; j < nxs; j+=4) {
+      _mm256_storeu_ps(&fxy[2*j+2*nxe*ny],_mm256_loadu_ps(&fxy[2*j]));
+   }
+/* loop over remaining elements */
+   for (j = nxs; j < nx; j++) {
+      fxy[2*j+2*nxe*ny] = fxy[2*j];
+      fxy[1+2*j+2*nxe*ny] = fxy[1+2*j];
+   }
+   fxy[2*nx+2*nxe*ny] = fxy[0];
+   fxy[1+2*nx+2*nxe*ny] = fxy[1];
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2aguard2l(float q[], int nx, int ny, int nxe, int nye) {
+/* accumulate extended periodic scalar field q
+   linear interpolation
+   nx/ny = system length in x/y direction
+   nxe = first dimension of field arrays, must be >= nx+1
+   nye = second dimension of field arrays, must be >= ny+1
+   requires AVX2
+local data                                                 */
+   int j, k, nxs;
+   __m256 v_q;
+   nxs = 8*(nx/8);
+/* accumulate edges of extended field */
+   for (k = 0; k < ny; k++) {
+      q[nxe*k] += q[nx+nxe*k];
+      q[nx+nxe*k] = 0.0;
+   }
+/* vector loop over elements in blocks of 8 */
+   for (j = 0; j < nxs; j+=8) {
+      v_q = _mm256_add_ps(_mm256_loadu_ps(&q[j]),
+                          _mm256_loadu_ps(&q[j+nxe*ny]));
+      _mm256_storeu_ps(&q[j],v_q);
+      _mm256_storeu_ps(&q[j+nxe*ny],_mm256_setzero_ps());
+   }
+/* loop over remaining elements */
+   for (j = nxs; j < nx; j++) {
+      q[j] += q[j+nxe*ny];
+      q[j+nxe*ny] = 0.0;
+   }
+   q[0] += q[nx+nxe*ny];
+   q[nx+nxe*ny] = 0.0;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2mpois22(float complex q[], float complex fxy[], int isign,
+                  float complex ffc[], float ax, float ay, float affp,
+                  float *we, int nx, int ny, int nxvh, int nyv,
+                  int nxhd, int nyhd) {
+/* this subroutine solves 2d poisson's equation in fourier space for
+   force/charge (or convolution of electric field over particle shape)
+   with periodic boundary conditions.
+   for isign = 0, input: isign,ax,ay,affp,nx,ny,nxvh,nyhd, output: ffc
+   for isign /= 0, input: q,ffc,isign,nx,ny,nxvh,nyhd, output: fxy,we
+   approximate flop count is: 26*nxc*nyc + 12*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   equation used is:
+   fx[ky][kx] = -sqrt(-1)*kx*g[ky][kx]*s[ky][kx]*q[ky][kx],
+   fy[ky][kx] = -sqrt(-1)*ky*g[ky][kx]*s[ky][kx]*q[ky][kx],
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   g[ky][kx] = (affp/(kx**2+ky**2))*s(kx,ky),
+   s[ky][kx] = exp(-((kx*ax)**2+(ky*ay)**2)/2), except for
+   fx(kx=pi) = fy(kx=pi) = fx(ky=pi) = fy(ky=pi) = 0, and
+   fx(kx=0,ky=0) = fy(kx=0,ky=0) = 0.
+   q[k][j] = complex charge density for fourier mode (j,k)
+   fxy[k][j][0] = x component of complex force/charge,
+   fxy[k][j][1] = y component of complex force/charge,
+   all for fourier mode (j,k)
+   if isign = 0, form factor array is prepared
+   if isign is not equal to 0, force/charge is calculated
+   cimag(ffc[k][j]) = finite-size particle shape factor s
+   for fourier mode (j,k)
+   creal(ffc[k][j]) = potential green's function g
+   for fourier mode (j,k)
+   ax/ay = half-width of particle in x/y direction
+   affp = normalization constant = nx*ny/np, where np=number of particles
+   electric field energy is also calculated, using
+   we = nx*ny*sum((affp/(kx**2+ky**2))*|q[ky][kx]*s[ky][kx]|**2)
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+   requires AVX2
+local data                                                 */
+   int nxh, nyh, nxhs, j, k, k1, kk, kj, it;
+   float dnx, dny, dkx, dky, at1, at2, at3, at4;
+   float complex zero, zt1, zt2;
+   double wp, sum1;
+   __m256i v_j;
+   __m256 v_dnx, v_dky, v_at1, v_at2, v_at3, v_at4;
+   __m256 v_zero, v_m, v_k0, v_zt1, v_zt2, v_zt3, v_zt4;
+   __m256d v_wp, v_d;
+   __attribute__((aligned(32))) double dd[4];
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   nxhs = 4*(nxh/4);
+   dnx = 6.28318530717959/(float) nx;
+   dny = 6.28318530717959/(float) ny;
+   zero = 0.0 + 0.0*_Complex_I;
+   v_j = _mm256_set_epi32(3,3,2,2,1,1,0,0);
+   v_dnx = _mm256_set1_ps(dnx);
+   v_zero = _mm256_setzero_ps();
+   v_m = _mm256_set_ps(1.0f,-1.0f,1.0f,-1.0f,1.0f,-1.0f,1.0f,-1.0f);
+/* mask which zeros out the kx = 0 mode */
+   v_k0 = _mm256_castsi256_ps(_mm256_set_epi32(-1,-1,-1,-1,-1,-1,0,0));
+   if (isign != 0)
+      goto L30;
+/* prepare form factor array */
+   for (k = 0; k < nyh; k++) {
+      dky = dny*(float) k;
+      kk = nxhd*k;
+      at1 = dky*dky;
+      at2 = pow((dky*ay),2);
+      for (j = 0; j < nxh; j++) {
+         dkx = dnx*(float) j;
+         at3 = dkx*dkx + at1;
+         at4 = exp(-0.5*(pow((dkx*ax),2) + at2));
+         if (at3==0.0) {
+            ffc[j+kk] = affp + 1.0*_Complex_I;
+         }
+         else {
+            ffc[j+kk] = (affp*at4/at3) + at4*_Complex_I;
+         }
+      }
+   }
+   return;
+/* calculate force/charge and sum field energy */
+L30: sum1 = 0.0;
+#pragma omp parallel for \
+private(j,k,k1,kk,kj,dky,at1,at2,at3,zt1,zt2,wp,v_dky,v_at1,v_at2, \
+v_at3,v_at4,v_zt1,v_zt2,v_zt3,v_zt4,v_wp,v_d,dd) \
+reduction(+:sum1)
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      dky = dny*(float) k;
+      v_dky = _mm256_set1_ps(dky);
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      wp = 0.0;
+      v_wp = _mm256_set1_pd(0.0);
+/* vector loop over elements in blocks of 4 */
+      for (j = 0; j < nxhs; j+=4) {
+/*       at1 = crealf(ffc[j+kk])*cimagf(ffc[j+kk]); */
+         v_at1 = _mm256_loadu_ps((float *)&ffc[j+kk]);
+         v_at1 = _mm256_mul_ps(v_at1,_mm256_permute_ps(v_at1,177));
+/*       at2 = at1*dnx*(float) j; */
+         v_at2 = _mm256_cvtepi32_ps(_mm256_add_epi32(
+                 _mm256_set1_epi32(j),v_j));
+         v_at2 = _mm256_mul_ps(v_at1,_mm256_mul_ps(v_dnx,v_at2));
+/*       at3 = dky*at1; */
+         v_at3 = _mm256_mul_ps(v_dky,v_at1);
+/*       zt1 = cimagf(q[j+kj]) - crealf(q[j+kj])*_Complex_I; */
+         v_zt1 = _mm256_loadu_ps((float *)&q[j+kj]);
+         v_zt1 = _mm256_permute_ps(_mm256_mul_ps(v_zt1,v_m),177);
+/*       zt2 = cimagf(q[j+k1]) - crealf(q[j+k1])*_Complex_I; */
+         v_zt2 = _mm256_loadu_ps((float *)&q[j+k1]);
+         v_zt2 = _mm256_permute_ps(_mm256_mul_ps(v_zt2,v_m),177);
+/* zero out kx = 0 mode */
+         if (j==0) {
+            v_zt1 = _mm256_and_ps(v_zt1,v_k0);
+            v_zt2 = _mm256_and_ps(v_zt2,v_k0);
+         }
+/*       fxy[2*j+2*kj] = at2*zt1;   */
+/*       fxy[1+2*j+2*kj] = at3*zt1; */
+         v_at4 = _mm256_mul_ps(v_at2,v_zt1);
+         v_zt4 = _mm256_mul_ps(v_at3,v_zt1);
+/* reorder write */
+         v_zt3 = _mm256_shuffle_ps(v_at4,v_zt4,68);
+         v_zt4 = _mm256_shuffle_ps(v_at4,v_zt4,238);
+         _mm256_storeu_ps((float *)&fxy[2*(j+kj)],
+                          _mm256_permute2f128_ps(v_zt3,v_zt4,32));
+         _mm256_storeu_ps((float *)&fxy[2*(j+2+kj)],
+                          _mm256_permute2f128_ps(v_zt3,v_zt4,49));
+/*       fxy[2*j+2*k1] = at2*zt2;    */
+/*       fxy[1+2*j+2*k1] = -at3*zt2; */
+         v_at4 = _mm256_mul_ps(v_at2,v_zt2);
+         v_zt4 = _mm256_sub_ps(v_zero,_mm256_mul_ps(v_at3,v_zt2));
+/* reorder write */
+         v_zt3 = _mm256_shuffle_ps(v_at4,v_zt4,68);
+         v_zt4 = _mm256_shuffle_ps(v_at4,v_zt4,238);
+         _mm256_storeu_ps((float *)&fxy[2*(j+k1)],
+                          _mm256_permute2f128_ps(v_zt3,v_zt4,32));
+         _mm256_storeu_ps((float *)&fxy[2*(j+2+k1)],
+                          _mm256_permute2f128_ps(v_zt3,v_zt4,49));
+/*       wp += at1*(q[j+kj]*conjf(q[j+kj]) + q[j+k1]*conjf(q[j+k1])); */
+         v_at4 = _mm256_fmadd_ps(v_zt2,v_zt2,_mm256_mul_ps(v_zt1,v_zt1));
+         v_at4 = _mm256_mul_ps(v_at1,v_at4);
+/* convert to double precision before accumulating */
+         v_d = _mm256_cvtps_pd(_mm256_castps256_ps128(v_at4));
+         v_wp = _mm256_add_pd(v_wp,v_d);
+         v_d = _mm256_cvtps_pd(_mm256_extractf128_ps(v_at4,1));
+         v_wp = _mm256_add_pd(v_wp,v_d);
+      }
+/* loop over remaining elements */
+      it = 1 > nxhs ? 1 : nxhs;
+      for (j = it; j < nxh; j++) {
+         at1 = crealf(ffc[j+kk])*cimagf(ffc[j+kk]);
+         at2 = at1*dnx*(float) j;
+         at3 = dky*at1;
+         zt1 = cimagf(q[j+kj]) - crealf(q[j+kj])*_Complex_I;
+         zt2 = cimagf(q[j+k1]) - crealf(q[j+k1])*_Complex_I;
+         fxy[2*j+2*kj] = at2*zt1;
+         fxy[1+2*j+2*kj] = at3*zt1;
+         fxy[2*j+2*k1] = at2*zt2;
+         fxy[1+2*j+2*k1] = -at3*zt2;
+         wp += at1*(q[j+kj]*conjf(q[j+kj]) + q[j+k1]*conjf(q[j+k1]));
+      }
+/*    sum1 += wp; */
+      _mm256_store_pd(&dd[0],v_wp);
+      for (j = 1; j < 4; j++) {
+         dd[0] += dd[j];
+      }
+      sum1 += (wp + dd[0]);
+   }
+   wp = 0.0;
+   v_wp = _mm256_set1_pd(0.0);
+/* mode numbers kx = 0, nx/2 */
+   for (k = 1; k < nyh; k++) {
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      at1 = crealf(ffc[kk])*cimagf(ffc[kk]);
+      at3 = at1*dny*(float) k;
+      zt1 = cimagf(q[kj]) - crealf(q[kj])*_Complex_I;
+      fxy[2*kj] = zero;
+      fxy[1+2*kj] = at3*zt1;
+      fxy[2*k1] = zero;
+      fxy[1+2*k1] = zero;
+      wp += at1*(q[kj]*conjf(q[kj]));
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = 2*nxvh*nyh;
+/* vector loop over elements in blocks of 4 */
+   for (j = 0; j < nxhs; j+=4) {
+/*    at1 = crealf(ffc[j])*cimagf(ffc[j]); */
+      v_at1 = _mm256_loadu_ps((float *)&ffc[j]);
+      v_at1 = _mm256_mul_ps(v_at1,_mm256_permute_ps(v_at1,177));
+/*    at2 = at1*dnx*(float) j; */
+      v_at2 = _mm256_cvtepi32_ps(_mm256_add_epi32(
+              _mm256_set1_epi32(j),v_j));
+      v_at2 = _mm256_mul_ps(v_at1,_mm256_mul_ps(v_dnx,v_at2));
+/*    zt1 = cimagf(q[j]) - crealf(q[j])*_Complex_I; */
+      v_zt1 = _mm256_loadu_ps((float *)&q[j]);
+      v_zt1 = _mm256_permute_ps(_mm256_mul_ps(v_zt1,v_m),177);
+/* zero out kx = 0 mode */
+      if (j==0) {
+         v_zt1 = _mm256_and_ps(v_zt1,v_k0);
+      }
+/*    fxy[2*j] = at2*zt1; */
+/*    fxy[1+2*j] = zero;  */
+      v_at4 = _mm256_mul_ps(v_at2,v_zt1);
+/* reorder write */
+      v_zt3 = _mm256_shuffle_ps(v_at4,v_zero,68);
+      v_zt4 = _mm256_shuffle_ps(v_at4,v_zero,238);
+      _mm256_storeu_ps((float *)&fxy[2*j],
+                       _mm256_permute2f128_ps(v_zt3,v_zt4,32));
+      _mm256_storeu_ps((float *)&fxy[2*j+4],
+                       _mm256_permute2f128_ps(v_zt3,v_zt4,49));
+/*    fxy[2*j+k1] = zero;   */
+/*    fxy[1+2*j+k1] = zero; */
+      _mm256_storeu_ps((float *)&fxy[2*j+k1],v_zero);
+      _mm256_storeu_ps((float *)&fxy[2*j+4+k1],v_zero);
+/*    wp += at1*(q[j]*conjf(q[j])); */
+      v_at4 = _mm256_mul_ps(v_at1,_mm256_mul_ps(v_zt1,v_zt1));
+/* convert to double precision before accumulating */
+      v_d = _mm256_cvtps_pd(_mm256_castps256_ps128(v_at4));
+      v_wp = _mm256_add_pd(v_wp,v_d);
+      v_d = _mm256_cvtps_pd(_mm256_extractf128_ps(v_at4,1));
+      v_wp = _mm256_add_pd(v_wp,v_d);
+   }
+/* loop over remaining elements */
+   it = 1 > nxhs ? 1 : nxhs;
+   for (j = it; j < nxh; j++) {
+      at1 = crealf(ffc[j])*cimagf(ffc[j]);
+      at2 = at1*dnx*(float) j;
+      zt1 = cimagf(q[j]) - crealf(q[j])*_Complex_I;
+      fxy[2*j] = at2*zt1;
+      fxy[1+2*j] = zero;
+      fxy[2*j+k1] = zero;
+      fxy[1+2*j+k1] = zero;
+      wp += at1*(q[j]*conjf(q[j]));
+   }
+   fxy[0] = zero;
+   fxy[1] = zero;
+   fxy[k1] = zero;
+   fxy[1+k1] = zero;
+   sum1 += wp;
+/* *we = sum1*(float) (nx*ny); */
+   _mm256_store_pd(&dd[0],v_wp);
+   for (j = 1; j < 4; j++) {
+      dd[0] += dd[j];
+   }
+   *we = (sum1 + dd[0])*(float) (nx*ny);
+   return;
+}
+
+/* Interfaces to Fortran */
+
+/*--------------------------------------------------------------------*/
+void cavx2gppush2lt_(float *ppart, float *fxy, int *kpic, float *qbm,
+                     float *dt, float *ek, int *idimp, int *nppmx,
+                     int *nx, int *ny, int *mx, int *my, int *nxv,
+                     int *nyv, int *mx1, int *mxy1, int *ipbc) {
+   cavx2gppush2lt(ppart,fxy,kpic,*qbm,*dt,ek,*idimp,*nppmx,*nx,*ny,*mx,
+                  *my,*nxv,*nyv,*mx1,*mxy1,*ipbc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2gppushf2lt_(float *ppart, float *fxy, int *kpic, int *ncl,
+                      int *ihole, float *qbm, float *dt, float *ek,
+                      int *idimp, int *nppmx, int *nx, int *ny, int *mx,
+                      int *my, int *nxv, int *nyv, int *mx1, int *mxy1,
+                      int *ntmax, int *irc) {
+   cavx2gppushf2lt(ppart,fxy,kpic,ncl,ihole,*qbm,*dt,ek,*idimp,*nppmx,
+                   *nx,*ny,*mx,*my,*nxv,*nyv,*mx1,*mxy1,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2gppost2lt_(float *ppart, float *q, int *kpic, float *qm,
+                     int *nppmx, int *idimp, int *mx, int *my, int *nxv,
+                     int *nyv, int *mx1, int *mxy1) {
+   cavx2gppost2lt(ppart,q,kpic,*qm,*nppmx,*idimp,*mx,*my,*nxv,*nyv,*mx1,
+                  *mxy1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2pporder2lt_(float *ppart, float *ppbuff, int *kpic, int *ncl,
+                      int *ihole, int *idimp, int *nppmx, int *nx,
+                      int *ny, int *mx, int *my, int *mx1, int *my1,
+                      int *npbmx, int *ntmax, int *irc) {
+   cavx2pporder2lt(ppart,ppbuff,kpic,ncl,ihole,*idimp,*nppmx,*nx,*ny,
+                   *mx,*my,*mx1,*my1,*npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2pporderf2lt_(float *ppart, float *ppbuff, int *kpic, int *ncl,
+                       int *ihole, int *idimp, int *nppmx, int *mx1,
+                       int *my1, int *npbmx, int *ntmax, int *irc) {
+   cavx2pporderf2lt(ppart,ppbuff,kpic,ncl,ihole,*idimp,*nppmx,*mx1,*my1,
+                    *npbmx,*ntmax,irc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2cguard2l_(float *fxy, int *nx, int *ny, int *nxe, int *nye) {
+   cavx2cguard2l(fxy,*nx,*ny,*nxe,*nye);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2aguard2l_(float *q, int *nx, int *ny, int *nxe, int *nye) {
+   cavx2aguard2l(q,*nx,*ny,*nxe,*nye);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cavx2mpois22_(float complex *q, float complex *fxy, int *isign,
+                   float complex *ffc, float *ax, float *ay,
+                   float *affp, float *we, int *nx, int *ny, int *nxvh,
+                   int *nyv, int *nxhd, int *nyhd) {
+   cavx2mpois22(q,fxy,*isign,ffc,*ax,*ay,*affp,we,*nx,*ny,*nxvh,*nyv,
+                *nxhd,*nyhd);
+   return;
+}
@@ -0,0 +1,35 @@
+/* header file for avx2mpush2.c */
+
+void cavx2gppush2lt(float ppart[], float fxy[], int kpic[], float qbm,
+                    float dt, float *ek, int idimp, int nppmx, int nx,
+                    int ny, int mx, int my, int nxv, int nyv, int mx1,
+                    int mxy1, int ipbc);
+
+void cavx2gppushf2lt(float ppart[], float fxy[], int kpic[], int ncl[],
+                     int ihole[], float qbm, float dt, float *ek,
+                     int idimp, int nppmx, int nx, int ny, int mx,
+                     int my, int nxv, int nyv, int mx1, int mxy1,
+                     int ntmax, int *irc);
+
+void cavx2gppost2lt(float ppart[], float q[], int kpic[], float qm,
+                    int nppmx, int idimp, int mx, int my, int nxv,
+                    int nyv, int mx1, int mxy1);
+
+void cavx2pporder2lt(float ppart[], float ppbuff[], int kpic[],
+                     int ncl[], int ihole[], int idimp, int nppmx,
+                     int nx, int ny, int mx, int my, int mx1, int my1,
+                     int npbmx, int ntmax, int *irc);
+
+void cavx2pporderf2lt(float ppart[], float ppbuff[], int kpic[],
+                      int ncl[], int ihole[], int idimp, int nppmx,
+                      int mx1, int my1, int npbmx, int ntmax,
+                      int *irc);
+
+void cavx2cguard2l(float fxy[], int nx, int ny, int nxe, int nye);
+
+void cavx2aguard2l(float q[], int nx, int ny, int nxe, int nye);
+
+void cavx2mpois22(float complex q[], float complex fxy[], int isign,
+                  float complex ffc[], float ax, float ay, float affp,
+                  float *we, int nx, int ny, int nxvh, int nyv,
+                  int nxhd, int nyhd);
@@ -9,8 +9,9 @@
 #include <mm_malloc.h>
 #include "sselib2.h"
 
-/* the following two functions work only with Intel icc compiler */
-/*
+/* check if processor supports the given instruction set extension */
+/* returns 1 if supported, 0 otherwise                               */
+#if defined(__INTEL_COMPILER)
 int check_sse2() {
    int result;
    result = _may_i_use_cpu_feature(_FEATURE_SSE2);
@@ -22,15 +23,39 @@ int check_avx() {
    result = _may_i_use_cpu_feature(_FEATURE_AVX);
    return result;
 }
-*/
+
+int check_avx2() {
+   int result;
+   result = _may_i_use_cpu_feature(_FEATURE_AVX2 | _FEATURE_FMA);
+   return result;
+}
+#else
+/* gcc and compatible compilers */
+int check_sse2() {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("sse2") ? 1 : 0;
+}
+
+int check_avx() {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx") ? 1 : 0;
+}
+
+int check_avx2() {
+   __builtin_cpu_init();
+   return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+          ? 1 : 0;
+}
+#endif
 
 /*--------------------------------------------------------------------*/
 void sse_fallocate(float **s_f, int nsize, int *irc) {
 /* allocate aligned float memory on SSE return pointer to C */
 /* size is padded to be a multiple of the alignment length */
+/* memory is 32 byte aligned, which also satisfies AVX2    */
 /* local data */
 /* NV = vector length for 32 bit data */
-#define NV             4
+#define NV             8
    int ns;
    void *sptr = NULL;
    ns = NV*((nsize - 1)/NV + 1);
@@ -48,9 +73,10 @@ void sse_fallocate(float **s_f, int nsize, int *irc) {
 void sse_callocate(float complex **s_c, int nsize, int *irc) {
 /* allocate aligned float complex memory on SSE return pointer to C */
 /* size is padded to be a multiple of the alignment length          */
+/* memory is 32 byte aligned, which also satisfies AVX2             */
 /* local data */
 /* NV = vector length for 64 bit data */
-#define NV             2
+#define NV             4
    int ns;
    void *sptr = NULL;
    ns = NV*((nsize - 1)/NV + 1);
@@ -68,9 +94,10 @@ void sse_callocate(float complex **s_c, int nsize, int *irc) {
 void sse_iallocate(int **s_i, int nsize, int *irc) {
 /* allocate aligned int memory on SSE, return pointer to C */
 /* size is padded to be a multiple of the alignment length */
+/* memory is 32 byte aligned, which also satisfies AVX2    */
 /* local data */
 /* NV = vector length for 32 bit data */
-#define NV             4
+#define NV             8
    int ns;
    void *sptr = NULL;
    ns = NV*((nsize - 1)/NV + 1);
@@ -148,17 +175,22 @@ void csse2iscan2_(int *isdata, int *nths) {
    return;
 }
 
-/* works only with Intel icc compiler */
-/*
+/*--------------------------------------------------------------------*/
 int check_sse2_() {
    return check_sse2();
 }
 
+/*--------------------------------------------------------------------*/
 int check_avx_() {
    return check_avx();
 }
-*/
 
+/*--------------------------------------------------------------------*/
+int check_avx2_() {
+   return check_avx2();
+}
+
+/*--------------------------------------------------------------------*/
 void fcopyin_(float *f, float *g, int *n) {
    int j;
    for (j = 0; j < *n; j++) {
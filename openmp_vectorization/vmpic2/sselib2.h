@@ -14,3 +14,5 @@ int check_sse2();
 
 int check_avx();
 
+int check_avx2();
+
@@ -9,6 +9,7 @@
 #include "omplib.h"
 #include "sselib2.h"
 #include "ssempush2.h"
+#include "avx2mpush2.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -38,8 +39,9 @@ int main(int argc, char *argv[]) {
    int mx = 16, my = 16;
 /* xtras = fraction of extra particles needed for particle management */
    float xtras = 0.2;
-/* kvec = (1,2) = run (autovector,SSE2) version */
-   int kvec = 1;
+/* kvec = (1,2,3) = run (autovector,SSE2,AVX2) version */
+/* kvec = 0 selects the fastest version supported by the processor */
+   int kvec = 0;
 
 /* declare scalars for standard code */
    int j;
@@ -93,6 +95,18 @@ int main(int argc, char *argv[]) {
 /* scanf("%i",&nvp);                   */
 /* initialize for shared memory parallel processing */
    cinit_omp(nvp);
+/* select vector version at run time */
+   if (kvec==0) {
+      kvec = 1;
+      if (check_sse2())
+         kvec = 2;
+      if (check_avx2())
+         kvec = 3;
+   }
+   else if ((kvec==3) && (!check_avx2())) {
+      printf("AVX2 not supported, using SSE2 version\n");
+      kvec = 2;
+   }
 
 /* initialize scalars for standard code */
 /* np = total number of particles in simulation */
@@ -114,7 +128,10 @@ int main(int argc, char *argv[]) {
    sct = (float complex *) malloc(nxyh*sizeof(float complex));
    kpic = (int *) malloc(mxy1*sizeof(int));
 
+/* AVX2 requires data aligned to 8 words */
    lvect = 4;
+   if (kvec==3)
+      lvect = 8;
 /* allocate vector field data */
    nxe = lvect*((nxe - 1)/lvect + 1);
    nxeh = nxe/2;
@@ -189,6 +206,10 @@ L500: if (nloop <= ntime)
       else if (kvec==2)
          csse2gppost2lt(ppartt,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,
                         mx1,mxy1);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2gppost2lt(ppartt,qe,kpic,qme,nppmx0,idimp,mx,my,nxe,nye,
+                        mx1,mxy1);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdpost += time;
@@ -200,6 +221,9 @@ L500: if (nloop <= ntime)
 /* SSE2 function */
       else if (kvec==2)
          csse2aguard2l(qe,nx,ny,nxe,nye);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2aguard2l(qe,nx,ny,nxe,nye);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
@@ -210,8 +234,8 @@ L500: if (nloop <= ntime)
       if (kvec==1)
          cwfft2rvmx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,
                     nye,nxhy,nxyh);
-/* SSE2 function */
-      else if (kvec==2)
+/* SSE2 function, also used by AVX2 version */
+      else if (kvec >= 2)
          csse2wfft2rmx((float complex *)qe,isign,mixup,sct,indx,indy,
                         nxeh,nye,nxhy,nxyh);
       dtimer(&dtime,&itime,1);
@@ -228,6 +252,10 @@ L500: if (nloop <= ntime)
       else if (kvec==2)
          csse2mpois22((float complex *)qe,(float complex *)fxye,isign,
                       ffc,ax,ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2mpois22((float complex *)qe,(float complex *)fxye,isign,
+                      ffc,ax,ay,affp,&we,nx,ny,nxeh,nye,nxh,nyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
@@ -238,8 +266,8 @@ L500: if (nloop <= ntime)
       if (kvec==1)
          cwfft2rvm2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,
                     nye,nxhy,nxyh);
-/* SSE2 function */
-      else if (kvec==2)
+/* SSE2 function, also used by AVX2 version */
+      else if (kvec >= 2)
          csse2wfft2rm2((float complex *)fxye,isign,mixup,sct,indx,indy,
                        nxeh,nye,nxhy,nxyh);
       dtimer(&dtime,&itime,1);
@@ -253,6 +281,9 @@ L500: if (nloop <= ntime)
 /* SSE2 function */
       else if (kvec==2)
          csse2cguard2l(fxye,nx,ny,nxe,nye);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2cguard2l(fxye,nx,ny,nxe,nye);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
@@ -268,6 +299,10 @@ L500: if (nloop <= ntime)
 /*    else if (kvec==2)                                                */
 /*       csse2gppush2lt(ppartt,fxye,kpic,qbme,dt,&wke,idimp,nppmx0,nx, */
 /*                      ny,mx,my,nxe,nye,mx1,mxy1,ipbc);               */
+/* AVX2 function */
+/*    else if (kvec==3)                                                */
+/*       cavx2gppush2lt(ppartt,fxye,kpic,qbme,dt,&wke,idimp,nppmx0,nx, */
+/*                      ny,mx,my,nxe,nye,mx1,mxy1,ipbc);               */
 /* updates ppartt, ncl, ihole, wke, irc */
       if (kvec==1)
          cvgppushf2lt(ppartt,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
@@ -277,6 +312,11 @@ L500: if (nloop <= ntime)
          csse2gppushf2lt(ppartt,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
                          nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,
                          &irc);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2gppushf2lt(ppartt,fxye,kpic,ncl,ihole,qbme,dt,&wke,idimp,
+                         nppmx0,nx,ny,mx,my,nxe,nye,mx1,mxy1,ntmax,
+                         &irc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
@@ -295,6 +335,10 @@ L500: if (nloop <= ntime)
 /*    else if (kvec==2)                                                */
 /*       csse2pporder2lt(ppartt,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx, */
 /*                       ny,mx,my,mx1,my1,npbmx,ntmax,&irc);           */
+/* AVX2 function */
+/*    else if (kvec==3)                                                */
+/*       cavx2pporder2lt(ppartt,ppbuff,kpic,ncl,ihole,idimp,nppmx0,nx, */
+/*                       ny,mx,my,mx1,my1,npbmx,ntmax,&irc);           */
 /* updates ppartt, ppbuff, kpic, ncl, and irc */
       if (kvec==1)
          cvpporderf2lt(ppartt,ppbuff,kpic,ncl,ihole,idimp,nppmx0,mx1,
@@ -303,6 +347,10 @@ L500: if (nloop <= ntime)
       else if (kvec==2)
          csse2pporderf2lt(ppartt,ppbuff,kpic,ncl,ihole,idimp,nppmx0,
                           mx1,my1,npbmx,ntmax,&irc);
+/* AVX2 function */
+      else if (kvec==3)
+         cavx2pporderf2lt(ppartt,ppbuff,kpic,ncl,ihole,idimp,nppmx0,
+                          mx1,my1,npbmx,ntmax,&irc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tsort += time;
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <complex.h>
+#include <math.h>
 #include <sys/time.h>
 #include "bpush2.h"
 
@@ -34,7 +35,13 @@ int main(int argc, char *argv[]) {
 /* sortime = number of time steps between standard electron sorting */
 /* relativity = (no,yes) = (0,1) = relativity is used */
    int idimp = 5, ipbc = 1, sortime = 50, relativity = 1;
+/* nsub = number of maxwell solver subcycles per particle time step */
+/* if nsub > 1, particles are pushed with time averaged fields      */
+   int nsub = 1;
    float wke = 0.0, we = 0.0, wf = 0.0, wm = 0.0, wt = 0.0;
+/* etot0 = initial total energy */
+/* edrift = maximum relative change in total energy */
+   float etot0 = 0.0, edrift = 0.0;
 /* declare scalars for standard code */
    int j;
    int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
@@ -50,6 +57,12 @@ int main(int argc, char *argv[]) {
    float *qe = NULL, *cue = NULL, *fxyze = NULL, *bxyze = NULL;
 /* exyz/bxyz = transverse electric/magnetic field in fourier space */
    float complex *exyz = NULL, *bxyz = NULL;
+/* exyza/bxyza = transverse fields averaged over subcycles */
+/* exyzs/bxyzs = transverse fields used to push particles  */
+/* exyzt/bxyzt = scratch transverse fields for subcycling  */
+   float complex *exyza = NULL, *bxyza = NULL;
+   float complex *exyzt = NULL, *bxyzt = NULL;
+   float complex *exyzs = NULL, *bxyzs = NULL;
 /* ffc = form factor array for poisson solver */
 /* sct = sine/cosine table for FFT */
    float complex *ffc = NULL, *sct = NULL;
@@ -89,6 +102,16 @@ int main(int argc, char *argv[]) {
    bxyze = (float *) malloc(ndim*nxe*nye*sizeof(float));
    exyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
    bxyz = (float complex *) malloc(ndim*nxeh*nye*sizeof(float complex));
+   if (nsub > 1) {
+      exyza = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      bxyza = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      exyzt = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+      bxyzt = (float complex *) malloc(ndim*nxeh*nye
+                                       *sizeof(float complex));
+   }
    ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
    mixup = (int *) malloc(nxhy*sizeof(int));
    sct = (float complex *) malloc(nxyh*sizeof(float complex));
@@ -109,7 +132,7 @@ int main(int argc, char *argv[]) {
       bxyz[j] = 0.0 + 0.0*_Complex_I;
    }
 
-   if (dt > 0.45*ci) {
+   if (dt/(float) nsub > 0.45*ci) {
       printf("Warning: Courant condition may be exceeded!\n");
    }
 
@@ -178,12 +201,22 @@ L500: if (nloop <= ntime)
 /* calculate electromagnetic fields in fourier space with standard */
 /* procedure: updates exyz, bxyz, wf, wm                           */
       dtimer(&dtime,&itime,-1);
+      exyzs = exyz;
+      bxyzs = bxyz;
       if (ntime==0) {
          cibpois23((float complex *)cue,bxyz,ffc,ci,&wm,nx,ny,nxeh,nye,
                    nxh,nyh);
          wf = 0.0;
          dth = 0.5*dt;
       }
+/* subcycle maxwell solver: also updates exyza, bxyza */
+      else if (nsub > 1) {
+         csubmaxwel2(exyz,bxyz,exyza,bxyza,exyzt,bxyzt,
+                     (float complex *)cue,ffc,ci,dt,&wf,&wm,nx,ny,nxeh,
+                     nye,nxh,nyh,nsub);
+         exyzs = exyza;
+         bxyzs = bxyza;
+      }
       else {
          cmaxwel2(exyz,bxyz,(float complex *)cue,ffc,ci,dt,&wf,&wm,nx,ny,
                   nxeh,nye,nxh,nyh);
@@ -206,13 +239,13 @@ L500: if (nloop <= ntime)
 /* procedure: updates fxyze */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      cemfield2((float complex *)fxyze,exyz,ffc,isign,nx,ny,nxeh,nye,nxh,
-                nyh);
+      cemfield2((float complex *)fxyze,exyzs,ffc,isign,nx,ny,nxeh,nye,
+                nxh,nyh);
 
 /* copy magnetic field with standard procedure: updates bxyze */
       isign = -1;
-      cemfield2((float complex *)bxyze,bxyz,ffc,isign,nx,ny,nxeh,nye,nxh,
-                nyh);
+      cemfield2((float complex *)bxyze,bxyzs,ffc,isign,nx,ny,nxeh,nye,
+                nxh,nyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
@@ -273,6 +306,16 @@ L500: if (nloop <= ntime)
          }
       }
 
+/* energy diagnostic: updates etot0, edrift */
+      wt = we + wf + wm;
+      if (ntime==0) {
+         etot0 = wt + wke;
+      }
+      else if (etot0 != 0.0) {
+         wt = fabsf((wt + wke)/etot0 - 1.0);
+         edrift = wt > edrift ? wt : edrift;
+      }
+
       if (ntime==0) {
          wt = we + wf + wm;
          printf("Initial Total Field, Kinetic and Total Energies:\n");
@@ -287,13 +330,15 @@ L2000:
 
 /* * * * end main iteration loop * * * */
 
-   printf("ntime, relativity = %i,%i\n",ntime,relativity);
+   printf("ntime, relativity, nsub = %i,%i,%i\n",ntime,relativity,
+          nsub);
    wt = we + wf + wm;
    printf("Final Total Field, Kinetic and Total Energies:\n");
    printf("%e %e %e\n",wt,wke,wke+wt);
    printf("Final Electrostatic, Transverse Electric and Magnetic Field \
 Energies:\n");
    printf("%e %e %e\n",we,wf,wm);
+   printf("Maximum Relative Change in Total Energy = %e\n",edrift);
 
    printf("\n");
    printf("deposit time = %f\n",tdpost);
@@ -318,6 +363,8 @@ Energies:\n");
    printf("Deposit Time (nsec) = %f\n",tdpost*wt);
    printf("Sort Time (nsec) = %f\n",tsort*wt);
    printf("Total Particle Time (nsec) = %f\n",time*wt);
+   wt = time + tfield;
+   printf("Simulated Time per Second = %f\n",(float) nloop*dt/wt);
 
    return 0;
 }
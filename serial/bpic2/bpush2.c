@@ -2009,6 +2009,90 @@ local data                                                 */
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void csubmaxwel2(float complex exy[], float complex bxy[],
+                 float complex exya[], float complex bxya[],
+                 float complex exyt[], float complex bxyt[],
+                 float complex cu[], float complex ffc[], float ci,
+                 float dt, float *wf, float *wm, int nx, int ny,
+                 int nxvh, int nyv, int nxhd, int nyhd, int nsub) {
+/* this subroutine subcycles 2-1/2d maxwell's equation in fourier space,
+   advancing the transverse electric and magnetic fields nsub times with
+   time step dts = dt/nsub, using cmaxwel2, with the current held fixed.
+   the fields are averaged over a window of length dt centered on the
+   end of the step, so that the particles can be pushed with a time step
+   dt which does not resolve light waves
+   the window uses the fields at the last nh = nsub/2 subcycles of the
+   step, at the end of the step, and at nh further subcycles advanced
+   in a copy exyt/bxyt.  if nsub is even, the first and last of these
+   fields have half weight.
+   input: all, output: wf, wm, exy, bxy, exya, bxya, exyt, bxyt
+   exy/bxy = complex transverse electric/magnetic field at end of step
+   exya/bxya = complex transverse electric/magnetic field averaged over
+   the nsub subcycles centered on the end of step
+   exyt/bxyt = scratch complex transverse electric/magnetic field
+   cu = complex current density, ffc = form factor array
+   ci = reciprocal of velocity of light
+   dt = time interval between successive particle pushes
+   wf/wm = transverse electric/magnetic field energy at end of step
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+   nsub = number of field subcycles per particle time step, nsub >= 1
+local data                                                 */
+   int j, n, nh, nxyv;
+   float dts, anorm, wh, at1, wft, wmt;
+   nxyv = 3*nxvh*nyv;
+   nh = nsub/2;
+   dts = dt/(float) nsub;
+   anorm = 1.0/(float) nsub;
+/* weight of first and last fields in window */
+   wh = nsub==2*nh ? 0.5 : 1.0;
+   for (j = 0; j < nxyv; j++) {
+      exya[j] = 0.0;
+      bxya[j] = 0.0;
+   }
+/* advance fields to end of step, summing from half a step before end */
+   for (n = 0; n < nsub; n++) {
+      cmaxwel2(exy,bxy,cu,ffc,ci,dts,wf,wm,nx,ny,nxvh,nyv,nxhd,nyhd);
+      if ((n+nh) >= (nsub-1)) {
+         at1 = (n+nh)==(nsub-1) ? wh : 1.0;
+         for (j = 0; j < nxyv; j++) {
+            exya[j] += at1*exy[j];
+            bxya[j] += at1*bxy[j];
+         }
+      }
+   }
+/* advance copy of fields nh subcycles past end of step */
+   if (nh > 0) {
+      wft = *wf;
+      wmt = *wm;
+      for (j = 0; j < nxyv; j++) {
+         exyt[j] = exy[j];
+         bxyt[j] = bxy[j];
+      }
+      for (n = 0; n < nh; n++) {
+         cmaxwel2(exyt,bxyt,cu,ffc,ci,dts,wf,wm,nx,ny,nxvh,nyv,nxhd,
+                  nyhd);
+         at1 = n==(nh-1) ? wh : 1.0;
+         for (j = 0; j < nxyv; j++) {
+            exya[j] += at1*exyt[j];
+            bxya[j] += at1*bxyt[j];
+         }
+      }
+/* energies at end of step */
+      *wf = wft;
+      *wm = wmt;
+   }
+   for (j = 0; j < nxyv; j++) {
+      exya[j] *= anorm;
+      bxya[j] *= anorm;
+   }
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cemfield2(float complex fxy[], float complex exy[],
                float complex ffc[], int isign, int nx, int ny, int nxvh,
@@ -3030,6 +3114,19 @@ void cmaxwel2_(float complex *exy, float complex *bxy,
    return;
 }
 
+/*--------------------------------------------------------------------*/
+void csubmaxwel2_(float complex *exy, float complex *bxy,
+                  float complex *exya, float complex *bxya,
+                  float complex *exyt, float complex *bxyt,
+                  float complex *cu, float complex *ffc, float *ci,
+                  float *dt, float *wf, float *wm, int *nx, int *ny,
+                  int *nxvh, int *nyv, int *nxhd, int *nyhd,
+                  int *nsub) {
+   csubmaxwel2(exy,bxy,exya,bxya,exyt,bxyt,cu,ffc,*ci,*dt,wf,wm,*nx,*ny,
+               *nxvh,*nyv,*nxhd,*nyhd,*nsub);
+   return;
+}
+
 /*--------------------------------------------------------------------*/
 void cemfield2_(float complex *fxy, float complex *exy,
                 float complex *ffc, int *isign, int *nx, int *ny,
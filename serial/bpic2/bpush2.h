@@ -59,6 +59,13 @@ void cmaxwel2(float complex exy[], float complex bxy[],
               float dt, float *wf, float *wm, int nx, int ny, int nxvh,
               int nyv, int nxhd, int nyhd);
 
+void csubmaxwel2(float complex exy[], float complex bxy[],
+                 float complex exya[], float complex bxya[],
+                 float complex exyt[], float complex bxyt[],
+                 float complex cu[], float complex ffc[], float ci,
+                 float dt, float *wf, float *wm, int nx, int ny,
+                 int nxvh, int nyv, int nxhd, int nyhd, int nsub);
+
 void cemfield2(float complex fxy[], float complex exy[],
                float complex ffc[], int isign, int nx, int ny, int nxvh,
                int nyv, int nxhd, int nyhd);
@@ -37,10 +37,22 @@ int main(int argc, char *argv[]) {
    float omx = 0.4, omy = 0.0, omz = 0.0;
 /* ndc = number of corrections in darwin iteration */
    int ndc = 1;
+/* kadc = (0,1) = (fixed,adaptive) number of corrections, if adaptive */
+/* ndc is the maximum number of corrections                           */
+/* dctol = convergence tolerance for relative change in transverse    */
+/* electric field between corrections                                 */
+   int kadc = 0;
+   float dctol = 1.0e-3;
+/* kdcp = (0,1) = (no,yes) print number of darwin corrections and */
+/* final relative change in transverse field for each time step   */
+   int kdcp = 0;
 /* wke/we = particle kinetic/electrostatic field energy */
 /* wf/wm/wt = magnetic field/transverse electric field/total energy */
    float wke = 0.0, we = 0.0, wf = 0.0, wm = 0.0, wt = 0.0;
    float zero = 0.0;
+/* err = relative change in transverse electric field in last */
+/* correction, errs/errmx = sum/maximum of err over all time steps */
+   float err = 0.0, errs = 0.0, errmx = 0.0;
 /* declare scalars for standard code */
    int j, k;
    int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
@@ -57,6 +69,10 @@ int main(int argc, char *argv[]) {
 /* cus = transverse electric field with guard cells */
 /* amu = momentum flux with guard cells */
    float *cue = NULL, *dcu = NULL, *cus = NULL, *amu = NULL;
+/* cuso = transverse electric field from previous correction */
+   float *cuso = NULL;
+/* ndcs = number of time steps which needed k corrections */
+   int *ndcs = NULL;
 /* exyze = smoothed total electric field with guard cells */
 /* fxyze = smoothed longitudinal electric field with guard cells */
 /* bxyze = smoothed magnetic field with guard cells */
@@ -102,6 +118,12 @@ int main(int argc, char *argv[]) {
    cue = (float *) malloc(ndim*nxe*nye*sizeof(float));
    dcu = (float *) malloc(ndim*nxe*nye*sizeof(float));
    cus = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   if (kadc==1)
+      cuso = (float *) malloc(ndim*nxe*nye*sizeof(float));
+   ndcs = (int *) malloc((ndc+1)*sizeof(int));
+   for (k = 0; k <= ndc; k++) {
+      ndcs[k] = 0;
+   }
    amu = (float *) malloc(mdim*nxe*nye*sizeof(float));
    bxyze = (float *) malloc(ndim*nxe*nye*sizeof(float));
    ffc = (float complex *) malloc(nxh*nyh*sizeof(float complex));
@@ -346,6 +368,13 @@ L500: if (nloop <= ntime)
       tfield += time;
 
 /* inner iteration loop */
+/* save transverse electric field to monitor convergence */
+      if (kadc==1) {
+         for (j = 0; j < ndim*nxe*nye; j++) {
+            cuso[j] = cus[j];
+         }
+      }
+      err = 0.0;
       for (k = 0; k < ndc; k++) {
 
 /* deposit electron current and acceleration density and momentum flux */
@@ -476,6 +505,29 @@ L500: if (nloop <= ntime)
          time = (float) dtime;
          tfield += time;
 
+/* find relative change in transverse electric field: */
+/* updates cuso, err                                   */
+         if (kadc==1) {
+            dtimer(&dtime,&itime,-1);
+            cvrdiff2(cus,cuso,&err,ndim,nx,ny,nxe,nye);
+            dtimer(&dtime,&itime,1);
+            time = (float) dtime;
+            tfield += time;
+/* stop iteration early if converged */
+            if (err < dctol) {
+               k += 1;
+               break;
+            }
+         }
+
+      }
+/* k = number of corrections performed in this time step */
+      ndcs[k] += 1;
+      errs += err;
+      errmx = err > errmx ? err : errmx;
+      if (kdcp==1) {
+         printf("ntime=%i, darwin corrections=%i, relative change=%e\n",
+                ntime,k,err);
       }
 
 /* push particles with standard procedure: updates part, wke */
@@ -535,6 +587,15 @@ Energies:\n");
    printf("fft time = %f\n",tfft);
    printf("push time = %f\n",tpush);
    printf("sort time = %f\n",tsort);
+   printf("time steps with k darwin corrections, k = 0,%i:\n",ndc);
+   for (k = 0; k <= ndc; k++) {
+      printf(" %i",ndcs[k]);
+   }
+   printf("\n");
+   if (kadc==1) {
+      printf("average, maximum final relative change in transverse \
+electric field = %e %e\n",errs/(float) nloop,errmx);
+   }
    tfield += tguard + tfft;
    printf("total solver time = %f\n",tfield);
    time = tdpost + tpush + tsort;
@@ -0,0 +1,427 @@
+/* C Library for Skeleton 2D Electrostatic PIC Code field diagnostics */
+/* written by Viktor K. Decyk, UCLA */
+
+#include <complex.h>
+#include "field2.h"
+
+/*--------------------------------------------------------------------*/
+void cpotp2(float complex q[], float complex pot[], float complex ffc[],
+            float *we, int nx, int ny, int nxvh, int nyv, int nxhd,
+            int nyhd) {
+/* this subroutine solves 2d poisson's equation in fourier space for
+   potential with periodic boundary conditions.
+   input: q,ffc,nx,ny,nxvh,nyv,nxhd,nyhd, output: pot,we
+   approximate flop count is: 14*nxc*nyc + 8*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   pot[ky][kx] = g[ky][kx]*q[ky][kx]
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   g[ky][kx] = (affp/(kx**2+ky**2))*s[ky][kx],
+   s[ky][kx] = exp(-((kx*ax)**2+(ky*ay)**2)/2), except for
+   pot[ky][kx=pi] = 0, pot[ky=pi][kx] = 0, and pot[ky=0][kx=0] = 0.
+   q[k][j] = complex charge density for fourier mode (j,k)
+   pot[k][j] = complex potential for fourier mode (j,k)
+   creal(ffc[k][j]) = potential green's function g
+   cimag(ffc[k][j]) = finite-size particle shape factor s
+   for fourier mode (j,k)
+   electric field energy is also calculated, using
+   we = nx*ny*sum((affp/(kx**2+ky**2))*|q[ky][kx]*s[ky][kx]|**2)
+   where affp = normalization constant = nx*ny/np,
+   where np=number of particles
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+local data                                                            */
+   int nxh, nyh, j, k, k1, kk, kj;
+   float at1, at2;
+   float complex zero;
+   double wp;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   zero = 0.0 + 0.0*_Complex_I;
+/* calculate potential and sum field energy */
+   wp = 0.0;
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      for (j = 1; j < nxh; j++) {
+         at2 = crealf(ffc[j+kk]);
+         at1 = at2*cimagf(ffc[j+kk]);
+         pot[j+kj] = at2*q[j+kj];
+         pot[j+k1] = at2*q[j+k1];
+         wp += at1*(q[j+kj]*conjf(q[j+kj]) + q[j+k1]*conjf(q[j+k1]));
+      }
+   }
+/* mode numbers kx = 0, nx/2 */
+   for (k = 1; k < nyh; k++) {
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      at2 = crealf(ffc[kk]);
+      at1 = at2*cimagf(ffc[kk]);
+      pot[kj] = at2*q[kj];
+      pot[k1] = zero;
+      wp += at1*(q[kj]*conjf(q[kj]));
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = nxvh*nyh;
+   for (j = 1; j < nxh; j++) {
+      at2 = crealf(ffc[j]);
+      at1 = at2*cimagf(ffc[j]);
+      pot[j] = at2*q[j];
+      pot[j+k1] = zero;
+      wp += at1*(q[j]*conjf(q[j]));
+   }
+   pot[0] = zero;
+   pot[k1] = zero;
+   *we = wp*(float) (nx*ny);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cdivf2(float complex f[], float complex df[], int nx, int ny,
+            int nxvh, int nyv) {
+/* this subroutine calculates the divergence in fourier space
+   input: all except df, output: df
+   approximate flop count is: 16*nxc*nyc + 5*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   the divergence is calculated using the equation:
+   df[ky][kx] = sqrt(-1)*(kx*fx[ky][kx]+ky*fy[ky][kx])
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   except for df(kx=pi) = df(ky=pi) = df(kx=0,ky=0) = 0.
+   f[k][j][i] = i-th component of vector field for fourier mode (j,k),
+   with 2 components
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+local data                                                            */
+   int nxh, nyh, j, k, k1, kj;
+   float dnx, dny, dkx, dky;
+   float complex zero, zt1;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   dnx = 6.28318530717959/(float) nx;
+   dny = 6.28318530717959/(float) ny;
+   zero = 0.0 + 0.0*_Complex_I;
+/* calculate the divergence */
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      dky = dny*(float) k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      for (j = 1; j < nxh; j++) {
+         dkx = dnx*(float) j;
+         zt1 = dkx*f[2*(j+kj)] + dky*f[1+2*(j+kj)];
+         df[j+kj] = -cimagf(zt1) + crealf(zt1)*_Complex_I;
+         zt1 = dkx*f[2*(j+k1)] - dky*f[1+2*(j+k1)];
+         df[j+k1] = -cimagf(zt1) + crealf(zt1)*_Complex_I;
+      }
+   }
+/* mode numbers kx = 0, nx/2 */
+   for (k = 1; k < nyh; k++) {
+      dky = dny*(float) k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      zt1 = f[1+2*kj];
+      df[kj] = dky*(-cimagf(zt1) + crealf(zt1)*_Complex_I);
+      df[k1] = zero;
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = nxvh*nyh;
+   for (j = 1; j < nxh; j++) {
+      dkx = dnx*(float) j;
+      zt1 = f[2*j];
+      df[j] = dkx*(-cimagf(zt1) + crealf(zt1)*_Complex_I);
+      df[j+k1] = zero;
+   }
+   df[0] = zero;
+   df[k1] = zero;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cgradf2(float complex df[], float complex f[], int nx, int ny,
+             int nxvh, int nyv) {
+/* this subroutine calculates the gradient in fourier space
+   input: all except f, output: f
+   approximate flop count is: 12*nxc*nyc + 4*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   the gradient is calculated using the equations:
+   fx[ky][kx] = sqrt(-1)*kx*df[ky][kx]
+   fy[ky][kx] = sqrt(-1)*ky*df[ky][kx]
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   except for fx(kx=pi) = fy(kx=pi) = 0, fx(ky=pi) = fy(ky=pi) = 0,
+   and fx(kx=0,ky=0) = fy(kx=0,ky=0) = 0.
+   f[k][j][i] = i-th component of vector field for fourier mode (j,k),
+   with 2 components
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+local data                                                            */
+   int nxh, nyh, j, k, k1, kj;
+   float dnx, dny, dkx, dky;
+   float complex zero, zt1;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   dnx = 6.28318530717959/(float) nx;
+   dny = 6.28318530717959/(float) ny;
+   zero = 0.0 + 0.0*_Complex_I;
+/* calculate the gradient */
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      dky = dny*(float) k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      for (j = 1; j < nxh; j++) {
+         dkx = dnx*(float) j;
+         zt1 = -cimagf(df[j+kj]) + crealf(df[j+kj])*_Complex_I;
+         f[2*(j+kj)] = dkx*zt1;
+         f[1+2*(j+kj)] = dky*zt1;
+         zt1 = -cimagf(df[j+k1]) + crealf(df[j+k1])*_Complex_I;
+         f[2*(j+k1)] = dkx*zt1;
+         f[1+2*(j+k1)] = -dky*zt1;
+      }
+   }
+/* mode numbers kx = 0, nx/2 */
+   for (k = 1; k < nyh; k++) {
+      dky = dny*(float) k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      f[2*kj] = zero;
+      f[1+2*kj] = dky*(-cimagf(df[kj]) + crealf(df[kj])*_Complex_I);
+      f[2*k1] = zero;
+      f[1+2*k1] = zero;
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = nxvh*nyh;
+   for (j = 1; j < nxh; j++) {
+      dkx = dnx*(float) j;
+      f[2*j] = dkx*(-cimagf(df[j]) + crealf(df[j])*_Complex_I);
+      f[1+2*j] = zero;
+      f[2*(j+k1)] = zero;
+      f[1+2*(j+k1)] = zero;
+   }
+   f[0] = zero;
+   f[1] = zero;
+   f[2*k1] = zero;
+   f[1+2*k1] = zero;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void csmooth2(float complex q[], float complex qs[],
+              float complex ffc[], int nx, int ny, int nxvh, int nyv,
+              int nxhd, int nyhd) {
+/* this subroutine provides a 2d scalar smoothing function
+   in fourier space, with periodic boundary conditions.
+   input: q,ffc,nx,ny,nxvh,nyv,nxhd,nyhd, output: qs
+   approximate flop count is: 4*nxc*nyc + 2*(nxc + nyc)
+   where nxc = nx/2 - 1, nyc = ny/2 - 1
+   smoothing is calculated using the equation:
+   qs[ky][kx] = q[ky][kx]*s[ky][kx]
+   where kx = 2pi*j/nx, ky = 2pi*k/ny, and j,k = fourier mode numbers,
+   s[ky][kx] = exp(-((kx*ax)**2+(ky*ay)**2)/2), except for
+   qs[ky][kx=pi] = qs[ky=pi][kx] = 0, and qs[ky=0][kx=0] = 0.
+   q[k][j] = complex charge density
+   qs[k][j] = complex smoothed charge density
+   for fourier mode (j,k)
+   creal(ffc[k][j]) = potential green's function g
+   cimag(ffc[k][j]) = finite-size particle shape factor s
+   for fourier mode (j,k)
+   nx/ny = system length in x/y direction
+   nxvh = first dimension of field arrays, must be >= nxh
+   nyv = second dimension of field arrays, must be >= ny
+   nxhd = first dimension of form factor array, must be >= nxh
+   nyhd = second dimension of form factor array, must be >= nyh
+local data                                                            */
+   int nxh, nyh, j, k, k1, kk, kj;
+   float at1;
+   float complex zero;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   zero = 0.0 + 0.0*_Complex_I;
+/* calculate smoothing */
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < nyh; k++) {
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      for (j = 1; j < nxh; j++) {
+         at1 = cimagf(ffc[j+kk]);
+         qs[j+kj] = at1*q[j+kj];
+         qs[j+k1] = at1*q[j+k1];
+      }
+   }
+/* mode numbers kx = 0, nx/2 */
+   for (k = 1; k < nyh; k++) {
+      kk = nxhd*k;
+      kj = nxvh*k;
+      k1 = nxvh*ny - kj;
+      at1 = cimagf(ffc[kk]);
+      qs[kj] = at1*q[kj];
+      qs[k1] = zero;
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = nxvh*nyh;
+   for (j = 1; j < nxh; j++) {
+      at1 = cimagf(ffc[j]);
+      qs[j] = at1*q[j];
+      qs[j+k1] = zero;
+   }
+   qs[0] = cimagf(ffc[0])*crealf(q[0]);
+   qs[k1] = zero;
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void crdmodes2(float complex pot[], float complex pott[], int nx,
+               int ny, int modesx, int modesy, int nxvh, int nyv,
+               int modesxd, int modesyd) {
+/* this subroutine extracts lowest order modes from packed complex array
+   pot and stores them into a location in an unpacked complex array pott
+   modes stored: kx=(0,1,...,NX/2), ky=(0,+-1,+-2,...,+-(NY/2-1),NY/2)
+   nx/ny = system length in x/y direction
+   modesx/modesy = number of modes to store in x/y direction,
+   where modesx <= nx/2+1, modesy <= ny/2+1
+   nxvh = first dimension of input array pot, nxvh >= nx/2
+   nyv = second dimension of input array pot, nyv >= ny
+   modesxd = first dimension of output array pott, modesxd >= modesx
+   modesyd = second dimension of output array pott,
+   where modesyd >= min(2*modesy-1,ny)
+local data                                                            */
+   int nxh, nyh, jmax, kmax, j, k, j1, k1, kk, jk;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   if ((modesx <= 0) || (modesx > (nxh+1)))
+      return;
+   if ((modesy <= 0) || (modesy > (nyh+1)))
+      return;
+   jmax = modesx < nxh ? modesx : nxh;
+   kmax = modesy < nyh ? modesy : nyh;
+   j1 = nxh;
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < kmax; k++) {
+      kk = nxvh*k;
+      k1 = nxvh*ny - kk;
+      jk = modesxd*(2*k - 1);
+      for (j = 1; j < jmax; j++) {
+         pott[j+jk] = pot[j+kk];
+         pott[j+jk+modesxd] = pot[j+k1];
+      }
+/* mode numbers kx = 0, nx/2 */
+      pott[jk] = pot[kk];
+      pott[jk+modesxd] = conjf(pot[kk]);
+      if (modesx > nxh) {
+         pott[j1+jk] = conjf(pot[k1]);
+         pott[j1+jk+modesxd] = pot[k1];
+      }
+   }
+/* mode numbers ky = 0, ny/2 */
+   for (j = 1; j < jmax; j++) {
+      pott[j] = pot[j];
+   }
+   pott[0] = crealf(pot[0]);
+   if (modesx > nxh) {
+      pott[j1] = cimagf(pot[0]);
+   }
+   if (modesy > nyh) {
+      k1 = nxvh*nyh;
+      jk = modesxd*(ny - 1);
+      for (j = 1; j < jmax; j++) {
+         pott[j+jk] = pot[j+k1];
+      }
+      pott[jk] = crealf(pot[k1]);
+      if (modesx > nxh) {
+         pott[j1+jk] = cimagf(pot[k1]);
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwrmodes2(float complex pot[], float complex pott[], int nx,
+               int ny, int modesx, int modesy, int nxvh, int nyv,
+               int modesxd, int modesyd) {
+/* this subroutine extracts lowest order modes from a location in an
+   unpacked complex array pott and stores them into a packed complex
+   array pot
+   modes stored: kx=(0,1,...,NX/2), ky=(0,+-1,+-2,...,+-(NY/2-1),NY/2)
+   nx/ny = system length in x/y direction
+   modesx/modesy = number of modes to store in x/y direction,
+   where modesx <= nx/2+1, modesy <= ny/2+1
+   nxvh = first dimension of input array pot, nxvh >= nx/2
+   nyv = second dimension of input array pot, nyv >= ny
+   modesxd = first dimension of output array pott, modesxd >= modesx
+   modesyd = second dimension of output array pott,
+   where modesyd >= min(2*modesy-1,ny)
+local data                                                            */
+   int nxh, nyh, jmax, kmax, j, k, j1, k1, kk, jk;
+   float complex zero;
+   nxh = nx/2;
+   nyh = 1 > ny/2 ? 1 : ny/2;
+   if ((modesx <= 0) || (modesx > (nxh+1)))
+      return;
+   if ((modesy <= 0) || (modesy > (nyh+1)))
+      return;
+   jmax = modesx < nxh ? modesx : nxh;
+   kmax = modesy < nyh ? modesy : nyh;
+   j1 = nxh;
+   zero = 0.0 + 0.0*_Complex_I;
+/* mode numbers 0 < kx < nx/2 and 0 < ky < ny/2 */
+   for (k = 1; k < kmax; k++) {
+      kk = nxvh*k;
+      k1 = nxvh*ny - kk;
+      jk = modesxd*(2*k - 1);
+      for (j = 1; j < jmax; j++) {
+         pot[j+kk] = pott[j+jk];
+         pot[j+k1] = pott[j+jk+modesxd];
+      }
+      for (j = jmax; j < nxh; j++) {
+         pot[j+kk] = zero;
+         pot[j+k1] = zero;
+      }
+/* mode numbers kx = 0, nx/2 */
+      pot[kk] = pott[jk];
+      pot[k1] = zero;
+      if (modesx > nxh) {
+         pot[k1] = conjf(pott[j1+jk]);
+      }
+   }
+   for (k = kmax; k < nyh; k++) {
+      kk = nxvh*k;
+      k1 = nxvh*ny - kk;
+      for (j = 0; j < nxh; j++) {
+         pot[j+kk] = zero;
+         pot[j+k1] = zero;
+      }
+   }
+/* mode numbers ky = 0, ny/2 */
+   k1 = nxvh*nyh;
+   for (j = 1; j < jmax; j++) {
+      pot[j] = pott[j];
+      pot[j+k1] = zero;
+   }
+   for (j = jmax; j < nxh; j++) {
+      pot[j] = zero;
+      pot[j+k1] = zero;
+   }
+   pot[0] = crealf(pott[0]);
+   pot[k1] = zero;
+   if (modesx > nxh) {
+      pot[0] = crealf(pot[0]) + crealf(pott[j1])*_Complex_I;
+   }
+   if (modesy > nyh) {
+      jk = modesxd*(ny - 1);
+      for (j = 1; j < jmax; j++) {
+         pot[j+k1] = pott[j+jk];
+      }
+      pot[k1] = crealf(pott[jk]);
+      if (modesx > nxh) {
+         pot[k1] = crealf(pot[k1]) + crealf(pott[j1+jk])*_Complex_I;
+      }
+   }
+   return;
+}
@@ -0,0 +1,222 @@
+/* C Library for streaming fourier mode diagnostics from Skeleton PIC */
+/* codes to an append-only binary file.  the file has a header which  */
+/* records the grid and mode array sizes, followed by self-describing */
+/* records with a name, time step and length.  records are copied to  */
+/* one of two buffers, while a helper thread writes the other buffer, */
+/* so that the main loop never waits for the disk.                    */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <complex.h>
+#include <pthread.h>
+#include "modeio.h"
+
+#define MODEVERSION     1
+
+/* identifies mode files */
+static char magic[8] = "PICMODE";
+
+/* output file, kopen = 1 if opened */
+static FILE *fmode = NULL;
+static int kopen = 0;
+/* double buffer: records are added to fill buffer, while helper */
+/* thread writes the other buffer, sizes in bytes                */
+static char *cbuf[2] = {NULL,NULL};
+static size_t nbuf[2] = {0,0}, mbuf[2] = {0,0};
+static int kfill = 0;
+/* helper thread and its synchronization, kdone = 1 when closing, */
+/* kerr = 1 if a write failed                                     */
+static pthread_t thread;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ready = PTHREAD_COND_INITIALIZER;
+static int kthr = 0, kdone = 0, kerr = 0;
+
+/*--------------------------------------------------------------------*/
+static int cmodebuf(int kb, void *f, size_t nbytes) {
+/* appends nbytes from f to buffer kb, enlarging it as needed.
+   returns 0 if successful, otherwise 1
+local data                                                            */
+   size_t nn;
+   char *tbuf;
+   if (nbuf[kb]+nbytes > mbuf[kb]) {
+      nn = 2*mbuf[kb] > nbuf[kb]+nbytes ? 2*mbuf[kb] : nbuf[kb]+nbytes;
+      tbuf = (char *) realloc(cbuf[kb],nn);
+      if (tbuf==NULL)
+         return 1;
+      cbuf[kb] = tbuf;
+      mbuf[kb] = nn;
+   }
+   memcpy(&cbuf[kb][nbuf[kb]],f,nbytes);
+   nbuf[kb] += nbytes;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+static int cmodeflush(int kb) {
+/* writes buffer kb to the file and empties it.
+   returns 0 if successful, otherwise 1
+local data                                                            */
+   int ierr = 0;
+   if (nbuf[kb] > 0) {
+      if (fwrite(cbuf[kb],1,nbuf[kb],fmode) != nbuf[kb])
+         ierr = 1;
+      if (fflush(fmode) != 0)
+         ierr = 1;
+   }
+   nbuf[kb] = 0;
+   return ierr;
+}
+
+/*--------------------------------------------------------------------*/
+static void *cmodethread(void *arg) {
+/* helper thread: waits for records in the fill buffer, swaps buffers
+   and writes the full one without holding the lock
+local data                                                            */
+   int kb, ierr;
+   pthread_mutex_lock(&lock);
+   while (1) {
+      while ((nbuf[kfill]==0) && (kdone==0)) {
+         pthread_cond_wait(&ready,&lock);
+      }
+      if (nbuf[kfill]==0)
+         break;
+      kb = kfill;
+      kfill = 1 - kfill;
+      pthread_mutex_unlock(&lock);
+      ierr = cmodeflush(kb);
+      pthread_mutex_lock(&lock);
+      if (ierr)
+         kerr = 1;
+   }
+   pthread_mutex_unlock(&lock);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+int cmodeopen(char *fname, int nx, int ny, int modesxd, int modesyd,
+              float dt) {
+/* this subroutine opens a file for fourier mode records and starts the
+   helper thread.  if the file already exists, its header must agree
+   with the arguments, and new records are appended, otherwise the
+   header is written.
+   returns 0 if successful, otherwise 1.
+   fname = name of file
+   nx/ny = system length in x/y direction
+   modesxd/modesyd = dimensions of unpacked mode arrays
+   dt = time interval between successive calculations
+local data                                                            */
+   int ihead[5], jhead[5];
+   float rhead, shead;
+   char cmag[8];
+   long nsize;
+   kopen = 0;
+   kdone = 0;
+   kerr = 0;
+   kfill = 0;
+   nbuf[0] = 0;
+   nbuf[1] = 0;
+   ihead[0] = MODEVERSION;
+   ihead[1] = nx;
+   ihead[2] = ny;
+   ihead[3] = modesxd;
+   ihead[4] = modesyd;
+   rhead = dt;
+   fmode = fopen(fname,"ab+");
+   if (fmode==NULL)
+      return 1;
+   fseek(fmode,0L,SEEK_END);
+   nsize = ftell(fmode);
+/* new file: write header */
+   if (nsize==0) {
+      if ((fwrite(magic,1,sizeof(magic),fmode) != sizeof(magic))
+         || (fwrite(ihead,sizeof(int),5,fmode) != 5)
+         || (fwrite(&rhead,sizeof(float),1,fmode) != 1))
+         goto L10;
+      if (fflush(fmode) != 0)
+         goto L10;
+   }
+/* existing file: check header */
+   else {
+      rewind(fmode);
+      if ((fread(cmag,1,sizeof(cmag),fmode) != sizeof(cmag))
+         || (memcmp(cmag,magic,sizeof(magic)) != 0))
+         goto L10;
+      if ((fread(jhead,sizeof(int),5,fmode) != 5)
+         || (fread(&shead,sizeof(float),1,fmode) != 1))
+         goto L10;
+      if ((memcmp(ihead,jhead,sizeof(ihead)) != 0) || (rhead != shead))
+         goto L10;
+      fseek(fmode,0L,SEEK_END);
+   }
+   kthr = pthread_create(&thread,NULL,cmodethread,NULL)==0;
+   kopen = 1;
+   return 0;
+L10: fclose(fmode);
+   fmode = NULL;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+int cmodeput(char *name, int ntime, float complex f[], int nf) {
+/* this subroutine copies a record of fourier modes to the fill buffer
+   and wakes the helper thread.  the array f may be modified as soon as
+   this returns.
+   returns 0 if successful, otherwise 1.
+   name = name of record, at most 8 characters
+   ntime = current time step
+   f = complex array of modes, such as from crdmodes2
+   nf = number of elements in f
+local data                                                            */
+   int j, ierr;
+   int irec[2];
+   char cname[8];
+   if (kopen==0)
+      return 1;
+   memset(cname,0,sizeof(cname));
+   for (j = 0; (j < sizeof(cname)) && (name[j] != '\0'); j++) {
+      cname[j] = name[j];
+   }
+   irec[0] = ntime;
+   irec[1] = nf;
+   pthread_mutex_lock(&lock);
+   ierr = cmodebuf(kfill,cname,sizeof(cname))
+       || cmodebuf(kfill,irec,sizeof(irec))
+       || cmodebuf(kfill,f,nf*sizeof(float complex));
+   if (kthr)
+      pthread_cond_signal(&ready);
+/* write without helper thread */
+   else if (cmodeflush(kfill))
+      kerr = 1;
+   pthread_mutex_unlock(&lock);
+   return ierr;
+}
+
+/*--------------------------------------------------------------------*/
+int cmodeclose() {
+/* this subroutine waits for the helper thread to write the remaining
+   records and closes the file.
+   returns 0 if all records were written, otherwise 1.
+local data                                                            */
+   int kb;
+   if (kopen==0)
+      return 0;
+   kopen = 0;
+   if (kthr) {
+      pthread_mutex_lock(&lock);
+      kdone = 1;
+      pthread_cond_signal(&ready);
+      pthread_mutex_unlock(&lock);
+      pthread_join(thread,NULL);
+      kthr = 0;
+   }
+   if (fclose(fmode) != 0)
+      kerr = 1;
+   fmode = NULL;
+   for (kb = 0; kb < 2; kb++) {
+      free(cbuf[kb]);
+      cbuf[kb] = NULL;
+      mbuf[kb] = 0;
+   }
+   return kerr;
+}
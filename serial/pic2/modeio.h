@@ -0,0 +1,8 @@
+/* header file for modeio.c */
+
+int cmodeopen(char *fname, int nx, int ny, int modesxd, int modesyd,
+              float dt);
+
+int cmodeput(char *name, int ntime, float complex f[], int nf);
+
+int cmodeclose();
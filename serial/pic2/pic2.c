@@ -6,6 +6,9 @@
 #include <complex.h>
 #include <sys/time.h>
 #include "push2.h"
+#include "perflog.h"
+#include "modeio.h"
+#include "extras2/field2.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -13,6 +16,11 @@ int main(int argc, char *argv[]) {
 /* indx/indy = exponent which determines grid points in x/y direction: */
 /* nx = 2**indx, ny = 2**indy */
    int indx =   9, indy =   9;
+/* nxn/nyn = number of grid points in x/y direction, if nonzero, used */
+/* instead of 2**indx/2**indy, with a mixed radix fft.  nxn must be a */
+/* multiple of 4 and nyn a multiple of 2, with no prime factors other */
+/* than 2, 3 and 5, e.g., nxn = 384 */
+   int nxn = 0, nyn = 0;
 /* npx/npy = number of electrons distributed in x/y direction */
    int npx =  3072, npy =   3072;
 /* ndim = number of velocity coordinates = 2 */
@@ -30,12 +38,27 @@ int main(int argc, char *argv[]) {
 /* ipbc = particle boundary condition: 1 = periodic */
 /* sortime = number of time steps between standard electron sorting */
    int idimp = 4, ipbc = 1, sortime = 50;
+/* kperf = (0,1,2) = write timings for each time step to perffile as */
+/* (none, CSV, JSON lines)                                           */
+/* nperf = print summary of timings every nperf time steps, 0 = never */
+   int kperf = 0, nperf = 0;
+   char *perffile = "pic2_perf";
+/* ntp/ntde = number of time steps between potential/density */
+/* diagnostics, 0 = none                                      */
+/* modesx/modesy = number of fourier modes in x/y written by */
+/* diagnostics, appended to modefile                         */
+   int ntp = 0, ntde = 0, modesx = 41, modesy = 41;
+   char *modefile = "pic2_modes";
 /* wke/we/wt = particle kinetic/electric field/total energy */
    float wke = 0.0, we = 0.0, wt = 0.0;
+/* wp = field energy returned by potential diagnostic */
+   float wp = 0.0;
 /* declare scalars for standard code */
    int j;
    int np, nx, ny, nxh, nyh, nxe, nye, nxeh, nxyh, nxhy;
-   int ny1, ntime, nloop, isign;
+   int ny1, ntime, nloop, isign, kfftn;
+   int nfac[32];
+   int modesxd, modesyd;
    float qbme, affp;
 
 /* declare arrays for standard code: */
@@ -53,25 +76,50 @@ int main(int argc, char *argv[]) {
    float complex *sct = NULL;
 /* npicy = scratch array for reordering particles */
    int *npicy = NULL;
+/* potc = potential in fourier space for diagnostics */
+   float complex *potc = NULL;
+/* pott/dent = unpacked fourier modes of potential/density */
+   float complex *pott = NULL, *dent = NULL;
   
 /* declare and initialize timing data */
    float time;
    struct timeval itime;
    float tdpost = 0.0, tguard = 0.0, tfft = 0.0, tfield = 0.0;
-   float tpush = 0.0, tsort = 0.0;
+   float tpush = 0.0, tsort = 0.0, tdiag = 0.0;
    double dtime;
+/* timed phases written by cperfstep */
+   char *phnames[6] = {"deposit","guard","fft","field","push","sort"};
+   double tperf[6];
 
 /* initialize scalars for standard code */
 /* np = total number of particles in simulation */
 /* nx/ny = number of grid points in x/y direction */
    np = npx*npy; nx = 1L<<indx; ny = 1L<<indy;
+   if (nxn > 0) nx = nxn;
+   if (nyn > 0) ny = nyn;
    nxh = nx/2; nyh = 1 > ny/2 ? 1 : ny/2;
    nxe = nx + 2; nye = ny + 1; nxeh = nxe/2;
    nxyh = (nx > ny ? nx : ny)/2; nxhy = nxh > ny ? nxh : ny;
+/* kfftn = (0,1) = use (radix-2, mixed radix) fft */
+   kfftn = (nxn > 0) || (nyn > 0);
+   if (kfftn) {
+      if (((nx%4) != 0) || ((ny%2) != 0) || (cfft1nfac(nxh,nfac)==0)
+         || (cfft1nfac(ny,nfac)==0)) {
+         printf("nx=%d, ny=%d not supported by mixed radix fft\n",nx,ny);
+         exit(1);
+      }
+/* mixed radix fft tables have separate x and y parts */
+      nxyh = nxh + ny/2; nxhy = nxh + ny;
+   }
    ny1 = ny + 1;
 /* nloop = number of time steps in simulation */
 /* ntime = current time step */
    nloop = tend/dt + .0001; ntime = 0;
+/* modesxd/modesyd = dimensions of unpacked fourier mode arrays */
+   modesx = modesx < nxh+1 ? modesx : nxh+1;
+   modesy = modesy < nyh+1 ? modesy : nyh+1;
+   modesxd = modesx; modesyd = 2*modesy - 1;
+   modesyd = modesyd < ny ? modesyd : ny;
    qbme = qme;
    affp = (float) (nx*ny)/(float ) np;
 
@@ -85,9 +133,20 @@ int main(int argc, char *argv[]) {
    mixup = (int *) malloc(nxhy*sizeof(int));
    sct = (float complex *) malloc(nxyh*sizeof(float complex));
    npicy = (int *) malloc(ny1*sizeof(int));
+   if (ntp > 0) {
+      potc = (float complex *) malloc(nxeh*nye*sizeof(float complex));
+      pott = (float complex *) malloc(modesxd*modesyd
+                                      *sizeof(float complex));
+   }
+   if (ntde > 0)
+      dent = (float complex *) malloc(modesxd*modesyd
+                                      *sizeof(float complex));
 
 /* prepare fft tables */
-   cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
+   if (kfftn)
+      cwfft2rninit(mixup,sct,nx,ny,nxhy,nxyh);
+   else
+      cwfft2rinit(mixup,sct,indx,indy,nxhy,nxyh);
 /* calculate form factors */
    isign = 0;
    cpois22((float complex *)qe,(float complex *)fxye,isign,ffc,ax,ay,affp,
@@ -95,10 +154,31 @@ int main(int argc, char *argv[]) {
 /* initialize electrons */
    cdistr2(part,vtx,vty,vx0,vy0,npx,npy,idimp,np,nx,ny,ipbc);
 
+/* open file for timings */
+   if ((kperf > 0) || (nperf > 0)) {
+      if (cperfopen(perffile,kperf,nperf,6,phnames,0,NULL) != 0) {
+         printf("cperfopen error: kperf, perffile=%d,%s\n",kperf,
+                perffile);
+         exit(1);
+      }
+   }
+
+/* open file for fourier mode diagnostics */
+   if ((ntp > 0) || (ntde > 0)) {
+      if (cmodeopen(modefile,nx,ny,modesxd,modesyd,dt) != 0) {
+         printf("cmodeopen error: modefile=%s\n",modefile);
+         exit(1);
+      }
+   }
+
 /* * * * start main iteration loop * * * */
  
 L500: if (nloop <= ntime)
          goto L2000;
+/* phase times for this time step, written by cperfstep */
+      for (j = 0; j < 6; j++) {
+         tperf[j] = 0.0;
+      }
 /*    printf("ntime = %i\n",ntime); */
  
 /* deposit charge with standard procedure: updates qe */
@@ -110,6 +190,7 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdpost += time;
+      tperf[0] += dtime;
 
 /* add guard cells with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
@@ -117,15 +198,47 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* transform charge to fourier space with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
       isign = -1;
-      cwfft2rx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,nye,
-               nxhy,nxyh);
+      if (kfftn)
+         cwfft2rnx((float complex *)qe,isign,mixup,sct,nx,ny,nxeh,nye,
+                   nxhy,nxyh);
+      else
+         cwfft2rx((float complex *)qe,isign,mixup,sct,indx,indy,nxeh,
+                  nye,nxhy,nxyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
+      tperf[2] += dtime;
+
+/* fourier mode diagnostics: records are written by helper thread */
+      if ((ntp > 0) || (ntde > 0)) {
+         dtimer(&dtime,&itime,-1);
+/* unpack density modes into dent */
+         if (ntde > 0) {
+            if (ntime%ntde==0) {
+               crdmodes2((float complex *)qe,dent,nx,ny,modesx,modesy,
+                         nxeh,nye,modesxd,modesyd);
+               cmodeput("den",ntime,dent,modesxd*modesyd);
+            }
+         }
+/* calculate potential and unpack modes into pott: updates potc, wp */
+         if (ntp > 0) {
+            if (ntime%ntp==0) {
+               cpotp2((float complex *)qe,potc,ffc,&wp,nx,ny,nxeh,nye,
+                      nxh,nyh);
+               crdmodes2(potc,pott,nx,ny,modesx,modesy,nxeh,nye,modesxd,
+                         modesyd);
+               cmodeput("pot",ntime,pott,modesxd*modesyd);
+            }
+         }
+         dtimer(&dtime,&itime,1);
+         time = (float) dtime;
+         tdiag += time;
+      }
 
 /* calculate force/charge in fourier space with standard procedure: */
 /* updates fxye, we                                                 */
@@ -136,15 +249,21 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
+      tperf[3] += dtime;
 
 /* transform force to real space with standard procedure: updates fxye */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      cwfft2r2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,nye,
-               nxhy,nxyh);
+      if (kfftn)
+         cwfft2rn2((float complex *)fxye,isign,mixup,sct,nx,ny,nxeh,nye,
+                   nxhy,nxyh);
+      else
+         cwfft2r2((float complex *)fxye,isign,mixup,sct,indx,indy,nxeh,
+                  nye,nxhy,nxyh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
+      tperf[2] += dtime;
 
 /* copy guard cells with standard procedure: updates fxye */
       dtimer(&dtime,&itime,-1);
@@ -152,6 +271,7 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
+      tperf[1] += dtime;
 
 /* push particles with standard procedure: updates part, wke */
       wke = 0.0;
@@ -160,6 +280,7 @@ L500: if (nloop <= ntime)
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
+      tperf[4] += dtime;
 
 /* sort particles by cell for standard procedure */
       if (sortime > 0) {
@@ -173,9 +294,15 @@ L500: if (nloop <= ntime)
             dtimer(&dtime,&itime,1);
             time = (float) dtime;
             tsort += time;
+            tperf[5] += dtime;
          }
       }
 
+/* record timings for this time step */
+      if ((kperf > 0) || (nperf > 0)) {
+         cperfstep(ntime,tperf,NULL);
+      }
+
       if (ntime==0) {
          printf("Initial Field, Kinetic and Total Energies:\n");
          printf("%e %e %e\n",we,wke,wke+we);
@@ -186,6 +313,12 @@ L2000:
 
 /* * * * end main iteration loop * * * */
 
+   if ((kperf > 0) || (nperf > 0))
+      cperfclose();
+   if ((ntp > 0) || (ntde > 0)) {
+      if (cmodeclose() != 0)
+         printf("cmodeclose error: modefile=%s\n",modefile);
+   }
    printf("ntime = %i\n",ntime);
    printf("Final Field, Kinetic and Total Energies:\n");
    printf("%e %e %e\n",we,wke,wke+we);
@@ -197,6 +330,8 @@ L2000:
    printf("fft time = %f\n",tfft);
    printf("push time = %f\n",tpush);
    printf("sort time = %f\n",tsort);
+   if ((ntp > 0) || (ntde > 0))
+      printf("diagnostic time = %f\n",tdiag);
    tfield += tguard + tfft;
    printf("total solver time = %f\n",tfield);
    time = tdpost + tpush + tsort;
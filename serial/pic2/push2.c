@@ -1494,6 +1494,715 @@ void cwfft2r2(float complex f[], int isign, int mixup[],
    return;
 }
 
+/*--------------------------------------------------------------------*/
+int cfft1nfac(int n, int nfac[]) {
+/* this subroutine finds the factors used by the mixed radix ffts, in
+   the order in which the transform stages are performed: factors of 4
+   first, then 2, 3 and 5.  returns the number of factors, or 0 if n
+   has prime factors other than 2, 3 and 5
+   n = length of transform
+   nfac = array of factors, must be dimensioned >= 32
+local data                                                            */
+   int m, nf;
+   if (n < 1)
+      return 0;
+   m = n;
+   nf = 0;
+   while ((m%4)==0) {
+      nfac[nf++] = 4;
+      m = m/4;
+   }
+   if ((m%2)==0) {
+      nfac[nf++] = 2;
+      m = m/2;
+   }
+   while ((m%3)==0) {
+      nfac[nf++] = 3;
+      m = m/3;
+   }
+   while ((m%5)==0) {
+      nfac[nf++] = 5;
+      m = m/5;
+   }
+   if (m != 1)
+      return 0;
+   return nf;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft1rnx(float complex f[], float complex g[], int isign,
+              int mixup[], float complex sct[], int n, int nrs, int ld,
+              int lb, int nb) {
+/* this subroutine performs nb complex fast fourier transforms of
+   length n, where n has no prime factors other than 2, 3 and 5, using
+   a mixed radix (2,3,4,5) decimation in time algorithm.  the data are
+   copied in digit reversed order to the scratch array g, where element
+   m of transform i is stored in g[i+nb*m], so that the innermost loop
+   is over the transforms, transformed, and copied back to f.
+   the data are not normalized.
+   for isign = (-1,1), input: all, output: f
+   if isign = -1, f[m*ld+i*lb] = sum(f[k*ld+i*lb]*exp(-sqrt(-1)*2pi*m*k/n))
+   if isign = 1, f[m*ld+i*lb] = sum(f[k*ld+i*lb]*exp(sqrt(-1)*2pi*m*k/n))
+   where 0 <= i < nb
+   g = scratch array, must be dimensioned >= n*nb
+   mixup = array of digit reversed addresses for n
+   sct = sine/cosine table, sct[j] = exp(-sqrt(-1)*2pi*j/(n*nrs)),
+   for 0 <= j < n*nrs/2
+   nrs = ratio of length of period of sct table to n, n*nrs must be even
+   ld = distance between successive elements of a transform in f
+   lb = distance between successive transforms in f
+   nb = number of transforms
+local data                                                            */
+   int nf, nl, ns, nr, km, kmr, k, j, l, m, i, e, p, k0, nh;
+   int nfac[32];
+   float sg, c1, c2, s1, s2;
+   float wr[4], wi[4];
+   float a0r, a0i, a1r, a1i, a2r, a2i, a3r, a3i, a4r, a4i;
+   float t1r, t1i, t2r, t2i, t3r, t3i, t4r, t4i, tr, ti;
+   float *gr;
+   gr = (float *) g;
+   nf = cfft1nfac(n,nfac);
+   nh = (n*nrs)/2;
+   sg = isign < 0 ? 1.0f : -1.0f;
+/* copy array elements in digit reversed order */
+   for (m = 0; m < n; m++) {
+      j = mixup[m] - 1;
+      for (i = 0; i < nb; i++) {
+         g[i+nb*m] = f[ld*j+lb*i];
+      }
+   }
+/* perform one stage for each factor */
+   ns = 1;
+   for (l = 0; l < nf; l++) {
+      nr = nfac[l];
+      nl = ns*nr;
+      km = n/nl;
+      kmr = km*nrs;
+      for (k = 0; k < km; k++) {
+         k0 = nl*k;
+         for (j = 0; j < ns; j++) {
+/* find twiddle factors exp(-sqrt(-1)*2pi*p*j/nl), 0 < p < nr */
+            for (p = 1; p < nr; p++) {
+               e = kmr*p*j;
+               if (e < nh) {
+                  wr[p-1] = crealf(sct[e]);
+                  wi[p-1] = sg*cimagf(sct[e]);
+               }
+               else {
+                  wr[p-1] = -crealf(sct[e-nh]);
+                  wi[p-1] = -sg*cimagf(sct[e-nh]);
+               }
+            }
+            m = 2*nb*(j + k0);
+            e = 2*nb*ns;
+/* radix 2 butterfly */
+            if (nr==2) {
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  gr[i+m] = a0r + a1r;
+                  gr[i+1+m] = a0i + a1i;
+                  gr[i+m+e] = a0r - a1r;
+                  gr[i+1+m+e] = a0i - a1i;
+               }
+            }
+/* radix 4 butterfly */
+            else if (nr==4) {
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  a3r = wr[2]*gr[i+m+3*e] - wi[2]*gr[i+1+m+3*e];
+                  a3i = wr[2]*gr[i+1+m+3*e] + wi[2]*gr[i+m+3*e];
+                  t1r = a0r + a2r;
+                  t1i = a0i + a2i;
+                  t2r = a0r - a2r;
+                  t2i = a0i - a2i;
+                  t3r = a1r + a3r;
+                  t3i = a1i + a3i;
+                  t4r = sg*(a1r - a3r);
+                  t4i = sg*(a1i - a3i);
+                  gr[i+m] = t1r + t3r;
+                  gr[i+1+m] = t1i + t3i;
+                  gr[i+m+e] = t2r + t4i;
+                  gr[i+1+m+e] = t2i - t4r;
+                  gr[i+m+2*e] = t1r - t3r;
+                  gr[i+1+m+2*e] = t1i - t3i;
+                  gr[i+m+3*e] = t2r - t4i;
+                  gr[i+1+m+3*e] = t2i + t4r;
+               }
+            }
+/* radix 3 butterfly */
+            else if (nr==3) {
+               s1 = sg*0.866025403784439;
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  t1r = a1r + a2r;
+                  t1i = a1i + a2i;
+                  t2r = s1*(a1r - a2r);
+                  t2i = s1*(a1i - a2i);
+                  tr = a0r - 0.5f*t1r;
+                  ti = a0i - 0.5f*t1i;
+                  gr[i+m] = a0r + t1r;
+                  gr[i+1+m] = a0i + t1i;
+                  gr[i+m+e] = tr + t2i;
+                  gr[i+1+m+e] = ti - t2r;
+                  gr[i+m+2*e] = tr - t2i;
+                  gr[i+1+m+2*e] = ti + t2r;
+               }
+            }
+/* radix 5 butterfly */
+            else {
+               c1 = 0.309016994374947;
+               c2 = -0.809016994374947;
+               s1 = sg*0.951056516295154;
+               s2 = sg*0.587785252292473;
+               for (i = 0; i < 2*nb; i += 2) {
+                  a0r = gr[i+m];
+                  a0i = gr[i+1+m];
+                  a1r = wr[0]*gr[i+m+e] - wi[0]*gr[i+1+m+e];
+                  a1i = wr[0]*gr[i+1+m+e] + wi[0]*gr[i+m+e];
+                  a2r = wr[1]*gr[i+m+2*e] - wi[1]*gr[i+1+m+2*e];
+                  a2i = wr[1]*gr[i+1+m+2*e] + wi[1]*gr[i+m+2*e];
+                  a3r = wr[2]*gr[i+m+3*e] - wi[2]*gr[i+1+m+3*e];
+                  a3i = wr[2]*gr[i+1+m+3*e] + wi[2]*gr[i+m+3*e];
+                  a4r = wr[3]*gr[i+m+4*e] - wi[3]*gr[i+1+m+4*e];
+                  a4i = wr[3]*gr[i+1+m+4*e] + wi[3]*gr[i+m+4*e];
+                  t1r = a1r + a4r;
+                  t1i = a1i + a4i;
+                  t2r = a2r + a3r;
+                  t2i = a2i + a3i;
+                  t3r = a1r - a4r;
+                  t3i = a1i - a4i;
+                  t4r = a2r - a3r;
+                  t4i = a2i - a3i;
+                  gr[i+m] = a0r + t1r + t2r;
+                  gr[i+1+m] = a0i + t1i + t2i;
+                  tr = a0r + c1*t1r + c2*t2r;
+                  ti = a0i + c1*t1i + c2*t2i;
+                  a1r = s1*t3r + s2*t4r;
+                  a1i = s1*t3i + s2*t4i;
+                  gr[i+m+e] = tr + a1i;
+                  gr[i+1+m+e] = ti - a1r;
+                  gr[i+m+4*e] = tr - a1i;
+                  gr[i+1+m+4*e] = ti + a1r;
+                  tr = a0r + c2*t1r + c1*t2r;
+                  ti = a0i + c2*t1i + c1*t2i;
+                  a1r = s2*t3r - s1*t4r;
+                  a1i = s2*t3i - s1*t4i;
+                  gr[i+m+2*e] = tr + a1i;
+                  gr[i+1+m+2*e] = ti - a1r;
+                  gr[i+m+3*e] = tr - a1i;
+                  gr[i+1+m+3*e] = ti + a1r;
+               }
+            }
+         }
+      }
+      ns = nl;
+   }
+/* copy array elements back */
+   for (m = 0; m < n; m++) {
+      for (i = 0; i < nb; i++) {
+         f[ld*m+lb*i] = g[i+nb*m];
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rninit(int mixup[], float complex sct[], int nx, int ny,
+                  int nxhyd, int nxyhd) {
+/* this subroutine calculates tables needed by a two dimensional
+   real to complex mixed radix fast fourier transform and its inverse.
+   input: nx, ny, nxhyd, nxyhd
+   output: mixup, sct
+   mixup = array of digit reversed addresses, for x in mixup[j],
+   0 <= j < nx/2, for y in mixup[nx/2+k], 0 <= k < ny
+   sct = sine/cosine table, for x in sct[j] = exp(-sqrt(-1)*2pi*j/nx),
+   0 <= j < nx/2, for y in sct[nx/2+k] = exp(-sqrt(-1)*2pi*k/ny),
+   0 <= k < ny/2
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5,
+   see cfft1nfac
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+local data                                                            */
+   int nxh, nyh, n, noff, nf, i, j, k, m, lb, ll;
+   int nfac[32];
+   float dnx, arg;
+   nxh = nx/2;
+   nyh = ny/2;
+/* digit reversed index table: mixup[j] = 1 + reversed digits of j */
+   for (i = 0; i < 2; i++) {
+      n = i==0 ? nxh : ny;
+      noff = i==0 ? 0 : nxh;
+      nf = cfft1nfac(n,nfac);
+      for (j = 0; j < n; j++) {
+         lb = j;
+         ll = 0;
+         for (k = 0; k < nf; k++) {
+            m = lb/nfac[k];
+            ll = nfac[k]*ll + (lb - nfac[k]*m);
+            lb = m;
+         }
+         mixup[j+noff] = ll + 1;
+      }
+   }
+/* sine/cosine tables for the angles 2*n*pi/nx and 2*n*pi/ny */
+   dnx = 6.28318530717959/(float) nx;
+   for (j = 0; j < nxh; j++) {
+      arg = dnx*(float) j;
+      sct[j] = cosf(arg) - sinf(arg)*_Complex_I;
+   }
+   dnx = 6.28318530717959/(float) ny;
+   for (k = 0; k < nyh; k++) {
+      arg = dnx*(float) k;
+      sct[k+nxh] = cosf(arg) - sinf(arg)*_Complex_I;
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rnxx(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nyi, int nyp,
+               int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of a two dimensional real to
+   complex mixed radix fast fourier transform and its inverse, for a
+   subset of y, using complex arithmetic
+   same as cfft2rxx, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in x are performed in blocks of NXB rows by cfft1rnx
+   for isign = (-1,1), input: all, output: f
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, an inverse fourier transform is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx)*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rxx
+local data                                                            */
+#define NXB             8
+   int nxh, nxhh, nyt, nyb, i, j, k, nb, joff;
+   float ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   nxh = nx/2;
+   nxhh = nx/4;
+   nyt = nyi + nyp - 1;
+   nyb = (nyp - 1)/NXB + 1;
+   if (isign > 0)
+      goto L60;
+/* inverse fourier transform */
+   for (i = 0; i < nyb; i++) {
+      float complex g[NXB*nxh];
+      joff = nxhd*(nyi - 1 + NXB*i);
+      nb = nyt - (nyi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,1,nxhd,nb);
+/* unscramble coefficients and normalize */
+      ani = 1.0/(float) (2*nx*ny);
+      for (k = 0; k < nb; k++) {
+         for (j = 1; j < nxhh; j++) {
+            t3 = cimagf(sct[j]) - crealf(sct[j])*_Complex_I;
+            t2 = conjf(f[nxh-j+joff]);
+            t1 = f[j+joff] + t2;
+            t2 = (f[j+joff] - t2)*t3;
+            f[j+joff] = ani*(t1 + t2);
+            f[nxh-j+joff] = ani*conjf(t1 - t2);
+         }
+         f[nxhh+joff] = 2.0*ani*conjf(f[nxhh+joff]);
+         f[joff] = 2.0*ani*((crealf(f[joff]) + cimagf(f[joff]))
+                   + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I);
+         joff += nxhd;
+      }
+   }
+   return;
+/* forward fourier transform */
+L60:
+   for (i = 0; i < nyb; i++) {
+      float complex g[NXB*nxh];
+      joff = nxhd*(nyi - 1 + NXB*i);
+      nb = nyt - (nyi - 1 + NXB*i);
+      nb = NXB < nb ? NXB : nb;
+/* scramble coefficients */
+      for (k = 0; k < nb; k++) {
+         for (j = 1; j < nxhh; j++) {
+            t3 = cimagf(sct[j]) + crealf(sct[j])*_Complex_I;
+            t2 = conjf(f[nxh-j+joff]);
+            t1 = f[j+joff] + t2;
+            t2 = (f[j+joff] - t2)*t3;
+            f[j+joff] = t1 + t2;
+            f[nxh-j+joff] = conjf(t1 - t2);
+         }
+         f[nxhh+joff] = 2.0*conjf(f[nxhh+joff]);
+         f[joff] = (crealf(f[joff]) + cimagf(f[joff]))
+                   + (crealf(f[joff]) - cimagf(f[joff]))*_Complex_I;
+         joff += nxhd;
+      }
+/* transform in x */
+      joff = nxhd*(nyi - 1 + NXB*i);
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,1,nxhd,nb);
+   }
+   return;
+#undef NXB
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rnxy(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nxi, int nxp,
+               int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of a two dimensional real to
+   complex mixed radix fast fourier transform and its inverse, for a
+   subset of x, using complex arithmetic
+   same as cfft2rxy, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in y are performed in blocks of NXB columns by
+   cfft1rnx
+   for isign = (-1,1), input: all, output: f
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, an inverse fourier transform is performed
+   f[m][n] = (1/nx*ny)*sum(f[k][j]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, a forward fourier transform is performed
+   f[k][j] = sum(f[m][n]*exp(sqrt(-1)*2pi*n*j/nx)*exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = first dimension of f >= nx/2
+   nyd = second dimension of f >= ny
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2rxy
+local data                                                            */
+#define NXB             8
+   int nxh, nyh, nxt, nxb, i, k, k1, nb, joff;
+   float complex t1;
+   if (isign==0)
+      return;
+   nxh = nx/2;
+   nyh = ny/2;
+   nxt = nxi + nxp - 1;
+   nxb = (nxp - 1)/NXB + 1;
+   if (isign > 0)
+      goto L50;
+/* inverse fourier transform */
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = nxi - 1 + NXB*i;
+      nb = nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,nxhd,1,nb);
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         joff = nxhd*k;
+         k1 = nxhd*ny - joff;
+         t1 = f[k1];
+         f[k1] = 0.5*(cimagf(f[joff] + t1)
+                  + crealf(f[joff] - t1)*_Complex_I);
+         f[joff] = 0.5*(crealf(f[joff] + t1)
+                    + cimagf(f[joff] - t1)*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+/* scramble modes kx = 0, nx/2 */
+L50: if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         joff = nxhd*k;
+         k1 = nxhd*ny - joff;
+         t1 = cimagf(f[k1]) + crealf(f[k1])*_Complex_I;
+         f[k1] = conjf(f[joff] - t1);
+         f[joff] += t1;
+      }
+   }
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = nxi - 1 + NXB*i;
+      nb = nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,nxhd,1,nb);
+   }
+   return;
+#undef NXB
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rn2x(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nyi, int nyp,
+               int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the x part of 2 two dimensional real to
+   complex mixed radix fast fourier transforms, and their inverses, for
+   a subset of y, using complex arithmetic
+   same as cfft2r2x, except that nx/ny may have prime factors 2, 3 and 5
+   for isign = (-1,1), input: all, output: f
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1]*
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx)*
+         exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
+   nyi = initial y index used
+   nyp = number of y indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2r2x
+local data                                                            */
+   int nxh, nxhh, nyt, i, j, jj, joff;
+   float at1, ani;
+   float complex t1, t2, t3;
+   if (isign==0)
+      return;
+   nxh = nx/2;
+   nxhh = nx/4;
+   nyt = nyi + nyp - 1;
+   if (isign > 0)
+      goto L80;
+/* inverse fourier transform */
+   for (i = nyi-1; i < nyt; i++) {
+      float complex g[2*nxh];
+      joff = 2*nxhd*i;
+/* swap complex components */
+      for (j = 0; j < nxh; j++) {
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+      }
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,2,1,2);
+/* unscramble coefficients and normalize */
+      ani = 1.0/(float) (2*nx*ny);
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[j]) - crealf(sct[j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = ani*(t1 + t2);
+            f[jj+2*(nxh-j)+joff] = ani*conjf(t1 - t2);
+         }
+      }
+      ani = 2.0*ani;
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = ani*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = ani*((crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I);
+      }
+   }
+   return;
+/* forward fourier transform */
+L80:
+   for (i = nyi-1; i < nyt; i++) {
+      float complex g[2*nxh];
+      joff = 2*nxhd*i;
+/* scramble coefficients */
+      for (j = 1; j < nxhh; j++) {
+         t3 = cimagf(sct[j]) + crealf(sct[j])*_Complex_I;
+         for (jj = 0; jj < 2; jj++) {
+            t2 = conjf(f[jj+2*(nxh-j)+joff]);
+            t1 = f[jj+2*j+joff] + t2;
+            t2 = (f[jj+2*j+joff] - t2)*t3;
+            f[jj+2*j+joff] = t1 + t2;
+            f[jj+2*(nxh-j)+joff] = conjf(t1 - t2);
+         }
+      }
+      for (jj = 0; jj < 2; jj++) {
+         f[jj+2*nxhh+joff] = 2.0*conjf(f[jj+2*nxhh+joff]);
+         f[jj+joff] = (crealf(f[jj+joff]) + cimagf(f[jj+joff]))
+                      + (crealf(f[jj+joff]) - cimagf(f[jj+joff]))*_Complex_I;
+      }
+/* transform in x */
+      cfft1rnx(&f[joff],g,isign,mixup,sct,nxh,2,2,1,2);
+/* swap complex components */
+      for (j = 0; j < nxh; j++) {
+         at1 = cimagf(f[2*j+joff]);
+         f[2*j+joff] = crealf(f[2*j+joff])
+                       + crealf(f[1+2*j+joff])*_Complex_I;
+         f[1+2*j+joff] = at1 + cimagf(f[1+2*j+joff])*_Complex_I;
+      }
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cfft2rn2y(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nxi, int nxp,
+               int nxhd, int nyd, int nxhyd, int nxyhd) {
+/* this subroutine performs the y part of 2 two dimensional real to
+   complex mixed radix fast fourier transforms, and their inverses, for
+   a subset of x, using complex arithmetic
+   same as cfft2r2y, except that nx/ny may have prime factors 2, 3 and 5
+   the transforms in y are performed in blocks of NXB columns by
+   cfft1rnx
+   for isign = (-1,1), input: all, output: f
+   nx/ny = system length in x/y direction, nx must be a multiple of 4,
+   ny a multiple of 2, with no prime factors other than 2, 3 and 5
+   if isign = -1, two inverse fourier transforms are performed
+   f[m][n][0:1] = (1/nx*ny)*sum(f[k][j][0:1] *
+         exp(-sqrt(-1)*2pi*n*j/nx)*exp(-sqrt(-1)*2pi*m*k/ny))
+   if isign = 1, two forward fourier transforms are performed
+   f[k][j][0:1] = sum(f[m][n][0:1]*exp(sqrt(-1)*2pi*n*j/nx)*
+         exp(sqrt(-1)*2pi*m*k/ny))
+   mixup = array of digit reversed addresses, from cwfft2rninit
+   sct = sine/cosine table, from cwfft2rninit
+   nxi = initial x index used
+   nxp = number of x indices used
+   nxhd = second dimension of f >= nx/2
+   nyd = third dimension of f >= ny
+   nxhyd = must be >= nx/2 + ny
+   nxyhd = must be >= nx/2 + ny/2
+   fourier coefficients are stored as for cfft2r2y
+local data                                                            */
+#define NXB             8
+   int nxh, nyh, nxt, nxb, i, k, k1, jj, nb, joff;
+   float complex t1;
+   if (isign==0)
+      return;
+   nxh = nx/2;
+   nyh = ny/2;
+   nxt = nxi + nxp - 1;
+/* both components are transformed together, 2*nxp columns */
+   nxb = (2*nxp - 1)/NXB + 1;
+   if (isign > 0)
+      goto L60;
+/* inverse fourier transform */
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = 2*(nxi - 1) + NXB*i;
+      nb = 2*nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,2*nxhd,1,
+               nb);
+   }
+/* unscramble modes kx = 0, nx/2 */
+   if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         joff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - joff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = f[jj+k1];
+            f[jj+k1] = 0.5*(cimagf(f[jj+joff] + t1)
+                        + crealf(f[jj+joff] - t1)*_Complex_I);
+            f[jj+joff] = 0.5*(crealf(f[jj+joff] + t1)
+                          + cimagf(f[jj+joff] - t1)*_Complex_I);
+         }
+      }
+   }
+   return;
+/* forward fourier transform */
+/* scramble modes kx = 0, nx/2 */
+L60: if (nxi==1) {
+      for (k = 1; k < nyh; k++) {
+         joff = 2*nxhd*k;
+         k1 = 2*nxhd*ny - joff;
+         for (jj = 0; jj < 2; jj++) {
+            t1 = cimagf(f[jj+k1]) + crealf(f[jj+k1])*_Complex_I;
+            f[jj+k1] = conjf(f[jj+joff] - t1);
+            f[jj+joff] += t1;
+         }
+      }
+   }
+   for (i = 0; i < nxb; i++) {
+      float complex g[NXB*ny];
+      joff = 2*(nxi - 1) + NXB*i;
+      nb = 2*nxt - joff;
+      nb = NXB < nb ? NXB : nb;
+/* transform in y */
+      cfft1rnx(&f[joff],g,isign,&mixup[nxh],&sct[nxh],ny,1,2*nxhd,1,
+               nb);
+   }
+   return;
+#undef NXB
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rnx(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nxhd, int nyd,
+               int nxhyd, int nxyhd) {
+/* wrapper function for real to complex mixed radix fft, with packed */
+/* data, nx/ny may have prime factors 2, 3 and 5 */
+/* local data */
+   int nxh;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = nx/2;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2rnxx(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
+/* perform y fft */
+      cfft2rnxy(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2rnxy(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
+/* perform x fft */
+      cfft2rnxx(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
+   }
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rn2(float complex f[], int isign, int mixup[],
+               float complex sct[], int nx, int ny, int nxhd, int nyd,
+               int nxhyd, int nxyhd) {
+/* wrapper function for 2 2d real to complex mixed radix ffts, */
+/* nx/ny may have prime factors 2, 3 and 5 */
+/* local data */
+   int nxh;
+   static int nxi = 1, nyi = 1;
+/* calculate range of indices */
+   nxh = nx/2;
+/* inverse fourier transform */
+   if (isign < 0) {
+/* perform x fft */
+      cfft2rn2x(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
+/* perform y fft */
+      cfft2rn2y(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
+   }
+/* forward fourier transform */
+   else if (isign > 0) {
+/* perform y fft */
+      cfft2rn2y(f,isign,mixup,sct,nx,ny,nxi,nxh,nxhd,nyd,nxhyd,nxyhd);
+/* perform x fft */
+      cfft2rn2x(f,isign,mixup,sct,nx,ny,nyi,ny,nxhd,nyd,nxhyd,nxyhd);
+   }
+   return;
+}
+
 /* Interfaces to Fortran */
 
 /*--------------------------------------------------------------------*/
@@ -1578,3 +2287,26 @@ void cwfft2r2_(float complex *f, int *isign, int *mixup, float complex *sct,
    cwfft2r2(f,*isign,mixup,sct,*indx,*indy,*nxhd,*nyd,*nxhyd,*nxyhd);
    return;
 }
+
+/*--------------------------------------------------------------------*/
+void cwfft2rninit_(int *mixup, float complex *sct, int *nx, int *ny,
+                   int *nxhyd, int *nxyhd) {
+   cwfft2rninit(mixup,sct,*nx,*ny,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rnx_(float complex *f, int *isign, int *mixup,
+                float complex *sct, int *nx, int *ny, int *nxhd,
+                int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2rnx(f,*isign,mixup,sct,*nx,*ny,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cwfft2rn2_(float complex *f, int *isign, int *mixup,
+                float complex *sct, int *nx, int *ny, int *nxhd,
+                int *nyd, int *nxhyd, int *nxyhd) {
+   cwfft2rn2(f,*isign,mixup,sct,*nx,*ny,*nxhd,*nyd,*nxhyd,*nxyhd);
+   return;
+}
@@ -9,6 +9,82 @@
 #include <mm_malloc.h>
 #include "avx512lib3.h"
 
+/* check if processor supports the given instruction set extension */
+/* returns 1 if supported, 0 otherwise                               */
+#if defined(__MIC__)
+/* KNC processors support none of the host vector extensions */
+int check_sse2() {
+   return 0;
+}
+
+int check_avx() {
+   return 0;
+}
+
+int check_avx2() {
+   return 0;
+}
+
+int check_avx512() {
+   return 0;
+}
+#elif defined(__INTEL_COMPILER)
+int check_sse2() {
+   int result;
+   result = _may_i_use_cpu_feature(_FEATURE_SSE2);
+   return result;
+}
+
+int check_avx() {
+   int result;
+   result = _may_i_use_cpu_feature(_FEATURE_AVX);
+   return result;
+}
+
+int check_avx2() {
+   int result;
+   result = _may_i_use_cpu_feature(_FEATURE_AVX2 | _FEATURE_FMA);
+   return result;
+}
+
+int check_avx512() {
+   int result;
+   result = _may_i_use_cpu_feature(_FEATURE_AVX512F);
+   return result;
+}
+#else
+/* gcc and compatible compilers */
+int check_sse2() {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("sse2") ? 1 : 0;
+}
+
+int check_avx() {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx") ? 1 : 0;
+}
+
+int check_avx2() {
+   __builtin_cpu_init();
+   return (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+          ? 1 : 0;
+}
+
+int check_avx512() {
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx512f") ? 1 : 0;
+}
+#endif
+
+/* returns 1 if code was compiled for KNC, 0 otherwise */
+int check_knc() {
+#if defined(__MIC__)
+   return 1;
+#else
+   return 0;
+#endif
+}
+
 /*--------------------------------------------------------------------*/
 void avx512_fallocate(float **s_f, int nsize, int *irc) {
 /* allocate aligned float memory on AVX512 return pointer to C */
@@ -81,8 +157,10 @@ void cknciscan2(int *isdata, int nths) {
 /* performs local prefix reduction of integer data shared by threads */
 /* using binary tree method. */
 /* requires KNC, isdata needs to be 64 byte aligned */
+/* on other processors, only the scalar loop is used */
 /* local data */
    int j, ns, isum, ist;
+#if defined(__MIC__)
    __m512i v_m1, v_m2, v_it, v_is, v_ioff;
    ns = 16*(nths/16);
    v_m1 = _mm512_set_epi32(11,11,11,11,11,10,9,8,3,3,3,3,3,2,1,0);
@@ -119,6 +197,10 @@ void cknciscan2(int *isdata, int nths) {
    }
    if (ns > 0)
       isum = isdata[ns-1];
+#else
+   ns = 0;
+   isum = 0;
+#endif
 /* loop over remaining elements */
    for (j = ns; j < nths; j++) {
       ist = isdata[j];
@@ -143,6 +225,31 @@ void cknciscan2_(int *isdata, int *nths) {
    return;
 }
 
+/*--------------------------------------------------------------------*/
+int check_sse2_() {
+   return check_sse2();
+}
+
+/*--------------------------------------------------------------------*/
+int check_avx_() {
+   return check_avx();
+}
+
+/*--------------------------------------------------------------------*/
+int check_avx2_() {
+   return check_avx2();
+}
+
+/*--------------------------------------------------------------------*/
+int check_avx512_() {
+   return check_avx512();
+}
+
+/*--------------------------------------------------------------------*/
+int check_knc_() {
+   return check_knc();
+}
+
 void fcopyin_(float *f, float *g, int *n) {
    int j;
    for (j = 0; j < *n; j++) {
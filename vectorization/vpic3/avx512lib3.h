@@ -9,3 +9,13 @@ void avx512_iallocate(int **s_i, int nsize, int *irc);
 void avx512_deallocate(void *s_d);
 
 void cknciscan2(int *isdata, int nths);
+
+int check_sse2();
+
+int check_avx();
+
+int check_avx2();
+
+int check_avx512();
+
+int check_knc();
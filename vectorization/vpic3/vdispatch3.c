@@ -0,0 +1,271 @@
+/* C Library for run time selection of procedures for Skeleton 3D */
+/* Electrostatic Vector PIC Code                                  */
+/* a single executable contains several versions of the push,    */
+/* deposit, sort, guard cell, field solver and FFT procedures.    */
+/* cselect3 probes the processor and binds the csel procedures    */
+/* below to the fastest version supported, unless overridden      */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include "vpush3.h"
+#include "vxpush3.h"
+#include "avx512lib3.h"
+#include "kncpush3.h"
+#include "vdispatch3.h"
+
+/* version currently selected */
+static int kvsel = 0;
+
+/* table of procedures for currently selected version */
+static void (*pgpush3lt)(float part[], float fxyz[], float qbm, float dt,
+                         float *ek, int idimp, int nop, int npe, int nx,
+                         int ny, int nz, int nxv, int nyv, int nzv,
+                         int ipbc) = cvgpush3lt;
+static void (*pgpost3lt)(float part[], float q[], float qm, int nop,
+                         int npe, int idimp, int nxv, int nyv,
+                         int nzv) = cgpost3lt;
+static void (*pdsortp3yzlt)(float parta[], float partb[], int npic[],
+                            int idimp, int nop, int npe, int ny1,
+                            int nyz1) = cdsortp3yzlt;
+static void (*pcguard3l)(float fxyz[], int nx, int ny, int nz, int nxe,
+                         int nye, int nze) = ccguard3l;
+static void (*paguard3l)(float q[], int nx, int ny, int nz, int nxe,
+                         int nye, int nze) = caguard3l;
+static void (*ppois33)(float complex q[], float complex fxyz[],
+                       int isign, float complex ffc[], float ax,
+                       float ay, float az, float affp, float *we,
+                       int nx, int ny, int nz, int nxvh, int nyv,
+                       int nzv, int nxhd, int nyhd, int nzhd) = cvpois33;
+static void (*pwfft3rvx)(float complex f[], int isign, int mixup[],
+                         float complex sct[], int indx, int indy,
+                         int indz, int nxhd, int nyd, int nzd,
+                         int nxhyzd, int nxyzhd) = cwfft3rvx;
+static void (*pwfft3rv3)(float complex f[], int isign, int mixup[],
+                         float complex sct[], int indx, int indy,
+                         int indz, int nxhd, int nyd, int nzd,
+                         int nxhyzd, int nxyzhd) = cwfft3rv3;
+
+/*--------------------------------------------------------------------*/
+int cselect3(int kvec) {
+/* this subroutine selects which version of the procedures is called
+   by the csel procedures, and returns the version selected.
+   kvec = (1,2,3,4,5) = (autovector,KNC,AVX2,AVX512,scalar) version
+   values 1 and 2 have the same meaning as in the Fortran main program.
+   the autovector version uses the vectorizable procedures compiled
+   with the default options, which is SSE2 on x86-64.  AVX2 and AVX512
+   versions are the vectorizable procedures compiled for that
+   instruction set.
+   if kvec = 0, the fastest version supported by the processor is used.
+   the environment variable VPIC_KVEC, if set, overrides kvec.
+   if the requested version is not supported, the next fastest
+   supported version is used.
+local data                                                            */
+   int kv;
+   char *env;
+   kv = kvec;
+/* check for override from environment */
+   env = getenv("VPIC_KVEC");
+   if (env != NULL) {
+      kv = atoi(env);
+      if ((kv < 0) || (kv > 5)) {
+         printf("cselect3: invalid VPIC_KVEC=%s ignored\n",env);
+         kv = kvec;
+      }
+   }
+/* find fastest version supported: KNC, AVX512, AVX2, autovector */
+   if ((kv==0) || (kv > 5))
+      kv = 2;
+   if ((kv==2) && (!check_knc()))
+      kv = 4;
+   if ((kv==4) && (!check_avx512()))
+      kv = 3;
+   if ((kv==3) && (!check_avx2()))
+      kv = 1;
+/* default procedures */
+   pgpush3lt = cvgpush3lt;
+   pgpost3lt = cgpost3lt;
+   pdsortp3yzlt = cdsortp3yzlt;
+   pcguard3l = ccguard3l;
+   paguard3l = caguard3l;
+   ppois33 = cvpois33;
+   pwfft3rvx = cwfft3rvx;
+   pwfft3rv3 = cwfft3rv3;
+/* scalar version */
+   if (kv==5) {
+      pgpush3lt = cgpush3lt;
+   }
+/* vectorizable procedures compiled for AVX2 */
+   else if (kv==3) {
+      pgpush3lt = cavx2vgpush3lt;
+      pgpost3lt = cavx2vgpost3lt;
+   }
+/* vectorizable procedures compiled for AVX512 */
+   else if (kv==4) {
+      pgpush3lt = cavx512vgpush3lt;
+      pgpost3lt = cavx512vgpost3lt;
+   }
+#if defined(__MIC__)
+/* KNC functions */
+   else if (kv==2) {
+      pgpush3lt = ckncgpush3lt;
+      pgpost3lt = cknc2gpost3lt;
+      pdsortp3yzlt = ckncdsortp3yzlt;
+      pcguard3l = cknccguard3l;
+      paguard3l = ckncaguard3l;
+      ppois33 = ckncpois33;
+      pwfft3rvx = ckncwfft3rvx;
+      pwfft3rv3 = ckncwfft3rv3;
+   }
+#endif
+   kvsel = kv;
+   return kv;
+}
+
+/*--------------------------------------------------------------------*/
+int cselected3() {
+/* returns version selected by cselect3, 0 if none selected yet */
+   return kvsel;
+}
+
+/*--------------------------------------------------------------------*/
+void cselgpush3lt(float part[], float fxyz[], float qbm, float dt,
+                  float *ek, int idimp, int nop, int npe, int nx, int ny,
+                  int nz, int nxv, int nyv, int nzv, int ipbc) {
+   (*pgpush3lt)(part,fxyz,qbm,dt,ek,idimp,nop,npe,nx,ny,nz,nxv,nyv,nzv,
+                ipbc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselgpost3lt(float part[], float q[], float qm, int nop, int npe,
+                  int idimp, int nxv, int nyv, int nzv) {
+   (*pgpost3lt)(part,q,qm,nop,npe,idimp,nxv,nyv,nzv);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cseldsortp3yzlt(float parta[], float partb[], int npic[],
+                     int idimp, int nop, int npe, int ny1, int nyz1) {
+   (*pdsortp3yzlt)(parta,partb,npic,idimp,nop,npe,ny1,nyz1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselcguard3l(float fxyz[], int nx, int ny, int nz, int nxe,
+                  int nye, int nze) {
+   (*pcguard3l)(fxyz,nx,ny,nz,nxe,nye,nze);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselaguard3l(float q[], int nx, int ny, int nz, int nxe, int nye,
+                  int nze) {
+   (*paguard3l)(q,nx,ny,nz,nxe,nye,nze);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselpois33(float complex q[], float complex fxyz[], int isign,
+                float complex ffc[], float ax, float ay, float az,
+                float affp, float *we, int nx, int ny, int nz, int nxvh,
+                int nyv, int nzv, int nxhd, int nyhd, int nzhd) {
+   (*ppois33)(q,fxyz,isign,ffc,ax,ay,az,affp,we,nx,ny,nz,nxvh,nyv,nzv,
+              nxhd,nyhd,nzhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselwfft3rvx(float complex f[], int isign, int mixup[],
+                  float complex sct[], int indx, int indy, int indz,
+                  int nxhd, int nyd, int nzd, int nxhyzd, int nxyzhd) {
+   (*pwfft3rvx)(f,isign,mixup,sct,indx,indy,indz,nxhd,nyd,nzd,nxhyzd,
+                nxyzhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselwfft3rv3(float complex f[], int isign, int mixup[],
+                  float complex sct[], int indx, int indy, int indz,
+                  int nxhd, int nyd, int nzd, int nxhyzd, int nxyzhd) {
+   (*pwfft3rv3)(f,isign,mixup,sct,indx,indy,indz,nxhd,nyd,nzd,nxhyzd,
+                nxyzhd);
+   return;
+}
+
+/* Interfaces to Fortran */
+
+/*--------------------------------------------------------------------*/
+int cselect3_(int *kvec) {
+   return cselect3(*kvec);
+}
+
+/*--------------------------------------------------------------------*/
+void cselgpush3lt_(float *part, float *fxyz, float *qbm, float *dt,
+                   float *ek, int *idimp, int *nop, int *npe, int *nx,
+                   int *ny, int *nz, int *nxv, int *nyv, int *nzv,
+                   int *ipbc) {
+   cselgpush3lt(part,fxyz,*qbm,*dt,ek,*idimp,*nop,*npe,*nx,*ny,*nz,*nxv,
+                *nyv,*nzv,*ipbc);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselgpost3lt_(float *part, float *q, float *qm, int *nop, int *npe,
+                   int *idimp, int *nxv, int *nyv, int *nzv) {
+   cselgpost3lt(part,q,*qm,*nop,*npe,*idimp,*nxv,*nyv,*nzv);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cseldsortp3yzlt_(float *parta, float *partb, int *npic,
+                      int *idimp, int *nop, int *npe, int *ny1,
+                      int *nyz1) {
+   cseldsortp3yzlt(parta,partb,npic,*idimp,*nop,*npe,*ny1,*nyz1);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselcguard3l_(float *fxyz, int *nx, int *ny, int *nz, int *nxe,
+                   int *nye, int *nze) {
+   cselcguard3l(fxyz,*nx,*ny,*nz,*nxe,*nye,*nze);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselaguard3l_(float *q, int *nx, int *ny, int *nz, int *nxe,
+                   int *nye, int *nze) {
+   cselaguard3l(q,*nx,*ny,*nz,*nxe,*nye,*nze);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselpois33_(float complex *q, float complex *fxyz, int *isign,
+                 float complex *ffc, float *ax, float *ay, float *az,
+                 float *affp, float *we, int *nx, int *ny, int *nz,
+                 int *nxvh, int *nyv, int *nzv, int *nxhd, int *nyhd,
+                 int *nzhd) {
+   cselpois33(q,fxyz,*isign,ffc,*ax,*ay,*az,*affp,we,*nx,*ny,*nz,*nxvh,
+              *nyv,*nzv,*nxhd,*nyhd,*nzhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselwfft3rvx_(float complex *f, int *isign, int *mixup,
+                   float complex *sct, int *indx, int *indy, int *indz,
+                   int *nxhd, int *nyd, int *nzd, int *nxhyzd,
+                   int *nxyzhd) {
+   cselwfft3rvx(f,*isign,mixup,sct,*indx,*indy,*indz,*nxhd,*nyd,*nzd,
+                *nxhyzd,*nxyzhd);
+   return;
+}
+
+/*--------------------------------------------------------------------*/
+void cselwfft3rv3_(float complex *f, int *isign, int *mixup,
+                   float complex *sct, int *indx, int *indy, int *indz,
+                   int *nxhd, int *nyd, int *nzd, int *nxhyzd,
+                   int *nxyzhd) {
+   cselwfft3rv3(f,*isign,mixup,sct,*indx,*indy,*indz,*nxhd,*nyd,*nzd,
+                *nxhyzd,*nxyzhd);
+   return;
+}
@@ -0,0 +1,34 @@
+/* header file for vdispatch3.c */
+
+int cselect3(int kvec);
+
+int cselected3();
+
+void cselgpush3lt(float part[], float fxyz[], float qbm, float dt,
+                  float *ek, int idimp, int nop, int npe, int nx, int ny,
+                  int nz, int nxv, int nyv, int nzv, int ipbc);
+
+void cselgpost3lt(float part[], float q[], float qm, int nop, int npe,
+                  int idimp, int nxv, int nyv, int nzv);
+
+void cseldsortp3yzlt(float parta[], float partb[], int npic[],
+                     int idimp, int nop, int npe, int ny1, int nyz1);
+
+void cselcguard3l(float fxyz[], int nx, int ny, int nz, int nxe,
+                  int nye, int nze);
+
+void cselaguard3l(float q[], int nx, int ny, int nz, int nxe, int nye,
+                  int nze);
+
+void cselpois33(float complex q[], float complex fxyz[], int isign,
+                float complex ffc[], float ax, float ay, float az,
+                float affp, float *we, int nx, int ny, int nz, int nxvh,
+                int nyv, int nzv, int nxhd, int nyhd, int nzhd);
+
+void cselwfft3rvx(float complex f[], int isign, int mixup[],
+                  float complex sct[], int indx, int indy, int indz,
+                  int nxhd, int nyd, int nzd, int nxhyzd, int nxyzhd);
+
+void cselwfft3rv3(float complex f[], int isign, int mixup[],
+                  float complex sct[], int indx, int indy, int indz,
+                  int nxhd, int nyd, int nzd, int nxhyzd, int nxyzhd);
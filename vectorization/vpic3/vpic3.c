@@ -7,7 +7,7 @@
 #include <sys/time.h>
 #include "vpush3.h"
 #include "avx512lib3.h"
-#include "kncpush3.h"
+#include "vdispatch3.h"
 
 void dtimer(double *time, struct timeval *itime, int icntrl);
 
@@ -35,8 +35,11 @@ int main(int argc, char *argv[]) {
    int idimp = 6, ipbc = 1, sortime = 20;
 /* wke/we/wt = particle kinetic/electric field/total energy */
    float wke = 0.0, we = 0.0, wt = 0.0;
-/* kvec = (1,2) = run (autovector,KNC) version */
-   int kvec = 1;
+/* kvec = (1,2,3,4,5) = run (autovector,KNC,AVX2,AVX512,scalar) */
+/* version                                                         */
+/* kvec = 0 selects the fastest version supported by the processor */
+/* environment variable VPIC_KVEC, if set, overrides kvec */
+   int kvec = 0;
    
 /* declare scalars for standard code */
    int j;
@@ -83,6 +86,9 @@ int main(int argc, char *argv[]) {
    qbme = qme;
    affp = ((float) nx)*((float) ny)*((float) nz)/(float ) np;
 
+/* select version of procedures to run */
+   kvec = cselect3(kvec);
+
 /* allocate data for standard code */
    mixup = (int *) malloc(nxhyz*sizeof(int));
    sct = (float complex *) malloc(nxyzh*sizeof(float complex));
@@ -123,23 +129,14 @@ L500: if (nloop <= ntime)
       for (j = 0; j < nxe*nye; j++) {
          qe[j] = 0.0;
       }
-      if (kvec==1)
-         cgpost3lt(partt,qe,qme,np,npe,idimp,nxe,nye,nze);
-/*       cvgpost3lt(partt,qe,qme,np,npe,idimp,nxe,nye,nze); */
-/* KNC function */
-      else if (kvec==2)
-         cknc2gpost3lt(partt,qe,qme,np,npe,idimp,nxe,nye,nze);
+      cselgpost3lt(partt,qe,qme,np,npe,idimp,nxe,nye,nze);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tdpost += time;
 
 /* add guard cells with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
-      if (kvec==1)
-         caguard3l(qe,nx,ny,nz,nxe,nye,nze);
-/* KNC function */
-      else if (kvec==2)
-         ckncaguard3l(qe,nx,ny,nz,nxe,nye,nze);
+      cselaguard3l(qe,nx,ny,nz,nxe,nye,nze);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
@@ -147,13 +144,8 @@ L500: if (nloop <= ntime)
 /* transform charge to fourier space with standard procedure: updates qe */
       dtimer(&dtime,&itime,-1);
       isign = -1;
-      if (kvec==1)
-         cwfft3rvx((float complex *)qe,isign,mixup,sct,indx,indy,indz,
+      cselwfft3rvx((float complex *)qe,isign,mixup,sct,indx,indy,indz,
                    nxeh,nye,nze,nxhyz,nxyzh);
-/* KNC function */
-      else if (kvec==2)
-         ckncwfft3rvx((float complex *)qe,isign,mixup,sct,indx,indy,
-                      indz,nxeh,nye,nze,nxhyz,nxyzh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
@@ -162,14 +154,8 @@ L500: if (nloop <= ntime)
 /* updates fxyze, we                                                */
       dtimer(&dtime,&itime,-1);
       isign = -1;
-      if (kvec==1)
-         cvpois33((float complex *)qe,(float complex *)fxyze,isign,ffc,
-                   ax,ay,az,affp,&we,nx,ny,nz,nxeh,nye,nze,nxh,nyh,nzh);
-/* KNC function */
-      else if (kvec==2)
-         ckncpois33((float complex *)qe,(float complex *)fxyze,isign,
-                    ffc,ax,ay,az,affp,&we,nx,ny,nz,nxeh,nye,nze,nxh,nyh,
-                    nzh);
+      cselpois33((float complex *)qe,(float complex *)fxyze,isign,ffc,
+                 ax,ay,az,affp,&we,nx,ny,nz,nxeh,nye,nze,nxh,nyh,nzh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfield += time;
@@ -177,24 +163,15 @@ L500: if (nloop <= ntime)
 /* transform force to real space with standard procedure: updates fxyze */
       dtimer(&dtime,&itime,-1);
       isign = 1;
-      if (kvec==1)
-         cwfft3rv3((float complex *)fxyze,isign,mixup,sct,indx,indy,
+      cselwfft3rv3((float complex *)fxyze,isign,mixup,sct,indx,indy,
                    indz,nxeh,nye,nze,nxhyz,nxyzh);
-/* KNC function */
-      else if (kvec==2)
-         ckncwfft3rv3((float complex *)fxyze,isign,mixup,sct,indx,indy,
-                      indz,nxeh,nye,nze,nxhyz,nxyzh);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tfft += time;
 
 /* copy guard cells with standard procedure: updates fxyze */
       dtimer(&dtime,&itime,-1);
-      if (kvec==1)
-         ccguard3l(fxyze,nx,ny,nz,nxe,nye,nze);
-/* KNC function */
-      else if (kvec==2)
-         cknccguard3l(fxyze,nx,ny,nz,nxe,nye,nze);
+      cselcguard3l(fxyze,nx,ny,nz,nxe,nye,nze);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tguard += time;
@@ -202,15 +179,8 @@ L500: if (nloop <= ntime)
 /* push particles with standard procedure: updates part, wke */
       wke = 0.0;
       dtimer(&dtime,&itime,-1);
-      if (kvec==1)
-/*       cgpush3lt(partt,fxyze,qbme,dt,&wke,idimp,np,npe,nx,ny,nz,nxe, */
-/*                 nye,nze,ipbc);                                      */
-         cvgpush3lt(partt,fxyze,qbme,dt,&wke,idimp,np,npe,nx,ny,nz,nxe,
-                    nye,nze,ipbc);
-/* KNC function */
-      else if (kvec==2)
-         ckncgpush3lt(partt,fxyze,qbme,dt,&wke,idimp,np,npe,nx,ny,nz,
-                      nxe,nye,nze,ipbc);
+      cselgpush3lt(partt,fxyze,qbme,dt,&wke,idimp,np,npe,nx,ny,nz,nxe,
+                   nye,nze,ipbc);
       dtimer(&dtime,&itime,1);
       time = (float) dtime;
       tpush += time;
@@ -219,11 +189,7 @@ L500: if (nloop <= ntime)
       if (sortime > 0) {
          if (ntime%sortime==0) {
             dtimer(&dtime,&itime,-1);
-            if (kvec==1)
-               cdsortp3yzlt(partt,partt2,npic,idimp,np,npe,ny1,nyz1);
-/* KNC function */
-            else if (kvec==2)
-               ckncdsortp3yzlt(partt,partt2,npic,idimp,np,npe,ny1,nyz1);
+            cseldsortp3yzlt(partt,partt2,npic,idimp,np,npe,ny1,nyz1);
 /* exchange pointers */
             tpartt = partt;
             partt = partt2;
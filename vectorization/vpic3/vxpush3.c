@@ -0,0 +1,491 @@
+/* C Library for Skeleton 3D Electrostatic Vector PIC Code */
+/* vectorizable push and deposit procedures, compiled once for each */
+/* instruction set to be selected at run time by vdispatch3.c.      */
+/* the instruction set name is given by the macro VXISA, so that    */
+/* cc -mavx2 -DVXISA=avx2 -c vxpush3.c defines cavx2vgpush3lt and   */
+/* cavx2vgpost3lt.  the procedures are the same as cvgpush3lt and   */
+/* cvgpost3lt in vpush3.c                                           */
+/* written by Viktor K. Decyk, UCLA and Ricardo Fonseca, ISCTE */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <complex.h>
+#include <math.h>
+#include "vxpush3.h"
+
+#ifndef VXISA
+#define VXISA avx2
+#endif
+#define VXCAT(isa,name) c ## isa ## name
+#define VXNAME2(isa,name) VXCAT(isa,name)
+#define VXNAME(name) VXNAME2(VXISA,name)
+
+/*--------------------------------------------------------------------*/
+void VXNAME(vgpush3lt)(float part[], float fxyz[], float qbm, float dt,
+                       float *ek, int idimp, int nop, int npe, int nx,
+                       int ny, int nz, int nxv, int nyv, int nzv,
+                       int ipbc) {
+/* for 3d code, this subroutine updates particle co-ordinates and
+   velocities using leap-frog scheme in time and first-order linear
+   interpolation in space
+   vectorizable version using guard cells
+   94 flops/particle, 30 loads, 6 stores
+   input: all, output: part, ek
+   equations used are:
+   vx(t+dt/2) = vx(t-dt/2) + (q/m)*fx(x(t),y(t),z(t))*dt,
+   vy(t+dt/2) = vy(t-dt/2) + (q/m)*fy(x(t),y(t),z(t))*dt,
+   vz(t+dt/2) = vz(t-dt/2) + (q/m)*fz(x(t),y(t),z(t))*dt,
+   where q/m is charge/mass, and
+   x(t+dt) = x(t) + vx(t+dt/2)*dt, y(t+dt) = y(t) + vy(t+dt/2)*dt,
+   z(t+dt) = z(t) + vz(t+dt/2)*dt
+   fx(x(t),y(t),z(t)), fy(x(t),y(t),z(t)), and fz(x(t),y(t),z(t))
+   are approximated by interpolation from the nearest grid points:
+   fx(x,y,z) = (1-dz)*((1-dy)*((1-dx)*fx(n,m,l)+dx*fx(n+1,m,l))
+                  + dy*((1-dx)*fx(n,m+1,l) + dx*fx(n+1,m+1,l)))
+             + dz*((1-dy)*((1-dx)*fx(n,m,l+1)+dx*fx(n+1,m,l+1))
+                  + dy*((1-dx)*fx(n,m+1,l+1) + dx*fx(n+1,m+1,l+1)))
+   fy(x,y,z) = (1-dz)*((1-dy)*((1-dx)*fy(n,m,l)+dx*fy(n+1,m,l))
+                  + dy*((1-dx)*fy(n,m+1,l) + dx*fy(n+1,m+1,l)))
+             + dz*((1-dy)*((1-dx)*fy(n,m,l+1)+dx*fy(n+1,m,l+1))
+                  + dy*((1-dx)*fy(n,m+1,l+1) + dx*fy(n+1,m+1,l+1)))
+   fz(x,y,z) = (1-dz)*((1-dy)*((1-dx)*fz(n,m,l)+dx*fz(n+1,m,l))
+                  + dy*((1-dx)*fz(n,m+1,l) + dx*fz(n+1,m+1,l)))
+             + dz*((1-dy)*((1-dx)*fz(n,m,l+1)+dx*fz(n+1,m,l+1))
+                  + dy*((1-dx)*fz(n,m+1,l+1) + dx*fz(n+1,m+1,l+1)))
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
+   part[0][n] = position x of particle n
+   part[1][n] = position y of particle n
+   part[2][n] = position z of particle n
+   part[3][n] = velocity vx of particle n
+   part[4][n] = velocity vy of particle n
+   part[5][n] = velocity vz of particle n
+   fxyz[l][k][j][0] = x component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][1] = y component of force/charge at grid (j,k,l)
+   fxyz[l][k][j][2] = z component of force/charge at grid (j,k,l)
+   that is, convolution of electric field over particle shape
+   qbm = particle charge/mass ratio
+   dt = time interval between successive calculations
+   kinetic energy/mass at time t is also calculated, using
+   ek = .125*sum((vx(t+dt/2)+vx(t-dt/2))**2+(vy(t+dt/2)+vy(t-dt/2))**2+
+   (vz(t+dt/2)+vz(t-dt/2))**2)
+   idimp = size of phase space = 6
+   nop = number of particles
+   npe = first dimension of particle array
+   nx/ny/nz = system length in x/y/z direction
+   nxv = second dimension of field array, must be >= nx+1
+   nyv = third dimension of field array, must be >= ny+1
+   nzv = fourth dimension of field array, must be >= nz+1
+   ipbc = particle boundary condition = (0,1,2,3) =
+   (none,3d periodic,3d reflecting,mixed 2d reflecting/1d periodic)
+local data                                                            */
+#define NPBLK             32
+#define LVECT             8
+#define N 4
+   int i, j, k, ipp, joff, nps, nn, mm, ll, nxyv;
+   float qtm, edgelx, edgely, edgelz, edgerx, edgery, edgerz;
+   float dxp, dyp, dzp, amx, amy, amz, dx1, x, y, z, dx, dy, dz;
+   float vx, vy, vz;
+/* scratch arrays */
+   int n[NPBLK], m[LVECT];
+   float s[NPBLK*LVECT], t[NPBLK*3];
+   double sum1;
+   nxyv = nxv*nyv;
+   m[0] = 0;
+   m[1] = N;
+   m[2] = N*nxv;
+   m[3] = N*(nxv + 1);
+   m[4] = N*nxyv;
+   m[5] = N*(nxyv + 1);
+   m[6] = N*(nxyv + nxv);
+   m[7] = N*(nxyv + nxv + 1);
+   qtm = qbm*dt;
+   sum1 = 0.0;
+/* set boundary values */
+   edgelx = 0.0f;
+   edgely = 0.0f;
+   edgelz = 0.0f;
+   edgerx = (float) nx;
+   edgery = (float) ny;
+   edgerz = (float) nz;
+   if (ipbc==2) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgelz = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+      edgerz = (float) (nz-1);
+   }
+   else if (ipbc==3) {
+      edgelx = 1.0f;
+      edgely = 1.0f;
+      edgerx = (float) (nx-1);
+      edgery = (float) (ny-1);
+   }
+   ipp = nop/NPBLK;
+/* outer loop over number of full blocks */
+   for (k = 0; k < ipp; k++) {
+      joff = NPBLK*k;
+/* inner loop over particles in block */
+      for (j = 0; j < NPBLK; j++) {
+/* find interpolation weights */
+         x = part[j+joff];
+         y = part[j+joff+npe];
+         z = part[j+joff+2*npe];
+         nn = x;
+         mm = y;
+         ll = z;
+         dxp = x - (float) nn;
+         dyp = y - (float) mm;
+         dzp = z - (float) ll;
+         n[j] = N*(nn + nxv*mm + nxyv*ll);
+         amx = 1.0f - dxp;
+         amy = 1.0f - dyp;
+         dx1 = dxp*dyp;
+         dyp = amx*dyp;
+         amx = amx*amy;
+         amz = 1.0f - dzp;
+         amy = dxp*amy;
+         s[j] = amx*amz;
+         s[j+NPBLK] = amy*amz;
+         s[j+2*NPBLK] = dyp*amz;
+         s[j+3*NPBLK] = dx1*amz;
+         s[j+4*NPBLK] = amx*dzp;
+         s[j+5*NPBLK] = amy*dzp;
+         s[j+6*NPBLK] = dyp*dzp;
+         s[j+7*NPBLK] = dx1*dzp;
+         t[j] = x;
+         t[j+NPBLK] = y;
+         t[j+2*NPBLK] = z;
+      }
+/* find acceleration */
+      for (j = 0; j < NPBLK; j++) {
+         dx = 0.0f;
+         dy = 0.0f;
+         dz = 0.0f;
+#pragma ivdep
+         for (i = 0; i < LVECT; i++) {
+            dx += fxyz[n[j]+m[i]]*s[j+NPBLK*i];
+            dy += fxyz[1+n[j]+m[i]]*s[j+NPBLK*i];
+            dz += fxyz[2+n[j]+m[i]]*s[j+NPBLK*i];
+         }
+         s[j] = dx;
+         s[j+NPBLK] = dy;
+         s[j+2*NPBLK] = dz;
+      }
+/* new velocity */
+      for (j = 0; j < NPBLK; j++) {
+         x = t[j];
+         y = t[j+NPBLK];
+         z = t[j+2*NPBLK];
+         dxp = part[j+joff+3*npe];
+         dyp = part[j+joff+4*npe];
+         dzp = part[j+joff+5*npe];
+         vx = dxp + qtm*s[j];
+         vy = dyp + qtm*s[j+NPBLK];
+         vz = dzp + qtm*s[j+2*NPBLK];
+/* average kinetic energy */
+         dxp += vx;
+         dyp += vy;
+         dzp += vz;
+         sum1 += dxp*dxp + dyp*dyp + dzp*dzp;
+/* new position */
+         s[j] = x + vx*dt;
+         s[j+NPBLK] = y + vy*dt;
+         s[j+2*NPBLK] = z + vz*dt;
+         s[j+3*NPBLK] = vx;
+         s[j+4*NPBLK] = vy;
+         s[j+5*NPBLK] = vz;
+      }
+/* check boundary conditions */
+      for (j = 0; j < NPBLK; j++) {
+         dx = s[j];
+         dy = s[j+NPBLK];
+         dz = s[j+2*NPBLK];
+         vx = s[j+3*NPBLK];
+         vy = s[j+4*NPBLK];
+         vz = s[j+5*NPBLK];
+/* periodic boundary conditions */
+         if (ipbc==1) {
+            if (dx < edgelx) dx += edgerx;
+            if (dx >= edgerx) dx -= edgerx;
+            if (dy < edgely) dy += edgery;
+            if (dy >= edgery) dy -= edgery;
+            if (dz < edgelz) dz += edgerz;
+            if (dz >= edgerz) dz -= edgerz;
+         }
+/* reflecting boundary conditions */
+         else if (ipbc==2) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = t[j];
+               vx = -vx;
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = t[j+NPBLK];
+               vy = -vy;
+            }
+            if ((dz < edgelz) || (dz >= edgerz)) {
+               dz = t[j+2*NPBLK];
+               vz = -vz;
+            }
+         }
+/* mixed reflecting/periodic boundary conditions */
+         else if (ipbc==3) {
+            if ((dx < edgelx) || (dx >= edgerx)) {
+               dx = t[j];
+               vx = -vx;
+            }
+            if ((dy < edgely) || (dy >= edgery)) {
+               dy = t[j+NPBLK];
+               vy = -vy;
+            }
+           if (dz < edgelz) dz += edgerz;
+            if (dz >= edgerz) dz -= edgerz;
+         }
+/* set new position */
+         part[j+joff] = dx;
+         part[j+joff+npe] = dy;
+         part[j+joff+2*npe] = dz;
+/* set new velocity */
+         part[j+joff+3*npe] = vx;
+         part[j+joff+4*npe] = vy;
+         part[j+joff+5*npe] = vz;
+      }
+   }
+   nps = NPBLK*ipp;
+/* loop over remaining particles */
+   for (j = nps; j < nop; j++) {
+/* find interpolation weights */
+      x = part[j];
+      y = part[j+npe];
+      z = part[j+2*npe];
+      nn = x;
+      mm = y;
+      ll = z;
+      dxp = x - (float) nn;
+      dyp = y - (float) mm;
+      dzp = z - (float) ll;
+      nn = N*(nn + nxv*mm + nxyv*ll);
+      amx = 1.0f - dxp;
+      amy = 1.0f - dyp;
+      dx1 = dxp*dyp;
+      dyp = amx*dyp;
+      amx = amx*amy;
+      amz = 1.0f - dzp;
+      amy = dxp*amy;
+/* find acceleration */
+      dx = amx*fxyz[nn] + amy*fxyz[nn+N];
+      dy = amx*fxyz[nn+1] + amy*fxyz[nn+1+N];
+      dz = amx*fxyz[nn+2] + amy*fxyz[nn+2+N];
+      mm = nn + N*nxv;
+      dx = amz*(dx + dyp*fxyz[mm] + dx1*fxyz[mm+N]);
+      dy = amz*(dy + dyp*fxyz[mm+1] + dx1*fxyz[mm+1+N]);
+      dz = amz*(dz + dyp*fxyz[mm+2] + dx1*fxyz[mm+2+N]);
+      nn += N*nxyv;
+      vx = amx*fxyz[nn] + amy*fxyz[nn+N];
+      vy = amx*fxyz[nn+1] + amy*fxyz[nn+1+N];
+      vz = amx*fxyz[nn+2] + amy*fxyz[nn+2+N];
+      mm = nn + N*nxv;
+      dx = dx + dzp*(vx + dyp*fxyz[mm] + dx1*fxyz[mm+N]);
+      dy = dy + dzp*(vy + dyp*fxyz[mm+1] + dx1*fxyz[mm+1+N]);
+      dz = dz + dzp*(vz + dyp*fxyz[mm+2] + dx1*fxyz[mm+2+N]);
+/* new velocity */
+      dxp = part[j+3*npe];
+      dyp = part[j+4*npe];
+      dzp = part[j+5*npe];
+      vx = dxp + qtm*dx;
+      vy = dyp + qtm*dy;
+      vz = dzp + qtm*dz;
+/* average kinetic energy */
+      dxp += vx;
+      dyp += vy;
+      dzp += vz;
+      sum1 += dxp*dxp + dyp*dyp + dzp*dzp;
+/* new position */
+      dx = x + vx*dt;
+      dy = y + vy*dt;
+      dz = z + vz*dt;
+/* periodic boundary conditions */
+      if (ipbc==1) {
+         if (dx < edgelx) dx += edgerx;
+         if (dx >= edgerx) dx -= edgerx;
+         if (dy < edgely) dy += edgery;
+         if (dy >= edgery) dy -= edgery;
+         if (dz < edgelz) dz += edgerz;
+         if (dz >= edgerz) dz -= edgerz;
+      }
+/* reflecting boundary conditions */
+      else if (ipbc==2) {
+         if ((dx < edgelx) || (dx >= edgerx)) {
+            dx = x;
+            vx = -vx;
+         }
+         if ((dy < edgely) || (dy >= edgery)) {
+            dy = y;
+            vy = -vy;
+         }
+         if ((dz < edgelz) || (dz >= edgerz)) {
+            dz = z;
+            vz = -vz;
+         }
+      }
+/* mixed reflecting/periodic boundary conditions */
+      else if (ipbc==3) {
+         if ((dx < edgelx) || (dx >= edgerx)) {
+            dx = x;
+            vx = -vx;
+         }
+         if ((dy < edgely) || (dy >= edgery)) {
+            dy = y;
+            vy = -vy;
+         }
+         if (dz < edgelz) dz += edgerz;
+         if (dz >= edgerz) dz -= edgerz;
+      }
+/* set new position */
+      part[j] = dx;
+      part[j+npe] = dy;
+      part[j+2*npe] = dz;
+/* set new velocity */
+      part[j+3*npe] = vx;
+      part[j+4*npe] = vy;
+      part[j+5*npe] = vz;
+   }
+/* normalize kinetic energy */
+   *ek += 0.125f*sum1;
+   return;
+#undef LVECT
+#undef NPBLK
+#undef N
+}
+
+/*--------------------------------------------------------------------*/
+void VXNAME(vgpost3lt)(float part[], float q[], float qm, int nop,
+                       int npe, int idimp, int nxv, int nyv, int nzv) {
+/* for 3d code, this subroutine calculates particle charge density
+   using first-order linear interpolation, periodic boundaries
+   vectorizable version using guard cells
+   33 flops/particle, 11 loads, 8 stores
+   input: all, output: q
+   charge density is approximated by values at the nearest grid points
+   q(n,m,l)=qm*(1.-dx)*(1.-dy)*(1.-dz)
+   q(n+1,m,l)=qm*dx*(1.-dy)*(1.-dz)
+   q(n,m+1,l)=qm*(1.-dx)*dy*(1.-dz)
+   q(n+1,m+1,l)=qm*dx*dy*(1.-dz)
+   q(n,m,l+1)=qm*(1.-dx)*(1.-dy)*dz
+   q(n+1,m,l+1)=qm*dx*(1.-dy)*dz
+   q(n,m+1,l+1)=qm*(1.-dx)*dy*dz
+   q(n+1,m+1,l+1)=qm*dx*dy*dz
+   where n,m,l = leftmost grid points and dx = x-n, dy = y-m, dz = z-l
+   part[0][n] = position x of particle n
+   part[1][n] = position y of particle n
+   part[2][n] = position z of particle n
+   q[l][k][j] = charge density at grid point j,k,l
+   qm = charge on particle, in units of e
+   nop = number of particles
+   npe = first dimension of particle array
+   idimp = size of phase space = 6
+   nxv = first dimension of charge array, must be >= nx+1
+   nyv = second dimension of charge array, must be >= ny+1
+   nzv = third dimension of charge array, must be >= nz+1
+local data                                                            */
+#define NPBLK             32
+#define LVECT             8
+   int i, j, k, ipp, joff, nps, nn, mm, ll, nxyv;
+   float x, y, z, w, dx1, dxp, dyp, dzp, amx, amy, amz;
+/* scratch arrays */
+   int n[NPBLK], m[LVECT];
+   float s[NPBLK*LVECT];
+   nxyv = nxv*nyv;
+   m[0] = 0;
+   m[1] = 1;
+   m[2] = nxv;
+   m[3] = nxv + 1;
+   m[4] = nxyv;
+   m[5] = nxyv + 1;
+   m[6] = nxyv + nxv;
+   m[7] = nxyv + nxv + 1;
+   ipp = nop/NPBLK;
+/* outer loop over number of full blocks */
+   for (k = 0; k < ipp; k++) {
+      joff = NPBLK*k;
+/* inner loop over particles in block */
+      for (j = 0; j < NPBLK; j++) {
+/* find interpolation weights */
+         x = part[j+joff];
+         y = part[j+joff+npe];
+         z = part[j+joff+2*npe];
+         nn = x;
+         mm = y;
+         ll = z;
+         dxp = qm*(x - (float) nn);
+         dyp = y - (float) mm;
+         dzp = z - (float) ll;
+         n[j] = nn + nxv*mm + nxyv*ll;
+         amx = qm - dxp;
+         amy = 1.0f - dyp;
+         dx1 = dxp*dyp;
+         dyp = amx*dyp;
+         amx = amx*amy;
+         amz = 1.0f - dzp;
+         amy = dxp*amy;
+         s[j] = amx*amz;
+         s[j+NPBLK] = amy*amz;
+         s[j+2*NPBLK] = dyp*amz;
+         s[j+3*NPBLK] = dx1*amz;
+         s[j+4*NPBLK] = amx*dzp;
+         s[j+5*NPBLK] = amy*dzp;
+         s[j+6*NPBLK] = dyp*dzp;
+         s[j+7*NPBLK] = dx1*dzp;
+     }
+/* deposit charge */
+      for (j = 0; j < NPBLK; j++) {
+#pragma ivdep
+         for (i = 0; i < LVECT; i++) {
+            q[n[j]+m[i]] += s[j+NPBLK*i];
+         }
+      }
+   }
+   nps = NPBLK*ipp;
+/* loop over remaining particles */
+   for (j = nps; j < nop; j++) {
+/* find interpolation weights */
+      x = part[j];
+      y = part[j+npe];
+      z = part[j+2*npe];
+      nn = x;
+      mm = y;
+      ll = z;
+      dxp = qm*(x - (float) nn);
+      dyp = y - (float) mm;
+      dzp = z - (float) ll;
+      nn = nn + nxv*mm + nxyv*ll;
+      amx = qm - dxp;
+      amy = 1.0f - dyp;
+      dx1 = dxp*dyp;
+      dyp = amx*dyp;
+      amx = amx*amy;
+      amz = 1.0f - dzp;
+      amy = dxp*amy;
+/* deposit charge */
+      x = q[nn] + amx*amz;
+      y = q[nn+1] + amy*amz;
+      z = q[nn+nxv] + dyp*amz;
+      w = q[nn+1+nxv] + dx1*amz;
+      q[nn] = x;
+      q[nn+1] = y;
+      q[nn+nxv] = z;
+      q[nn+1+nxv] = w;
+      mm = nn + nxyv;
+      x = q[mm] + amx*dzp;
+      y = q[mm+1] + amy*dzp;
+      z = q[mm+nxv] + dyp*dzp;
+      w = q[mm+1+nxv] + dx1*dzp;
+      q[mm] = x;
+      q[mm+1] = y;
+      q[mm+nxv] = z;
+      q[mm+1+nxv] = w;
+   }
+   return;
+#undef LVECT
+#undef NPBLK
+}
@@ -0,0 +1,16 @@
+/* header file for vxpush3.c */
+
+void cavx2vgpush3lt(float part[], float fxyz[], float qbm, float dt,
+                    float *ek, int idimp, int nop, int npe, int nx,
+                    int ny, int nz, int nxv, int nyv, int nzv, int ipbc);
+
+void cavx2vgpost3lt(float part[], float q[], float qm, int nop, int npe,
+                    int idimp, int nxv, int nyv, int nzv);
+
+void cavx512vgpush3lt(float part[], float fxyz[], float qbm, float dt,
+                      float *ek, int idimp, int nop, int npe, int nx,
+                      int ny, int nz, int nxv, int nyv, int nzv,
+                      int ipbc);
+
+void cavx512vgpost3lt(float part[], float q[], float qm, int nop,
+                      int npe, int idimp, int nxv, int nyv, int nzv);